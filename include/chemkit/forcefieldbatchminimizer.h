@@ -0,0 +1 @@
+#include "../../src/chemkit/forcefieldbatchminimizer.h"
@@ -0,0 +1 @@
+#include "../../src/chemkit/neighborlist.h"
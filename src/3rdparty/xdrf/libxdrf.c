@@ -165,6 +165,7 @@ int ctofstr(char *, int, char *);
 static FILE *xdrfiles[MAXID];
 static XDR *xdridptr[MAXID];
 static char xdrmodes[MAXID];
+static int init_done = 0;
 static unsigned int cnt;
 
 typedef void (* xdrfproc_) (int *, void *, int *);
@@ -436,7 +437,6 @@ static int magicints[] = {
 */
 
 int xdropen(XDR *xdrs, const char *filename, const char *type) {
-    static int init_done = 0;
     enum xdr_op lmode;
     int xdrid;
     
@@ -481,6 +481,48 @@ int xdropen(XDR *xdrs, const char *filename, const char *type) {
     return xdrid;
 }
 
+/*_________________________________________________________________________
+ |
+ | xdrmemopen - open xdr stream on a memory buffer
+ |
+ | This is the same as xdropen except that the stream reads from or
+ | writes to the size bytes at buffer (using xdrmem_create) instead of
+ | a file, so that xdr3dfcoord can be used without a temporary file.
+ | The number of bytes used can be found with xdr_getpos.
+ |
+*/
+
+int xdrmemopen(XDR *xdrs, char *buffer, unsigned int size, const char *type) {
+    enum xdr_op lmode;
+    int xdrid;
+
+    if (init_done == 0) {
+	for (xdrid = 1; xdrid < MAXID; xdrid++) {
+	    xdridptr[xdrid] = NULL;
+	}
+	init_done = 1;
+    }
+    xdrid = 1;
+    while (xdrid < MAXID && xdridptr[xdrid] != NULL) {
+	xdrid++;
+    }
+    if (xdrid == MAXID || xdrs == NULL) {
+	return 0;
+    }
+    if (*type == 'w' || *type == 'W') {
+	    xdrmodes[xdrid] = 'w';
+	    lmode = XDR_ENCODE;
+    } else {
+	    xdrmodes[xdrid] = 'r';
+	    lmode = XDR_DECODE;
+    }
+    xdrfiles[xdrid] = NULL;
+    xdridptr[xdrid] = xdrs;
+    xdrmem_create(xdrs, buffer, size, lmode);
+
+    return xdrid;
+}
+
 /*_________________________________________________________________________
  |
  | xdrclose - close a xdr file
@@ -502,7 +544,9 @@ int xdrclose(XDR *xdrs) {
 	if (xdridptr[xdrid] == xdrs) {
 	    
 	    xdr_destroy(xdrs);
-	    fclose(xdrfiles[xdrid]);
+	    if (xdrfiles[xdrid] != NULL) {
+		fclose(xdrfiles[xdrid]);
+	    }
 	    xdridptr[xdrid] = NULL;
 	    return 1;
 	}
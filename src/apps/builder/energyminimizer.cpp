@@ -45,12 +45,17 @@ EnergyMinimizer::EnergyMinimizer(chemkit::Molecule *molecule)
     m_moleculeChanged = true;
     m_state = Stopped;
     m_forceField = 0;
+    m_minimizer = new chemkit::ForceFieldMinimizer;
     m_forceFieldName = "uff";
     connect(&m_minimizationWatcher, SIGNAL(finished()), SLOT(minimizationStepFinished()));
 }
 
 EnergyMinimizer::~EnergyMinimizer()
 {
+    m_minimizer->cancel();
+    m_minimizationWatcher.waitForFinished();
+
+    delete m_minimizer;
     delete m_forceField;
 }
 
@@ -91,6 +96,11 @@ chemkit::ForceField* EnergyMinimizer::forceField() const
     return m_forceField;
 }
 
+chemkit::ForceFieldMinimizer* EnergyMinimizer::minimizer() const
+{
+    return m_minimizer;
+}
+
 int EnergyMinimizer::state() const
 {
     return m_state;
@@ -112,7 +122,9 @@ QString EnergyMinimizer::stateString() const
 // --- Optimization -------------------------------------------------------- //
 chemkit::Float EnergyMinimizer::energy() const
 {
-    if(m_forceField)
+    if(m_forceField && m_minimizer->stepCount() > 0)
+        return m_minimizer->energy();
+    else if(m_forceField)
         return m_forceField->energy();
     else
         return 0;
@@ -126,7 +138,12 @@ void EnergyMinimizer::start()
         return;
     }
 
+    // wait for the previous step to finish
+    m_minimizer->cancel();
+    m_minimizationWatcher.waitForFinished();
+
     if(m_moleculeChanged){
+        m_minimizer->setForceField(0);
         delete m_forceField;
 
         m_forceField = chemkit::ForceField::create(m_forceFieldName.toStdString());
@@ -145,10 +162,11 @@ void EnergyMinimizer::start()
             return;
         }
 
+        m_minimizer->setForceField(m_forceField);
         m_moleculeChanged = false;
     }
 
-    QFuture<bool> future = m_forceField->minimizationStepAsync();
+    QFuture<bool> future = m_minimizer->stepAsync();
     m_minimizationWatcher.setFuture(future);
 
     setState(Running);
@@ -156,6 +174,7 @@ void EnergyMinimizer::start()
 
 void EnergyMinimizer::stop()
 {
+    m_minimizer->cancel();
     setState(Stopped);
 }
 
@@ -177,7 +196,7 @@ void EnergyMinimizer::minimizationStepFinished()
         return;
     }
 
-    if(converged){
+    if(converged || m_minimizer->status() == chemkit::ForceFieldMinimizer::Failed){
         setState(Converged);
     }
     else{
@@ -41,6 +41,7 @@
 
 #include <chemkit/molecule.h>
 #include <chemkit/forcefield.h>
+#include <chemkit/forcefieldminimizer.h>
 
 class EnergyMinimizer : public QObject
 {
@@ -68,6 +69,7 @@ class EnergyMinimizer : public QObject
         bool moleculeChanged() const;
         void setForceField(const QString &name);
         chemkit::ForceField* forceField() const;
+        chemkit::ForceFieldMinimizer* minimizer() const;
         int state() const;
         QString stateString() const;
 
@@ -93,6 +95,7 @@ class EnergyMinimizer : public QObject
         bool m_moleculeChanged;
         chemkit::Molecule *m_molecule;
         chemkit::ForceField *m_forceField;
+        chemkit::ForceFieldMinimizer *m_minimizer;
         QString m_forceFieldName;
         int m_state;
         QFutureWatcher<bool> m_minimizationWatcher;
@@ -124,6 +124,7 @@ void Atom::setAtomicNumber(int atomicNumber)
     }
 
     m_element.setAtomicNumber(atomicNumber);
+    m_molecule->setTopologyChanged();
     m_molecule->notifyObservers(this, Molecule::AtomAtomicNumberChanged);
 }
 
@@ -168,7 +169,14 @@ int Atom::formalCharge() const
 /// Sets the partial charge of the atom.
 void Atom::setPartialCharge(Float charge)
 {
+    if(charge == d->partialCharge){
+        return;
+    }
+
     d->partialCharge = charge;
+
+    // atom types may depend on partial charges (e.g. metal ions)
+    m_molecule->clearCachedAtomTypers();
     m_molecule->notifyObservers(this, Molecule::AtomPartialChargeChanged);
 }
 
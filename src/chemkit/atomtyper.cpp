@@ -42,6 +42,28 @@
 
 namespace chemkit {
 
+namespace {
+
+// The AtomTyperChunk class contains a contiguous range of molecules
+// along with the atom typers which are assigned them by a single
+// thread.
+class AtomTyperChunk
+{
+    public:
+        AtomTyper * const *typers;
+        const Molecule * const *molecules;
+        int count;
+};
+
+void assignChunkTypes(AtomTyperChunk &chunk)
+{
+    for(int i = 0; i < chunk.count; i++){
+        chunk.typers[i]->setMolecule(chunk.molecules[i]);
+    }
+}
+
+} // end anonymous namespace
+
 // === AtomTyperPrivate ==================================================== //
 class AtomTyperPrivate
 {
@@ -79,11 +101,47 @@ std::string AtomTyper::name() const
 }
 
 /// Sets the molecule for the atom typer to \p molecule.
+///
+/// Atom types are cached by the molecule along with its current
+/// topology revision. If the molecule has already been typed by
+/// another atom typer with the same name and neither its topology
+/// nor the partial charges of its atoms have changed since then, the
+/// cached types are reused instead of being assigned again. The cache
+/// is guarded by a mutex so the same molecule may be typed from
+/// multiple threads at once.
 void AtomTyper::setMolecule(const Molecule *molecule)
 {
     d->molecule = molecule;
 
+    if(!molecule){
+        assignTypes(molecule);
+        return;
+    }
+
+    // reuse cached types
+    QMutexLocker locker(molecule->atomTyperMutex());
+    const AtomTyper *cachedTyper = molecule->cachedAtomTyper(d->name);
+    if(cachedTyper && copyTypes(cachedTyper)){
+        return;
+    }
+    locker.unlock();
+
     assignTypes(molecule);
+
+    // cache types for the molecule
+    AtomTyper *typer = create(d->name);
+    if(!typer){
+        return;
+    }
+    else if(!typer->copyTypes(this)){
+        delete typer;
+        return;
+    }
+
+    typer->d->molecule = molecule;
+
+    QMutexLocker cacheLocker(molecule->atomTyperMutex());
+    molecule->setCachedAtomTyper(typer);
 }
 
 /// Returns the molecule for the atom typer.
@@ -139,6 +197,63 @@ AtomTyper* AtomTyper::create(const std::string &name)
     return PluginManager::instance()->createPluginClass<AtomTyper>(name);
 }
 
+/// Creates a new atom typer with \p name for each molecule in
+/// \p molecules and assigns the types for the molecules using
+/// \p threadCount threads. If \p threadCount is \c 0 the ideal
+/// number of threads for the system is used. Returns an empty list
+/// if \p name is invalid.
+///
+/// Each molecule must only be present once in \p molecules. The
+/// returned atom typers are owned by the caller.
+std::vector<AtomTyper *> AtomTyper::create(const std::string &name, const std::vector<const Molecule *> &molecules, int threadCount)
+{
+    std::vector<AtomTyper *> typers;
+    typers.reserve(molecules.size());
+
+    for(unsigned int i = 0; i < molecules.size(); i++){
+        AtomTyper *typer = create(name);
+        if(!typer){
+            foreach(AtomTyper *typer, typers){
+                delete typer;
+            }
+
+            return std::vector<AtomTyper *>();
+        }
+
+        typers.push_back(typer);
+    }
+
+    if(threadCount == 0){
+        threadCount = QThread::idealThreadCount();
+    }
+
+    int moleculeCount = molecules.size();
+    threadCount = qBound(1, threadCount, qMax(1, moleculeCount));
+
+    if(moleculeCount == 0){
+        return typers;
+    }
+
+    std::vector<AtomTyperChunk> chunks(threadCount);
+    for(int i = 0; i < threadCount; i++){
+        int begin = (i * moleculeCount) / threadCount;
+        int end = ((i + 1) * moleculeCount) / threadCount;
+
+        chunks[i].typers = &typers[begin];
+        chunks[i].molecules = &molecules[begin];
+        chunks[i].count = end - begin;
+    }
+
+    if(threadCount == 1){
+        assignChunkTypes(chunks[0]);
+    }
+    else{
+        QtConcurrent::blockingMap(chunks, assignChunkTypes);
+    }
+
+    return typers;
+}
+
 /// Returns a list of names of all the available atom typers.
 std::vector<std::string> AtomTyper::typers()
 {
@@ -151,4 +266,18 @@ void AtomTyper::assignTypes(const Molecule *molecule)
     Q_UNUSED(molecule);
 }
 
+/// Copies the atom types from \p typer which has the same name and
+/// molecule as this atom typer. Returns \c false if the types could
+/// not be copied.
+///
+/// Atom typers which implement this method have their types cached
+/// by the molecule and shared with other atom typers. The default
+/// implementation returns \c false.
+bool AtomTyper::copyTypes(const AtomTyper *typer)
+{
+    Q_UNUSED(typer);
+
+    return false;
+}
+
 } // end chemkit namespace
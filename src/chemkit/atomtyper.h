@@ -72,11 +72,13 @@ class CHEMKIT_EXPORT AtomTyper
 
         // static methods
         static AtomTyper* create(const std::string &name);
+        static std::vector<AtomTyper *> create(const std::string &name, const std::vector<const Molecule *> &molecules, int threadCount = 1);
         static std::vector<std::string> typers();
 
     protected:
         AtomTyper(const std::string &name);
         virtual void assignTypes(const Molecule *molecule);
+        virtual bool copyTypes(const AtomTyper *typer);
 
     private:
         AtomTyperPrivate* const d;
@@ -0,0 +1,64 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#ifndef CHEMKIT_BINARYPARAMETERFILE_INLINE_H
+#define CHEMKIT_BINARYPARAMETERFILE_INLINE_H
+
+#include "binaryparameterfile.h"
+
+namespace chemkit {
+
+// --- Sections ------------------------------------------------------------ //
+/// Adds a new section containing \p records to the file. The
+/// records type must be plain-old-data.
+template<typename T>
+inline void BinaryParameterFile::addSection(const std::vector<T> &records)
+{
+    addSection(records.empty() ? 0 : &records[0], records.size(), sizeof(T));
+}
+
+/// Returns a pointer to the records in the section at \p index and
+/// sets \p count to the number of records. Returns \c 0 if the
+/// section does not exist or its record size does not match
+/// \c sizeof(T).
+template<typename T>
+inline const T* BinaryParameterFile::section(int index, int *count) const
+{
+    return static_cast<const T *>(section(index, sizeof(T), count));
+}
+
+} // end chemkit namespace
+
+#endif // CHEMKIT_BINARYPARAMETERFILE_INLINE_H
@@ -0,0 +1,483 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "binaryparameterfile.h"
+
+#include <cstring>
+
+#include <QtCore>
+
+namespace chemkit {
+
+namespace {
+
+const char Magic[8] = { 'C', 'K', 'P', 'A', 'R', 'A', 'M', '\n' };
+const quint32 FileVersion = 1;
+const quint32 ByteOrderMark = 0x01020304;
+const int SectionAlignment = 16;
+
+struct FileHeader
+{
+    char magic[8];
+    quint32 fileVersion;
+    quint32 byteOrder;
+    quint32 floatSize;
+    qint32 version;
+    qint32 sectionCount;
+    quint32 reserved;
+    char format[16];
+    qint64 sourceSize;
+    qint64 sourceModified;
+};
+
+struct SectionHeader
+{
+    quint64 offset;
+    qint32 count;
+    qint32 recordSize;
+};
+
+// Returns the number of bytes needed to pad offset to the section
+// alignment.
+inline qint64 padding(qint64 offset)
+{
+    return (SectionAlignment - offset % SectionAlignment) % SectionAlignment;
+}
+
+} // end anonymous namespace
+
+// === BinaryParameterFilePrivate ========================================== //
+class BinaryParameterFilePrivate
+{
+    public:
+        struct Section
+        {
+            const char *mapped;
+            std::vector<char> buffer;
+            int count;
+            int recordSize;
+        };
+
+        std::string format;
+        int version;
+        std::string fileName;
+        QFile file;
+        const uchar *data;
+        std::vector<Section> sections;
+        qint64 sourceSize;
+        qint64 sourceModified;
+        std::string errorString;
+};
+
+// === BinaryParameterFile ================================================= //
+/// \class BinaryParameterFile binaryparameterfile.h chemkit/binaryparameterfile.h
+/// \ingroup chemkit
+/// \brief The BinaryParameterFile class provides access to
+///        precompiled force field parameter files.
+///
+/// Binary parameter files store parameter records as flat sections
+/// of plain-old-data structs. When opened the file is memory-mapped
+/// and the records are used in place so no per-record parsing or
+/// allocation takes place.
+///
+/// Each file records a format name and version chosen by the force
+/// field which wrote it along with the size and modification time
+/// of the text file it was generated from. Force fields use this to
+/// keep a cache of binary files (see cacheFileName()) which are
+/// regenerated whenever the text file changes.
+///
+/// \see ForceField::setParameterFile()
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new binary parameter file for \p format and \p version.
+BinaryParameterFile::BinaryParameterFile(const std::string &format, int version)
+    : d(new BinaryParameterFilePrivate)
+{
+    d->format = format.substr(0, sizeof(FileHeader().format) - 1);
+    d->version = version;
+    d->data = 0;
+    d->sourceSize = 0;
+    d->sourceModified = 0;
+}
+
+/// Destroys the binary parameter file. All pointers returned by
+/// section() become invalid.
+BinaryParameterFile::~BinaryParameterFile()
+{
+    close();
+
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Returns the format name for the file.
+std::string BinaryParameterFile::format() const
+{
+    return d->format;
+}
+
+/// Returns the format version for the file.
+int BinaryParameterFile::version() const
+{
+    return d->version;
+}
+
+/// Returns the name of the currently open file.
+std::string BinaryParameterFile::fileName() const
+{
+    return d->fileName;
+}
+
+/// Returns \c true if the file is open.
+bool BinaryParameterFile::isOpen() const
+{
+    return d->data != 0;
+}
+
+// --- Source File --------------------------------------------------------- //
+/// Sets the text parameter file the binary file is generated from.
+/// Its size and modification time are stored in the file when it
+/// is written.
+void BinaryParameterFile::setSourceFile(const std::string &fileName)
+{
+    QFileInfo info(QString::fromStdString(fileName));
+
+    d->sourceSize = info.size();
+    d->sourceModified = info.lastModified().toTime_t();
+}
+
+/// Returns \c true if the file was generated from the current
+/// contents of \p sourceFileName.
+bool BinaryParameterFile::isCurrent(const std::string &sourceFileName) const
+{
+    QFileInfo info(QString::fromStdString(sourceFileName));
+    if(!info.exists()){
+        return false;
+    }
+
+    return info.size() == d->sourceSize &&
+           qint64(info.lastModified().toTime_t()) == d->sourceModified;
+}
+
+// --- Sections ------------------------------------------------------------ //
+/// Adds a new section to the file containing \p count records of
+/// \p recordSize bytes each copied from \p data.
+void BinaryParameterFile::addSection(const void *data, int count, int recordSize)
+{
+    d->sections.push_back(BinaryParameterFilePrivate::Section());
+
+    BinaryParameterFilePrivate::Section &section = d->sections.back();
+    section.mapped = 0;
+    section.count = count;
+    section.recordSize = recordSize;
+
+    if(count > 0){
+        const char *begin = static_cast<const char *>(data);
+        section.buffer.assign(begin, begin + count * recordSize);
+    }
+}
+
+/// Returns the number of sections in the file.
+int BinaryParameterFile::sectionCount() const
+{
+    return d->sections.size();
+}
+
+/// Returns a pointer to the records in the section at \p index and
+/// sets \p count to the number of records. Returns \c 0 if the
+/// section does not exist or if its records are not \p recordSize
+/// bytes long.
+const void* BinaryParameterFile::section(int index, int recordSize, int *count) const
+{
+    if(count){
+        *count = 0;
+    }
+
+    if(index < 0 || index >= sectionCount()){
+        return 0;
+    }
+
+    const BinaryParameterFilePrivate::Section &section = d->sections[index];
+    if(section.recordSize != recordSize){
+        return 0;
+    }
+
+    if(count){
+        *count = section.count;
+    }
+
+    if(section.mapped){
+        return section.mapped;
+    }
+    else if(!section.buffer.empty()){
+        return &section.buffer[0];
+    }
+
+    return 0;
+}
+
+// --- Input and Output ---------------------------------------------------- //
+/// Opens and memory-maps the binary parameter file \p fileName.
+/// Returns \c false if the file cannot be read or if it was written
+/// with a different format, version or floating point size.
+bool BinaryParameterFile::open(const std::string &fileName)
+{
+    close();
+
+    d->file.setFileName(QString::fromStdString(fileName));
+    if(!d->file.open(QFile::ReadOnly)){
+        setErrorString(d->file.errorString().toStdString());
+        return false;
+    }
+
+    qint64 size = d->file.size();
+    if(size < qint64(sizeof(FileHeader))){
+        setErrorString("File is too small to be a binary parameter file.");
+        d->file.close();
+        return false;
+    }
+
+    const uchar *data = d->file.map(0, size);
+    if(!data){
+        setErrorString(d->file.errorString().toStdString());
+        d->file.close();
+        return false;
+    }
+
+    FileHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    std::string error;
+    if(memcmp(header.magic, Magic, sizeof(Magic)) != 0){
+        error = "File is not a binary parameter file.";
+    }
+    else if(header.fileVersion != FileVersion || header.byteOrder != ByteOrderMark){
+        error = "Unsupported binary parameter file version or byte order.";
+    }
+    else if(header.floatSize != sizeof(chemkit::Float)){
+        error = "Binary parameter file was written with a different floating point size.";
+    }
+    else if(strncmp(header.format, d->format.c_str(), sizeof(header.format)) != 0 ||
+            header.version != d->version){
+        error = "Binary parameter file has a different format or version.";
+    }
+    else if(header.sectionCount < 0 ||
+            qint64(sizeof(FileHeader) + header.sectionCount * sizeof(SectionHeader)) > size){
+        error = "Binary parameter file is truncated.";
+    }
+
+    std::vector<BinaryParameterFilePrivate::Section> sections(qMax(0, int(header.sectionCount)));
+
+    for(int i = 0; error.empty() && i < header.sectionCount; i++){
+        SectionHeader sectionHeader;
+        memcpy(&sectionHeader, data + sizeof(FileHeader) + i * sizeof(SectionHeader), sizeof(sectionHeader));
+
+        if(sectionHeader.count < 0 ||
+           sectionHeader.recordSize <= 0 ||
+           sectionHeader.offset % SectionAlignment != 0 ||
+           qint64(sectionHeader.offset) + qint64(sectionHeader.count) * sectionHeader.recordSize > size){
+            error = "Binary parameter file is truncated.";
+            break;
+        }
+
+        sections[i].mapped = reinterpret_cast<const char *>(data + sectionHeader.offset);
+        sections[i].count = sectionHeader.count;
+        sections[i].recordSize = sectionHeader.recordSize;
+    }
+
+    if(!error.empty()){
+        setErrorString(error);
+        d->file.unmap(const_cast<uchar *>(data));
+        d->file.close();
+        return false;
+    }
+
+    d->data = data;
+    d->fileName = fileName;
+    d->sections.swap(sections);
+    d->sourceSize = header.sourceSize;
+    d->sourceModified = header.sourceModified;
+
+    return true;
+}
+
+/// Closes the file and removes all of its sections. All pointers
+/// returned by section() become invalid.
+void BinaryParameterFile::close()
+{
+    if(d->data){
+        d->file.unmap(const_cast<uchar *>(d->data));
+        d->file.close();
+        d->data = 0;
+    }
+
+    d->sections.clear();
+    d->fileName.clear();
+}
+
+/// Writes the sections to \p fileName. The file is first written to
+/// a temporary file and then renamed so that other processes never
+/// see a partially written file. Returns \c false if an error
+/// occurs.
+bool BinaryParameterFile::write(const std::string &fileName)
+{
+    QFileInfo info(QString::fromStdString(fileName));
+    QDir().mkpath(info.absolutePath());
+
+    QTemporaryFile file(info.absoluteFilePath() + ".XXXXXX");
+    if(!file.open()){
+        setErrorString(file.errorString().toStdString());
+        return false;
+    }
+
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, Magic, sizeof(Magic));
+    header.fileVersion = FileVersion;
+    header.byteOrder = ByteOrderMark;
+    header.floatSize = sizeof(chemkit::Float);
+    header.version = d->version;
+    header.sectionCount = sectionCount();
+    strncpy(header.format, d->format.c_str(), sizeof(header.format) - 1);
+    header.sourceSize = d->sourceSize;
+    header.sourceModified = d->sourceModified;
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    // section table
+    qint64 offset = sizeof(FileHeader) + sectionCount() * sizeof(SectionHeader);
+    for(int i = 0; i < sectionCount(); i++){
+        offset += padding(offset);
+
+        SectionHeader sectionHeader;
+        memset(&sectionHeader, 0, sizeof(sectionHeader));
+        sectionHeader.offset = offset;
+        sectionHeader.count = d->sections[i].count;
+        sectionHeader.recordSize = d->sections[i].recordSize;
+        file.write(reinterpret_cast<const char *>(&sectionHeader), sizeof(sectionHeader));
+
+        offset += qint64(sectionHeader.count) * sectionHeader.recordSize;
+    }
+
+    // section data
+    const char zeros[SectionAlignment] = { 0 };
+    offset = sizeof(FileHeader) + sectionCount() * sizeof(SectionHeader);
+    for(int i = 0; i < sectionCount(); i++){
+        file.write(zeros, padding(offset));
+        offset += padding(offset);
+
+        int count = 0;
+        const char *data = static_cast<const char *>(section(i, d->sections[i].recordSize, &count));
+        qint64 size = qint64(count) * d->sections[i].recordSize;
+        if(size > 0 && file.write(data, size) != size){
+            setErrorString(file.errorString().toStdString());
+            return false;
+        }
+
+        offset += size;
+    }
+
+    file.close();
+
+    // replace the old file
+    QFile::remove(info.absoluteFilePath());
+    if(!file.rename(info.absoluteFilePath())){
+        setErrorString(file.errorString().toStdString());
+        return false;
+    }
+
+    file.setAutoRemove(false);
+
+    return true;
+}
+
+// --- Error Handling ------------------------------------------------------ //
+void BinaryParameterFile::setErrorString(const std::string &errorString)
+{
+    d->errorString = errorString;
+}
+
+/// Returns a string describing the last error that occured.
+std::string BinaryParameterFile::errorString() const
+{
+    return d->errorString;
+}
+
+// --- Static Methods ------------------------------------------------------ //
+/// Returns \c true if \p fileName is a binary parameter file.
+bool BinaryParameterFile::isBinaryParameterFile(const std::string &fileName)
+{
+    QFile file(QString::fromStdString(fileName));
+    if(!file.open(QFile::ReadOnly)){
+        return false;
+    }
+
+    QByteArray magic = file.read(sizeof(Magic));
+
+    return magic.size() == int(sizeof(Magic)) &&
+           memcmp(magic.constData(), Magic, sizeof(Magic)) == 0;
+}
+
+/// Returns the directory where cached binary parameter files are
+/// stored. This is the value of the \c CHEMKIT_CACHE_PATH
+/// environment variable if set, otherwise a \c chemkit-cache
+/// directory in the system's temporary directory.
+std::string BinaryParameterFile::cachePath()
+{
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    QString path = environment.value("CHEMKIT_CACHE_PATH");
+    if(path.isEmpty()){
+        path = QDir::tempPath() + "/chemkit-cache";
+    }
+
+    if(!path.endsWith("/")){
+        path += "/";
+    }
+
+    return path.toStdString();
+}
+
+/// Returns the file name of the cached binary parameter file for
+/// the text parameter file \p sourceFileName.
+std::string BinaryParameterFile::cacheFileName(const std::string &sourceFileName)
+{
+    QFileInfo info(QString::fromStdString(sourceFileName));
+
+    QString name = QString("%1-%2.ckp").arg(info.completeBaseName())
+                                       .arg(qHash(info.absoluteFilePath()), 8, 16, QChar('0'));
+
+    return cachePath() + name.toStdString();
+}
+
+} // end chemkit namespace
@@ -0,0 +1,96 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#ifndef CHEMKIT_BINARYPARAMETERFILE_H
+#define CHEMKIT_BINARYPARAMETERFILE_H
+
+#include "chemkit.h"
+
+#include <string>
+#include <vector>
+
+namespace chemkit {
+
+class BinaryParameterFilePrivate;
+
+class CHEMKIT_EXPORT BinaryParameterFile
+{
+    public:
+        // construction and destruction
+        BinaryParameterFile(const std::string &format, int version);
+        ~BinaryParameterFile();
+
+        // properties
+        std::string format() const;
+        int version() const;
+        std::string fileName() const;
+        bool isOpen() const;
+
+        // source file
+        void setSourceFile(const std::string &fileName);
+        bool isCurrent(const std::string &sourceFileName) const;
+
+        // sections
+        void addSection(const void *data, int count, int recordSize);
+        template<typename T> void addSection(const std::vector<T> &records);
+        int sectionCount() const;
+        const void* section(int index, int recordSize, int *count) const;
+        template<typename T> const T* section(int index, int *count) const;
+
+        // input and output
+        bool open(const std::string &fileName);
+        void close();
+        bool write(const std::string &fileName);
+
+        // error handling
+        std::string errorString() const;
+
+        // static methods
+        static bool isBinaryParameterFile(const std::string &fileName);
+        static std::string cachePath();
+        static std::string cacheFileName(const std::string &sourceFileName);
+
+    private:
+        void setErrorString(const std::string &errorString);
+
+    private:
+        BinaryParameterFilePrivate* const d;
+};
+
+} // end chemkit namespace
+
+#include "binaryparameterfile-inline.h"
+
+#endif // CHEMKIT_BINARYPARAMETERFILE_H
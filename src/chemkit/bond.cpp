@@ -100,6 +100,7 @@ void Bond::setOrder(int order)
 {
     m_order = order;
 
+    molecule()->setTopologyChanged();
     molecule()->notifyObservers(this, Molecule::BondOrderChanged);
 }
 
@@ -193,6 +194,26 @@ bool Bond::isTerminal() const
     return (m_atom1->isTerminal() || m_atom2->isTerminal());
 }
 
+/// Returns \c true if the bond is rotatable. A bond is rotatable
+/// if it is a single bond, is not in a ring and both of its atoms
+/// are bonded to at least one other heavy (non-hydrogen) atom.
+bool Bond::isRotatable() const
+{
+    if(m_order != Single){
+        return false;
+    }
+
+    for(int i = 0; i < 2; i++){
+        const Atom *atom = this->atom(i);
+
+        if(atom->neighborCount() - atom->neighborCount(Atom::Hydrogen) < 2){
+            return false;
+        }
+    }
+
+    return !isInRing();
+}
+
 // --- Ring Perception ----------------------------------------------------- //
 /// Returns a list of rings the bond is a member of.
 std::vector<Ring *> Bond::rings() const
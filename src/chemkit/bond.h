@@ -85,6 +85,7 @@ class CHEMKIT_EXPORT Bond
         bool containsBoth(const Atom *a, const Atom *b) const;
         bool containsBoth(const Element &a, const Element &b) const;
         bool isTerminal() const;
+        bool isRotatable() const;
 
         // ring perception
         std::vector<Ring *> rings() const;
@@ -0,0 +1,875 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "conformersearch.h"
+
+#include <algorithm>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real.hpp>
+#include <boost/random/variate_generator.hpp>
+
+#include "atom.h"
+#include "bond.h"
+#include "foreach.h"
+#include "molecule.h"
+#include "conformer.h"
+#include "quaternion.h"
+#include "forcefield.h"
+#include "staticmatrix.h"
+#include "forcefieldatom.h"
+
+namespace chemkit {
+
+namespace {
+
+// A rotatable bond and the atoms on the side of the bond which
+// are moved when it is rotated.
+class RotatableTorsion
+{
+    public:
+        int atom1;
+        int atom2;
+        std::vector<int> movingAtoms;
+};
+
+// A starting geometry and the result of minimizing it. Positions
+// are indexed by the atom's index in the molecule.
+class ConformerTrial
+{
+    public:
+        std::vector<Point3> positions;
+        ForceFieldMinimizer::Status status;
+        Float energy;
+};
+
+// Returns the indices of the atoms bonded to bond->atom2() which are
+// not connected to bond->atom1() except through the bond.
+std::vector<int> bondSide(const Bond *bond)
+{
+    const Atom *root = bond->atom2();
+
+    std::vector<int> side;
+    std::vector<bool> visited(bond->molecule()->size());
+    std::vector<const Atom *> stack;
+
+    visited[bond->atom1()->index()] = true;
+    visited[root->index()] = true;
+    stack.push_back(root);
+
+    while(!stack.empty()){
+        const Atom *atom = stack.back();
+        stack.pop_back();
+        side.push_back(atom->index());
+
+        foreach(const Atom *neighbor, atom->neighbors()){
+            if(!visited[neighbor->index()]){
+                visited[neighbor->index()] = true;
+                stack.push_back(neighbor);
+            }
+        }
+    }
+
+    return side;
+}
+
+// Rotates the moving atoms of torsion by angle degrees around the
+// bond axis.
+void rotateTorsion(std::vector<Point3> &positions, const RotatableTorsion &torsion, Float angle)
+{
+    const Point3 origin = positions[torsion.atom1];
+    const Vector3 axis = (positions[torsion.atom2] - origin).normalized();
+
+    foreach(int index, torsion.movingAtoms){
+        positions[index] = origin + Quaternion::rotate(Vector3(positions[index] - origin), axis, angle);
+    }
+}
+
+// Returns the root mean square deviation between the atoms in a
+// and b after optimal superposition. The deviation is calculated
+// from the singular values of the covariance matrix (Kabsch) so
+// the rotation itself is never constructed.
+Float superposedRmsd(const std::vector<Point3> &a, const std::vector<Point3> &b, const std::vector<int> &atoms)
+{
+    if(atoms.empty()){
+        return 0;
+    }
+
+    Vector3 centerA;
+    Vector3 centerB;
+    foreach(int index, atoms){
+        centerA += a[index];
+        centerB += b[index];
+    }
+    centerA /= atoms.size();
+    centerB /= atoms.size();
+
+    StaticMatrix<Float, 3, 3> covariance;
+    covariance.fill(0);
+    Float sumSquared = 0;
+
+    foreach(int index, atoms){
+        Vector3 u = a[index] - centerA;
+        Vector3 v = b[index] - centerB;
+
+        for(int i = 0; i < 3; i++){
+            for(int j = 0; j < 3; j++){
+                covariance(i, j) += u[i] * v[j];
+            }
+        }
+
+        sumSquared += u.lengthSquared() + v.lengthSquared();
+    }
+
+    StaticMatrix<Float, 3, 3> U;
+    StaticMatrix<Float, 3, 3> V;
+    StaticVector<Float, 3> S;
+    covariance.svd(&U, &S, &V);
+
+    Float singularValues[3] = { qAbs(S[0]), qAbs(S[1]), qAbs(S[2]) };
+    std::sort(singularValues, singularValues + 3);
+
+    // a reflection is not allowed so the smallest singular value is
+    // subtracted if the covariance matrix has a negative determinant
+    Float sign = covariance.determinant() < 0 ? -1 : 1;
+    Float deviation = sumSquared - 2 * (singularValues[2] + singularValues[1] + sign * singularValues[0]);
+
+    return std::sqrt(qMax(Float(0), deviation) / atoms.size());
+}
+
+bool compareTrialEnergies(const ConformerTrial *a, const ConformerTrial *b)
+{
+    return a->energy < b->energy;
+}
+
+} // end anonymous namespace
+
+// === ConformerSearchPrivate ============================================== //
+class ConformerSearchPrivate
+{
+    public:
+        std::string forceField;
+        ConformerSearch::Method method;
+        ForceFieldMinimizer::Algorithm algorithm;
+        int threadCount;
+        unsigned int randomSeed;
+        Float torsionIncrement;
+        int maximumTrialCount;
+        int convergenceTrialCount;
+        int maximumStepCount;
+        Float rmsdThreshold;
+        Float energyThreshold;
+        Float energyWindow;
+        int maximumConformerCount;
+        QAtomicInt canceled;
+        std::string errorString;
+
+        // the trials being minimized and the index of the next trial
+        // to be claimed by a thread
+        std::vector<ConformerTrial> trials;
+        QAtomicInt nextTrial;
+
+        // results
+        std::vector<Conformer *> conformers;
+        std::vector<Float> energies;
+        int trialCount;
+        int failedTrialCount;
+
+        void minimizeTrials(ForceField *forceField, ForceFieldMinimizer *minimizer, const std::vector<int> &atomIndices);
+};
+
+// Minimizes trials until none are left. Each thread runs this with
+// its own force field and minimizer. The force field atoms are
+// mapped to the trial positions with atomIndices.
+void ConformerSearchPrivate::minimizeTrials(ForceField *forceField, ForceFieldMinimizer *minimizer, const std::vector<int> &atomIndices)
+{
+    const std::vector<ForceFieldAtom *> atoms = forceField->atoms();
+
+    for(;;){
+        if(canceled){
+            return;
+        }
+
+        int index = nextTrial.fetchAndAddOrdered(1);
+        if(index >= static_cast<int>(trials.size())){
+            return;
+        }
+
+        ConformerTrial &trial = trials[index];
+
+        for(unsigned int i = 0; i < atoms.size(); i++){
+            atoms[i]->setPosition(trial.positions[atomIndices[i]]);
+        }
+
+        minimizer->reset();
+        minimizer->minimize();
+
+        trial.status = minimizer->status();
+        trial.energy = minimizer->energy();
+
+        for(unsigned int i = 0; i < atoms.size(); i++){
+            trial.positions[atomIndices[i]] = atoms[i]->position();
+        }
+    }
+}
+
+namespace {
+
+// The ConformerSearchWorkspace class contains the force field and
+// minimizer used by a single thread.
+class ConformerSearchWorkspace
+{
+    public:
+        ConformerSearchPrivate *search;
+        ForceField *forceField;
+        ForceFieldMinimizer *minimizer;
+        std::vector<int> atomIndices;
+};
+
+void minimizeWorkspaceTrials(ConformerSearchWorkspace &workspace)
+{
+    workspace.search->minimizeTrials(workspace.forceField, workspace.minimizer, workspace.atomIndices);
+}
+
+} // end anonymous namespace
+
+// === ConformerSearch ===================================================== //
+/// \class ConformerSearch conformersearch.h chemkit/conformersearch.h
+/// \ingroup chemkit
+/// \brief The ConformerSearch class searches for the low energy
+///        conformers of a molecule.
+///
+/// Starting geometries are generated by rotating the rotatable bonds
+/// of the molecule (see rotatableBonds()). The \c Systematic method
+/// rotates each bond through multiples of torsionIncrement() while
+/// the \c Random method sets each bond to a random angle. Each
+/// starting geometry is then minimized with the force field. The
+/// minimizations are distributed over a pool of threads which each
+/// have their own force field.
+///
+/// Two minimized geometries are considered to be the same conformer
+/// if both their energies differ by less than energyThreshold() and
+/// the root mean square deviation of their heavy atoms after
+/// superposition is less than rmsdThreshold(). The search stops
+/// early if convergenceTrialCount() trials in a row have not found a
+/// new conformer.
+///
+/// The trials are minimized in rounds and compared in the order they
+/// were generated so the results do not depend on the number of
+/// threads used.
+///
+/// The unique conformers within energyWindow() of the lowest energy
+/// conformer are added to the molecule with Molecule::addConformer()
+/// in order of increasing energy. The coordinates of the molecule
+/// itself are not changed.
+///
+/// The following example shows how to find the conformers of a
+/// molecule and make the lowest energy conformer active.
+///
+/// \code
+/// ConformerSearch search("mmff", ConformerSearch::Random);
+/// search.setMaximumTrialCount(500);
+///
+/// if(search.search(molecule)){
+///     molecule->setConformer(search.conformer(0));
+/// }
+/// \endcode
+///
+/// \see ForceFieldMinimizer, ForceFieldBatchMinimizer
+
+/// \enum ConformerSearch::Method
+/// Provides the methods used to generate starting geometries:
+///     - \c Systematic
+///     - \c Random
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new conformer search using the force field with
+/// \p name and \p method.
+ConformerSearch::ConformerSearch(const std::string &forceField, Method method)
+    : d(new ConformerSearchPrivate)
+{
+    d->forceField = forceField;
+    d->method = method;
+    d->algorithm = ForceFieldMinimizer::Lbfgs;
+    d->threadCount = 0;
+    d->randomSeed = 5489;
+    d->torsionIncrement = 120;
+    d->maximumTrialCount = 1000;
+    d->convergenceTrialCount = 100;
+    d->maximumStepCount = 1000;
+    d->rmsdThreshold = 0.5;
+    d->energyThreshold = 1.0;
+    d->energyWindow = 10.0;
+    d->maximumConformerCount = 0;
+    d->canceled = 0;
+    d->trialCount = 0;
+    d->failedTrialCount = 0;
+}
+
+/// Destroys the conformer search object. The conformers added to
+/// the molecule are not removed.
+ConformerSearch::~ConformerSearch()
+{
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Sets the name of the force field used to minimize the conformers
+/// to \p name.
+void ConformerSearch::setForceField(const std::string &name)
+{
+    d->forceField = name;
+}
+
+/// Returns the name of the force field used to minimize the
+/// conformers.
+std::string ConformerSearch::forceField() const
+{
+    return d->forceField;
+}
+
+/// Sets the method used to generate starting geometries to
+/// \p method.
+void ConformerSearch::setMethod(Method method)
+{
+    d->method = method;
+}
+
+/// Returns the method used to generate starting geometries.
+ConformerSearch::Method ConformerSearch::method() const
+{
+    return d->method;
+}
+
+/// Sets the minimization algorithm to \p algorithm. The default is
+/// \c Lbfgs.
+void ConformerSearch::setAlgorithm(ForceFieldMinimizer::Algorithm algorithm)
+{
+    d->algorithm = algorithm;
+}
+
+/// Returns the minimization algorithm.
+ForceFieldMinimizer::Algorithm ConformerSearch::algorithm() const
+{
+    return d->algorithm;
+}
+
+/// Sets the number of threads used to minimize the conformers to
+/// \p count. If \p count is \c 0 (the default) the ideal thread
+/// count for the system is used.
+void ConformerSearch::setThreadCount(int count)
+{
+    d->threadCount = qMax(0, count);
+}
+
+/// Returns the number of threads used to minimize the conformers.
+/// Returns \c 0 if the ideal thread count is used.
+int ConformerSearch::threadCount() const
+{
+    return d->threadCount;
+}
+
+/// Returns the number of threads that will be used to minimize the
+/// conformers.
+int ConformerSearch::effectiveThreadCount() const
+{
+    if(d->threadCount == 0){
+        return qMax(1, QThread::idealThreadCount());
+    }
+
+    return d->threadCount;
+}
+
+/// Sets the seed for the random number generator used by the
+/// \c Random method to \p seed.
+void ConformerSearch::setRandomSeed(unsigned int seed)
+{
+    d->randomSeed = seed;
+}
+
+/// Returns the seed for the random number generator.
+unsigned int ConformerSearch::randomSeed() const
+{
+    return d->randomSeed;
+}
+
+// --- Search Parameters --------------------------------------------------- //
+/// Sets the angle (in degrees) each bond is rotated by with the
+/// \c Systematic method to \p angle. The default is 120 degrees.
+void ConformerSearch::setTorsionIncrement(Float angle)
+{
+    d->torsionIncrement = angle;
+}
+
+/// Returns the angle each bond is rotated by with the \c Systematic
+/// method.
+Float ConformerSearch::torsionIncrement() const
+{
+    return d->torsionIncrement;
+}
+
+/// Sets the maximum number of starting geometries to \p count. The
+/// default is \c 1000.
+///
+/// The \c Systematic method stops once every combination of torsion
+/// angles has been tried or after \p count geometries, whichever is
+/// first. Molecules with many rotatable bonds should be searched
+/// with the \c Random method.
+void ConformerSearch::setMaximumTrialCount(int count)
+{
+    d->maximumTrialCount = qMax(1, count);
+}
+
+/// Returns the maximum number of starting geometries.
+int ConformerSearch::maximumTrialCount() const
+{
+    return d->maximumTrialCount;
+}
+
+/// Sets the number of consecutive trials that must fail to find a
+/// new conformer for the search to stop early to \p count. If
+/// \p count is \c 0 the search does not stop early. The default is
+/// \c 100.
+void ConformerSearch::setConvergenceTrialCount(int count)
+{
+    d->convergenceTrialCount = qMax(0, count);
+}
+
+/// Returns the number of consecutive trials that must fail to find
+/// a new conformer for the search to stop early.
+int ConformerSearch::convergenceTrialCount() const
+{
+    return d->convergenceTrialCount;
+}
+
+/// Sets the maximum number of minimization steps for each trial to
+/// \p count.
+///
+/// \see ForceFieldMinimizer::setMaximumStepCount()
+void ConformerSearch::setMaximumStepCount(int count)
+{
+    d->maximumStepCount = count;
+}
+
+/// Returns the maximum number of minimization steps for each trial.
+int ConformerSearch::maximumStepCount() const
+{
+    return d->maximumStepCount;
+}
+
+// --- Duplicate Removal --------------------------------------------------- //
+/// Sets the root mean square deviation (in angstroms) below which
+/// two conformers with similar energies are considered the same to
+/// \p threshold. The default is \c 0.5.
+void ConformerSearch::setRmsdThreshold(Float threshold)
+{
+    d->rmsdThreshold = threshold;
+}
+
+/// Returns the root mean square deviation threshold.
+Float ConformerSearch::rmsdThreshold() const
+{
+    return d->rmsdThreshold;
+}
+
+/// Sets the energy difference (in kcal/mol) below which two
+/// conformers with similar geometries are considered the same to
+/// \p threshold. The default is \c 1.0.
+void ConformerSearch::setEnergyThreshold(Float threshold)
+{
+    d->energyThreshold = threshold;
+}
+
+/// Returns the energy threshold.
+Float ConformerSearch::energyThreshold() const
+{
+    return d->energyThreshold;
+}
+
+/// Sets the energy window (in kcal/mol) to \p window. Conformers
+/// with an energy more than \p window above the lowest energy
+/// conformer are discarded. The default is \c 10.
+void ConformerSearch::setEnergyWindow(Float window)
+{
+    d->energyWindow = window;
+}
+
+/// Returns the energy window.
+Float ConformerSearch::energyWindow() const
+{
+    return d->energyWindow;
+}
+
+/// Sets the maximum number of conformers added to the molecule to
+/// \p count. If \p count is \c 0 (the default) every conformer
+/// within the energy window is added.
+void ConformerSearch::setMaximumConformerCount(int count)
+{
+    d->maximumConformerCount = qMax(0, count);
+}
+
+/// Returns the maximum number of conformers added to the molecule.
+int ConformerSearch::maximumConformerCount() const
+{
+    return d->maximumConformerCount;
+}
+
+// --- Search -------------------------------------------------------------- //
+/// Searches for the conformers of \p molecule and adds them to the
+/// molecule. Returns \c false if the force field could not be setup
+/// for the molecule or the search was canceled.
+bool ConformerSearch::search(Molecule *molecule)
+{
+    // trials are minimized in rounds of this size and then compared
+    // in order so that the results do not depend on the thread count
+    const int roundSize = 32;
+
+    d->errorString.clear();
+    d->conformers.clear();
+    d->energies.clear();
+    d->trialCount = 0;
+    d->failedTrialCount = 0;
+    d->canceled = 0;
+
+    if(!molecule || molecule->isEmpty()){
+        d->errorString = "Molecule is empty.";
+        return false;
+    }
+
+    // find the rotatable bonds and the atoms moved by each of them
+    std::vector<RotatableTorsion> torsions;
+    foreach(const Bond *bond, rotatableBonds(molecule)){
+        RotatableTorsion torsion;
+        torsion.atom1 = bond->atom1()->index();
+        torsion.atom2 = bond->atom2()->index();
+        torsion.movingAtoms = bondSide(bond);
+
+        // rotate the smaller side of the bond
+        if(2 * static_cast<int>(torsion.movingAtoms.size()) > molecule->size()){
+            std::swap(torsion.atom1, torsion.atom2);
+
+            std::vector<bool> moving(molecule->size());
+            foreach(int index, torsion.movingAtoms){
+                moving[index] = true;
+            }
+
+            torsion.movingAtoms.clear();
+            for(int i = 0; i < molecule->size(); i++){
+                if(!moving[i]){
+                    torsion.movingAtoms.push_back(i);
+                }
+            }
+        }
+
+        torsions.push_back(torsion);
+    }
+
+    // compare conformers using their heavy atoms
+    std::vector<int> comparedAtoms;
+    foreach(const Atom *atom, molecule->atoms()){
+        if(!atom->is(Atom::Hydrogen)){
+            comparedAtoms.push_back(atom->index());
+        }
+    }
+    if(comparedAtoms.empty()){
+        for(int i = 0; i < molecule->size(); i++){
+            comparedAtoms.push_back(i);
+        }
+    }
+
+    std::vector<Point3> initialPositions;
+    foreach(const Atom *atom, molecule->atoms()){
+        initialPositions.push_back(atom->position());
+    }
+
+    // number of starting geometries
+    int angleCount = qMax(1, qRound(360.0 / d->torsionIncrement));
+    int totalTrialCount = d->maximumTrialCount;
+    if(torsions.empty()){
+        totalTrialCount = 1;
+    }
+    else if(d->method == Systematic){
+        Float combinationCount = std::pow(Float(angleCount), Float(torsions.size()));
+        totalTrialCount = static_cast<int>(qMin(combinationCount, Float(totalTrialCount)));
+    }
+
+    // create the workspaces in this thread so that the plugins and
+    // force field parameters are loaded before the threads start
+    int workspaceCount = qMin(effectiveThreadCount(), qMin(roundSize, totalTrialCount));
+    std::vector<ConformerSearchWorkspace> workspaces;
+
+    for(int i = 0; i < workspaceCount; i++){
+        ForceField *forceField = ForceField::create(d->forceField);
+        if(!forceField){
+            d->errorString = "Force field '" + d->forceField + "' is not supported.";
+            break;
+        }
+
+        forceField->setThreadCount(1);
+        forceField->addMolecule(molecule);
+        if(!forceField->setup()){
+            d->errorString = "Failed to setup force field: " + forceField->errorString();
+            delete forceField;
+            break;
+        }
+
+        ConformerSearchWorkspace workspace;
+        workspace.search = d;
+        workspace.forceField = forceField;
+        workspace.minimizer = new ForceFieldMinimizer(forceField, d->algorithm);
+        workspace.minimizer->setMaximumStepCount(d->maximumStepCount);
+        foreach(const ForceFieldAtom *atom, forceField->atoms()){
+            workspace.atomIndices.push_back(atom->atom()->index());
+        }
+        workspaces.push_back(workspace);
+    }
+
+    boost::mt19937 generator(d->randomSeed);
+    boost::variate_generator<boost::mt19937&, boost::uniform_real<Float> >
+        randomAngle(generator, boost::uniform_real<Float>(0, 360));
+
+    // unique minima found so far
+    std::vector<ConformerTrial> minima;
+    int trialsWithoutNewMinimum = 0;
+    bool converged = false;
+
+    for(int first = 0; d->errorString.empty() && !converged && first < totalTrialCount; first += roundSize){
+        // generate the starting geometries for this round
+        int count = qMin(roundSize, totalTrialCount - first);
+        d->trials.resize(count);
+
+        for(int i = 0; i < count; i++){
+            int trial = first + i;
+
+            ConformerTrial &conformerTrial = d->trials[i];
+            conformerTrial.positions = initialPositions;
+            conformerTrial.status = ForceFieldMinimizer::Canceled;
+            conformerTrial.energy = 0;
+
+            // the first trial always starts from the initial geometry
+            if(trial == 0){
+                continue;
+            }
+
+            int digits = trial;
+            foreach(const RotatableTorsion &torsion, torsions){
+                Float angle;
+
+                if(d->method == Systematic){
+                    angle = (digits % angleCount) * d->torsionIncrement;
+                    digits /= angleCount;
+                }
+                else{
+                    angle = randomAngle();
+                }
+
+                rotateTorsion(conformerTrial.positions, torsion, angle);
+            }
+        }
+
+        // minimize them
+        d->nextTrial = 0;
+        if(workspaces.size() == 1){
+            minimizeWorkspaceTrials(workspaces[0]);
+        }
+        else{
+            QtConcurrent::blockingMap(workspaces, minimizeWorkspaceTrials);
+        }
+
+        if(d->canceled){
+            break;
+        }
+
+        // compare each minimized geometry with the minima found so far
+        foreach(const ConformerTrial &trial, d->trials){
+            d->trialCount++;
+
+            if(trial.status == ForceFieldMinimizer::Failed || qIsNaN(trial.energy) || qIsInf(trial.energy)){
+                d->failedTrialCount++;
+                trialsWithoutNewMinimum++;
+            }
+            else{
+                bool duplicate = false;
+
+                for(unsigned int i = 0; i < minima.size(); i++){
+                    if(qAbs(minima[i].energy - trial.energy) < d->energyThreshold &&
+                       superposedRmsd(minima[i].positions, trial.positions, comparedAtoms) < d->rmsdThreshold){
+                        // keep the lower energy geometry
+                        if(trial.energy < minima[i].energy){
+                            minima[i] = trial;
+                        }
+
+                        duplicate = true;
+                        break;
+                    }
+                }
+
+                if(duplicate){
+                    trialsWithoutNewMinimum++;
+                }
+                else{
+                    minima.push_back(trial);
+                    trialsWithoutNewMinimum = 0;
+                }
+            }
+
+            if(d->convergenceTrialCount > 0 && trialsWithoutNewMinimum >= d->convergenceTrialCount){
+                converged = true;
+                break;
+            }
+        }
+    }
+
+    foreach(const ConformerSearchWorkspace &workspace, workspaces){
+        delete workspace.minimizer;
+        delete workspace.forceField;
+    }
+
+    d->trials.clear();
+
+    if(!d->errorString.empty()){
+        return false;
+    }
+
+    if(d->canceled){
+        d->errorString = "Search was canceled.";
+        return false;
+    }
+
+    // add the conformers within the energy window in order of energy
+    std::vector<const ConformerTrial *> sortedMinima;
+    for(unsigned int i = 0; i < minima.size(); i++){
+        sortedMinima.push_back(&minima[i]);
+    }
+    std::stable_sort(sortedMinima.begin(), sortedMinima.end(), compareTrialEnergies);
+
+    foreach(const ConformerTrial *minimum, sortedMinima){
+        if(minimum->energy > sortedMinima[0]->energy + d->energyWindow){
+            break;
+        }
+        else if(d->maximumConformerCount > 0 && conformerCount() == d->maximumConformerCount){
+            break;
+        }
+
+        Conformer *conformer = molecule->addConformer();
+        foreach(const Atom *atom, molecule->atoms()){
+            conformer->setPosition(atom, minimum->positions[atom->index()]);
+        }
+
+        d->conformers.push_back(conformer);
+        d->energies.push_back(minimum->energy);
+    }
+
+    return true;
+}
+
+/// Cancels the search. This method may be called from any thread.
+void ConformerSearch::cancel()
+{
+    d->canceled = 1;
+}
+
+/// Returns \c true if the search was canceled.
+bool ConformerSearch::isCanceled() const
+{
+    return d->canceled;
+}
+
+// --- Results ------------------------------------------------------------- //
+/// Returns the conformers found by the last search in order of
+/// increasing energy.
+std::vector<Conformer *> ConformerSearch::conformers() const
+{
+    return d->conformers;
+}
+
+/// Returns the conformer at \p index.
+Conformer* ConformerSearch::conformer(int index) const
+{
+    return d->conformers[index];
+}
+
+/// Returns the number of conformers found by the last search.
+int ConformerSearch::conformerCount() const
+{
+    return d->conformers.size();
+}
+
+/// Returns the energy of the conformer at \p index in kcal/mol.
+Float ConformerSearch::energy(int index) const
+{
+    return d->energies[index];
+}
+
+/// Returns the number of starting geometries minimized by the last
+/// search.
+int ConformerSearch::trialCount() const
+{
+    return d->trialCount;
+}
+
+/// Returns the number of starting geometries whose minimization
+/// failed in the last search.
+int ConformerSearch::failedTrialCount() const
+{
+    return d->failedTrialCount;
+}
+
+// --- Error Handling ------------------------------------------------------ //
+/// Returns a string describing the last error that occurred.
+std::string ConformerSearch::errorString() const
+{
+    return d->errorString;
+}
+
+// --- Static Methods ------------------------------------------------------ //
+/// Returns a list of the rotatable bonds in \p molecule.
+///
+/// \see Bond::isRotatable()
+std::vector<Bond *> ConformerSearch::rotatableBonds(const Molecule *molecule)
+{
+    std::vector<Bond *> bonds;
+
+    foreach(Bond *bond, molecule->bonds()){
+        if(bond->isRotatable()){
+            bonds.push_back(bond);
+        }
+    }
+
+    return bonds;
+}
+
+} // end chemkit namespace
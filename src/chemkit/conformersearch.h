@@ -0,0 +1,125 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#ifndef CHEMKIT_CONFORMERSEARCH_H
+#define CHEMKIT_CONFORMERSEARCH_H
+
+#include "chemkit.h"
+
+#include <string>
+#include <vector>
+
+#include "forcefieldminimizer.h"
+
+namespace chemkit {
+
+class Bond;
+class Molecule;
+class Conformer;
+class ConformerSearchPrivate;
+
+class CHEMKIT_EXPORT ConformerSearch
+{
+    public:
+        // enumerations
+        enum Method {
+            Systematic,
+            Random
+        };
+
+        // construction and destruction
+        ConformerSearch(const std::string &forceField = "uff", Method method = Systematic);
+        ~ConformerSearch();
+
+        // properties
+        void setForceField(const std::string &name);
+        std::string forceField() const;
+        void setMethod(Method method);
+        Method method() const;
+        void setAlgorithm(ForceFieldMinimizer::Algorithm algorithm);
+        ForceFieldMinimizer::Algorithm algorithm() const;
+        void setThreadCount(int count);
+        int threadCount() const;
+        int effectiveThreadCount() const;
+        void setRandomSeed(unsigned int seed);
+        unsigned int randomSeed() const;
+
+        // search parameters
+        void setTorsionIncrement(Float angle);
+        Float torsionIncrement() const;
+        void setMaximumTrialCount(int count);
+        int maximumTrialCount() const;
+        void setConvergenceTrialCount(int count);
+        int convergenceTrialCount() const;
+        void setMaximumStepCount(int count);
+        int maximumStepCount() const;
+
+        // duplicate removal
+        void setRmsdThreshold(Float threshold);
+        Float rmsdThreshold() const;
+        void setEnergyThreshold(Float threshold);
+        Float energyThreshold() const;
+        void setEnergyWindow(Float window);
+        Float energyWindow() const;
+        void setMaximumConformerCount(int count);
+        int maximumConformerCount() const;
+
+        // search
+        bool search(Molecule *molecule);
+        void cancel();
+        bool isCanceled() const;
+
+        // results
+        std::vector<Conformer *> conformers() const;
+        Conformer* conformer(int index) const;
+        int conformerCount() const;
+        Float energy(int index) const;
+        int trialCount() const;
+        int failedTrialCount() const;
+
+        // error handling
+        std::string errorString() const;
+
+        // static methods
+        static std::vector<Bond *> rotatableBonds(const Molecule *molecule);
+
+    private:
+        ConformerSearchPrivate* const d;
+};
+
+} // end chemkit namespace
+
+#endif // CHEMKIT_CONFORMERSEARCH_H
@@ -35,30 +35,462 @@
 
 #include "forcefield.h"
 
+#include <map>
+#include <algorithm>
+
 #include "atom.h"
+#include "bond.h"
 #include "foreach.h"
 #include "molecule.h"
+#include "unitcell.h"
 #include "constants.h"
+#include "conformer.h"
 #include "pluginmanager.h"
+#include "neighborlist.h"
 #include "forcefieldatom.h"
+#include "generalizedborn.h"
+#include "particlemeshewald.h"
+#include "forcefieldprofile.h"
+#include "forcefieldminimizer.h"
 #include "forcefieldcalculation.h"
 
 namespace chemkit {
 
 namespace {
 
-Float mapEnergy(const ForceFieldCalculation *calculation)
+// Coulomb constant in (kcal * angstrom) / (mol * e^2).
+const Float CoulombConstant = 332.0716;
+
+// Replaces matrix with the average of itself and its transpose.
+void symmetrize(Matrix &matrix)
+{
+    for(int i = 0; i < matrix.rowCount(); i++){
+        for(int j = i + 1; j < matrix.columnCount(); j++){
+            Float value = 0.5 * (matrix(i, j) + matrix(j, i));
+            matrix(i, j) = value;
+            matrix(j, i) = value;
+        }
+    }
+}
+
+// The ProfileTimer class measures the time spent in each part of a
+// profiled energy or gradient evaluation in milliseconds. Qt 4.8 and
+// later provide a nanosecond timer while with older versions the
+// time is only measured to the nearest millisecond.
+class ProfileTimer
+{
+    public:
+        void start()
+        {
+            m_timer.start();
+        }
+
+        Float elapsed() const
+        {
+#if QT_VERSION >= 0x040800
+            return m_timer.nsecsElapsed() * 1.0e-6;
+#else
+            return m_timer.elapsed();
+#endif
+        }
+
+    private:
+#if QT_VERSION >= 0x040700
+        QElapsedTimer m_timer;
+#else
+        QTime m_timer;
+#endif
+};
+
+// The ForceFieldChunk class contains a contiguous range of
+// calculations along with the partial energy and gradient
+// accumulated for them by a single thread.
+class ForceFieldChunk
+{
+    public:
+        const ForceFieldCalculation * const *begin;
+        const ForceFieldCalculation * const *end;
+        Float energy;
+        std::vector<Vector3> gradient;
+        std::vector<Vector3> *sharedGradient;
+        QMutex *sharedGradientMutex;
+};
+
+void calculateChunkEnergy(ForceFieldChunk &chunk)
+{
+    Float energy = 0;
+
+    for(const ForceFieldCalculation * const *i = chunk.begin; i != chunk.end; ++i){
+        energy += (*i)->energy();
+    }
+
+    chunk.energy = energy;
+}
+
+void calculateChunkGradient(ForceFieldChunk &chunk)
+{
+    std::vector<Vector3> &gradient = chunk.gradient;
+
+    for(const ForceFieldCalculation * const *i = chunk.begin; i != chunk.end; ++i){
+        const ForceFieldCalculation *calculation = *i;
+        std::vector<Vector3> atomGradients = calculation->gradient();
+
+        for(unsigned int j = 0; j < atomGradients.size(); j++){
+            gradient[calculation->atom(j)->index()] += atomGradients[j];
+        }
+    }
+
+    // with an unordered reduction each thread adds its buffer to the
+    // result as soon as it finishes instead of waiting for the others
+    if(chunk.sharedGradient){
+        QMutexLocker locker(chunk.sharedGradientMutex);
+
+        for(unsigned int j = 0; j < gradient.size(); j++){
+            (*chunk.sharedGradient)[j] += gradient[j];
+        }
+    }
+}
+
+// Returns the numerical gradient of the energy with respect to the
+// position of atom.
+Vector3 numericalAtomGradient(ForceFieldAtom *atom, ForceField::NumericalGradientMethod method)
+{
+    const Point3 position = atom->position();
+    Vector3 gradient;
+
+    if(method == ForceField::CentralDifference){
+        const Float epsilon = 1.0e-5;
+
+        for(int i = 0; i < 3; i++){
+            Point3 forward = position;
+            forward[i] += epsilon;
+            atom->setPosition(forward);
+            Float eF = atom->energy();
+
+            Point3 backward = position;
+            backward[i] -= epsilon;
+            atom->setPosition(backward);
+            Float eB = atom->energy();
+
+            gradient[i] = (eF - eB) / (2 * epsilon);
+        }
+    }
+    else{
+        const Float epsilon = 1.0e-10;
+
+        // initial energy
+        Float eI = atom->energy();
+
+        for(int i = 0; i < 3; i++){
+            Point3 forward = position;
+            forward[i] += epsilon;
+            atom->setPosition(forward);
+            Float eF = atom->energy();
+
+            gradient[i] = (eF - eI) / epsilon;
+        }
+    }
+
+    // restore initial position
+    atom->setPosition(position);
+
+    return gradient;
+}
+
+// The NumericalGradientChunk class contains a group of atoms which
+// do not share any calculations and can therefore be displaced at
+// the same time.
+class NumericalGradientChunk
+{
+    public:
+        std::vector<ForceFieldAtom *> atoms;
+        std::vector<int> indices;
+        ForceField::NumericalGradientMethod method;
+        std::vector<Vector3> *gradient;
+};
+
+void calculateChunkNumericalGradient(NumericalGradientChunk &chunk)
+{
+    for(unsigned int i = 0; i < chunk.atoms.size(); i++){
+        (*chunk.gradient)[chunk.indices[i]] = numericalAtomGradient(chunk.atoms[i], chunk.method);
+    }
+}
+
+// Returns the position of the periodic image of atom closest to
+// reference or the position of atom if cell is null.
+Point3 imagePosition(const UnitCell *cell, const ForceFieldAtom *atom, const Point3 &reference)
 {
-    return calculation->energy();
+    if(!cell){
+        return atom->position();
+    }
+
+    return cell->image(atom->position(), reference);
 }
 
-void reduceEnergy(Float &result, const Float &energy)
+// The PositionRestraint class restrains an atom to a fixed position
+// with a harmonic potential: E = k * |r - r0|^2.
+class PositionRestraint : public ForceFieldCalculation
+{
+    public:
+        PositionRestraint(const ForceFieldAtom *atom, const Point3 &position, Float forceConstant)
+            : ForceFieldCalculation(Restraint, 1, 4)
+        {
+            setAtom(0, atom);
+            setParameter(0, position.x());
+            setParameter(1, position.y());
+            setParameter(2, position.z());
+            setParameter(3, forceConstant);
+        }
+
+        Float energy() const
+        {
+            Vector3 displacement = position(atom(0)) - Point3(parameter(0), parameter(1), parameter(2));
+
+            return parameter(3) * displacement.lengthSquared();
+        }
+
+        std::vector<Vector3> gradient() const
+        {
+            Vector3 displacement = position(atom(0)) - Point3(parameter(0), parameter(1), parameter(2));
+
+            return std::vector<Vector3>(1, displacement * (2 * parameter(3)));
+        }
+
+        Matrix hessian() const
+        {
+            Matrix hessian(3, 3);
+            for(int i = 0; i < 3; i++){
+                hessian(i, i) = 2 * parameter(3);
+            }
+
+            return hessian;
+        }
+};
+
+// The DistanceRestraint class restrains the distance between two
+// atoms with a harmonic potential: E = k * (r - r0)^2.
+class DistanceRestraint : public ForceFieldCalculation
+{
+    public:
+        DistanceRestraint(const ForceFieldAtom *a, const ForceFieldAtom *b, Float distance, Float forceConstant)
+            : ForceFieldCalculation(Restraint, 2, 2)
+        {
+            setAtom(0, a);
+            setAtom(1, b);
+            setParameter(0, distance);
+            setParameter(1, forceConstant);
+        }
+
+        Float energy() const
+        {
+            Float dr = distance(atom(0), atom(1)) - parameter(0);
+
+            return parameter(1) * dr * dr;
+        }
+
+        std::vector<Vector3> gradient() const
+        {
+            Float dr = distance(atom(0), atom(1)) - parameter(0);
+            Float de_dr = 2 * parameter(1) * dr;
+
+            std::vector<Vector3> gradient = distanceGradient(atom(0), atom(1));
+            gradient[0] *= de_dr;
+            gradient[1] *= de_dr;
+
+            return gradient;
+        }
+
+        Matrix hessian() const
+        {
+            Float dr = distance(atom(0), atom(1)) - parameter(0);
+
+            return distanceHessian(atom(0), atom(1), 2 * parameter(1) * dr, 2 * parameter(1));
+        }
+};
+
+// The ElectrostaticPairParameters class contains the constants used
+// to calculate the interactions between pairs of charges with the
+// electrostatics method.
+class ElectrostaticPairParameters
+{
+    public:
+        ForceField::ElectrostaticsMethod method;
+        Float cutoff;
+        Float alpha;
+        Float reactionFieldK;
+        Float reactionFieldC;
+        Float shiftedEnergy;
+        Float shiftedForce;
+};
+
+// Returns the energy of the pairs of charges within the cutoff (and
+// for particle mesh Ewald the correction for the excluded pairs) and
+// adds its gradient to gradient if it is not null. Neither is scaled
+// by the Coulomb constant.
+//
+// The positions, charges and the gradient of each atom are stored
+// and accumulated with the scalar type T which is either float or
+// double. The energy is always summed in double precision.
+template<typename T>
+Float electrostaticPairEnergy(const std::vector<Point3> &positions,
+                              const std::vector<Float> &charges,
+                              const NeighborList &neighborList,
+                              const std::vector<std::vector<int> > &exclusions,
+                              const UnitCell *unitCell,
+                              const ElectrostaticPairParameters &parameters,
+                              std::vector<Vector3> *gradient)
 {
-    result += energy;
+    const int count = positions.size();
+
+    const std::vector<GenericPoint<T> > points(positions.begin(), positions.end());
+    const std::vector<T> pointCharges(charges.begin(), charges.end());
+
+    std::vector<GenericVector<T> > pairGradient;
+    if(gradient){
+        pairGradient.assign(count, GenericVector<T>());
+    }
+
+    const ForceField::ElectrostaticsMethod method = parameters.method;
+    const T cutoff = parameters.cutoff;
+    const T alpha = parameters.alpha;
+    const T alphaSquared = alpha * alpha;
+    const T twoAlphaOverRootPi = 2.0 * parameters.alpha / std::sqrt(constants::Pi);
+    const T reactionFieldK = parameters.reactionFieldK;
+    const T reactionFieldC = parameters.reactionFieldC;
+    const T shiftedEnergy = parameters.shiftedEnergy;
+    const T shiftedForce = parameters.shiftedForce;
+
+    double energy = 0;
+
+    for(int i = 0; i < count; i++){
+        const T qi = pointCharges[i];
+        if(qi == 0){
+            continue;
+        }
+
+        const std::vector<int> &atomExclusions = exclusions[i];
+
+        for(int k = 0; k < neighborList.neighborCount(i); k++){
+            int j = neighborList.neighbor(i, k);
+
+            const T qiqj = qi * pointCharges[j];
+            if(qiqj == 0 || std::binary_search(atomExclusions.begin(), atomExclusions.end(), j)){
+                continue;
+            }
+
+            GenericVector<T> vector = points[j] - points[i];
+            if(unitCell){
+                vector = unitCell->minimumImage(Vector3(vector));
+            }
+
+            T r = vector.length();
+            T e;
+            T de_dr;
+
+            if(method == ForceField::ParticleMeshEwald){
+                e = erfc(alpha * r) / r;
+                de_dr = -(e + twoAlphaOverRootPi * std::exp(-alphaSquared * r * r)) / r;
+            }
+            else if(method == ForceField::ReactionField){
+                e = T(1) / r + reactionFieldK * r * r - reactionFieldC;
+                de_dr = T(-1) / (r * r) + 2 * reactionFieldK * r;
+            }
+            else{
+                T screened = erfc(alpha * r) / r;
+                e = screened - shiftedEnergy + shiftedForce * (r - cutoff);
+                de_dr = -(screened + twoAlphaOverRootPi * std::exp(-alphaSquared * r * r)) / r + shiftedForce;
+            }
+
+            energy += qiqj * e;
+
+            if(gradient){
+                GenericVector<T> force = vector * (qiqj * de_dr / r);
+
+                pairGradient[i] -= force;
+                pairGradient[j] += force;
+            }
+        }
+    }
+
+    // remove the screened interactions of the excluded pairs which
+    // are included in the reciprocal space sum
+    if(method == ForceField::ParticleMeshEwald){
+        for(int i = 0; i < count; i++){
+            const T qi = pointCharges[i];
+            if(qi == 0){
+                continue;
+            }
+
+            foreach(int j, exclusions[i]){
+                const T qiqj = qi * pointCharges[j];
+                if(qiqj == 0){
+                    continue;
+                }
+
+                GenericVector<T> vector = unitCell->minimumImage(Vector3(points[j] - points[i]));
+                T r = vector.length();
+                T screened = erf(alpha * r) / r;
+
+                energy -= qiqj * screened;
+
+                if(gradient){
+                    T de_dr = -qiqj * (twoAlphaOverRootPi * std::exp(-alphaSquared * r * r) - screened) / r;
+                    GenericVector<T> force = vector * (de_dr / r);
+
+                    pairGradient[i] -= force;
+                    pairGradient[j] += force;
+                }
+            }
+        }
+    }
+
+    if(gradient){
+        for(int i = 0; i < count; i++){
+            (*gradient)[i] += Vector3(pairGradient[i]);
+        }
+    }
+
+    return energy;
 }
 
 } // end anonymous namespace
 
+// The ForceFieldSetupChunk class contains the molecules or the
+// contiguous range of calculations set up by a single thread.
+class ForceFieldSetupChunk
+{
+    public:
+        ForceField *forceField;
+        bool ok;
+
+        // molecule setup
+        std::vector<int> molecules;
+        const std::vector<const Molecule *> *moleculeList;
+        std::vector<std::vector<ForceFieldAtom *> > *atoms;
+        std::vector<std::vector<ForceFieldCalculation *> > *calculations;
+
+        // calculation setup
+        ForceFieldCalculation * const *begin;
+        ForceFieldCalculation * const *end;
+};
+
+// The ForceFieldEnsembleChunk class contains a contiguous range of
+// calculations which a single thread evaluates for every conformer
+// in an ensemble along with the partial energy (and gradient) of
+// each conformer accumulated for them.
+class ForceFieldEnsembleChunk
+{
+    public:
+        ForceFieldCalculation * const *begin;
+        ForceFieldCalculation * const *end;
+        const Point3 *coordinates;
+        int atomCount;
+        int conformerCount;
+        bool calculateGradients;
+        std::vector<Float> energies;
+        std::vector<Vector3> gradients;
+};
+
 // === ForceFieldPrivate =================================================== //
 class ForceFieldPrivate
 {
@@ -72,239 +504,1671 @@ class ForceFieldPrivate
         std::string parameterFile;
         std::map<std::string, std::string> parameterSets;
         std::string errorString;
+        int threadCount;
+        bool deterministicReduction;
+        bool topologyTemplatesEnabled;
+        const UnitCell *unitCell;
+        QHash<const ForceFieldAtom *, int> atomIndices;
+        QHash<const Atom *, ForceFieldAtom *> forceFieldAtoms;
+        ForceFieldMinimizer *minimizer;
+        ForceField::NumericalGradientMethod numericalGradientMethod;
+        bool atomCalculationsValid;
+        std::vector<std::vector<ForceFieldCalculation *> > atomCalculations;
+        std::vector<std::vector<int> > independentAtomSets;
+        QMutex atomCalculationsMutex;
+        std::vector<ForceFieldAtom *> trialMoveAtoms;
+        std::vector<Point3> trialMoveInitialPositions;
+        ForceField::ElectrostaticsMethod electrostaticsMethod;
+        Float electrostaticsCutoff;
+        Float ewaldTolerance;
+        Float reactionFieldDielectric;
+        Float electrostaticsDamping;
+        ForceField::ElectrostaticsPrecision electrostaticsPrecision;
+        ParticleMeshEwald particleMeshEwald;
+        NeighborList neighborList;
+        bool electrostaticsValid;
+        std::vector<ForceFieldCalculation *> electrostaticsCalculations;
+        std::vector<std::vector<int> > electrostaticExclusions;
+        QMutex electrostaticsMutex;
+        bool implicitSolventEnabled;
+        bool implicitSolventValid;
+        GeneralizedBorn generalizedBorn;
+        QMutex implicitSolventMutex;
+        std::vector<ForceFieldCalculation *> restraints;
+        bool frozenValid;
+        int frozenAtomCount;
+        Float frozenEnergy;
+        std::vector<ForceFieldCalculation *> mobileCalculations;
+        QMutex frozenMutex;
+        bool profilingEnabled;
+        ForceFieldProfile profile;
+        QMutex ensembleMutex;
+
+        std::vector<ForceFieldChunk> chunks(const std::vector<ForceFieldCalculation *> &calculations, int threadCount) const;
+        Float calculationEnergy(const std::vector<ForceFieldCalculation *> &calculations, int threadCount) const;
+        void calculationGradient(const std::vector<ForceFieldCalculation *> &calculations, int threadCount, std::vector<Vector3> &gradient) const;
+        Float profiledEnergy(const std::vector<ForceFieldCalculation *> &calculations, int threadCount);
+        void profiledGradient(const std::vector<ForceFieldCalculation *> &calculations, int threadCount, std::vector<Vector3> &gradient);
+        void updateAtomCalculations();
+        bool electrostaticsEnabled() const;
+        const std::vector<ForceFieldCalculation *>& evaluatedCalculations();
+        void updateElectrostatics();
+        bool isReplacedByElectrostatics(const ForceFieldCalculation *calculation) const;
+        Float electrostaticEnergy(std::vector<Vector3> *gradient);
+        void updateImplicitSolvent();
+        Float solvationEnergy(std::vector<Vector3> *gradient);
+        bool globalTermsEnabled() const;
+        Float globalEnergy(std::vector<Vector3> *gradient);
+        void updateFrozenCalculations(const std::vector<ForceFieldCalculation *> &calculations);
+        void clearFrozenGradients(std::vector<Vector3> &gradient) const;
+
+        static void setupMoleculeChunk(ForceFieldSetupChunk &chunk);
+        static void setupCalculationChunk(ForceFieldSetupChunk &chunk);
+        static void calculateEnsembleChunk(ForceFieldEnsembleChunk &chunk);
 };
 
-// === ForceField ========================================================== //
-/// \class ForceField forcefield.h chemkit/forcefield.h
-/// \ingroup chemkit
-/// \brief The ForceField class provides a generic interface to
-///        molecular mechanics force fields.
-///
-/// The following force fields are supported in chemkit:
-///     - \c amber
-///     - \c mmff
-///     - \c opls
-///     - \c uff
-///
-/// The following example shows how to calculate the energy of a
-/// molecule using the uff force field.
-///
-/// \code
-/// // create the uff force field
-/// ForceField *forceField = ForceField::create("uff");
-///
-/// // add the molecule to the force field
-/// forceField->addMolecule(molecule);
-///
-/// // setup the force field
-/// forceField->setup();
-///
-/// // calculate the total energy
-/// Float energy = forceField->energy();
-/// \endcode
+// Partitions the calculations into (at most) threadCount contiguous
+// chunks of roughly equal size.
+std::vector<ForceFieldChunk> ForceFieldPrivate::chunks(const std::vector<ForceFieldCalculation *> &calculations, int threadCount) const
+{
+    std::vector<ForceFieldChunk> chunks;
+
+    int calculationCount = calculations.size();
+    int chunkCount = qMin(threadCount, calculationCount);
+    if(chunkCount < 1){
+        return chunks;
+    }
+
+    const ForceFieldCalculation * const *first = &calculations[0];
+
+    for(int i = 0; i < chunkCount; i++){
+        ForceFieldChunk chunk;
+        chunk.begin = first + (static_cast<qint64>(calculationCount) * i) / chunkCount;
+        chunk.end = first + (static_cast<qint64>(calculationCount) * (i + 1)) / chunkCount;
+        chunk.energy = 0;
+        chunk.sharedGradient = 0;
+        chunk.sharedGradientMutex = 0;
+        chunks.push_back(chunk);
+    }
+
+    return chunks;
+}
+
+// Returns the total energy of the calculations.
+Float ForceFieldPrivate::calculationEnergy(const std::vector<ForceFieldCalculation *> &calculations, int threadCount) const
+{
+    const unsigned int parallelThreshold = 5000;
+
+    Float energy = 0;
+
+    if(threadCount == 1 || calculations.size() < parallelThreshold){
+        // calculate energy sequentially
+        foreach(const ForceFieldCalculation *calculation, calculations){
+            energy += calculation->energy();
+        }
+    }
+    else{
+        // calculate energy in parallel
+        std::vector<ForceFieldChunk> chunks = this->chunks(calculations, threadCount);
+        QtConcurrent::blockingMap(chunks, calculateChunkEnergy);
+
+        // sum partial energies in chunk order
+        foreach(const ForceFieldChunk &chunk, chunks){
+            energy += chunk.energy;
+        }
+    }
+
+    return energy;
+}
+
+// Adds the gradient of the calculations to gradient.
+void ForceFieldPrivate::calculationGradient(const std::vector<ForceFieldCalculation *> &calculations, int threadCount, std::vector<Vector3> &gradient) const
+{
+    const unsigned int parallelThreshold = 1000;
+
+    if(threadCount == 1 || calculations.size() < parallelThreshold){
+        // calculate gradient sequentially
+        std::vector<ForceFieldChunk> chunks = this->chunks(calculations, 1);
+        if(!chunks.empty()){
+            chunks[0].gradient.swap(gradient);
+            calculateChunkGradient(chunks[0]);
+            chunks[0].gradient.swap(gradient);
+        }
+    }
+    else{
+        // calculate gradient in parallel
+        QMutex gradientMutex;
+
+        std::vector<ForceFieldChunk> chunks = this->chunks(calculations, threadCount);
+        for(unsigned int i = 0; i < chunks.size(); i++){
+            chunks[i].gradient.resize(gradient.size());
+
+            if(!deterministicReduction){
+                chunks[i].sharedGradient = &gradient;
+                chunks[i].sharedGradientMutex = &gradientMutex;
+            }
+        }
+
+        QtConcurrent::blockingMap(chunks, calculateChunkGradient);
+
+        if(deterministicReduction){
+            // sum per-thread gradients in chunk order
+            foreach(const ForceFieldChunk &chunk, chunks){
+                for(unsigned int i = 0; i < gradient.size(); i++){
+                    gradient[i] += chunk.gradient[i];
+                }
+            }
+        }
+    }
+}
+
+// Calculates the energy one calculation type at a time and records
+// the energy and time for each type in the profile.
+Float ForceFieldPrivate::profiledEnergy(const std::vector<ForceFieldCalculation *> &calculations, int threadCount)
+{
+    typedef std::map<int, std::vector<ForceFieldCalculation *> > CalculationTypeMap;
+
+    CalculationTypeMap types;
+    foreach(ForceFieldCalculation *calculation, calculations){
+        types[calculation->type()].push_back(calculation);
+    }
+
+    ProfileTimer timer;
+    Float energy = 0;
+
+    for(CalculationTypeMap::const_iterator iter = types.begin(); iter != types.end(); ++iter){
+        timer.start();
+        Float typeEnergy = calculationEnergy(iter->second, threadCount);
+        profile.addEnergy(iter->first, iter->second.size(), typeEnergy, timer.elapsed());
+
+        energy += typeEnergy;
+    }
+
+    if(electrostaticsEnabled()){
+        timer.start();
+        Float electrostaticEnergy = this->electrostaticEnergy(0);
+        profile.addEnergy(ForceFieldCalculation::Electrostatic, neighborList.pairCount(), electrostaticEnergy, timer.elapsed());
+
+        energy += electrostaticEnergy;
+    }
+
+    profile.addEnergyEvaluation();
+
+    return energy;
+}
+
+// Calculates the gradient one calculation type at a time and records
+// the gradient norm and time for each type in the profile.
+void ForceFieldPrivate::profiledGradient(const std::vector<ForceFieldCalculation *> &calculations, int threadCount, std::vector<Vector3> &gradient)
+{
+    typedef std::map<int, std::vector<ForceFieldCalculation *> > CalculationTypeMap;
+
+    CalculationTypeMap types;
+    foreach(ForceFieldCalculation *calculation, calculations){
+        types[calculation->type()].push_back(calculation);
+    }
+
+    ProfileTimer timer;
+    std::vector<Vector3> typeGradient(gradient.size());
+
+    for(CalculationTypeMap::const_iterator iter = types.begin(); iter != types.end(); ++iter){
+        typeGradient.assign(gradient.size(), Vector3());
+
+        timer.start();
+        calculationGradient(iter->second, threadCount, typeGradient);
+        Float time = timer.elapsed();
+
+        clearFrozenGradients(typeGradient);
+
+        Float normSquared = 0;
+        for(unsigned int i = 0; i < gradient.size(); i++){
+            normSquared += typeGradient[i].lengthSquared();
+            gradient[i] += typeGradient[i];
+        }
+
+        profile.addGradient(iter->first, iter->second.size(), std::sqrt(normSquared), time);
+    }
+
+    if(electrostaticsEnabled()){
+        timer.start();
+        electrostaticEnergy(&typeGradient);
+        Float time = timer.elapsed();
+
+        clearFrozenGradients(typeGradient);
+
+        Float normSquared = 0;
+        for(unsigned int i = 0; i < gradient.size(); i++){
+            normSquared += typeGradient[i].lengthSquared();
+            gradient[i] += typeGradient[i];
+        }
+
+        profile.addGradient(ForceFieldCalculation::Electrostatic, neighborList.pairCount(), std::sqrt(normSquared), time);
+    }
+
+    profile.addGradientEvaluation();
+}
+
+// Builds the list of calculations that each atom is a part of along
+// with sets of atoms that do not share any calculations.
+void ForceFieldPrivate::updateAtomCalculations()
+{
+    QMutexLocker locker(&atomCalculationsMutex);
+
+    if(atomCalculationsValid){
+        return;
+    }
+
+    atomCalculations.assign(atoms.size(), std::vector<ForceFieldCalculation *>());
+
+    foreach(ForceFieldCalculation *calculation, calculations){
+        for(int i = 0; i < calculation->atomCount(); i++){
+            int index = atomIndices.value(calculation->atom(i), -1);
+
+            if(index != -1){
+                atomCalculations[index].push_back(calculation);
+            }
+        }
+    }
+
+    // greedily color the atoms so that no two atoms with the same
+    // color are part of the same calculation
+    std::vector<int> colors(atoms.size(), -1);
+    std::vector<int> usedColors;
+
+    independentAtomSets.clear();
+
+    for(unsigned int i = 0; i < atoms.size(); i++){
+        foreach(const ForceFieldCalculation *calculation, atomCalculations[i]){
+            for(int j = 0; j < calculation->atomCount(); j++){
+                int neighbor = atomIndices.value(calculation->atom(j), -1);
+
+                if(neighbor != -1 && colors[neighbor] != -1){
+                    usedColors.push_back(colors[neighbor]);
+                }
+            }
+        }
+
+        std::sort(usedColors.begin(), usedColors.end());
+
+        int color = 0;
+        foreach(int usedColor, usedColors){
+            if(usedColor == color){
+                color++;
+            }
+            else if(usedColor > color){
+                break;
+            }
+        }
+
+        usedColors.clear();
+
+        colors[i] = color;
+        if(color == static_cast<int>(independentAtomSets.size())){
+            independentAtomSets.push_back(std::vector<int>());
+        }
+        independentAtomSets[color].push_back(i);
+    }
+
+    atomCalculationsValid = true;
+}
+
+// Returns true if the electrostatic interactions are calculated with
+// a method other than the force field's own pairwise calculations.
+bool ForceFieldPrivate::electrostaticsEnabled() const
+{
+    if(electrostaticsMethod == ForceField::ParticleMeshEwald){
+        return unitCell != 0 && unitCell->volume() != 0;
+    }
+
+    return electrostaticsMethod != ForceField::Coulomb;
+}
+
+// Returns the calculations which contribute to the energy and
+// gradient. When the electrostatics are calculated by the force
+// field this excludes the electrostatic calculations it replaces.
+// When atoms are frozen this excludes the calculations whose atoms
+// are all frozen (their energy is given by frozenEnergy instead).
+const std::vector<ForceFieldCalculation *>& ForceFieldPrivate::evaluatedCalculations()
+{
+    const std::vector<ForceFieldCalculation *> *evaluated = &calculations;
+
+    if(electrostaticsEnabled()){
+        updateElectrostatics();
+        evaluated = &electrostaticsCalculations;
+    }
+
+    updateFrozenCalculations(*evaluated);
+
+    if(frozenAtomCount == 0){
+        return *evaluated;
+    }
+
+    return mobileCalculations;
+}
+
+// Splits the calculations into those with at least one mobile atom
+// and those with only frozen atoms. The energy of the latter is
+// constant while the frozen atoms do not move so it is calculated
+// once and stored in frozenEnergy.
+void ForceFieldPrivate::updateFrozenCalculations(const std::vector<ForceFieldCalculation *> &calculations)
+{
+    QMutexLocker locker(&frozenMutex);
+
+    if(frozenValid){
+        return;
+    }
+
+    frozenAtomCount = 0;
+    foreach(const ForceFieldAtom *atom, atoms){
+        if(atom->isFrozen()){
+            frozenAtomCount++;
+        }
+    }
+
+    frozenEnergy = 0;
+    mobileCalculations.clear();
+
+    if(frozenAtomCount != 0){
+        foreach(ForceFieldCalculation *calculation, calculations){
+            bool frozen = true;
+
+            for(int i = 0; i < calculation->atomCount(); i++){
+                if(!calculation->atom(i)->isFrozen()){
+                    frozen = false;
+                    break;
+                }
+            }
+
+            if(frozen){
+                frozenEnergy += calculation->energy();
+            }
+            else{
+                mobileCalculations.push_back(calculation);
+            }
+        }
+    }
+
+    frozenValid = true;
+}
+
+// Sets the gradient of each frozen atom to zero.
+void ForceFieldPrivate::clearFrozenGradients(std::vector<Vector3> &gradient) const
+{
+    if(frozenAtomCount == 0){
+        return;
+    }
+
+    for(unsigned int i = 0; i < atoms.size(); i++){
+        if(atoms[i]->isFrozen()){
+            gradient[i] = Vector3();
+        }
+    }
+}
+
+// Sets up the molecules in chunk. Called from setupMolecules().
+void ForceFieldPrivate::setupMoleculeChunk(ForceFieldSetupChunk &chunk)
+{
+    foreach(int index, chunk.molecules){
+        const Molecule *molecule = (*chunk.moleculeList)[index];
+
+        bool ok = chunk.forceField->setupMolecule(molecule,
+                                                  (*chunk.atoms)[index],
+                                                  (*chunk.calculations)[index]);
+        if(!ok){
+            chunk.ok = false;
+        }
+    }
+}
+
+// Sets up the calculations in chunk. Called from setupCalculations().
+void ForceFieldPrivate::setupCalculationChunk(ForceFieldSetupChunk &chunk)
+{
+    for(ForceFieldCalculation * const *i = chunk.begin; i != chunk.end; ++i){
+        bool setup = chunk.forceField->setupCalculation(*i);
+        if(!setup){
+            chunk.ok = false;
+        }
+
+        chunk.forceField->setCalculationSetup(*i, setup);
+    }
+}
+
+// Adds the energy (and gradient) of the calculations in chunk for
+// each conformer to the chunk's energies (and gradients). Each
+// calculation reads the positions of its atoms from the coordinates
+// of the conformer being evaluated instead of from the atoms.
+void ForceFieldPrivate::calculateEnsembleChunk(ForceFieldEnsembleChunk &chunk)
+{
+    for(int i = 0; i < chunk.conformerCount; i++){
+        const Point3 *positions = chunk.coordinates + i * chunk.atomCount;
+
+        Float energy = 0;
+        for(ForceFieldCalculation * const *j = chunk.begin; j != chunk.end; ++j){
+            (*j)->setPositions(positions);
+            energy += (*j)->energy();
+        }
+        chunk.energies[i] += energy;
+
+        if(chunk.calculateGradients){
+            Vector3 *gradient = &chunk.gradients[i * chunk.atomCount];
+
+            for(ForceFieldCalculation * const *j = chunk.begin; j != chunk.end; ++j){
+                const ForceFieldCalculation *calculation = *j;
+                std::vector<Vector3> atomGradients = calculation->gradient();
+
+                for(unsigned int k = 0; k < atomGradients.size(); k++){
+                    gradient[calculation->atom(k)->index()] += atomGradients[k];
+                }
+            }
+        }
+    }
+
+    // restore the atoms' own positions
+    for(ForceFieldCalculation * const *j = chunk.begin; j != chunk.end; ++j){
+        (*j)->setPositions(0);
+    }
+}
+
+// Builds the lists of atoms excluded from the electrostatic sum of
+// each atom along with the calculations which are not replaced by
+// it. Atoms separated by three or fewer bonds are excluded. Any
+// electrostatic calculations the force field has for these atoms
+// (e.g. scaled 1-4 interactions) are kept while those for all other
+// pairs are replaced.
+void ForceFieldPrivate::updateElectrostatics()
+{
+    QMutexLocker locker(&electrostaticsMutex);
+
+    if(electrostaticsValid){
+        return;
+    }
+
+    QHash<const Atom *, int> indices;
+    for(unsigned int i = 0; i < atoms.size(); i++){
+        if(atoms[i]->atom()){
+            indices[atoms[i]->atom()] = i;
+        }
+    }
+
+    electrostaticExclusions.assign(atoms.size(), std::vector<int>());
+
+    for(unsigned int i = 0; i < atoms.size(); i++){
+        const Atom *atom = atoms[i]->atom();
+        if(!atom){
+            continue;
+        }
+
+        std::vector<int> &exclusions = electrostaticExclusions[i];
+
+        std::vector<const Atom *> shell(1, atom);
+        for(int depth = 0; depth < 3; depth++){
+            std::vector<const Atom *> nextShell;
+
+            foreach(const Atom *shellAtom, shell){
+                foreach(const Atom *neighbor, shellAtom->neighbors()){
+                    int index = indices.value(neighbor, -1);
+
+                    if(index > static_cast<int>(i)){
+                        exclusions.push_back(index);
+                    }
+
+                    nextShell.push_back(neighbor);
+                }
+            }
+
+            shell.swap(nextShell);
+        }
+
+        std::sort(exclusions.begin(), exclusions.end());
+        exclusions.erase(std::unique(exclusions.begin(), exclusions.end()), exclusions.end());
+    }
+
+    electrostaticsCalculations.clear();
+
+    foreach(ForceFieldCalculation *calculation, calculations){
+        if(!isReplacedByElectrostatics(calculation)){
+            electrostaticsCalculations.push_back(calculation);
+        }
+    }
+
+    electrostaticsValid = true;
+}
+
+// Returns true if calculation is a pairwise electrostatic calculation
+// that is replaced by the electrostatics method. The exclusions must
+// have been built by updateElectrostatics().
+bool ForceFieldPrivate::isReplacedByElectrostatics(const ForceFieldCalculation *calculation) const
+{
+    if(calculation->type() != ForceFieldCalculation::Electrostatic || calculation->atomCount() != 2){
+        return false;
+    }
+
+    int a = atomIndices.value(calculation->atom(0), -1);
+    int b = atomIndices.value(calculation->atom(1), -1);
+
+    if(a == -1 || b == -1){
+        return false;
+    }
+
+    const std::vector<int> &exclusions = electrostaticExclusions[qMin(a, b)];
+
+    return !std::binary_search(exclusions.begin(), exclusions.end(), qMax(a, b));
+}
+
+// Returns the electrostatic energy of the atoms calculated with the
+// electrostatics method. If gradient is not null it is set to the
+// gradient of the energy.
+Float ForceFieldPrivate::electrostaticEnergy(std::vector<Vector3> *gradient)
+{
+    updateElectrostatics();
+
+    const int count = atoms.size();
+
+    std::vector<Point3> positions(count);
+    std::vector<Float> charges(count);
+    for(int i = 0; i < count; i++){
+        positions[i] = atoms[i]->position();
+        charges[i] = atoms[i]->charge();
+    }
+
+    if(gradient){
+        gradient->assign(count, Vector3());
+    }
+
+    const Float cutoff = electrostaticsCutoff;
+    const Float rootPi = std::sqrt(constants::Pi);
+    const ForceField::ElectrostaticsMethod method = electrostaticsMethod;
+
+    // the screening coefficient is the ewald coefficient for particle
+    // mesh ewald and the damping coefficient for damped shifted force
+    Float alpha = 0;
+    if(method == ForceField::ParticleMeshEwald){
+        alpha = ParticleMeshEwald::ewaldCoefficient(cutoff, ewaldTolerance);
+    }
+    else if(method == ForceField::DampedShiftedForce){
+        alpha = electrostaticsDamping;
+    }
+
+    const Float alphaSquared = alpha * alpha;
+    const Float twoAlphaOverRootPi = 2.0 * alpha / rootPi;
+
+    // reaction field constants chosen so that the energy is zero at
+    // the cutoff
+    Float reactionFieldK = 0;
+    Float reactionFieldC = 0;
+    if(method == ForceField::ReactionField){
+        reactionFieldK = (reactionFieldDielectric - 1) / ((2 * reactionFieldDielectric + 1) * cutoff * cutoff * cutoff);
+        reactionFieldC = 1.0 / cutoff + reactionFieldK * cutoff * cutoff;
+    }
+
+    // damped shifted force constants chosen so that both the energy
+    // and the force are zero at the cutoff
+    Float shiftedEnergy = 0;
+    Float shiftedForce = 0;
+    if(method == ForceField::DampedShiftedForce){
+        shiftedEnergy = erfc(alpha * cutoff) / cutoff;
+        shiftedForce = shiftedEnergy / cutoff + twoAlphaOverRootPi * std::exp(-alphaSquared * cutoff * cutoff) / cutoff;
+    }
+
+    Float energy = 0;
+
+    // reciprocal space and self energy
+    if(method == ForceField::ParticleMeshEwald){
+        particleMeshEwald.setUnitCell(unitCell);
+        particleMeshEwald.setEwaldCoefficient(alpha);
+
+        if(gradient){
+            energy += particleMeshEwald.reciprocalEnergy(positions, charges, *gradient);
+        }
+        else{
+            energy += particleMeshEwald.reciprocalEnergy(positions, charges);
+        }
+        energy += particleMeshEwald.selfEnergy(charges);
+    }
+
+    // pairs within the cutoff
+    ProfileTimer timer;
+    if(profilingEnabled){
+        timer.start();
+    }
+
+    neighborList.setCutoff(cutoff);
+    neighborList.setUnitCell(unitCell);
+    neighborList.build(positions);
+
+    if(profilingEnabled){
+        profile.addNeighborListBuild(neighborList.pairCount(), neighborList.cellCount(), timer.elapsed());
+    }
+
+    ElectrostaticPairParameters parameters;
+    parameters.method = method;
+    parameters.cutoff = cutoff;
+    parameters.alpha = alpha;
+    parameters.reactionFieldK = reactionFieldK;
+    parameters.reactionFieldC = reactionFieldC;
+    parameters.shiftedEnergy = shiftedEnergy;
+    parameters.shiftedForce = shiftedForce;
+
+    if(electrostaticsPrecision == ForceField::SinglePrecision){
+        energy += electrostaticPairEnergy<float>(positions, charges, neighborList, electrostaticExclusions, unitCell, parameters, gradient);
+    }
+    else{
+        energy += electrostaticPairEnergy<double>(positions, charges, neighborList, electrostaticExclusions, unitCell, parameters, gradient);
+    }
+
+    if(gradient){
+        for(int i = 0; i < count; i++){
+            (*gradient)[i] *= CoulombConstant;
+        }
+    }
+
+    return CoulombConstant * energy;
+}
+
+// Sets the radii and screening factors of the generalized Born
+// model from the atoms in the force field.
+void ForceFieldPrivate::updateImplicitSolvent()
+{
+    QMutexLocker locker(&implicitSolventMutex);
+
+    if(implicitSolventValid){
+        return;
+    }
+
+    std::vector<Float> radii(atoms.size(), 1.5);
+    std::vector<Float> screeningFactors(atoms.size(), 0.8);
+
+    for(unsigned int i = 0; i < atoms.size(); i++){
+        const Atom *atom = atoms[i]->atom();
+
+        if(atom){
+            radii[i] = GeneralizedBorn::intrinsicRadius(atom);
+            screeningFactors[i] = GeneralizedBorn::screeningFactor(atom);
+        }
+    }
+
+    generalizedBorn.setRadii(radii);
+    generalizedBorn.setScreeningFactors(screeningFactors);
+
+    implicitSolventValid = true;
+}
+
+// Returns the solvation energy of the atoms calculated with the
+// generalized Born model. If gradient is not null it is set to the
+// gradient of the energy.
+Float ForceFieldPrivate::solvationEnergy(std::vector<Vector3> *gradient)
+{
+    updateImplicitSolvent();
+
+    const int count = atoms.size();
+
+    std::vector<Point3> positions(count);
+    std::vector<Float> charges(count);
+    for(int i = 0; i < count; i++){
+        positions[i] = atoms[i]->position();
+        charges[i] = atoms[i]->charge();
+    }
+
+    if(gradient){
+        return generalizedBorn.energy(positions, charges, *gradient);
+    }
+
+    return generalizedBorn.energy(positions, charges);
+}
+
+// Returns true if any of the terms calculated by the force field
+// over all of its atoms (the electrostatics method and the implicit
+// solvent) are enabled.
+bool ForceFieldPrivate::globalTermsEnabled() const
+{
+    return electrostaticsEnabled() || implicitSolventEnabled;
+}
+
+// Returns the sum of the energies of the terms calculated by the
+// force field over all of its atoms. If gradient is not null it is
+// set to the gradient of the energy.
+Float ForceFieldPrivate::globalEnergy(std::vector<Vector3> *gradient)
+{
+    Float energy = 0;
+
+    if(gradient){
+        gradient->assign(atoms.size(), Vector3());
+    }
+
+    std::vector<Vector3> termGradient;
+
+    if(electrostaticsEnabled()){
+        energy += electrostaticEnergy(gradient ? &termGradient : 0);
+
+        if(gradient){
+            for(unsigned int i = 0; i < atoms.size(); i++){
+                (*gradient)[i] += termGradient[i];
+            }
+        }
+    }
+
+    if(implicitSolventEnabled){
+        energy += solvationEnergy(gradient ? &termGradient : 0);
+
+        if(gradient){
+            for(unsigned int i = 0; i < atoms.size(); i++){
+                (*gradient)[i] += termGradient[i];
+            }
+        }
+    }
+
+    return energy;
+}
+
+// === ForceField ========================================================== //
+/// \class ForceField forcefield.h chemkit/forcefield.h
+/// \ingroup chemkit
+/// \brief The ForceField class provides a generic interface to
+///        molecular mechanics force fields.
+///
+/// The following force fields are supported in chemkit:
+///     - \c amber
+///     - \c mmff
+///     - \c opls
+///     - \c uff
+///
+/// The following example shows how to calculate the energy of a
+/// molecule using the uff force field.
+///
+/// \code
+/// // create the uff force field
+/// ForceField *forceField = ForceField::create("uff");
+///
+/// // add the molecule to the force field
+/// forceField->addMolecule(molecule);
+///
+/// // setup the force field
+/// forceField->setup();
+///
+/// // calculate the total energy
+/// Float energy = forceField->energy();
+/// \endcode
+///
+/// For large systems the setup, energy and gradient are evaluated
+/// in parallel. The number of threads used can be changed with the
+/// setThreadCount() method. The atoms and calculations are always
+/// created in the same order so the result of the setup does not
+/// depend on the number of threads.
+///
+/// Periodic systems (such as a box of solvent) are handled by
+/// setting the unit cell with the setUnitCell() method. All
+/// distances and angles are then calculated using the closest
+/// periodic images of the atoms. The long-range electrostatic
+/// interactions of periodic systems can be calculated with the
+/// particle mesh Ewald method and those of large non-periodic
+/// systems (such as proteins) can be truncated at a cutoff with the
+/// reaction field or damped shifted force methods (see
+/// setElectrostaticsMethod()).
+///
+/// The solvation of non-periodic systems in water can be included
+/// with a generalized Born implicit solvent model (see
+/// setImplicitSolventEnabled()).
+
+// --- Construction and Destruction ---------------------------------------- //
+ForceField::ForceField(const std::string &name)
+    : d(new ForceFieldPrivate)
+{
+    d->name = name;
+    d->threadCount = 0;
+    d->deterministicReduction = true;
+    d->topologyTemplatesEnabled = true;
+    d->unitCell = 0;
+    d->minimizer = 0;
+    d->numericalGradientMethod = ForwardDifference;
+    d->atomCalculationsValid = false;
+    d->electrostaticsMethod = Coulomb;
+    d->electrostaticsCutoff = 9.0;
+    d->ewaldTolerance = 1.0e-5;
+    d->reactionFieldDielectric = 78.5;
+    d->electrostaticsDamping = 0.2;
+    d->electrostaticsPrecision = DoublePrecision;
+    d->electrostaticsValid = false;
+    d->implicitSolventEnabled = false;
+    d->implicitSolventValid = false;
+    d->frozenValid = false;
+    d->frozenAtomCount = 0;
+    d->frozenEnergy = 0;
+    d->profilingEnabled = false;
+}
+
+/// Destroys a force field.
+ForceField::~ForceField()
+{
+    delete d->minimizer;
+
+    // delete all calculations
+    foreach(ForceFieldCalculation *calculation, d->calculations){
+        delete calculation;
+    }
+
+    // delete all atoms
+    foreach(ForceFieldAtom *atom, d->atoms){
+        delete atom;
+    }
+
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Returns the name of the force field.
+std::string ForceField::name() const
+{
+    return d->name;
+}
+
+/// Sets the flags for the force field to \p flags.
+void ForceField::setFlags(Flags flags)
+{
+    d->flags = flags;
+}
+
+/// Returns the flags for the force field.
+ForceField::Flags ForceField::flags() const
+{
+    return d->flags;
+}
+
+/// Returns the number of atoms in the force field.
+int ForceField::size() const
+{
+    return atomCount();
+}
+
+/// Returns a list of all the atoms in the force field.
+std::vector<ForceFieldAtom *> ForceField::atoms() const
+{
+    return d->atoms;
+}
+
+/// Returns the number of atoms in the force field.
+int ForceField::atomCount() const
+{
+    return d->atoms.size();
+}
+
+/// Returns the atom at index.
+ForceFieldAtom* ForceField::atom(int index) const
+{
+    return d->atoms[index];
+}
+
+/// Returns the force field atom that represents atom.
+ForceFieldAtom* ForceField::atom(const Atom *atom) const
+{
+    return d->forceFieldAtoms.value(atom, 0);
+}
+
+// --- Setup --------------------------------------------------------------- //
+/// Adds a molecule to the force field.
+void ForceField::addMolecule(const Molecule *molecule)
+{
+    d->molecules.push_back(molecule);
+}
+
+/// Removes a molecule from the force field.
+void ForceField::removeMolecule(const Molecule *molecule)
+{
+    d->molecules.erase(std::remove(d->molecules.begin(), d->molecules.end(), molecule));
+}
+
+/// Returns a list of all the molecules in the force field.
+std::vector<const Molecule *> ForceField::molecules() const
+{
+    return d->molecules;
+}
+
+/// Returns the number of molecules in the force field.
+int ForceField::moleculeCount() const
+{
+    return d->molecules.size();
+}
+
+void ForceField::addAtom(ForceFieldAtom *atom)
+{
+    atom->setIndex(d->atoms.size());
+    d->atomIndices[atom] = d->atoms.size();
+    if(!d->forceFieldAtoms.contains(atom->atom())){
+        d->forceFieldAtoms.insert(atom->atom(), atom);
+    }
+    d->atoms.push_back(atom);
+    d->atomCalculationsValid = false;
+    d->electrostaticsValid = false;
+    d->implicitSolventValid = false;
+    d->frozenValid = false;
+}
+
+void ForceField::removeAtom(ForceFieldAtom *atom)
+{
+    d->atoms.erase(std::remove(d->atoms.begin(), d->atoms.end(), atom));
+    atom->setIndex(-1);
+
+    // update atom indices
+    d->atomIndices.clear();
+    d->forceFieldAtoms.clear();
+    for(unsigned int i = 0; i < d->atoms.size(); i++){
+        d->atoms[i]->setIndex(i);
+        d->atomIndices[d->atoms[i]] = i;
+        if(!d->forceFieldAtoms.contains(d->atoms[i]->atom())){
+            d->forceFieldAtoms.insert(d->atoms[i]->atom(), d->atoms[i]);
+        }
+    }
+
+    d->atomCalculationsValid = false;
+    d->electrostaticsValid = false;
+    d->implicitSolventValid = false;
+    d->frozenValid = false;
+}
+
+/// Removes all of the molecules, atoms and calculations in the force
+/// field.
+void ForceField::clear()
+{
+    while(!d->molecules.empty()){
+        removeMolecule(d->molecules.front());
+    }
+
+    foreach(ForceFieldCalculation *calculation, d->calculations){
+        delete calculation;
+    }
+    d->calculations.clear();
+    d->restraints.clear();
+
+    foreach(ForceFieldAtom *atom, d->atoms){
+        delete atom;
+    }
+    d->atoms.clear();
+    d->atomIndices.clear();
+    d->forceFieldAtoms.clear();
+
+    d->atomCalculationsValid = false;
+    d->electrostaticsValid = false;
+    d->implicitSolventValid = false;
+    d->frozenValid = false;
+
+    acceptTrialMove();
+
+    if(d->minimizer){
+        d->minimizer->reset();
+    }
+}
+
+/// Sets up the force field. Returns false if the setup failed.
+bool ForceField::setup()
+{
+    return false;
+}
+
+/// Returns \c true if the force field is setup.
+bool ForceField::isSetup() const
+{
+    Q_FOREACH(const ForceFieldCalculation *calculation, d->calculations){
+        if(!calculation->isSetup()){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/// Sets whether molecules with identical topologies share the
+/// setup of the first such molecule. When enabled (the default) the
+/// atom types and calculation parameters for the first molecule
+/// are reused for each of its copies instead of being determined
+/// again. This greatly reduces the setup time for systems such as
+/// solvent boxes which contain many copies of the same molecule.
+void ForceField::setTopologyTemplatesEnabled(bool enabled)
+{
+    d->topologyTemplatesEnabled = enabled;
+}
+
+/// Returns \c true if topology templates are enabled.
+bool ForceField::topologyTemplatesEnabled() const
+{
+    return d->topologyTemplatesEnabled;
+}
+
+/// Returns the topology template for each molecule in the force
+/// field. The template for a molecule is the first molecule in the
+/// force field with identical topology, that is the same elements
+/// and formal charges in the same atom order and the same bonds.
+/// Molecules without an earlier copy are their own template.
+///
+/// If topology templates are disabled each molecule is returned as
+/// its own template.
+std::vector<const Molecule *> ForceField::topologyTemplates() const
+{
+    if(!d->topologyTemplatesEnabled){
+        return d->molecules;
+    }
+
+    std::vector<const Molecule *> templates;
+    std::map<std::vector<int>, const Molecule *> signatures;
+
+    foreach(const Molecule *molecule, d->molecules){
+        std::vector<int> signature;
+        signature.reserve(2 + 2 * molecule->atomCount() + 3 * molecule->bondCount());
+        signature.push_back(molecule->atomCount());
+        signature.push_back(molecule->bondCount());
+
+        // atom indices are looked up in a hash because
+        // Atom::index() is linear in the size of the molecule
+        QHash<const Atom *, int> atomIndices;
+        atomIndices.reserve(molecule->atomCount());
+
+        foreach(const Atom *atom, molecule->atoms()){
+            atomIndices.insert(atom, atomIndices.size());
+            signature.push_back(atom->atomicNumber());
+            signature.push_back(atom->formalCharge());
+        }
+
+        foreach(const Bond *bond, molecule->bonds()){
+            signature.push_back(atomIndices.value(bond->atom1()));
+            signature.push_back(atomIndices.value(bond->atom2()));
+            signature.push_back(bond->order());
+        }
+
+        std::map<std::vector<int>, const Molecule *>::iterator location = signatures.find(signature);
+        if(location == signatures.end()){
+            signatures[signature] = molecule;
+            templates.push_back(molecule);
+        }
+        else{
+            templates.push_back(location->second);
+        }
+    }
+
+    return templates;
+}
+
+/// Creates the atoms and calculations for \p molecule and appends
+/// them to \p atoms and \p calculations without adding them to the
+/// force field. The atoms must be created in the same order as the
+/// atoms in the molecule. Returns \c false if the molecule could
+/// not be set up.
+///
+/// Force fields which set up their molecules with setupMolecules()
+/// reimplement this method. It is called from several threads at
+/// once (for different molecules) and must not modify the force
+/// field itself. The default implementation returns \c false.
+bool ForceField::setupMolecule(const Molecule *molecule, std::vector<ForceFieldAtom *> &atoms, std::vector<ForceFieldCalculation *> &calculations)
+{
+    Q_UNUSED(molecule);
+    Q_UNUSED(atoms);
+    Q_UNUSED(calculations);
+
+    return false;
+}
+
+/// Assigns the parameters for \p calculation. Returns \c false if
+/// the calculation could not be parameterized.
+///
+/// Force fields which parameterize their calculations with
+/// setupCalculations() reimplement this method. It is called from
+/// several threads at once (for different calculations) and must
+/// only modify \p calculation. The default implementation returns
+/// \c false.
+bool ForceField::setupCalculation(ForceFieldCalculation *calculation)
+{
+    Q_UNUSED(calculation);
+
+    return false;
+}
+
+/// Sets up each molecule in \p molecules with setupMolecule(). The
+/// atoms and calculations created for the molecule at index \c i
+/// are stored in \p atoms[i] and \p calculations[i] and are not
+/// added to the force field. Null molecules are skipped. Returns
+/// \c false if any of the molecules could not be set up.
+///
+/// The molecules are distributed over effectiveThreadCount()
+/// threads. Each molecule is set up independently by a single
+/// thread so the result does not depend on the number of threads.
+bool ForceField::setupMolecules(const std::vector<const Molecule *> &molecules,
+                                std::vector<std::vector<ForceFieldAtom *> > &atoms,
+                                std::vector<std::vector<ForceFieldCalculation *> > &calculations)
+{
+    atoms.assign(molecules.size(), std::vector<ForceFieldAtom *>());
+    calculations.assign(molecules.size(), std::vector<ForceFieldCalculation *>());
+
+    ForceFieldSetupChunk prototype;
+    prototype.forceField = this;
+    prototype.ok = true;
+    prototype.moleculeList = &molecules;
+    prototype.atoms = &atoms;
+    prototype.calculations = &calculations;
+    prototype.begin = 0;
+    prototype.end = 0;
+
+    // molecules are assigned to threads in turn. a molecule added
+    // more than once is always set up by the same thread because
+    // setting it up may update perception data stored in it
+    int threadCount = effectiveThreadCount();
+    std::vector<ForceFieldSetupChunk> chunks;
+    QHash<const Molecule *, int> moleculeChunks;
+
+    for(unsigned int i = 0; i < molecules.size(); i++){
+        const Molecule *molecule = molecules[i];
+        if(!molecule){
+            continue;
+        }
+
+        QHash<const Molecule *, int>::const_iterator location = moleculeChunks.find(molecule);
+        if(location != moleculeChunks.end()){
+            chunks[location.value()].molecules.push_back(i);
+            continue;
+        }
+
+        int chunk = moleculeChunks.size() % threadCount;
+        if(chunk == static_cast<int>(chunks.size())){
+            chunks.push_back(prototype);
+        }
+
+        chunks[chunk].molecules.push_back(i);
+        moleculeChunks.insert(molecule, chunk);
+    }
+
+    if(chunks.size() == 1){
+        ForceFieldPrivate::setupMoleculeChunk(chunks[0]);
+    }
+    else{
+        QtConcurrent::blockingMap(chunks, ForceFieldPrivate::setupMoleculeChunk);
+    }
+
+    bool ok = true;
+    foreach(const ForceFieldSetupChunk &chunk, chunks){
+        ok = ok && chunk.ok;
+    }
+
+    return ok;
+}
+
+/// Sets up each calculation in \p calculations with
+/// setupCalculation() and marks it as set up if it succeeded.
+/// Returns \c false if any of the calculations could not be set up.
+///
+/// For large systems the calculations are split into contiguous
+/// ranges which are parameterized in parallel (see
+/// setThreadCount()).
+bool ForceField::setupCalculations(const std::vector<ForceFieldCalculation *> &calculations)
+{
+    const unsigned int parallelThreshold = 1000;
+
+    if(calculations.empty()){
+        return true;
+    }
+
+    int threadCount = effectiveThreadCount();
+    if(calculations.size() < parallelThreshold){
+        threadCount = 1;
+    }
+
+    std::vector<ForceFieldSetupChunk> chunks;
+    unsigned int size = calculations.size();
+    unsigned int chunkSize = (size + threadCount - 1) / threadCount;
+
+    for(unsigned int first = 0; first < size; first += chunkSize){
+        ForceFieldSetupChunk chunk;
+        chunk.forceField = this;
+        chunk.ok = true;
+        chunk.moleculeList = 0;
+        chunk.atoms = 0;
+        chunk.calculations = 0;
+        chunk.begin = &calculations[0] + first;
+        chunk.end = &calculations[0] + qMin(first + chunkSize, size);
+        chunks.push_back(chunk);
+    }
+
+    if(chunks.size() == 1){
+        ForceFieldPrivate::setupCalculationChunk(chunks[0]);
+    }
+    else{
+        QtConcurrent::blockingMap(chunks, ForceFieldPrivate::setupCalculationChunk);
+    }
+
+    bool ok = true;
+    foreach(const ForceFieldSetupChunk &chunk, chunks){
+        ok = ok && chunk.ok;
+    }
+
+    return ok;
+}
+
+// --- Parameters ---------------------------------------------------------- //
+void ForceField::addParameterSet(const std::string &name, const std::string &fileName)
+{
+    d->parameterSets[name] = fileName;
+}
+
+void ForceField::removeParameterSet(const std::string &name)
+{
+    d->parameterSets.erase(name);
+}
+
+void ForceField::setParameterSet(const std::string &name)
+{
+    std::map<std::string, std::string>::iterator element = d->parameterSets.find(name);
+    if(element == d->parameterSets.end()){
+        return;
+    }
+
+    d->parameterSet = name;
+    d->parameterFile = element->second;
+}
+
+std::string ForceField::parameterSet() const
+{
+    return d->parameterSet;
+}
+
+std::vector<std::string> ForceField::parameterSets() const
+{
+    std::vector<std::string> parameterSets;
+
+    std::pair<std::string, std::string> element;
+    foreach(element, d->parameterSets){
+        parameterSets.push_back(element.first);
+    }
 
-// --- Construction and Destruction ---------------------------------------- //
-ForceField::ForceField(const std::string &name)
-    : d(new ForceFieldPrivate)
+    return parameterSets;
+}
+
+/// Sets the parameter file to \p fileName. The file may either be
+/// a text parameter file or a precompiled binary parameter file
+/// (see BinaryParameterFile). Force fields compile text parameter
+/// files into the parameter cache the first time they are read.
+void ForceField::setParameterFile(const std::string &fileName)
 {
-    d->name = name;
+    d->parameterFile = fileName;
 }
 
-/// Destroys a force field.
-ForceField::~ForceField()
+/// Returns the parameter file for the force field.
+std::string ForceField::parameterFile() const
 {
-    // delete all calculations
-    foreach(ForceFieldCalculation *calculation, d->calculations){
-        delete calculation;
-    }
+    return d->parameterFile;
+}
 
-    // delete all atoms
-    foreach(ForceFieldAtom *atom, d->atoms){
-        delete atom;
+// --- Threading ---------------------------------------------------------- //
+/// Sets the maximum number of threads used to set up the force
+/// field and to calculate the energy and gradient to \p count. If
+/// \p count is \c 0 (the default) the ideal number of threads for
+/// the machine is used. Setting \p count to \c 1 disables parallel
+/// evaluation which is useful when running many independent force
+/// fields at once (e.g. one per core).
+void ForceField::setThreadCount(int count)
+{
+    d->threadCount = qMax(0, count);
+    d->generalizedBorn.setThreadCount(d->threadCount);
+}
+
+/// Returns the maximum number of threads used to calculate the
+/// energy and gradient. Returns \c 0 if the ideal number of threads
+/// for the machine is used.
+///
+/// \see effectiveThreadCount()
+int ForceField::threadCount() const
+{
+    return d->threadCount;
+}
+
+/// Returns the number of threads that will be used to calculate the
+/// energy and gradient.
+int ForceField::effectiveThreadCount() const
+{
+    if(d->threadCount == 0){
+        return QThread::idealThreadCount();
     }
 
-    delete d;
+    return d->threadCount;
 }
 
-// --- Properties ---------------------------------------------------------- //
-/// Returns the name of the force field.
-std::string ForceField::name() const
+/// Sets whether the per-thread partial results are reduced in a
+/// deterministic order. When \c true (the default) the energy and
+/// gradient are bitwise reproducible between runs with the same
+/// thread count. When \c false each thread adds its partial gradient
+/// to the result as soon as it is finished which avoids waiting on
+/// the slowest thread but makes the rounding of the result depend
+/// on thread scheduling.
+void ForceField::setDeterministicReduction(bool enabled)
 {
-    return d->name;
+    d->deterministicReduction = enabled;
 }
 
-/// Sets the flags for the force field to \p flags.
-void ForceField::setFlags(Flags flags)
+/// Returns \c true if partial results are reduced in a
+/// deterministic order.
+bool ForceField::deterministicReduction() const
 {
-    d->flags = flags;
+    return d->deterministicReduction;
 }
 
-/// Returns the flags for the force field.
-ForceField::Flags ForceField::flags() const
+// --- Periodic Boundaries ------------------------------------------------- //
+/// Sets the periodic unit cell to \p cell. If \p cell is not \c 0
+/// periodic boundary conditions are used and every interaction is
+/// calculated between the closest periodic images of its atoms (the
+/// minimum image convention). Bonded interactions are calculated
+/// correctly for molecules which are split across the boundary of
+/// the cell. The cell is not owned by the force field.
+///
+/// For the minimum image convention to be valid each cell vector
+/// should be at least twice as long as the range of the nonbonded
+/// interactions.
+void ForceField::setUnitCell(const UnitCell *cell)
 {
-    return d->flags;
+    d->unitCell = cell;
+
+    foreach(ForceFieldCalculation *calculation, d->calculations){
+        calculation->setUnitCell(cell);
+    }
 }
 
-/// Returns the number of atoms in the force field.
-int ForceField::size() const
+/// Returns the periodic unit cell. Returns \c 0 if periodic
+/// boundary conditions are not used.
+const UnitCell* ForceField::unitCell() const
 {
-    return atomCount();
+    return d->unitCell;
 }
 
-/// Returns a list of all the atoms in the force field.
-std::vector<ForceFieldAtom *> ForceField::atoms() const
+// --- Electrostatics ------------------------------------------------------ //
+/// Sets the method used to calculate the electrostatic interactions
+/// to \p method.
+///
+/// The following methods are supported:
+///     - \c Coulomb: (default) The electrostatic interactions are
+///       calculated by the force field between every pair of atoms.
+///     - \c ParticleMeshEwald: The electrostatic interactions of a
+///       periodic system are calculated with the smooth particle
+///       mesh Ewald method. This includes the interactions between
+///       all of the periodic images of the atoms and scales as
+///       O(N log N) with the number of atoms. The unit cell must be
+///       set with setUnitCell(), otherwise the \c Coulomb method is
+///       used.
+///     - \c ReactionField: Interactions beyond the cutoff are
+///       replaced by a dielectric continuum (see
+///       setReactionFieldDielectric()). The energy of each pair goes
+///       smoothly to zero at the cutoff.
+///     - \c DampedShiftedForce: The damped shifted force method of
+///       Fennell and Gezelter [2006]. The interactions are screened
+///       with the complementary error function (see
+///       setElectrostaticsDamping()) and shifted so that both the
+///       energy and force of each pair go to zero at the cutoff. This
+///       conserves energy well in molecular dynamics and closely
+///       reproduces the forces of the full sum.
+///
+/// The \c ReactionField and \c DampedShiftedForce methods only
+/// calculate the interactions between atoms within the cutoff
+/// distance (see setElectrostaticsCutoff()) using a neighbor list
+/// which makes them linear in the number of atoms. They can be used
+/// with or without periodic boundaries.
+///
+/// With a method other than \c Coulomb the force field's
+/// electrostatic calculations are replaced by a sum over the
+/// charges of the atoms in which atoms separated by three or fewer
+/// bonds are excluded. Electrostatic calculations for atoms
+/// separated by three bonds (which are usually scaled by the force
+/// field) are kept. Only calculations of the \c Electrostatic type
+/// are replaced and so force fields must calculate the van der Waals
+/// and electrostatic interactions in separate calculations.
+///
+/// The method is used by energy() and gradient(). The energies of
+/// individual atoms and trial moves are still calculated with the
+/// force field's own calculations.
+///
+/// \see ParticleMeshEwald
+void ForceField::setElectrostaticsMethod(ElectrostaticsMethod method)
 {
-    return d->atoms;
+    d->electrostaticsMethod = method;
+    d->electrostaticsValid = false;
+    d->frozenValid = false;
 }
 
-/// Returns the number of atoms in the force field.
-int ForceField::atomCount() const
+/// Returns the method used to calculate the electrostatic
+/// interactions.
+ForceField::ElectrostaticsMethod ForceField::electrostaticsMethod() const
 {
-    return d->atoms.size();
+    return d->electrostaticsMethod;
 }
 
-/// Returns the atom at index.
-ForceFieldAtom* ForceField::atom(int index) const
+/// Sets the cutoff distance for the electrostatic interactions to
+/// \p cutoff. For the particle mesh Ewald method this is the cutoff
+/// of the real space sum. The default cutoff is 9.0 angstroms. For
+/// periodic systems the cutoff must be less than half the width of
+/// the unit cell.
+void ForceField::setElectrostaticsCutoff(Float cutoff)
 {
-    return d->atoms[index];
+    d->electrostaticsCutoff = cutoff;
 }
 
-/// Returns the force field atom that represents atom.
-ForceFieldAtom* ForceField::atom(const Atom *atom) const
+/// Returns the cutoff distance for the electrostatic interactions.
+Float ForceField::electrostaticsCutoff() const
 {
-    foreach(ForceFieldAtom *forceFieldAtom, d->atoms){
-        if(forceFieldAtom->atom() == atom){
-            return forceFieldAtom;
-        }
-    }
+    return d->electrostaticsCutoff;
+}
 
-    return 0;
+/// Sets the relative strength of the screened electrostatic
+/// interaction at the cutoff distance to \p tolerance. This
+/// determines the Ewald coefficient. The default tolerance is
+/// \f$10^{-5}\f$.
+///
+/// \see ParticleMeshEwald::ewaldCoefficient()
+void ForceField::setEwaldTolerance(Float tolerance)
+{
+    d->ewaldTolerance = tolerance;
 }
 
-// --- Setup --------------------------------------------------------------- //
-/// Adds a molecule to the force field.
-void ForceField::addMolecule(const Molecule *molecule)
+/// Returns the relative strength of the screened electrostatic
+/// interaction at the cutoff distance.
+Float ForceField::ewaldTolerance() const
 {
-    d->molecules.push_back(molecule);
+    return d->ewaldTolerance;
 }
 
-/// Removes a molecule from the force field.
-void ForceField::removeMolecule(const Molecule *molecule)
+/// Sets the maximum spacing between the points of the particle mesh
+/// Ewald grid to \p spacing. The default spacing is 1.0 angstrom.
+void ForceField::setEwaldGridSpacing(Float spacing)
 {
-    d->molecules.erase(std::remove(d->molecules.begin(), d->molecules.end(), molecule));
+    d->particleMeshEwald.setGridSpacing(spacing);
 }
 
-/// Returns a list of all the molecules in the force field.
-std::vector<const Molecule *> ForceField::molecules() const
+/// Returns the maximum spacing between the points of the particle
+/// mesh Ewald grid.
+Float ForceField::ewaldGridSpacing() const
 {
-    return d->molecules;
+    return d->particleMeshEwald.gridSpacing();
 }
 
-/// Returns the number of molecules in the force field.
-int ForceField::moleculeCount() const
+/// Sets the order of the B-spline interpolation used by the
+/// particle mesh Ewald method to \p order. The default order is 4.
+void ForceField::setEwaldOrder(int order)
 {
-    return d->molecules.size();
+    d->particleMeshEwald.setOrder(order);
 }
 
-void ForceField::addAtom(ForceFieldAtom *atom)
+/// Returns the order of the B-spline interpolation used by the
+/// particle mesh Ewald method.
+int ForceField::ewaldOrder() const
 {
-    d->atoms.push_back(atom);
+    return d->particleMeshEwald.order();
 }
 
-void ForceField::removeAtom(ForceFieldAtom *atom)
+/// Sets the dielectric constant of the continuum beyond the cutoff
+/// used by the reaction field method to \p dielectric. The default
+/// is 78.5 (water).
+void ForceField::setReactionFieldDielectric(Float dielectric)
 {
-    d->atoms.erase(std::remove(d->atoms.begin(), d->atoms.end(), atom));
+    d->reactionFieldDielectric = dielectric;
 }
 
-/// Removes all of the molecules in the force field.
-void ForceField::clear()
+/// Returns the dielectric constant of the continuum beyond the
+/// cutoff used by the reaction field method.
+Float ForceField::reactionFieldDielectric() const
 {
-    while(!d->molecules.empty()){
-        removeMolecule(d->molecules.front());
-    }
+    return d->reactionFieldDielectric;
+}
 
-    foreach(ForceFieldCalculation *calculation, d->calculations){
-        delete calculation;
-    }
-    d->calculations.clear();
+/// Sets the damping coefficient (\f$\alpha\f$) used by the damped
+/// shifted force method to \p damping. The coefficient is in
+/// inverse angstroms. The default is 0.2 which is suitable for
+/// condensed phase systems with cutoffs between 9 and 12 angstroms.
+/// Smaller values more closely reproduce the unscreened interactions
+/// of systems in vacuum.
+void ForceField::setElectrostaticsDamping(Float damping)
+{
+    d->electrostaticsDamping = damping;
 }
 
-/// Sets up the force field. Returns false if the setup failed.
-bool ForceField::setup()
+/// Returns the damping coefficient used by the damped shifted force
+/// method.
+Float ForceField::electrostaticsDamping() const
 {
-    return false;
+    return d->electrostaticsDamping;
 }
 
-/// Returns \c true if the force field is setup.
-bool ForceField::isSetup() const
+/// Sets the floating point precision used to calculate the
+/// interactions between pairs of charges with the electrostatics
+/// method to \p precision.
+///
+/// With \c SinglePrecision the positions, charges and gradients of
+/// the atoms are converted to single precision for the sum over the
+/// pairs within the cutoff. This halves the memory traffic of the
+/// sum which is the most expensive part of the calculation for large
+/// systems. The energy is still summed in double precision and the
+/// gradient of each atom is returned in double precision. The
+/// relative error of the energy and gradient is about
+/// \f$10^{-6}\f$ which is suitable for molecular dynamics and
+/// minimization but not for comparing energies to many significant
+/// figures.
+///
+/// The precision only applies to the electrostatics pair sum of
+/// methods other than \c Coulomb. The particle mesh Ewald reciprocal
+/// space sum and all of the force field's own calculations, including
+/// its bonded and van der Waals terms, are always performed in double
+/// precision. The speedup of the total energy and gradient therefore
+/// depends on the fraction of the time spent in the electrostatics
+/// pair sum. The default is \c DoublePrecision.
+///
+/// \see setElectrostaticsMethod()
+void ForceField::setElectrostaticsPrecision(ElectrostaticsPrecision precision)
 {
-    Q_FOREACH(const ForceFieldCalculation *calculation, d->calculations){
-        if(!calculation->isSetup()){
-            return false;
-        }
-    }
+    d->electrostaticsPrecision = precision;
+}
 
-    return true;
+/// Returns the floating point precision used to calculate the
+/// interactions between pairs of charges with the electrostatics
+/// method.
+ForceField::ElectrostaticsPrecision ForceField::electrostaticsPrecision() const
+{
+    return d->electrostaticsPrecision;
 }
 
-// --- Parameters ---------------------------------------------------------- //
-void ForceField::addParameterSet(const std::string &name, const std::string &fileName)
+// --- Implicit Solvent ---------------------------------------------------- //
+/// Sets whether the solvation energy is calculated with an implicit
+/// solvent model to \p enabled. The default is \c false.
+///
+/// The solvation energy is calculated with the generalized Born
+/// model using the OBC Born radii and the ACE approximation of the
+/// nonpolar energy (see GeneralizedBorn). It is added to the energy
+/// and gradient of the force field and uses the partial charges of
+/// its atoms. Implicit solvent should not be used with periodic
+/// boundary conditions.
+///
+/// \see solvationEnergy()
+void ForceField::setImplicitSolventEnabled(bool enabled)
 {
-    d->parameterSets[name] = fileName;
+    d->implicitSolventEnabled = enabled;
 }
 
-void ForceField::removeParameterSet(const std::string &name)
+/// Returns \c true if the solvation energy is calculated with an
+/// implicit solvent model.
+bool ForceField::implicitSolventEnabled() const
 {
-    d->parameterSets.erase(name);
+    return d->implicitSolventEnabled;
 }
 
-void ForceField::setParameterSet(const std::string &name)
+/// Sets the dielectric constant of the implicit solvent to
+/// \p dielectric. The default is \c 78.5 (water).
+void ForceField::setSolventDielectric(Float dielectric)
 {
-    std::map<std::string, std::string>::iterator element = d->parameterSets.find(name);
-    if(element == d->parameterSets.end()){
-        return;
-    }
+    d->generalizedBorn.setSolventDielectric(dielectric);
+}
 
-    d->parameterSet = name;
-    d->parameterFile = element->second;
+/// Returns the dielectric constant of the implicit solvent.
+Float ForceField::solventDielectric() const
+{
+    return d->generalizedBorn.solventDielectric();
 }
 
-std::string ForceField::parameterSet() const
+/// Sets the surface tension used for the nonpolar solvation energy
+/// to \p tension. The default is \c 0.0054 kcal/mol/angstrom^2.
+void ForceField::setSurfaceTension(Float tension)
 {
-    return d->parameterSet;
+    d->generalizedBorn.setSurfaceTension(tension);
 }
 
-std::vector<std::string> ForceField::parameterSets() const
+/// Returns the surface tension used for the nonpolar solvation
+/// energy.
+Float ForceField::surfaceTension() const
 {
-    std::vector<std::string> parameterSets;
+    return d->generalizedBorn.surfaceTension();
+}
 
-    std::pair<std::string, std::string> element;
-    foreach(element, d->parameterSets){
-        parameterSets.push_back(element.first);
-    }
+/// Sets the cutoff distance for the implicit solvent to \p cutoff.
+/// If \p cutoff is \c 0 (the default) every pair of atoms is
+/// used. Otherwise only the pairs found by a neighbor list within
+/// the cutoff are used which is much faster for large systems. A
+/// cutoff of at least 16 angstroms is recommended.
+void ForceField::setImplicitSolventCutoff(Float cutoff)
+{
+    d->generalizedBorn.setCutoff(cutoff);
+}
 
-    return parameterSets;
+/// Returns the cutoff distance for the implicit solvent.
+Float ForceField::implicitSolventCutoff() const
+{
+    return d->generalizedBorn.cutoff();
 }
 
-void ForceField::setParameterFile(const std::string &fileName)
+/// Returns the solvation energy of the atoms calculated with the
+/// implicit solvent model. This is calculated even if the implicit
+/// solvent is not enabled. Energy is in kcal/mol.
+Float ForceField::solvationEnergy() const
 {
-    d->parameterFile = fileName;
+    return d->solvationEnergy(0);
 }
 
-std::string ForceField::parameterFile() const
+/// Returns the effective Born radius of each atom in the force
+/// field.
+std::vector<Float> ForceField::bornRadii() const
 {
-    return d->parameterFile;
+    d->updateImplicitSolvent();
+
+    std::vector<Point3> positions(atomCount());
+    for(int i = 0; i < atomCount(); i++){
+        positions[i] = d->atoms[i]->position();
+    }
+
+    return d->generalizedBorn.bornRadii(positions);
 }
 
 // --- Calculations -------------------------------------------------------- //
 void ForceField::addCalculation(ForceFieldCalculation *calculation)
 {
+    calculation->setUnitCell(d->unitCell);
     d->calculations.push_back(calculation);
+    d->atomCalculationsValid = false;
+    d->electrostaticsValid = false;
+    d->frozenValid = false;
 }
 
 void ForceField::removeCalculation(ForceFieldCalculation *calculation)
 {
     d->calculations.erase(std::remove(d->calculations.begin(), d->calculations.end(), calculation));
+    d->atomCalculationsValid = false;
+    d->electrostaticsValid = false;
+    d->frozenValid = false;
     delete calculation;
 }
 
@@ -314,6 +2178,19 @@ std::vector<ForceFieldCalculation *> ForceField::calculations() const
     return d->calculations;
 }
 
+/// Returns a list of all the calculations that \p atom is a part
+/// of.
+std::vector<ForceFieldCalculation *> ForceField::calculations(const ForceFieldAtom *atom) const
+{
+    return atomCalculations(atom);
+}
+
+/// Returns the calculation at \p index.
+ForceFieldCalculation* ForceField::calculation(int index) const
+{
+    return d->calculations[index];
+}
+
 /// Returns the number of calculations in the force field.
 int ForceField::calculationCount() const
 {
@@ -325,32 +2202,202 @@ void ForceField::setCalculationSetup(ForceFieldCalculation *calculation, bool se
     calculation->setSetup(setup);
 }
 
+/// Returns a new calculation of \p type between atoms \p a and
+/// \p b which is parameterized but not added to the force field.
+/// Returns \c 0 if the type is not supported or the calculation
+/// could not be parameterized. Force fields reimplement this method
+/// to be used with ReceptorGrid. The default implementation returns
+/// \c 0.
+ForceFieldCalculation* ForceField::createPairCalculation(ForceFieldCalculation::Type type, const ForceFieldAtom *a, const ForceFieldAtom *b) const
+{
+    Q_UNUSED(type);
+    Q_UNUSED(a);
+    Q_UNUSED(b);
+
+    return 0;
+}
+
+// --- Profiling ----------------------------------------------------------- //
+/// Sets whether profiling is enabled to \p enabled. While profiling
+/// is enabled the energy and gradient are evaluated one calculation
+/// type at a time and the energy, gradient norm and evaluation time
+/// of each type are recorded in the profile. The default is
+/// \c false.
+///
+/// Evaluating each type separately changes the order in which the
+/// terms are summed so the total energy and gradient may differ in
+/// the last few bits from those calculated with profiling disabled.
+///
+/// \see profile()
+void ForceField::setProfilingEnabled(bool enabled)
+{
+    d->profilingEnabled = enabled;
+}
+
+/// Returns \c true if profiling is enabled.
+bool ForceField::profilingEnabled() const
+{
+    return d->profilingEnabled;
+}
+
+/// Returns the profile recorded while profiling was enabled.
+///
+/// The profile only contains the calculations which are evaluated.
+/// The energy of calculations whose atoms are all frozen is given
+/// by frozenEnergy().
+///
+/// \see setProfilingEnabled()
+const ForceFieldProfile* ForceField::profile() const
+{
+    return &d->profile;
+}
+
+/// Removes all of the information from the profile.
+void ForceField::clearProfile()
+{
+    d->profile.clear();
+}
+
+// --- Frozen Atoms -------------------------------------------------------- //
+/// Returns the number of frozen atoms in the force field.
+///
+/// \see ForceFieldAtom::setFrozen()
+int ForceField::frozenAtomCount() const
+{
+    d->evaluatedCalculations();
+
+    return d->frozenAtomCount;
+}
+
+/// Returns the energy of the calculations whose atoms are all
+/// frozen. This energy is constant while the frozen atoms do not
+/// move and is added to the total energy without re-evaluating
+/// those calculations.
+///
+/// Electrostatic interactions calculated by the force field itself
+/// (e.g. with the ParticleMeshEwald method) are always evaluated
+/// for every pair of atoms and are not included in this energy.
+Float ForceField::frozenEnergy() const
+{
+    d->evaluatedCalculations();
+
+    return d->frozenEnergy;
+}
+
+// Called by ForceFieldAtom when an atom is frozen or unfrozen or
+// when a frozen atom is moved.
+void ForceField::frozenAtomsChanged()
+{
+    d->frozenValid = false;
+}
+
+// --- Restraints ---------------------------------------------------------- //
+/// Adds a harmonic restraint holding \p atom at \p position and
+/// returns it. The energy of the restraint is
+/// \f$ k |\vec{r} - \vec{r}_{0}|^{2} \f$ where the force constant
+/// \f$ k \f$ is in kcal/mol/A^2.
+///
+/// Restraints should be added after the force field is setup.
+///
+/// \see addDistanceRestraint()
+ForceFieldCalculation* ForceField::addPositionRestraint(ForceFieldAtom *atom, const Point3 &position, Float forceConstant)
+{
+    ForceFieldCalculation *restraint = new PositionRestraint(atom, position, forceConstant);
+    setCalculationSetup(restraint, true);
+    addCalculation(restraint);
+    d->restraints.push_back(restraint);
+
+    return restraint;
+}
+
+/// Adds a harmonic restraint holding the atoms \p a and \p b
+/// \p distance angstroms apart and returns it. The energy of the
+/// restraint is \f$ k (r - r_{0})^{2} \f$ where the force constant
+/// \f$ k \f$ is in kcal/mol/A^2.
+///
+/// Restraints should be added after the force field is setup.
+///
+/// \see addPositionRestraint()
+ForceFieldCalculation* ForceField::addDistanceRestraint(ForceFieldAtom *a, ForceFieldAtom *b, Float distance, Float forceConstant)
+{
+    ForceFieldCalculation *restraint = new DistanceRestraint(a, b, distance, forceConstant);
+    setCalculationSetup(restraint, true);
+    addCalculation(restraint);
+    d->restraints.push_back(restraint);
+
+    return restraint;
+}
+
+/// Removes and deletes \p restraint from the force field.
+void ForceField::removeRestraint(ForceFieldCalculation *restraint)
+{
+    std::vector<ForceFieldCalculation *>::iterator iter = std::find(d->restraints.begin(), d->restraints.end(), restraint);
+    if(iter == d->restraints.end()){
+        return;
+    }
+
+    d->restraints.erase(iter);
+    removeCalculation(restraint);
+}
+
+/// Removes and deletes all of the restraints in the force field.
+void ForceField::removeRestraints()
+{
+    while(!d->restraints.empty()){
+        removeRestraint(d->restraints.back());
+    }
+}
+
+/// Returns a list of the restraints in the force field.
+std::vector<ForceFieldCalculation *> ForceField::restraints() const
+{
+    return d->restraints;
+}
+
+/// Returns the number of restraints in the force field.
+int ForceField::restraintCount() const
+{
+    return d->restraints.size();
+}
+
 /// Calculates and returns the total energy of the system. Energy is
 /// in kcal/mol. If the force field is not setup this method will
 /// return \c 0.
 Float ForceField::energy() const
 {
-    const unsigned int parallelThreshold = 5000;
+    const std::vector<ForceFieldCalculation *> &calculations = d->evaluatedCalculations();
 
     Float energy = 0;
 
-    if(d->calculations.size() < parallelThreshold){
-        // calculate energy sequentially
-        foreach(const ForceFieldCalculation *calculation, d->calculations){
-            energy += calculation->energy();
-        }
+    if(d->profilingEnabled){
+        energy = d->profiledEnergy(calculations, effectiveThreadCount());
     }
     else{
-        // calculate energy in parallel
-        energy = QtConcurrent::blockingMappedReduced(d->calculations, mapEnergy, reduceEnergy);
+        energy = d->calculationEnergy(calculations, effectiveThreadCount());
+
+        if(d->electrostaticsEnabled()){
+            energy += d->electrostaticEnergy(0);
+        }
+    }
+
+    if(d->implicitSolventEnabled){
+        energy += d->solvationEnergy(0);
     }
 
+    energy += d->frozenEnergy;
+
     return energy;
 }
 
 /// Returns the gradient of the energy with respect to the
 /// coordinates of each atom in the force field.
 ///
+/// For large systems the calculations are partitioned across
+/// threads, each of which accumulates into its own gradient buffer.
+/// The buffers are then summed to give the final gradient.
+///
+/// \see setThreadCount(), setDeterministicReduction()
+///
 /** \f[ \nabla E = \left[
 ///                \begin{array}{ccc}
 ///                    \frac{\partial E}{\partial x_{0}} &
@@ -370,18 +2417,37 @@ Float ForceField::energy() const
 std::vector<Vector3> ForceField::gradient() const
 {
     if(d->flags.testFlag(AnalyticalGradient)){
+        const std::vector<ForceFieldCalculation *> &calculations = d->evaluatedCalculations();
+
         std::vector<Vector3> gradient(atomCount());
 
-        foreach(const ForceFieldCalculation *calculation, d->calculations){
-            std::vector<Vector3> atomGradients = calculation->gradient();
+        if(d->profilingEnabled){
+            d->profiledGradient(calculations, effectiveThreadCount(), gradient);
+        }
+        else{
+            d->calculationGradient(calculations, effectiveThreadCount(), gradient);
+
+            if(d->electrostaticsEnabled()){
+                std::vector<Vector3> electrostaticGradient;
+                d->electrostaticEnergy(&electrostaticGradient);
+
+                for(unsigned int i = 0; i < gradient.size(); i++){
+                    gradient[i] += electrostaticGradient[i];
+                }
+            }
+        }
 
-            for(unsigned int i = 0; i < atomGradients.size(); i++){
-                const ForceFieldAtom *atom = calculation->atom(i);
+        if(d->implicitSolventEnabled){
+            std::vector<Vector3> solvationGradient;
+            d->solvationEnergy(&solvationGradient);
 
-                gradient[atom->index()] += atomGradients[i];
+            for(unsigned int i = 0; i < gradient.size(); i++){
+                gradient[i] += solvationGradient[i];
             }
         }
 
+        d->clearFrozenGradients(gradient);
+
         return gradient;
     }
     else{
@@ -391,40 +2457,73 @@ std::vector<Vector3> ForceField::gradient() const
 
 /// Returns the gradient of the energy with respect to the
 /// coordinates of each atom in the force field. The gradient is
-/// calculated numerically.
+/// calculated numerically using the method set with
+/// setNumericalGradientMethod().
+///
+/// Atoms that are not part of any common calculation are displaced
+/// at the same time using multiple threads. The result does not
+/// depend on the number of threads used.
 ///
 /// \see ForceField::gradient()
 std::vector<Vector3> ForceField::numericalGradient() const
 {
-    std::vector<Vector3> gradient(atomCount());
+    const unsigned int parallelThreshold = 16;
 
-    for(int i = 0; i < atomCount(); i++){
-        ForceFieldAtom *atom = d->atoms[i];
+    d->updateAtomCalculations();
 
-        // initial energy
-        Float eI = atom->energy();
-        Float epsilon = 1.0e-10;
+    std::vector<Vector3> gradient(atomCount());
 
-        atom->moveBy(epsilon, 0, 0);
-        Float eF_x = atom->energy();
+    int threadCount = effectiveThreadCount();
 
-        atom->moveBy(-epsilon, epsilon, 0);
-        Float eF_y = atom->energy();
+    foreach(const std::vector<int> &allAtoms, d->independentAtomSets){
+        // frozen atoms are not displaced and have a zero gradient
+        std::vector<int> atomSet;
+        foreach(int index, allAtoms){
+            if(!d->atoms[index]->isFrozen()){
+                atomSet.push_back(index);
+            }
+        }
+
+        if(threadCount == 1 || atomSet.size() < parallelThreshold){
+            foreach(int index, atomSet){
+                gradient[index] = numericalAtomGradient(d->atoms[index], d->numericalGradientMethod);
+            }
 
-        atom->moveBy(0, -epsilon, epsilon);
-        Float eF_z = atom->energy();
+            continue;
+        }
 
-        // restore initial position
-        atom->moveBy(0, 0, -epsilon);
+        // split the set into one chunk per thread
+        int chunkCount = qMin(threadCount, static_cast<int>(atomSet.size()));
+        std::vector<NumericalGradientChunk> chunks(chunkCount);
 
-        Float dx = (eF_x - eI) / epsilon;
-        Float dy = (eF_y - eI) / epsilon;
-        Float dz = (eF_z - eI) / epsilon;
+        for(unsigned int i = 0; i < atomSet.size(); i++){
+            NumericalGradientChunk &chunk = chunks[(i * chunkCount) / atomSet.size()];
+            chunk.atoms.push_back(d->atoms[atomSet[i]]);
+            chunk.indices.push_back(atomSet[i]);
+            chunk.method = d->numericalGradientMethod;
+            chunk.gradient = &gradient;
+        }
 
-        gradient[i] = Vector3(dx, dy, dz);
+        QtConcurrent::blockingMap(chunks, calculateChunkNumericalGradient);
     }
 
-    return gradient;
+    return gradient;
+}
+
+/// Sets the method used to calculate numerical gradients to
+/// \p method. The default is \c ForwardDifference.
+///
+/// Central differences require twice as many energy calculations
+/// but are considerably more accurate.
+void ForceField::setNumericalGradientMethod(NumericalGradientMethod method)
+{
+    d->numericalGradientMethod = method;
+}
+
+/// Returns the method used to calculate numerical gradients.
+ForceField::NumericalGradientMethod ForceField::numericalGradientMethod() const
+{
+    return d->numericalGradientMethod;
 }
 
 /// Returns the magnitude of the largest gradient.
@@ -466,6 +2565,181 @@ Float ForceField::rootMeanSquareGradient() const
     return sqrt(sum / (3.0 * size()));
 }
 
+/// Returns the Hessian of the energy with respect to the
+/// coordinates of each atom in the force field. The Hessian is a
+/// 3N x 3N matrix (where N is the number of atoms) with rows and
+/// columns ordered as x0, y0, z0, x1, ..., zN. The rows and columns
+/// of frozen atoms are zero.
+///
+/// The Hessian is assembled from the second derivatives of each
+/// calculation (see ForceFieldCalculation::hessian()). If the force
+/// field does not provide analytical gradients the Hessian is
+/// calculated with numericalHessian() instead.
+///
+/// The memory required grows with the square of the number of atoms
+/// so for large systems hessianProduct() should be used instead.
+Matrix ForceField::hessian() const
+{
+    if(!d->flags.testFlag(AnalyticalGradient)){
+        return numericalHessian();
+    }
+
+    const std::vector<ForceFieldCalculation *> &calculations = d->evaluatedCalculations();
+
+    int size = 3 * atomCount();
+    Matrix hessian(size, size);
+
+    foreach(const ForceFieldCalculation *calculation, calculations){
+        Matrix calculationHessian = calculation->hessian();
+
+        int calculationAtomCount = calculation->atomCount();
+        std::vector<int> indices(calculationAtomCount);
+        for(int i = 0; i < calculationAtomCount; i++){
+            indices[i] = atomIndex(calculation->atom(i));
+        }
+
+        for(int i = 0; i < calculationAtomCount; i++){
+            for(int j = 0; j < calculationAtomCount; j++){
+                for(int k = 0; k < 3; k++){
+                    for(int l = 0; l < 3; l++){
+                        hessian(3 * indices[i] + k, 3 * indices[j] + l) += calculationHessian(3 * i + k, 3 * j + l);
+                    }
+                }
+            }
+        }
+    }
+
+    // the electrostatics methods and the implicit solvent only provide
+    // gradients so their contribution is calculated numerically
+    if(d->globalTermsEnabled()){
+        for(int i = 0; i < size; i++){
+            if(d->atoms[i / 3]->isFrozen()){
+                continue;
+            }
+
+            std::vector<Vector3> direction(atomCount());
+            direction[i / 3][i % 3] = 1;
+
+            std::vector<Vector3> column = numericalHessianProduct(direction, true);
+            for(int j = 0; j < atomCount(); j++){
+                for(int k = 0; k < 3; k++){
+                    hessian(3 * j + k, i) += column[j][k];
+                }
+            }
+        }
+
+        symmetrize(hessian);
+    }
+
+    // frozen atoms
+    for(int i = 0; i < atomCount(); i++){
+        if(!d->atoms[i]->isFrozen()){
+            continue;
+        }
+
+        for(int j = 0; j < size; j++){
+            for(int k = 0; k < 3; k++){
+                hessian(3 * i + k, j) = 0;
+                hessian(j, 3 * i + k) = 0;
+            }
+        }
+    }
+
+    return hessian;
+}
+
+/// Returns the Hessian of the energy with respect to the
+/// coordinates of each atom in the force field. The Hessian is
+/// calculated with central differences of gradient() which requires
+/// six gradient calculations per atom.
+///
+/// \see ForceField::hessian()
+Matrix ForceField::numericalHessian() const
+{
+    int size = 3 * atomCount();
+    Matrix hessian(size, size);
+
+    for(int i = 0; i < size; i++){
+        if(d->atoms[i / 3]->isFrozen()){
+            continue;
+        }
+
+        std::vector<Vector3> direction(atomCount());
+        direction[i / 3][i % 3] = 1;
+
+        std::vector<Vector3> column = numericalHessianProduct(direction, false);
+        for(int j = 0; j < atomCount(); j++){
+            for(int k = 0; k < 3; k++){
+                hessian(3 * j + k, i) = column[j][k];
+            }
+        }
+    }
+
+    symmetrize(hessian);
+
+    return hessian;
+}
+
+/// Returns the product of the Hessian and \p vector which contains
+/// one component for each atom. The components of frozen atoms are
+/// ignored and their products are zero.
+///
+/// The product is calculated from the Hessian of each calculation
+/// without assembling the Hessian of the whole force field. Its cost
+/// grows with the number of calculations rather than the square of
+/// the number of atoms which makes it suitable for large systems.
+///
+/// \see ForceField::hessian()
+std::vector<Vector3> ForceField::hessianProduct(const std::vector<Vector3> &vector) const
+{
+    if(!d->flags.testFlag(AnalyticalGradient)){
+        return numericalHessianProduct(vector, false);
+    }
+
+    const std::vector<ForceFieldCalculation *> &calculations = d->evaluatedCalculations();
+
+    std::vector<Vector3> mobileVector = vector;
+    d->clearFrozenGradients(mobileVector);
+
+    std::vector<Vector3> product(atomCount());
+
+    foreach(const ForceFieldCalculation *calculation, calculations){
+        Matrix calculationHessian = calculation->hessian();
+
+        int calculationAtomCount = calculation->atomCount();
+        std::vector<int> indices(calculationAtomCount);
+        for(int i = 0; i < calculationAtomCount; i++){
+            indices[i] = atomIndex(calculation->atom(i));
+        }
+
+        for(int i = 0; i < calculationAtomCount; i++){
+            for(int k = 0; k < 3; k++){
+                Float sum = 0;
+
+                for(int j = 0; j < calculationAtomCount; j++){
+                    for(int l = 0; l < 3; l++){
+                        sum += calculationHessian(3 * i + k, 3 * j + l) * mobileVector[indices[j]][l];
+                    }
+                }
+
+                product[indices[i]][k] += sum;
+            }
+        }
+    }
+
+    if(d->globalTermsEnabled()){
+        std::vector<Vector3> globalProduct = numericalHessianProduct(mobileVector, true);
+
+        for(unsigned int i = 0; i < product.size(); i++){
+            product[i] += globalProduct[i];
+        }
+    }
+
+    d->clearFrozenGradients(product);
+
+    return product;
+}
+
 // --- Coordinates --------------------------------------------------------- //
 /// Updates the coordinates of molecule in the force field.
 void ForceField::readCoordinates(const Molecule *molecule)
@@ -485,6 +2759,19 @@ void ForceField::readCoordinates(const Atom *atom)
     }
 }
 
+/// Updates the coordinates of the atoms in the molecule of
+/// \p conformer to their positions in the conformer.
+void ForceField::readCoordinates(const Conformer *conformer)
+{
+    foreach(const Atom *atom, conformer->molecule()->atoms()){
+        ForceFieldAtom *forceFieldAtom = this->atom(atom);
+
+        if(forceFieldAtom){
+            forceFieldAtom->setPosition(conformer->position(atom));
+        }
+    }
+}
+
 /// Writes the coordinates to molecule from the force field.
 void ForceField::writeCoordinates(Molecule *molecule) const
 {
@@ -503,80 +2790,210 @@ void ForceField::writeCoordinates(Atom *atom) const
     }
 }
 
-// --- Energy Minimization ------------------------------------------------- //
-/// Perform one step of energy minimization. Returns \c true if
-/// converged. The minimization is considered converged when the
-/// root mean square gradient is below \p converganceValue.
-bool ForceField::minimizationStep(Float converganceValue)
+// --- Conformer Ensembles ------------------------------------------------ //
+/// Returns the energy of the force field for each conformer in
+/// \p conformers. The atoms of each conformer's molecule are placed
+/// at their positions in the conformer while all other atoms keep
+/// their current positions. The positions of the atoms in the force
+/// field are not changed.
+///
+/// This is much faster than calling readCoordinates() and energy()
+/// for each conformer because the calculations are divided between
+/// effectiveThreadCount() threads which each evaluate their share of
+/// the calculations for every conformer. The calculations read the
+/// atom positions from the conformer instead of from the atoms and
+/// so the force field must not be evaluated from another thread
+/// while this method runs. Concurrent calls to energies() on the
+/// same force field are evaluated one after another.
+///
+/// The following example shows how to calculate the energy of each
+/// conformer of a molecule.
+///
+/// \code
+/// std::vector<Float> energies = forceField->energies(molecule->conformers());
+/// \endcode
+std::vector<Float> ForceField::energies(const std::vector<Conformer *> &conformers) const
 {
-    // calculate gradient
-    std::vector<Vector3> gradient = this->gradient();
+    return ensembleEnergies(conformerCoordinates(conformers), 0);
+}
+
+/// Returns the energy of the force field for each conformer in
+/// \p conformers and stores the gradient for each conformer in
+/// \p gradients. The gradients are stored one after another with
+/// atomCount() gradients per conformer.
+std::vector<Float> ForceField::energies(const std::vector<Conformer *> &conformers, std::vector<Vector3> &gradients) const
+{
+    return ensembleEnergies(conformerCoordinates(conformers), &gradients);
+}
+
+/// Returns the energy of the force field for each set of atom
+/// coordinates in \p coordinates. The coordinates for each set are
+/// stored one after another with the position for each atom in the
+/// same order as atoms(). Returns an empty list if the number of
+/// coordinates is not a multiple of atomCount().
+std::vector<Float> ForceField::energies(const std::vector<Point3> &coordinates) const
+{
+    return ensembleEnergies(coordinates, 0);
+}
 
-    // perform line search
-    std::vector<Point3> initialPositions(atomCount());
+/// Returns the energy of the force field for each set of atom
+/// coordinates in \p coordinates and stores the gradient for each
+/// set in \p gradients. The gradients have the same layout as the
+/// coordinates.
+std::vector<Float> ForceField::energies(const std::vector<Point3> &coordinates, std::vector<Vector3> &gradients) const
+{
+    return ensembleEnergies(coordinates, &gradients);
+}
 
-    Float step = 0.05;
-    Float stepConv = 1e-5;
-    int stepCount = 10;
+// --- Monte Carlo Moves -------------------------------------------------- //
+/// Moves \p atom to \p position and returns the resulting change in
+/// energy.
+///
+/// \see trialMove(const std::vector<ForceFieldAtom *> &atoms, const std::vector<Point3> &positions)
+Float ForceField::trialMove(ForceFieldAtom *atom, const Point3 &position)
+{
+    return trialMove(std::vector<ForceFieldAtom *>(1, atom), std::vector<Point3>(1, position));
+}
 
-    Float initialEnergy = energy();
+/// Moves each atom in \p atoms to the corresponding position in
+/// \p positions and returns the resulting change in energy. Only
+/// the calculations containing at least one of the moved atoms are
+/// evaluated which makes this much faster than calling energy()
+/// before and after the move.
+///
+/// If the electrostatics method or the implicit solvent is enabled
+/// their terms depend on every atom and are evaluated in full before
+/// and after the move. The returned change in energy then still
+/// matches energy() but the move is no longer local and costs about
+/// as much as two calls to energy().
+///
+/// The move must be followed by a call to either acceptTrialMove()
+/// or rejectTrialMove(). Starting a new trial move accepts the
+/// previous one.
+///
+/// The following example shows a metropolis monte carlo step:
+/// \code
+/// Float deltaEnergy = forceField->trialMove(atom, newPosition);
+///
+/// if(deltaEnergy < 0 || exp(-beta * deltaEnergy) > random()){
+///     forceField->acceptTrialMove();
+///     energy += deltaEnergy;
+/// }
+/// else{
+///     forceField->rejectTrialMove();
+/// }
+/// \endcode
+Float ForceField::trialMove(const std::vector<ForceFieldAtom *> &atoms, const std::vector<Point3> &positions)
+{
+    acceptTrialMove();
 
-    for(int i = 0; i < stepCount; i++){
-        for(int atomIndex = 0; atomIndex < atomCount(); atomIndex++){
-            ForceFieldAtom *atom = d->atoms[atomIndex];
+    // find each calculation containing a moved atom
+    std::vector<ForceFieldCalculation *> calculations;
+    foreach(const ForceFieldAtom *atom, atoms){
+        const std::vector<ForceFieldCalculation *> &atomCalculations = this->atomCalculations(atom);
+        calculations.insert(calculations.end(), atomCalculations.begin(), atomCalculations.end());
+    }
 
-            initialPositions[atomIndex] = atom->position();
-            atom->moveBy(-gradient[atomIndex] * step);
-        }
+    std::sort(calculations.begin(), calculations.end());
+    calculations.erase(std::unique(calculations.begin(), calculations.end()), calculations.end());
 
-        Float finalEnergy = energy();
+    // drop the pairwise electrostatic calculations which are
+    // replaced by the electrostatics method
+    if(d->electrostaticsEnabled()){
+        d->updateElectrostatics();
 
-        // if the final energy is NaN then most likely the
-        // simulation exploded so we reset the initial atom
-        // positions and then 'wiggle' each atom by one
-        // Angstrom in a random direction
-        if(qIsNaN(finalEnergy)){
-            for(int atomIndex = 0; atomIndex < atomCount(); atomIndex++){
-                d->atoms[atomIndex]->setPosition(initialPositions[atomIndex]);
-                d->atoms[atomIndex]->moveBy(Vector3::randomUnitVector());
+        std::vector<ForceFieldCalculation *> evaluated;
+        foreach(ForceFieldCalculation *calculation, calculations){
+            if(!d->isReplacedByElectrostatics(calculation)){
+                evaluated.push_back(calculation);
             }
+        }
 
-            // recalculate gradient
-            gradient = this->gradient();
+        calculations.swap(evaluated);
+    }
 
-            // continue to next step
-            continue;
-        }
+    bool globalTerms = d->globalTermsEnabled();
 
-        if(finalEnergy < initialEnergy && qAbs(finalEnergy - initialEnergy) < stepConv){
-            break;
-        }
-        else if(finalEnergy < initialEnergy){
-            // we reduced the energy, so set a bigger step size
-            step *= 2;
+    // initial energy
+    Float initialEnergy = 0;
+    foreach(const ForceFieldCalculation *calculation, calculations){
+        initialEnergy += calculation->energy();
+    }
 
-            // maximum step size is 1
-            if(step > 1){
-                step = 1;
-            }
+    if(globalTerms){
+        initialEnergy += d->globalEnergy(0);
+    }
 
-            // the initial energy for the next step
-            // is the final energy of this step
-            initialEnergy = finalEnergy;
-        }
-        else if(finalEnergy > initialEnergy){
-            // we went too far, so reset initial atom positions
-            for(int atomIndex = 0; atomIndex < atomCount(); atomIndex++){
-                d->atoms[atomIndex]->setPosition(initialPositions[atomIndex]);
-            }
+    // move atoms
+    d->trialMoveAtoms = atoms;
+    d->trialMoveInitialPositions.resize(atoms.size());
+    for(unsigned int i = 0; i < atoms.size(); i++){
+        d->trialMoveInitialPositions[i] = atoms[i]->position();
+        atoms[i]->setPosition(positions[i]);
+    }
 
-            // and reduce step size
-            step *= 0.1;
-        }
+    // final energy
+    Float finalEnergy = 0;
+    foreach(const ForceFieldCalculation *calculation, calculations){
+        finalEnergy += calculation->energy();
+    }
+
+    if(globalTerms){
+        finalEnergy += d->globalEnergy(0);
+    }
+
+    return finalEnergy - initialEnergy;
+}
+
+/// Accepts the current trial move. The moved atoms keep their new
+/// positions.
+void ForceField::acceptTrialMove()
+{
+    d->trialMoveAtoms.clear();
+    d->trialMoveInitialPositions.clear();
+}
+
+/// Rejects the current trial move. The moved atoms are restored to
+/// their positions before the move.
+void ForceField::rejectTrialMove()
+{
+    for(unsigned int i = 0; i < d->trialMoveAtoms.size(); i++){
+        d->trialMoveAtoms[i]->setPosition(d->trialMoveInitialPositions[i]);
+    }
+
+    acceptTrialMove();
+}
+
+/// Returns \c true if there is a trial move that has not yet been
+/// accepted or rejected.
+bool ForceField::hasTrialMove() const
+{
+    return !d->trialMoveAtoms.empty();
+}
+
+// --- Energy Minimization ------------------------------------------------- //
+/// Perform one step of energy minimization. Returns \c true if
+/// converged. The minimization is considered converged when the
+/// root mean square gradient is below \p converganceValue or when
+/// the energy can not be lowered any further.
+///
+/// The steps are performed with the l-bfgs algorithm. For more
+/// control over the minimization use the ForceFieldMinimizer class.
+///
+/// \see ForceFieldMinimizer
+bool ForceField::minimizationStep(Float converganceValue)
+{
+    if(!d->minimizer){
+        d->minimizer = new ForceFieldMinimizer(this, ForceFieldMinimizer::Lbfgs);
+        d->minimizer->setEnergyConvergence(0);
+        d->minimizer->setMaximumGradientConvergence(0);
     }
 
-    // check for convergance
-    return rootMeanSquareGradient() < converganceValue;
+    d->minimizer->setRootMeanSquareGradientConvergence(converganceValue);
+
+    bool converged = d->minimizer->step();
+
+    return converged || d->minimizer->status() == ForceFieldMinimizer::Failed;
 }
 
 QFuture<bool> ForceField::minimizationStepAsync(Float converganceValue)
@@ -587,6 +3004,10 @@ QFuture<bool> ForceField::minimizationStepAsync(Float converganceValue)
 // --- Geometry ------------------------------------------------------------ //
 Float ForceField::distance(const ForceFieldAtom *a, const ForceFieldAtom *b) const
 {
+    if(d->unitCell){
+        return d->unitCell->distance(a->position(), b->position());
+    }
+
     return Point3::distance(a->position(), b->position());
 }
 
@@ -597,7 +3018,11 @@ Float ForceField::bondAngle(const ForceFieldAtom *a, const ForceFieldAtom *b, co
 
 Float ForceField::bondAngleRadians(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c) const
 {
-    return Point3::angleRadians(a->position(), b->position(), c->position());
+    Point3 center = b->position();
+
+    return Point3::angleRadians(imagePosition(unitCell(), a, center),
+                                center,
+                                imagePosition(unitCell(), c, center));
 }
 
 Float ForceField::torsionAngle(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c, const ForceFieldAtom *d) const
@@ -607,7 +3032,15 @@ Float ForceField::torsionAngle(const ForceFieldAtom *a, const ForceFieldAtom *b,
 
 Float ForceField::torsionAngleRadians(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c, const ForceFieldAtom *d) const
 {
-    return Point3::torsionAngleRadians(a->position(), b->position(), c->position(), d->position());
+    const UnitCell *cell = unitCell();
+
+    Point3 pb = b->position();
+    Point3 pc = imagePosition(cell, c, pb);
+
+    return Point3::torsionAngleRadians(imagePosition(cell, a, pb),
+                                       pb,
+                                       pc,
+                                       imagePosition(cell, d, pc));
 }
 
 Float ForceField::wilsonAngle(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c, const ForceFieldAtom *d) const
@@ -617,7 +3050,14 @@ Float ForceField::wilsonAngle(const ForceFieldAtom *a, const ForceFieldAtom *b,
 
 Float ForceField::wilsonAngleRadians(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c, const ForceFieldAtom *d) const
 {
-    return Point3::wilsonAngleRadians(a->position(), b->position(), c->position(), d->position());
+    const UnitCell *cell = unitCell();
+
+    Point3 pb = b->position();
+
+    return Point3::wilsonAngleRadians(imagePosition(cell, a, pb),
+                                      pb,
+                                      imagePosition(cell, c, pb),
+                                      imagePosition(cell, d, pb));
 }
 
 // --- Error Handling ------------------------------------------------------ //
@@ -633,6 +3073,241 @@ std::string ForceField::errorString() const
     return d->errorString;
 }
 
+// --- Internal Methods ---------------------------------------------------- //
+int ForceField::atomIndex(const ForceFieldAtom *atom) const
+{
+    return d->atomIndices.value(atom, -1);
+}
+
+const std::vector<ForceFieldCalculation *>& ForceField::atomCalculations(const ForceFieldAtom *atom) const
+{
+    static const std::vector<ForceFieldCalculation *> empty;
+
+    d->updateAtomCalculations();
+
+    int index = atomIndex(atom);
+    if(index == -1){
+        return empty;
+    }
+
+    return d->atomCalculations[index];
+}
+
+// Returns the positions of the atoms for each of the conformers one
+// after another.
+std::vector<Point3> ForceField::conformerCoordinates(const std::vector<Conformer *> &conformers) const
+{
+    std::vector<Point3> coordinates;
+    coordinates.reserve(conformers.size() * d->atoms.size());
+
+    foreach(const Conformer *conformer, conformers){
+        foreach(const ForceFieldAtom *atom, d->atoms){
+            if(atom->atom()->molecule() == conformer->molecule()){
+                coordinates.push_back(conformer->position(atom->atom()));
+            }
+            else{
+                coordinates.push_back(atom->position());
+            }
+        }
+    }
+
+    return coordinates;
+}
+
+// Calculates the energy (and gradient if gradients is not null) for
+// each set of coordinates. The calculations are divided between the
+// threads and each thread evaluates its calculations for every set
+// of coordinates, reading the atom positions from the coordinates
+// instead of from the atoms. Global terms such as the particle mesh
+// Ewald electrostatics and the implicit solvent keep their own
+// per-force field state and so with those enabled the atoms are
+// instead moved to each set of coordinates in turn.
+std::vector<Float> ForceField::ensembleEnergies(const std::vector<Point3> &coordinates, std::vector<Vector3> *gradients) const
+{
+    int atomCount = d->atoms.size();
+    if(atomCount == 0 || coordinates.size() % atomCount != 0){
+        if(gradients){
+            gradients->clear();
+        }
+
+        return std::vector<Float>();
+    }
+
+    int conformerCount = coordinates.size() / atomCount;
+    std::vector<Float> energies(conformerCount);
+    if(gradients){
+        gradients->assign(coordinates.size(), Vector3());
+    }
+
+    if(conformerCount == 0){
+        return energies;
+    }
+
+    QMutexLocker locker(&d->ensembleMutex);
+
+    if(d->globalTermsEnabled() || (gradients && !d->flags.testFlag(AnalyticalGradient))){
+        std::vector<Point3> initialPositions(atomCount);
+        for(int i = 0; i < atomCount; i++){
+            initialPositions[i] = d->atoms[i]->position();
+        }
+
+        for(int i = 0; i < conformerCount; i++){
+            for(int j = 0; j < atomCount; j++){
+                d->atoms[j]->setPosition(coordinates[i * atomCount + j]);
+            }
+
+            energies[i] = energy();
+
+            if(gradients){
+                std::vector<Vector3> gradient = this->gradient();
+                std::copy(gradient.begin(), gradient.end(), gradients->begin() + i * atomCount);
+            }
+        }
+
+        for(int i = 0; i < atomCount; i++){
+            d->atoms[i]->setPosition(initialPositions[i]);
+        }
+
+        return energies;
+    }
+
+    const int parallelThreshold = 5000;
+
+    int calculationCount = d->calculations.size();
+    int chunkCount = qMin(effectiveThreadCount(), calculationCount);
+    if(static_cast<qint64>(calculationCount) * conformerCount < parallelThreshold){
+        chunkCount = qMin(1, calculationCount);
+    }
+
+    std::vector<ForceFieldEnsembleChunk> chunks(chunkCount);
+    for(int i = 0; i < chunkCount; i++){
+        ForceFieldEnsembleChunk &chunk = chunks[i];
+        chunk.begin = &d->calculations[0] + (static_cast<qint64>(calculationCount) * i) / chunkCount;
+        chunk.end = &d->calculations[0] + (static_cast<qint64>(calculationCount) * (i + 1)) / chunkCount;
+        chunk.coordinates = &coordinates[0];
+        chunk.atomCount = atomCount;
+        chunk.conformerCount = conformerCount;
+        chunk.calculateGradients = gradients != 0;
+    }
+
+    if(chunkCount == 1){
+        // calculate energies sequentially
+        chunks[0].energies.swap(energies);
+        if(gradients){
+            chunks[0].gradients.swap(*gradients);
+        }
+
+        ForceFieldPrivate::calculateEnsembleChunk(chunks[0]);
+
+        chunks[0].energies.swap(energies);
+        if(gradients){
+            chunks[0].gradients.swap(*gradients);
+        }
+    }
+    else if(chunkCount > 1){
+        // calculate energies in parallel
+        for(int i = 0; i < chunkCount; i++){
+            chunks[i].energies.resize(conformerCount);
+            if(gradients){
+                chunks[i].gradients.resize(coordinates.size());
+            }
+        }
+
+        QtConcurrent::blockingMap(chunks, ForceFieldPrivate::calculateEnsembleChunk);
+
+        // sum partial energies and gradients in chunk order
+        foreach(const ForceFieldEnsembleChunk &chunk, chunks){
+            for(int i = 0; i < conformerCount; i++){
+                energies[i] += chunk.energies[i];
+            }
+
+            if(gradients){
+                for(unsigned int i = 0; i < gradients->size(); i++){
+                    (*gradients)[i] += chunk.gradients[i];
+                }
+            }
+        }
+    }
+
+    // frozen atoms do not move
+    if(gradients && frozenAtomCount() > 0){
+        for(int i = 0; i < atomCount; i++){
+            if(d->atoms[i]->isFrozen()){
+                for(int j = 0; j < conformerCount; j++){
+                    (*gradients)[j * atomCount + i] = Vector3();
+                }
+            }
+        }
+    }
+
+    return energies;
+}
+
+// Returns the product of the Hessian and vector calculated with
+// central differences of the gradient along vector. If globalTerms
+// is true only the gradient of the terms calculated by the force
+// field over all of its atoms (the electrostatics method and the
+// implicit solvent) is used.
+std::vector<Vector3> ForceField::numericalHessianProduct(const std::vector<Vector3> &vector, bool globalTerms) const
+{
+    const Float epsilon = 1.0e-5;
+
+    std::vector<Vector3> product(atomCount());
+
+    // move the atom with the largest component by epsilon
+    Float largest = 0;
+    for(int i = 0; i < atomCount(); i++){
+        if(!d->atoms[i]->isFrozen()){
+            largest = qMax(largest, vector[i].length());
+        }
+    }
+
+    if(largest == 0){
+        return product;
+    }
+
+    Float step = epsilon / largest;
+
+    std::vector<Point3> positions(atomCount());
+    for(int i = 0; i < atomCount(); i++){
+        positions[i] = d->atoms[i]->position();
+    }
+
+    std::vector<Vector3> gradients[2];
+
+    for(int sign = 0; sign < 2; sign++){
+        Float displacement = sign == 0 ? step : -step;
+
+        for(int i = 0; i < atomCount(); i++){
+            if(!d->atoms[i]->isFrozen()){
+                d->atoms[i]->setPosition(positions[i].movedBy(vector[i] * displacement));
+            }
+        }
+
+        if(globalTerms){
+            d->globalEnergy(&gradients[sign]);
+        }
+        else{
+            gradients[sign] = gradient();
+        }
+    }
+
+    // restore initial positions
+    for(int i = 0; i < atomCount(); i++){
+        if(!d->atoms[i]->isFrozen()){
+            d->atoms[i]->setPosition(positions[i]);
+        }
+    }
+
+    for(int i = 0; i < atomCount(); i++){
+        product[i] = (gradients[0][i] - gradients[1][i]) / (2 * step);
+    }
+
+    d->clearFrozenGradients(product);
+
+    return product;
+}
+
 // --- Static Methods ------------------------------------------------------ //
 /// Create a new force field from \p name. If \p name is invalid or
 /// a force field with \p name is not available \c 0 is returned.
@@ -44,6 +44,7 @@
 #include <vector>
 
 #include "point3.h"
+#include "matrix.h"
 #include "vector3.h"
 #include "forcefieldatom.h"
 #include "forcefieldcalculation.h"
@@ -52,6 +53,9 @@ namespace chemkit {
 
 class Atom;
 class Molecule;
+class Conformer;
+class UnitCell;
+class ForceFieldProfile;
 class ForceFieldPrivate;
 
 class CHEMKIT_EXPORT ForceField
@@ -63,6 +67,23 @@ class CHEMKIT_EXPORT ForceField
         };
         Q_DECLARE_FLAGS(Flags, Flag)
 
+        enum NumericalGradientMethod {
+            ForwardDifference,
+            CentralDifference
+        };
+
+        enum ElectrostaticsMethod {
+            Coulomb,
+            ParticleMeshEwald,
+            ReactionField,
+            DampedShiftedForce
+        };
+
+        enum ElectrostaticsPrecision {
+            DoublePrecision,
+            SinglePrecision
+        };
+
         // typedefs
         typedef ForceField* (*CreateFunction)();
 
@@ -86,6 +107,8 @@ class CHEMKIT_EXPORT ForceField
         virtual bool setup();
         bool isSetup() const;
         virtual void clear();
+        void setTopologyTemplatesEnabled(bool enabled);
+        bool topologyTemplatesEnabled() const;
 
         // parameters
         void setParameterSet(const std::string &name);
@@ -94,21 +117,101 @@ class CHEMKIT_EXPORT ForceField
         void setParameterFile(const std::string &fileName);
         std::string parameterFile() const;
 
+        // threading
+        void setThreadCount(int count);
+        int threadCount() const;
+        int effectiveThreadCount() const;
+        void setDeterministicReduction(bool enabled);
+        bool deterministicReduction() const;
+
+        // periodic boundaries
+        void setUnitCell(const UnitCell *cell);
+        const UnitCell* unitCell() const;
+
+        // electrostatics
+        void setElectrostaticsMethod(ElectrostaticsMethod method);
+        ElectrostaticsMethod electrostaticsMethod() const;
+        void setElectrostaticsCutoff(Float cutoff);
+        Float electrostaticsCutoff() const;
+        void setEwaldTolerance(Float tolerance);
+        Float ewaldTolerance() const;
+        void setEwaldGridSpacing(Float spacing);
+        Float ewaldGridSpacing() const;
+        void setEwaldOrder(int order);
+        int ewaldOrder() const;
+        void setReactionFieldDielectric(Float dielectric);
+        Float reactionFieldDielectric() const;
+        void setElectrostaticsDamping(Float damping);
+        Float electrostaticsDamping() const;
+        void setElectrostaticsPrecision(ElectrostaticsPrecision precision);
+        ElectrostaticsPrecision electrostaticsPrecision() const;
+
+        // implicit solvent
+        void setImplicitSolventEnabled(bool enabled);
+        bool implicitSolventEnabled() const;
+        void setSolventDielectric(Float dielectric);
+        Float solventDielectric() const;
+        void setSurfaceTension(Float tension);
+        Float surfaceTension() const;
+        void setImplicitSolventCutoff(Float cutoff);
+        Float implicitSolventCutoff() const;
+        Float solvationEnergy() const;
+        std::vector<Float> bornRadii() const;
+
         // calculations
         std::vector<ForceFieldCalculation *> calculations() const;
+        std::vector<ForceFieldCalculation *> calculations(const ForceFieldAtom *atom) const;
+        ForceFieldCalculation* calculation(int index) const;
         int calculationCount() const;
         virtual Float energy() const;
         std::vector<Vector3> gradient() const;
         std::vector<Vector3> numericalGradient() const;
+        void setNumericalGradientMethod(NumericalGradientMethod method);
+        NumericalGradientMethod numericalGradientMethod() const;
         Float largestGradient() const;
         Float rootMeanSquareGradient() const;
+        Matrix hessian() const;
+        Matrix numericalHessian() const;
+        std::vector<Vector3> hessianProduct(const std::vector<Vector3> &vector) const;
+
+        // profiling
+        void setProfilingEnabled(bool enabled);
+        bool profilingEnabled() const;
+        const ForceFieldProfile* profile() const;
+        void clearProfile();
+
+        // frozen atoms
+        int frozenAtomCount() const;
+        Float frozenEnergy() const;
+
+        // conformer ensembles
+        std::vector<Float> energies(const std::vector<Conformer *> &conformers) const;
+        std::vector<Float> energies(const std::vector<Conformer *> &conformers, std::vector<Vector3> &gradients) const;
+        std::vector<Float> energies(const std::vector<Point3> &coordinates) const;
+        std::vector<Float> energies(const std::vector<Point3> &coordinates, std::vector<Vector3> &gradients) const;
+
+        // restraints
+        ForceFieldCalculation* addPositionRestraint(ForceFieldAtom *atom, const Point3 &position, Float forceConstant);
+        ForceFieldCalculation* addDistanceRestraint(ForceFieldAtom *a, ForceFieldAtom *b, Float distance, Float forceConstant);
+        void removeRestraint(ForceFieldCalculation *restraint);
+        void removeRestraints();
+        std::vector<ForceFieldCalculation *> restraints() const;
+        int restraintCount() const;
 
         // coordinates
         void readCoordinates(const Molecule *molecule);
         void readCoordinates(const Atom *atom);
+        void readCoordinates(const Conformer *conformer);
         void writeCoordinates(Molecule *molecule) const;
         void writeCoordinates(Atom *atom) const;
 
+        // monte carlo moves
+        Float trialMove(ForceFieldAtom *atom, const Point3 &position);
+        Float trialMove(const std::vector<ForceFieldAtom *> &atoms, const std::vector<Point3> &positions);
+        void acceptTrialMove();
+        void rejectTrialMove();
+        bool hasTrialMove() const;
+
         // energy minimization
         bool minimizationStep(Float converganceValue = 0.1);
         QFuture<bool> minimizationStepAsync(Float converganceValue = 0.1);
@@ -137,10 +240,28 @@ class CHEMKIT_EXPORT ForceField
         void addCalculation(ForceFieldCalculation *calculation);
         void removeCalculation(ForceFieldCalculation *calculation);
         void setCalculationSetup(ForceFieldCalculation *calculation, bool setup);
+        virtual ForceFieldCalculation* createPairCalculation(ForceFieldCalculation::Type type, const ForceFieldAtom *a, const ForceFieldAtom *b) const;
+        std::vector<const Molecule *> topologyTemplates() const;
+        virtual bool setupMolecule(const Molecule *molecule, std::vector<ForceFieldAtom *> &atoms, std::vector<ForceFieldCalculation *> &calculations);
+        virtual bool setupCalculation(ForceFieldCalculation *calculation);
+        bool setupMolecules(const std::vector<const Molecule *> &molecules, std::vector<std::vector<ForceFieldAtom *> > &atoms, std::vector<std::vector<ForceFieldCalculation *> > &calculations);
+        bool setupCalculations(const std::vector<ForceFieldCalculation *> &calculations);
         void addParameterSet(const std::string &name, const std::string &fileName);
         void removeParameterSet(const std::string &name);
         void setErrorString(const std::string &errorString);
 
+    private:
+        int atomIndex(const ForceFieldAtom *atom) const;
+        const std::vector<ForceFieldCalculation *>& atomCalculations(const ForceFieldAtom *atom) const;
+        std::vector<Vector3> numericalHessianProduct(const std::vector<Vector3> &vector, bool globalTerms) const;
+        void frozenAtomsChanged();
+        std::vector<Point3> conformerCoordinates(const std::vector<Conformer *> &conformers) const;
+        std::vector<Float> ensembleEnergies(const std::vector<Point3> &coordinates, std::vector<Vector3> *gradients) const;
+
+        friend class ForceFieldAtom;
+        friend class ForceFieldPrivate;
+        friend class ReceptorGridPrivate;
+
     private:
         ForceFieldPrivate* const d;
 };
@@ -52,7 +52,9 @@ class ForceFieldAtomPrivate
         std::string type;
         Float charge;
         Point3 position;
+        bool frozen;
         bool setup;
+        int index;
         ForceField *forceField;
 };
 
@@ -73,7 +75,9 @@ ForceFieldAtom::ForceFieldAtom(ForceField *forceField, const Atom *atom)
     d->atom = atom;
     d->position = atom->position();
     d->charge = 0;
+    d->frozen = false;
     d->setup = false;
+    d->index = -1;
 }
 
 /// Destroys the force field atom object.
@@ -92,9 +96,7 @@ const Atom* ForceFieldAtom::atom() const
 /// Returns the atom's index.
 int ForceFieldAtom::index() const
 {
-    const std::vector<ForceFieldAtom *> &atoms = forceField()->atoms();
-
-    return std::distance(atoms.begin(), std::find(atoms.begin(), atoms.end(), this));
+    return d->index;
 }
 
 /// Sets the symbolic type for the atom.
@@ -114,7 +116,15 @@ std::string ForceFieldAtom::type() const
 /// Sets the charge of the atom.
 void ForceFieldAtom::setCharge(Float charge)
 {
+    if(charge == d->charge){
+        return;
+    }
+
     d->charge = charge;
+
+    if(d->frozen){
+        d->forceField->frozenAtomsChanged();
+    }
 }
 
 /// Returns the charge of the atom.
@@ -123,6 +133,28 @@ Float ForceFieldAtom::charge() const
     return d->charge;
 }
 
+/// Sets whether the atom is frozen. Frozen atoms are held fixed
+/// during energy minimization and their gradient is zero. The
+/// calculations in which every atom is frozen have a constant energy
+/// and are not evaluated again while the atoms remain frozen.
+///
+/// \see ForceField::frozenAtomCount()
+void ForceFieldAtom::setFrozen(bool frozen)
+{
+    if(frozen == d->frozen){
+        return;
+    }
+
+    d->frozen = frozen;
+    d->forceField->frozenAtomsChanged();
+}
+
+/// Returns \c true if the atom is frozen.
+bool ForceFieldAtom::isFrozen() const
+{
+    return d->frozen;
+}
+
 /// Returns \c true if the atom is setup.
 bool ForceFieldAtom::isSetup() const
 {
@@ -142,10 +174,10 @@ Float ForceFieldAtom::energy() const
 {
     Float energy = 0;
 
-    Q_FOREACH(const ForceFieldCalculation *calculation, forceField()->calculations()){
-        if(calculation->contains(this)){
-            energy += calculation->energy();
-        }
+    const std::vector<ForceFieldCalculation *> &calculations = forceField()->atomCalculations(this);
+
+    for(unsigned int i = 0; i < calculations.size(); i++){
+        energy += calculations[i]->energy();
     }
 
     return energy;
@@ -185,7 +217,17 @@ bool ForceFieldAtom::isOneFour(const ForceFieldAtom *atom) const
 /// Sets the position of the atom.
 void ForceFieldAtom::setPosition(const Point3 &position)
 {
+    if(position.x() == d->position.x() &&
+       position.y() == d->position.y() &&
+       position.z() == d->position.z()){
+        return;
+    }
+
     d->position = position;
+
+    if(d->frozen){
+        d->forceField->frozenAtomsChanged();
+    }
 }
 
 /// Returns the position of the atom.
@@ -197,13 +239,19 @@ Point3 ForceFieldAtom::position() const
 /// Moves the atom's position by \p vector.
 void ForceFieldAtom::moveBy(const Vector3 &vector)
 {
-    d->position.moveBy(vector);
+    setPosition(d->position.movedBy(vector));
 }
 
 /// Moves the atom's position by (dx, dy, dz).
 void ForceFieldAtom::moveBy(Float dx, Float dy, Float dz)
 {
-    d->position.moveBy(dx, dy, dz);
+    setPosition(d->position.movedBy(dx, dy, dz));
+}
+
+// --- Internal Methods ---------------------------------------------------- //
+void ForceFieldAtom::setIndex(int index)
+{
+    d->index = index;
 }
 
 } // end chemkit namespace
@@ -61,6 +61,8 @@ class CHEMKIT_EXPORT ForceFieldAtom
         virtual std::string type() const;
         void setCharge(Float charge);
         Float charge() const;
+        void setFrozen(bool frozen);
+        bool isFrozen() const;
         bool isSetup() const;
         ForceField* forceField() const;
 
@@ -77,6 +79,11 @@ class CHEMKIT_EXPORT ForceFieldAtom
         void moveBy(const Vector3 &vector);
         void moveBy(Float dx, Float dy, Float dz);
 
+    private:
+        void setIndex(int index);
+
+        friend class ForceField;
+
     private:
         ForceFieldAtomPrivate* const d;
 };
@@ -0,0 +1,535 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "forcefieldbatchminimizer.h"
+
+#include "foreach.h"
+#include "molecule.h"
+#include "forcefield.h"
+#include "moleculefile.h"
+
+namespace chemkit {
+
+namespace {
+
+// The result of minimizing a single molecule.
+class BatchMinimizerResult
+{
+    public:
+        ForceFieldMinimizer::Status status;
+        Float initialEnergy;
+        Float energy;
+        Float rootMeanSquareGradient;
+        int stepCount;
+        Float elapsedTime;
+        std::string errorString;
+};
+
+} // end anonymous namespace
+
+// === ForceFieldBatchMinimizerPrivate ===================================== //
+class ForceFieldBatchMinimizerPrivate
+{
+    public:
+        std::string forceField;
+        ForceFieldMinimizer::Algorithm algorithm;
+        int threadCount;
+        Float energyConvergence;
+        Float rootMeanSquareGradientConvergence;
+        Float maximumGradientConvergence;
+        int maximumStepCount;
+        QAtomicInt canceled;
+        std::string errorString;
+
+        // the molecules being minimized and the index of the next
+        // molecule to be claimed by a thread
+        std::vector<Molecule *> molecules;
+        QAtomicInt nextMolecule;
+        std::vector<BatchMinimizerResult> results;
+
+        void minimizeMolecules(ForceField *forceField, ForceFieldMinimizer *minimizer);
+};
+
+// Minimizes molecules until none are left. Each thread runs this
+// with its own force field and minimizer which are cleared and
+// reused for every molecule instead of being created again.
+void ForceFieldBatchMinimizerPrivate::minimizeMolecules(ForceField *forceField, ForceFieldMinimizer *minimizer)
+{
+    QTime timer;
+
+    for(;;){
+        if(canceled){
+            return;
+        }
+
+        int index = nextMolecule.fetchAndAddOrdered(1);
+        if(index >= static_cast<int>(molecules.size())){
+            return;
+        }
+
+        Molecule *molecule = molecules[index];
+        BatchMinimizerResult &result = results[index];
+
+        timer.start();
+
+        forceField->clear();
+        forceField->addMolecule(molecule);
+
+        if(!forceField->setup()){
+            result.status = ForceFieldMinimizer::Failed;
+            result.errorString = forceField->errorString();
+            result.elapsedTime = timer.elapsed();
+            forceField->clear();
+            continue;
+        }
+
+        minimizer->reset();
+        result.initialEnergy = forceField->energy();
+        minimizer->minimize();
+        forceField->writeCoordinates(molecule);
+
+        result.status = minimizer->status();
+        result.energy = minimizer->energy();
+        result.rootMeanSquareGradient = minimizer->rootMeanSquareGradient();
+        result.stepCount = minimizer->stepCount();
+        result.elapsedTime = timer.elapsed();
+
+        forceField->clear();
+    }
+}
+
+namespace {
+
+// The BatchMinimizerWorkspace class contains the force field and
+// minimizer used by a single thread.
+class BatchMinimizerWorkspace
+{
+    public:
+        ForceFieldBatchMinimizerPrivate *batch;
+        ForceField *forceField;
+        ForceFieldMinimizer *minimizer;
+};
+
+void minimizeWorkspaceMolecules(BatchMinimizerWorkspace &workspace)
+{
+    workspace.batch->minimizeMolecules(workspace.forceField, workspace.minimizer);
+}
+
+} // end anonymous namespace
+
+// === ForceFieldBatchMinimizer ============================================ //
+/// \class ForceFieldBatchMinimizer forcefieldbatchminimizer.h chemkit/forcefieldbatchminimizer.h
+/// \ingroup chemkit
+/// \brief The ForceFieldBatchMinimizer class minimizes the energies
+///        of many molecules in parallel.
+///
+/// Each molecule is minimized independently with its own force
+/// field setup. The molecules are distributed over a pool of
+/// threads as each thread becomes free. Every thread reuses a single
+/// force field and minimizer for all of the molecules it handles so
+/// the force field parameters are only loaded once per thread and
+/// the atom, calculation and minimizer storage is not reallocated
+/// for each molecule.
+///
+/// The results for each molecule (see status(), energy() and
+/// elapsedTime()) are stored in the same order as the input
+/// molecules regardless of which thread minimized them.
+///
+/// The following example shows how to minimize each molecule in a
+/// file with the mmff force field and write them to a new file.
+///
+/// \code
+/// MoleculeFile input("ligands.sdf");
+/// input.read();
+///
+/// ForceFieldBatchMinimizer minimizer("mmff");
+/// MoleculeFile output("minimized.sdf");
+/// minimizer.minimize(&input, &output);
+/// output.write();
+/// \endcode
+///
+/// \see ForceFieldMinimizer
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new batch minimizer using the force field with \p name
+/// and \p algorithm.
+ForceFieldBatchMinimizer::ForceFieldBatchMinimizer(const std::string &forceField, ForceFieldMinimizer::Algorithm algorithm)
+    : d(new ForceFieldBatchMinimizerPrivate)
+{
+    d->forceField = forceField;
+    d->algorithm = algorithm;
+    d->threadCount = 0;
+    d->energyConvergence = 1.0e-7;
+    d->rootMeanSquareGradientConvergence = 0.1;
+    d->maximumGradientConvergence = 0.5;
+    d->maximumStepCount = 1000;
+    d->canceled = 0;
+}
+
+/// Destroys the batch minimizer object.
+ForceFieldBatchMinimizer::~ForceFieldBatchMinimizer()
+{
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Sets the name of the force field used to minimize the molecules
+/// to \p name.
+void ForceFieldBatchMinimizer::setForceField(const std::string &name)
+{
+    d->forceField = name;
+}
+
+/// Returns the name of the force field used to minimize the
+/// molecules.
+std::string ForceFieldBatchMinimizer::forceField() const
+{
+    return d->forceField;
+}
+
+/// Sets the minimization algorithm to \p algorithm.
+void ForceFieldBatchMinimizer::setAlgorithm(ForceFieldMinimizer::Algorithm algorithm)
+{
+    d->algorithm = algorithm;
+}
+
+/// Returns the minimization algorithm.
+ForceFieldMinimizer::Algorithm ForceFieldBatchMinimizer::algorithm() const
+{
+    return d->algorithm;
+}
+
+/// Sets the number of threads used to minimize the molecules to
+/// \p count. If \p count is \c 0 (the default) the ideal thread
+/// count for the system is used.
+void ForceFieldBatchMinimizer::setThreadCount(int count)
+{
+    d->threadCount = qMax(0, count);
+}
+
+/// Returns the number of threads used to minimize the molecules.
+/// Returns \c 0 if the ideal thread count is used.
+int ForceFieldBatchMinimizer::threadCount() const
+{
+    return d->threadCount;
+}
+
+/// Returns the number of threads that will be used to minimize the
+/// molecules.
+int ForceFieldBatchMinimizer::effectiveThreadCount() const
+{
+    if(d->threadCount == 0){
+        return qMax(1, QThread::idealThreadCount());
+    }
+
+    return d->threadCount;
+}
+
+// --- Convergence Criteria ------------------------------------------------ //
+/// Sets the energy change convergence criteria for each molecule to
+/// \p value.
+///
+/// \see ForceFieldMinimizer::setEnergyConvergence()
+void ForceFieldBatchMinimizer::setEnergyConvergence(Float value)
+{
+    d->energyConvergence = value;
+}
+
+/// Returns the energy change convergence criteria.
+Float ForceFieldBatchMinimizer::energyConvergence() const
+{
+    return d->energyConvergence;
+}
+
+/// Sets the root mean square gradient convergence criteria for each
+/// molecule to \p value.
+///
+/// \see ForceFieldMinimizer::setRootMeanSquareGradientConvergence()
+void ForceFieldBatchMinimizer::setRootMeanSquareGradientConvergence(Float value)
+{
+    d->rootMeanSquareGradientConvergence = value;
+}
+
+/// Returns the root mean square gradient convergence criteria.
+Float ForceFieldBatchMinimizer::rootMeanSquareGradientConvergence() const
+{
+    return d->rootMeanSquareGradientConvergence;
+}
+
+/// Sets the maximum gradient convergence criteria for each molecule
+/// to \p value.
+///
+/// \see ForceFieldMinimizer::setMaximumGradientConvergence()
+void ForceFieldBatchMinimizer::setMaximumGradientConvergence(Float value)
+{
+    d->maximumGradientConvergence = value;
+}
+
+/// Returns the maximum gradient convergence criteria.
+Float ForceFieldBatchMinimizer::maximumGradientConvergence() const
+{
+    return d->maximumGradientConvergence;
+}
+
+/// Sets the maximum number of steps for each molecule to \p count.
+///
+/// \see ForceFieldMinimizer::setMaximumStepCount()
+void ForceFieldBatchMinimizer::setMaximumStepCount(int count)
+{
+    d->maximumStepCount = count;
+}
+
+/// Returns the maximum number of steps for each molecule.
+int ForceFieldBatchMinimizer::maximumStepCount() const
+{
+    return d->maximumStepCount;
+}
+
+// --- Minimization -------------------------------------------------------- //
+/// Minimizes the energy of each molecule in \p molecules. The
+/// minimized coordinates are written back to the molecules.
+///
+/// Returns \c false if the force field could not be created or the
+/// minimization was canceled. The outcome for each molecule is
+/// available from status().
+bool ForceFieldBatchMinimizer::minimize(const std::vector<Molecule *> &molecules)
+{
+    d->errorString.clear();
+    d->molecules = molecules;
+    d->nextMolecule = 0;
+    d->canceled = 0;
+
+    BatchMinimizerResult emptyResult;
+    emptyResult.status = ForceFieldMinimizer::Canceled;
+    emptyResult.initialEnergy = 0;
+    emptyResult.energy = 0;
+    emptyResult.rootMeanSquareGradient = 0;
+    emptyResult.stepCount = 0;
+    emptyResult.elapsedTime = 0;
+    d->results.assign(molecules.size(), emptyResult);
+
+    // create the workspaces in this thread so that the plugins and
+    // force field parameters are loaded before the threads start
+    int workspaceCount = qMin<int>(effectiveThreadCount(), molecules.size());
+    std::vector<BatchMinimizerWorkspace> workspaces;
+
+    for(int i = 0; i < workspaceCount; i++){
+        ForceField *forceField = ForceField::create(d->forceField);
+        if(!forceField){
+            d->errorString = "Force field '" + d->forceField + "' is not supported.";
+            break;
+        }
+
+        forceField->setThreadCount(1);
+        forceField->setup();
+
+        ForceFieldMinimizer *minimizer = new ForceFieldMinimizer(forceField, d->algorithm);
+        minimizer->setEnergyConvergence(d->energyConvergence);
+        minimizer->setRootMeanSquareGradientConvergence(d->rootMeanSquareGradientConvergence);
+        minimizer->setMaximumGradientConvergence(d->maximumGradientConvergence);
+        minimizer->setMaximumStepCount(d->maximumStepCount);
+
+        BatchMinimizerWorkspace workspace;
+        workspace.batch = d;
+        workspace.forceField = forceField;
+        workspace.minimizer = minimizer;
+        workspaces.push_back(workspace);
+    }
+
+    if(d->errorString.empty()){
+        if(workspaces.size() == 1){
+            minimizeWorkspaceMolecules(workspaces[0]);
+        }
+        else if(!workspaces.empty()){
+            QtConcurrent::blockingMap(workspaces, minimizeWorkspaceMolecules);
+        }
+    }
+
+    foreach(const BatchMinimizerWorkspace &workspace, workspaces){
+        delete workspace.minimizer;
+        delete workspace.forceField;
+    }
+
+    d->molecules.clear();
+
+    if(!d->errorString.empty()){
+        for(unsigned int i = 0; i < d->results.size(); i++){
+            d->results[i].status = ForceFieldMinimizer::Failed;
+        }
+
+        return false;
+    }
+
+    if(d->canceled){
+        d->errorString = "Minimization was canceled.";
+        return false;
+    }
+
+    return true;
+}
+
+/// Minimizes copies of each molecule in \p input and adds them to
+/// \p output in the same order as they are in \p input. The
+/// molecules in \p input are not modified.
+bool ForceFieldBatchMinimizer::minimize(const MoleculeFile *input, MoleculeFile *output)
+{
+    std::vector<Molecule *> molecules;
+    molecules.reserve(input->moleculeCount());
+
+    foreach(const Molecule *molecule, input->molecules()){
+        Molecule *copy = new Molecule(*molecule);
+        output->addMolecule(copy);
+        molecules.push_back(copy);
+    }
+
+    return minimize(molecules);
+}
+
+/// Cancels a running minimization. Molecules which have not been
+/// started are left unchanged.
+void ForceFieldBatchMinimizer::cancel()
+{
+    d->canceled = 1;
+}
+
+/// Returns \c true if the minimization was canceled.
+bool ForceFieldBatchMinimizer::isCanceled() const
+{
+    return d->canceled;
+}
+
+// --- Results ------------------------------------------------------------- //
+/// Returns the number of results. This is the number of molecules
+/// in the last minimization.
+int ForceFieldBatchMinimizer::resultCount() const
+{
+    return d->results.size();
+}
+
+/// Returns the minimization status for the molecule at \p index. If
+/// the force field could not be setup for the molecule the status
+/// is \c ForceFieldMinimizer::Failed and if it was not minimized
+/// because the minimization was canceled the status is
+/// \c ForceFieldMinimizer::Canceled.
+ForceFieldMinimizer::Status ForceFieldBatchMinimizer::status(int index) const
+{
+    return d->results[index].status;
+}
+
+/// Returns \c true if the minimization of the molecule at \p index
+/// converged.
+bool ForceFieldBatchMinimizer::isConverged(int index) const
+{
+    return d->results[index].status == ForceFieldMinimizer::Converged;
+}
+
+/// Returns the energy of the molecule at \p index before
+/// minimization.
+Float ForceFieldBatchMinimizer::initialEnergy(int index) const
+{
+    return d->results[index].initialEnergy;
+}
+
+/// Returns the energy of the molecule at \p index after
+/// minimization.
+Float ForceFieldBatchMinimizer::energy(int index) const
+{
+    return d->results[index].energy;
+}
+
+/// Returns the root mean square gradient of the molecule at
+/// \p index after minimization.
+Float ForceFieldBatchMinimizer::rootMeanSquareGradient(int index) const
+{
+    return d->results[index].rootMeanSquareGradient;
+}
+
+/// Returns the number of minimization steps taken for the molecule
+/// at \p index.
+int ForceFieldBatchMinimizer::stepCount(int index) const
+{
+    return d->results[index].stepCount;
+}
+
+/// Returns the time in milliseconds taken to setup and minimize the
+/// molecule at \p index.
+Float ForceFieldBatchMinimizer::elapsedTime(int index) const
+{
+    return d->results[index].elapsedTime;
+}
+
+/// Returns the number of molecules whose minimization converged.
+int ForceFieldBatchMinimizer::convergedCount() const
+{
+    int count = 0;
+
+    foreach(const BatchMinimizerResult &result, d->results){
+        if(result.status == ForceFieldMinimizer::Converged){
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/// Returns the number of molecules whose minimization failed.
+int ForceFieldBatchMinimizer::failedCount() const
+{
+    int count = 0;
+
+    foreach(const BatchMinimizerResult &result, d->results){
+        if(result.status == ForceFieldMinimizer::Failed){
+            count++;
+        }
+    }
+
+    return count;
+}
+
+// --- Error Handling ------------------------------------------------------ //
+/// Returns a string describing the last error that occurred.
+std::string ForceFieldBatchMinimizer::errorString() const
+{
+    return d->errorString;
+}
+
+/// Returns a string describing the error that occurred while
+/// setting up the force field for the molecule at \p index.
+std::string ForceFieldBatchMinimizer::errorString(int index) const
+{
+    return d->results[index].errorString;
+}
+
+} // end chemkit namespace
@@ -0,0 +1,106 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#ifndef CHEMKIT_FORCEFIELDBATCHMINIMIZER_H
+#define CHEMKIT_FORCEFIELDBATCHMINIMIZER_H
+
+#include "chemkit.h"
+
+#include <string>
+#include <vector>
+
+#include "forcefieldminimizer.h"
+
+namespace chemkit {
+
+class Molecule;
+class MoleculeFile;
+class ForceFieldBatchMinimizerPrivate;
+
+class CHEMKIT_EXPORT ForceFieldBatchMinimizer
+{
+    public:
+        // construction and destruction
+        ForceFieldBatchMinimizer(const std::string &forceField = "uff", ForceFieldMinimizer::Algorithm algorithm = ForceFieldMinimizer::Lbfgs);
+        ~ForceFieldBatchMinimizer();
+
+        // properties
+        void setForceField(const std::string &name);
+        std::string forceField() const;
+        void setAlgorithm(ForceFieldMinimizer::Algorithm algorithm);
+        ForceFieldMinimizer::Algorithm algorithm() const;
+        void setThreadCount(int count);
+        int threadCount() const;
+        int effectiveThreadCount() const;
+
+        // convergence criteria
+        void setEnergyConvergence(Float value);
+        Float energyConvergence() const;
+        void setRootMeanSquareGradientConvergence(Float value);
+        Float rootMeanSquareGradientConvergence() const;
+        void setMaximumGradientConvergence(Float value);
+        Float maximumGradientConvergence() const;
+        void setMaximumStepCount(int count);
+        int maximumStepCount() const;
+
+        // minimization
+        bool minimize(const std::vector<Molecule *> &molecules);
+        bool minimize(const MoleculeFile *input, MoleculeFile *output);
+        void cancel();
+        bool isCanceled() const;
+
+        // results
+        int resultCount() const;
+        ForceFieldMinimizer::Status status(int index) const;
+        bool isConverged(int index) const;
+        Float initialEnergy(int index) const;
+        Float energy(int index) const;
+        Float rootMeanSquareGradient(int index) const;
+        int stepCount(int index) const;
+        Float elapsedTime(int index) const;
+        int convergedCount() const;
+        int failedCount() const;
+
+        // error handling
+        std::string errorString() const;
+        std::string errorString(int index) const;
+
+    private:
+        ForceFieldBatchMinimizerPrivate* const d;
+};
+
+} // end chemkit namespace
+
+#endif // CHEMKIT_FORCEFIELDBATCHMINIMIZER_H
@@ -39,6 +39,7 @@
 #include "forcefieldcalculation.h"
 
 #include "point3.h"
+#include "unitcell.h"
 #include "forcefieldatom.h"
 
 namespace chemkit {
@@ -47,13 +48,20 @@ namespace chemkit {
 /// Angstroms.
 inline Float ForceFieldCalculation::distance(const ForceFieldAtom *a, const ForceFieldAtom *b) const
 {
-    return a->position().distance(b->position());
+    const UnitCell *cell = unitCell();
+    if(cell){
+        return cell->distance(position(a), position(b));
+    }
+
+    return position(a).distance(position(b));
 }
 
 /// Returns the gradient of the distance between atoms \p a and \p b.
 inline std::vector<Vector3> ForceFieldCalculation::distanceGradient(const ForceFieldAtom *a, const ForceFieldAtom *b) const
 {
-    return distanceGradient(a->position(), b->position());
+    Point3 pa = position(a);
+
+    return distanceGradient(pa, imagePosition(b, pa));
 }
 
 /// Returns the gradient of the distance between points \p a and \p b.
@@ -71,14 +79,18 @@ inline std::vector<Vector3> ForceFieldCalculation::distanceGradient(const Point3
 /// angle is in degrees.
 inline Float ForceFieldCalculation::bondAngle(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c) const
 {
-    return Point3::angle(a->position(), b->position(), c->position());
+    Point3 pb = position(b);
+
+    return Point3::angle(imagePosition(a, pb), pb, imagePosition(c, pb));
 }
 
 /// Returns the bond angle between atoms \p a, \p b and \p c. The
 /// angle is in radians.
 inline Float ForceFieldCalculation::bondAngleRadians(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c) const
 {
-    return Point3::angleRadians(a->position(), b->position(), c->position());
+    Point3 pb = position(b);
+
+    return Point3::angleRadians(imagePosition(a, pb), pb, imagePosition(c, pb));
 }
 
 /// Returns the gradient of the bond angle between atoms \p a, \p b
@@ -98,7 +110,9 @@ inline std::vector<Vector3> ForceFieldCalculation::bondAngleGradient(const Force
 /// and \p c.
 inline std::vector<Vector3> ForceFieldCalculation::bondAngleGradientRadians(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c) const
 {
-    return bondAngleGradientRadians(a->position(), b->position(), c->position());
+    Point3 pb = position(b);
+
+    return bondAngleGradientRadians(imagePosition(a, pb), pb, imagePosition(c, pb));
 }
 
 /// Returns the gradient of the bond angle between points \p a, \p b
@@ -124,7 +138,10 @@ inline std::vector<Vector3> ForceFieldCalculation::bondAngleGradientRadians(cons
 /// degrees.
 inline Float ForceFieldCalculation::torsionAngle(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c, const ForceFieldAtom *d) const
 {
-    return Point3::torsionAngle(a->position(), b->position(), c->position(), d->position());
+    Point3 pb = position(b);
+    Point3 pc = imagePosition(c, pb);
+
+    return Point3::torsionAngle(imagePosition(a, pb), pb, pc, imagePosition(d, pc));
 }
 
 /// Returns the torsion angle (also known as the dihedral angle)
@@ -132,7 +149,10 @@ inline Float ForceFieldCalculation::torsionAngle(const ForceFieldAtom *a, const
 /// radians.
 inline Float ForceFieldCalculation::torsionAngleRadians(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c, const ForceFieldAtom *d) const
 {
-    return Point3::torsionAngleRadians(a->position(), b->position(), c->position(), d->position());
+    Point3 pb = position(b);
+    Point3 pc = imagePosition(c, pb);
+
+    return Point3::torsionAngleRadians(imagePosition(a, pb), pb, pc, imagePosition(d, pc));
 }
 
 /// Returns the gradient of the torsion angle between the atoms \p a,
@@ -152,7 +172,10 @@ inline std::vector<Vector3> ForceFieldCalculation::torsionAngleGradient(const Fo
 /// \p b, \p c, and \p d.
 inline std::vector<Vector3> ForceFieldCalculation::torsionAngleGradientRadians(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c, const ForceFieldAtom *d) const
 {
-    return torsionAngleGradientRadians(a->position(), b->position(), c->position(), d->position());
+    Point3 pb = position(b);
+    Point3 pc = imagePosition(c, pb);
+
+    return torsionAngleGradientRadians(imagePosition(a, pb), pb, pc, imagePosition(d, pc));
 }
 
 /// Returns the gradient of the torsion angle between the points
@@ -187,14 +210,18 @@ inline std::vector<Vector3> ForceFieldCalculation::torsionAngleGradientRadians(c
 /// \p d. The angle is in degrees.
 inline Float ForceFieldCalculation::wilsonAngle(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c, const ForceFieldAtom *d) const
 {
-    return Point3::wilsonAngle(a->position(), b->position(), c->position(), d->position());
+    Point3 pb = position(b);
+
+    return Point3::wilsonAngle(imagePosition(a, pb), pb, imagePosition(c, pb), imagePosition(d, pb));
 }
 
 /// Returns the wilson angle between the atoms \p a, \p b, \p c, and
 /// \p d. The angle is in radians.
 inline Float ForceFieldCalculation::wilsonAngleRadians(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c, const ForceFieldAtom *d) const
 {
-    return Point3::wilsonAngleRadians(a->position(), b->position(), c->position(), d->position());
+    Point3 pb = position(b);
+
+    return Point3::wilsonAngleRadians(imagePosition(a, pb), pb, imagePosition(c, pb), imagePosition(d, pb));
 }
 
 /// Returns the gradient of the wilson angle between the atoms
@@ -214,7 +241,9 @@ inline std::vector<Vector3> ForceFieldCalculation::wilsonAngleGradient(const For
 /// \p a, \p b, \p c, and \p d.
 inline std::vector<Vector3> ForceFieldCalculation::wilsonAngleGradientRadians(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c, const ForceFieldAtom *d) const
 {
-    return wilsonAngleGradientRadians(a->position(), b->position(), c->position(), d->position());
+    Point3 pb = position(b);
+
+    return wilsonAngleGradientRadians(imagePosition(a, pb), pb, imagePosition(c, pb), imagePosition(d, pb));
 }
 
 /// Returns the gradient of the wilson angle between the points
@@ -247,6 +276,32 @@ inline std::vector<Vector3> ForceFieldCalculation::wilsonAngleGradientRadians(co
     return gradient;
 }
 
+/// Returns the position of \p atom. While the calculation is being
+/// evaluated for a conformer ensemble (see ForceField::energies())
+/// this is the atom's position in the conformer being evaluated.
+inline Point3 ForceFieldCalculation::position(const ForceFieldAtom *atom) const
+{
+    const Point3 *positions = this->positions();
+    if(positions){
+        return positions[atom->index()];
+    }
+
+    return atom->position();
+}
+
+/// Returns the position of the periodic image of \p atom which is
+/// closest to \p reference. If periodic boundary conditions are not
+/// used the position of \p atom is returned.
+inline Point3 ForceFieldCalculation::imagePosition(const ForceFieldAtom *atom, const Point3 &reference) const
+{
+    const UnitCell *cell = unitCell();
+    if(!cell){
+        return position(atom);
+    }
+
+    return cell->image(position(atom), reference);
+}
+
 } // end chemkit namespace
 
 #endif // CHEMKIT_FORCEFIELDCALCULATION_INLINE_H
@@ -37,6 +37,7 @@
 
 #include <algorithm>
 
+#include "constants.h"
 #include "forcefieldatom.h"
 
 namespace chemkit {
@@ -47,6 +48,8 @@ class ForceFieldCalculationPrivate
     public:
         int type;
         bool setup;
+        const UnitCell *unitCell;
+        const Point3 *positions;
         std::vector<Float> parameters;
         std::vector<const ForceFieldAtom *> atoms;
 };
@@ -65,6 +68,8 @@ ForceFieldCalculation::ForceFieldCalculation(int type, int atomCount, int parame
 {
     d->type = type;
     d->setup = false;
+    d->unitCell = 0;
+    d->positions = 0;
     d->atoms.resize(atomCount);
     d->parameters.resize(parameterCount);
 }
@@ -226,10 +231,233 @@ std::vector<Vector3> ForceFieldCalculation::numericalGradient() const
     return gradient;
 }
 
+/// Returns the Hessian of the energy with respect to the coordinates
+/// of each atom for the calculation. The Hessian is a 3N x 3N matrix
+/// (where N is the number of atoms) with rows and columns ordered as
+/// x0, y0, z0, x1, ..., zN. This method will calculate the second
+/// derivatives analytically if possible, otherwise they will be
+/// calculated numerically via numericalHessian().
+Matrix ForceFieldCalculation::hessian() const
+{
+    return numericalHessian();
+}
+
+/// Returns the Hessian of the energy with respect to the coordinates
+/// of each atom for the calculation. The Hessian is calculated with
+/// central differences of the gradient and then symmetrized. This
+/// method is used when analytical second derivatives are not
+/// available.
+///
+/// \see ForceFieldCalculation::hessian()
+Matrix ForceFieldCalculation::numericalHessian() const
+{
+    const Float epsilon = 1.0e-5;
+
+    int size = 3 * atomCount();
+    Matrix hessian(size, size);
+
+    for(int i = 0; i < atomCount(); i++){
+        ForceFieldAtom *atom = const_cast<ForceFieldAtom *>(d->atoms[i]);
+        Point3 position = atom->position();
+
+        for(int j = 0; j < 3; j++){
+            Vector3 displacement;
+            displacement[j] = epsilon;
+
+            atom->setPosition(position.movedBy(displacement));
+            std::vector<Vector3> forward = gradient();
+
+            atom->setPosition(position.movedBy(-displacement));
+            std::vector<Vector3> backward = gradient();
+
+            for(int k = 0; k < atomCount(); k++){
+                for(int l = 0; l < 3; l++){
+                    hessian(3 * k + l, 3 * i + j) = (forward[k][l] - backward[k][l]) / (2 * epsilon);
+                }
+            }
+        }
+
+        // restore initial position
+        atom->setPosition(position);
+    }
+
+    for(int i = 0; i < size; i++){
+        for(int j = i + 1; j < size; j++){
+            Float value = 0.5 * (hessian(i, j) + hessian(j, i));
+            hessian(i, j) = value;
+            hessian(j, i) = value;
+        }
+    }
+
+    return hessian;
+}
+
+// --- Geometry ------------------------------------------------------------ //
+/// Returns the Hessian of an energy which depends only on the
+/// distance between atoms \p a and \p b. The first and second
+/// derivatives of the energy with respect to the distance are given
+/// by \p de_dr and \p d2e_dr2.
+Matrix ForceFieldCalculation::distanceHessian(const ForceFieldAtom *a, const ForceFieldAtom *b, Float de_dr, Float d2e_dr2) const
+{
+    Point3 pa = position(a);
+    Vector3 ab = pa - imagePosition(b, pa);
+
+    Float r = ab.length();
+    Vector3 u = ab / r;
+
+    Matrix hessian(6, 6);
+
+    for(int i = 0; i < 3; i++){
+        for(int j = 0; j < 3; j++){
+            Float delta = i == j ? 1 : 0;
+            Float value = d2e_dr2 * u[i] * u[j] + de_dr * (delta - u[i] * u[j]) / r;
+
+            hessian(i, j) = value;
+            hessian(i + 3, j + 3) = value;
+            hessian(i, j + 3) = -value;
+            hessian(i + 3, j) = -value;
+        }
+    }
+
+    return hessian;
+}
+
+/// Returns the Hessian of an energy which depends only on the bond
+/// angle between atoms \p a, \p b and \p c. The first and second
+/// derivatives of the energy with respect to the angle (in degrees)
+/// are given by \p de_dtheta and \p d2e_dtheta2.
+Matrix ForceFieldCalculation::bondAngleHessian(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c, Float de_dtheta, Float d2e_dtheta2) const
+{
+    const Float scale = chemkit::constants::RadiansToDegrees;
+
+    return bondAngleHessianRadians(a, b, c, de_dtheta * scale, d2e_dtheta2 * scale * scale);
+}
+
+/// Returns the Hessian of an energy which depends only on the bond
+/// angle between atoms \p a, \p b and \p c. The first and second
+/// derivatives of the energy with respect to the angle (in radians)
+/// are given by \p de_dtheta and \p d2e_dtheta2.
+///
+/// For (nearly) linear angles the energy is assumed to be stationary
+/// at the linear angle, i.e. \p de_dtheta goes to zero along with
+/// the sine of the angle.
+Matrix ForceFieldCalculation::bondAngleHessianRadians(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c, Float de_dtheta, Float d2e_dtheta2) const
+{
+    Point3 pb = position(b);
+
+    return bondAngleHessianRadians(imagePosition(a, pb), pb, imagePosition(c, pb), de_dtheta, d2e_dtheta2);
+}
+
+// The Hessian is first calculated with respect to the bond vectors
+// u = a - b and v = c - b from the derivatives of the cosine of the
+// angle and then transformed to the coordinates of the three atoms.
+Matrix ForceFieldCalculation::bondAngleHessianRadians(const Point3 &a, const Point3 &b, const Point3 &c, Float de_dtheta, Float d2e_dtheta2) const
+{
+    Vector3 u = a - b;
+    Vector3 v = c - b;
+
+    Float lu = u.length();
+    Float lv = v.length();
+    Float cosine = u.dot(v) / (lu * lv);
+    Float sine = sqrt(qMax(Float(0), 1 - cosine * cosine));
+
+    // gradient of the cosine with respect to u and v
+    Vector3 dc[2];
+    dc[0] = v / (lu * lv) - u * (cosine / (lu * lu));
+    dc[1] = u / (lu * lv) - v * (cosine / (lv * lv));
+
+    // hessian of the energy with respect to u and v. the factors are
+    // the derivatives of the energy with respect to the cosine which
+    // are singular for linear angles so their limits are used instead
+    Float gradientFactor = 0;
+    Float hessianFactor = -cosine * d2e_dtheta2;
+
+    if(sine > 1e-4){
+        gradientFactor = d2e_dtheta2 / (sine * sine) - de_dtheta * cosine / (sine * sine * sine);
+        hessianFactor = -de_dtheta / sine;
+    }
+
+    Matrix uv(6, 6);
+
+    for(int i = 0; i < 3; i++){
+        for(int j = 0; j < 3; j++){
+            Float delta = i == j ? 1 : 0;
+
+            Float d2c_du2 = -(v[i] * u[j] + u[i] * v[j]) / (lu * lu * lu * lv) +
+                            3 * cosine * u[i] * u[j] / pow(lu, 4) -
+                            cosine * delta / (lu * lu);
+            Float d2c_dv2 = -(u[i] * v[j] + v[i] * u[j]) / (lu * lv * lv * lv) +
+                            3 * cosine * v[i] * v[j] / pow(lv, 4) -
+                            cosine * delta / (lv * lv);
+            Float d2c_dudv = delta / (lu * lv) -
+                             v[i] * v[j] / (lu * lv * lv * lv) -
+                             u[i] * dc[1][j] / (lu * lu);
+
+            uv(i, j) = gradientFactor * dc[0][i] * dc[0][j] + hessianFactor * d2c_du2;
+            uv(i + 3, j + 3) = gradientFactor * dc[1][i] * dc[1][j] + hessianFactor * d2c_dv2;
+            uv(i, j + 3) = gradientFactor * dc[0][i] * dc[1][j] + hessianFactor * d2c_dudv;
+            uv(j + 3, i) = uv(i, j + 3);
+        }
+    }
+
+    // derivatives of u and v with respect to the position of each atom
+    const Float coefficients[3][2] = {{1, 0}, {-1, -1}, {0, 1}};
+
+    Matrix hessian(9, 9);
+
+    for(int k = 0; k < 3; k++){
+        for(int l = 0; l < 3; l++){
+            for(int p = 0; p < 2; p++){
+                for(int q = 0; q < 2; q++){
+                    Float coefficient = coefficients[k][p] * coefficients[l][q];
+                    if(coefficient == 0){
+                        continue;
+                    }
+
+                    for(int i = 0; i < 3; i++){
+                        for(int j = 0; j < 3; j++){
+                            hessian(3 * k + i, 3 * l + j) += coefficient * uv(3 * p + i, 3 * q + j);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return hessian;
+}
+
 // --- Internal Methods ---------------------------------------------------- //
 void ForceFieldCalculation::setSetup(bool setup)
 {
     d->setup = setup;
 }
 
+void ForceFieldCalculation::setUnitCell(const UnitCell *cell)
+{
+    d->unitCell = cell;
+}
+
+// Returns the periodic unit cell of the force field or 0 if periodic
+// boundary conditions are not used.
+const UnitCell* ForceFieldCalculation::unitCell() const
+{
+    return d->unitCell;
+}
+
+// Sets the positions read for the atoms of the calculation in place
+// of their own positions. Each atom's position is at its index in
+// the force field. Passing null restores the atoms' own positions.
+void ForceFieldCalculation::setPositions(const Point3 *positions)
+{
+    d->positions = positions;
+}
+
+// Returns the positions read for the atoms of the calculation or 0
+// if the atoms' own positions are used.
+const Point3* ForceFieldCalculation::positions() const
+{
+    return d->positions;
+}
+
 } // end chemkit namespace
@@ -41,10 +41,12 @@
 #include <vector>
 
 #include "point3.h"
+#include "matrix.h"
 #include "vector3.h"
 
 namespace chemkit {
 
+class UnitCell;
 class ForceField;
 class ForceFieldAtom;
 class ForceFieldCalculationPrivate;
@@ -59,7 +61,8 @@ class CHEMKIT_EXPORT ForceFieldCalculation
             Torsion = 0x04,
             Inversion = 0x08,
             VanDerWaals = 0x10,
-            Electrostatic = 0x20
+            Electrostatic = 0x20,
+            Restraint = 0x40
         };
 
         // properties
@@ -83,17 +86,23 @@ class CHEMKIT_EXPORT ForceFieldCalculation
         virtual Float energy() const;
         virtual std::vector<Vector3> gradient() const;
         std::vector<Vector3> numericalGradient() const;
+        virtual Matrix hessian() const;
+        Matrix numericalHessian() const;
 
     protected:
         ForceFieldCalculation(int type, int atomCount, int parameterCount);
         virtual ~ForceFieldCalculation();
         void setAtom(int index, const ForceFieldAtom *atom);
+        Point3 position(const ForceFieldAtom *atom) const;
         Float distance(const ForceFieldAtom *a, const ForceFieldAtom *b) const;
         std::vector<Vector3> distanceGradient(const ForceFieldAtom *a, const ForceFieldAtom *b) const;
+        Matrix distanceHessian(const ForceFieldAtom *a, const ForceFieldAtom *b, Float de_dr, Float d2e_dr2) const;
         Float bondAngle(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c) const;
         Float bondAngleRadians(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c) const;
         std::vector<Vector3> bondAngleGradient(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c) const;
         std::vector<Vector3> bondAngleGradientRadians(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c) const;
+        Matrix bondAngleHessian(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c, Float de_dtheta, Float d2e_dtheta2) const;
+        Matrix bondAngleHessianRadians(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c, Float de_dtheta, Float d2e_dtheta2) const;
         Float torsionAngle(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c, const ForceFieldAtom *d) const;
         Float torsionAngleRadians(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c, const ForceFieldAtom *d) const;
         std::vector<Vector3> torsionAngleGradient(const ForceFieldAtom *a, const ForceFieldAtom *b, const ForceFieldAtom *c, const ForceFieldAtom *d) const;
@@ -105,12 +114,20 @@ class CHEMKIT_EXPORT ForceFieldCalculation
 
     private:
         void setSetup(bool setup);
+        void setUnitCell(const UnitCell *cell);
+        const UnitCell* unitCell() const;
+        void setPositions(const Point3 *positions);
+        const Point3* positions() const;
+        Point3 imagePosition(const ForceFieldAtom *atom, const Point3 &reference) const;
         std::vector<Vector3> distanceGradient(const Point3 &a, const Point3 &b) const;
         std::vector<Vector3> bondAngleGradientRadians(const Point3 &a, const Point3 &b, const Point3 &c) const;
+        Matrix bondAngleHessianRadians(const Point3 &a, const Point3 &b, const Point3 &c, Float de_dtheta, Float d2e_dtheta2) const;
         std::vector<Vector3> torsionAngleGradientRadians(const Point3 &a, const Point3 &b, const Point3 &c, const Point3 &d) const;
         std::vector<Vector3> wilsonAngleGradientRadians(const Point3 &a, const Point3 &b, const Point3 &c, const Point3 &d) const;
 
         friend class ForceField;
+        friend class ForceFieldPrivate;
+        friend class ReceptorGridPrivate;
 
     private:
         ForceFieldCalculationPrivate* const d;
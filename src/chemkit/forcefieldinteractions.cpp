@@ -47,6 +47,7 @@ class ForceFieldInteractionsPrivate
     public:
         const Molecule *molecule;
         const ForceField *forceField;
+        QHash<const Atom *, const ForceFieldAtom *> atoms;
 };
 
 // === ForceFieldInteractions ============================================== //
@@ -63,6 +64,26 @@ ForceFieldInteractions::ForceFieldInteractions(const Molecule *molecule, const F
 {
     d->molecule = molecule;
     d->forceField = forceField;
+
+    foreach(const Atom *atom, molecule->atoms()){
+        d->atoms.insert(atom, forceField->atom(atom));
+    }
+}
+
+/// Create a new force field interactions object for the force field
+/// atoms in \p atoms. The atoms must be in the same order as the
+/// atoms in \p molecule. Unlike the force field constructor the
+/// atoms do not need to have been added to their force field yet.
+ForceFieldInteractions::ForceFieldInteractions(const Molecule *molecule, const std::vector<ForceFieldAtom *> &atoms)
+    : d(new ForceFieldInteractionsPrivate)
+{
+    d->molecule = molecule;
+    d->forceField = atoms.empty() ? 0 : atoms[0]->forceField();
+
+    d->atoms.reserve(atoms.size());
+    for(unsigned int i = 0; i < atoms.size(); i++){
+        d->atoms.insert(molecule->atom(i), atoms[i]);
+    }
 }
 
 /// Destroy the force field interactions object.
@@ -91,8 +112,8 @@ std::vector<std::pair<const ForceFieldAtom *, const ForceFieldAtom *> > ForceFie
     std::vector<std::pair<const ForceFieldAtom *, const ForceFieldAtom *> > bondedPairs;
 
     Q_FOREACH(const Bond *bond, d->molecule->bonds()){
-        const ForceFieldAtom *a = forceField()->atom(bond->atom1());
-        const ForceFieldAtom *b = forceField()->atom(bond->atom2());
+        const ForceFieldAtom *a = forceFieldAtom(bond->atom1());
+        const ForceFieldAtom *b = forceFieldAtom(bond->atom2());
         bondedPairs.push_back(std::make_pair(a, b));
     }
 
@@ -110,9 +131,9 @@ std::vector<std::vector<const ForceFieldAtom *> > ForceFieldInteractions::angleG
             for(unsigned int i = 0; i < neighbors.size(); i++){
                 for(unsigned int j = i + 1; j < neighbors.size(); j++){
                     std::vector<const ForceFieldAtom *> angleGroup(3);
-                    angleGroup[0] = forceField()->atom(neighbors[i]);
-                    angleGroup[1] = forceField()->atom(atom);
-                    angleGroup[2] = forceField()->atom(neighbors[j]);
+                    angleGroup[0] = forceFieldAtom(neighbors[i]);
+                    angleGroup[1] = forceFieldAtom(atom);
+                    angleGroup[2] = forceFieldAtom(neighbors[j]);
 
                     angleGroups.push_back(angleGroup);
                 }
@@ -152,10 +173,10 @@ std::vector<std::vector<const ForceFieldAtom *> > ForceFieldInteractions::torsio
                     continue;
 
                 std::vector<const ForceFieldAtom *> torsionGroup(4);
-                torsionGroup[0] = forceField()->atom(a);
-                torsionGroup[1] = forceField()->atom(b);
-                torsionGroup[2] = forceField()->atom(c);
-                torsionGroup[3] = forceField()->atom(d);
+                torsionGroup[0] = forceFieldAtom(a);
+                torsionGroup[1] = forceFieldAtom(b);
+                torsionGroup[2] = forceFieldAtom(c);
+                torsionGroup[3] = forceFieldAtom(d);
 
                 torsionGroups.push_back(torsionGroup);
             }
@@ -174,8 +195,8 @@ std::vector<std::pair<const ForceFieldAtom *, const ForceFieldAtom *> > ForceFie
     for(unsigned int i = 0; i < atoms.size(); i++){
         for(unsigned int j = i + 1; j < atoms.size(); j++){
             if(!atomsWithinTwoBonds(atoms[i], atoms[j])){
-                const ForceFieldAtom *a = forceField()->atom(atoms[i]);
-                const ForceFieldAtom *b = forceField()->atom(atoms[j]);
+                const ForceFieldAtom *a = forceFieldAtom(atoms[i]);
+                const ForceFieldAtom *b = forceFieldAtom(atoms[j]);
 
                 nonbondedPairs.push_back(std::make_pair(a, b));
             }
@@ -186,6 +207,11 @@ std::vector<std::pair<const ForceFieldAtom *, const ForceFieldAtom *> > ForceFie
 }
 
 // --- Internal Methods ---------------------------------------------------- //
+const ForceFieldAtom* ForceFieldInteractions::forceFieldAtom(const Atom *atom) const
+{
+    return d->atoms.value(atom);
+}
+
 bool ForceFieldInteractions::atomsWithinTwoBonds(const Atom *a, const Atom *b)
 {
     Q_FOREACH(const Atom *neighbor, a->neighbors()){
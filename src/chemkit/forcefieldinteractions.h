@@ -53,6 +53,7 @@ class CHEMKIT_EXPORT ForceFieldInteractions
     public:
         // construction and destruction
         ForceFieldInteractions(const Molecule *molecule, const ForceField *forceField);
+        ForceFieldInteractions(const Molecule *molecule, const std::vector<ForceFieldAtom *> &atoms);
         ~ForceFieldInteractions();
 
         // properties
@@ -66,6 +67,7 @@ class CHEMKIT_EXPORT ForceFieldInteractions
         std::vector<std::pair<const ForceFieldAtom *, const ForceFieldAtom *> > nonbondedPairs();
 
     private:
+        const ForceFieldAtom* forceFieldAtom(const Atom *atom) const;
         bool atomsWithinTwoBonds(const Atom *a, const Atom *b);
 
     private:
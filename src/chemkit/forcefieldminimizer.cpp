@@ -0,0 +1,1196 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "forcefieldminimizer.h"
+
+#include <deque>
+#include <limits>
+#include <algorithm>
+
+#include "matrix.h"
+#include "forcefield.h"
+#include "forcefieldatom.h"
+
+namespace chemkit {
+
+namespace {
+
+// Systems with at most this many mobile atoms store the Hessian for
+// the truncated newton algorithm. Larger systems calculate its
+// products with the force field as needed.
+const int maximumDenseHessianAtomCount = 200;
+
+// A point along a line search direction.
+struct LineSearchPoint
+{
+    Float step;
+    Float energy;
+    Float slope;
+    std::vector<Vector3> gradient;
+};
+
+Float dot(const std::vector<Vector3> &a, const std::vector<Vector3> &b)
+{
+    Float sum = 0;
+
+    for(unsigned int i = 0; i < a.size(); i++){
+        sum += a[i] * b[i];
+    }
+
+    return sum;
+}
+
+Float maximumLength(const std::vector<Vector3> &vectors)
+{
+    Float maximum = 0;
+
+    for(unsigned int i = 0; i < vectors.size(); i++){
+        maximum = qMax(maximum, vectors[i].length());
+    }
+
+    return maximum;
+}
+
+// Returns the minimizer of the cubic interpolating the energy and
+// slope at points a and b. If the cubic has no minimum between a
+// and b (or the values are not finite) the midpoint is returned.
+Float cubicInterpolate(const LineSearchPoint &a, const LineSearchPoint &b)
+{
+    Float midpoint = 0.5 * (a.step + b.step);
+
+    if(qIsNaN(a.energy) || qIsNaN(b.energy) || qIsInf(a.energy) || qIsInf(b.energy)){
+        return midpoint;
+    }
+
+    Float d1 = a.slope + b.slope - 3 * (a.energy - b.energy) / (a.step - b.step);
+    Float discriminant = d1 * d1 - a.slope * b.slope;
+    if(discriminant < 0){
+        return midpoint;
+    }
+
+    Float d2 = (b.step > a.step ? 1 : -1) * sqrt(discriminant);
+    Float denominator = b.slope - a.slope + 2 * d2;
+    if(denominator == 0){
+        return midpoint;
+    }
+
+    Float step = b.step - (b.step - a.step) * (b.slope + d2 - d1) / denominator;
+
+    // keep the new step safely inside the interval
+    Float low = qMin(a.step, b.step);
+    Float high = qMax(a.step, b.step);
+    Float margin = 0.1 * (high - low);
+    if(qIsNaN(step) || step < low + margin || step > high - margin){
+        return midpoint;
+    }
+
+    return step;
+}
+
+} // end anonymous namespace
+
+// === ForceFieldMinimizerPrivate ========================================== //
+class ForceFieldMinimizerPrivate
+{
+    public:
+        ForceField *forceField;
+        ForceFieldMinimizer::Algorithm algorithm;
+        ForceFieldMinimizer::Status status;
+        int historySize;
+        Float maximumStepSize;
+        Float energyConvergence;
+        Float rootMeanSquareGradientConvergence;
+        Float maximumGradientConvergence;
+        int maximumStepCount;
+        int stepCount;
+        int energyEvaluationCount;
+        int gradientEvaluationCount;
+        int hessianEvaluationCount;
+        QAtomicInt canceled;
+        bool initialized;
+
+        // current state (of the atoms which are not frozen)
+        std::vector<ForceFieldAtom *> atoms;
+        std::vector<int> atomIndices;
+        std::vector<Vector3> positions;
+        std::vector<Vector3> gradient;
+        Float energy;
+        Float energyChange;
+
+        // conjugate gradient
+        std::vector<Vector3> previousGradient;
+        std::vector<Vector3> previousDirection;
+
+        // l-bfgs
+        std::deque<std::vector<Vector3> > positionDifferences;
+        std::deque<std::vector<Vector3> > gradientDifferences;
+        std::deque<Float> curvatures;
+
+        // fire
+        std::vector<Vector3> velocities;
+        Float timeStep;
+        Float mixing;
+        int downhillStepCount;
+
+        // truncated newton
+        Matrix hessian;
+        bool denseHessian;
+
+        void initialize();
+        bool positionsChanged() const;
+        void clearHistory();
+        void writePositions(const std::vector<Vector3> &positions);
+        Float evaluate(std::vector<Vector3> &gradient);
+        LineSearchPoint evaluate(const std::vector<Vector3> &direction, Float step);
+        std::vector<Vector3> searchDirection();
+        void updateHessian();
+        std::vector<Vector3> hessianProduct(const std::vector<Vector3> &vector);
+        std::vector<Vector3> newtonDirection();
+        bool lineSearch(const std::vector<Vector3> &direction, Float initialStep, Float curvatureFactor, LineSearchPoint &result);
+        bool lineSearchStep();
+        bool fireStep();
+        void updateHistory(const std::vector<Vector3> &oldPositions, const std::vector<Vector3> &oldGradient);
+        bool checkConvergence() const;
+};
+
+// Reads the current positions of the atoms which are not frozen and
+// evaluates the energy and gradient at them. Frozen atoms are left
+// out of the minimization entirely.
+void ForceFieldMinimizerPrivate::initialize()
+{
+    const std::vector<ForceFieldAtom *> &allAtoms = forceField->atoms();
+
+    atoms.clear();
+    atomIndices.clear();
+    for(unsigned int i = 0; i < allAtoms.size(); i++){
+        if(!allAtoms[i]->isFrozen()){
+            atoms.push_back(allAtoms[i]);
+            atomIndices.push_back(i);
+        }
+    }
+
+    positions.resize(atoms.size());
+    for(unsigned int i = 0; i < atoms.size(); i++){
+        positions[i] = atoms[i]->position();
+    }
+
+    energy = evaluate(gradient);
+    energyChange = std::numeric_limits<Float>::max();
+
+    clearHistory();
+    initialized = true;
+}
+
+// Returns true if the atom positions in the force field were
+// changed since the last step (e.g. by readCoordinates()) or if
+// atoms were frozen or unfrozen.
+bool ForceFieldMinimizerPrivate::positionsChanged() const
+{
+    const std::vector<ForceFieldAtom *> &allAtoms = forceField->atoms();
+
+    unsigned int mobileAtomCount = 0;
+    for(unsigned int i = 0; i < allAtoms.size(); i++){
+        if(allAtoms[i]->isFrozen()){
+            continue;
+        }
+
+        if(mobileAtomCount == atoms.size() || allAtoms[i] != atoms[mobileAtomCount]){
+            return true;
+        }
+
+        mobileAtomCount++;
+    }
+
+    if(mobileAtomCount != atoms.size()){
+        return true;
+    }
+
+    for(unsigned int i = 0; i < atoms.size(); i++){
+        if(!(Vector3(atoms[i]->position()) == positions[i])){
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ForceFieldMinimizerPrivate::clearHistory()
+{
+    previousGradient.clear();
+    previousDirection.clear();
+    positionDifferences.clear();
+    gradientDifferences.clear();
+    curvatures.clear();
+    velocities.assign(positions.size(), Vector3());
+    timeStep = 0.1;
+    mixing = 0.1;
+    downhillStepCount = 0;
+}
+
+void ForceFieldMinimizerPrivate::writePositions(const std::vector<Vector3> &positions)
+{
+    for(unsigned int i = 0; i < atoms.size(); i++){
+        atoms[i]->setPosition(Point3(positions[i]));
+    }
+}
+
+// Calculates the energy and gradient at the current atom positions.
+Float ForceFieldMinimizerPrivate::evaluate(std::vector<Vector3> &gradient)
+{
+    Float energy = forceField->energy();
+    energyEvaluationCount++;
+
+    gradient = forceField->gradient();
+    gradientEvaluationCount++;
+
+    if(atoms.size() != gradient.size()){
+        for(unsigned int i = 0; i < atomIndices.size(); i++){
+            gradient[i] = gradient[atomIndices[i]];
+        }
+
+        gradient.resize(atomIndices.size());
+    }
+
+    return energy;
+}
+
+// Calculates the energy and gradient at positions + step * direction.
+LineSearchPoint ForceFieldMinimizerPrivate::evaluate(const std::vector<Vector3> &direction, Float step)
+{
+    std::vector<Vector3> trialPositions(positions.size());
+    for(unsigned int i = 0; i < positions.size(); i++){
+        trialPositions[i] = positions[i] + direction[i] * step;
+    }
+    writePositions(trialPositions);
+
+    LineSearchPoint point;
+    point.step = step;
+    point.energy = evaluate(point.gradient);
+    point.slope = dot(point.gradient, direction);
+
+    return point;
+}
+
+// Returns the search direction for the current step.
+std::vector<Vector3> ForceFieldMinimizerPrivate::searchDirection()
+{
+    std::vector<Vector3> direction(gradient.size());
+
+    if(algorithm == ForceFieldMinimizer::ConjugateGradient && !previousGradient.empty()){
+        // polak-ribiere with automatic restarts (pr+)
+        Float beta = 0;
+        Float previousNorm = dot(previousGradient, previousGradient);
+        if(previousNorm > 0){
+            beta = (dot(gradient, gradient) - dot(gradient, previousGradient)) / previousNorm;
+        }
+        beta = qMax(Float(0), beta);
+
+        for(unsigned int i = 0; i < direction.size(); i++){
+            direction[i] = -gradient[i] + previousDirection[i] * beta;
+        }
+    }
+    else if(algorithm == ForceFieldMinimizer::Lbfgs && !curvatures.empty()){
+        // two-loop recursion
+        int size = curvatures.size();
+        std::vector<Float> alpha(size);
+
+        std::vector<Vector3> q = gradient;
+        for(int i = size - 1; i >= 0; i--){
+            alpha[i] = curvatures[i] * dot(positionDifferences[i], q);
+            for(unsigned int j = 0; j < q.size(); j++){
+                q[j] -= gradientDifferences[i][j] * alpha[i];
+            }
+        }
+
+        // scale by the most recent curvature estimate
+        const std::vector<Vector3> &s = positionDifferences.back();
+        const std::vector<Vector3> &y = gradientDifferences.back();
+        Float gamma = dot(s, y) / dot(y, y);
+        for(unsigned int j = 0; j < q.size(); j++){
+            q[j] *= gamma;
+        }
+
+        for(int i = 0; i < size; i++){
+            Float beta = curvatures[i] * dot(gradientDifferences[i], q);
+            for(unsigned int j = 0; j < q.size(); j++){
+                q[j] += positionDifferences[i][j] * (alpha[i] - beta);
+            }
+        }
+
+        for(unsigned int j = 0; j < q.size(); j++){
+            direction[j] = -q[j];
+        }
+    }
+    else if(algorithm == ForceFieldMinimizer::TruncatedNewton){
+        direction = newtonDirection();
+    }
+    else{
+        for(unsigned int i = 0; i < direction.size(); i++){
+            direction[i] = -gradient[i];
+        }
+    }
+
+    // fall back to steepest descent if the direction is not downhill
+    if(dot(direction, gradient) >= 0){
+        for(unsigned int i = 0; i < direction.size(); i++){
+            direction[i] = -gradient[i];
+        }
+    }
+
+    return direction;
+}
+
+// Calculates the Hessian of the mobile atoms for small systems. For
+// larger systems the Hessian is not stored.
+void ForceFieldMinimizerPrivate::updateHessian()
+{
+    denseHessian = int(atoms.size()) <= maximumDenseHessianAtomCount;
+    if(!denseHessian){
+        hessian = Matrix();
+        return;
+    }
+
+    Matrix fullHessian = forceField->hessian();
+    hessianEvaluationCount++;
+
+    int size = 3 * atoms.size();
+    hessian = Matrix(size, size);
+
+    for(unsigned int i = 0; i < atoms.size(); i++){
+        for(unsigned int j = 0; j < atoms.size(); j++){
+            for(int k = 0; k < 3; k++){
+                for(int l = 0; l < 3; l++){
+                    hessian(3 * i + k, 3 * j + l) = fullHessian(3 * atomIndices[i] + k, 3 * atomIndices[j] + l);
+                }
+            }
+        }
+    }
+}
+
+// Returns the product of the Hessian of the mobile atoms and vector.
+std::vector<Vector3> ForceFieldMinimizerPrivate::hessianProduct(const std::vector<Vector3> &vector)
+{
+    std::vector<Vector3> product(vector.size());
+
+    if(denseHessian){
+        for(unsigned int i = 0; i < vector.size(); i++){
+            for(int k = 0; k < 3; k++){
+                Float sum = 0;
+
+                for(unsigned int j = 0; j < vector.size(); j++){
+                    for(int l = 0; l < 3; l++){
+                        sum += hessian(3 * i + k, 3 * j + l) * vector[j][l];
+                    }
+                }
+
+                product[i][k] = sum;
+            }
+        }
+
+        return product;
+    }
+
+    std::vector<Vector3> fullVector(forceField->atomCount());
+    for(unsigned int i = 0; i < atomIndices.size(); i++){
+        fullVector[atomIndices[i]] = vector[i];
+    }
+
+    std::vector<Vector3> fullProduct = forceField->hessianProduct(fullVector);
+    hessianEvaluationCount++;
+
+    for(unsigned int i = 0; i < atomIndices.size(); i++){
+        product[i] = fullProduct[atomIndices[i]];
+    }
+
+    return product;
+}
+
+// Returns the truncated newton direction which approximately solves
+// H * p = -g using the conjugate gradient method (Nocedal and
+// Wright, Algorithm 7.1). The iterations stop once the residual is
+// below the forcing tolerance or when negative curvature is found.
+std::vector<Vector3> ForceFieldMinimizerPrivate::newtonDirection()
+{
+    updateHessian();
+
+    int size = gradient.size();
+
+    std::vector<Vector3> direction(size);
+    std::vector<Vector3> residual = gradient;
+    std::vector<Vector3> conjugate(size);
+    for(int i = 0; i < size; i++){
+        conjugate[i] = -gradient[i];
+    }
+
+    Float residualNorm = dot(residual, residual);
+    Float gradientNorm = sqrt(residualNorm);
+    Float tolerance = qMin(Float(0.5), sqrt(gradientNorm)) * gradientNorm;
+
+    int maximumIterations = qMin(3 * size, 100);
+
+    for(int i = 0; i < maximumIterations; i++){
+        if(canceled){
+            break;
+        }
+
+        std::vector<Vector3> product = hessianProduct(conjugate);
+
+        Float curvature = dot(conjugate, product);
+        if(curvature <= 0){
+            // use the steepest descent direction if negative
+            // curvature is found before any progress was made
+            if(i == 0){
+                direction = conjugate;
+            }
+
+            break;
+        }
+
+        Float alpha = residualNorm / curvature;
+        for(int j = 0; j < size; j++){
+            direction[j] += conjugate[j] * alpha;
+            residual[j] += product[j] * alpha;
+        }
+
+        Float newResidualNorm = dot(residual, residual);
+        if(sqrt(newResidualNorm) < tolerance){
+            break;
+        }
+
+        Float beta = newResidualNorm / residualNorm;
+        residualNorm = newResidualNorm;
+
+        for(int j = 0; j < size; j++){
+            conjugate[j] = -residual[j] + conjugate[j] * beta;
+        }
+    }
+
+    return direction;
+}
+
+// Searches along direction for a step satisfying the strong Wolfe
+// conditions using bracketing followed by cubic interpolation
+// (Nocedal and Wright, Algorithms 3.5 and 3.6). On success the atoms
+// are left at the accepted point which is stored in result.
+bool ForceFieldMinimizerPrivate::lineSearch(const std::vector<Vector3> &direction,
+                                            Float initialStep,
+                                            Float curvatureFactor,
+                                            LineSearchPoint &result)
+{
+    const Float sufficientDecreaseFactor = 1.0e-4;
+    const int maximumBracketSteps = 10;
+    const int maximumZoomSteps = 20;
+
+    LineSearchPoint origin;
+    origin.step = 0;
+    origin.energy = energy;
+    origin.slope = dot(gradient, direction);
+    origin.gradient = gradient;
+
+    LineSearchPoint best = origin;
+    LineSearchPoint previous = origin;
+    LineSearchPoint low;
+    LineSearchPoint high;
+    bool bracketed = false;
+
+    Float step = initialStep;
+
+    for(int i = 0; i < maximumBracketSteps; i++){
+        if(canceled){
+            return false;
+        }
+
+        LineSearchPoint current = evaluate(direction, step);
+        if(current.energy < best.energy){
+            best = current;
+        }
+
+        if(qIsNaN(current.energy) ||
+           current.energy > origin.energy + sufficientDecreaseFactor * step * origin.slope ||
+           (i > 0 && current.energy >= previous.energy)){
+            low = previous;
+            high = current;
+            bracketed = true;
+            break;
+        }
+
+        if(qAbs(current.slope) <= -curvatureFactor * origin.slope){
+            result = current;
+            return true;
+        }
+
+        if(current.slope >= 0){
+            low = current;
+            high = previous;
+            bracketed = true;
+            break;
+        }
+
+        previous = current;
+        step *= 2;
+    }
+
+    if(bracketed){
+        for(int i = 0; i < maximumZoomSteps; i++){
+            if(canceled){
+                return false;
+            }
+
+            Float step = cubicInterpolate(low, high);
+            if(qAbs(high.step - low.step) < 1.0e-12){
+                break;
+            }
+
+            LineSearchPoint current = evaluate(direction, step);
+            if(current.energy < best.energy){
+                best = current;
+            }
+
+            if(qIsNaN(current.energy) ||
+               current.energy > origin.energy + sufficientDecreaseFactor * step * origin.slope ||
+               current.energy >= low.energy){
+                high = current;
+            }
+            else{
+                if(qAbs(current.slope) <= -curvatureFactor * origin.slope){
+                    result = current;
+                    return true;
+                }
+
+                if(current.slope * (high.step - low.step) >= 0){
+                    high = low;
+                }
+
+                low = current;
+            }
+        }
+    }
+
+    // accept the lowest energy point found if it decreased the energy
+    if(best.step > 0 && best.energy < origin.energy){
+        evaluate(direction, best.step);
+        result = best;
+        return true;
+    }
+
+    return false;
+}
+
+// Performs one step of steepest descent, conjugate gradient, l-bfgs
+// or truncated newton minimization.
+bool ForceFieldMinimizerPrivate::lineSearchStep()
+{
+    std::vector<Vector3> direction = searchDirection();
+
+    bool quasiNewton = (algorithm == ForceFieldMinimizer::Lbfgs && !curvatures.empty()) ||
+                       algorithm == ForceFieldMinimizer::TruncatedNewton;
+
+    // (quasi-)newton methods try the unit step first while the other
+    // methods (and the first l-bfgs step) start with a step moving
+    // the furthest atom by the maximum step size
+    Float longestStep = maximumLength(direction);
+    if(longestStep == 0){
+        return false;
+    }
+
+    Float initialStep = quasiNewton ? 1.0 : maximumStepSize / longestStep;
+    if(initialStep * longestStep > maximumStepSize){
+        initialStep = maximumStepSize / longestStep;
+    }
+
+    Float curvatureFactor = algorithm == ForceFieldMinimizer::ConjugateGradient ? 0.1 : 0.9;
+
+    LineSearchPoint point;
+    bool found = lineSearch(direction, initialStep, curvatureFactor, point);
+
+    if(!found && !canceled && dot(direction, gradient) != -dot(gradient, gradient)){
+        // retry along the steepest descent direction
+        clearHistory();
+
+        for(unsigned int i = 0; i < direction.size(); i++){
+            direction[i] = -gradient[i];
+        }
+
+        found = lineSearch(direction, maximumStepSize / maximumLength(direction), curvatureFactor, point);
+    }
+
+    if(!found){
+        // restore the last accepted positions
+        writePositions(positions);
+        return false;
+    }
+
+    std::vector<Vector3> oldPositions = positions;
+    std::vector<Vector3> oldGradient = gradient;
+
+    for(unsigned int i = 0; i < positions.size(); i++){
+        positions[i] += direction[i] * point.step;
+    }
+
+    energyChange = point.energy - energy;
+    energy = point.energy;
+    gradient = point.gradient;
+
+    previousGradient = oldGradient;
+    previousDirection = direction;
+    updateHistory(oldPositions, oldGradient);
+
+    return true;
+}
+
+// Stores the position and gradient differences for l-bfgs.
+void ForceFieldMinimizerPrivate::updateHistory(const std::vector<Vector3> &oldPositions,
+                                               const std::vector<Vector3> &oldGradient)
+{
+    if(algorithm != ForceFieldMinimizer::Lbfgs){
+        return;
+    }
+
+    std::vector<Vector3> s(positions.size());
+    std::vector<Vector3> y(positions.size());
+    for(unsigned int i = 0; i < positions.size(); i++){
+        s[i] = positions[i] - oldPositions[i];
+        y[i] = gradient[i] - oldGradient[i];
+    }
+
+    // skip the update if the curvature condition is not satisfied
+    Float sy = dot(s, y);
+    if(sy <= 1.0e-10 * dot(y, y)){
+        return;
+    }
+
+    positionDifferences.push_back(s);
+    gradientDifferences.push_back(y);
+    curvatures.push_back(1.0 / sy);
+
+    while(int(curvatures.size()) > historySize){
+        positionDifferences.pop_front();
+        gradientDifferences.pop_front();
+        curvatures.pop_front();
+    }
+}
+
+// Performs one step of the fast inertial relaxation engine (FIRE)
+// of Bitzek et al. (Phys. Rev. Lett. 97, 170201, 2006).
+bool ForceFieldMinimizerPrivate::fireStep()
+{
+    const Float maximumTimeStep = 1.0;
+    const Float initialMixing = 0.1;
+    const int minimumDownhillSteps = 5;
+
+    Float power = 0;
+    for(unsigned int i = 0; i < velocities.size(); i++){
+        power -= gradient[i] * velocities[i];
+    }
+
+    if(power > 0){
+        // mix the velocity towards the force direction
+        Float velocityNorm = sqrt(dot(velocities, velocities));
+        Float forceNorm = sqrt(dot(gradient, gradient));
+
+        for(unsigned int i = 0; i < velocities.size(); i++){
+            velocities[i] = velocities[i] * (1 - mixing) - gradient[i] * (mixing * velocityNorm / forceNorm);
+        }
+
+        if(++downhillStepCount > minimumDownhillSteps){
+            timeStep = qMin(timeStep * 1.1, maximumTimeStep);
+            mixing *= 0.99;
+        }
+    }
+    else{
+        // moving uphill so stop and slow down
+        velocities.assign(velocities.size(), Vector3());
+        timeStep *= 0.5;
+        mixing = initialMixing;
+        downhillStepCount = 0;
+    }
+
+    // semi-implicit euler integration with unit masses
+    std::vector<Vector3> displacements(positions.size());
+    for(unsigned int i = 0; i < positions.size(); i++){
+        velocities[i] -= gradient[i] * timeStep;
+        displacements[i] = velocities[i] * timeStep;
+    }
+
+    // limit the displacement of the furthest atom
+    Float longestDisplacement = maximumLength(displacements);
+    if(longestDisplacement > maximumStepSize){
+        Float scale = maximumStepSize / longestDisplacement;
+        for(unsigned int i = 0; i < displacements.size(); i++){
+            displacements[i] *= scale;
+        }
+    }
+
+    std::vector<Vector3> newPositions(positions.size());
+    for(unsigned int i = 0; i < positions.size(); i++){
+        newPositions[i] = positions[i] + displacements[i];
+    }
+    writePositions(newPositions);
+
+    std::vector<Vector3> newGradient;
+    Float newEnergy = evaluate(newGradient);
+    if(qIsNaN(newEnergy)){
+        writePositions(positions);
+        velocities.assign(velocities.size(), Vector3());
+        timeStep *= 0.5;
+        return timeStep > 1.0e-8;
+    }
+
+    positions = newPositions;
+    gradient = newGradient;
+    energyChange = newEnergy - energy;
+    energy = newEnergy;
+
+    return true;
+}
+
+bool ForceFieldMinimizerPrivate::checkConvergence() const
+{
+    // energy change
+    if(energyConvergence > 0 && qAbs(energyChange) < energyConvergence){
+        return true;
+    }
+
+    if(rootMeanSquareGradientConvergence <= 0 && maximumGradientConvergence <= 0){
+        return false;
+    }
+
+    // root mean square gradient
+    if(rootMeanSquareGradientConvergence > 0){
+        Float rmsg = gradient.empty() ? 0 : sqrt(dot(gradient, gradient) / (3.0 * gradient.size()));
+        if(rmsg >= rootMeanSquareGradientConvergence){
+            return false;
+        }
+    }
+
+    // largest gradient
+    if(maximumGradientConvergence > 0){
+        if(maximumLength(gradient) >= maximumGradientConvergence){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// === ForceFieldMinimizer ================================================= //
+/// \class ForceFieldMinimizer forcefieldminimizer.h chemkit/forcefieldminimizer.h
+/// \ingroup chemkit
+/// \brief The ForceFieldMinimizer class minimizes the energy of a
+///        force field.
+///
+/// The following minimization algorithms are available:
+///     - \c SteepestDescent
+///     - \c ConjugateGradient (Polak-Ribiere)
+///     - \c Lbfgs (limited memory Broyden-Fletcher-Goldfarb-Shanno)
+///     - \c Fire (fast inertial relaxation engine)
+///     - \c TruncatedNewton (newton's method with the newton equations
+///       solved approximately by conjugate gradient iterations)
+///
+/// The line search based methods use a line search satisfying the
+/// strong Wolfe conditions.
+///
+/// The truncated newton algorithm uses the second derivatives of the
+/// energy (see ForceField::hessian()). It takes far fewer steps than
+/// the other algorithms but each step requires several products of
+/// the Hessian with a vector. For small systems the Hessian is
+/// calculated once per step while for larger systems the products
+/// are calculated with ForceField::hessianProduct().
+///
+/// Frozen atoms (see ForceFieldAtom::setFrozen()) are not moved and
+/// only the coordinates of the other atoms are minimized. The
+/// convergence criteria only consider the gradient of those atoms.
+///
+/// The following example shows how to minimize the energy of a
+/// molecule using the uff force field and the l-bfgs algorithm.
+///
+/// \code
+/// ForceField *forceField = ForceField::create("uff");
+/// forceField->addMolecule(molecule);
+/// forceField->setup();
+///
+/// ForceFieldMinimizer minimizer(forceField, ForceFieldMinimizer::Lbfgs);
+/// minimizer.minimize();
+///
+/// forceField->writeCoordinates(molecule);
+/// \endcode
+///
+/// \see ForceField
+
+/// \enum ForceFieldMinimizer::Algorithm
+/// Provides the minimization algorithms:
+///     - \c SteepestDescent
+///     - \c ConjugateGradient
+///     - \c Lbfgs
+///     - \c Fire
+///     - \c TruncatedNewton
+
+/// \enum ForceFieldMinimizer::Status
+/// Provides the minimization status:
+///     - \c Ready
+///     - \c Converged
+///     - \c Failed
+///     - \c Canceled
+///     - \c StepLimitReached
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new minimizer for \p forceField using \p algorithm.
+ForceFieldMinimizer::ForceFieldMinimizer(ForceField *forceField, Algorithm algorithm)
+    : d(new ForceFieldMinimizerPrivate)
+{
+    d->forceField = forceField;
+    d->algorithm = algorithm;
+    d->historySize = 10;
+    d->maximumStepSize = 0.3;
+    d->energyConvergence = 1.0e-7;
+    d->rootMeanSquareGradientConvergence = 0.1;
+    d->maximumGradientConvergence = 0.5;
+    d->maximumStepCount = 1000;
+
+    reset();
+}
+
+/// Destroys the minimizer object.
+ForceFieldMinimizer::~ForceFieldMinimizer()
+{
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Sets the force field to minimize to \p forceField.
+void ForceFieldMinimizer::setForceField(ForceField *forceField)
+{
+    d->forceField = forceField;
+    reset();
+}
+
+/// Returns the force field being minimized.
+ForceField* ForceFieldMinimizer::forceField() const
+{
+    return d->forceField;
+}
+
+/// Sets the minimization algorithm to \p algorithm.
+void ForceFieldMinimizer::setAlgorithm(Algorithm algorithm)
+{
+    d->algorithm = algorithm;
+    d->clearHistory();
+}
+
+/// Returns the minimization algorithm.
+ForceFieldMinimizer::Algorithm ForceFieldMinimizer::algorithm() const
+{
+    return d->algorithm;
+}
+
+/// Sets the number of previous steps used by the l-bfgs algorithm
+/// to approximate the inverse hessian. The default is \c 10.
+void ForceFieldMinimizer::setHistorySize(int size)
+{
+    d->historySize = qMax(1, size);
+}
+
+/// Returns the number of previous steps used by the l-bfgs
+/// algorithm.
+int ForceFieldMinimizer::historySize() const
+{
+    return d->historySize;
+}
+
+/// Sets the maximum distance an atom may be moved in a single step
+/// to \p size. The default is \c 0.3 Angstroms.
+void ForceFieldMinimizer::setMaximumStepSize(Float size)
+{
+    d->maximumStepSize = size;
+}
+
+/// Returns the maximum distance an atom may be moved in a single
+/// step.
+Float ForceFieldMinimizer::maximumStepSize() const
+{
+    return d->maximumStepSize;
+}
+
+// --- Convergence Criteria ------------------------------------------------ //
+/// Sets the energy convergence value to \p value. The minimization
+/// is considered converged when the energy changes by less than
+/// \p value in one step. Setting \p value to \c 0 disables the
+/// energy criterion. The default is \c 1.0e-7 kcal/mol.
+void ForceFieldMinimizer::setEnergyConvergence(Float value)
+{
+    d->energyConvergence = value;
+}
+
+/// Returns the energy convergence value.
+Float ForceFieldMinimizer::energyConvergence() const
+{
+    return d->energyConvergence;
+}
+
+/// Sets the root mean square gradient convergence value to
+/// \p value. Setting \p value to \c 0 disables the criterion. The
+/// default is \c 0.1 kcal/mol/Angstrom.
+void ForceFieldMinimizer::setRootMeanSquareGradientConvergence(Float value)
+{
+    d->rootMeanSquareGradientConvergence = value;
+}
+
+/// Returns the root mean square gradient convergence value.
+Float ForceFieldMinimizer::rootMeanSquareGradientConvergence() const
+{
+    return d->rootMeanSquareGradientConvergence;
+}
+
+/// Sets the largest gradient convergence value to \p value. Setting
+/// \p value to \c 0 disables the criterion. The default is \c 0.5
+/// kcal/mol/Angstrom.
+///
+/// The minimization is considered converged when both the root mean
+/// square gradient and the largest gradient are below their
+/// convergence values (or the energy criterion is met).
+void ForceFieldMinimizer::setMaximumGradientConvergence(Float value)
+{
+    d->maximumGradientConvergence = value;
+}
+
+/// Returns the largest gradient convergence value.
+Float ForceFieldMinimizer::maximumGradientConvergence() const
+{
+    return d->maximumGradientConvergence;
+}
+
+/// Sets the maximum number of steps performed by minimize() to
+/// \p count. If \p count is \c 0 there is no limit. The default is
+/// \c 1000.
+void ForceFieldMinimizer::setMaximumStepCount(int count)
+{
+    d->maximumStepCount = count;
+}
+
+/// Returns the maximum number of steps performed by minimize().
+int ForceFieldMinimizer::maximumStepCount() const
+{
+    return d->maximumStepCount;
+}
+
+// --- State --------------------------------------------------------------- //
+/// Returns the status of the minimization.
+ForceFieldMinimizer::Status ForceFieldMinimizer::status() const
+{
+    return d->status;
+}
+
+/// Returns \c true if the minimization has converged.
+bool ForceFieldMinimizer::isConverged() const
+{
+    return d->status == Converged;
+}
+
+/// Returns the energy after the last step.
+Float ForceFieldMinimizer::energy() const
+{
+    return d->energy;
+}
+
+/// Returns the change in energy during the last step.
+Float ForceFieldMinimizer::energyChange() const
+{
+    return d->energyChange;
+}
+
+/// Returns the root mean square gradient after the last step.
+Float ForceFieldMinimizer::rootMeanSquareGradient() const
+{
+    if(d->gradient.empty()){
+        return 0;
+    }
+
+    return sqrt(dot(d->gradient, d->gradient) / (3.0 * d->gradient.size()));
+}
+
+/// Returns the magnitude of the largest gradient after the last
+/// step.
+Float ForceFieldMinimizer::maximumGradient() const
+{
+    return maximumLength(d->gradient);
+}
+
+/// Returns the number of steps performed.
+int ForceFieldMinimizer::stepCount() const
+{
+    return d->stepCount;
+}
+
+/// Returns the number of times the energy was calculated.
+int ForceFieldMinimizer::energyEvaluationCount() const
+{
+    return d->energyEvaluationCount;
+}
+
+/// Returns the number of times the gradient was calculated.
+int ForceFieldMinimizer::gradientEvaluationCount() const
+{
+    return d->gradientEvaluationCount;
+}
+
+/// Returns the number of times the Hessian (or its product with a
+/// vector) was calculated by the truncated newton algorithm.
+int ForceFieldMinimizer::hessianEvaluationCount() const
+{
+    return d->hessianEvaluationCount;
+}
+
+// --- Minimization -------------------------------------------------------- //
+/// Performs one step of energy minimization. Returns \c true if
+/// converged.
+///
+/// If the atom positions in the force field were changed since the
+/// last step the minimizer is restarted from the new positions.
+bool ForceFieldMinimizer::step()
+{
+    if(!d->forceField || d->canceled){
+        return false;
+    }
+
+    if(!d->initialized || d->positionsChanged()){
+        d->initialize();
+    }
+
+    bool ok;
+    if(d->algorithm == Fire){
+        ok = d->fireStep();
+    }
+    else{
+        ok = d->lineSearchStep();
+    }
+
+    if(d->canceled){
+        d->status = Canceled;
+        return false;
+    }
+
+    d->stepCount++;
+
+    if(!ok){
+        d->status = Failed;
+        return false;
+    }
+
+    if(d->checkConvergence()){
+        d->status = Converged;
+        return true;
+    }
+
+    d->status = Ready;
+    return false;
+}
+
+/// Performs energy minimization until converged, the maximum
+/// number of steps is reached or the minimization is canceled.
+/// Returns \c true if converged.
+bool ForceFieldMinimizer::minimize()
+{
+    for(;;){
+        if(step()){
+            return true;
+        }
+        else if(d->status != Ready){
+            return false;
+        }
+        else if(d->maximumStepCount > 0 && d->stepCount >= d->maximumStepCount){
+            d->status = StepLimitReached;
+            return false;
+        }
+    }
+}
+
+/// Performs one step of energy minimization asynchronously.
+///
+/// \see step()
+QFuture<bool> ForceFieldMinimizer::stepAsync()
+{
+    d->canceled = 0;
+
+    return QtConcurrent::run(this, &ForceFieldMinimizer::step);
+}
+
+/// Performs energy minimization asynchronously.
+///
+/// \see minimize()
+QFuture<bool> ForceFieldMinimizer::minimizeAsync()
+{
+    d->canceled = 0;
+
+    return QtConcurrent::run(this, &ForceFieldMinimizer::minimize);
+}
+
+/// Cancels a running minimization. The atoms are left at the last
+/// accepted positions. The minimizer remains canceled until reset()
+/// is called or a new asynchronous minimization is started.
+void ForceFieldMinimizer::cancel()
+{
+    d->canceled = 1;
+}
+
+/// Returns \c true if the minimization was canceled.
+bool ForceFieldMinimizer::isCanceled() const
+{
+    return d->canceled;
+}
+
+/// Resets the minimizer. The step and evaluation counters are set to
+/// zero and the next step starts from the current atom positions.
+void ForceFieldMinimizer::reset()
+{
+    d->status = Ready;
+    d->stepCount = 0;
+    d->energyEvaluationCount = 0;
+    d->gradientEvaluationCount = 0;
+    d->hessianEvaluationCount = 0;
+    d->energy = 0;
+    d->energyChange = 0;
+    d->canceled = 0;
+    d->initialized = false;
+    d->atoms.clear();
+    d->atomIndices.clear();
+    d->positions.clear();
+    d->gradient.clear();
+    d->hessian = Matrix();
+    d->denseHessian = false;
+    d->clearHistory();
+}
+
+} // end chemkit namespace
@@ -0,0 +1,124 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#ifndef CHEMKIT_FORCEFIELDMINIMIZER_H
+#define CHEMKIT_FORCEFIELDMINIMIZER_H
+
+#include "chemkit.h"
+
+#include <QtCore>
+
+#include <vector>
+
+#include "vector3.h"
+
+namespace chemkit {
+
+class ForceField;
+class ForceFieldMinimizerPrivate;
+
+class CHEMKIT_EXPORT ForceFieldMinimizer
+{
+    public:
+        // enumerations
+        enum Algorithm {
+            SteepestDescent,
+            ConjugateGradient,
+            Lbfgs,
+            Fire,
+            TruncatedNewton
+        };
+
+        enum Status {
+            Ready,
+            Converged,
+            Failed,
+            Canceled,
+            StepLimitReached
+        };
+
+        // construction and destruction
+        ForceFieldMinimizer(ForceField *forceField = 0, Algorithm algorithm = Lbfgs);
+        ~ForceFieldMinimizer();
+
+        // properties
+        void setForceField(ForceField *forceField);
+        ForceField* forceField() const;
+        void setAlgorithm(Algorithm algorithm);
+        Algorithm algorithm() const;
+        void setHistorySize(int size);
+        int historySize() const;
+        void setMaximumStepSize(Float size);
+        Float maximumStepSize() const;
+
+        // convergence criteria
+        void setEnergyConvergence(Float value);
+        Float energyConvergence() const;
+        void setRootMeanSquareGradientConvergence(Float value);
+        Float rootMeanSquareGradientConvergence() const;
+        void setMaximumGradientConvergence(Float value);
+        Float maximumGradientConvergence() const;
+        void setMaximumStepCount(int count);
+        int maximumStepCount() const;
+
+        // state
+        Status status() const;
+        bool isConverged() const;
+        Float energy() const;
+        Float energyChange() const;
+        Float rootMeanSquareGradient() const;
+        Float maximumGradient() const;
+        int stepCount() const;
+        int energyEvaluationCount() const;
+        int gradientEvaluationCount() const;
+        int hessianEvaluationCount() const;
+
+        // minimization
+        bool step();
+        bool minimize();
+        QFuture<bool> stepAsync();
+        QFuture<bool> minimizeAsync();
+        void cancel();
+        bool isCanceled() const;
+        void reset();
+
+    private:
+        ForceFieldMinimizerPrivate* const d;
+};
+
+} // end chemkit namespace
+
+#endif // CHEMKIT_FORCEFIELDMINIMIZER_H
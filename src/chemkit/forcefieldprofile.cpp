@@ -0,0 +1,284 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "forcefieldprofile.h"
+
+#include <map>
+
+namespace chemkit {
+
+namespace {
+
+// The profile of a single calculation type.
+class ProfileEntry
+{
+    public:
+        ProfileEntry()
+            : calculationCount(0),
+              energy(0),
+              gradientNorm(0),
+              time(0)
+        {
+        }
+
+        int calculationCount;
+        Float energy;
+        Float gradientNorm;
+        Float time;
+};
+
+} // end anonymous namespace
+
+// === ForceFieldProfilePrivate ============================================ //
+class ForceFieldProfilePrivate
+{
+    public:
+        std::map<int, ProfileEntry> entries;
+        int energyEvaluationCount;
+        int gradientEvaluationCount;
+        int neighborListBuildCount;
+        int neighborListPairCount;
+        int neighborListCellCount;
+        Float neighborListTime;
+};
+
+// === ForceFieldProfile =================================================== //
+/// \class ForceFieldProfile forcefieldprofile.h chemkit/forcefieldprofile.h
+/// \ingroup chemkit
+/// \brief The ForceFieldProfile class contains energy and timing
+///        information for each type of force field calculation.
+///
+/// A force field collects a profile while profiling is enabled with
+/// ForceField::setProfilingEnabled(). For each calculation type (see
+/// ForceFieldCalculation::Type) the profile contains the number of
+/// calculations, the energy and the gradient norm from the last
+/// evaluation, and the total time spent evaluating them. Statistics
+/// for the neighbor list used by the force field's electrostatics
+/// methods are also recorded.
+///
+/// Times are measured with a nanosecond timer when chemkit is built
+/// against Qt 4.8 or later and to the nearest millisecond otherwise.
+///
+/// The following example shows how to print the energy of each
+/// calculation type:
+///
+/// \code
+/// forceField->setProfilingEnabled(true);
+/// forceField->energy();
+///
+/// const ForceFieldProfile *profile = forceField->profile();
+/// foreach(int type, profile->types()){
+///     qDebug() << type << profile->energy(type);
+/// }
+/// \endcode
+///
+/// \see ForceField::profile()
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new, empty profile.
+ForceFieldProfile::ForceFieldProfile()
+    : d(new ForceFieldProfilePrivate)
+{
+    clear();
+}
+
+/// Destroys the profile.
+ForceFieldProfile::~ForceFieldProfile()
+{
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Returns \c true if the profile contains no evaluations.
+bool ForceFieldProfile::isEmpty() const
+{
+    return d->energyEvaluationCount == 0 &&
+           d->gradientEvaluationCount == 0 &&
+           d->neighborListBuildCount == 0;
+}
+
+/// Removes all of the information from the profile.
+void ForceFieldProfile::clear()
+{
+    d->entries.clear();
+    d->energyEvaluationCount = 0;
+    d->gradientEvaluationCount = 0;
+    d->neighborListBuildCount = 0;
+    d->neighborListPairCount = 0;
+    d->neighborListCellCount = 0;
+    d->neighborListTime = 0;
+}
+
+// --- Calculations -------------------------------------------------------- //
+/// Returns a list of the calculation types in the profile. Types
+/// are those returned by ForceFieldCalculation::type() so
+/// calculations with a combination of types (e.g. stretch-bend
+/// calculations) are recorded separately.
+std::vector<int> ForceFieldProfile::types() const
+{
+    std::vector<int> types;
+
+    for(std::map<int, ProfileEntry>::const_iterator iter = d->entries.begin(); iter != d->entries.end(); ++iter){
+        types.push_back(iter->first);
+    }
+
+    return types;
+}
+
+/// Returns the number of calculations of \p type.
+int ForceFieldProfile::calculationCount(int type) const
+{
+    std::map<int, ProfileEntry>::const_iterator iter = d->entries.find(type);
+
+    return iter != d->entries.end() ? iter->second.calculationCount : 0;
+}
+
+/// Returns the energy of the calculations of \p type from the last
+/// energy evaluation. Energy is in kcal/mol.
+Float ForceFieldProfile::energy(int type) const
+{
+    std::map<int, ProfileEntry>::const_iterator iter = d->entries.find(type);
+
+    return iter != d->entries.end() ? iter->second.energy : 0;
+}
+
+/// Returns the norm of the gradient of the calculations of \p type
+/// from the last gradient evaluation.
+Float ForceFieldProfile::gradientNorm(int type) const
+{
+    std::map<int, ProfileEntry>::const_iterator iter = d->entries.find(type);
+
+    return iter != d->entries.end() ? iter->second.gradientNorm : 0;
+}
+
+/// Returns the total time spent evaluating the energy and gradient
+/// of the calculations of \p type. Time is in milliseconds.
+Float ForceFieldProfile::time(int type) const
+{
+    std::map<int, ProfileEntry>::const_iterator iter = d->entries.find(type);
+
+    return iter != d->entries.end() ? iter->second.time : 0;
+}
+
+/// Returns the total time spent evaluating the energy and gradient
+/// of every calculation type. Time is in milliseconds.
+Float ForceFieldProfile::totalTime() const
+{
+    Float time = 0;
+
+    for(std::map<int, ProfileEntry>::const_iterator iter = d->entries.begin(); iter != d->entries.end(); ++iter){
+        time += iter->second.time;
+    }
+
+    return time;
+}
+
+/// Returns the number of times the energy was evaluated.
+int ForceFieldProfile::energyEvaluationCount() const
+{
+    return d->energyEvaluationCount;
+}
+
+/// Returns the number of times the gradient was evaluated.
+int ForceFieldProfile::gradientEvaluationCount() const
+{
+    return d->gradientEvaluationCount;
+}
+
+// --- Neighbor List ------------------------------------------------------- //
+/// Returns the number of times the neighbor list was built.
+int ForceFieldProfile::neighborListBuildCount() const
+{
+    return d->neighborListBuildCount;
+}
+
+/// Returns the number of pairs in the neighbor list from the last
+/// time it was built.
+int ForceFieldProfile::neighborListPairCount() const
+{
+    return d->neighborListPairCount;
+}
+
+/// Returns the number of cells in the neighbor list from the last
+/// time it was built.
+int ForceFieldProfile::neighborListCellCount() const
+{
+    return d->neighborListCellCount;
+}
+
+/// Returns the total time spent building the neighbor list. Time is
+/// in milliseconds.
+Float ForceFieldProfile::neighborListTime() const
+{
+    return d->neighborListTime;
+}
+
+// --- Internal Methods ---------------------------------------------------- //
+void ForceFieldProfile::addEnergy(int type, int calculationCount, Float energy, Float time)
+{
+    ProfileEntry &entry = d->entries[type];
+    entry.calculationCount = calculationCount;
+    entry.energy = energy;
+    entry.time += time;
+}
+
+void ForceFieldProfile::addGradient(int type, int calculationCount, Float gradientNorm, Float time)
+{
+    ProfileEntry &entry = d->entries[type];
+    entry.calculationCount = calculationCount;
+    entry.gradientNorm = gradientNorm;
+    entry.time += time;
+}
+
+void ForceFieldProfile::addEnergyEvaluation()
+{
+    d->energyEvaluationCount++;
+}
+
+void ForceFieldProfile::addGradientEvaluation()
+{
+    d->gradientEvaluationCount++;
+}
+
+void ForceFieldProfile::addNeighborListBuild(int pairCount, int cellCount, Float time)
+{
+    d->neighborListBuildCount++;
+    d->neighborListPairCount = pairCount;
+    d->neighborListCellCount = cellCount;
+    d->neighborListTime += time;
+}
+
+} // end chemkit namespace
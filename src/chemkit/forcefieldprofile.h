@@ -0,0 +1,91 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#ifndef CHEMKIT_FORCEFIELDPROFILE_H
+#define CHEMKIT_FORCEFIELDPROFILE_H
+
+#include "chemkit.h"
+
+#include <vector>
+
+namespace chemkit {
+
+class ForceFieldProfilePrivate;
+
+class CHEMKIT_EXPORT ForceFieldProfile
+{
+    public:
+        // construction and destruction
+        ForceFieldProfile();
+        ~ForceFieldProfile();
+
+        // properties
+        bool isEmpty() const;
+        void clear();
+
+        // calculations
+        std::vector<int> types() const;
+        int calculationCount(int type) const;
+        Float energy(int type) const;
+        Float gradientNorm(int type) const;
+        Float time(int type) const;
+        Float totalTime() const;
+        int energyEvaluationCount() const;
+        int gradientEvaluationCount() const;
+
+        // neighbor list
+        int neighborListBuildCount() const;
+        int neighborListPairCount() const;
+        int neighborListCellCount() const;
+        Float neighborListTime() const;
+
+    private:
+        void addEnergy(int type, int calculationCount, Float energy, Float time);
+        void addGradient(int type, int calculationCount, Float gradientNorm, Float time);
+        void addEnergyEvaluation();
+        void addGradientEvaluation();
+        void addNeighborListBuild(int pairCount, int cellCount, Float time);
+
+        friend class ForceField;
+        friend class ForceFieldPrivate;
+
+    private:
+        ForceFieldProfilePrivate* const d;
+};
+
+} // end chemkit namespace
+
+#endif // CHEMKIT_FORCEFIELDPROFILE_H
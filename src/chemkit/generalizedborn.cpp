@@ -0,0 +1,743 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "generalizedborn.h"
+
+#include <cmath>
+
+#include <QtCore>
+
+#include "atom.h"
+#include "foreach.h"
+#include "constants.h"
+#include "neighborlist.h"
+
+namespace chemkit {
+
+namespace {
+
+// Coulomb constant in (kcal * angstrom) / (mol * e^2).
+const Float CoulombConstant = 332.0716;
+
+// Offset subtracted from the intrinsic radii when calculating the
+// descreening integrals.
+const Float RadiusOffset = 0.09;
+
+// Rescaling parameters of the OBC II model.
+const Float ObcAlpha = 1.0;
+const Float ObcBeta = 0.8;
+const Float ObcGamma = 4.85;
+
+// The GeneralizedBornChunk class contains the atoms whose pairs are
+// evaluated by a single thread along with the sums accumulated for
+// them. Each chunk takes every stride'th atom starting at first so
+// that the number of pairs is balanced when every pair is used.
+class GeneralizedBornChunk
+{
+    public:
+        int first;
+        int stride;
+        const std::vector<Point3> *positions;
+        const std::vector<Float> *charges;
+        const std::vector<Float> *offsetRadii;
+        const std::vector<Float> *scaledRadii;
+        const std::vector<Float> *bornRadii;
+        const std::vector<Float> *radiusChain;
+        const NeighborList *neighborList;
+        Float cutoff;
+        Float prefactor;
+        bool calculateGradient;
+        Float energy;
+        std::vector<Float> values;
+        std::vector<Vector3> gradient;
+};
+
+// Returns the number of pairs of atom i with atoms of higher index.
+inline int pairCount(const GeneralizedBornChunk &chunk, int i)
+{
+    if(chunk.neighborList){
+        return chunk.neighborList->neighborCount(i);
+    }
+
+    return chunk.positions->size() - i - 1;
+}
+
+// Returns the k'th atom paired with atom i.
+inline int pairAtom(const GeneralizedBornChunk &chunk, int i, int k)
+{
+    if(chunk.neighborList){
+        return chunk.neighborList->neighbor(i, k);
+    }
+
+    return i + 1 + k;
+}
+
+// Returns the contribution of an atom with scaled radius s at
+// distance r to the descreening integral of an atom with offset
+// radius rho (Hawkins, Cramer and Truhlar, J. Phys. Chem. 100,
+// 19824, 1996). If derivative is not null it is set to the
+// derivative of the contribution with respect to r.
+Float descreening(Float r, Float rho, Float s, Float *derivative)
+{
+    if(rho >= r + s){
+        if(derivative){
+            *derivative = 0;
+        }
+
+        return 0;
+    }
+
+    Float lower = qMax(rho, qAbs(r - s));
+    Float l = 1.0 / lower;
+    Float u = 1.0 / (r + s);
+    Float logRatio = std::log(u / l);
+
+    Float value = l - u + 0.25 * r * (u * u - l * l) + 0.5 * logRatio / r + 0.25 * s * s * (l * l - u * u) / r;
+
+    // the atom is inside the scaled sphere
+    bool inside = rho < s - r;
+    if(inside){
+        value += 2 * (1.0 / rho - l);
+    }
+
+    if(derivative){
+        Float du = -u * u;
+        Float dl = 0;
+        if(rho < qAbs(r - s)){
+            dl = r > s ? -l * l : l * l;
+        }
+
+        Float d = dl - du +
+                  0.25 * (u * u - l * l) + 0.5 * r * (u * du - l * dl) -
+                  0.5 * logRatio / (r * r) + 0.5 * (du / u - dl / l) / r -
+                  0.25 * s * s * (l * l - u * u) / (r * r) + 0.5 * s * s * (l * dl - u * du) / r;
+
+        if(inside){
+            d -= 2 * dl;
+        }
+
+        *derivative = d;
+    }
+
+    return value;
+}
+
+// Accumulates the descreening integral of each atom.
+void calculateChunkIntegrals(GeneralizedBornChunk &chunk)
+{
+    const std::vector<Point3> &positions = *chunk.positions;
+    const std::vector<Float> &offsetRadii = *chunk.offsetRadii;
+    const std::vector<Float> &scaledRadii = *chunk.scaledRadii;
+    const Float cutoffSquared = chunk.cutoff * chunk.cutoff;
+
+    chunk.values.assign(positions.size(), 0);
+
+    for(unsigned int i = chunk.first; i < positions.size(); i += chunk.stride){
+        for(int k = 0; k < pairCount(chunk, i); k++){
+            int j = pairAtom(chunk, i, k);
+
+            Float distanceSquared = (positions[i] - positions[j]).lengthSquared();
+            if(chunk.cutoff > 0 && distanceSquared >= cutoffSquared){
+                continue;
+            }
+
+            Float r = std::sqrt(distanceSquared);
+
+            chunk.values[i] += 0.5 * descreening(r, offsetRadii[i], scaledRadii[j], 0);
+            chunk.values[j] += 0.5 * descreening(r, offsetRadii[j], scaledRadii[i], 0);
+        }
+    }
+}
+
+// Accumulates the polar self energy of each atom and the polar
+// energy of each pair of atoms along with their derivatives with
+// respect to the positions (if calculateGradient is true) and the
+// born radii (stored in values).
+void calculateChunkPolarEnergy(GeneralizedBornChunk &chunk)
+{
+    const std::vector<Point3> &positions = *chunk.positions;
+    const std::vector<Float> &charges = *chunk.charges;
+    const std::vector<Float> &bornRadii = *chunk.bornRadii;
+    const Float cutoffSquared = chunk.cutoff * chunk.cutoff;
+
+    // with a cutoff the self and pair energies are shifted so that
+    // they cancel for neutral groups of atoms within the cutoff
+    const Float inverseCutoff = chunk.cutoff > 0 ? 1.0 / chunk.cutoff : 0;
+
+    chunk.energy = 0;
+    chunk.values.assign(positions.size(), 0);
+    if(chunk.calculateGradient){
+        chunk.gradient.assign(positions.size(), Vector3());
+    }
+
+    for(unsigned int i = chunk.first; i < positions.size(); i += chunk.stride){
+        if(charges[i] == 0){
+            continue;
+        }
+
+        // self energy
+        Float selfEnergy = 0.5 * chunk.prefactor * charges[i] * charges[i] / bornRadii[i];
+        chunk.energy += selfEnergy - 0.5 * chunk.prefactor * charges[i] * charges[i] * inverseCutoff;
+        chunk.values[i] -= selfEnergy / bornRadii[i];
+
+        for(int k = 0; k < pairCount(chunk, i); k++){
+            int j = pairAtom(chunk, i, k);
+            if(charges[j] == 0){
+                continue;
+            }
+
+            Vector3 delta = positions[i] - positions[j];
+            Float distanceSquared = delta.lengthSquared();
+            if(chunk.cutoff > 0 && distanceSquared >= cutoffSquared){
+                continue;
+            }
+
+            Float radiusProduct = bornRadii[i] * bornRadii[j];
+            Float ratio = distanceSquared / (4 * radiusProduct);
+            Float exponential = std::exp(-ratio);
+            Float denominatorSquared = distanceSquared + radiusProduct * exponential;
+            Float denominator = std::sqrt(denominatorSquared);
+
+            Float energy = chunk.prefactor * charges[i] * charges[j] / denominator;
+            chunk.energy += energy - chunk.prefactor * charges[i] * charges[j] * inverseCutoff;
+
+            // derivative with respect to the product of the born radii
+            Float de_dproduct = -0.5 * energy * exponential * (1 + ratio) / denominatorSquared;
+            chunk.values[i] += de_dproduct * bornRadii[j];
+            chunk.values[j] += de_dproduct * bornRadii[i];
+
+            if(chunk.calculateGradient){
+                Vector3 gradient = delta * (-energy * (1 - 0.25 * exponential) / denominatorSquared);
+                chunk.gradient[i] += gradient;
+                chunk.gradient[j] -= gradient;
+            }
+        }
+    }
+}
+
+// Accumulates the gradient of the energy due to the dependence of
+// the born radii on the positions. The derivative of the energy with
+// respect to the descreening integral of each atom is radiusChain.
+void calculateChunkRadiusGradient(GeneralizedBornChunk &chunk)
+{
+    const std::vector<Point3> &positions = *chunk.positions;
+    const std::vector<Float> &offsetRadii = *chunk.offsetRadii;
+    const std::vector<Float> &scaledRadii = *chunk.scaledRadii;
+    const std::vector<Float> &radiusChain = *chunk.radiusChain;
+    const Float cutoffSquared = chunk.cutoff * chunk.cutoff;
+
+    chunk.gradient.assign(positions.size(), Vector3());
+
+    for(unsigned int i = chunk.first; i < positions.size(); i += chunk.stride){
+        for(int k = 0; k < pairCount(chunk, i); k++){
+            int j = pairAtom(chunk, i, k);
+
+            Vector3 delta = positions[i] - positions[j];
+            Float distanceSquared = delta.lengthSquared();
+            if(chunk.cutoff > 0 && distanceSquared >= cutoffSquared){
+                continue;
+            }
+
+            Float r = std::sqrt(distanceSquared);
+
+            Float dij = 0;
+            Float dji = 0;
+            descreening(r, offsetRadii[i], scaledRadii[j], &dij);
+            descreening(r, offsetRadii[j], scaledRadii[i], &dji);
+
+            Float de_dr = 0.5 * (radiusChain[i] * dij + radiusChain[j] * dji);
+
+            Vector3 gradient = delta * (de_dr / r);
+            chunk.gradient[i] += gradient;
+            chunk.gradient[j] -= gradient;
+        }
+    }
+}
+
+} // end anonymous namespace
+
+// === GeneralizedBornPrivate ============================================== //
+class GeneralizedBornPrivate
+{
+    public:
+        std::vector<Float> radii;
+        std::vector<Float> screeningFactors;
+        Float soluteDielectric;
+        Float solventDielectric;
+        Float surfaceTension;
+        Float probeRadius;
+        Float cutoff;
+        int threadCount;
+        Float polarEnergy;
+        Float nonpolarEnergy;
+        std::vector<Float> offsetRadii;
+        std::vector<Float> scaledRadii;
+        NeighborList neighborList;
+
+        std::vector<GeneralizedBornChunk> chunks(const std::vector<Point3> &positions, int threadCount);
+        void calculateBornRadii(std::vector<GeneralizedBornChunk> &chunks, std::vector<Float> &bornRadii, std::vector<Float> *radiusDerivatives);
+        Float calculateEnergy(const std::vector<Point3> &positions, const std::vector<Float> &charges, std::vector<Vector3> *gradient, int threadCount);
+};
+
+// Builds the neighbor list (if a cutoff is used) and returns the
+// chunks of atoms for each thread.
+std::vector<GeneralizedBornChunk> GeneralizedBornPrivate::chunks(const std::vector<Point3> &positions, int threadCount)
+{
+    if(cutoff > 0){
+        neighborList.setCutoff(cutoff);
+        neighborList.build(positions);
+    }
+
+    int chunkCount = qMax(1, qMin(threadCount, static_cast<int>(positions.size())));
+
+    std::vector<GeneralizedBornChunk> chunks(chunkCount);
+    for(int i = 0; i < chunkCount; i++){
+        GeneralizedBornChunk &chunk = chunks[i];
+        chunk.first = i;
+        chunk.stride = chunkCount;
+        chunk.positions = &positions;
+        chunk.charges = 0;
+        chunk.offsetRadii = 0;
+        chunk.scaledRadii = 0;
+        chunk.bornRadii = 0;
+        chunk.radiusChain = 0;
+        chunk.neighborList = cutoff > 0 ? &neighborList : 0;
+        chunk.cutoff = cutoff;
+        chunk.prefactor = 0;
+        chunk.calculateGradient = false;
+        chunk.energy = 0;
+    }
+
+    return chunks;
+}
+
+// Calculates the born radius of each atom with the OBC model
+// (Onufriev, Bashford and Case, Proteins 55, 383, 2004). If
+// radiusDerivatives is not null it is set to the derivative of each
+// born radius with respect to its descreening integral.
+void GeneralizedBornPrivate::calculateBornRadii(std::vector<GeneralizedBornChunk> &chunks,
+                                                std::vector<Float> &bornRadii,
+                                                std::vector<Float> *radiusDerivatives)
+{
+    const int count = radii.size();
+
+    offsetRadii.resize(count);
+    scaledRadii.resize(count);
+    for(int i = 0; i < count; i++){
+        offsetRadii[i] = radii[i] - RadiusOffset;
+        scaledRadii[i] = offsetRadii[i] * screeningFactors[i];
+    }
+
+    for(unsigned int i = 0; i < chunks.size(); i++){
+        chunks[i].offsetRadii = &offsetRadii;
+        chunks[i].scaledRadii = &scaledRadii;
+    }
+
+    QtConcurrent::blockingMap(chunks, calculateChunkIntegrals);
+
+    bornRadii.resize(count);
+    if(radiusDerivatives){
+        radiusDerivatives->resize(count);
+    }
+
+    for(int i = 0; i < count; i++){
+        // sum the chunks in order so the result does not depend on
+        // the scheduling of the threads
+        Float integral = 0;
+        for(unsigned int j = 0; j < chunks.size(); j++){
+            integral += chunks[j].values[i];
+        }
+
+        Float psi = offsetRadii[i] * integral;
+        Float tanhSum = std::tanh(ObcAlpha * psi - ObcBeta * psi * psi + ObcGamma * psi * psi * psi);
+
+        bornRadii[i] = 1.0 / (1.0 / offsetRadii[i] - tanhSum / radii[i]);
+
+        if(radiusDerivatives){
+            (*radiusDerivatives)[i] = bornRadii[i] * bornRadii[i] * (1 - tanhSum * tanhSum) *
+                                      (ObcAlpha - 2 * ObcBeta * psi + 3 * ObcGamma * psi * psi) *
+                                      offsetRadii[i] / radii[i];
+        }
+    }
+}
+
+Float GeneralizedBornPrivate::calculateEnergy(const std::vector<Point3> &positions,
+                                              const std::vector<Float> &charges,
+                                              std::vector<Vector3> *gradient,
+                                              int threadCount)
+{
+    const int count = positions.size();
+
+    polarEnergy = 0;
+    nonpolarEnergy = 0;
+
+    if(gradient){
+        gradient->assign(count, Vector3());
+    }
+
+    if(count == 0 || int(radii.size()) != count || int(screeningFactors.size()) != count){
+        return 0;
+    }
+
+    std::vector<GeneralizedBornChunk> chunks = this->chunks(positions, threadCount);
+
+    std::vector<Float> bornRadii;
+    std::vector<Float> radiusDerivatives;
+    calculateBornRadii(chunks, bornRadii, gradient ? &radiusDerivatives : 0);
+
+    // polar energy
+    Float prefactor = -CoulombConstant * (1.0 / soluteDielectric - 1.0 / solventDielectric);
+
+    for(unsigned int i = 0; i < chunks.size(); i++){
+        chunks[i].charges = &charges;
+        chunks[i].bornRadii = &bornRadii;
+        chunks[i].prefactor = prefactor;
+        chunks[i].calculateGradient = gradient != 0;
+    }
+
+    QtConcurrent::blockingMap(chunks, calculateChunkPolarEnergy);
+
+    std::vector<Float> de_dradius(count);
+    for(unsigned int j = 0; j < chunks.size(); j++){
+        polarEnergy += chunks[j].energy;
+
+        for(int i = 0; i < count; i++){
+            de_dradius[i] += chunks[j].values[i];
+        }
+
+        if(gradient){
+            for(int i = 0; i < count; i++){
+                (*gradient)[i] += chunks[j].gradient[i];
+            }
+        }
+    }
+
+    // nonpolar energy (ace approximation of the surface area)
+    Float surfaceFactor = 4 * constants::Pi * surfaceTension;
+
+    for(int i = 0; i < count; i++){
+        Float radius = radii[i] + probeRadius;
+        Float energy = surfaceFactor * radius * radius * std::pow(radii[i] / bornRadii[i], 6);
+
+        nonpolarEnergy += energy;
+        de_dradius[i] -= 6 * energy / bornRadii[i];
+    }
+
+    // gradient due to the born radii
+    if(gradient){
+        std::vector<Float> radiusChain(count);
+        for(int i = 0; i < count; i++){
+            radiusChain[i] = de_dradius[i] * radiusDerivatives[i];
+        }
+
+        for(unsigned int i = 0; i < chunks.size(); i++){
+            chunks[i].radiusChain = &radiusChain;
+        }
+
+        QtConcurrent::blockingMap(chunks, calculateChunkRadiusGradient);
+
+        for(unsigned int j = 0; j < chunks.size(); j++){
+            for(int i = 0; i < count; i++){
+                (*gradient)[i] += chunks[j].gradient[i];
+            }
+        }
+    }
+
+    return polarEnergy + nonpolarEnergy;
+}
+
+// === GeneralizedBorn ===================================================== //
+/// \class GeneralizedBorn generalizedborn.h chemkit/generalizedborn.h
+/// \ingroup chemkit
+/// \brief The GeneralizedBorn class calculates the solvation energy
+///        of a molecule with an implicit solvent model.
+///
+/// The GeneralizedBorn class implements the generalized Born model
+/// of Still et al. [1990] with the effective Born radii of Onufriev,
+/// Bashford and Case [2004] (the OBC II parameters). The solvent is
+/// treated as a continuum with a high dielectric constant and the
+/// solvation energy is the sum of a polar and a nonpolar term:
+/// \f[ E = E_{polar} + E_{nonpolar} \f]
+///
+/// The polar energy is given by:
+/// \f[ E_{polar} = -\frac{k}{2} \left(\frac{1}{\epsilon_{in}} - \frac{1}{\epsilon_{out}}\right) \sum_{i,j} \frac{q_{i} q_{j}}{f_{GB}(r_{ij})} \f]
+/// \f[ f_{GB}(r_{ij}) = \sqrt{r_{ij}^{2} + B_{i} B_{j} e^{-r_{ij}^{2} / 4 B_{i} B_{j}}} \f]
+///
+/// The nonpolar energy uses the ACE approximation of the solvent
+/// accessible surface area of each atom from its Born radius:
+/// \f[ E_{nonpolar} = 4 \pi \gamma \sum_{i} (R_{i} + r_{probe})^{2} \left(\frac{R_{i}}{B_{i}}\right)^{6} \f]
+///
+/// If a cutoff is set the descreening integrals and pair energies
+/// are only calculated for atoms closer than the cutoff which are
+/// found with a NeighborList. The polar self and pair energies are
+/// then shifted by \f$1/r_{c}\f$ which cancels the truncation error
+/// for neutral groups of atoms within the cutoff. Otherwise every
+/// pair is used. In both cases the pairs are divided between
+/// multiple threads. Energies are in kcal/mol.
+///
+/// \see NeighborList, MolecularSurface
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new generalized Born object.
+GeneralizedBorn::GeneralizedBorn()
+    : d(new GeneralizedBornPrivate)
+{
+    d->soluteDielectric = 1.0;
+    d->solventDielectric = 78.5;
+    d->surfaceTension = 0.0054;
+    d->probeRadius = 1.4;
+    d->cutoff = 0;
+    d->threadCount = 0;
+    d->polarEnergy = 0;
+    d->nonpolarEnergy = 0;
+}
+
+/// Destroys the generalized Born object.
+GeneralizedBorn::~GeneralizedBorn()
+{
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Sets the intrinsic radius of each atom to \p radii.
+///
+/// \see intrinsicRadius()
+void GeneralizedBorn::setRadii(const std::vector<Float> &radii)
+{
+    d->radii = radii;
+}
+
+/// Returns the intrinsic radius of each atom.
+std::vector<Float> GeneralizedBorn::radii() const
+{
+    return d->radii;
+}
+
+/// Sets the screening factor of each atom to \p factors. The
+/// screening factors scale the radii of the atoms when calculating
+/// their contribution to the Born radii of other atoms.
+///
+/// \see screeningFactor()
+void GeneralizedBorn::setScreeningFactors(const std::vector<Float> &factors)
+{
+    d->screeningFactors = factors;
+}
+
+/// Returns the screening factor of each atom.
+std::vector<Float> GeneralizedBorn::screeningFactors() const
+{
+    return d->screeningFactors;
+}
+
+/// Sets the dielectric constant of the solute to \p dielectric. The
+/// default is \c 1.0.
+void GeneralizedBorn::setSoluteDielectric(Float dielectric)
+{
+    d->soluteDielectric = dielectric;
+}
+
+/// Returns the dielectric constant of the solute.
+Float GeneralizedBorn::soluteDielectric() const
+{
+    return d->soluteDielectric;
+}
+
+/// Sets the dielectric constant of the solvent to \p dielectric. The
+/// default is \c 78.5 (water).
+void GeneralizedBorn::setSolventDielectric(Float dielectric)
+{
+    d->solventDielectric = dielectric;
+}
+
+/// Returns the dielectric constant of the solvent.
+Float GeneralizedBorn::solventDielectric() const
+{
+    return d->solventDielectric;
+}
+
+/// Sets the surface tension used for the nonpolar energy to
+/// \p tension. The default is \c 0.0054 kcal/mol/angstrom^2. A
+/// tension of \c 0 disables the nonpolar energy.
+void GeneralizedBorn::setSurfaceTension(Float tension)
+{
+    d->surfaceTension = tension;
+}
+
+/// Returns the surface tension used for the nonpolar energy.
+Float GeneralizedBorn::surfaceTension() const
+{
+    return d->surfaceTension;
+}
+
+/// Sets the radius of the solvent probe to \p radius. The default
+/// is \c 1.4 angstroms.
+void GeneralizedBorn::setProbeRadius(Float radius)
+{
+    d->probeRadius = radius;
+}
+
+/// Returns the radius of the solvent probe.
+Float GeneralizedBorn::probeRadius() const
+{
+    return d->probeRadius;
+}
+
+/// Sets the cutoff distance to \p cutoff. If \p cutoff is \c 0 (the
+/// default) every pair of atoms is used.
+void GeneralizedBorn::setCutoff(Float cutoff)
+{
+    d->cutoff = qMax(Float(0), cutoff);
+}
+
+/// Returns the cutoff distance.
+Float GeneralizedBorn::cutoff() const
+{
+    return d->cutoff;
+}
+
+/// Sets the number of threads used to calculate the energy to
+/// \p count. If \p count is \c 0 (the default) the ideal thread
+/// count for the system is used.
+void GeneralizedBorn::setThreadCount(int count)
+{
+    d->threadCount = qMax(0, count);
+}
+
+/// Returns the number of threads used to calculate the energy.
+/// Returns \c 0 if the ideal thread count is used.
+int GeneralizedBorn::threadCount() const
+{
+    return d->threadCount;
+}
+
+/// Returns the number of threads that will be used to calculate the
+/// energy.
+int GeneralizedBorn::effectiveThreadCount() const
+{
+    if(d->threadCount == 0){
+        return qMax(1, QThread::idealThreadCount());
+    }
+
+    return d->threadCount;
+}
+
+// --- Energy -------------------------------------------------------------- //
+/// Returns the solvation energy of the \p charges located at
+/// \p positions. The radii and screening factors must be set for
+/// each of the positions.
+Float GeneralizedBorn::energy(const std::vector<Point3> &positions, const std::vector<Float> &charges)
+{
+    return d->calculateEnergy(positions, charges, 0, effectiveThreadCount());
+}
+
+/// Returns the solvation energy of the \p charges located at
+/// \p positions and sets \p gradient to its gradient with respect
+/// to each of the positions.
+Float GeneralizedBorn::energy(const std::vector<Point3> &positions, const std::vector<Float> &charges, std::vector<Vector3> &gradient)
+{
+    return d->calculateEnergy(positions, charges, &gradient, effectiveThreadCount());
+}
+
+/// Returns the polar energy from the last energy calculation.
+Float GeneralizedBorn::polarEnergy() const
+{
+    return d->polarEnergy;
+}
+
+/// Returns the nonpolar energy from the last energy calculation.
+Float GeneralizedBorn::nonpolarEnergy() const
+{
+    return d->nonpolarEnergy;
+}
+
+/// Returns the effective Born radius of each atom at \p positions.
+std::vector<Float> GeneralizedBorn::bornRadii(const std::vector<Point3> &positions)
+{
+    std::vector<Float> bornRadii;
+
+    if(positions.empty() || d->radii.size() != positions.size() || d->screeningFactors.size() != positions.size()){
+        return bornRadii;
+    }
+
+    std::vector<GeneralizedBornChunk> chunks = d->chunks(positions, effectiveThreadCount());
+    d->calculateBornRadii(chunks, bornRadii, 0);
+
+    return bornRadii;
+}
+
+// --- Static Methods ------------------------------------------------------ //
+/// Returns the intrinsic radius of \p atom. These are the modified
+/// Bondi radii (mbondi2) of Onufriev, Bashford and Case [2004].
+Float GeneralizedBorn::intrinsicRadius(const Atom *atom)
+{
+    switch(atom->atomicNumber()){
+        case 1:
+            foreach(const Atom *neighbor, atom->neighbors()){
+                if(neighbor->atomicNumber() == 7){
+                    return 1.3;
+                }
+            }
+            return 1.2;
+        case 6: return 1.7;
+        case 7: return 1.55;
+        case 8: return 1.5;
+        case 9: return 1.5;
+        case 14: return 2.1;
+        case 15: return 1.85;
+        case 16: return 1.8;
+        case 17: return 1.7;
+        case 35: return 1.85;
+        case 53: return 1.98;
+        default: return 1.5;
+    }
+}
+
+/// Returns the screening factor of \p atom. These are the factors
+/// of Hawkins, Cramer and Truhlar [1996].
+Float GeneralizedBorn::screeningFactor(const Atom *atom)
+{
+    switch(atom->atomicNumber()){
+        case 1: return 0.85;
+        case 6: return 0.72;
+        case 7: return 0.79;
+        case 8: return 0.85;
+        case 9: return 0.88;
+        case 15: return 0.86;
+        case 16: return 0.96;
+        default: return 0.8;
+    }
+}
+
+} // end chemkit namespace
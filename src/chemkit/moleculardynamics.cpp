@@ -0,0 +1,1134 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "moleculardynamics.h"
+
+#include <cmath>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/gamma_distribution.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+
+#include "atom.h"
+#include "bond.h"
+#include "foreach.h"
+#include "fragment.h"
+#include "molecule.h"
+#include "unitcell.h"
+#include "constants.h"
+#include "forcefield.h"
+#include "trajectory.h"
+#include "coordinates.h"
+#include "forcefieldatom.h"
+#include "trajectoryfile.h"
+#include "trajectoryframe.h"
+
+namespace chemkit {
+
+namespace {
+
+// Boltzmann constant in kcal/(mol K).
+const Float BoltzmannConstant = constants::GasConstant * constants::JoulesToCalories / 1000.0;
+
+// Conversion factor from kcal/(mol A amu) to A/fs^2.
+const Float AccelerationConversion = constants::CaloriesToJoules * 1.0e-4;
+
+// Maximum number of SHAKE/RATTLE iterations.
+const int MaximumConstraintIterations = 500;
+
+// A fixed distance between two atoms.
+struct DistanceConstraint
+{
+    int i;
+    int j;
+    Float distanceSquared;
+};
+
+} // end anonymous namespace
+
+// === MolecularDynamicsPrivate ============================================ //
+class MolecularDynamicsPrivate
+{
+    public:
+        MolecularDynamicsPrivate();
+
+        void initialize();
+        bool positionsChanged() const;
+        bool frozenAtomsChanged() const;
+        Vector3 bondVector(const Point3 &a, const Point3 &b) const;
+        void calculateAccelerations();
+        bool applyPositionConstraints(const std::vector<Point3> &reference, std::vector<Point3> &positions);
+        bool applyVelocityConstraints();
+        void applyFriction(Float time);
+        void applyThermostat();
+        void removeCenterOfMassMotion();
+        bool writeFrame();
+        Float calculateKineticEnergy() const;
+        Float calculateTemperature() const;
+        int calculateDegreesOfFreedom() const;
+
+        ForceField *forceField;
+        MolecularDynamics::Integrator integrator;
+        MolecularDynamics::Thermostat thermostat;
+        MolecularDynamics::Constraints constraints;
+        Float timeStep;
+        Float temperature;
+        Float couplingTime;
+        Float friction;
+        Float constraintTolerance;
+        const UnitCell *unitCell;
+        unsigned int randomSeed;
+        Trajectory *trajectory;
+        TrajectoryFile *trajectoryFile;
+        int frameInterval;
+        int stepCount;
+        QAtomicInt canceled;
+        bool initialized;
+        std::string errorString;
+
+        // simulation state
+        std::vector<ForceFieldAtom *> atoms;
+        std::vector<Float> masses;
+        std::vector<Float> inverseMasses;
+        std::vector<bool> frozen;
+        int frozenAtomCount;
+        std::vector<Point3> positions;
+        std::vector<Vector3> velocities;
+        std::vector<Vector3> accelerations;
+        std::vector<DistanceConstraint> distanceConstraints;
+        std::vector<std::vector<int> > fragments;
+
+        // random number generation
+        boost::mt19937 generator;
+        boost::variate_generator<boost::mt19937&, boost::normal_distribution<Float> > normal;
+
+        // frame used for streaming output
+        Trajectory frameBuffer;
+};
+
+MolecularDynamicsPrivate::MolecularDynamicsPrivate()
+    : normal(generator, boost::normal_distribution<Float>())
+{
+}
+
+// Reads the atoms, masses and constraints from the force field. The
+// current velocities are kept if the number of atoms is unchanged.
+// Frozen atoms are given an infinite mass (a zero inverse mass) and
+// a zero velocity so that they are neither moved by the integrator
+// nor by the constraints.
+void MolecularDynamicsPrivate::initialize()
+{
+    atoms = forceField->atoms();
+
+    int atomCount = atoms.size();
+
+    masses.resize(atomCount);
+    inverseMasses.resize(atomCount);
+    frozen.resize(atomCount);
+    positions.resize(atomCount);
+
+    if(int(velocities.size()) != atomCount){
+        velocities.assign(atomCount, Vector3(0, 0, 0));
+    }
+
+    frozenAtomCount = 0;
+
+    QHash<const Atom *, int> atomIndices;
+    for(int i = 0; i < atomCount; i++){
+        const Atom *atom = atoms[i]->atom();
+
+        masses[i] = atom->mass();
+        frozen[i] = atoms[i]->isFrozen();
+        inverseMasses[i] = masses[i] > 0 && !frozen[i] ? 1.0 / masses[i] : 0;
+        positions[i] = atoms[i]->position();
+        atomIndices[atom] = i;
+
+        if(frozen[i]){
+            velocities[i] = Vector3(0, 0, 0);
+            frozenAtomCount++;
+        }
+    }
+
+    // bonds to hydrogen are constrained to their initial length
+    distanceConstraints.clear();
+    fragments.clear();
+
+    foreach(const Molecule *molecule, forceField->molecules()){
+        if(constraints == MolecularDynamics::HydrogenBonds){
+            foreach(const Bond *bond, molecule->bonds()){
+                if(!bond->contains(Atom::Hydrogen)){
+                    continue;
+                }
+
+                QHash<const Atom *, int>::const_iterator a = atomIndices.find(bond->atom1());
+                QHash<const Atom *, int>::const_iterator b = atomIndices.find(bond->atom2());
+                if(a == atomIndices.end() || b == atomIndices.end()){
+                    continue;
+                }
+
+                // the distance between two frozen atoms is fixed
+                if(frozen[a.value()] && frozen[b.value()]){
+                    continue;
+                }
+
+                DistanceConstraint constraint;
+                constraint.i = a.value();
+                constraint.j = b.value();
+                constraint.distanceSquared = bondVector(positions[constraint.i],
+                                                        positions[constraint.j]).lengthSquared();
+                distanceConstraints.push_back(constraint);
+            }
+        }
+
+        // fragments are wrapped into the unit cell as a whole
+        foreach(const Fragment *fragment, molecule->fragments()){
+            std::vector<int> indices;
+
+            foreach(const Atom *atom, fragment->atoms()){
+                QHash<const Atom *, int>::const_iterator location = atomIndices.find(atom);
+                if(location != atomIndices.end()){
+                    indices.push_back(location.value());
+                }
+            }
+
+            if(!indices.empty()){
+                fragments.push_back(indices);
+            }
+        }
+    }
+
+    calculateAccelerations();
+
+    initialized = true;
+}
+
+// Returns true if the atom positions in the force field were changed
+// since the last step.
+bool MolecularDynamicsPrivate::positionsChanged() const
+{
+    for(unsigned int i = 0; i < atoms.size(); i++){
+        if(!(atoms[i]->position() == positions[i])){
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Returns true if any atom was frozen or unfrozen since the atoms
+// were last read from the force field.
+bool MolecularDynamicsPrivate::frozenAtomsChanged() const
+{
+    for(unsigned int i = 0; i < atoms.size(); i++){
+        if(atoms[i]->isFrozen() != frozen[i]){
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Returns the vector from b to a. If a unit cell is set the vector
+// to the closest periodic image of a is returned.
+Vector3 MolecularDynamicsPrivate::bondVector(const Point3 &a, const Point3 &b) const
+{
+    if(unitCell){
+        return unitCell->minimumImage(a - b);
+    }
+
+    return a - b;
+}
+
+void MolecularDynamicsPrivate::calculateAccelerations()
+{
+    std::vector<Vector3> gradient = forceField->gradient();
+
+    accelerations.resize(gradient.size());
+    for(unsigned int i = 0; i < gradient.size(); i++){
+        accelerations[i] = gradient[i] * (-AccelerationConversion * inverseMasses[i]);
+    }
+}
+
+// SHAKE: moves the unconstrained positions so that each constrained
+// distance is restored. Corrections are made along the bond vectors
+// of the reference positions and applied to the velocities as well.
+bool MolecularDynamicsPrivate::applyPositionConstraints(const std::vector<Point3> &reference, std::vector<Point3> &positions)
+{
+    if(distanceConstraints.empty()){
+        return true;
+    }
+
+    for(int iteration = 0; iteration < MaximumConstraintIterations; iteration++){
+        bool converged = true;
+
+        foreach(const DistanceConstraint &constraint, distanceConstraints){
+            int i = constraint.i;
+            int j = constraint.j;
+
+            Vector3 bond = bondVector(positions[i], positions[j]);
+            Float difference = constraint.distanceSquared - bond.lengthSquared();
+            if(std::abs(difference) <= 2 * constraintTolerance * constraint.distanceSquared){
+                continue;
+            }
+
+            converged = false;
+
+            Vector3 referenceBond = bondVector(reference[i], reference[j]);
+            Float denominator = 2 * referenceBond.dot(bond) * (inverseMasses[i] + inverseMasses[j]);
+            if(denominator == 0){
+                return false;
+            }
+
+            Vector3 correction = referenceBond * (difference / denominator);
+
+            positions[i] += correction * inverseMasses[i];
+            positions[j] -= correction * inverseMasses[j];
+            velocities[i] += correction * (inverseMasses[i] / timeStep);
+            velocities[j] -= correction * (inverseMasses[j] / timeStep);
+        }
+
+        if(converged){
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// RATTLE: removes the component of the relative velocity along each
+// constrained bond.
+bool MolecularDynamicsPrivate::applyVelocityConstraints()
+{
+    if(distanceConstraints.empty()){
+        return true;
+    }
+
+    for(int iteration = 0; iteration < MaximumConstraintIterations; iteration++){
+        bool converged = true;
+
+        foreach(const DistanceConstraint &constraint, distanceConstraints){
+            int i = constraint.i;
+            int j = constraint.j;
+
+            Vector3 bond = bondVector(positions[i], positions[j]);
+            Float projection = bond.dot(velocities[i] - velocities[j]);
+            if(std::abs(projection) * timeStep <= constraintTolerance * constraint.distanceSquared){
+                continue;
+            }
+
+            converged = false;
+
+            Float k = projection / (constraint.distanceSquared * (inverseMasses[i] + inverseMasses[j]));
+
+            velocities[i] -= bond * (k * inverseMasses[i]);
+            velocities[j] += bond * (k * inverseMasses[j]);
+        }
+
+        if(converged){
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Applies the Ornstein-Uhlenbeck part of the Langevin integrator for
+// the given time (in femtoseconds).
+void MolecularDynamicsPrivate::applyFriction(Float time)
+{
+    Float a = exp(-friction * 1.0e-3 * time);
+    Float b = sqrt((1 - a * a) * BoltzmannConstant * temperature * AccelerationConversion);
+
+    for(unsigned int i = 0; i < velocities.size(); i++){
+        Float sigma = b * sqrt(inverseMasses[i]);
+
+        velocities[i] = velocities[i] * a + Vector3(normal(), normal(), normal()) * sigma;
+    }
+}
+
+// Rescales the velocities towards the target temperature. The
+// Berendsen thermostat scales the kinetic energy deterministically
+// while velocity rescaling uses the stochastic scheme of Bussi,
+// Donadio and Parrinello which samples the canonical ensemble.
+void MolecularDynamicsPrivate::applyThermostat()
+{
+    Float kineticEnergy = calculateKineticEnergy();
+    if(kineticEnergy <= 0){
+        return;
+    }
+
+    int degreesOfFreedom = calculateDegreesOfFreedom();
+    Float scale = 1;
+
+    if(thermostat == MolecularDynamics::Berendsen){
+        Float currentTemperature = 2 * kineticEnergy / (degreesOfFreedom * BoltzmannConstant);
+
+        scale = sqrt(1 + (timeStep / couplingTime) * (temperature / currentTemperature - 1));
+        scale = qBound(Float(0.8), scale, Float(1.25));
+    }
+    else if(thermostat == MolecularDynamics::VelocityRescaling){
+        Float targetKineticEnergy = 0.5 * degreesOfFreedom * BoltzmannConstant * temperature;
+        Float c = exp(-timeStep / couplingTime);
+
+        Float r1 = normal();
+        Float sumOfSquares = 0;
+        if(degreesOfFreedom > 1){
+            // sum of the squares of (degreesOfFreedom - 1) gaussian
+            // random numbers, drawn from the chi-squared distribution
+            boost::variate_generator<boost::mt19937&, boost::gamma_distribution<Float> >
+                gamma(generator, boost::gamma_distribution<Float>(0.5 * (degreesOfFreedom - 1)));
+            sumOfSquares = 2 * gamma();
+        }
+
+        Float newKineticEnergy = kineticEnergy +
+            (1 - c) * (targetKineticEnergy * (r1 * r1 + sumOfSquares) / degreesOfFreedom - kineticEnergy) +
+            2 * r1 * sqrt(c * (1 - c) * targetKineticEnergy * kineticEnergy / degreesOfFreedom);
+
+        scale = sqrt(qMax(Float(0), newKineticEnergy) / kineticEnergy);
+    }
+
+    for(unsigned int i = 0; i < velocities.size(); i++){
+        velocities[i] *= scale;
+    }
+}
+
+// Removes the velocity of the center of mass. The momentum of the
+// mobile atoms is not conserved when other atoms are frozen and so
+// it is left unchanged.
+void MolecularDynamicsPrivate::removeCenterOfMassMotion()
+{
+    if(frozenAtomCount != 0){
+        return;
+    }
+
+    Vector3 momentum(0, 0, 0);
+    Float totalMass = 0;
+
+    for(unsigned int i = 0; i < velocities.size(); i++){
+        momentum += velocities[i] * masses[i];
+        totalMass += masses[i];
+    }
+
+    if(totalMass <= 0){
+        return;
+    }
+
+    Vector3 velocity = momentum / totalMass;
+    for(unsigned int i = 0; i < velocities.size(); i++){
+        velocities[i] -= velocity;
+    }
+}
+
+// Writes the current positions to the trajectory and the trajectory
+// file. If a unit cell is set each fragment is made whole and then
+// wrapped into the cell.
+bool MolecularDynamicsPrivate::writeFrame()
+{
+    if(!trajectory && !trajectoryFile){
+        return true;
+    }
+
+    Coordinates coordinates(atoms.size());
+
+    if(unitCell){
+        foreach(const std::vector<int> &fragment, fragments){
+            // place each atom at the image closest to the first atom
+            const Point3 &origin = positions[fragment[0]];
+
+            Vector3 center(0, 0, 0);
+            foreach(int index, fragment){
+                Point3 position = unitCell->image(positions[index], origin);
+                coordinates.setPosition(index, position);
+                center += position;
+            }
+            center /= fragment.size();
+
+            Vector3 shift = unitCell->wrap(center) - center;
+            foreach(int index, fragment){
+                coordinates.setPosition(index, coordinates.position(index) + shift);
+            }
+        }
+    }
+    else{
+        for(unsigned int i = 0; i < positions.size(); i++){
+            coordinates.setPosition(i, positions[i]);
+        }
+    }
+
+    Float time = stepCount * timeStep * 1.0e-3;
+
+    if(trajectory){
+        TrajectoryFrame *frame = trajectory->addFrame();
+        frame->setCoordinates(&coordinates);
+        frame->setStep(stepCount);
+        frame->setTime(time);
+        if(unitCell){
+            frame->setUnitCell(new UnitCell(unitCell->x(), unitCell->y(), unitCell->z()));
+        }
+    }
+
+    if(trajectoryFile){
+        // the same frame is reused so only one frame is ever kept
+        // in memory while streaming
+        TrajectoryFrame *frame = frameBuffer.isEmpty() ? frameBuffer.addFrame() : frameBuffer.frame(0);
+        frame->setCoordinates(&coordinates);
+        frame->setStep(stepCount);
+        frame->setTime(time);
+        if(unitCell && !frame->unitCell()){
+            frame->setUnitCell(new UnitCell(unitCell->x(), unitCell->y(), unitCell->z()));
+        }
+        else if(!unitCell){
+            frame->setUnitCell(0);
+        }
+
+        if(!trajectoryFile->writeFrame(frame)){
+            errorString = trajectoryFile->errorString();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+Float MolecularDynamicsPrivate::calculateKineticEnergy() const
+{
+    Float energy = 0;
+
+    for(unsigned int i = 0; i < velocities.size(); i++){
+        energy += masses[i] * velocities[i].lengthSquared();
+    }
+
+    return 0.5 * energy / AccelerationConversion;
+}
+
+Float MolecularDynamicsPrivate::calculateTemperature() const
+{
+    return 2 * calculateKineticEnergy() / (calculateDegreesOfFreedom() * BoltzmannConstant);
+}
+
+int MolecularDynamicsPrivate::calculateDegreesOfFreedom() const
+{
+    int mobileAtomCount = atoms.size() - frozenAtomCount;
+    int count = 3 * mobileAtomCount - distanceConstraints.size();
+
+    // center of mass motion
+    if(frozenAtomCount == 0 && mobileAtomCount > 1){
+        count -= 3;
+    }
+
+    return qMax(1, count);
+}
+
+// === MolecularDynamics =================================================== //
+/// \class MolecularDynamics moleculardynamics.h chemkit/moleculardynamics.h
+/// \ingroup chemkit
+/// \brief The MolecularDynamics class propagates the atoms in a
+///        force field through time.
+///
+/// The equations of motion are integrated with the velocity Verlet
+/// algorithm using the gradient from the force field. The following
+/// integrators are supported:
+///     - \c VelocityVerlet: constant energy dynamics, optionally
+///       coupled to a thermostat
+///     - \c Langevin: stochastic dynamics at constant temperature
+///
+/// With the \c VelocityVerlet integrator the temperature can be
+/// controlled with either the \c Berendsen weak coupling thermostat
+/// or the stochastic \c VelocityRescaling thermostat.
+///
+/// Bonds to hydrogen atoms can be held at a fixed length with the
+/// SHAKE and RATTLE algorithms which allows for larger time steps.
+///
+/// Frozen atoms (see ForceFieldAtom::setFrozen()) are held at rest
+/// and do not count towards the degrees of freedom.
+///
+/// Frames are written every frameInterval() steps to a Trajectory
+/// and/or streamed to a TrajectoryFile opened with
+/// TrajectoryFile::beginWriting(). For example, to run 10 ps of
+/// Langevin dynamics at 300 K writing a frame every 100 steps:
+/// \code
+/// MolecularDynamics md(forceField, MolecularDynamics::Langevin);
+/// md.setTemperature(300);
+/// md.initializeVelocities();
+///
+/// TrajectoryFile file("output.xtc");
+/// file.beginWriting();
+/// md.setTrajectoryFile(&file);
+/// md.setFrameInterval(100);
+///
+/// md.run(10000);
+/// file.endWriting();
+/// \endcode
+///
+/// Units are angstroms for distances, femtoseconds for the time step,
+/// kelvin for temperatures, and kcal/mol for energies.
+///
+/// \see ForceField, ForceFieldMinimizer
+
+/// \enum MolecularDynamics::Integrator
+/// Integration algorithms:
+///     - \c VelocityVerlet
+///     - \c Langevin
+
+/// \enum MolecularDynamics::Thermostat
+/// Thermostats for the \c VelocityVerlet integrator:
+///     - \c NoThermostat
+///     - \c Berendsen
+///     - \c VelocityRescaling
+
+/// \enum MolecularDynamics::Constraints
+/// Bond constraints:
+///     - \c NoConstraints
+///     - \c HydrogenBonds
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new molecular dynamics simulation for \p forceField
+/// using \p integrator.
+MolecularDynamics::MolecularDynamics(ForceField *forceField, Integrator integrator)
+    : d(new MolecularDynamicsPrivate)
+{
+    d->forceField = forceField;
+    d->integrator = integrator;
+    d->thermostat = NoThermostat;
+    d->constraints = NoConstraints;
+    d->timeStep = 1.0;
+    d->temperature = 300;
+    d->couplingTime = 100;
+    d->friction = 1.0;
+    d->constraintTolerance = 1e-6;
+    d->unitCell = 0;
+    d->randomSeed = 5489;
+    d->trajectory = 0;
+    d->trajectoryFile = 0;
+    d->frameInterval = 100;
+    d->stepCount = 0;
+    d->canceled = 0;
+    d->initialized = false;
+    d->frozenAtomCount = 0;
+    d->generator.seed(d->randomSeed);
+}
+
+/// Destroys the molecular dynamics object.
+MolecularDynamics::~MolecularDynamics()
+{
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Sets the force field to \p forceField. This resets the simulation.
+void MolecularDynamics::setForceField(ForceField *forceField)
+{
+    d->forceField = forceField;
+    if(forceField && d->unitCell){
+        forceField->setUnitCell(d->unitCell);
+    }
+
+    d->velocities.clear();
+    reset();
+}
+
+/// Returns the force field.
+ForceField* MolecularDynamics::forceField() const
+{
+    return d->forceField;
+}
+
+/// Sets the integrator to \p integrator.
+void MolecularDynamics::setIntegrator(Integrator integrator)
+{
+    d->integrator = integrator;
+}
+
+/// Returns the integrator.
+MolecularDynamics::Integrator MolecularDynamics::integrator() const
+{
+    return d->integrator;
+}
+
+/// Sets the time step to \p timeStep femtoseconds. The default is
+/// \c 1 fs.
+void MolecularDynamics::setTimeStep(Float timeStep)
+{
+    d->timeStep = timeStep;
+}
+
+/// Returns the time step in femtoseconds.
+Float MolecularDynamics::timeStep() const
+{
+    return d->timeStep;
+}
+
+/// Sets the target temperature to \p temperature kelvin. The
+/// default is \c 300 K.
+void MolecularDynamics::setTemperature(Float temperature)
+{
+    d->temperature = temperature;
+}
+
+/// Returns the target temperature in kelvin.
+Float MolecularDynamics::temperature() const
+{
+    return d->temperature;
+}
+
+/// Sets the thermostat to \p thermostat. The thermostat is only
+/// used with the \c VelocityVerlet integrator.
+void MolecularDynamics::setThermostat(Thermostat thermostat)
+{
+    d->thermostat = thermostat;
+}
+
+/// Returns the thermostat.
+MolecularDynamics::Thermostat MolecularDynamics::thermostat() const
+{
+    return d->thermostat;
+}
+
+/// Sets the thermostat coupling time to \p time femtoseconds. The
+/// default is \c 100 fs.
+void MolecularDynamics::setCouplingTime(Float time)
+{
+    d->couplingTime = time;
+}
+
+/// Returns the thermostat coupling time in femtoseconds.
+Float MolecularDynamics::couplingTime() const
+{
+    return d->couplingTime;
+}
+
+/// Sets the friction coefficient for the \c Langevin integrator to
+/// \p friction inverse picoseconds. The default is \c 1 ps^-1.
+void MolecularDynamics::setFriction(Float friction)
+{
+    d->friction = friction;
+}
+
+/// Returns the friction coefficient in inverse picoseconds.
+Float MolecularDynamics::friction() const
+{
+    return d->friction;
+}
+
+/// Sets the bond constraints to \p constraints. Constrained bonds
+/// are held at the length they have when the simulation starts.
+void MolecularDynamics::setConstraints(Constraints constraints)
+{
+    d->constraints = constraints;
+    d->initialized = false;
+}
+
+/// Returns the bond constraints.
+MolecularDynamics::Constraints MolecularDynamics::constraints() const
+{
+    return d->constraints;
+}
+
+/// Sets the relative tolerance for the bond constraints to
+/// \p tolerance. The default is \c 1e-6.
+void MolecularDynamics::setConstraintTolerance(Float tolerance)
+{
+    d->constraintTolerance = tolerance;
+}
+
+/// Returns the relative tolerance for the bond constraints.
+Float MolecularDynamics::constraintTolerance() const
+{
+    return d->constraintTolerance;
+}
+
+/// Returns the number of constrained bonds.
+int MolecularDynamics::constraintCount() const
+{
+    if(!d->initialized && d->forceField){
+        d->initialize();
+    }
+
+    return d->distanceConstraints.size();
+}
+
+/// Sets the periodic unit cell to \p cell. The cell is also set on
+/// the force field so that forces are calculated with periodic
+/// boundary conditions (see ForceField::setUnitCell()). Written
+/// frames are wrapped into the cell and store a copy of it. The
+/// cell is not owned by the simulation.
+void MolecularDynamics::setUnitCell(const UnitCell *cell)
+{
+    d->unitCell = cell;
+
+    if(d->forceField){
+        d->forceField->setUnitCell(cell);
+    }
+}
+
+/// Returns the periodic unit cell.
+const UnitCell* MolecularDynamics::unitCell() const
+{
+    return d->unitCell;
+}
+
+/// Sets the seed for the random number generator to \p seed. Runs
+/// with the same seed and starting state are reproducible.
+void MolecularDynamics::setRandomSeed(unsigned int seed)
+{
+    d->randomSeed = seed;
+    d->generator.seed(seed);
+    d->normal.distribution().reset();
+}
+
+/// Returns the seed for the random number generator.
+unsigned int MolecularDynamics::randomSeed() const
+{
+    return d->randomSeed;
+}
+
+// --- Velocities ---------------------------------------------------------- //
+/// Assigns random velocities from the Maxwell-Boltzmann distribution
+/// at the target temperature.
+void MolecularDynamics::initializeVelocities()
+{
+    initializeVelocities(d->temperature);
+}
+
+/// Assigns random velocities from the Maxwell-Boltzmann distribution
+/// at \p temperature. The center of mass motion is removed and the
+/// velocities are scaled to exactly match \p temperature.
+void MolecularDynamics::initializeVelocities(Float temperature)
+{
+    if(!d->forceField){
+        return;
+    }
+
+    if(!d->initialized){
+        d->initialize();
+    }
+
+    // frozen atoms have a zero inverse mass and so stay at rest
+    for(unsigned int i = 0; i < d->velocities.size(); i++){
+        Float sigma = sqrt(BoltzmannConstant * temperature * AccelerationConversion * d->inverseMasses[i]);
+
+        d->velocities[i] = Vector3(d->normal(), d->normal(), d->normal()) * sigma;
+    }
+
+    d->removeCenterOfMassMotion();
+    d->applyVelocityConstraints();
+
+    Float currentTemperature = d->calculateTemperature();
+    if(currentTemperature > 0){
+        Float scale = sqrt(temperature / currentTemperature);
+
+        for(unsigned int i = 0; i < d->velocities.size(); i++){
+            d->velocities[i] *= scale;
+        }
+    }
+}
+
+/// Sets the velocity of the atom at \p index to \p velocity. The
+/// velocity is in angstroms per femtosecond.
+void MolecularDynamics::setVelocity(int index, const Vector3 &velocity)
+{
+    if(!d->initialized && d->forceField){
+        d->initialize();
+    }
+
+    d->velocities[index] = velocity;
+}
+
+/// Returns the velocity of the atom at \p index in angstroms per
+/// femtosecond.
+Vector3 MolecularDynamics::velocity(int index) const
+{
+    if(index >= int(d->velocities.size())){
+        return Vector3(0, 0, 0);
+    }
+
+    return d->velocities[index];
+}
+
+/// Returns the velocities of each atom.
+std::vector<Vector3> MolecularDynamics::velocities() const
+{
+    return d->velocities;
+}
+
+// --- State --------------------------------------------------------------- //
+/// Returns the number of steps performed.
+int MolecularDynamics::stepCount() const
+{
+    return d->stepCount;
+}
+
+/// Returns the simulated time in picoseconds.
+Float MolecularDynamics::time() const
+{
+    return d->stepCount * d->timeStep * 1.0e-3;
+}
+
+/// Returns the number of degrees of freedom. This is three times
+/// the number of mobile atoms minus the number of constraints and
+/// the center of mass motion (which is only removed when no atoms
+/// are frozen).
+int MolecularDynamics::degreesOfFreedom() const
+{
+    if(!d->initialized && d->forceField){
+        d->initialize();
+    }
+
+    return d->calculateDegreesOfFreedom();
+}
+
+/// Returns the kinetic energy in kcal/mol.
+Float MolecularDynamics::kineticEnergy() const
+{
+    return d->calculateKineticEnergy();
+}
+
+/// Returns the potential energy in kcal/mol.
+Float MolecularDynamics::potentialEnergy() const
+{
+    if(!d->forceField){
+        return 0;
+    }
+
+    return d->forceField->energy();
+}
+
+/// Returns the sum of the kinetic and potential energy in kcal/mol.
+Float MolecularDynamics::totalEnergy() const
+{
+    return kineticEnergy() + potentialEnergy();
+}
+
+/// Returns the instantaneous temperature in kelvin.
+Float MolecularDynamics::instantaneousTemperature() const
+{
+    if(d->velocities.empty()){
+        return 0;
+    }
+
+    return d->calculateTemperature();
+}
+
+// --- Output -------------------------------------------------------------- //
+/// Sets the trajectory to \p trajectory. A new frame is added to
+/// the trajectory every frameInterval() steps.
+void MolecularDynamics::setTrajectory(Trajectory *trajectory)
+{
+    d->trajectory = trajectory;
+}
+
+/// Returns the trajectory.
+Trajectory* MolecularDynamics::trajectory() const
+{
+    return d->trajectory;
+}
+
+/// Sets the trajectory file to \p file. Every frameInterval() steps
+/// a frame is appended to the file. The file must be opened with
+/// TrajectoryFile::beginWriting() before running the simulation.
+/// Frames written to the file are not kept in memory.
+void MolecularDynamics::setTrajectoryFile(TrajectoryFile *file)
+{
+    d->trajectoryFile = file;
+}
+
+/// Returns the trajectory file.
+TrajectoryFile* MolecularDynamics::trajectoryFile() const
+{
+    return d->trajectoryFile;
+}
+
+/// Sets the number of steps between written frames to \p steps. The
+/// default is \c 100.
+void MolecularDynamics::setFrameInterval(int steps)
+{
+    d->frameInterval = steps;
+}
+
+/// Returns the number of steps between written frames.
+int MolecularDynamics::frameInterval() const
+{
+    return d->frameInterval;
+}
+
+// --- Simulation ---------------------------------------------------------- //
+/// Performs one time step. Returns \c false if an error occurs.
+///
+/// If the atom positions in the force field were changed since the
+/// last step the forces are recalculated at the new positions.
+bool MolecularDynamics::step()
+{
+    if(!d->forceField || d->canceled){
+        return false;
+    }
+
+    if(!d->forceField->isSetup()){
+        d->errorString = "Force field is not setup.";
+        return false;
+    }
+
+    if(!d->initialized || int(d->atoms.size()) != d->forceField->atomCount() || d->frozenAtomsChanged()){
+        d->initialize();
+    }
+    else if(d->positionsChanged()){
+        for(unsigned int i = 0; i < d->atoms.size(); i++){
+            d->positions[i] = d->atoms[i]->position();
+        }
+
+        d->calculateAccelerations();
+    }
+
+    Float dt = d->timeStep;
+    bool langevin = d->integrator == Langevin;
+
+    if(langevin){
+        d->applyFriction(0.5 * dt);
+        d->applyVelocityConstraints();
+    }
+
+    // first half kick and drift
+    std::vector<Point3> reference = d->positions;
+    for(unsigned int i = 0; i < d->atoms.size(); i++){
+        if(d->frozen[i]){
+            continue;
+        }
+
+        d->velocities[i] += d->accelerations[i] * (0.5 * dt);
+        d->positions[i] += d->velocities[i] * dt;
+    }
+
+    if(!d->applyPositionConstraints(reference, d->positions)){
+        d->errorString = "Bond constraints failed to converge.";
+        return false;
+    }
+
+    for(unsigned int i = 0; i < d->atoms.size(); i++){
+        if(!d->frozen[i]){
+            d->atoms[i]->setPosition(d->positions[i]);
+        }
+    }
+
+    // second half kick with the new forces
+    d->calculateAccelerations();
+    for(unsigned int i = 0; i < d->atoms.size(); i++){
+        d->velocities[i] += d->accelerations[i] * (0.5 * dt);
+    }
+
+    if(!d->applyVelocityConstraints()){
+        d->errorString = "Bond constraints failed to converge.";
+        return false;
+    }
+
+    if(langevin){
+        d->applyFriction(0.5 * dt);
+        d->applyVelocityConstraints();
+    }
+    else if(d->thermostat != NoThermostat){
+        d->applyThermostat();
+    }
+
+    Float kineticEnergy = d->calculateKineticEnergy();
+    if(qIsNaN(kineticEnergy) || qIsInf(kineticEnergy)){
+        d->errorString = "Simulation became unstable.";
+        return false;
+    }
+
+    d->stepCount++;
+
+    if(d->frameInterval > 0 && d->stepCount % d->frameInterval == 0){
+        if(!d->writeFrame()){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/// Performs \p steps time steps. Returns \c false if an error
+/// occurs or the simulation is canceled.
+bool MolecularDynamics::run(int steps)
+{
+    for(int i = 0; i < steps; i++){
+        if(d->canceled || !step()){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/// Performs \p steps time steps asynchronously.
+///
+/// \see run()
+QFuture<bool> MolecularDynamics::runAsync(int steps)
+{
+    d->canceled = 0;
+
+    return QtConcurrent::run(this, &MolecularDynamics::run, steps);
+}
+
+/// Cancels a running simulation. The simulation remains canceled
+/// until reset() is called or a new asynchronous run is started.
+void MolecularDynamics::cancel()
+{
+    d->canceled = 1;
+}
+
+/// Returns \c true if the simulation was canceled.
+bool MolecularDynamics::isCanceled() const
+{
+    return d->canceled;
+}
+
+/// Resets the step counter. The velocities are kept and the next
+/// step starts from the current atom positions.
+void MolecularDynamics::reset()
+{
+    d->stepCount = 0;
+    d->canceled = 0;
+    d->initialized = false;
+    d->errorString.clear();
+}
+
+// --- Error Handling ------------------------------------------------------ //
+/// Returns a string describing the last error that occurred.
+std::string MolecularDynamics::errorString() const
+{
+    return d->errorString;
+}
+
+} // end chemkit namespace
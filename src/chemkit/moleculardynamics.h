@@ -0,0 +1,147 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#ifndef CHEMKIT_MOLECULARDYNAMICS_H
+#define CHEMKIT_MOLECULARDYNAMICS_H
+
+#include "chemkit.h"
+
+#include <QtCore>
+
+#include <string>
+#include <vector>
+
+#include "vector3.h"
+
+namespace chemkit {
+
+class UnitCell;
+class ForceField;
+class Trajectory;
+class TrajectoryFile;
+class MolecularDynamicsPrivate;
+
+class CHEMKIT_EXPORT MolecularDynamics
+{
+    public:
+        // enumerations
+        enum Integrator {
+            VelocityVerlet,
+            Langevin
+        };
+
+        enum Thermostat {
+            NoThermostat,
+            Berendsen,
+            VelocityRescaling
+        };
+
+        enum Constraints {
+            NoConstraints,
+            HydrogenBonds
+        };
+
+        // construction and destruction
+        MolecularDynamics(ForceField *forceField = 0, Integrator integrator = VelocityVerlet);
+        ~MolecularDynamics();
+
+        // properties
+        void setForceField(ForceField *forceField);
+        ForceField* forceField() const;
+        void setIntegrator(Integrator integrator);
+        Integrator integrator() const;
+        void setTimeStep(Float timeStep);
+        Float timeStep() const;
+        void setTemperature(Float temperature);
+        Float temperature() const;
+        void setThermostat(Thermostat thermostat);
+        Thermostat thermostat() const;
+        void setCouplingTime(Float time);
+        Float couplingTime() const;
+        void setFriction(Float friction);
+        Float friction() const;
+        void setConstraints(Constraints constraints);
+        Constraints constraints() const;
+        void setConstraintTolerance(Float tolerance);
+        Float constraintTolerance() const;
+        int constraintCount() const;
+        void setUnitCell(const UnitCell *cell);
+        const UnitCell* unitCell() const;
+        void setRandomSeed(unsigned int seed);
+        unsigned int randomSeed() const;
+
+        // velocities
+        void initializeVelocities();
+        void initializeVelocities(Float temperature);
+        void setVelocity(int index, const Vector3 &velocity);
+        Vector3 velocity(int index) const;
+        std::vector<Vector3> velocities() const;
+
+        // state
+        int stepCount() const;
+        Float time() const;
+        int degreesOfFreedom() const;
+        Float kineticEnergy() const;
+        Float potentialEnergy() const;
+        Float totalEnergy() const;
+        Float instantaneousTemperature() const;
+
+        // output
+        void setTrajectory(Trajectory *trajectory);
+        Trajectory* trajectory() const;
+        void setTrajectoryFile(TrajectoryFile *file);
+        TrajectoryFile* trajectoryFile() const;
+        void setFrameInterval(int steps);
+        int frameInterval() const;
+
+        // simulation
+        bool step();
+        bool run(int steps);
+        QFuture<bool> runAsync(int steps);
+        void cancel();
+        bool isCanceled() const;
+        void reset();
+
+        // error handling
+        std::string errorString() const;
+
+    private:
+        MolecularDynamicsPrivate* const d;
+};
+
+} // end chemkit namespace
+
+#endif // CHEMKIT_MOLECULARDYNAMICS_H
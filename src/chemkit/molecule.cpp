@@ -44,6 +44,7 @@
 #include "point3.h"
 #include "element.h"
 #include "foreach.h"
+#include "atomtyper.h"
 #include "vector3.h"
 #include "constants.h"
 #include "lineformat.h"
@@ -72,6 +73,9 @@ class MoleculePrivate
         std::vector<Fragment *> fragments;
         QList<MoleculeWatcher *> watchers;
         std::map<std::string, QVariant> data;
+        unsigned int topologyRevision;
+        std::map<std::string, std::pair<unsigned int, AtomTyper *> > atomTypers;
+        QMutex atomTypersMutex;
 };
 
 MoleculePrivate::MoleculePrivate()
@@ -79,6 +83,7 @@ MoleculePrivate::MoleculePrivate()
     conformer = 0;
     fragmentsPerceived = false;
     ringsPerceived = false;
+    topologyRevision = 0;
 }
 
 // === Molecule ============================================================ //
@@ -186,6 +191,10 @@ Molecule::~Molecule()
     Q_FOREACH(Conformer *conformer, d->conformers)
         delete conformer;
 
+    std::map<std::string, std::pair<unsigned int, AtomTyper *> >::iterator iter;
+    for(iter = d->atomTypers.begin(); iter != d->atomTypers.end(); ++iter)
+        delete iter->second.second;
+
     delete d;
 }
 
@@ -348,6 +357,7 @@ Atom* Molecule::addAtom(const Element &element)
     m_atoms.push_back(atom);
 
     setFragmentsPerceived(false);
+    setTopologyChanged();
     notifyObservers(atom, AtomAdded);
 
     return atom;
@@ -383,6 +393,7 @@ void Molecule::removeAtom(Atom *atom)
     m_atoms.erase(std::remove(m_atoms.begin(), m_atoms.end(), atom), m_atoms.end());
 
     atom->m_molecule = 0;
+    setTopologyChanged();
     notifyObservers(atom, AtomRemoved);
 
     delete atom;
@@ -449,6 +460,7 @@ Bond* Molecule::addBond(Atom *a, Atom *b, int order)
 
     setRingsPerceived(false);
     setFragmentsPerceived(false);
+    setTopologyChanged();
 
     notifyObservers(bond, BondAdded);
 
@@ -476,6 +488,7 @@ void Molecule::removeBond(Bond *bond)
 
     setRingsPerceived(false);
     setFragmentsPerceived(false);
+    setTopologyChanged();
 
     notifyObservers(bond, BondRemoved);
 
@@ -549,6 +562,18 @@ void Molecule::clear()
     }
 }
 
+/// Returns the topology revision of the molecule. The revision is
+/// incremented whenever an atom or bond is added or removed, an
+/// atom's atomic number is changed or a bond's order is changed.
+///
+/// Results which only depend on the molecule's topology (such as
+/// atom types) can be cached along with the revision they were
+/// calculated for and reused while the revision is unchanged.
+unsigned int Molecule::topologyRevision() const
+{
+    return d->topologyRevision;
+}
+
 // --- Comparison ---------------------------------------------------------- //
 /// Returns \c true if the molecule equals \p molecule.
 bool Molecule::equals(const Molecule *molecule, CompareFlags flags) const
@@ -1233,6 +1258,61 @@ void Molecule::notifyObservers(const Bond *bond, ChangeType type)
     }
 }
 
+void Molecule::setTopologyChanged()
+{
+    d->topologyRevision++;
+
+    clearCachedAtomTypers();
+}
+
+// Deletes the cached atom typers.
+void Molecule::clearCachedAtomTypers()
+{
+    QMutexLocker locker(&d->atomTypersMutex);
+
+    if(!d->atomTypers.empty()){
+        std::map<std::string, std::pair<unsigned int, AtomTyper *> >::iterator iter;
+        for(iter = d->atomTypers.begin(); iter != d->atomTypers.end(); ++iter){
+            delete iter->second.second;
+        }
+
+        d->atomTypers.clear();
+    }
+}
+
+// Returns the mutex guarding the cached atom typers. It must be held
+// while calling cachedAtomTyper() or setCachedAtomTyper() and while
+// using the returned atom typer.
+QMutex* Molecule::atomTyperMutex() const
+{
+    return &d->atomTypersMutex;
+}
+
+// Returns the cached atom typer with name for the molecule's current
+// topology revision or 0 if none has been cached.
+const AtomTyper* Molecule::cachedAtomTyper(const std::string &name) const
+{
+    std::map<std::string, std::pair<unsigned int, AtomTyper *> >::const_iterator iter = d->atomTypers.find(name);
+    if(iter == d->atomTypers.end() || iter->second.first != d->topologyRevision){
+        return 0;
+    }
+
+    return iter->second.second;
+}
+
+// Caches typer for the molecule's current topology revision. The
+// molecule takes ownership of typer.
+void Molecule::setCachedAtomTyper(AtomTyper *typer) const
+{
+    std::pair<unsigned int, AtomTyper *> &entry = d->atomTypers[typer->name()];
+    if(entry.second != typer){
+        delete entry.second;
+    }
+
+    entry.first = d->topologyRevision;
+    entry.second = typer;
+}
+
 void Molecule::addWatcher(MoleculeWatcher *watcher) const
 {
     d->watchers.append(watcher);
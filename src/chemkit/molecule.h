@@ -41,6 +41,7 @@
 #include <string>
 #include <vector>
 
+#include <QMutex>
 #include <QVariant>
 
 #include "atom.h"
@@ -55,6 +56,7 @@
 
 namespace chemkit {
 
+class AtomTyper;
 class Coordinates;
 class MoleculePrivate;
 class MoleculeWatcher;
@@ -129,6 +131,7 @@ class CHEMKIT_EXPORT Molecule
         int bondCount() const;
         bool contains(const Bond *bond) const;
         void clear();
+        unsigned int topologyRevision() const;
 
         // comparison
         bool equals(const Molecule *molecule, CompareFlags flags = CompareFlags()) const;
@@ -198,9 +201,15 @@ class CHEMKIT_EXPORT Molecule
         void addWatcher(MoleculeWatcher *watcher) const;
         void removeWatcher(MoleculeWatcher *watcher) const;
         bool isSubsetOf(const Molecule *molecule, CompareFlags flags = CompareFlags()) const;
+        void setTopologyChanged();
+        void clearCachedAtomTypers();
+        QMutex* atomTyperMutex() const;
+        const AtomTyper* cachedAtomTyper(const std::string &name) const;
+        void setCachedAtomTyper(AtomTyper *typer) const;
 
         friend class Atom;
         friend class Bond;
+        friend class AtomTyper;
         friend class MoleculeWatcher;
 
     private:
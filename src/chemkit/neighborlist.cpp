@@ -0,0 +1,357 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "neighborlist.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "unitcell.h"
+
+namespace chemkit {
+
+// === NeighborListPrivate ================================================= //
+class NeighborListPrivate
+{
+    public:
+        Float cutoff;
+        const UnitCell *unitCell;
+        int size;
+        int cellCount;
+        std::vector<int> offsets;
+        std::vector<int> neighbors;
+};
+
+// === NeighborList ======================================================== //
+/// \class NeighborList neighborlist.h chemkit/neighborlist.h
+/// \ingroup chemkit
+/// \brief The NeighborList class finds all pairs of positions
+///        within a cutoff distance of each other.
+///
+/// The positions are sorted into a grid of cells which are at least
+/// as wide as the cutoff so that only the positions in neighboring
+/// cells need to be compared. This makes building the list linear
+/// in the number of positions rather than quadratic.
+///
+/// The following example shows how to find the atoms within 8
+/// angstroms of each other:
+///
+/// \code
+/// NeighborList neighborList(8.0);
+/// neighborList.build(positions);
+///
+/// for(int i = 0; i < neighborList.size(); i++){
+///     foreach(int j, neighborList.neighbors(i)){
+///         // positions i and j are within 8 angstroms
+///     }
+/// }
+/// \endcode
+///
+/// Each pair is only stored once with the lower index, that is the
+/// neighbors of position \c i all have indices greater than \c i.
+///
+/// If a unit cell is set, distances are measured between the
+/// closest periodic images of the positions. Only the closest image
+/// of each pair is considered so the cutoff should be at most half
+/// the width of the cell.
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new, empty neighbor list.
+NeighborList::NeighborList()
+    : d(new NeighborListPrivate)
+{
+    d->cutoff = 0;
+    d->unitCell = 0;
+    d->size = 0;
+    d->cellCount = 0;
+}
+
+/// Creates a new, empty neighbor list with \p cutoff.
+NeighborList::NeighborList(Float cutoff)
+    : d(new NeighborListPrivate)
+{
+    d->cutoff = cutoff;
+    d->unitCell = 0;
+    d->size = 0;
+    d->cellCount = 0;
+}
+
+/// Destroys the neighbor list.
+NeighborList::~NeighborList()
+{
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Sets the cutoff distance to \p cutoff. The list must be rebuilt
+/// with build() for the new cutoff to take effect.
+void NeighborList::setCutoff(Float cutoff)
+{
+    d->cutoff = cutoff;
+}
+
+/// Returns the cutoff distance.
+Float NeighborList::cutoff() const
+{
+    return d->cutoff;
+}
+
+/// Sets the periodic unit cell to \p cell. If \p cell is \c 0 (the
+/// default) periodic boundaries are not used. The cell is not owned
+/// by the neighbor list.
+void NeighborList::setUnitCell(const UnitCell *cell)
+{
+    d->unitCell = cell;
+}
+
+/// Returns the periodic unit cell.
+const UnitCell* NeighborList::unitCell() const
+{
+    return d->unitCell;
+}
+
+/// Returns the number of positions in the list.
+int NeighborList::size() const
+{
+    return d->size;
+}
+
+/// Returns the number of pairs in the list.
+int NeighborList::pairCount() const
+{
+    return d->neighbors.size();
+}
+
+/// Returns the number of cells that the positions were sorted into
+/// when the list was last built.
+int NeighborList::cellCount() const
+{
+    return d->cellCount;
+}
+
+// --- Neighbors ----------------------------------------------------------- //
+/// Builds the neighbor list for \p positions.
+void NeighborList::build(const std::vector<Point3> &positions)
+{
+    d->size = positions.size();
+    d->offsets.assign(d->size + 1, 0);
+    d->neighbors.clear();
+    d->cellCount = 0;
+
+    if(positions.empty() || d->cutoff <= 0){
+        return;
+    }
+
+    const UnitCell *cell = d->unitCell;
+    if(cell && cell->volume() == 0){
+        cell = 0;
+    }
+
+    // the coordinates of each position along the three axes of the
+    // grid scaled so that the grid spans [0, 1) along each axis
+    Vector3 axes[3];
+    Float origin[3];
+    int dimensions[3];
+
+    if(cell){
+        // the rows of the inverse cell matrix, the distance between
+        // opposite faces of the cell is the reciprocal of their length
+        Float determinant = cell->x().dot(cell->y().cross(cell->z()));
+        axes[0] = cell->y().cross(cell->z()) / determinant;
+        axes[1] = cell->z().cross(cell->x()) / determinant;
+        axes[2] = cell->x().cross(cell->y()) / determinant;
+
+        for(int i = 0; i < 3; i++){
+            origin[i] = 0;
+            dimensions[i] = qMax(1, static_cast<int>(1.0 / (axes[i].length() * d->cutoff)));
+        }
+    }
+    else{
+        Point3 minimum = positions[0];
+        Point3 maximum = positions[0];
+
+        for(unsigned int i = 1; i < positions.size(); i++){
+            for(int j = 0; j < 3; j++){
+                minimum[j] = qMin(minimum[j], positions[i][j]);
+                maximum[j] = qMax(maximum[j], positions[i][j]);
+            }
+        }
+
+        // limit the number of cells for sparse systems by using
+        // larger cells
+        Float cellSize = d->cutoff;
+        Float cellLimit = 8.0 * positions.size() + 64;
+        Float volume = 1;
+        for(int i = 0; i < 3; i++){
+            volume *= (maximum[i] - minimum[i]) / cellSize + 1;
+        }
+        if(volume > cellLimit){
+            cellSize *= std::pow(volume / cellLimit, 1.0 / 3.0);
+        }
+
+        for(int i = 0; i < 3; i++){
+            dimensions[i] = static_cast<int>((maximum[i] - minimum[i]) / cellSize) + 1;
+
+            axes[i] = Vector3(0, 0, 0);
+            axes[i][i] = 1.0 / (dimensions[i] * cellSize);
+            origin[i] = minimum[i] * axes[i][i];
+        }
+    }
+
+    d->cellCount = dimensions[0] * dimensions[1] * dimensions[2];
+
+    // sort the positions into cells
+    std::vector<int> atomCells(positions.size());
+    std::vector<int> cellStarts(d->cellCount + 1, 0);
+
+    for(unsigned int i = 0; i < positions.size(); i++){
+        int index[3];
+
+        for(int j = 0; j < 3; j++){
+            Float fraction = axes[j].dot(positions[i]) - origin[j];
+            if(cell){
+                fraction -= std::floor(fraction);
+            }
+
+            index[j] = qBound(0, static_cast<int>(fraction * dimensions[j]), dimensions[j] - 1);
+        }
+
+        atomCells[i] = (index[0] * dimensions[1] + index[1]) * dimensions[2] + index[2];
+        cellStarts[atomCells[i] + 1]++;
+    }
+
+    for(int i = 0; i < d->cellCount; i++){
+        cellStarts[i + 1] += cellStarts[i];
+    }
+
+    std::vector<int> cellAtoms(positions.size());
+    std::vector<int> cellPositions(cellStarts.begin(), cellStarts.end() - 1);
+    for(unsigned int i = 0; i < positions.size(); i++){
+        cellAtoms[cellPositions[atomCells[i]]++] = i;
+    }
+
+    // compare each position with the positions in its own and the
+    // 26 surrounding cells
+    const Float cutoffSquared = d->cutoff * d->cutoff;
+    std::vector<int> neighborCells;
+    neighborCells.reserve(27);
+
+    for(unsigned int i = 0; i < positions.size(); i++){
+        int cellIndex = atomCells[i];
+        int index[3] = { cellIndex / (dimensions[1] * dimensions[2]),
+                         (cellIndex / dimensions[2]) % dimensions[1],
+                         cellIndex % dimensions[2] };
+
+        neighborCells.clear();
+        for(int a = -1; a <= 1; a++){
+            for(int b = -1; b <= 1; b++){
+                for(int c = -1; c <= 1; c++){
+                    int neighbor[3] = { index[0] + a, index[1] + b, index[2] + c };
+
+                    bool valid = true;
+                    for(int j = 0; j < 3; j++){
+                        if(neighbor[j] < 0 || neighbor[j] >= dimensions[j]){
+                            if(cell){
+                                neighbor[j] = (neighbor[j] + dimensions[j]) % dimensions[j];
+                            }
+                            else{
+                                valid = false;
+                            }
+                        }
+                    }
+
+                    if(valid){
+                        neighborCells.push_back((neighbor[0] * dimensions[1] + neighbor[1]) * dimensions[2] + neighbor[2]);
+                    }
+                }
+            }
+        }
+
+        // with fewer than three cells along an axis the same cell is
+        // reached from both sides
+        std::sort(neighborCells.begin(), neighborCells.end());
+        neighborCells.erase(std::unique(neighborCells.begin(), neighborCells.end()), neighborCells.end());
+
+        const Point3 &position = positions[i];
+        unsigned int first = d->neighbors.size();
+
+        for(unsigned int k = 0; k < neighborCells.size(); k++){
+            int neighborCell = neighborCells[k];
+
+            for(int l = cellStarts[neighborCell]; l < cellStarts[neighborCell + 1]; l++){
+                unsigned int j = cellAtoms[l];
+                if(j <= i){
+                    continue;
+                }
+
+                Vector3 vector = positions[j] - position;
+                if(cell){
+                    vector = cell->minimumImage(vector);
+                }
+
+                if(vector.lengthSquared() <= cutoffSquared){
+                    d->neighbors.push_back(j);
+                }
+            }
+        }
+
+        std::sort(d->neighbors.begin() + first, d->neighbors.end());
+        d->offsets[i + 1] = d->neighbors.size();
+    }
+}
+
+/// Returns the indices of the neighbors of the position at
+/// \p index. Only neighbors with indices greater than \p index are
+/// returned.
+std::vector<int> NeighborList::neighbors(int index) const
+{
+    return std::vector<int>(d->neighbors.begin() + d->offsets[index],
+                            d->neighbors.begin() + d->offsets[index + 1]);
+}
+
+/// Returns the number of neighbors of the position at \p index.
+int NeighborList::neighborCount(int index) const
+{
+    return d->offsets[index + 1] - d->offsets[index];
+}
+
+/// Returns the index of the \p i'th neighbor of the position at
+/// \p index.
+int NeighborList::neighbor(int index, int i) const
+{
+    return d->neighbors[d->offsets[index] + i];
+}
+
+} // end chemkit namespace
@@ -0,0 +1,667 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "particlemeshewald.h"
+
+#include <cmath>
+#include <complex>
+
+#include "unitcell.h"
+#include "constants.h"
+
+namespace chemkit {
+
+namespace {
+
+typedef std::complex<Float> Complex;
+
+// Returns the smallest number greater than or equal to value whose
+// only prime factors are 2, 3 and 5.
+int fastFourierSize(int value)
+{
+    for(int size = qMax(1, value); ; size++){
+        int remainder = size;
+
+        while(remainder % 2 == 0){
+            remainder /= 2;
+        }
+        while(remainder % 3 == 0){
+            remainder /= 3;
+        }
+        while(remainder % 5 == 0){
+            remainder /= 5;
+        }
+
+        if(remainder == 1){
+            return size;
+        }
+    }
+}
+
+// The FourierTransform class calculates one dimensional discrete
+// Fourier transforms of a fixed size using the mixed radix
+// Cooley-Tukey algorithm. The transform is fastest for sizes which
+// only have small prime factors.
+class FourierTransform
+{
+    public:
+        FourierTransform();
+
+        void setSize(int size);
+        int size() const;
+        void transform(const Complex *input, Complex *output, int sign) const;
+
+    private:
+        void transform(const Complex *input, int stride, Complex *output, int size, int factor, int sign) const;
+        Complex twiddle(int index, int sign) const;
+
+    private:
+        int m_size;
+        std::vector<int> m_factors;
+        std::vector<Complex> m_twiddles;
+};
+
+FourierTransform::FourierTransform()
+{
+    setSize(1);
+}
+
+void FourierTransform::setSize(int size)
+{
+    m_size = size;
+
+    m_factors.clear();
+    int remainder = size;
+    for(int factor = 2; remainder > 1; factor++){
+        while(remainder % factor == 0){
+            m_factors.push_back(factor);
+            remainder /= factor;
+        }
+    }
+
+    m_twiddles.resize(size);
+    for(int i = 0; i < size; i++){
+        Float angle = -2.0 * chemkit::constants::Pi * i / size;
+        m_twiddles[i] = Complex(std::cos(angle), std::sin(angle));
+    }
+}
+
+int FourierTransform::size() const
+{
+    return m_size;
+}
+
+// Transforms input into output. The forward transform is calculated
+// if sign is negative and the (unnormalized) backward transform if
+// sign is positive.
+void FourierTransform::transform(const Complex *input, Complex *output, int sign) const
+{
+    transform(input, 1, output, m_size, 0, sign);
+}
+
+void FourierTransform::transform(const Complex *input, int stride, Complex *output, int size, int factor, int sign) const
+{
+    if(size == 1){
+        output[0] = input[0];
+        return;
+    }
+
+    // transform each of the radix interleaved subsequences
+    int radix = m_factors[factor];
+    int subsize = size / radix;
+
+    for(int i = 0; i < radix; i++){
+        transform(input + i * stride, stride * radix, output + i * subsize, subsize, factor + 1, sign);
+    }
+
+    // combine the subsequence transforms
+    int step = m_size / size;
+    std::vector<Complex> terms(radix);
+
+    for(int k = 0; k < subsize; k++){
+        for(int i = 0; i < radix; i++){
+            terms[i] = output[i * subsize + k] * twiddle(i * k * step, sign);
+        }
+
+        for(int j = 0; j < radix; j++){
+            Complex sum = 0;
+
+            for(int i = 0; i < radix; i++){
+                sum += terms[i] * twiddle(((i * j) % radix) * subsize * step, sign);
+            }
+
+            output[j * subsize + k] = sum;
+        }
+    }
+}
+
+// Returns exp(sign * 2 * pi * i * index / size).
+Complex FourierTransform::twiddle(int index, int sign) const
+{
+    const Complex &value = m_twiddles[index % m_size];
+
+    return sign < 0 ? value : std::conj(value);
+}
+
+// Transforms each line of the three dimensional grid along each
+// of its axes.
+void transformGrid(std::vector<Complex> &grid, const int dimensions[3], const FourierTransform transforms[3], int sign)
+{
+    const int strides[3] = { dimensions[1] * dimensions[2], dimensions[2], 1 };
+
+    for(int axis = 0; axis < 3; axis++){
+        int size = dimensions[axis];
+        int stride = strides[axis];
+        int a = (axis + 1) % 3;
+        int b = (axis + 2) % 3;
+
+        std::vector<Complex> line(size);
+        std::vector<Complex> result(size);
+
+        for(int i = 0; i < dimensions[a]; i++){
+            for(int j = 0; j < dimensions[b]; j++){
+                Complex *start = &grid[i * strides[a] + j * strides[b]];
+
+                for(int k = 0; k < size; k++){
+                    line[k] = start[k * stride];
+                }
+
+                transforms[axis].transform(&line[0], &result[0], sign);
+
+                for(int k = 0; k < size; k++){
+                    start[k * stride] = result[k];
+                }
+            }
+        }
+    }
+}
+
+// Calculates the values of the cardinal B-spline of order at the
+// order grid points surrounding a position which is offset by w
+// from the first grid point. The derivatives with respect to w are
+// also calculated if derivatives is not null.
+void splineWeights(Float w, int order, Float *values, Float *derivatives)
+{
+    values[order - 1] = 0;
+    values[1] = w;
+    values[0] = 1 - w;
+
+    for(int j = 3; j < order; j++){
+        Float scale = 1.0 / (j - 1);
+        values[j - 1] = scale * w * values[j - 2];
+
+        for(int k = 1; k < j - 1; k++){
+            values[j - k - 1] = scale * ((w + k) * values[j - k - 2] + (j - k - w) * values[j - k - 1]);
+        }
+
+        values[0] = scale * (1 - w) * values[0];
+    }
+
+    // the derivatives follow from the spline of one lower order
+    if(derivatives){
+        derivatives[0] = -values[0];
+
+        for(int j = 1; j < order; j++){
+            derivatives[j] = values[j - 1] - values[j];
+        }
+    }
+
+    Float scale = 1.0 / (order - 1);
+    values[order - 1] = scale * w * values[order - 2];
+
+    for(int k = 1; k < order - 1; k++){
+        values[order - k - 1] = scale * ((w + k) * values[order - k - 2] + (order - k - w) * values[order - k - 1]);
+    }
+
+    values[0] = scale * (1 - w) * values[0];
+}
+
+// Calculates the squared moduli of the discrete Fourier transform of
+// the B-spline interpolation weights along one axis of the grid.
+std::vector<Float> splineModuli(int size, int order)
+{
+    std::vector<Float> values(order);
+    splineWeights(0, order, &values[0], 0);
+
+    std::vector<Float> spline(size, 0);
+    for(int i = 0; i < order; i++){
+        spline[(i + 1) % size] += values[i];
+    }
+
+    std::vector<Float> moduli(size);
+    for(int m = 0; m < size; m++){
+        Float real = 0;
+        Float imaginary = 0;
+
+        for(int j = 0; j < size; j++){
+            Float angle = 2.0 * chemkit::constants::Pi * m * j / size;
+            real += spline[j] * std::cos(angle);
+            imaginary += spline[j] * std::sin(angle);
+        }
+
+        moduli[m] = real * real + imaginary * imaginary;
+    }
+
+    // odd order splines have zeros at the nyquist frequency which are
+    // replaced with the average of their neighbors
+    for(int m = 0; m < size; m++){
+        if(moduli[m] < 1.0e-7){
+            moduli[m] = 0.5 * (moduli[(m - 1 + size) % size] + moduli[(m + 1) % size]);
+        }
+    }
+
+    return moduli;
+}
+
+} // end anonymous namespace
+
+// === ParticleMeshEwaldPrivate ============================================ //
+class ParticleMeshEwaldPrivate
+{
+    public:
+        void updateGrid();
+        Float reciprocalEnergy(const std::vector<Point3> &positions, const std::vector<Float> &charges, std::vector<Vector3> *gradient);
+
+        const UnitCell *unitCell;
+        Float ewaldCoefficient;
+        Float gridSpacing;
+        int order;
+        int gridOrder;
+        int dimensions[3];
+        FourierTransform transforms[3];
+        std::vector<Float> moduli[3];
+        std::vector<Complex> grid;
+};
+
+// Updates the size of the grid for the current unit cell, grid
+// spacing and spline order.
+void ParticleMeshEwaldPrivate::updateGrid()
+{
+    const Vector3 vectors[3] = { unitCell->x(), unitCell->y(), unitCell->z() };
+
+    bool changed = false;
+
+    for(int i = 0; i < 3; i++){
+        int size = fastFourierSize(qMax(order, static_cast<int>(std::ceil(vectors[i].length() / gridSpacing))));
+
+        if(size != dimensions[i] || order != gridOrder){
+            dimensions[i] = size;
+            transforms[i].setSize(size);
+            moduli[i] = splineModuli(size, order);
+            changed = true;
+        }
+    }
+
+    gridOrder = order;
+
+    if(changed){
+        grid.resize(dimensions[0] * dimensions[1] * dimensions[2]);
+    }
+}
+
+Float ParticleMeshEwaldPrivate::reciprocalEnergy(const std::vector<Point3> &positions, const std::vector<Float> &charges, std::vector<Vector3> *gradient)
+{
+    if(gradient){
+        gradient->assign(positions.size(), Vector3());
+    }
+
+    if(!unitCell || unitCell->volume() == 0 || positions.empty()){
+        return 0;
+    }
+
+    updateGrid();
+
+    const Float volume = unitCell->volume();
+    const Float beta = ewaldCoefficient;
+    const Float pi = chemkit::constants::Pi;
+
+    // the reciprocal vectors of the cell
+    Float determinant = unitCell->x().dot(unitCell->y().cross(unitCell->z()));
+    const Vector3 reciprocal[3] = { unitCell->y().cross(unitCell->z()) / determinant,
+                                    unitCell->z().cross(unitCell->x()) / determinant,
+                                    unitCell->x().cross(unitCell->y()) / determinant };
+
+    // spread the charges onto the grid
+    const int count = positions.size();
+    std::vector<int> firstPoints(3 * count);
+    std::vector<Float> weights(3 * count * order);
+    std::vector<Float> weightDerivatives(3 * count * order);
+
+    std::fill(grid.begin(), grid.end(), Complex(0));
+
+    Float totalCharge = 0;
+
+    for(int i = 0; i < count; i++){
+        for(int axis = 0; axis < 3; axis++){
+            Float u = reciprocal[axis].dot(positions[i]);
+            u = (u - std::floor(u)) * dimensions[axis];
+
+            int first = static_cast<int>(u);
+            Float w = u - first;
+
+            firstPoints[3 * i + axis] = first % dimensions[axis];
+            splineWeights(w, order, &weights[(3 * i + axis) * order], &weightDerivatives[(3 * i + axis) * order]);
+        }
+
+        const Float charge = charges[i];
+        totalCharge += charge;
+
+        const Float *wx = &weights[(3 * i + 0) * order];
+        const Float *wy = &weights[(3 * i + 1) * order];
+        const Float *wz = &weights[(3 * i + 2) * order];
+
+        for(int x = 0; x < order; x++){
+            int gx = (firstPoints[3 * i + 0] + x) % dimensions[0];
+
+            for(int y = 0; y < order; y++){
+                int gy = (firstPoints[3 * i + 1] + y) % dimensions[1];
+                Complex *row = &grid[(gx * dimensions[1] + gy) * dimensions[2]];
+                Float wxy = charge * wx[x] * wy[y];
+
+                for(int z = 0; z < order; z++){
+                    int gz = (firstPoints[3 * i + 2] + z) % dimensions[2];
+                    row[gz] += wxy * wz[z];
+                }
+            }
+        }
+    }
+
+    transformGrid(grid, dimensions, transforms, -1);
+
+    // multiply the structure factors by the reciprocal space
+    // influence function
+    Float energy = 0;
+
+    for(int x = 0; x < dimensions[0]; x++){
+        int mx = x <= dimensions[0] / 2 ? x : x - dimensions[0];
+
+        for(int y = 0; y < dimensions[1]; y++){
+            int my = y <= dimensions[1] / 2 ? y : y - dimensions[1];
+
+            for(int z = 0; z < dimensions[2]; z++){
+                int mz = z <= dimensions[2] / 2 ? z : z - dimensions[2];
+                Complex &value = grid[(x * dimensions[1] + y) * dimensions[2] + z];
+
+                if(mx == 0 && my == 0 && mz == 0){
+                    value = 0;
+                    continue;
+                }
+
+                Vector3 m = reciprocal[0] * Float(mx) + reciprocal[1] * Float(my) + reciprocal[2] * Float(mz);
+                Float mSquared = m.lengthSquared();
+
+                Float term = std::exp(-pi * pi * mSquared / (beta * beta)) /
+                             (pi * volume * mSquared * moduli[0][x] * moduli[1][y] * moduli[2][z]);
+
+                energy += 0.5 * term * std::norm(value);
+                value *= term;
+            }
+        }
+    }
+
+    // correction for the uniform background charge which neutralizes
+    // systems with a net charge
+    energy -= pi * totalCharge * totalCharge / (2 * volume * beta * beta);
+
+    if(!gradient){
+        return energy;
+    }
+
+    // the convolution of the charges with the influence function is
+    // the derivative of the energy with respect to each grid point
+    transformGrid(grid, dimensions, transforms, 1);
+
+    for(int i = 0; i < count; i++){
+        const Float *wx = &weights[(3 * i + 0) * order];
+        const Float *wy = &weights[(3 * i + 1) * order];
+        const Float *wz = &weights[(3 * i + 2) * order];
+        const Float *dx = &weightDerivatives[(3 * i + 0) * order];
+        const Float *dy = &weightDerivatives[(3 * i + 1) * order];
+        const Float *dz = &weightDerivatives[(3 * i + 2) * order];
+
+        Float derivatives[3] = { 0, 0, 0 };
+
+        for(int x = 0; x < order; x++){
+            int gx = (firstPoints[3 * i + 0] + x) % dimensions[0];
+
+            for(int y = 0; y < order; y++){
+                int gy = (firstPoints[3 * i + 1] + y) % dimensions[1];
+                const Complex *row = &grid[(gx * dimensions[1] + gy) * dimensions[2]];
+
+                for(int z = 0; z < order; z++){
+                    int gz = (firstPoints[3 * i + 2] + z) % dimensions[2];
+                    Float value = row[gz].real();
+
+                    derivatives[0] += dx[x] * wy[y] * wz[z] * value;
+                    derivatives[1] += wx[x] * dy[y] * wz[z] * value;
+                    derivatives[2] += wx[x] * wy[y] * dz[z] * value;
+                }
+            }
+        }
+
+        (*gradient)[i] = (reciprocal[0] * (derivatives[0] * dimensions[0]) +
+                          reciprocal[1] * (derivatives[1] * dimensions[1]) +
+                          reciprocal[2] * (derivatives[2] * dimensions[2])) * charges[i];
+    }
+
+    return energy;
+}
+
+// === ParticleMeshEwald =================================================== //
+/// \class ParticleMeshEwald particlemeshewald.h chemkit/particlemeshewald.h
+/// \ingroup chemkit
+/// \brief The ParticleMeshEwald class calculates the long-range
+///        electrostatic energy of a periodic system.
+///
+/// The ParticleMeshEwald class implements the smooth particle mesh
+/// Ewald method of Essmann et al. [1995]. The Coulomb energy of a
+/// periodic system of point charges is split into a short-range
+/// real space sum which is screened by the complementary error
+/// function and a smooth long-range reciprocal space sum. The
+/// reciprocal space sum is calculated by interpolating the charges
+/// onto a grid with cardinal B-splines and convolving the grid with
+/// fast Fourier transforms which scales as O(N log N) with the
+/// number of charges.
+///
+/// The total electrostatic energy is given by:
+/// \f[ E = E_{real} + E_{reciprocal} + E_{self} - E_{excluded} \f]
+///
+/// where the real space energy is the sum over all pairs within the
+/// cutoff:
+/// \f[ E_{real} = \sum_{i<j} \frac{q_{i} q_{j} erfc(\beta r_{ij})}{r_{ij}} \f]
+///
+/// The reciprocal space and self energies are calculated by the
+/// reciprocalEnergy() and selfEnergy() methods respectively. All
+/// energies are in units of \f$e^{2}/\AA\f$ and should be multiplied
+/// by the Coulomb constant to give energies in kcal/mol.
+///
+/// The accuracy of the reciprocal space sum is controlled by the
+/// grid spacing and the order of the interpolating splines. With an
+/// Ewald coefficient of about 0.35 (a 9 angstrom cutoff) the default
+/// spacing of 1.0 angstrom and fourth order interpolation give
+/// relative errors of about \f$10^{-3}\f$ in the energy. Larger
+/// coefficients (shorter cutoffs) require finer grids.
+///
+/// \see NeighborList
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new particle mesh Ewald object.
+ParticleMeshEwald::ParticleMeshEwald()
+    : d(new ParticleMeshEwaldPrivate)
+{
+    d->unitCell = 0;
+    d->ewaldCoefficient = 0.35;
+    d->gridSpacing = 1.0;
+    d->order = 4;
+    d->gridOrder = 0;
+
+    for(int i = 0; i < 3; i++){
+        d->dimensions[i] = 0;
+    }
+}
+
+/// Destroys the particle mesh Ewald object.
+ParticleMeshEwald::~ParticleMeshEwald()
+{
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Sets the periodic unit cell to \p cell. The cell is not owned by
+/// the particle mesh Ewald object.
+void ParticleMeshEwald::setUnitCell(const UnitCell *cell)
+{
+    d->unitCell = cell;
+}
+
+/// Returns the periodic unit cell.
+const UnitCell* ParticleMeshEwald::unitCell() const
+{
+    return d->unitCell;
+}
+
+/// Sets the Ewald coefficient (\f$\beta\f$) to \p coefficient. The
+/// coefficient is in inverse angstroms and controls how the energy
+/// is divided between the real and reciprocal space sums.
+///
+/// \see ewaldCoefficient(Float, Float)
+void ParticleMeshEwald::setEwaldCoefficient(Float coefficient)
+{
+    d->ewaldCoefficient = coefficient;
+}
+
+/// Returns the Ewald coefficient.
+Float ParticleMeshEwald::ewaldCoefficient() const
+{
+    return d->ewaldCoefficient;
+}
+
+/// Sets the maximum spacing between grid points to \p spacing. The
+/// default spacing is 1.0 angstrom. The number of grid points along
+/// each cell vector is rounded up to a number whose only prime
+/// factors are 2, 3 and 5.
+void ParticleMeshEwald::setGridSpacing(Float spacing)
+{
+    d->gridSpacing = spacing;
+}
+
+/// Returns the maximum spacing between grid points.
+Float ParticleMeshEwald::gridSpacing() const
+{
+    return d->gridSpacing;
+}
+
+/// Sets the order of the B-spline interpolation to \p order. The
+/// default order is 4 (cubic splines). Higher orders are more
+/// accurate but require more time to interpolate the charges.
+void ParticleMeshEwald::setOrder(int order)
+{
+    d->order = qBound(3, order, 12);
+}
+
+/// Returns the order of the B-spline interpolation.
+int ParticleMeshEwald::order() const
+{
+    return d->order;
+}
+
+/// Returns the number of grid points along each of the cell
+/// vectors.
+std::vector<int> ParticleMeshEwald::gridDimensions() const
+{
+    if(d->unitCell){
+        d->updateGrid();
+    }
+
+    return std::vector<int>(d->dimensions, d->dimensions + 3);
+}
+
+// --- Energy -------------------------------------------------------------- //
+/// Returns the reciprocal space energy of the \p charges located at
+/// \p positions. This includes the correction for the uniform
+/// background charge in systems with a net charge.
+Float ParticleMeshEwald::reciprocalEnergy(const std::vector<Point3> &positions, const std::vector<Float> &charges)
+{
+    return d->reciprocalEnergy(positions, charges, 0);
+}
+
+/// Returns the reciprocal space energy of the \p charges located at
+/// \p positions and sets \p gradient to its gradient with respect
+/// to each of the positions.
+Float ParticleMeshEwald::reciprocalEnergy(const std::vector<Point3> &positions, const std::vector<Float> &charges, std::vector<Vector3> &gradient)
+{
+    return d->reciprocalEnergy(positions, charges, &gradient);
+}
+
+/// Returns the self energy of the \p charges. This removes the
+/// interaction of each charge with its own screening charge
+/// distribution that is included in the reciprocal space sum.
+///
+/// \f[ E_{self} = -\frac{\beta}{\sqrt{\pi}} \sum_{i} q_{i}^{2} \f]
+Float ParticleMeshEwald::selfEnergy(const std::vector<Float> &charges) const
+{
+    Float sum = 0;
+    for(unsigned int i = 0; i < charges.size(); i++){
+        sum += charges[i] * charges[i];
+    }
+
+    return -d->ewaldCoefficient / std::sqrt(chemkit::constants::Pi) * sum;
+}
+
+// --- Static Methods ------------------------------------------------------ //
+/// Returns the Ewald coefficient for which the screened interaction
+/// of two charges at \p cutoff is reduced by the factor
+/// \p tolerance. That is, the value of \f$\beta\f$ satisfying
+/// \f$erfc(\beta r_{c}) = tolerance\f$.
+Float ParticleMeshEwald::ewaldCoefficient(Float cutoff, Float tolerance)
+{
+    Float low = 0;
+    Float high = 10.0 / cutoff;
+
+    for(int i = 0; i < 100; i++){
+        Float middle = 0.5 * (low + high);
+
+        if(erfc(middle * cutoff) > tolerance){
+            low = middle;
+        }
+        else{
+            high = middle;
+        }
+    }
+
+    return 0.5 * (low + high);
+}
+
+} // end chemkit namespace
@@ -0,0 +1,736 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "receptorgrid.h"
+
+#include <map>
+#include <cmath>
+
+#include "atom.h"
+#include "foreach.h"
+#include "molecule.h"
+#include "forcefield.h"
+#include "scalarfield.h"
+#include "forcefieldatom.h"
+
+namespace chemkit {
+
+namespace {
+
+// Coulomb constant in (kcal * angstrom) / (mol * e^2).
+const Float CoulombConstant = 332.0716;
+
+// Spacing between the distances at which the van der Waals energy
+// of each pair of atom types is tabulated.
+const Float TableSpacing = 0.01;
+
+// The ReceptorGridSlab class contains a range of planes of the grid
+// along with the data needed to calculate the values at their
+// points. Each slab is filled by a single thread.
+class ReceptorGridSlab
+{
+    public:
+        int begin;
+        int end;
+        const std::vector<int> *dimensions;
+        Point3 origin;
+        Float spacing;
+        Float cutoff;
+        Float electrostaticScale;
+        Float energyLimit;
+        const std::vector<Point3> *receptorPositions;
+        const std::vector<Float> *receptorCharges;
+        const std::vector<int> *receptorTypes;
+        const std::vector<std::vector<std::vector<Float> > > *tables;
+        std::vector<std::vector<Float> > *vanDerWaalsData;
+        std::vector<Float> *electrostaticData;
+};
+
+void fillReceptorGridSlab(ReceptorGridSlab &slab)
+{
+    const std::vector<int> &dimensions = *slab.dimensions;
+    const std::vector<Point3> &receptorPositions = *slab.receptorPositions;
+    const std::vector<Float> &receptorCharges = *slab.receptorCharges;
+    const std::vector<int> &receptorTypes = *slab.receptorTypes;
+    const std::vector<std::vector<std::vector<Float> > > &tables = *slab.tables;
+
+    const int typeCount = tables.size();
+    const Float cutoffSquared = slab.cutoff * slab.cutoff;
+
+    std::vector<Float> energies(typeCount);
+
+    for(int i = slab.begin; i < slab.end; i++){
+        for(int j = 0; j < dimensions[1]; j++){
+            for(int k = 0; k < dimensions[2]; k++){
+                Point3 point = slab.origin + Vector3(i * slab.spacing, j * slab.spacing, k * slab.spacing);
+
+                std::fill(energies.begin(), energies.end(), Float(0));
+                Float potential = 0;
+
+                for(unsigned int atom = 0; atom < receptorPositions.size(); atom++){
+                    Float distanceSquared = (receptorPositions[atom] - point).lengthSquared();
+                    Float r = std::sqrt(distanceSquared);
+
+                    potential += receptorCharges[atom] / qMax(r, Float(1.0e-6));
+
+                    if(distanceSquared >= cutoffSquared){
+                        continue;
+                    }
+
+                    // linear interpolation between the tabulated energies
+                    Float x = r / TableSpacing;
+                    int index = static_cast<int>(x);
+                    Float fraction = x - index;
+
+                    for(int type = 0; type < typeCount; type++){
+                        const std::vector<Float> &table = tables[type][receptorTypes[atom]];
+
+                        energies[type] += table[index] * (1 - fraction) + table[index + 1] * fraction;
+                    }
+                }
+
+                int index = i * dimensions[1] * dimensions[2] + j * dimensions[2] + k;
+
+                for(int type = 0; type < typeCount; type++){
+                    (*slab.vanDerWaalsData)[type][index] = qMin(energies[type], slab.energyLimit);
+                }
+
+                potential *= slab.electrostaticScale;
+                (*slab.electrostaticData)[index] = qBound(-slab.energyLimit, potential, slab.energyLimit);
+            }
+        }
+    }
+}
+
+} // end anonymous namespace
+
+// === ReceptorGridPrivate ================================================= //
+class ReceptorGridPrivate
+{
+    public:
+        ForceField *forceField;
+        const Molecule *receptor;
+        Point3 center;
+        Vector3 size;
+        Float spacing;
+        Float vanDerWaalsCutoff;
+        Float dielectric;
+        Float energyLimit;
+        int threadCount;
+        Point3 origin;
+        std::vector<int> dimensions;
+        std::vector<std::string> types;
+        std::vector<ScalarField *> vanDerWaalsMaps;
+        ScalarField *electrostaticMap;
+        std::vector<ForceFieldAtom *> ligandAtoms;
+        std::vector<int> ligandTypes;
+        std::string errorString;
+
+        std::vector<Float> vanDerWaalsEnergies(const ForceFieldAtom *a, ForceFieldAtom *b, const std::vector<Float> &distances) const;
+};
+
+// Returns the van der Waals energy between atoms a and b when they
+// are separated by each distance in distances. Atom b is moved to
+// each distance and then returned to its original position. Returns
+// an empty vector if the force field does not support the
+// interaction.
+std::vector<Float> ReceptorGridPrivate::vanDerWaalsEnergies(const ForceFieldAtom *a, ForceFieldAtom *b, const std::vector<Float> &distances) const
+{
+    std::vector<Float> energies;
+
+    ForceFieldCalculation *calculation = forceField->createPairCalculation(ForceFieldCalculation::VanDerWaals, a, b);
+    if(!calculation){
+        return energies;
+    }
+
+    Point3 position = b->position();
+
+    energies.reserve(distances.size());
+    foreach(Float distance, distances){
+        b->setPosition(a->position().movedBy(distance, 0, 0));
+        energies.push_back(calculation->energy());
+    }
+
+    b->setPosition(position);
+
+    delete calculation;
+
+    return energies;
+}
+
+// === ReceptorGrid ======================================================== //
+/// \class ReceptorGrid receptorgrid.h chemkit/receptorgrid.h
+/// \ingroup chemkit
+/// \brief The ReceptorGrid class scores ligands in a rigid receptor
+///        with precomputed grid maps.
+///
+/// The receptor grid contains a map of the van der Waals energy for
+/// each type of ligand atom and a map of the electrostatic potential
+/// of the receptor. The maps are calculated once at the points of a
+/// regular grid covering the binding site. The energy of a ligand
+/// pose is then the sum over the ligand atoms of the values of the
+/// maps interpolated at their positions. This makes the cost of
+/// scoring a pose proportional to the number of ligand atoms and
+/// independent of the size of the receptor.
+///
+/// The receptor and the ligand are added to a force field which
+/// provides the atom types, charges and van der Waals parameters.
+/// The maps are built for each atom type of the ligand atoms (the
+/// atoms in the force field which are not part of the receptor).
+/// Force fields must support ForceField::createPairCalculation() for
+/// the van der Waals interactions.
+///
+/// The following example shows how to score a ligand docked into a
+/// receptor:
+///
+/// \code
+/// ForceField *forceField = ForceField::create("mmff");
+/// forceField->addMolecule(receptor);
+/// forceField->addMolecule(ligand);
+/// forceField->setup();
+///
+/// ReceptorGrid grid(forceField, receptor);
+/// grid.setCenter(bindingSite);
+/// grid.setSize(Vector3(20, 20, 20));
+/// grid.build();
+///
+/// forceField->readCoordinates(ligand);
+/// Float energy = grid.energy();
+/// \endcode
+///
+/// \see ScalarField
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new receptor grid for the \p receptor in \p forceField.
+ReceptorGrid::ReceptorGrid(ForceField *forceField, const Molecule *receptor)
+    : d(new ReceptorGridPrivate)
+{
+    d->forceField = forceField;
+    d->receptor = receptor;
+    d->size = Vector3(20, 20, 20);
+    d->spacing = 0.375;
+    d->vanDerWaalsCutoff = 8.0;
+    d->dielectric = 1.0;
+    d->energyLimit = 1000.0;
+    d->threadCount = 0;
+    d->dimensions = std::vector<int>(3, 0);
+    d->electrostaticMap = 0;
+}
+
+/// Destroys the receptor grid.
+ReceptorGrid::~ReceptorGrid()
+{
+    clear();
+
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Sets the force field containing the receptor and the ligand to
+/// \p forceField. The force field must be setup before the grid is
+/// built.
+void ReceptorGrid::setForceField(ForceField *forceField)
+{
+    d->forceField = forceField;
+}
+
+/// Returns the force field containing the receptor and the ligand.
+ForceField* ReceptorGrid::forceField() const
+{
+    return d->forceField;
+}
+
+/// Sets the receptor molecule to \p receptor.
+void ReceptorGrid::setReceptor(const Molecule *receptor)
+{
+    d->receptor = receptor;
+}
+
+/// Returns the receptor molecule.
+const Molecule* ReceptorGrid::receptor() const
+{
+    return d->receptor;
+}
+
+/// Sets the center of the grid to \p center.
+void ReceptorGrid::setCenter(const Point3 &center)
+{
+    d->center = center;
+}
+
+/// Returns the center of the grid.
+Point3 ReceptorGrid::center() const
+{
+    return d->center;
+}
+
+/// Sets the size of the grid along each axis to \p size. The default
+/// size is 20 angstroms along each axis.
+void ReceptorGrid::setSize(const Vector3 &size)
+{
+    d->size = size;
+}
+
+/// Returns the size of the grid along each axis.
+Vector3 ReceptorGrid::size() const
+{
+    return d->size;
+}
+
+/// Sets the spacing between the points of the grid to \p spacing.
+/// The default spacing is 0.375 angstroms.
+void ReceptorGrid::setSpacing(Float spacing)
+{
+    d->spacing = spacing;
+}
+
+/// Returns the spacing between the points of the grid.
+Float ReceptorGrid::spacing() const
+{
+    return d->spacing;
+}
+
+/// Sets the cutoff distance for the van der Waals interactions to
+/// \p cutoff. The default cutoff is 8.0 angstroms.
+void ReceptorGrid::setVanDerWaalsCutoff(Float cutoff)
+{
+    d->vanDerWaalsCutoff = cutoff;
+}
+
+/// Returns the cutoff distance for the van der Waals interactions.
+Float ReceptorGrid::vanDerWaalsCutoff() const
+{
+    return d->vanDerWaalsCutoff;
+}
+
+/// Sets the dielectric constant used to calculate the electrostatic
+/// potential to \p dielectric. The default is 1.0.
+void ReceptorGrid::setDielectric(Float dielectric)
+{
+    d->dielectric = dielectric;
+}
+
+/// Returns the dielectric constant used to calculate the
+/// electrostatic potential.
+Float ReceptorGrid::dielectric() const
+{
+    return d->dielectric;
+}
+
+/// Sets the largest magnitude of the values in the maps to
+/// \p limit. Values at points very close to receptor atoms are
+/// truncated to the limit. The default limit is 1000 kcal/mol.
+void ReceptorGrid::setEnergyLimit(Float limit)
+{
+    d->energyLimit = limit;
+}
+
+/// Returns the largest magnitude of the values in the maps.
+Float ReceptorGrid::energyLimit() const
+{
+    return d->energyLimit;
+}
+
+/// Sets the number of threads used to build the maps to \p count.
+/// If \p count is \c 0 (the default) the ideal thread count for the
+/// system is used.
+void ReceptorGrid::setThreadCount(int count)
+{
+    d->threadCount = qMax(0, count);
+}
+
+/// Returns the number of threads used to build the maps. Returns
+/// \c 0 if the ideal thread count is used.
+int ReceptorGrid::threadCount() const
+{
+    return d->threadCount;
+}
+
+/// Returns the number of threads that will be used to build the
+/// maps.
+int ReceptorGrid::effectiveThreadCount() const
+{
+    if(d->threadCount == 0){
+        return qMax(1, QThread::idealThreadCount());
+    }
+
+    return d->threadCount;
+}
+
+// --- Maps ---------------------------------------------------------------- //
+/// Builds the maps. Returns \c false if an error occurs.
+///
+/// The van der Waals energy of each pair of ligand and receptor atom
+/// types is first tabulated with the pair calculations created by
+/// the force field. The values at the points of the grid are then
+/// calculated in parallel from the tables and the charges of the
+/// receptor atoms.
+bool ReceptorGrid::build()
+{
+    clear();
+
+    if(!d->forceField){
+        d->errorString = "No force field set.";
+        return false;
+    }
+    else if(!d->receptor){
+        d->errorString = "No receptor set.";
+        return false;
+    }
+    else if(d->spacing <= 0 || d->size.x() <= 0 || d->size.y() <= 0 || d->size.z() <= 0){
+        d->errorString = "Invalid grid size or spacing.";
+        return false;
+    }
+
+    // split the force field atoms into receptor and ligand atoms
+    std::vector<ForceFieldAtom *> receptorAtoms;
+    foreach(ForceFieldAtom *atom, d->forceField->atoms()){
+        if(atom->atom() && atom->atom()->molecule() == d->receptor){
+            receptorAtoms.push_back(atom);
+        }
+        else{
+            d->ligandAtoms.push_back(atom);
+        }
+    }
+
+    if(receptorAtoms.empty()){
+        d->errorString = "The force field does not contain the receptor.";
+        return false;
+    }
+    else if(d->ligandAtoms.empty()){
+        d->errorString = "The force field does not contain any ligand atoms.";
+        return false;
+    }
+
+    // ligand atom types and the first atom of each type
+    std::map<std::string, int> ligandTypeIndices;
+    std::vector<ForceFieldAtom *> ligandTypeAtoms;
+    foreach(ForceFieldAtom *atom, d->ligandAtoms){
+        std::map<std::string, int>::iterator iter = ligandTypeIndices.find(atom->type());
+        if(iter == ligandTypeIndices.end()){
+            iter = ligandTypeIndices.insert(std::make_pair(atom->type(), int(d->types.size()))).first;
+            d->types.push_back(atom->type());
+            ligandTypeAtoms.push_back(atom);
+        }
+
+        d->ligandTypes.push_back(iter->second);
+    }
+
+    // receptor atom types and the first atom of each type
+    std::map<std::string, int> receptorTypeIndices;
+    std::vector<ForceFieldAtom *> receptorTypeAtoms;
+    std::vector<int> receptorTypes;
+    std::vector<Point3> receptorPositions;
+    std::vector<Float> receptorCharges;
+    foreach(ForceFieldAtom *atom, receptorAtoms){
+        std::map<std::string, int>::iterator iter = receptorTypeIndices.find(atom->type());
+        if(iter == receptorTypeIndices.end()){
+            iter = receptorTypeIndices.insert(std::make_pair(atom->type(), int(receptorTypeAtoms.size()))).first;
+            receptorTypeAtoms.push_back(atom);
+        }
+
+        receptorTypes.push_back(iter->second);
+        receptorPositions.push_back(atom->position());
+        receptorCharges.push_back(atom->charge());
+    }
+
+    // tabulate the van der Waals energy of each pair of types. the
+    // first entry (at zero distance) is copied from the second.
+    int tableSize = static_cast<int>(std::ceil(d->vanDerWaalsCutoff / TableSpacing)) + 2;
+    std::vector<Float> distances;
+    for(int i = 1; i < tableSize; i++){
+        distances.push_back(i * TableSpacing);
+    }
+
+    std::vector<std::vector<std::vector<Float> > > tables(ligandTypeAtoms.size());
+    for(unsigned int i = 0; i < ligandTypeAtoms.size(); i++){
+        for(unsigned int j = 0; j < receptorTypeAtoms.size(); j++){
+            std::vector<Float> energies = d->vanDerWaalsEnergies(receptorTypeAtoms[j],
+                                                                 ligandTypeAtoms[i],
+                                                                 distances);
+            if(energies.empty()){
+                d->errorString = "Failed to calculate the van der Waals energy between the types '" +
+                                 ligandTypeAtoms[i]->type() + "' and '" + receptorTypeAtoms[j]->type() + "'.";
+                clear();
+                return false;
+            }
+
+            energies.insert(energies.begin(), energies.front());
+            for(unsigned int k = 0; k < energies.size(); k++){
+                energies[k] = qMin(energies[k], d->energyLimit);
+            }
+
+            tables[i].push_back(energies);
+        }
+    }
+
+    // grid dimensions
+    d->origin = d->center - d->size / 2.0;
+    for(int i = 0; i < 3; i++){
+        d->dimensions[i] = static_cast<int>(std::floor(d->size[i] / d->spacing)) + 1;
+    }
+
+    int pointCount = d->dimensions[0] * d->dimensions[1] * d->dimensions[2];
+
+    std::vector<std::vector<Float> > vanDerWaalsData(d->types.size(), std::vector<Float>(pointCount));
+    std::vector<Float> electrostaticData(pointCount);
+
+    // fill the grid in slabs of planes
+    int slabCount = qMin(d->dimensions[0], effectiveThreadCount());
+
+    std::vector<ReceptorGridSlab> slabs;
+    for(int i = 0; i < slabCount; i++){
+        ReceptorGridSlab slab;
+        slab.begin = (d->dimensions[0] * i) / slabCount;
+        slab.end = (d->dimensions[0] * (i + 1)) / slabCount;
+        slab.dimensions = &d->dimensions;
+        slab.origin = d->origin;
+        slab.spacing = d->spacing;
+        slab.cutoff = d->vanDerWaalsCutoff;
+        slab.electrostaticScale = CoulombConstant / d->dielectric;
+        slab.energyLimit = d->energyLimit;
+        slab.receptorPositions = &receptorPositions;
+        slab.receptorCharges = &receptorCharges;
+        slab.receptorTypes = &receptorTypes;
+        slab.tables = &tables;
+        slab.vanDerWaalsData = &vanDerWaalsData;
+        slab.electrostaticData = &electrostaticData;
+        slabs.push_back(slab);
+    }
+
+    if(slabs.size() == 1){
+        fillReceptorGridSlab(slabs[0]);
+    }
+    else{
+        QtConcurrent::blockingMap(slabs, fillReceptorGridSlab);
+    }
+
+    std::vector<Float> cellLengths(3, d->spacing);
+
+    for(unsigned int i = 0; i < d->types.size(); i++){
+        ScalarField *map = new ScalarField(d->dimensions, cellLengths, vanDerWaalsData[i]);
+        map->setOrigin(d->origin);
+        d->vanDerWaalsMaps.push_back(map);
+    }
+
+    d->electrostaticMap = new ScalarField(d->dimensions, cellLengths, electrostaticData);
+    d->electrostaticMap->setOrigin(d->origin);
+
+    return true;
+}
+
+/// Returns \c true if the maps have been built.
+bool ReceptorGrid::isBuilt() const
+{
+    return d->electrostaticMap != 0;
+}
+
+/// Removes the maps.
+void ReceptorGrid::clear()
+{
+    foreach(ScalarField *map, d->vanDerWaalsMaps){
+        delete map;
+    }
+    d->vanDerWaalsMaps.clear();
+
+    delete d->electrostaticMap;
+    d->electrostaticMap = 0;
+
+    d->types.clear();
+    d->ligandAtoms.clear();
+    d->ligandTypes.clear();
+    d->dimensions = std::vector<int>(3, 0);
+}
+
+/// Returns the ligand atom types which have a van der Waals map.
+std::vector<std::string> ReceptorGrid::types() const
+{
+    return d->types;
+}
+
+/// Returns the van der Waals map for ligand atoms of \p type.
+/// Returns \c 0 if there is no map for \p type.
+const ScalarField* ReceptorGrid::vanDerWaalsMap(const std::string &type) const
+{
+    for(unsigned int i = 0; i < d->types.size(); i++){
+        if(d->types[i] == type){
+            return d->vanDerWaalsMaps[i];
+        }
+    }
+
+    return 0;
+}
+
+/// Returns the map of the electrostatic potential of the receptor.
+/// The values are the energies of a unit positive charge in
+/// kcal/mol.
+const ScalarField* ReceptorGrid::electrostaticMap() const
+{
+    return d->electrostaticMap;
+}
+
+/// Returns the position of the first point of the grid.
+Point3 ReceptorGrid::origin() const
+{
+    return d->origin;
+}
+
+/// Returns the number of points along each axis of the grid.
+std::vector<int> ReceptorGrid::dimensions() const
+{
+    return d->dimensions;
+}
+
+/// Returns the number of points in the grid.
+int ReceptorGrid::pointCount() const
+{
+    return d->dimensions[0] * d->dimensions[1] * d->dimensions[2];
+}
+
+// --- Scoring ------------------------------------------------------------- //
+/// Returns the ligand atoms in the force field. These are all of
+/// the atoms which are not part of the receptor.
+std::vector<ForceFieldAtom *> ReceptorGrid::ligandAtoms() const
+{
+    return d->ligandAtoms;
+}
+
+/// Returns the number of ligand atoms in the force field.
+int ReceptorGrid::ligandAtomCount() const
+{
+    return d->ligandAtoms.size();
+}
+
+/// Returns the interaction energy between the receptor and the
+/// ligand atoms at their current positions in the force field.
+Float ReceptorGrid::energy() const
+{
+    std::vector<Point3> positions;
+    foreach(const ForceFieldAtom *atom, d->ligandAtoms){
+        positions.push_back(atom->position());
+    }
+
+    return energy(positions);
+}
+
+/// Returns the interaction energy between the receptor and the
+/// ligand atoms at \p positions. The positions are in the same
+/// order as the atoms returned by ligandAtoms(). Atoms outside of
+/// the grid do not contribute to the energy.
+Float ReceptorGrid::energy(const std::vector<Point3> &positions) const
+{
+    if(!isBuilt()){
+        return 0;
+    }
+
+    Float energy = 0;
+
+    for(unsigned int i = 0; i < d->ligandAtoms.size(); i++){
+        if(!contains(positions[i])){
+            continue;
+        }
+
+        Point3 position = positions[i] - d->origin;
+
+        energy += d->vanDerWaalsMaps[d->ligandTypes[i]]->value(position);
+        energy += d->ligandAtoms[i]->charge() * d->electrostaticMap->value(position);
+    }
+
+    return energy;
+}
+
+/// Returns the gradient of the interaction energy for each ligand
+/// atom at its current position in the force field.
+std::vector<Vector3> ReceptorGrid::gradient() const
+{
+    std::vector<Point3> positions;
+    foreach(const ForceFieldAtom *atom, d->ligandAtoms){
+        positions.push_back(atom->position());
+    }
+
+    return gradient(positions);
+}
+
+/// Returns the gradient of the interaction energy for each ligand
+/// atom at \p positions.
+std::vector<Vector3> ReceptorGrid::gradient(const std::vector<Point3> &positions) const
+{
+    std::vector<Vector3> gradient(d->ligandAtoms.size());
+
+    if(!isBuilt()){
+        return gradient;
+    }
+
+    for(unsigned int i = 0; i < d->ligandAtoms.size(); i++){
+        if(!contains(positions[i])){
+            continue;
+        }
+
+        Point3 position = positions[i] - d->origin;
+
+        // ScalarField::gradient() points towards decreasing values
+        gradient[i] = -(d->vanDerWaalsMaps[d->ligandTypes[i]]->gradient(position) +
+                        d->electrostaticMap->gradient(position) * d->ligandAtoms[i]->charge());
+    }
+
+    return gradient;
+}
+
+/// Returns \c true if \p position is inside the grid.
+bool ReceptorGrid::contains(const Point3 &position) const
+{
+    if(!isBuilt()){
+        return false;
+    }
+
+    for(int i = 0; i < 3; i++){
+        Float x = position[i] - d->origin[i];
+
+        if(x < 0 || x >= (d->dimensions[i] - 1) * d->spacing){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// --- Error Handling ------------------------------------------------------ //
+/// Returns a string describing the last error that occurred.
+std::string ReceptorGrid::errorString() const
+{
+    return d->errorString;
+}
+
+} // end chemkit namespace
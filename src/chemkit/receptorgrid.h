@@ -0,0 +1,112 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#ifndef CHEMKIT_RECEPTORGRID_H
+#define CHEMKIT_RECEPTORGRID_H
+
+#include "chemkit.h"
+
+#include <string>
+#include <vector>
+
+#include "point3.h"
+#include "vector3.h"
+
+namespace chemkit {
+
+class Molecule;
+class ForceField;
+class ScalarField;
+class ForceFieldAtom;
+class ReceptorGridPrivate;
+
+class CHEMKIT_EXPORT ReceptorGrid
+{
+    public:
+        // construction and destruction
+        ReceptorGrid(ForceField *forceField = 0, const Molecule *receptor = 0);
+        ~ReceptorGrid();
+
+        // properties
+        void setForceField(ForceField *forceField);
+        ForceField* forceField() const;
+        void setReceptor(const Molecule *receptor);
+        const Molecule* receptor() const;
+        void setCenter(const Point3 &center);
+        Point3 center() const;
+        void setSize(const Vector3 &size);
+        Vector3 size() const;
+        void setSpacing(Float spacing);
+        Float spacing() const;
+        void setVanDerWaalsCutoff(Float cutoff);
+        Float vanDerWaalsCutoff() const;
+        void setDielectric(Float dielectric);
+        Float dielectric() const;
+        void setEnergyLimit(Float limit);
+        Float energyLimit() const;
+        void setThreadCount(int count);
+        int threadCount() const;
+        int effectiveThreadCount() const;
+
+        // maps
+        bool build();
+        bool isBuilt() const;
+        void clear();
+        std::vector<std::string> types() const;
+        const ScalarField* vanDerWaalsMap(const std::string &type) const;
+        const ScalarField* electrostaticMap() const;
+        Point3 origin() const;
+        std::vector<int> dimensions() const;
+        int pointCount() const;
+
+        // scoring
+        std::vector<ForceFieldAtom *> ligandAtoms() const;
+        int ligandAtomCount() const;
+        Float energy() const;
+        Float energy(const std::vector<Point3> &positions) const;
+        std::vector<Vector3> gradient() const;
+        std::vector<Vector3> gradient(const std::vector<Point3> &positions) const;
+        bool contains(const Point3 &position) const;
+
+        // error handling
+        std::string errorString() const;
+
+    private:
+        ReceptorGridPrivate* const d;
+};
+
+} // end chemkit namespace
+
+#endif // CHEMKIT_RECEPTORGRID_H
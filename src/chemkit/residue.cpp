@@ -39,6 +39,7 @@
 #include <algorithm>
 
 #include "atom.h"
+#include "foreach.h"
 #include "molecule.h"
 
 namespace chemkit {
@@ -71,6 +72,12 @@ Residue::Residue(Molecule *molecule, int type)
 /// Destroys the residue.
 Residue::~Residue()
 {
+    foreach(Atom *atom, d->atoms){
+        if(atom->residue() == this){
+            atom->setResidue(0);
+        }
+    }
+
     delete d;
 }
 
@@ -108,6 +115,7 @@ void Residue::addAtom(Atom *atom)
     }
 
     d->atoms.push_back(atom);
+    atom->setResidue(this);
 }
 
 /// Removes an atom from the residue.
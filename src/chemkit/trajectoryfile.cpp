@@ -48,6 +48,8 @@ class TrajectoryFilePrivate
         std::string errorString;
         Trajectory *trajectory;
         TrajectoryFileFormat *format;
+        QIODevice *stream;
+        bool ownsStream;
 };
 
 // === TrajectoryFile ====================================================== //
@@ -58,6 +60,18 @@ class TrajectoryFilePrivate
 /// The following trajectory file formats are supported in chemkit:
 ///     - \c xtc
 ///
+/// Frames can also be streamed to a file one at a time without
+/// storing the whole trajectory in memory. For example, to write
+/// frames while they are being generated:
+/// \code
+/// TrajectoryFile file("output.xtc");
+/// file.beginWriting();
+/// while(simulating){
+///     file.writeFrame(frame);
+/// }
+/// file.endWriting();
+/// \endcode
+///
 /// \see Trajectory, TrajectoryFileFormat
 
 // --- Construction and Destruction ---------------------------------------- //
@@ -67,6 +81,8 @@ TrajectoryFile::TrajectoryFile()
 {
     d->trajectory = 0;
     d->format = 0;
+    d->stream = 0;
+    d->ownsStream = false;
 }
 
 /// Creates a new trajectory file with \p fileName.
@@ -76,11 +92,15 @@ TrajectoryFile::TrajectoryFile(const std::string &fileName)
     d->fileName = fileName;
     d->trajectory = 0;
     d->format = 0;
+    d->stream = 0;
+    d->ownsStream = false;
 }
 
 /// Destroys the trajectory file object.
 TrajectoryFile::~TrajectoryFile()
 {
+    endWriting();
+
     delete d->trajectory;
     delete d;
 }
@@ -251,6 +271,104 @@ bool TrajectoryFile::write(QIODevice *iodev, const std::string &format)
     return write(iodev);
 }
 
+// --- Streaming Output --------------------------------------------------- //
+/// Opens the file for streaming output.
+bool TrajectoryFile::beginWriting()
+{
+    if(d->fileName.empty()){
+        setErrorString("No file name set.");
+        return false;
+    }
+
+    return beginWriting(fileName());
+}
+
+/// Opens \p fileName for streaming output.
+bool TrajectoryFile::beginWriting(const std::string &fileName)
+{
+    std::string format = QFileInfo(fileName.c_str()).suffix().toStdString();
+
+    return beginWriting(fileName, format);
+}
+
+/// Opens \p fileName for streaming output using \p format. Any
+/// existing contents of the file are discarded.
+bool TrajectoryFile::beginWriting(const std::string &fileName, const std::string &format)
+{
+    QFile *file = new QFile(fileName.c_str());
+    if(!file->open(QIODevice::WriteOnly | QIODevice::Truncate)){
+        setErrorString(QString("Failed to open '%1' for writing: %2").arg(fileName.c_str()).arg(file->errorString()).toStdString());
+        delete file;
+        return false;
+    }
+
+    if(!beginWriting(file, format)){
+        delete file;
+        return false;
+    }
+
+    d->ownsStream = true;
+    return true;
+}
+
+/// Begins streaming output to \p iodev using \p format. The device
+/// must already be open for writing and remains owned by the caller.
+bool TrajectoryFile::beginWriting(QIODevice *iodev, const std::string &format)
+{
+    endWriting();
+
+    if(!d->format || d->format->name() != format){
+        d->format = TrajectoryFileFormat::create(format);
+        if(!d->format){
+            setErrorString(QString("Format '%1' is not supported").arg(format.c_str()).toStdString());
+            return false;
+        }
+    }
+
+    d->stream = iodev;
+    d->ownsStream = false;
+    return true;
+}
+
+/// Appends \p frame to the file opened with beginWriting(). The
+/// frame does not need to belong to the file's trajectory.
+bool TrajectoryFile::writeFrame(const TrajectoryFrame *frame)
+{
+    if(!d->stream){
+        setErrorString("File is not open for writing.");
+        return false;
+    }
+
+    bool ok = d->format->writeFrame(frame, d->stream);
+    if(!ok){
+        setErrorString(d->format->errorString());
+    }
+
+    return ok;
+}
+
+/// Finishes streaming output and closes the file.
+void TrajectoryFile::endWriting()
+{
+    if(!d->stream){
+        return;
+    }
+
+    if(d->ownsStream){
+        d->stream->close();
+        delete d->stream;
+    }
+
+    d->stream = 0;
+    d->ownsStream = false;
+}
+
+/// Returns \c true if the file is open for streaming output.
+bool TrajectoryFile::isWriting() const
+{
+    return d->stream != 0;
+}
+
 // --- Error Handling ------------------------------------------------------ //
 /// Sets a string describing the last error that occurred.
 void TrajectoryFile::setErrorString(const std::string &errorString)
@@ -46,6 +46,7 @@
 namespace chemkit {
 
 class Trajectory;
+class TrajectoryFrame;
 class TrajectoryFilePrivate;
 
 class CHEMKIT_EXPORT TrajectoryFile
@@ -78,6 +79,15 @@ class CHEMKIT_EXPORT TrajectoryFile
         bool write(QIODevice *iodev);
         bool write(QIODevice *iodev, const std::string &format);
 
+        // streaming output
+        bool beginWriting();
+        bool beginWriting(const std::string &fileName);
+        bool beginWriting(const std::string &fileName, const std::string &format);
+        bool beginWriting(QIODevice *iodev, const std::string &format);
+        bool writeFrame(const TrajectoryFrame *frame);
+        void endWriting();
+        bool isWriting() const;
+
         // error handling
         std::string errorString() const;
 
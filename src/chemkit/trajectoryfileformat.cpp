@@ -35,7 +35,10 @@
 
 #include "trajectoryfileformat.h"
 
+#include "foreach.h"
+#include "trajectory.h"
 #include "pluginmanager.h"
+#include "trajectoryfile.h"
 
 namespace chemkit {
 
@@ -85,9 +88,33 @@ bool TrajectoryFileFormat::read(QIODevice *iodev, TrajectoryFile *file)
 }
 
 /// Writes a trajectory file from \p file to \p iodev.
+///
+/// The default implementation writes each frame in the trajectory
+/// with writeFrame().
 bool TrajectoryFileFormat::write(const TrajectoryFile *file, QIODevice *iodev)
 {
-    Q_UNUSED(file);
+    const Trajectory *trajectory = file->trajectory();
+    if(!trajectory){
+        setErrorString("File does not contain a trajectory.");
+        return false;
+    }
+
+    foreach(const TrajectoryFrame *frame, trajectory->frames()){
+        if(!writeFrame(frame, iodev)){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/// Appends a single \p frame to \p iodev.
+///
+/// Formats that implement this method can be used to stream frames
+/// to a file as they are generated (see TrajectoryFile::writeFrame()).
+bool TrajectoryFileFormat::writeFrame(const TrajectoryFrame *frame, QIODevice *iodev)
+{
+    Q_UNUSED(frame);
     Q_UNUSED(iodev);
 
     setErrorString(QString("'%1' writing not supported.").arg(name().c_str()).toStdString());
@@ -43,6 +43,7 @@
 namespace chemkit {
 
 class TrajectoryFile;
+class TrajectoryFrame;
 class TrajectoryFileFormatPrivate;
 
 class CHEMKIT_EXPORT TrajectoryFileFormat
@@ -60,6 +61,7 @@ class CHEMKIT_EXPORT TrajectoryFileFormat
         // input and output
         virtual bool read(QIODevice *iodev, TrajectoryFile *file);
         virtual bool write(const TrajectoryFile *file, QIODevice *iodev);
+        virtual bool writeFrame(const TrajectoryFrame *frame, QIODevice *iodev);
 
         // error handling
         std::string errorString() const;
@@ -51,6 +51,8 @@ class TrajectoryFramePrivate
         Trajectory *trajectory;
         Coordinates *coordinates;
         UnitCell *unitCell;
+        int step;
+        Float time;
 };
 
 // === TrajectoryFrame ===================================================== //
@@ -71,6 +73,8 @@ TrajectoryFrame::TrajectoryFrame(Trajectory *trajectory)
     d->trajectory = trajectory;
     d->coordinates = 0;
     d->unitCell = 0;
+    d->step = 0;
+    d->time = 0;
 }
 
 /// Destroys the trajectory frame object.
@@ -108,6 +112,31 @@ Trajectory* TrajectoryFrame::trajectory() const
     return d->trajectory;
 }
 
+/// Sets the simulation step number for the frame to \p step.
+void TrajectoryFrame::setStep(int step)
+{
+    d->step = step;
+}
+
+/// Returns the simulation step number for the frame.
+int TrajectoryFrame::step() const
+{
+    return d->step;
+}
+
+/// Sets the simulation time for the frame to \p time. The time is
+/// in picoseconds.
+void TrajectoryFrame::setTime(Float time)
+{
+    d->time = time;
+}
+
+/// Returns the simulation time for the frame in picoseconds.
+Float TrajectoryFrame::time() const
+{
+    return d->time;
+}
+
 // --- Coordinates --------------------------------------------------------- //
 /// Sets the coordinates for the frame to \p coordinates.
 void TrajectoryFrame::setCoordinates(const Coordinates *coordinates)
@@ -135,9 +164,15 @@ Point3 TrajectoryFrame::position(int index) const
 }
 
 // --- Unit Cell ----------------------------------------------------------- //
-/// Sets the unit cell for the frame to \p cell.
+/// Sets the unit cell for the frame to \p cell. The frame takes
+/// ownership of the cell and deletes the previous one.
 void TrajectoryFrame::setUnitCell(UnitCell *cell)
 {
+    if(cell == d->unitCell){
+        return;
+    }
+
+    delete d->unitCell;
     d->unitCell = cell;
 }
 
@@ -55,6 +55,10 @@ class CHEMKIT_EXPORT TrajectoryFrame
         bool isEmpty() const;
         int index() const;
         Trajectory* trajectory() const;
+        void setStep(int step);
+        int step() const;
+        void setTime(Float time);
+        Float time() const;
 
         // coordinates
         void setCoordinates(const Coordinates *coordinates);
@@ -35,17 +35,88 @@
 
 #include "unitcell.h"
 
+#include <cmath>
+
+#include "staticmatrix.h"
+
 namespace chemkit {
 
 // === UnitCellPrivate ===================================================== //
 class UnitCellPrivate
 {
     public:
+        void initialize();
+
         Vector3 x;
         Vector3 y;
         Vector3 z;
+        bool periodic;
+        bool orthorhombic;
+        Vector3 reduced[3];
+        Float inverse[3][3];
 };
 
+// Precomputes a reduced basis for the lattice along with the inverse
+// of its matrix which converts cartesian vectors into fractional
+// coordinates. The reduced basis spans the same lattice as the cell
+// vectors but is as short and orthogonal as possible which allows
+// the minimum image of a vector to be found by only searching the
+// neighboring cells.
+void UnitCellPrivate::initialize()
+{
+    orthorhombic = x[1] == 0 && x[2] == 0 &&
+                   y[0] == 0 && y[2] == 0 &&
+                   z[0] == 0 && z[1] == 0;
+
+    periodic = x.dot(y.cross(z)) != 0;
+
+    if(!periodic || orthorhombic){
+        return;
+    }
+
+    reduced[0] = x;
+    reduced[1] = y;
+    reduced[2] = z;
+
+    // repeatedly shorten each vector by integer multiples of the
+    // others until no vector can be made any shorter
+    bool changed = true;
+    while(changed){
+        changed = false;
+
+        for(int i = 0; i < 3; i++){
+            for(int j = 0; j < 3; j++){
+                if(i == j){
+                    continue;
+                }
+
+                Float k = std::floor(reduced[i].dot(reduced[j]) / reduced[j].lengthSquared() + 0.5);
+                if(k != 0){
+                    Vector3 shortened = reduced[i] - reduced[j] * k;
+
+                    if(shortened.lengthSquared() < reduced[i].lengthSquared()){
+                        reduced[i] = shortened;
+                        changed = true;
+                    }
+                }
+            }
+        }
+    }
+
+    // the rows of the inverse are the reciprocal vectors
+    Float determinant = reduced[0].dot(reduced[1].cross(reduced[2]));
+
+    Vector3 a = reduced[1].cross(reduced[2]) / determinant;
+    Vector3 b = reduced[2].cross(reduced[0]) / determinant;
+    Vector3 c = reduced[0].cross(reduced[1]) / determinant;
+
+    for(int i = 0; i < 3; i++){
+        inverse[0][i] = a[i];
+        inverse[1][i] = b[i];
+        inverse[2][i] = c[i];
+    }
+}
+
 // === UnitCell ============================================================ //
 /// \class UnitCell unitcell.h chemkit/unitcell.h
 /// \ingroup chemkit
@@ -56,6 +127,7 @@ class UnitCellPrivate
 UnitCell::UnitCell()
     : d(new UnitCellPrivate)
 {
+    d->initialize();
 }
 
 /// Creates a new unit cell with \p x, \p y, and \p z.
@@ -65,6 +137,7 @@ UnitCell::UnitCell(const Vector3 &x, const Vector3 &y, const Vector3 &z)
     d->x = x;
     d->y = y;
     d->z = z;
+    d->initialize();
 }
 
 /// Destroys the unit cell object.
@@ -92,4 +165,108 @@ const Vector3& UnitCell::z() const
     return d->z;
 }
 
+/// Returns the volume of the unit cell.
+Float UnitCell::volume() const
+{
+    return std::abs(d->x.dot(d->y.cross(d->z)));
+}
+
+/// Returns \c true if the unit cell vectors are aligned with the x,
+/// y, and z axes.
+bool UnitCell::isOrthorhombic() const
+{
+    return d->orthorhombic;
+}
+
+// --- Geometry ------------------------------------------------------------ //
+/// Returns the periodic image of \p position that lies inside the
+/// unit cell. The cell is spanned by the x, y, and z vectors with
+/// its origin at (0, 0, 0).
+Point3 UnitCell::wrap(const Point3 &position) const
+{
+    StaticMatrix<Float, 3, 3> cell;
+    for(int i = 0; i < 3; i++){
+        cell(i, 0) = d->x[i];
+        cell(i, 1) = d->y[i];
+        cell(i, 2) = d->z[i];
+    }
+
+    // fractional coordinates of the position
+    StaticVector<Float, 3> fractional = cell.inverted().multiply(position);
+    for(int i = 0; i < 3; i++){
+        fractional[i] -= std::floor(fractional[i]);
+    }
+
+    return cell.multiply(fractional);
+}
+
+/// Returns the shortest periodic image of \p vector. This is used
+/// to apply the minimum image convention to the displacement vector
+/// between two positions. If the unit cell has no volume \p vector
+/// is returned unchanged.
+Vector3 UnitCell::minimumImage(const Vector3 &vector) const
+{
+    if(!d->periodic){
+        return vector;
+    }
+
+    if(d->orthorhombic){
+        Float lengths[3] = { d->x[0], d->y[1], d->z[2] };
+
+        Vector3 image = vector;
+        for(int i = 0; i < 3; i++){
+            image[i] -= lengths[i] * std::floor(image[i] / lengths[i] + 0.5);
+        }
+
+        return image;
+    }
+
+    // fractional coordinates of the vector shifted into [-0.5, 0.5)
+    Float fractional[3];
+    for(int i = 0; i < 3; i++){
+        fractional[i] = d->inverse[i][0] * vector[0] +
+                        d->inverse[i][1] * vector[1] +
+                        d->inverse[i][2] * vector[2];
+        fractional[i] -= std::floor(fractional[i] + 0.5);
+    }
+
+    const Vector3 *basis = d->reduced;
+    Vector3 image = basis[0] * fractional[0] + basis[1] * fractional[1] + basis[2] * fractional[2];
+
+    // for skewed cells the shortest image may be in one of the
+    // neighboring cells
+    Vector3 shortest = image;
+    Float shortestLength = image.lengthSquared();
+
+    for(int i = -1; i <= 1; i++){
+        for(int j = -1; j <= 1; j++){
+            for(int k = -1; k <= 1; k++){
+                Vector3 candidate = image + basis[0] * Float(i) + basis[1] * Float(j) + basis[2] * Float(k);
+                Float length = candidate.lengthSquared();
+
+                if(length < shortestLength){
+                    shortest = candidate;
+                    shortestLength = length;
+                }
+            }
+        }
+    }
+
+    return shortest;
+}
+
+/// Returns the periodic image of \p position which is closest to
+/// \p reference.
+Point3 UnitCell::image(const Point3 &position, const Point3 &reference) const
+{
+    return reference + minimumImage(position - reference);
+}
+
+/// Returns the distance between \p a and the closest periodic image
+/// of \p b.
+Float UnitCell::distance(const Point3 &a, const Point3 &b) const
+{
+    return minimumImage(b - a).length();
+}
+
 } // end chemkit namespace
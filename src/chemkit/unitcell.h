@@ -38,6 +38,7 @@
 
 #include "chemkit.h"
 
+#include "point3.h"
 #include "vector3.h"
 
 namespace chemkit {
@@ -56,6 +57,14 @@ class CHEMKIT_EXPORT UnitCell
         const Vector3& x() const;
         const Vector3& y() const;
         const Vector3& z() const;
+        Float volume() const;
+        bool isOrthorhombic() const;
+
+        // geometry
+        Point3 wrap(const Point3 &position) const;
+        Vector3 minimumImage(const Vector3 &vector) const;
+        Point3 image(const Point3 &position, const Point3 &reference) const;
+        Float distance(const Point3 &a, const Point3 &b) const;
 
     private:
         UnitCellPrivate* const d;
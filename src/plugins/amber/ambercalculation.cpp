@@ -139,8 +139,8 @@ chemkit::Float AmberAngleCalculation::energy() const
     const chemkit::ForceFieldAtom *c = atom(2);
 
     chemkit::Float ka = parameter(0);
-    chemkit::Float theta0 = parameter(1);
-    chemkit::Float theta = bondAngle(a, b, c);
+    chemkit::Float theta0 = parameter(1) * chemkit::constants::DegreesToRadians;
+    chemkit::Float theta = bondAngleRadians(a, b, c);
     chemkit::Float dt = theta - theta0;
 
     return ka * (dt*dt);
@@ -153,13 +153,13 @@ std::vector<chemkit::Vector3> AmberAngleCalculation::gradient() const
     const chemkit::ForceFieldAtom *c = atom(2);
 
     chemkit::Float ka = parameter(0);
-    chemkit::Float theta0 = parameter(1);
-    chemkit::Float theta = bondAngle(a, b, c);
+    chemkit::Float theta0 = parameter(1) * chemkit::constants::DegreesToRadians;
+    chemkit::Float theta = bondAngleRadians(a, b, c);
 
     // dE/dtheta
     chemkit::Float de_dtheta = 2.0 * ka * (theta - theta0);
 
-    std::vector<chemkit::Vector3> gradient = bondAngleGradient(a, b, c);
+    std::vector<chemkit::Vector3> gradient = bondAngleGradientRadians(a, b, c);
 
     gradient[0] *= de_dtheta;
     gradient[1] *= de_dtheta;
@@ -268,16 +268,93 @@ std::vector<chemkit::Vector3> AmberTorsionCalculation::gradient() const
     return gradient;
 }
 
-// === AmberNonbondedCalculation =========================================== //
-AmberNonbondedCalculation::AmberNonbondedCalculation(const chemkit::ForceFieldAtom *a,
-                                                     const chemkit::ForceFieldAtom *b)
-    : AmberCalculation(VanDerWaals | Electrostatic, 2, 2)
+// === AmberImproperTorsionCalculation ===================================== //
+// The improper torsion keeps the central atom c and its three
+// neighbors a, b and d planar.
+AmberImproperTorsionCalculation::AmberImproperTorsionCalculation(const chemkit::ForceFieldAtom *a,
+                                                                 const chemkit::ForceFieldAtom *b,
+                                                                 const chemkit::ForceFieldAtom *c,
+                                                                 const chemkit::ForceFieldAtom *d)
+    : AmberCalculation(Inversion, 4, 3)
 {
     setAtom(0, a);
     setAtom(1, b);
+    setAtom(2, c);
+    setAtom(3, d);
 }
 
-bool AmberNonbondedCalculation::setup(const AmberParameters *parameters)
+bool AmberImproperTorsionCalculation::setup(const AmberParameters *parameters)
+{
+    const chemkit::ForceFieldAtom *a = atom(0);
+    const chemkit::ForceFieldAtom *b = atom(1);
+    const chemkit::ForceFieldAtom *c = atom(2);
+    const chemkit::ForceFieldAtom *d = atom(3);
+
+    const AmberImproperTorsionParameters *improperParameters = parameters->improperTorsionParameters(a, b, c, d);
+    if(!improperParameters){
+        return false;
+    }
+
+    setParameter(0, improperParameters->V);
+    setParameter(1, improperParameters->gamma);
+    setParameter(2, improperParameters->n);
+
+    return true;
+}
+
+chemkit::Float AmberImproperTorsionCalculation::energy() const
+{
+    const chemkit::ForceFieldAtom *a = atom(0);
+    const chemkit::ForceFieldAtom *b = atom(1);
+    const chemkit::ForceFieldAtom *c = atom(2);
+    const chemkit::ForceFieldAtom *d = atom(3);
+
+    chemkit::Float V = parameter(0);
+    chemkit::Float gamma = parameter(1);
+    chemkit::Float n = parameter(2);
+
+    chemkit::Float phi = torsionAngle(a, b, c, d);
+
+    return V * (1.0 + cos((n * phi - gamma) * chemkit::constants::DegreesToRadians));
+}
+
+std::vector<chemkit::Vector3> AmberImproperTorsionCalculation::gradient() const
+{
+    const chemkit::ForceFieldAtom *a = atom(0);
+    const chemkit::ForceFieldAtom *b = atom(1);
+    const chemkit::ForceFieldAtom *c = atom(2);
+    const chemkit::ForceFieldAtom *d = atom(3);
+
+    chemkit::Float V = parameter(0);
+    chemkit::Float gamma = parameter(1);
+    chemkit::Float n = parameter(2);
+
+    chemkit::Float phi = torsionAngle(a, b, c, d);
+
+    // dE/dphi
+    chemkit::Float de_dphi = -V * n * sin((n * phi - gamma) * chemkit::constants::DegreesToRadians);
+    de_dphi *= chemkit::constants::DegreesToRadians;
+
+    std::vector<chemkit::Vector3> gradient = torsionAngleGradient(a, b, c, d);
+
+    gradient[0] *= de_dphi;
+    gradient[1] *= de_dphi;
+    gradient[2] *= de_dphi;
+    gradient[3] *= de_dphi;
+
+    return gradient;
+}
+
+// === AmberVanDerWaalsCalculation ======================================== //
+AmberVanDerWaalsCalculation::AmberVanDerWaalsCalculation(const chemkit::ForceFieldAtom *a,
+                                                         const chemkit::ForceFieldAtom *b)
+    : AmberCalculation(VanDerWaals, 2, 3)
+{
+    setAtom(0, a);
+    setAtom(1, b);
+}
+
+bool AmberVanDerWaalsCalculation::setup(const AmberParameters *parameters)
 {
     const chemkit::ForceFieldAtom *a = atom(0);
     const chemkit::ForceFieldAtom *b = atom(1);
@@ -288,48 +365,107 @@ bool AmberNonbondedCalculation::setup(const AmberParameters *parameters)
         return false;
     }
 
-    chemkit::Float epsilon = parametersA->wellDepth + parametersB->wellDepth;
+    chemkit::Float epsilon = sqrt(parametersA->wellDepth * parametersB->wellDepth);
     chemkit::Float sigma = parametersA->vanDerWaalsRadius + parametersB->vanDerWaalsRadius;
 
     setParameter(0, epsilon);
     setParameter(1, sigma);
 
+    // 1-4 interactions are scaled by 1/2
+    if(a->isOneFour(b)){
+        setParameter(2, 0.5);
+    }
+    else{
+        setParameter(2, 1.0);
+    }
+
     return true;
 }
 
-chemkit::Float AmberNonbondedCalculation::energy() const
+chemkit::Float AmberVanDerWaalsCalculation::energy() const
 {
     const chemkit::ForceFieldAtom *a = atom(0);
     const chemkit::ForceFieldAtom *b = atom(1);
 
     chemkit::Float epsilon = parameter(0);
     chemkit::Float sigma = parameter(1);
+    chemkit::Float scale = parameter(2);
     chemkit::Float r = distance(a, b);
-    chemkit::Float e0 = 1;
-
-    chemkit::Float vanDerWaalsTerm = epsilon * (pow(sigma/r, 12) - 2 * pow(sigma/r, 6));
-    chemkit::Float electrostaticTerm = (a->charge() * b->charge()) / (4.0 * chemkit::constants::Pi * e0 * r);
 
-    return vanDerWaalsTerm + electrostaticTerm;
+    return scale * epsilon * (pow(sigma/r, 12) - 2 * pow(sigma/r, 6));
 }
 
-std::vector<chemkit::Vector3> AmberNonbondedCalculation::gradient() const
+std::vector<chemkit::Vector3> AmberVanDerWaalsCalculation::gradient() const
 {
     const chemkit::ForceFieldAtom *a = atom(0);
     const chemkit::ForceFieldAtom *b = atom(1);
 
     chemkit::Float epsilon = parameter(0);
     chemkit::Float sigma = parameter(1);
-    chemkit::Float qa = a->charge();
-    chemkit::Float qb = b->charge();
-    chemkit::Float e0 = 1;
-    chemkit::Float pi = chemkit::constants::Pi;
+    chemkit::Float scale = parameter(2);
 
     chemkit::Float r = distance(a, b);
     chemkit::Float sr = sigma / r;
 
     // dE/dr
-    chemkit::Float de_dr = (-12 * epsilon * sigma / pow(r, 2) * (pow(sr, 11) - pow(sr, 5))) - ((qa * qb) / (4.0 * pi * e0 * pow(r, 2)));
+    chemkit::Float de_dr = -12 * scale * epsilon * sigma / pow(r, 2) * (pow(sr, 11) - pow(sr, 5));
+
+    std::vector<chemkit::Vector3> gradient = distanceGradient(a, b);
+
+    gradient[0] *= de_dr;
+    gradient[1] *= de_dr;
+
+    return gradient;
+}
+
+// === AmberElectrostaticCalculation ======================================= //
+AmberElectrostaticCalculation::AmberElectrostaticCalculation(const chemkit::ForceFieldAtom *a,
+                                                             const chemkit::ForceFieldAtom *b)
+    : AmberCalculation(Electrostatic, 2, 1)
+{
+    setAtom(0, a);
+    setAtom(1, b);
+}
+
+bool AmberElectrostaticCalculation::setup(const AmberParameters *parameters)
+{
+    Q_UNUSED(parameters);
+
+    const chemkit::ForceFieldAtom *a = atom(0);
+    const chemkit::ForceFieldAtom *b = atom(1);
+
+    // 1-4 interactions are scaled by 1/1.2
+    if(a->isOneFour(b)){
+        setParameter(0, 1.0 / 1.2);
+    }
+    else{
+        setParameter(0, 1.0);
+    }
+
+    return true;
+}
+
+chemkit::Float AmberElectrostaticCalculation::energy() const
+{
+    const chemkit::ForceFieldAtom *a = atom(0);
+    const chemkit::ForceFieldAtom *b = atom(1);
+
+    chemkit::Float scale = parameter(0);
+    chemkit::Float r = distance(a, b);
+
+    return scale * (332.0522 * a->charge() * b->charge()) / r;
+}
+
+std::vector<chemkit::Vector3> AmberElectrostaticCalculation::gradient() const
+{
+    const chemkit::ForceFieldAtom *a = atom(0);
+    const chemkit::ForceFieldAtom *b = atom(1);
+
+    chemkit::Float scale = parameter(0);
+    chemkit::Float r = distance(a, b);
+
+    // dE/dr
+    chemkit::Float de_dr = -scale * 332.0522 * a->charge() * b->charge() / pow(r, 2);
 
     std::vector<chemkit::Vector3> gradient = distanceGradient(a, b);
 
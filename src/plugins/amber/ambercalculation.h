@@ -81,10 +81,30 @@ class AmberTorsionCalculation : public AmberCalculation
         std::vector<chemkit::Vector3> gradient() const;
 };
 
-class AmberNonbondedCalculation : public AmberCalculation
+class AmberImproperTorsionCalculation : public AmberCalculation
 {
     public:
-        AmberNonbondedCalculation(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b);
+        AmberImproperTorsionCalculation(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b, const chemkit::ForceFieldAtom *c, const chemkit::ForceFieldAtom *d);
+
+        bool setup(const AmberParameters *parameters);
+        chemkit::Float energy() const;
+        std::vector<chemkit::Vector3> gradient() const;
+};
+
+class AmberVanDerWaalsCalculation : public AmberCalculation
+{
+    public:
+        AmberVanDerWaalsCalculation(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b);
+
+        bool setup(const AmberParameters *parameters);
+        chemkit::Float energy() const;
+        std::vector<chemkit::Vector3> gradient() const;
+};
+
+class AmberElectrostaticCalculation : public AmberCalculation
+{
+    public:
+        AmberElectrostaticCalculation(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b);
 
         bool setup(const AmberParameters *parameters);
         chemkit::Float energy() const;
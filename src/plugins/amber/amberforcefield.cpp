@@ -41,10 +41,28 @@
 #include "amberparameters.h"
 #include "ambercalculation.h"
 
+#include <algorithm>
+
 #include <chemkit/atom.h>
 #include <chemkit/molecule.h>
+#include <chemkit/aminoacid.h>
 #include <chemkit/forcefieldinteractions.h>
 
+namespace {
+
+// Returns true if the type of a sorts before the type of b. Atoms
+// with the same type are sorted by their index.
+bool improperTorsionAtomLessThan(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b)
+{
+    if(a->type() != b->type()){
+        return a->type() < b->type();
+    }
+
+    return a->atom()->index() < b->atom()->index();
+}
+
+} // end anonymous namespace
+
 // --- Construction and Destruction ---------------------------------------- //
 AmberForceField::AmberForceField()
     : chemkit::ForceField("amber")
@@ -62,66 +80,144 @@ AmberForceField::~AmberForceField()
 // --- Setup --------------------------------------------------------------- //
 bool AmberForceField::setup()
 {
-    foreach(const chemkit::Molecule *molecule, molecules()){
-        // add atoms
-        foreach(const chemkit::Atom *atom, molecule->atoms()){
-            chemkit::ForceFieldAtom *forceFieldAtom = new chemkit::ForceFieldAtom(this, atom);
-            forceFieldAtom->setType(atomType(atom));
-            addAtom(forceFieldAtom);
-        }
+    const std::vector<const chemkit::Molecule *> molecules = this->molecules();
 
-        chemkit::ForceFieldInteractions interactions(molecule, this);
+    // type and enumerate the calculations for each molecule in parallel
+    std::vector<std::vector<chemkit::ForceFieldAtom *> > moleculeAtoms;
+    std::vector<std::vector<chemkit::ForceFieldCalculation *> > moleculeCalculations;
+    bool ok = setupMolecules(molecules, moleculeAtoms, moleculeCalculations);
 
-        // add bond calculations
-        std::pair<const chemkit::ForceFieldAtom *, const chemkit::ForceFieldAtom *> bondedPair;
-        foreach(bondedPair, interactions.bondedPairs()){
-            addCalculation(new AmberBondCalculation(bondedPair.first,
-                                                    bondedPair.second));
+    // add atoms and calculations in molecule order
+    for(unsigned int i = 0; i < molecules.size(); i++){
+        foreach(chemkit::ForceFieldAtom *atom, moleculeAtoms[i]){
+            addAtom(atom);
         }
-
-        // add angle calculations
-        std::vector<const chemkit::ForceFieldAtom *> angleGroup;
-        foreach(angleGroup, interactions.angleGroups()){
-            addCalculation(new AmberAngleCalculation(angleGroup[0],
-                                                     angleGroup[1],
-                                                     angleGroup[2]));
+        foreach(chemkit::ForceFieldCalculation *calculation, moleculeCalculations[i]){
+            addCalculation(calculation);
         }
+    }
+
+    if(!setupCalculations(calculations())){
+        ok = false;
+    }
+
+    return ok;
+}
 
-        // add torsion calculations
-        std::vector<const chemkit::ForceFieldAtom *> torsionGroup;
-        foreach(torsionGroup, interactions.torsionGroups()){
-            addCalculation(new AmberTorsionCalculation(torsionGroup[0],
-                                                       torsionGroup[1],
-                                                       torsionGroup[2],
-                                                       torsionGroup[3]));
+const AmberParameters* AmberForceField::parameters() const
+{
+    return m_parameters;
+}
+
+// Creates the atoms and calculations for molecule. This is called
+// for several molecules at once from different threads and so only
+// modifies the atoms and calculations passed to it.
+bool AmberForceField::setupMolecule(const chemkit::Molecule *molecule,
+                                    std::vector<chemkit::ForceFieldAtom *> &atoms,
+                                    std::vector<chemkit::ForceFieldCalculation *> &calculations)
+{
+    // add atoms. atoms in residues with a template (e.g. the amino
+    // acids in a protein read from a PDB file) are typed and charged
+    // from the template by their atom name. the template for each
+    // residue is found once and shared by all of its atoms.
+    QHash<const chemkit::Residue *, const AmberResidueTemplate *> residueTemplates;
+
+    atoms.reserve(molecule->atomCount());
+    foreach(const chemkit::Atom *atom, molecule->atoms()){
+        chemkit::ForceFieldAtom *forceFieldAtom = new chemkit::ForceFieldAtom(this, atom);
+
+        const AmberResidueAtomParameters *parameters = 0;
+        const chemkit::Residue *residue = atom->residue();
+        if(residue){
+            const AmberResidueTemplate *atomTemplate = 0;
+            if(residueTemplates.contains(residue)){
+                atomTemplate = residueTemplates.value(residue);
+            }
+            else{
+                atomTemplate = residueTemplate(residue);
+                residueTemplates.insert(residue, atomTemplate);
+            }
+
+            if(atomTemplate){
+                parameters = atomTemplate->atomParameters(residue->atomType(atom));
+            }
         }
 
-        // add nonbonded calculations
-        std::pair<const chemkit::ForceFieldAtom *, const chemkit::ForceFieldAtom *> nonbondedPair;
-        foreach(nonbondedPair, interactions.nonbondedPairs()){
-            addCalculation(new AmberNonbondedCalculation(nonbondedPair.first,
-                                                         nonbondedPair.second));
+        if(parameters){
+            forceFieldAtom->setType(parameters->type);
+            forceFieldAtom->setCharge(parameters->charge);
+        }
+        else{
+            forceFieldAtom->setType(atomType(atom));
         }
+
+        atoms.push_back(forceFieldAtom);
     }
 
-    bool ok = true;
+    chemkit::ForceFieldInteractions interactions(molecule, atoms);
 
-    foreach(chemkit::ForceFieldCalculation *calculation, calculations()){
-        bool setup = static_cast<AmberCalculation *>(calculation)->setup(m_parameters);
+    // add bond calculations
+    std::pair<const chemkit::ForceFieldAtom *, const chemkit::ForceFieldAtom *> bondedPair;
+    foreach(bondedPair, interactions.bondedPairs()){
+        calculations.push_back(new AmberBondCalculation(bondedPair.first,
+                                                        bondedPair.second));
+    }
 
-        if(!setup){
-            ok = false;
+    // add angle calculations
+    std::vector<const chemkit::ForceFieldAtom *> angleGroup;
+    foreach(angleGroup, interactions.angleGroups()){
+        calculations.push_back(new AmberAngleCalculation(angleGroup[0],
+                                                         angleGroup[1],
+                                                         angleGroup[2]));
+    }
+
+    // add torsion calculations
+    std::vector<const chemkit::ForceFieldAtom *> torsionGroup;
+    foreach(torsionGroup, interactions.torsionGroups()){
+        calculations.push_back(new AmberTorsionCalculation(torsionGroup[0],
+                                                           torsionGroup[1],
+                                                           torsionGroup[2],
+                                                           torsionGroup[3]));
+    }
+
+    // add improper torsion calculations. each trigonal center has an
+    // improper torsion with the center as the third atom and the other
+    // atoms sorted by type if there are parameters for their types.
+    foreach(const chemkit::Atom *atom, molecule->atoms()){
+        if(atom->neighborCount() != 3){
+            continue;
+        }
+
+        std::vector<const chemkit::ForceFieldAtom *> neighbors;
+        foreach(const chemkit::Atom *neighbor, atom->neighbors()){
+            neighbors.push_back(atoms[neighbor->index()]);
         }
+        std::sort(neighbors.begin(), neighbors.end(), improperTorsionAtomLessThan);
 
-        setCalculationSetup(calculation, setup);
+        const chemkit::ForceFieldAtom *center = atoms[atom->index()];
+        if(m_parameters->improperTorsionParameters(neighbors[0], neighbors[1], center, neighbors[2])){
+            calculations.push_back(new AmberImproperTorsionCalculation(neighbors[0],
+                                                                       neighbors[1],
+                                                                       center,
+                                                                       neighbors[2]));
+        }
     }
 
-    return ok;
+    // add nonbonded calculations
+    std::pair<const chemkit::ForceFieldAtom *, const chemkit::ForceFieldAtom *> nonbondedPair;
+    foreach(nonbondedPair, interactions.nonbondedPairs()){
+        calculations.push_back(new AmberVanDerWaalsCalculation(nonbondedPair.first,
+                                                               nonbondedPair.second));
+        calculations.push_back(new AmberElectrostaticCalculation(nonbondedPair.first,
+                                                                 nonbondedPair.second));
+    }
+
+    return true;
 }
 
-const AmberParameters* AmberForceField::parameters() const
+bool AmberForceField::setupCalculation(chemkit::ForceFieldCalculation *calculation)
 {
-    return m_parameters;
+    return static_cast<AmberCalculation *>(calculation)->setup(m_parameters);
 }
 
 // --- Internal Methods ---------------------------------------------------- //
@@ -360,3 +456,49 @@ std::string AmberForceField::atomType(const chemkit::Atom *atom) const
 
     return std::string();
 }
+
+// Returns the template for residue or 0 if residue is not one of
+// the standard amino acids. Histidine and cysteine templates are
+// chosen by the hydrogens present (HID, HIE or HIP and CYS or CYX)
+// and the terminal templates by the presence of the OXT or H1/H3
+// atoms.
+const AmberResidueTemplate* AmberForceField::residueTemplate(const chemkit::Residue *residue) const
+{
+    if(residue->residueType() != chemkit::Residue::AminoAcidResidue){
+        return 0;
+    }
+
+    std::string name = static_cast<const chemkit::AminoAcid *>(residue)->symbol();
+    std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+    if(name == "HIS"){
+        bool deltaHydrogen = residue->atom("HD1") != 0;
+        bool epsilonHydrogen = residue->atom("HE2") != 0;
+
+        if(deltaHydrogen && epsilonHydrogen){
+            name = "HIP";
+        }
+        else if(deltaHydrogen){
+            name = "HID";
+        }
+        else{
+            name = "HIE";
+        }
+    }
+    else if(name == "CYS"){
+        const chemkit::Atom *sulfur = residue->atom("SG");
+
+        if(sulfur && !residue->atom("HG") && sulfur->isBondedTo(chemkit::Atom::Sulfur)){
+            name = "CYX";
+        }
+    }
+
+    if(residue->atom("OXT")){
+        name = "C" + name;
+    }
+    else if(residue->atom("H1") || residue->atom("H3")){
+        name = "N" + name;
+    }
+
+    return m_parameters->residueTemplate(name);
+}
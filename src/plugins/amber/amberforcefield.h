@@ -36,9 +36,11 @@
 #ifndef AMBERFORCEFIELD_H
 #define AMBERFORCEFIELD_H
 
+#include <chemkit/residue.h>
 #include <chemkit/forcefield.h>
 
 class AmberParameters;
+class AmberResidueTemplate;
 
 class AmberForceField : public chemkit::ForceField
 {
@@ -51,8 +53,15 @@ class AmberForceField : public chemkit::ForceField
         virtual bool setup();
         const AmberParameters* parameters() const;
 
+    protected:
+        bool setupMolecule(const chemkit::Molecule *molecule,
+                           std::vector<chemkit::ForceFieldAtom *> &atoms,
+                           std::vector<chemkit::ForceFieldCalculation *> &calculations);
+        bool setupCalculation(chemkit::ForceFieldCalculation *calculation);
+
     private:
         std::string atomType(const chemkit::Atom *atom) const;
+        const AmberResidueTemplate* residueTemplate(const chemkit::Residue *residue) const;
 
     private:
         AmberParameters *m_parameters;
@@ -436,117 +436,173 @@ struct TorsionParameters
 };
 
 const struct TorsionParameters TorsionParameters[] = {
-    {"X", "C", "C", "X", {0.000, 0.276, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "C", "CA", "X", {0.000, 0.276, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "C", "CB", "X", {0.000, 0.333, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "C", "CM", "X", {0.000, 0.460, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "C", "C", "X", {0.000, 3.625, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "C", "CA", "X", {0.000, 3.625, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "C", "CB", "X", {0.000, 3.000, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "C", "CM", "X", {0.000, 2.175, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
     {"X", "C", "CT", "X", {0.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"X", "C", "N", "X", {0.000, 0.400, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "C", "N*", "X", {0.000, 0.690, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "C", "NA", "X", {0.000, 0.741, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "C", "NC", "X", {0.000, 0.250, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "C", "O", "X", {0.000, 0.357, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "C", "OH", "X", {0.000, 0.435, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "C", "OS", "X", {0.000, 0.370, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CA", "CA", "X", {0.000, 0.276, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CA", "CB", "X", {0.000, 0.286, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CA", "CM", "X", {0.000, 0.392, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CA", "CN", "X", {0.000, 0.276, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "C", "N", "X", {0.000, 2.500, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "C", "N*", "X", {0.000, 1.450, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "C", "NA", "X", {0.000, 1.350, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "C", "NC", "X", {0.000, 4.000, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "C", "O", "X", {0.000, 2.800, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "C", "OH", "X", {0.000, 2.300, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "C", "OS", "X", {0.000, 2.700, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CA", "CA", "X", {0.000, 3.625, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CA", "CB", "X", {0.000, 3.500, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CA", "CM", "X", {0.000, 2.550, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CA", "CN", "X", {0.000, 3.625, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
     {"X", "CA", "CT", "X", {0.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"X", "CA", "N2", "X", {0.000, 0.417, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CA", "NA", "X", {0.000, 0.667, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CA", "NC", "X", {0.000, 0.208, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CA", "OH", "X", {0.000, 1.111, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CB", "CB", "X", {0.000, 0.183, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CB", "CN", "X", {0.000, 0.333, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CB", "N*", "X", {0.000, 0.606, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CB", "NB", "X", {0.000, 0.392, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CB", "NC", "X", {0.000, 0.241, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CA", "N2", "X", {0.000, 2.400, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CA", "NA", "X", {0.000, 1.500, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CA", "NC", "X", {0.000, 4.800, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CA", "OH", "X", {0.000, 0.900, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CB", "CB", "X", {0.000, 5.450, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CB", "CN", "X", {0.000, 3.000, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CB", "N*", "X", {0.000, 1.650, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CB", "NB", "X", {0.000, 2.550, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CB", "NC", "X", {0.000, 4.150, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
     {"X", "CC", "CT", "X", {0.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"X", "CC", "CV", "X", {0.000, 0.194, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CC", "CW", "X", {0.000, 0.186, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CC", "NA", "X", {0.000, 0.714, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CC", "NB", "X", {0.000, 0.417, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CC", "CV", "X", {0.000, 5.150, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CC", "CW", "X", {0.000, 5.375, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CC", "NA", "X", {0.000, 1.400, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CC", "NB", "X", {0.000, 2.400, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
     {"X", "CD", "CD", "X", {0.000, 1.000, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
     {"X", "CD", "CT", "X", {0.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"X", "CD", "CM", "X", {0.000, 0.150, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CK", "N*", "X", {0.000, 0.588, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CK", "NB", "X", {0.000, 0.100, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CM", "CM", "X", {0.000, 0.150, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CD", "CM", "X", {0.000, 6.650, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CK", "N*", "X", {0.000, 1.700, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CK", "NB", "X", {0.000, 10.000, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CM", "CM", "X", {0.000, 6.650, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
     {"X", "CM", "CT", "X", {0.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"X", "CM", "N*", "X", {0.000, 0.541, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CM", "OS", "X", {0.000, 0.952, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CN", "NA", "X", {0.000, 0.656, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CQ", "NC", "X", {0.000, 0.147, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CT", "CT", "X", {0.000, 0.000, 6.429, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"X", "CM", "N*", "X", {0.000, 1.850, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CM", "OS", "X", {0.000, 1.050, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CN", "NA", "X", {0.000, 1.525, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CQ", "NC", "X", {0.000, 6.800, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CT", "CT", "X", {0.000, 0.000, 0.155556, 0.000, 0.0, 0.0, 0.0, 0.0}},
     {"X", "CT", "CY", "X", {0.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
     {"X", "CT", "CZ", "X", {0.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
     {"X", "CT", "N", "X", {0.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
     {"X", "CT", "N*", "X", {0.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
     {"X", "CT", "N2", "X", {0.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"X", "CT", "NT", "X", {0.000, 0.000, 3.333, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"X", "CT", "N3", "X", {0.000, 0.000, 6.429, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"X", "CT", "OH", "X", {0.000, 0.000, 6.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"X", "CT", "OS", "X", {0.000, 0.000, 2.609, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"X", "CT", "S", "X", {0.000, 0.000, 3.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"X", "CT", "SH", "X", {0.000, 0.000, 4.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"X", "C*", "CB", "X", {0.000, 0.597, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CT", "NT", "X", {0.000, 0.000, 0.300, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"X", "CT", "N3", "X", {0.000, 0.000, 0.155556, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"X", "CT", "OH", "X", {0.000, 0.000, 0.166667, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"X", "CT", "OS", "X", {0.000, 0.000, 0.383333, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"X", "CT", "S", "X", {0.000, 0.000, 0.333333, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"X", "CT", "SH", "X", {0.000, 0.000, 0.250, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"X", "C*", "CB", "X", {0.000, 1.675, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
     {"X", "C*", "CT", "X", {0.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"X", "C*", "CW", "X", {0.000, 0.153, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CR", "NA", "X", {0.000, 0.430, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CR", "NB", "X", {0.000, 0.200, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CV", "NB", "X", {0.000, 0.417, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "CW", "NA", "X", {0.000, 0.667, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"X", "OH", "P", "X", {0.000, 0.000, 4.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"X", "OS", "P", "X", {0.000, 0.000, 4.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"N", "CT", "C", "N", {0.588, 0.500, 0.000, 0.000, 180.0, 180.0, 0.0, 0.0}},
-    {"C", "N", "CT", "C", {1.250, 1.176, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"CT", "CT", "N", "C", {1.887, 0.000, 6.667, 2.000, 0.0, 0.0, 180.0, 180.0}},
-    {"CT", "CT", "C", "N", {0.000, 14.286, 0.000, 10.000, 0.0, 0.0, 0.0, 0.0}},
-    {"H", "N", "C", "O", {0.500, 0.400, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"CT", "S", "S", "CT", {0.000, 0.286, 1.667, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"OH", "P", "OS", "CT", {0.000, 0.833, 4.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"OS", "P", "OS", "CT", {0.000, 0.833, 4.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"H1", "CT", "C", "O", {1.250, 0.000, 12.500, 0.000, 0.0, 0.0, 180.0, 0.0}},
-    {"HC", "CT", "C", "O", {1.250, 0.000, 12.500, 0.000, 0.0, 0.0, 180.0, 0.0}},
+    {"X", "C*", "CW", "X", {0.000, 6.525, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CR", "NA", "X", {0.000, 2.325, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CR", "NB", "X", {0.000, 5.000, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CV", "NB", "X", {0.000, 2.400, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "CW", "NA", "X", {0.000, 1.500, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"X", "OH", "P", "X", {0.000, 0.000, 0.250, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"X", "OS", "P", "X", {0.000, 0.000, 0.250, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"N", "CT", "C", "N", {1.700, 2.000, 0.000, 0.000, 180.0, 180.0, 0.0, 0.0}},
+    {"C", "N", "CT", "C", {0.800, 0.850, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"CT", "CT", "N", "C", {0.530, 0.000, 0.150, 0.500, 0.0, 0.0, 180.0, 180.0}},
+    {"CT", "CT", "C", "N", {0.000, 0.070, 0.000, 0.100, 0.0, 0.0, 0.0, 0.0}},
+    {"H", "N", "C", "O", {2.000, 2.500, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"CT", "S", "S", "CT", {0.000, 3.500, 0.600, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"OH", "P", "OS", "CT", {0.000, 1.200, 0.250, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"OS", "P", "OS", "CT", {0.000, 1.200, 0.250, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"H1", "CT", "C", "O", {0.800, 0.000, 0.080, 0.000, 0.0, 0.0, 180.0, 0.0}},
+    {"HC", "CT", "C", "O", {0.800, 0.000, 0.080, 0.000, 0.0, 0.0, 180.0, 0.0}},
     {"HC", "CT", "C", "O", {0.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"HC", "CT", "CT", "HC", {0.000, 0.000, 6.667, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"HC", "CT", "CT", "CT", {0.000, 0.000, 6.250, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"HC", "CT", "CM", "CM", {0.870, 0.000, 2.632, 0.000, 0.0, 0.0, 180.0, 0.0}},
-    {"HO", "OH", "CT", "CT", {4.000, 0.000, 6.250, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"HO", "OH", "C", "O", {0.526, 0.435, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"CM", "CM", "C", "O", {0.000, 0.460, 3.333, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"CT", "CM", "CM", "CT", {0.526, 0.150, 0.000, 0.000, 180.0, 180.0, 0.0, 0.0}},
-    {"CT", "CT", "CT", "CT", {5.000, 4.000, 5.556, 0.000, 180.0, 180.0, 0.0, 0.0}},
-    {"CT", "CT", "NT", "CT", {0.000, 2.083, 3.333, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"CT", "CT", "OS", "CT", {0.000, 10.000, 2.611, 0.000, 0.0, 180.0, 0.0, 0.0}},
-    {"CT", "CT", "OS", "C", {1.250, 0.000, 2.611, 0.000, 180.0, 0.0, 0.0, 0.0}},
-    {"CT", "OS", "CT", "OS", {0.741, 1.176, 10.000, 0.000, 180.0, 180.0, 0.0, 0.0}},
-    {"CT", "OS", "CT", "N*", {0.000, 1.538, 2.611, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"HC", "CT", "CT", "HC", {0.000, 0.000, 0.150, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"HC", "CT", "CT", "CT", {0.000, 0.000, 0.160, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"HC", "CT", "CM", "CM", {1.150, 0.000, 0.380, 0.000, 0.0, 0.0, 180.0, 0.0}},
+    {"HO", "OH", "CT", "CT", {0.250, 0.000, 0.160, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"HO", "OH", "C", "O", {1.900, 2.300, 0.000, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"CM", "CM", "C", "O", {0.000, 2.175, 0.300, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"CT", "CM", "CM", "CT", {1.900, 6.650, 0.000, 0.000, 180.0, 180.0, 0.0, 0.0}},
+    {"CT", "CT", "CT", "CT", {0.200, 0.250, 0.180, 0.000, 180.0, 180.0, 0.0, 0.0}},
+    {"CT", "CT", "NT", "CT", {0.000, 0.480, 0.300, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"CT", "CT", "OS", "CT", {0.000, 0.100, 0.383, 0.000, 0.0, 180.0, 0.0, 0.0}},
+    {"CT", "CT", "OS", "C", {0.800, 0.000, 0.383, 0.000, 180.0, 0.0, 0.0, 0.0}},
+    {"CT", "OS", "CT", "OS", {1.350, 0.850, 0.100, 0.000, 180.0, 180.0, 0.0, 0.0}},
+    {"CT", "OS", "CT", "N*", {0.000, 0.650, 0.383, 0.000, 0.0, 0.0, 0.0, 0.0}},
     {"CT", "CZ", "CZ", "HZ", {0.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"O", "C", "OS", "CT", {0.714, 0.370, 0.000, 0.000, 180.0, 180.0, 0.0, 0.0}},
-    {"OS", "CT", "N*", "CK", {0.400, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"OS", "CT", "N*", "CM", {0.400, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"OS", "CT", "CT", "OS", {0.000, 0.851, 6.944, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"OS", "CT", "CT", "OH", {0.000, 0.851, 6.944, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"OH", "CT", "CT", "OH", {0.000, 0.851, 6.944, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"F", "CT", "CT", "F", {0.833, 0.000, 0.000, 0.000, 180.0, 0.0, 0.0, 0.0}},
-    {"Cl", "CT", "CT", "Cl", {2.222, 0.000, 0.000, 0.000, 180.0, 0.0, 0.0, 0.0}},
+    {"O", "C", "OS", "CT", {1.400, 2.700, 0.000, 0.000, 180.0, 180.0, 0.0, 0.0}},
+    {"OS", "CT", "N*", "CK", {2.500, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"OS", "CT", "N*", "CM", {2.500, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"OS", "CT", "CT", "OS", {0.000, 1.175, 0.144, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"OS", "CT", "CT", "OH", {0.000, 1.175, 0.144, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"OH", "CT", "CT", "OH", {0.000, 1.175, 0.144, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"F", "CT", "CT", "F", {1.200, 0.000, 0.000, 0.000, 180.0, 0.0, 0.0, 0.0}},
+    {"Cl", "CT", "CT", "Cl", {0.450, 0.000, 0.000, 0.000, 180.0, 0.0, 0.0, 0.0}},
     {"Br", "CT", "CT", "Br", {0.000, 0.000, 0.000, 0.000, 180.0, 0.0, 0.0, 0.0}},
-    {"H1", "CT", "CT", "OS", {4.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"H1", "CT", "CT", "OH", {4.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"H1", "CT", "CT", "F", {5.263, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"H1", "CT", "CT", "Cl", {4.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"H1", "CT", "CT", "Br", {1.818, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"HC", "CT", "CT", "OS", {4.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"HC", "CT", "CT", "OH", {4.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"HC", "CT", "CT", "F", {5.263, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"HC", "CT", "CT", "Cl", {4.000, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
-    {"HC", "CT", "CT", "Br", {1.818, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}}
+    {"H1", "CT", "CT", "OS", {0.250, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"H1", "CT", "CT", "OH", {0.250, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"H1", "CT", "CT", "F", {0.190, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"H1", "CT", "CT", "Cl", {0.250, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"H1", "CT", "CT", "Br", {0.550, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"HC", "CT", "CT", "OS", {0.250, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"HC", "CT", "CT", "OH", {0.250, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"HC", "CT", "CT", "F", {0.190, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"HC", "CT", "CT", "Cl", {0.250, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}},
+    {"HC", "CT", "CT", "Br", {0.550, 0.000, 0.000, 0.000, 0.0, 0.0, 0.0, 0.0}}
 };
 
 const int TorsionParametersCount = sizeof(TorsionParameters) / sizeof(*TorsionParameters);
 
+// --- Improper Torsion Parameters ----------------------------------------- //
+// The central atom is the third atom and the other atoms are listed in
+// alphabetical order of their types.
+struct ImproperTorsionParameters
+{
+    const char *typeA;
+    const char *typeB;
+    const char *typeC;
+    const char *typeD;
+    AmberImproperTorsionParameters parameters;
+};
+
+const struct ImproperTorsionParameters ImproperTorsionParameters[] = {
+    {"X", "X", "C", "O", {10.500, 180.0, 2}},
+    {"X", "O2", "C", "O2", {10.500, 180.0, 2}},
+    {"X", "X", "N", "H", {1.000, 180.0, 2}},
+    {"X", "X", "N2", "H", {1.000, 180.0, 2}},
+    {"X", "X", "NA", "H", {1.000, 180.0, 2}},
+    {"X", "N2", "CA", "N2", {10.500, 180.0, 2}},
+    {"X", "CT", "N", "CT", {1.000, 180.0, 2}},
+    {"X", "X", "CA", "HA", {1.100, 180.0, 2}},
+    {"X", "X", "CW", "H4", {1.100, 180.0, 2}},
+    {"X", "X", "CR", "H5", {1.100, 180.0, 2}},
+    {"X", "X", "CV", "H4", {1.100, 180.0, 2}},
+    {"X", "X", "CQ", "H5", {1.100, 180.0, 2}},
+    {"X", "X", "CK", "H5", {1.100, 180.0, 2}},
+    {"X", "X", "CM", "H4", {1.100, 180.0, 2}},
+    {"X", "X", "CM", "HA", {1.100, 180.0, 2}},
+    {"X", "X", "CA", "H4", {1.100, 180.0, 2}},
+    {"X", "X", "CA", "H5", {1.100, 180.0, 2}},
+    {"CB", "CK", "N*", "CT", {1.000, 180.0, 2}},
+    {"C", "CM", "N*", "CT", {1.000, 180.0, 2}},
+    {"C", "CM", "CM", "CT", {1.100, 180.0, 2}},
+    {"CT", "O", "C", "OH", {10.500, 180.0, 2}},
+    {"CT", "CV", "CC", "NA", {1.100, 180.0, 2}},
+    {"CT", "CW", "CC", "NB", {1.100, 180.0, 2}},
+    {"CT", "CW", "CC", "NA", {1.100, 180.0, 2}},
+    {"CB", "CT", "C*", "CW", {1.100, 180.0, 2}},
+    {"CA", "CA", "CA", "CT", {1.100, 180.0, 2}},
+    {"C", "CM", "CM", "CT", {1.100, 180.0, 2}},
+    {"CM", "N2", "CA", "NC", {1.100, 180.0, 2}},
+    {"CB", "N2", "CA", "NC", {1.100, 180.0, 2}},
+    {"N2", "NA", "CA", "NC", {1.100, 180.0, 2}},
+    {"CA", "CA", "C", "OH", {1.100, 180.0, 2}},
+    {"CA", "CA", "CA", "OH", {1.100, 180.0, 2}},
+    {"H5", "O", "C", "OH", {1.100, 180.0, 2}},
+    {"H5", "O", "C", "OS", {1.100, 180.0, 2}},
+    {"CM", "CT", "CM", "HA", {1.100, 180.0, 2}},
+    {"Br", "CA", "CA", "CA", {1.100, 180.0, 2}},
+    {"CM", "H4", "C", "O", {1.100, 180.0, 2}},
+    {"C", "CT", "N", "H", {1.100, 180.0, 2}},
+    {"C", "CT", "N", "O", {1.100, 180.0, 2}}
+};
+
+const int ImproperTorsionParametersCount = sizeof(ImproperTorsionParameters) / sizeof(*ImproperTorsionParameters);
+
 // --- Nonbonded Parameters ------------------------------------------------ //
 struct NonbondedParameters
 {
@@ -621,12 +677,605 @@ const struct NonbondedParameters NonbondedParameters[] = {
 
 const int NonbondedParametersCount = sizeof(NonbondedParameters) / sizeof(*NonbondedParameters);
 
+// --- Residue Parameters ------------------------------------------------- //
+// Atom types and partial charges for the atoms in the standard amino
+// acid residues keyed by residue name and atom name (from the AMBER
+// all_amino94 residue library).
+struct ResidueAtomParameters
+{
+    const char *residue;
+    const char *atom;
+    const char *type;
+    chemkit::Float charge;
+};
+
+const struct ResidueAtomParameters ResidueAtomParameters[] = {
+    {"ALA", "N", "N", -0.4157},
+    {"ALA", "H", "H", 0.2719},
+    {"ALA", "CA", "CT", 0.0337},
+    {"ALA", "HA", "H1", 0.0823},
+    {"ALA", "CB", "CT", -0.1825},
+    {"ALA", "HB1", "HC", 0.0603},
+    {"ALA", "HB2", "HC", 0.0603},
+    {"ALA", "HB3", "HC", 0.0603},
+    {"ALA", "C", "C", 0.5973},
+    {"ALA", "O", "O", -0.5679},
+    {"ARG", "N", "N", -0.3479},
+    {"ARG", "H", "H", 0.2747},
+    {"ARG", "CA", "CT", -0.2637},
+    {"ARG", "HA", "H1", 0.1560},
+    {"ARG", "CB", "CT", -0.0007},
+    {"ARG", "HB2", "HC", 0.0327},
+    {"ARG", "HB3", "HC", 0.0327},
+    {"ARG", "CG", "CT", 0.0390},
+    {"ARG", "HG2", "HC", 0.0285},
+    {"ARG", "HG3", "HC", 0.0285},
+    {"ARG", "CD", "CT", 0.0486},
+    {"ARG", "HD2", "H1", 0.0687},
+    {"ARG", "HD3", "H1", 0.0687},
+    {"ARG", "NE", "N2", -0.5295},
+    {"ARG", "HE", "H", 0.3456},
+    {"ARG", "CZ", "CA", 0.8076},
+    {"ARG", "NH1", "N2", -0.8627},
+    {"ARG", "HH11", "H", 0.4478},
+    {"ARG", "HH12", "H", 0.4478},
+    {"ARG", "NH2", "N2", -0.8627},
+    {"ARG", "HH21", "H", 0.4478},
+    {"ARG", "HH22", "H", 0.4478},
+    {"ARG", "C", "C", 0.7341},
+    {"ARG", "O", "O", -0.5894},
+    {"ASN", "N", "N", -0.4157},
+    {"ASN", "H", "H", 0.2719},
+    {"ASN", "CA", "CT", 0.0143},
+    {"ASN", "HA", "H1", 0.1048},
+    {"ASN", "CB", "CT", -0.2041},
+    {"ASN", "HB2", "HC", 0.0797},
+    {"ASN", "HB3", "HC", 0.0797},
+    {"ASN", "CG", "C", 0.7130},
+    {"ASN", "OD1", "O", -0.5931},
+    {"ASN", "ND2", "N", -0.9191},
+    {"ASN", "HD21", "H", 0.4196},
+    {"ASN", "HD22", "H", 0.4196},
+    {"ASN", "C", "C", 0.5973},
+    {"ASN", "O", "O", -0.5679},
+    {"ASP", "N", "N", -0.5163},
+    {"ASP", "H", "H", 0.2936},
+    {"ASP", "CA", "CT", 0.0381},
+    {"ASP", "HA", "H1", 0.0880},
+    {"ASP", "CB", "CT", -0.0303},
+    {"ASP", "HB2", "HC", -0.0122},
+    {"ASP", "HB3", "HC", -0.0122},
+    {"ASP", "CG", "C", 0.7994},
+    {"ASP", "OD1", "O2", -0.8014},
+    {"ASP", "OD2", "O2", -0.8014},
+    {"ASP", "C", "C", 0.5366},
+    {"ASP", "O", "O", -0.5819},
+    {"CYS", "N", "N", -0.4157},
+    {"CYS", "H", "H", 0.2719},
+    {"CYS", "CA", "CT", 0.0213},
+    {"CYS", "HA", "H1", 0.1124},
+    {"CYS", "CB", "CT", -0.1231},
+    {"CYS", "HB2", "H1", 0.1112},
+    {"CYS", "HB3", "H1", 0.1112},
+    {"CYS", "SG", "SH", -0.3119},
+    {"CYS", "HG", "HS", 0.1933},
+    {"CYS", "C", "C", 0.5973},
+    {"CYS", "O", "O", -0.5679},
+    {"CYX", "N", "N", -0.4157},
+    {"CYX", "H", "H", 0.2719},
+    {"CYX", "CA", "CT", 0.0429},
+    {"CYX", "HA", "H1", 0.0766},
+    {"CYX", "CB", "CT", -0.0790},
+    {"CYX", "HB2", "H1", 0.0910},
+    {"CYX", "HB3", "H1", 0.0910},
+    {"CYX", "SG", "S", -0.1081},
+    {"CYX", "C", "C", 0.5973},
+    {"CYX", "O", "O", -0.5679},
+    {"GLN", "N", "N", -0.4157},
+    {"GLN", "H", "H", 0.2719},
+    {"GLN", "CA", "CT", -0.0031},
+    {"GLN", "HA", "H1", 0.0850},
+    {"GLN", "CB", "CT", -0.0036},
+    {"GLN", "HB2", "HC", 0.0171},
+    {"GLN", "HB3", "HC", 0.0171},
+    {"GLN", "CG", "CT", -0.0645},
+    {"GLN", "HG2", "HC", 0.0352},
+    {"GLN", "HG3", "HC", 0.0352},
+    {"GLN", "CD", "C", 0.6951},
+    {"GLN", "OE1", "O", -0.6086},
+    {"GLN", "NE2", "N", -0.9407},
+    {"GLN", "HE21", "H", 0.4251},
+    {"GLN", "HE22", "H", 0.4251},
+    {"GLN", "C", "C", 0.5973},
+    {"GLN", "O", "O", -0.5679},
+    {"GLU", "N", "N", -0.5163},
+    {"GLU", "H", "H", 0.2936},
+    {"GLU", "CA", "CT", 0.0397},
+    {"GLU", "HA", "H1", 0.1105},
+    {"GLU", "CB", "CT", 0.0560},
+    {"GLU", "HB2", "HC", -0.0173},
+    {"GLU", "HB3", "HC", -0.0173},
+    {"GLU", "CG", "CT", 0.0136},
+    {"GLU", "HG2", "HC", -0.0425},
+    {"GLU", "HG3", "HC", -0.0425},
+    {"GLU", "CD", "C", 0.8054},
+    {"GLU", "OE1", "O2", -0.8188},
+    {"GLU", "OE2", "O2", -0.8188},
+    {"GLU", "C", "C", 0.5366},
+    {"GLU", "O", "O", -0.5819},
+    {"GLY", "N", "N", -0.4157},
+    {"GLY", "H", "H", 0.2719},
+    {"GLY", "CA", "CT", -0.0252},
+    {"GLY", "HA2", "H1", 0.0698},
+    {"GLY", "HA3", "H1", 0.0698},
+    {"GLY", "C", "C", 0.5973},
+    {"GLY", "O", "O", -0.5679},
+    {"HID", "N", "N", -0.4157},
+    {"HID", "H", "H", 0.2719},
+    {"HID", "CA", "CT", 0.0188},
+    {"HID", "HA", "H1", 0.0881},
+    {"HID", "CB", "CT", -0.0462},
+    {"HID", "HB2", "HC", 0.0402},
+    {"HID", "HB3", "HC", 0.0402},
+    {"HID", "CG", "CC", -0.0266},
+    {"HID", "ND1", "NA", -0.3811},
+    {"HID", "HD1", "H", 0.3649},
+    {"HID", "CE1", "CR", 0.2057},
+    {"HID", "HE1", "H5", 0.1392},
+    {"HID", "NE2", "NB", -0.5727},
+    {"HID", "CD2", "CV", 0.1292},
+    {"HID", "HD2", "H4", 0.1147},
+    {"HID", "C", "C", 0.5973},
+    {"HID", "O", "O", -0.5679},
+    {"HIE", "N", "N", -0.4157},
+    {"HIE", "H", "H", 0.2719},
+    {"HIE", "CA", "CT", -0.0581},
+    {"HIE", "HA", "H1", 0.1360},
+    {"HIE", "CB", "CT", -0.0074},
+    {"HIE", "HB2", "HC", 0.0367},
+    {"HIE", "HB3", "HC", 0.0367},
+    {"HIE", "CG", "CC", 0.1868},
+    {"HIE", "ND1", "NB", -0.5432},
+    {"HIE", "CE1", "CR", 0.1635},
+    {"HIE", "HE1", "H5", 0.1435},
+    {"HIE", "NE2", "NA", -0.2795},
+    {"HIE", "HE2", "H", 0.3339},
+    {"HIE", "CD2", "CW", -0.2207},
+    {"HIE", "HD2", "H4", 0.1862},
+    {"HIE", "C", "C", 0.5973},
+    {"HIE", "O", "O", -0.5679},
+    {"HIP", "N", "N", -0.3479},
+    {"HIP", "H", "H", 0.2747},
+    {"HIP", "CA", "CT", -0.1354},
+    {"HIP", "HA", "H1", 0.1212},
+    {"HIP", "CB", "CT", -0.0414},
+    {"HIP", "HB2", "HC", 0.0810},
+    {"HIP", "HB3", "HC", 0.0810},
+    {"HIP", "CG", "CC", -0.0012},
+    {"HIP", "ND1", "NA", -0.1513},
+    {"HIP", "HD1", "H", 0.3866},
+    {"HIP", "CE1", "CR", -0.0170},
+    {"HIP", "HE1", "H5", 0.2681},
+    {"HIP", "NE2", "NA", -0.1718},
+    {"HIP", "HE2", "H", 0.3911},
+    {"HIP", "CD2", "CW", -0.1141},
+    {"HIP", "HD2", "H4", 0.2317},
+    {"HIP", "C", "C", 0.7341},
+    {"HIP", "O", "O", -0.5894},
+    {"ILE", "N", "N", -0.4157},
+    {"ILE", "H", "H", 0.2719},
+    {"ILE", "CA", "CT", -0.0597},
+    {"ILE", "HA", "H1", 0.0869},
+    {"ILE", "CB", "CT", 0.1303},
+    {"ILE", "HB", "HC", 0.0187},
+    {"ILE", "CG2", "CT", -0.3204},
+    {"ILE", "HG21", "HC", 0.0882},
+    {"ILE", "HG22", "HC", 0.0882},
+    {"ILE", "HG23", "HC", 0.0882},
+    {"ILE", "CG1", "CT", -0.0430},
+    {"ILE", "HG12", "HC", 0.0236},
+    {"ILE", "HG13", "HC", 0.0236},
+    {"ILE", "CD1", "CT", -0.0660},
+    {"ILE", "HD11", "HC", 0.0186},
+    {"ILE", "HD12", "HC", 0.0186},
+    {"ILE", "HD13", "HC", 0.0186},
+    {"ILE", "C", "C", 0.5973},
+    {"ILE", "O", "O", -0.5679},
+    {"LEU", "N", "N", -0.4157},
+    {"LEU", "H", "H", 0.2719},
+    {"LEU", "CA", "CT", -0.0518},
+    {"LEU", "HA", "H1", 0.0922},
+    {"LEU", "CB", "CT", -0.1102},
+    {"LEU", "HB2", "HC", 0.0457},
+    {"LEU", "HB3", "HC", 0.0457},
+    {"LEU", "CG", "CT", 0.3531},
+    {"LEU", "HG", "HC", -0.0361},
+    {"LEU", "CD1", "CT", -0.4121},
+    {"LEU", "HD11", "HC", 0.1000},
+    {"LEU", "HD12", "HC", 0.1000},
+    {"LEU", "HD13", "HC", 0.1000},
+    {"LEU", "CD2", "CT", -0.4121},
+    {"LEU", "HD21", "HC", 0.1000},
+    {"LEU", "HD22", "HC", 0.1000},
+    {"LEU", "HD23", "HC", 0.1000},
+    {"LEU", "C", "C", 0.5973},
+    {"LEU", "O", "O", -0.5679},
+    {"LYS", "N", "N", -0.3479},
+    {"LYS", "H", "H", 0.2747},
+    {"LYS", "CA", "CT", -0.2400},
+    {"LYS", "HA", "H1", 0.1426},
+    {"LYS", "CB", "CT", -0.0094},
+    {"LYS", "HB2", "HC", 0.0362},
+    {"LYS", "HB3", "HC", 0.0362},
+    {"LYS", "CG", "CT", 0.0187},
+    {"LYS", "HG2", "HC", 0.0103},
+    {"LYS", "HG3", "HC", 0.0103},
+    {"LYS", "CD", "CT", -0.0479},
+    {"LYS", "HD2", "HC", 0.0621},
+    {"LYS", "HD3", "HC", 0.0621},
+    {"LYS", "CE", "CT", -0.0143},
+    {"LYS", "HE2", "HP", 0.1135},
+    {"LYS", "HE3", "HP", 0.1135},
+    {"LYS", "NZ", "N3", -0.3854},
+    {"LYS", "HZ1", "H", 0.3400},
+    {"LYS", "HZ2", "H", 0.3400},
+    {"LYS", "HZ3", "H", 0.3400},
+    {"LYS", "C", "C", 0.7341},
+    {"LYS", "O", "O", -0.5894},
+    {"MET", "N", "N", -0.4157},
+    {"MET", "H", "H", 0.2719},
+    {"MET", "CA", "CT", -0.0237},
+    {"MET", "HA", "H1", 0.0880},
+    {"MET", "CB", "CT", 0.0342},
+    {"MET", "HB2", "HC", 0.0241},
+    {"MET", "HB3", "HC", 0.0241},
+    {"MET", "CG", "CT", 0.0018},
+    {"MET", "HG2", "H1", 0.0440},
+    {"MET", "HG3", "H1", 0.0440},
+    {"MET", "SD", "S", -0.2737},
+    {"MET", "CE", "CT", -0.0536},
+    {"MET", "HE1", "H1", 0.0684},
+    {"MET", "HE2", "H1", 0.0684},
+    {"MET", "HE3", "H1", 0.0684},
+    {"MET", "C", "C", 0.5973},
+    {"MET", "O", "O", -0.5679},
+    {"PHE", "N", "N", -0.4157},
+    {"PHE", "H", "H", 0.2719},
+    {"PHE", "CA", "CT", -0.0024},
+    {"PHE", "HA", "H1", 0.0978},
+    {"PHE", "CB", "CT", -0.0343},
+    {"PHE", "HB2", "HC", 0.0295},
+    {"PHE", "HB3", "HC", 0.0295},
+    {"PHE", "CG", "CA", 0.0118},
+    {"PHE", "CD1", "CA", -0.1256},
+    {"PHE", "HD1", "HA", 0.1330},
+    {"PHE", "CE1", "CA", -0.1704},
+    {"PHE", "HE1", "HA", 0.1430},
+    {"PHE", "CZ", "CA", -0.1072},
+    {"PHE", "HZ", "HA", 0.1297},
+    {"PHE", "CE2", "CA", -0.1704},
+    {"PHE", "HE2", "HA", 0.1430},
+    {"PHE", "CD2", "CA", -0.1256},
+    {"PHE", "HD2", "HA", 0.1330},
+    {"PHE", "C", "C", 0.5973},
+    {"PHE", "O", "O", -0.5679},
+    {"PRO", "N", "N", -0.2548},
+    {"PRO", "CD", "CT", 0.0192},
+    {"PRO", "HD2", "H1", 0.0391},
+    {"PRO", "HD3", "H1", 0.0391},
+    {"PRO", "CG", "CT", 0.0189},
+    {"PRO", "HG2", "HC", 0.0213},
+    {"PRO", "HG3", "HC", 0.0213},
+    {"PRO", "CB", "CT", -0.0070},
+    {"PRO", "HB2", "HC", 0.0253},
+    {"PRO", "HB3", "HC", 0.0253},
+    {"PRO", "CA", "CT", -0.0266},
+    {"PRO", "HA", "H1", 0.0641},
+    {"PRO", "C", "C", 0.5896},
+    {"PRO", "O", "O", -0.5748},
+    {"SER", "N", "N", -0.4157},
+    {"SER", "H", "H", 0.2719},
+    {"SER", "CA", "CT", -0.0249},
+    {"SER", "HA", "H1", 0.0843},
+    {"SER", "CB", "CT", 0.2117},
+    {"SER", "HB2", "H1", 0.0352},
+    {"SER", "HB3", "H1", 0.0352},
+    {"SER", "OG", "OH", -0.6546},
+    {"SER", "HG", "HO", 0.4275},
+    {"SER", "C", "C", 0.5973},
+    {"SER", "O", "O", -0.5679},
+    {"THR", "N", "N", -0.4157},
+    {"THR", "H", "H", 0.2719},
+    {"THR", "CA", "CT", -0.0389},
+    {"THR", "HA", "H1", 0.1007},
+    {"THR", "CB", "CT", 0.3654},
+    {"THR", "HB", "H1", 0.0043},
+    {"THR", "CG2", "CT", -0.2438},
+    {"THR", "HG21", "HC", 0.0642},
+    {"THR", "HG22", "HC", 0.0642},
+    {"THR", "HG23", "HC", 0.0642},
+    {"THR", "OG1", "OH", -0.6761},
+    {"THR", "HG1", "HO", 0.4102},
+    {"THR", "C", "C", 0.5973},
+    {"THR", "O", "O", -0.5679},
+    {"TRP", "N", "N", -0.4157},
+    {"TRP", "H", "H", 0.2719},
+    {"TRP", "CA", "CT", -0.0275},
+    {"TRP", "HA", "H1", 0.1123},
+    {"TRP", "CB", "CT", -0.0050},
+    {"TRP", "HB2", "HC", 0.0339},
+    {"TRP", "HB3", "HC", 0.0339},
+    {"TRP", "CG", "C*", -0.1415},
+    {"TRP", "CD1", "CW", -0.1638},
+    {"TRP", "HD1", "H4", 0.2062},
+    {"TRP", "NE1", "NA", -0.3418},
+    {"TRP", "HE1", "H", 0.3412},
+    {"TRP", "CE2", "CN", 0.1380},
+    {"TRP", "CZ2", "CA", -0.2601},
+    {"TRP", "HZ2", "HA", 0.1572},
+    {"TRP", "CH2", "CA", -0.1134},
+    {"TRP", "HH2", "HA", 0.1417},
+    {"TRP", "CZ3", "CA", -0.1972},
+    {"TRP", "HZ3", "HA", 0.1447},
+    {"TRP", "CE3", "CA", -0.2387},
+    {"TRP", "HE3", "HA", 0.1700},
+    {"TRP", "CD2", "CB", 0.1243},
+    {"TRP", "C", "C", 0.5973},
+    {"TRP", "O", "O", -0.5679},
+    {"TYR", "N", "N", -0.4157},
+    {"TYR", "H", "H", 0.2719},
+    {"TYR", "CA", "CT", -0.0014},
+    {"TYR", "HA", "H1", 0.0876},
+    {"TYR", "CB", "CT", -0.0152},
+    {"TYR", "HB2", "HC", 0.0295},
+    {"TYR", "HB3", "HC", 0.0295},
+    {"TYR", "CG", "CA", -0.0011},
+    {"TYR", "CD1", "CA", -0.1906},
+    {"TYR", "HD1", "HA", 0.1699},
+    {"TYR", "CE1", "CA", -0.2341},
+    {"TYR", "HE1", "HA", 0.1656},
+    {"TYR", "CZ", "C", 0.3226},
+    {"TYR", "OH", "OH", -0.5579},
+    {"TYR", "HH", "HO", 0.3992},
+    {"TYR", "CE2", "CA", -0.2341},
+    {"TYR", "HE2", "HA", 0.1656},
+    {"TYR", "CD2", "CA", -0.1906},
+    {"TYR", "HD2", "HA", 0.1699},
+    {"TYR", "C", "C", 0.5973},
+    {"TYR", "O", "O", -0.5679},
+    {"VAL", "N", "N", -0.4157},
+    {"VAL", "H", "H", 0.2719},
+    {"VAL", "CA", "CT", -0.0875},
+    {"VAL", "HA", "H1", 0.0969},
+    {"VAL", "CB", "CT", 0.2985},
+    {"VAL", "HB", "HC", -0.0297},
+    {"VAL", "CG1", "CT", -0.3192},
+    {"VAL", "HG11", "HC", 0.0791},
+    {"VAL", "HG12", "HC", 0.0791},
+    {"VAL", "HG13", "HC", 0.0791},
+    {"VAL", "CG2", "CT", -0.3192},
+    {"VAL", "HG21", "HC", 0.0791},
+    {"VAL", "HG22", "HC", 0.0791},
+    {"VAL", "HG23", "HC", 0.0791},
+    {"VAL", "C", "C", 0.5973},
+    {"VAL", "O", "O", -0.5679}
+};
+
+const int ResidueAtomParametersCount = sizeof(ResidueAtomParameters) / sizeof(*ResidueAtomParameters);
+
+// Charges of the charged amino and carboxylate groups in N-terminal
+// and C-terminal residues.
+const chemkit::Float TerminalNitrogenCharge = 0.1414;
+const chemkit::Float TerminalHydrogenCharge = 0.1997;
+const chemkit::Float TerminalCarbonCharge = 0.7731;
+const chemkit::Float TerminalOxygenCharge = -0.8055;
+
+// Returns the sum of the partial charges in the residue template.
+chemkit::Float residueCharge(const AmberResidueTemplate &residue)
+{
+    chemkit::Float charge = 0;
+
+    std::map<std::string, AmberResidueAtomParameters>::const_iterator iter;
+    for(iter = residue.atoms.begin(); iter != residue.atoms.end(); ++iter){
+        charge += iter->second.charge;
+    }
+
+    return charge;
+}
+
+// Sets the partial charge of the alpha carbon so that the total
+// charge of the residue template is charge.
+void setResidueCharge(AmberResidueTemplate &residue, chemkit::Float charge)
+{
+    residue.atoms["CA"].charge += charge - residueCharge(residue);
+}
+
+// Returns the template for the N-terminal form of residue. The amide
+// hydrogen is replaced with a charged amino group.
+AmberResidueTemplate nTerminalResidue(const AmberResidueTemplate &residue, const std::string &name)
+{
+    AmberResidueTemplate terminal = residue;
+    chemkit::Float charge = qRound(residueCharge(residue)) + 1;
+
+    terminal.atoms.erase("H");
+    terminal.atoms["N"].type = "N3";
+    terminal.atoms["N"].charge = TerminalNitrogenCharge;
+    if(name != "PRO"){
+        terminal.atoms["H1"].type = "H";
+        terminal.atoms["H1"].charge = TerminalHydrogenCharge;
+    }
+    terminal.atoms["H2"].type = "H";
+    terminal.atoms["H2"].charge = TerminalHydrogenCharge;
+    terminal.atoms["H3"].type = "H";
+    terminal.atoms["H3"].charge = TerminalHydrogenCharge;
+
+    // alpha hydrogens next to the charged amino group
+    const char *alphaHydrogens[] = {"HA", "HA2", "HA3"};
+    for(int i = 0; i < 3; i++){
+        std::map<std::string, AmberResidueAtomParameters>::iterator location = terminal.atoms.find(alphaHydrogens[i]);
+        if(location != terminal.atoms.end()){
+            location->second.type = "HP";
+        }
+    }
+
+    setResidueCharge(terminal, charge);
+    return terminal;
+}
+
+// Returns the template for the C-terminal form of residue. The
+// carbonyl group is replaced with a charged carboxylate group.
+AmberResidueTemplate cTerminalResidue(const AmberResidueTemplate &residue)
+{
+    AmberResidueTemplate terminal = residue;
+    chemkit::Float charge = qRound(residueCharge(residue)) - 1;
+
+    terminal.atoms["C"].type = "C";
+    terminal.atoms["C"].charge = TerminalCarbonCharge;
+    terminal.atoms["O"].type = "O2";
+    terminal.atoms["O"].charge = TerminalOxygenCharge;
+    terminal.atoms["OXT"].type = "O2";
+    terminal.atoms["OXT"].charge = TerminalOxygenCharge;
+
+    setResidueCharge(terminal, charge);
+    return terminal;
+}
+
+// Returns a hash key for the type ids in a parameter.
+inline quint64 parameterKey(int a, int b, int c = 0, int d = 0)
+{
+    return (quint64(quint16(a)) << 48) |
+           (quint64(quint16(b)) << 32) |
+           (quint64(quint16(c)) << 16) |
+            quint64(quint16(d));
+}
+
 } // end anonymous namespace
 
+// === AmberResidueTemplate ================================================ //
+// Returns the parameters for the atom with name in the residue or 0
+// if the residue has no atom with name.
+const AmberResidueAtomParameters* AmberResidueTemplate::atomParameters(const std::string &name) const
+{
+    std::map<std::string, AmberResidueAtomParameters>::const_iterator location = atoms.find(name);
+    if(location == atoms.end()){
+        return 0;
+    }
+
+    return &location->second;
+}
+
 // === AmberParameters ===================================================== //
 // --- Construction and Destruction ---------------------------------------- //
 AmberParameters::AmberParameters()
 {
+    // build hash tables for the parameters keyed by type ids. when a
+    // parameter is listed more than once the first entry is used.
+    for(int i = 0; i < BondParametersCount; i++){
+        const struct BondParameters *parameters = &BondParameters[i];
+
+        int a = addType(parameters->typeA);
+        int b = addType(parameters->typeB);
+
+        if(a > b){
+            qSwap(a, b);
+        }
+
+        quint64 key = parameterKey(a, b);
+        if(!m_bondParameters.contains(key)){
+            m_bondParameters.insert(key, &parameters->parameters);
+        }
+    }
+
+    for(int i = 0; i < AngleParametersCount; i++){
+        const struct AngleParameters *parameters = &AngleParameters[i];
+
+        int a = addType(parameters->typeA);
+        int b = addType(parameters->typeB);
+        int c = addType(parameters->typeC);
+
+        if(a > c){
+            qSwap(a, c);
+        }
+
+        quint64 key = parameterKey(a, b, c);
+        if(!m_angleParameters.contains(key)){
+            m_angleParameters.insert(key, &parameters->parameters);
+        }
+    }
+
+    // torsions with an 'X' terminal type match any terminal atoms and
+    // are only used for atoms without a specific entry. each entry is
+    // stored in the direction with the lower central type id first so
+    // that it is found for the atoms in either direction.
+    for(int i = 0; i < TorsionParametersCount; i++){
+        const struct TorsionParameters *parameters = &TorsionParameters[i];
+
+        int a = addType(parameters->typeA);
+        int b = addType(parameters->typeB);
+        int c = addType(parameters->typeC);
+        int d = addType(parameters->typeD);
+
+        if(b > c || (b == c && a > d)){
+            qSwap(a, d);
+            qSwap(b, c);
+        }
+
+        if(strcmp("X", parameters->typeA) == 0){
+            quint64 key = parameterKey(b, c);
+            if(!m_wildcardTorsionParameters.contains(key)){
+                m_wildcardTorsionParameters.insert(key, &parameters->parameters);
+            }
+        }
+        else{
+            quint64 key = parameterKey(a, b, c, d);
+            if(!m_torsionParameters.contains(key)){
+                m_torsionParameters.insert(key, &parameters->parameters);
+            }
+        }
+    }
+
+    // improper torsions with 'X' types for the first or the first two
+    // atoms match any atoms in those positions
+    for(int i = 0; i < ImproperTorsionParametersCount; i++){
+        const struct ImproperTorsionParameters *parameters = &ImproperTorsionParameters[i];
+
+        int a = addType(parameters->typeA);
+        int b = addType(parameters->typeB);
+        int c = addType(parameters->typeC);
+        int d = addType(parameters->typeD);
+
+        quint64 key = parameterKey(a, b, c, d);
+        if(!m_improperTorsionParameters.contains(key)){
+            m_improperTorsionParameters.insert(key, &parameters->parameters);
+        }
+    }
+
+    for(int i = 0; i < NonbondedParametersCount; i++){
+        const struct NonbondedParameters *parameters = &NonbondedParameters[i];
+
+        int type = addType(parameters->type);
+        if(!m_nonbondedParameters.contains(type)){
+            m_nonbondedParameters.insert(type, &parameters->parameters);
+        }
+    }
+
+    // build the residue templates along with their N-terminal
+    // (e.g. NALA) and C-terminal (e.g. CALA) forms
+    for(int i = 0; i < ResidueAtomParametersCount; i++){
+        const struct ResidueAtomParameters *parameters = &ResidueAtomParameters[i];
+
+        AmberResidueAtomParameters &atom = m_residueTemplates[parameters->residue].atoms[parameters->atom];
+        atom.type = parameters->type;
+        atom.charge = parameters->charge;
+    }
+
+    std::map<std::string, AmberResidueTemplate> terminalTemplates;
+    std::map<std::string, AmberResidueTemplate>::const_iterator iter;
+    for(iter = m_residueTemplates.begin(); iter != m_residueTemplates.end(); ++iter){
+        terminalTemplates["N" + iter->first] = nTerminalResidue(iter->second, iter->first);
+        terminalTemplates["C" + iter->first] = cTerminalResidue(iter->second);
+    }
+    m_residueTemplates.insert(terminalTemplates.begin(), terminalTemplates.end());
 }
 
 AmberParameters::~AmberParameters()
@@ -636,71 +1285,127 @@ AmberParameters::~AmberParameters()
 // --- Parameters ---------------------------------------------------------- //
 const AmberBondParameters* AmberParameters::bondParameters(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b) const
 {
-    for(int i = 0; i < BondParametersCount; i++){
-        const struct BondParameters *parameters = &BondParameters[i];
+    int typeA = typeId(a->type());
+    int typeB = typeId(b->type());
+    if(typeA == -1 || typeB == -1){
+        return 0;
+    }
 
-        if((a->type() == parameters->typeA && b->type() == parameters->typeB) ||
-           (a->type() == parameters->typeB && (b->type() == parameters->typeA))){
-            return &parameters->parameters;
-        }
+    if(typeA > typeB){
+        qSwap(typeA, typeB);
     }
 
-    return 0;
+    return m_bondParameters.value(parameterKey(typeA, typeB), 0);
 }
 
 const AmberAngleParameters* AmberParameters::angleParameters(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b, const chemkit::ForceFieldAtom *c) const
 {
-    for(int i = 0; i < AngleParametersCount; i++){
-        const struct AngleParameters *parameters = &AngleParameters[i];
+    int typeA = typeId(a->type());
+    int typeB = typeId(b->type());
+    int typeC = typeId(c->type());
+    if(typeA == -1 || typeB == -1 || typeC == -1){
+        return 0;
+    }
 
-        if(b->type() == parameters->typeB){
-            if((a->type() == parameters->typeA && c->type() == parameters->typeC) ||
-               (a->type() == parameters->typeC && c->type() == parameters->typeA)){
-                return &parameters->parameters;
-            }
-        }
+    if(typeA > typeC){
+        qSwap(typeA, typeC);
     }
 
-    return 0;
+    return m_angleParameters.value(parameterKey(typeA, typeB, typeC), 0);
 }
 
 const AmberTorsionParameters* AmberParameters::torsionParameters(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b, const chemkit::ForceFieldAtom *c, const chemkit::ForceFieldAtom *d) const
 {
-    std::string typeA = a->type();
-    std::string typeB = b->type();
-    std::string typeC = c->type();
-    std::string typeD = d->type();
+    int typeA = typeId(a->type());
+    int typeB = typeId(b->type());
+    int typeC = typeId(c->type());
+    int typeD = typeId(d->type());
+    if(typeB == -1 || typeC == -1){
+        return 0;
+    }
 
-    if(typeB > typeC){
+    if(typeB > typeC || (typeB == typeC && typeA > typeD)){
+        qSwap(typeA, typeD);
         qSwap(typeB, typeC);
     }
 
-    for(int i = 0; i < TorsionParametersCount; i++){
-        const struct TorsionParameters *parameters = &TorsionParameters[i];
-
-        if(typeB == parameters->typeB && typeC == parameters->typeC){
-            if(strcmp("X", parameters->typeA) == 0){
-                return &parameters->parameters;
-            }
-            else if((typeA == parameters->typeA && typeD == parameters->typeD) ||
-                    (typeA == parameters->typeD && typeD == parameters->typeA)){
-                return &parameters->parameters;
-            }
+    if(typeA != -1 && typeD != -1){
+        const AmberTorsionParameters *parameters = m_torsionParameters.value(parameterKey(typeA, typeB, typeC, typeD), 0);
+        if(parameters){
+            return parameters;
         }
     }
 
-    return 0;
+    return m_wildcardTorsionParameters.value(parameterKey(typeB, typeC), 0);
+}
+
+// Returns the parameters for the improper torsion with the central
+// atom c or 0 if there are none. The atoms a, b and d must be sorted
+// by type.
+const AmberImproperTorsionParameters* AmberParameters::improperTorsionParameters(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b, const chemkit::ForceFieldAtom *c, const chemkit::ForceFieldAtom *d) const
+{
+    int typeA = typeId(a->type());
+    int typeB = typeId(b->type());
+    int typeC = typeId(c->type());
+    int typeD = typeId(d->type());
+    if(typeC == -1 || typeD == -1){
+        return 0;
+    }
+
+    int wildcard = typeId("X");
+
+    const AmberImproperTorsionParameters *parameters = 0;
+    if(typeA != -1 && typeB != -1){
+        parameters = m_improperTorsionParameters.value(parameterKey(typeA, typeB, typeC, typeD), 0);
+    }
+    if(!parameters && typeB != -1){
+        parameters = m_improperTorsionParameters.value(parameterKey(wildcard, typeB, typeC, typeD), 0);
+    }
+    if(!parameters){
+        parameters = m_improperTorsionParameters.value(parameterKey(wildcard, wildcard, typeC, typeD), 0);
+    }
+
+    return parameters;
 }
 
 const AmberNonbondedParameters* AmberParameters::nonbondedParameters(const chemkit::ForceFieldAtom *atom) const
 {
-    for(int i = 0; i < NonbondedParametersCount; i++){
-        const struct NonbondedParameters *parameters = &NonbondedParameters[i];
+    return m_nonbondedParameters.value(typeId(atom->type()), 0);
+}
 
-        if(atom->type() == parameters->type){
-            return &parameters->parameters;
-        }
+// Returns the template for the residue with name (e.g. "ALA", or
+// "NALA" and "CALA" for the terminal forms) or 0 if there is no
+// template for the residue.
+const AmberResidueTemplate* AmberParameters::residueTemplate(const std::string &name) const
+{
+    std::map<std::string, AmberResidueTemplate>::const_iterator location = m_residueTemplates.find(name);
+    if(location == m_residueTemplates.end()){
+        return 0;
+    }
+
+    return &location->second;
+}
+
+// --- Internal Methods ---------------------------------------------------- //
+// Returns the id for the atom type or -1 if the type has no parameters.
+int AmberParameters::typeId(const std::string &type) const
+{
+    std::map<std::string, int>::const_iterator location = m_typeIds.find(type);
+    if(location == m_typeIds.end()){
+        return -1;
+    }
+
+    return location->second;
+}
+
+int AmberParameters::addType(const std::string &type)
+{
+    std::map<std::string, int>::const_iterator location = m_typeIds.find(type);
+    if(location != m_typeIds.end()){
+        return location->second;
     }
 
-    return 0;
+    int id = m_typeIds.size();
+    m_typeIds[type] = id;
+    return id;
 }
@@ -36,6 +36,11 @@
 #ifndef AMBERPARAMETERS_H
 #define AMBERPARAMETERS_H
 
+#include <map>
+#include <string>
+
+#include <QtCore>
+
 #include <chemkit/forcefieldatom.h>
 
 struct AmberBondParameters
@@ -62,12 +67,33 @@ struct AmberTorsionParameters
     chemkit::Float gamma4;
 };
 
+struct AmberImproperTorsionParameters
+{
+    chemkit::Float V;
+    chemkit::Float gamma;
+    int n;
+};
+
 struct AmberNonbondedParameters
 {
     chemkit::Float vanDerWaalsRadius;
     chemkit::Float wellDepth;
 };
 
+struct AmberResidueAtomParameters
+{
+    std::string type;
+    chemkit::Float charge;
+};
+
+class AmberResidueTemplate
+{
+    public:
+        const AmberResidueAtomParameters* atomParameters(const std::string &name) const;
+
+        std::map<std::string, AmberResidueAtomParameters> atoms;
+};
+
 class AmberParameters
 {
     public:
@@ -79,7 +105,23 @@ class AmberParameters
         const AmberBondParameters* bondParameters(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b) const;
         const AmberAngleParameters* angleParameters(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b, const chemkit::ForceFieldAtom *c) const;
         const AmberTorsionParameters* torsionParameters(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b, const chemkit::ForceFieldAtom *c, const chemkit::ForceFieldAtom *d) const;
+        const AmberImproperTorsionParameters* improperTorsionParameters(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b, const chemkit::ForceFieldAtom *c, const chemkit::ForceFieldAtom *d) const;
         const AmberNonbondedParameters* nonbondedParameters(const chemkit::ForceFieldAtom *atom) const;
+        const AmberResidueTemplate* residueTemplate(const std::string &name) const;
+
+    private:
+        int typeId(const std::string &type) const;
+        int addType(const std::string &type);
+
+    private:
+        std::map<std::string, int> m_typeIds;
+        QHash<quint64, const AmberBondParameters *> m_bondParameters;
+        QHash<quint64, const AmberAngleParameters *> m_angleParameters;
+        QHash<quint64, const AmberTorsionParameters *> m_torsionParameters;
+        QHash<quint64, const AmberTorsionParameters *> m_wildcardTorsionParameters;
+        QHash<quint64, const AmberImproperTorsionParameters *> m_improperTorsionParameters;
+        QHash<int, const AmberNonbondedParameters *> m_nonbondedParameters;
+        std::map<std::string, AmberResidueTemplate> m_residueTemplates;
 };
 
 #endif // AMBERPARAMETERS_H
@@ -35,47 +35,46 @@
 
 #include "mmffatomtyper.h"
 
+#include <cstring>
+
 #include <chemkit/atom.h>
+#include <chemkit/bond.h>
 #include <chemkit/molecule.h>
 
 #include "mmffforcefield.h"
 
 namespace {
 
-bool isGuanidinium(const chemkit::Atom *atom)
+// The element slots used to count the neighbors of an atom by
+// element. All other elements share the last slot.
+enum ElementSlot {
+    HydrogenSlot,
+    CarbonSlot,
+    NitrogenSlot,
+    OxygenSlot,
+    PhosphorusSlot,
+    SulfurSlot,
+    OtherSlot
+};
+
+inline int elementSlot(int atomicNumber)
 {
-    if(atom->is(chemkit::Atom::Carbon)){
-        bool doubleBondedPositiveNitrogen = false;
-        int singleBondedNitrogenCount = 0;
-
-        foreach(const chemkit::Atom *neighbor, atom->neighbors()){
-            if(neighbor->is(chemkit::Atom::Nitrogen)){
-                if(neighbor->formalCharge() == 1 &&
-                   atom->bondTo(neighbor)->order() == chemkit::Bond::Double){
-                    doubleBondedPositiveNitrogen = true;
-                }
-                else if(atom->bondTo(neighbor)->order() == chemkit::Bond::Single &&
-                        neighbor->neighborCount() == 3){
-                    singleBondedNitrogenCount++;
-                }
-            }
-        }
-
-        if(doubleBondedPositiveNitrogen && singleBondedNitrogenCount == 2){
-            return true;
-        }
-    }
-    else if(atom->is(chemkit::Atom::Nitrogen)){
-        foreach(const chemkit::Atom *neighbor, atom->neighbors()){
-            if(neighbor->is(chemkit::Atom::Carbon)){
-                if(isGuanidinium(neighbor)){
-                    return true;
-                }
-            }
-        }
+    switch(atomicNumber){
+        case chemkit::Atom::Hydrogen:
+            return HydrogenSlot;
+        case chemkit::Atom::Carbon:
+            return CarbonSlot;
+        case chemkit::Atom::Nitrogen:
+            return NitrogenSlot;
+        case chemkit::Atom::Oxygen:
+            return OxygenSlot;
+        case chemkit::Atom::Phosphorus:
+            return PhosphorusSlot;
+        case chemkit::Atom::Sulfur:
+            return SulfurSlot;
+        default:
+            return OtherSlot;
     }
-
-    return false;
 }
 
 bool isPositiveAromaticNitrogenRing(const chemkit::Ring *ring)
@@ -121,181 +120,6 @@ bool isPositiveAromaticNitrogenRing(const chemkit::Ring *ring)
     return true;
 }
 
-bool isResonant(const chemkit::Atom *atom)
-{
-    if(atom->is(chemkit::Atom::Carbon)){
-        const chemkit::Atom *doubleBondedPositiveNitrogen = 0;
-        int singleBondedNitrogenCount = 0;
-
-        foreach(const chemkit::Atom *neighbor, atom->neighbors()){
-            const chemkit::Bond *bond = atom->bondTo(neighbor);
-
-            if(neighbor->is(chemkit::Atom::Nitrogen)){
-                if(bond->order() == chemkit::Bond::Double &&
-                   neighbor->neighborCount() == 3 &&
-                   neighbor->formalCharge() == 1){
-                    doubleBondedPositiveNitrogen = neighbor;
-
-                    foreach(const chemkit::Atom *secondNeighbor, neighbor->neighbors()){
-                        if(secondNeighbor->formalCharge() < 0 && secondNeighbor->isTerminal()){
-                            doubleBondedPositiveNitrogen = 0;
-                            break;
-                        }
-                    }
-                }
-                else if(bond->order() == chemkit::Bond::Single &&
-                        neighbor->neighborCount() == 3 &&
-                        neighbor->formalCharge() == 0){
-                    singleBondedNitrogenCount++;
-                }
-            }
-        }
-
-        foreach(const chemkit::Ring *ring, atom->rings()){
-            if(ring->contains(doubleBondedPositiveNitrogen) && isPositiveAromaticNitrogenRing(ring)){
-                return false;
-            }
-        }
-
-        if(doubleBondedPositiveNitrogen && singleBondedNitrogenCount == 1){
-            return true;
-        }
-    }
-    else if(atom->is(chemkit::Atom::Nitrogen)){
-        foreach(const chemkit::Atom *neighbor, atom->neighbors()){
-            if(neighbor->is(chemkit::Atom::Carbon)){
-                if(isResonant(neighbor)){
-                    return true;
-                }
-            }
-        }
-    }
-
-    return false;
-}
-
-bool isAmide(const chemkit::Atom *atom)
-{
-    if(atom->is(chemkit::Atom::Carbon)){
-        if(atom->isBondedTo(chemkit::Atom::Oxygen, chemkit::Bond::Double) &&
-           atom->isBondedTo(chemkit::Atom::Nitrogen, chemkit::Bond::Single)){
-            return true;
-        }
-        else if(atom->isBondedTo(chemkit::Atom::Sulfur, chemkit::Bond::Double) &&
-                atom->isBondedTo(chemkit::Atom::Nitrogen, chemkit::Bond::Single)){
-            return true;
-        }
-    }
-    else if(atom->is(chemkit::Atom::Nitrogen)){
-        foreach(const chemkit::Atom *neighbor, atom->neighbors()){
-            if(neighbor->is(chemkit::Atom::Carbon)){
-                if(isAmide(neighbor)){
-                    return true;
-                }
-            }
-        }
-    }
-
-    return false;
-}
-
-bool isPhosphate(const chemkit::Atom *atom)
-{
-    if(atom->is(chemkit::Atom::Phosphorus)){
-        if(atom->isInRing()){
-            return false;
-        }
-
-        int singleBondedOxygenCount = 0;
-        int doubleBondedOxygenCount = 0;
-
-        foreach(const chemkit::Atom *neighbor, atom->neighbors()){
-            if(neighbor->is(chemkit::Atom::Oxygen)){
-                const chemkit::Bond *bond = atom->bondTo(neighbor);
-
-                if(bond->order() == chemkit::Bond::Single){
-                    singleBondedOxygenCount++;
-                }
-                else if(bond->order() == chemkit::Bond::Double){
-                    doubleBondedOxygenCount++;
-                }
-            }
-        }
-
-        int oxygenCount = singleBondedOxygenCount + doubleBondedOxygenCount;
-        if(oxygenCount >= 2 && doubleBondedOxygenCount >= 1){
-            return true;
-        }
-    }
-
-    return false;
-}
-
-bool isSulfate(const chemkit::Atom *atom)
-{
-    if(atom->is(chemkit::Atom::Sulfur)){
-        int singleBondedOxygenCount = 0;
-        int doubleBondedOxygenCount = 0;
-
-        foreach(const chemkit::Atom *neighbor, atom->neighbors()){
-            if(neighbor->is(chemkit::Atom::Oxygen)){
-                const chemkit::Bond *bond = atom->bondTo(neighbor);
-
-                if(bond->order() == chemkit::Bond::Single){
-                    singleBondedOxygenCount++;
-                }
-                else if(bond->order() == chemkit::Bond::Double){
-                    doubleBondedOxygenCount++;
-                }
-            }
-        }
-
-        int oxygenCount = singleBondedOxygenCount + doubleBondedOxygenCount;
-        if(oxygenCount >= 2 && doubleBondedOxygenCount >= 1){
-            return true;
-        }
-    }
-
-    return false;
-}
-
-bool isThiocarboxylate(const chemkit::Atom *atom)
-{
-    if(atom->is(chemkit::Atom::Carbon)){
-        bool negativeSulfur = false;
-        bool doubleBondedSulfur = false;
-        int sulfurCount = 0;
-
-        foreach(const chemkit::Atom *neighbor, atom->neighbors()){
-            const chemkit::Bond *bond = atom->bondTo(neighbor);
-
-            if(neighbor->is(chemkit::Atom::Sulfur) && neighbor->isTerminal()){
-                sulfurCount++;
-
-                if(bond->order() == chemkit::Bond::Single && neighbor->formalCharge() == -1){
-                    negativeSulfur = true;
-                }
-                else if(bond->order() == chemkit::Bond::Double && neighbor->formalCharge() == 0){
-                    doubleBondedSulfur = true;
-                }
-            }
-        }
-
-        if(sulfurCount == 2 && negativeSulfur && doubleBondedSulfur){
-            return true;
-        }
-    }
-    else if(atom->is(chemkit::Atom::Sulfur)){
-        foreach(const chemkit::Atom *neighbor, atom->neighbors()){
-            if(neighbor->is(chemkit::Atom::Carbon) && isThiocarboxylate(neighbor)){
-                return true;
-            }
-        }
-    }
-
-    return false;
-}
-
 int ringPosition(const chemkit::Atom *atom, const chemkit::Ring *ring)
 {
     if(ring->size() != 5){
@@ -410,7 +234,7 @@ int MmffAtomTyper::typeNumber(int index) const
 
 int MmffAtomTyper::typeNumber(const chemkit::Atom *atom) const
 {
-    return typeNumber(atom->index());
+    return typeNumber(atomIndex(atom));
 }
 
 // --- Charges ------------------------------------------------------------- //
@@ -421,7 +245,7 @@ chemkit::Float MmffAtomTyper::formalCharge(int index) const
 
 chemkit::Float MmffAtomTyper::formalCharge(const chemkit::Atom *atom) const
 {
-    return formalCharge(atom->index());
+    return formalCharge(atomIndex(atom));
 }
 
 // --- Internal Methods ---------------------------------------------------- //
@@ -429,54 +253,436 @@ void MmffAtomTyper::assignTypes(const chemkit::Molecule *molecule)
 {
     if(!molecule){
         m_types.resize(0);
+        m_environments.clear();
+        m_neighbors.clear();
+        m_indices.clear();
         return;
     }
 
-    m_types.resize(molecule->atomCount());
-    m_formalCharges.resize(molecule->atomCount());
+    m_types.fill(0, molecule->atomCount());
+    m_formalCharges.fill(0, molecule->atomCount());
 
-    QList<const chemkit::Atom *> terminalHydrogens;
+    // find aromatic rings and build the atom environments
+    std::vector<const chemkit::Ring *> aromaticRings;
+    assignEnvironments(molecule, aromaticRings);
 
     // assign types to heavy atoms
     for(int i = 0; i < molecule->atomCount(); i++){
-        const chemkit::Atom *atom = molecule->atom(i);
+        const AtomEnvironment &environment = m_environments[i];
 
-        if(atom->isTerminalHydrogen()){
-            terminalHydrogens.append(atom);
-        }
-        else{
-            setType(i, molecule->atom(i));
+        if(environment.atomicNumber != chemkit::Atom::Hydrogen ||
+           environment.neighborCount != 1){
+            setType(i);
         }
     }
 
     // assign aromatic atom types
-    QList<const chemkit::Ring *> sixMemberedAromaticRings;
-    QList<const chemkit::Ring *> fiveMemberedAromaticRings;
-    foreach(const chemkit::Ring *ring, molecule->rings()){
-        if(ring->size() == 5 && MmffForceField::isAromatic(ring)){
-            fiveMemberedAromaticRings.append(ring);
+    foreach(const chemkit::Ring *ring, aromaticRings){
+        foreach(const chemkit::Atom *atom, ring->atoms()){
+            setAromaticType(atomIndex(atom), ring, ringPosition(atom, ring));
         }
-        else if(ring->size() == 6 && MmffForceField::isAromatic(ring)){
-            sixMemberedAromaticRings.append(ring);
+    }
+
+    // assign terminal hydrogen types
+    for(int i = 0; i < molecule->atomCount(); i++){
+        const AtomEnvironment &environment = m_environments[i];
+
+        if(environment.atomicNumber == chemkit::Atom::Hydrogen &&
+           environment.neighborCount == 1){
+            setHydrogenType(i);
         }
     }
+}
 
-    foreach(const chemkit::Ring *ring, sixMemberedAromaticRings){
-        foreach(const chemkit::Atom *atom, ring->atoms()){
-            setAromaticType(atom->index(), atom, ring, ringPosition(atom, ring));
+// Copies the types and formal charges from typer. The atom
+// environments are only needed while assigning types and are not
+// copied.
+bool MmffAtomTyper::copyTypes(const chemkit::AtomTyper *typer)
+{
+    const MmffAtomTyper *mmffTyper = static_cast<const MmffAtomTyper *>(typer);
+
+    m_types = mmffTyper->m_types;
+    m_formalCharges = mmffTyper->m_formalCharges;
+    m_indices = mmffTyper->m_indices;
+    m_environments.clear();
+    m_neighbors.clear();
+
+    return true;
+}
+
+// Builds the environment record for each atom in the molecule and
+// adds the aromatic rings to aromaticRings (six membered rings
+// first followed by five membered rings).
+void MmffAtomTyper::assignEnvironments(const chemkit::Molecule *molecule, std::vector<const chemkit::Ring *> &aromaticRings)
+{
+    int atomCount = molecule->atomCount();
+
+    m_indices.clear();
+    m_indices.reserve(atomCount);
+    for(int i = 0; i < atomCount; i++){
+        m_indices[molecule->atom(i)] = i;
+    }
+
+    m_environments.resize(atomCount);
+    m_neighbors.resize(2 * molecule->bondCount());
+
+    // element, charge and neighbor counts
+    for(int i = 0; i < atomCount; i++){
+        const chemkit::Atom *atom = molecule->atom(i);
+        AtomEnvironment &environment = m_environments[i];
+
+        environment.atom = atom;
+        environment.atomicNumber = atom->atomicNumber();
+        environment.formalCharge = atom->formalCharge();
+        environment.neighborCount = 0;
+        environment.valence = 0;
+        environment.ringSizes = 0;
+        environment.smallestRing = 0;
+        environment.aromatic = false;
+        memset(environment.elementCounts, 0, sizeof(environment.elementCounts));
+        memset(environment.bondCounts, 0, sizeof(environment.bondCounts));
+    }
+
+    foreach(const chemkit::Bond *bond, molecule->bonds()){
+        m_environments[atomIndex(bond->atom1())].neighborCount++;
+        m_environments[atomIndex(bond->atom2())].neighborCount++;
+    }
+
+    int firstNeighbor = 0;
+    for(int i = 0; i < atomCount; i++){
+        m_environments[i].firstNeighbor = firstNeighbor;
+        firstNeighbor += m_environments[i].neighborCount;
+    }
+
+    // neighbor lists in the same order as the atom's bonds
+    for(int i = 0; i < atomCount; i++){
+        const chemkit::Atom *atom = molecule->atom(i);
+        AtomEnvironment &environment = m_environments[i];
+        Neighbor *neighbor = &m_neighbors[environment.firstNeighbor];
+
+        foreach(const chemkit::Bond *bond, atom->bonds()){
+            int order = bond->order();
+            int slot = elementSlot(bond->otherAtom(atom)->atomicNumber());
+
+            neighbor->index = atomIndex(bond->otherAtom(atom));
+            neighbor->bondOrder = order;
+            neighbor++;
+
+            environment.valence += order;
+            environment.elementCounts[slot]++;
+            if(order >= chemkit::Bond::Single && order <= chemkit::Bond::Triple){
+                environment.bondCounts[slot][order - 1]++;
+            }
         }
     }
 
-    foreach(const chemkit::Ring *ring, fiveMemberedAromaticRings){
+    // ring membership
+    std::vector<const chemkit::Ring *> fiveMemberedAromaticRings;
+
+    foreach(const chemkit::Ring *ring, molecule->rings()){
+        int size = ring->size();
+
         foreach(const chemkit::Atom *atom, ring->atoms()){
-            setAromaticType(atom->index(), atom, ring, ringPosition(atom, ring));
+            AtomEnvironment &environment = m_environments[atomIndex(atom)];
+
+            if(size < 32){
+                environment.ringSizes |= 1 << size;
+            }
+            if(!environment.smallestRing || size < environment.smallestRing->size()){
+                environment.smallestRing = ring;
+            }
+        }
+
+        if((size == 5 || size == 6) && MmffForceField::isAromatic(ring)){
+            foreach(const chemkit::Atom *atom, ring->atoms()){
+                m_environments[atomIndex(atom)].aromatic = true;
+            }
+
+            if(size == 6){
+                aromaticRings.push_back(ring);
+            }
+            else{
+                fiveMemberedAromaticRings.push_back(ring);
+            }
         }
     }
 
-    // assign terminal hydrogen types
-    foreach(const chemkit::Atom *atom, terminalHydrogens){
-        setHydrogenType(atom->index(), atom);
+    aromaticRings.insert(aromaticRings.end(), fiveMemberedAromaticRings.begin(), fiveMemberedAromaticRings.end());
+}
+
+// Returns the index of atom in the molecule.
+inline int MmffAtomTyper::atomIndex(const chemkit::Atom *atom) const
+{
+    QHash<const chemkit::Atom *, int>::const_iterator location = m_indices.constFind(atom);
+    if(location == m_indices.constEnd()){
+        return atom->index();
     }
+
+    return location.value();
+}
+
+inline const MmffAtomTyper::Neighbor* MmffAtomTyper::neighborsBegin(int index) const
+{
+    return &m_neighbors[0] + m_environments[index].firstNeighbor;
+}
+
+inline const MmffAtomTyper::Neighbor* MmffAtomTyper::neighborsEnd(int index) const
+{
+    return neighborsBegin(index) + m_environments[index].neighborCount;
+}
+
+// Returns the number of neighbors of the atom at index with element.
+int MmffAtomTyper::neighborCount(int index, int element) const
+{
+    int slot = elementSlot(element);
+    if(slot != OtherSlot){
+        return m_environments[index].elementCounts[slot];
+    }
+
+    int count = 0;
+    for(const Neighbor *neighbor = neighborsBegin(index); neighbor != neighborsEnd(index); ++neighbor){
+        if(m_environments[neighbor->index].atomicNumber == element){
+            count++;
+        }
+    }
+
+    return count;
+}
+
+// Returns true if the atom at index is bonded to an atom of element.
+bool MmffAtomTyper::isBondedTo(int index, int element) const
+{
+    return neighborCount(index, element) > 0;
+}
+
+// Returns true if the atom at index is bonded to an atom of element
+// with a bond of bondOrder.
+bool MmffAtomTyper::isBondedTo(int index, int element, int bondOrder) const
+{
+    int slot = elementSlot(element);
+    if(slot != OtherSlot && bondOrder >= chemkit::Bond::Single && bondOrder <= chemkit::Bond::Triple){
+        return m_environments[index].bondCounts[slot][bondOrder - 1] > 0;
+    }
+
+    for(const Neighbor *neighbor = neighborsBegin(index); neighbor != neighborsEnd(index); ++neighbor){
+        if(m_environments[neighbor->index].atomicNumber == element && neighbor->bondOrder == bondOrder){
+            return true;
+        }
+    }
+
+    return false;
+}
+
+inline bool MmffAtomTyper::isInRing(int index) const
+{
+    return m_environments[index].smallestRing != 0;
+}
+
+inline bool MmffAtomTyper::isInRing(int index, int size) const
+{
+    return (m_environments[index].ringSizes & (1 << size)) != 0;
+}
+
+bool MmffAtomTyper::isGuanidinium(int index) const
+{
+    const AtomEnvironment &environment = m_environments[index];
+
+    if(environment.atomicNumber == chemkit::Atom::Carbon){
+        bool doubleBondedPositiveNitrogen = false;
+        int singleBondedNitrogenCount = 0;
+
+        for(const Neighbor *neighbor = neighborsBegin(index); neighbor != neighborsEnd(index); ++neighbor){
+            const AtomEnvironment &neighborEnvironment = m_environments[neighbor->index];
+
+            if(neighborEnvironment.atomicNumber == chemkit::Atom::Nitrogen){
+                if(neighborEnvironment.formalCharge == 1 &&
+                   neighbor->bondOrder == chemkit::Bond::Double){
+                    doubleBondedPositiveNitrogen = true;
+                }
+                else if(neighbor->bondOrder == chemkit::Bond::Single &&
+                        neighborEnvironment.neighborCount == 3){
+                    singleBondedNitrogenCount++;
+                }
+            }
+        }
+
+        if(doubleBondedPositiveNitrogen && singleBondedNitrogenCount == 2){
+            return true;
+        }
+    }
+    else if(environment.atomicNumber == chemkit::Atom::Nitrogen){
+        for(const Neighbor *neighbor = neighborsBegin(index); neighbor != neighborsEnd(index); ++neighbor){
+            if(m_environments[neighbor->index].atomicNumber == chemkit::Atom::Carbon){
+                if(isGuanidinium(neighbor->index)){
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+bool MmffAtomTyper::isResonant(int index) const
+{
+    const AtomEnvironment &environment = m_environments[index];
+
+    if(environment.atomicNumber == chemkit::Atom::Carbon){
+        int doubleBondedPositiveNitrogen = -1;
+        int singleBondedNitrogenCount = 0;
+
+        for(const Neighbor *neighbor = neighborsBegin(index); neighbor != neighborsEnd(index); ++neighbor){
+            const AtomEnvironment &neighborEnvironment = m_environments[neighbor->index];
+
+            if(neighborEnvironment.atomicNumber == chemkit::Atom::Nitrogen){
+                if(neighbor->bondOrder == chemkit::Bond::Double &&
+                   neighborEnvironment.neighborCount == 3 &&
+                   neighborEnvironment.formalCharge == 1){
+                    doubleBondedPositiveNitrogen = neighbor->index;
+
+                    for(const Neighbor *secondNeighbor = neighborsBegin(neighbor->index); secondNeighbor != neighborsEnd(neighbor->index); ++secondNeighbor){
+                        const AtomEnvironment &secondNeighborEnvironment = m_environments[secondNeighbor->index];
+
+                        if(secondNeighborEnvironment.formalCharge < 0 && secondNeighborEnvironment.neighborCount == 1){
+                            doubleBondedPositiveNitrogen = -1;
+                            break;
+                        }
+                    }
+                }
+                else if(neighbor->bondOrder == chemkit::Bond::Single &&
+                        neighborEnvironment.neighborCount == 3 &&
+                        neighborEnvironment.formalCharge == 0){
+                    singleBondedNitrogenCount++;
+                }
+            }
+        }
+
+        if(doubleBondedPositiveNitrogen == -1){
+            return false;
+        }
+
+        const chemkit::Atom *nitrogen = m_environments[doubleBondedPositiveNitrogen].atom;
+        foreach(const chemkit::Ring *ring, environment.atom->rings()){
+            if(ring->contains(nitrogen) && isPositiveAromaticNitrogenRing(ring)){
+                return false;
+            }
+        }
+
+        if(singleBondedNitrogenCount == 1){
+            return true;
+        }
+    }
+    else if(environment.atomicNumber == chemkit::Atom::Nitrogen){
+        for(const Neighbor *neighbor = neighborsBegin(index); neighbor != neighborsEnd(index); ++neighbor){
+            if(m_environments[neighbor->index].atomicNumber == chemkit::Atom::Carbon){
+                if(isResonant(neighbor->index)){
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+bool MmffAtomTyper::isAmide(int index) const
+{
+    const AtomEnvironment &environment = m_environments[index];
+
+    if(environment.atomicNumber == chemkit::Atom::Carbon){
+        if(isBondedTo(index, chemkit::Atom::Oxygen, chemkit::Bond::Double) &&
+           isBondedTo(index, chemkit::Atom::Nitrogen, chemkit::Bond::Single)){
+            return true;
+        }
+        else if(isBondedTo(index, chemkit::Atom::Sulfur, chemkit::Bond::Double) &&
+                isBondedTo(index, chemkit::Atom::Nitrogen, chemkit::Bond::Single)){
+            return true;
+        }
+    }
+    else if(environment.atomicNumber == chemkit::Atom::Nitrogen){
+        for(const Neighbor *neighbor = neighborsBegin(index); neighbor != neighborsEnd(index); ++neighbor){
+            if(m_environments[neighbor->index].atomicNumber == chemkit::Atom::Carbon){
+                if(isAmide(neighbor->index)){
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+bool MmffAtomTyper::isPhosphate(int index) const
+{
+    if(m_environments[index].atomicNumber == chemkit::Atom::Phosphorus){
+        if(isInRing(index)){
+            return false;
+        }
+
+        int singleBondedOxygenCount = m_environments[index].bondCounts[OxygenSlot][chemkit::Bond::Single - 1];
+        int doubleBondedOxygenCount = m_environments[index].bondCounts[OxygenSlot][chemkit::Bond::Double - 1];
+
+        int oxygenCount = singleBondedOxygenCount + doubleBondedOxygenCount;
+        if(oxygenCount >= 2 && doubleBondedOxygenCount >= 1){
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool MmffAtomTyper::isSulfate(int index) const
+{
+    if(m_environments[index].atomicNumber == chemkit::Atom::Sulfur){
+        int singleBondedOxygenCount = m_environments[index].bondCounts[OxygenSlot][chemkit::Bond::Single - 1];
+        int doubleBondedOxygenCount = m_environments[index].bondCounts[OxygenSlot][chemkit::Bond::Double - 1];
+
+        int oxygenCount = singleBondedOxygenCount + doubleBondedOxygenCount;
+        if(oxygenCount >= 2 && doubleBondedOxygenCount >= 1){
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool MmffAtomTyper::isThiocarboxylate(int index) const
+{
+    const AtomEnvironment &environment = m_environments[index];
+
+    if(environment.atomicNumber == chemkit::Atom::Carbon){
+        bool negativeSulfur = false;
+        bool doubleBondedSulfur = false;
+        int sulfurCount = 0;
+
+        for(const Neighbor *neighbor = neighborsBegin(index); neighbor != neighborsEnd(index); ++neighbor){
+            const AtomEnvironment &neighborEnvironment = m_environments[neighbor->index];
+
+            if(neighborEnvironment.atomicNumber == chemkit::Atom::Sulfur && neighborEnvironment.neighborCount == 1){
+                sulfurCount++;
+
+                if(neighbor->bondOrder == chemkit::Bond::Single && neighborEnvironment.formalCharge == -1){
+                    negativeSulfur = true;
+                }
+                else if(neighbor->bondOrder == chemkit::Bond::Double && neighborEnvironment.formalCharge == 0){
+                    doubleBondedSulfur = true;
+                }
+            }
+        }
+
+        if(sulfurCount == 2 && negativeSulfur && doubleBondedSulfur){
+            return true;
+        }
+    }
+    else if(environment.atomicNumber == chemkit::Atom::Sulfur){
+        for(const Neighbor *neighbor = neighborsBegin(index); neighbor != neighborsEnd(index); ++neighbor){
+            if(m_environments[neighbor->index].atomicNumber == chemkit::Atom::Carbon && isThiocarboxylate(neighbor->index)){
+                return true;
+            }
+        }
+    }
+
+    return false;
 }
 
 void MmffAtomTyper::setType(int index, int type, chemkit::Float formalCharge)
@@ -485,50 +691,52 @@ void MmffAtomTyper::setType(int index, int type, chemkit::Float formalCharge)
     m_formalCharges[index] = formalCharge;
 }
 
-void MmffAtomTyper::setType(int index, const chemkit::Atom *atom)
+void MmffAtomTyper::setType(int index)
 {
-    switch(atom->atomicNumber()){
+    const AtomEnvironment &environment = m_environments[index];
+
+    switch(environment.atomicNumber){
         // carbon
         case chemkit::Atom::Carbon:
-            setCarbonType(index, atom);
+            setCarbonType(index);
             break;
 
         // nitrogen
         case chemkit::Atom::Nitrogen:
-            setNitrogenType(index, atom);
+            setNitrogenType(index);
             break;
 
         // oxygen
         case chemkit::Atom::Oxygen:
-            setOxygenType(index, atom);
+            setOxygenType(index);
             break;
 
         // phosphorus
         case chemkit::Atom::Phosphorus:
-            if(atom->neighborCount() == 4){
+            if(environment.neighborCount == 4){
                 setType(index, 25);
             }
-            else if(atom->neighborCount() == 3){
-                if(atom->isBondedTo(chemkit::Atom::Carbon, chemkit::Bond::Double)){
+            else if(environment.neighborCount == 3){
+                if(isBondedTo(index, chemkit::Atom::Carbon, chemkit::Bond::Double)){
                     setType(index, 75);
                 }
                 else{
                     setType(index, 26);
                 }
             }
-            else if(atom->neighborCount() == 2 && atom->isBondedTo(chemkit::Atom::Carbon)){
+            else if(environment.neighborCount == 2 && isBondedTo(index, chemkit::Atom::Carbon)){
                 setType(index, 75);
             }
             break;
 
         // sulfur
         case chemkit::Atom::Sulfur:
-            setSulfurType(index, atom);
+            setSulfurType(index);
             break;
 
         // fluorine
         case chemkit::Atom::Fluorine:
-            if(atom->valence() > 0){
+            if(environment.valence > 0){
                 setType(index, 11);
             }
             else{
@@ -538,10 +746,10 @@ void MmffAtomTyper::setType(int index, const chemkit::Atom *atom)
 
         // chlorine
         case chemkit::Atom::Chlorine:
-            if(atom->neighborCount(chemkit::Atom::Oxygen) == 4){
+            if(neighborCount(index, chemkit::Atom::Oxygen) == 4){
                 setType(index, 77);
             }
-            else if(atom->valence() > 0){
+            else if(environment.valence > 0){
                 setType(index, 12);
             }
             else{
@@ -551,7 +759,7 @@ void MmffAtomTyper::setType(int index, const chemkit::Atom *atom)
 
         // bromine
         case chemkit::Atom::Bromine:
-            if(atom->valence() > 0){
+            if(environment.valence > 0){
                 setType(index, 13);
             }
             else{
@@ -561,14 +769,14 @@ void MmffAtomTyper::setType(int index, const chemkit::Atom *atom)
 
         // iodine
         case chemkit::Atom::Iodine:
-            if(atom->valence() > 0){
+            if(environment.valence > 0){
                 setType(index, 14);
             }
             break;
 
         // iron
         case chemkit::Atom::Iron:
-            if(qRound(atom->partialCharge()) == 2){
+            if(qRound(environment.atom->partialCharge()) == 2){
                 setType(index, 87, 2.0);
             }
             else{
@@ -603,7 +811,7 @@ void MmffAtomTyper::setType(int index, const chemkit::Atom *atom)
 
         // copper
         case chemkit::Atom::Copper:
-            if(qRound(atom->partialCharge()) == 2){
+            if(qRound(environment.atom->partialCharge()) == 2){
                 setType(index, 98, 2.0);
             }
             else{
@@ -626,20 +834,21 @@ void MmffAtomTyper::setType(int index, const chemkit::Atom *atom)
     }
 }
 
-void MmffAtomTyper::setHydrogenType(int index, const chemkit::Atom *atom)
+void MmffAtomTyper::setHydrogenType(int index)
 {
-    Q_ASSERT(atom->isTerminalHydrogen());
+    Q_ASSERT(m_environments[index].neighborCount == 1);
 
-    const chemkit::Atom *neighbor = atom->neighbor(0);
+    int neighbor = neighborsBegin(index)->index;
+    const AtomEnvironment &neighborEnvironment = m_environments[neighbor];
     int neighborType = typeNumber(neighbor);
 
     // carbon
-    if(neighbor->is(chemkit::Atom::Carbon)){
+    if(neighborEnvironment.atomicNumber == chemkit::Atom::Carbon){
         setType(index, 5);
     }
 
     // nitrogen
-    else if(neighbor->is(chemkit::Atom::Nitrogen)){
+    else if(neighborEnvironment.atomicNumber == chemkit::Atom::Nitrogen){
         if(neighborType == 8 || neighborType == 39 || neighborType == 45 ||
            neighborType == 62 || neighborType == 67 || neighborType == 68){
             setType(index, 23);
@@ -658,8 +867,8 @@ void MmffAtomTyper::setHydrogenType(int index, const chemkit::Atom *atom)
     }
 
     // oxygen
-    else if(neighbor->is(chemkit::Atom::Oxygen)){
-        if(neighbor->isBondedTo(chemkit::Atom::Sulfur)){
+    else if(neighborEnvironment.atomicNumber == chemkit::Atom::Oxygen){
+        if(isBondedTo(neighbor, chemkit::Atom::Sulfur)){
             setType(index, 33);
         }
         else if(neighborType == 6){
@@ -667,24 +876,26 @@ void MmffAtomTyper::setHydrogenType(int index, const chemkit::Atom *atom)
             bool carboxylicAcid = false;
             bool phosphate = false;
 
-            foreach(const chemkit::Atom *secondNeighbor, neighbor->neighbors()){
-                if(secondNeighbor == atom){
+            for(const Neighbor *secondNeighbor = neighborsBegin(neighbor); secondNeighbor != neighborsEnd(neighbor); ++secondNeighbor){
+                if(secondNeighbor->index == index){
                     continue;
                 }
 
-                if((secondNeighbor->is(chemkit::Atom::Carbon) || secondNeighbor->is(chemkit::Atom::Phosphorus)) &&
-                   secondNeighbor->isBondedTo(chemkit::Atom::Oxygen, chemkit::Bond::Double)){
+                int secondNeighborElement = m_environments[secondNeighbor->index].atomicNumber;
+
+                if((secondNeighborElement == chemkit::Atom::Carbon || secondNeighborElement == chemkit::Atom::Phosphorus) &&
+                   isBondedTo(secondNeighbor->index, chemkit::Atom::Oxygen, chemkit::Bond::Double)){
                     carboxylicAcid = true;
                     break;
                 }
-                else if(secondNeighbor->is(chemkit::Atom::Carbon) &&
-                        (secondNeighbor->isBondedTo(chemkit::Atom::Carbon, chemkit::Bond::Double) ||
-                        secondNeighbor->isBondedTo(chemkit::Atom::Nitrogen, chemkit::Bond::Double))){
+                else if(secondNeighborElement == chemkit::Atom::Carbon &&
+                        (isBondedTo(secondNeighbor->index, chemkit::Atom::Carbon, chemkit::Bond::Double) ||
+                         isBondedTo(secondNeighbor->index, chemkit::Atom::Nitrogen, chemkit::Bond::Double))){
                     imineOrEnol = true;
                     break;
                 }
-                else if(secondNeighbor->is(chemkit::Atom::Phosphorus) &&
-                        secondNeighbor->neighborCount(chemkit::Atom::Oxygen) >= 2){
+                else if(secondNeighborElement == chemkit::Atom::Phosphorus &&
+                        neighborCount(secondNeighbor->index, chemkit::Atom::Oxygen) >= 2){
                     phosphate = true;
                 }
             }
@@ -720,30 +931,32 @@ void MmffAtomTyper::setHydrogenType(int index, const chemkit::Atom *atom)
     }
 
     // phosphorus
-    else if(neighbor->is(chemkit::Atom::Phosphorus)){
+    else if(neighborEnvironment.atomicNumber == chemkit::Atom::Phosphorus){
         setType(index, 71);
     }
 
     // sulfur
-    else if(neighbor->is(chemkit::Atom::Sulfur)){
+    else if(neighborEnvironment.atomicNumber == chemkit::Atom::Sulfur){
         setType(index, 71);
     }
 
     // silicon
-    else if(neighbor->is(chemkit::Atom::Silicon)){
+    else if(neighborEnvironment.atomicNumber == chemkit::Atom::Silicon){
         setType(index, 5);
     }
 }
 
-void MmffAtomTyper::setCarbonType(int index, const chemkit::Atom *atom)
+void MmffAtomTyper::setCarbonType(int index)
 {
+    const AtomEnvironment &environment = m_environments[index];
+
     // four neighbors
-    if(atom->neighborCount() == 4){
-        if(atom->isInRing(3)){
+    if(environment.neighborCount == 4){
+        if(isInRing(index, 3)){
             setType(index, 22); // carbon in three membered ring
         }
-        else if(atom->isInRing(4)){
-            if(atom->isBondedTo(chemkit::Atom::Carbon, chemkit::Bond::Double)){
+        else if(isInRing(index, 4)){
+            if(isBondedTo(index, chemkit::Atom::Carbon, chemkit::Bond::Double)){
                 setType(index, 30); // olefinic carbon in four membered ring
             }
             else{
@@ -756,14 +969,16 @@ void MmffAtomTyper::setCarbonType(int index, const chemkit::Atom *atom)
     }
 
     // three neighbors
-    else if(atom->neighborCount() == 3){
-        const chemkit::Ring *smallestRing = atom->smallestRing();
+    else if(environment.neighborCount == 3){
+        const chemkit::Ring *smallestRing = environment.smallestRing;
 
-        if(atom->isBondedTo(chemkit::Atom::Oxygen, chemkit::Bond::Double)){
-            if(atom->neighborCount(chemkit::Atom::Oxygen) == 2){
+        if(isBondedTo(index, chemkit::Atom::Oxygen, chemkit::Bond::Double)){
+            if(neighborCount(index, chemkit::Atom::Oxygen) == 2){
                 bool isNegative = false;
-                foreach(const chemkit::Atom *neighbor, atom->neighbors()){
-                    if(neighbor->is(chemkit::Atom::Oxygen) && neighbor->formalCharge() < 0){
+                for(const Neighbor *neighbor = neighborsBegin(index); neighbor != neighborsEnd(index); ++neighbor){
+                    const AtomEnvironment &neighborEnvironment = m_environments[neighbor->index];
+
+                    if(neighborEnvironment.atomicNumber == chemkit::Atom::Oxygen && neighborEnvironment.formalCharge < 0){
                         isNegative = true;
                     }
                 }
@@ -775,54 +990,56 @@ void MmffAtomTyper::setCarbonType(int index, const chemkit::Atom *atom)
                     setType(index, 3);
                 }
             }
-            else if(atom->neighborCount(chemkit::Atom::Nitrogen) == 1){
+            else if(neighborCount(index, chemkit::Atom::Nitrogen) == 1){
                 setType(index, 3); // amide carbonyl carbon
             }
-            else if(atom->neighborCount(chemkit::Atom::Nitrogen) == 2){
+            else if(neighborCount(index, chemkit::Atom::Nitrogen) == 2){
                 setType(index, 3); // urea carbonyl carbon
             }
-            else if(atom->neighborCount(chemkit::Atom::Carbon) >= 1){
+            else if(neighborCount(index, chemkit::Atom::Carbon) >= 1){
                 setType(index, 3);
             }
             else{
                 setType(index, 3); // general carbonyl carbon
             }
         }
-        else if(atom->isBondedTo(chemkit::Atom::Carbon, chemkit::Bond::Double)){
-            if(atom->isInRing(4)){
+        else if(isBondedTo(index, chemkit::Atom::Carbon, chemkit::Bond::Double)){
+            if(isInRing(index, 4)){
                 setType(index, 30);
             }
             else{
                 setType(index, 2); // vinylic carbon
             }
         }
-        else if(atom->isInRing() && smallestRing->size() == 3 && !smallestRing->isHeterocycle()){
+        else if(smallestRing && smallestRing->size() == 3 && !smallestRing->isHeterocycle()){
             setType(index, 22);
         }
-        else if(isResonant(atom)){
+        else if(isResonant(index)){
             setType(index, 57); // +N=C-N resonance structure
         }
-        else if(isGuanidinium(atom)){
+        else if(isGuanidinium(index)){
             setType(index, 57); // CGD+ guanidinium
         }
-        else if(atom->isBondedTo(chemkit::Atom::Nitrogen, chemkit::Bond::Double)){
+        else if(isBondedTo(index, chemkit::Atom::Nitrogen, chemkit::Bond::Double)){
             setType(index, 3);
         }
         else if(smallestRing && smallestRing->size() == 4){
             setType(index, 20);
         }
-        else if(atom->isBondedTo(chemkit::Atom::Phosphorus, chemkit::Bond::Double) ||
-                atom->isBondedTo(chemkit::Atom::Sulfur, chemkit::Bond::Double)){
+        else if(isBondedTo(index, chemkit::Atom::Phosphorus, chemkit::Bond::Double) ||
+                isBondedTo(index, chemkit::Atom::Sulfur, chemkit::Bond::Double)){
 
             bool negativeSulfur = false;
 
-            foreach(const chemkit::Atom *neighbor, atom->neighbors()){
-                if(neighbor->is(chemkit::Atom::Sulfur) && neighbor->formalCharge() < 0){
+            for(const Neighbor *neighbor = neighborsBegin(index); neighbor != neighborsEnd(index); ++neighbor){
+                const AtomEnvironment &neighborEnvironment = m_environments[neighbor->index];
+
+                if(neighborEnvironment.atomicNumber == chemkit::Atom::Sulfur && neighborEnvironment.formalCharge < 0){
                     negativeSulfur = true;
                 }
             }
 
-            if(negativeSulfur && atom->neighborCount(chemkit::Atom::Sulfur) == 2){
+            if(negativeSulfur && neighborCount(index, chemkit::Atom::Sulfur) == 2){
                 setType(index, 41);
             }
             else{
@@ -835,8 +1052,8 @@ void MmffAtomTyper::setCarbonType(int index, const chemkit::Atom *atom)
     }
 
     // two neighbors
-    else if(atom->neighborCount() == 2){
-        if(atom->isBondedTo(chemkit::Atom::Nitrogen, 3) && atom->formalCharge() == -1){
+    else if(environment.neighborCount == 2){
+        if(isBondedTo(index, chemkit::Atom::Nitrogen, chemkit::Bond::Triple) && environment.formalCharge == -1){
             setType(index, 60); // isonitrile carbon
         }
         else{
@@ -845,32 +1062,34 @@ void MmffAtomTyper::setCarbonType(int index, const chemkit::Atom *atom)
     }
 
     // one neighbor
-    else if(atom->neighborCount() == 1){
-        if(atom->isBondedTo(chemkit::Atom::Nitrogen, 3) && atom->formalCharge() == -1){
+    else if(environment.neighborCount == 1){
+        if(isBondedTo(index, chemkit::Atom::Nitrogen, chemkit::Bond::Triple) && environment.formalCharge == -1){
             setType(index, 60); // isonitrile carbon
         }
     }
 }
 
-void MmffAtomTyper::setNitrogenType(int index, const chemkit::Atom *atom)
+void MmffAtomTyper::setNitrogenType(int index)
 {
+    const AtomEnvironment &environment = m_environments[index];
+
     // one neighbor
-    if(atom->neighborCount() == 1){
-        const chemkit::Bond *neighborBond = atom->bonds()[0];
-        const chemkit::Atom *neighbor = neighborBond->otherAtom(atom);
+    if(environment.neighborCount == 1){
+        const Neighbor *neighbor = neighborsBegin(index);
+        int neighborElement = m_environments[neighbor->index].atomicNumber;
 
-        if(neighbor->is(chemkit::Atom::Carbon)){
-            if(neighbor->isBondedTo(chemkit::Atom::Carbon, chemkit::Bond::Triple)){
+        if(neighborElement == chemkit::Atom::Carbon){
+            if(isBondedTo(neighbor->index, chemkit::Atom::Carbon, chemkit::Bond::Triple)){
                 setType(index, 40);
             }
-            else if(neighbor->isBondedTo(chemkit::Atom::Nitrogen, chemkit::Bond::Double)){
+            else if(isBondedTo(neighbor->index, chemkit::Atom::Nitrogen, chemkit::Bond::Double)){
                 setType(index, 40);
             }
             else{
                 setType(index, 42);
             }
         }
-        else if(neighbor->is(chemkit::Atom::Nitrogen) && neighborBond->order() == chemkit::Bond::Double){
+        else if(neighborElement == chemkit::Atom::Nitrogen && neighbor->bondOrder == chemkit::Bond::Double){
             setType(index, 47);
         }
         else{
@@ -879,36 +1098,31 @@ void MmffAtomTyper::setNitrogenType(int index, const chemkit::Atom *atom)
     }
 
     // two neighbors
-    else if(atom->neighborCount() == 2){
+    else if(environment.neighborCount == 2){
         bool negativeRingNitrogen = false;
 
-        if(atom->smallestRing() && atom->smallestRing()->size() == 5){
-            foreach(const chemkit::Atom *ringAtom, atom->smallestRing()->atoms()){
-                if(ringAtom->is(chemkit::Atom::Nitrogen) && ringAtom->formalCharge() == -1){
+        if(environment.smallestRing && environment.smallestRing->size() == 5){
+            foreach(const chemkit::Atom *ringAtom, environment.smallestRing->atoms()){
+                const AtomEnvironment &ringAtomEnvironment = m_environments[atomIndex(ringAtom)];
+
+                if(ringAtomEnvironment.atomicNumber == chemkit::Atom::Nitrogen && ringAtomEnvironment.formalCharge == -1){
                     negativeRingNitrogen = true;
                 }
             }
         }
 
-        if(atom->isBondedTo(chemkit::Atom::Carbon, chemkit::Bond::Double) &&
-           atom->isBondedTo(chemkit::Atom::Nitrogen, chemkit::Bond::Double)){
+        if(isBondedTo(index, chemkit::Atom::Carbon, chemkit::Bond::Double) &&
+           isBondedTo(index, chemkit::Atom::Nitrogen, chemkit::Bond::Double)){
             setType(index, 53);
         }
-        else if(atom->formalCharge() == -1 || negativeRingNitrogen){
+        else if(environment.formalCharge == -1 || negativeRingNitrogen){
             setType(index, 62, -1.0); // NM
         }
-        else if(atom->isBondedTo(chemkit::Atom::Carbon, chemkit::Bond::Double)){
+        else if(isBondedTo(index, chemkit::Atom::Carbon, chemkit::Bond::Double)){
             setType(index, 9);
         }
-        else if(atom->isBondedTo(chemkit::Atom::Nitrogen, chemkit::Bond::Double)){
-            int doubleBondedNitrogen = 0;
-
-            foreach(const chemkit::Bond *bond, atom->bonds()){
-                if(bond->otherAtom(atom)->is(chemkit::Atom::Nitrogen) &&
-                   bond->order() == chemkit::Bond::Double){
-                    doubleBondedNitrogen++;
-                }
-            }
+        else if(isBondedTo(index, chemkit::Atom::Nitrogen, chemkit::Bond::Double)){
+            int doubleBondedNitrogen = environment.bondCounts[NitrogenSlot][chemkit::Bond::Double - 1];
 
             if(doubleBondedNitrogen == 2){
                 setType(index, 53);
@@ -917,29 +1131,32 @@ void MmffAtomTyper::setNitrogenType(int index, const chemkit::Atom *atom)
                 setType(index, 9);
             }
         }
-        else if(atom->isInRing(5)){
+        else if(isInRing(index, 5)){
             setType(index, 79);
         }
-        else if(atom->isBondedTo(chemkit::Atom::Oxygen, chemkit::Bond::Double)){
+        else if(isBondedTo(index, chemkit::Atom::Oxygen, chemkit::Bond::Double)){
             setType(index, 46); // nitroso
         }
-        else if(atom->isBondedTo(chemkit::Atom::Carbon, chemkit::Bond::Triple)){
+        else if(isBondedTo(index, chemkit::Atom::Carbon, chemkit::Bond::Triple)){
             setType(index, 61); // isonitrile
         }
-        else if(atom->isBondedTo(chemkit::Atom::Nitrogen, chemkit::Bond::Triple)){
+        else if(isBondedTo(index, chemkit::Atom::Nitrogen, chemkit::Bond::Triple)){
             setType(index, 61, 1.0); // diazo
         }
-        else if(atom->isBondedTo(chemkit::Atom::Sulfur)){
+        else if(isBondedTo(index, chemkit::Atom::Sulfur)){
             bool sulfate = false;
             bool nso = false;
 
-            foreach(const chemkit::Atom *neighbor, atom->neighbors()){
-                if(neighbor->is(chemkit::Atom::Sulfur) && isSulfate(neighbor)){
+            for(const Neighbor *neighbor = neighborsBegin(index); neighbor != neighborsEnd(index); ++neighbor){
+                if(m_environments[neighbor->index].atomicNumber != chemkit::Atom::Sulfur){
+                    continue;
+                }
+
+                if(isSulfate(neighbor->index)){
                     sulfate = true;
                 }
-                else if(neighbor->is(chemkit::Atom::Sulfur) &&
-                        neighbor->isBondedTo(chemkit::Atom::Oxygen, chemkit::Bond::Double) &&
-                        atom->bondTo(neighbor)->order() == chemkit::Bond::Double){
+                else if(isBondedTo(neighbor->index, chemkit::Atom::Oxygen, chemkit::Bond::Double) &&
+                        neighbor->bondOrder == chemkit::Bond::Double){
                     nso = true;
                 }
             }
@@ -960,68 +1177,72 @@ void MmffAtomTyper::setNitrogenType(int index, const chemkit::Atom *atom)
     }
 
     // three neighbors
-    else if(atom->neighborCount() == 3){
+    else if(environment.neighborCount == 3){
         bool sulfate = false;
         bool phosphate = false;
         bool oxide = false;
 
-        foreach(const chemkit::Atom *neighbor, atom->neighbors()){
-            if(neighbor->is(chemkit::Atom::Sulfur) && isSulfate(neighbor)){
+        for(const Neighbor *neighbor = neighborsBegin(index); neighbor != neighborsEnd(index); ++neighbor){
+            const AtomEnvironment &neighborEnvironment = m_environments[neighbor->index];
+
+            if(neighborEnvironment.atomicNumber == chemkit::Atom::Sulfur && isSulfate(neighbor->index)){
                 sulfate = true;
             }
-            else if(neighbor->is(chemkit::Atom::Phosphorus) && isPhosphate(neighbor)){
+            else if(neighborEnvironment.atomicNumber == chemkit::Atom::Phosphorus && isPhosphate(neighbor->index)){
                 phosphate = true;
             }
-            else if(neighbor->is(chemkit::Atom::Oxygen) && neighbor->formalCharge() < 0){
+            else if(neighborEnvironment.atomicNumber == chemkit::Atom::Oxygen && neighborEnvironment.formalCharge < 0){
                 oxide = true;
             }
         }
 
-        if(atom->isBondedTo(chemkit::Atom::Oxygen, chemkit::Bond::Double) && atom->neighborCount(chemkit::Atom::Oxygen) > 1){
+        if(isBondedTo(index, chemkit::Atom::Oxygen, chemkit::Bond::Double) && neighborCount(index, chemkit::Atom::Oxygen) > 1){
             setType(index, 45); // nitro or nitrate group nitrogen
         }
-        else if(atom->formalCharge() == 1 && oxide){
+        else if(environment.formalCharge == 1 && oxide){
             setType(index, 67); // sp2 n-oxide nitrogen
         }
-        else if(isGuanidinium(atom)){
+        else if(isGuanidinium(index)){
             setType(index, 56, (1.0/3.0)); // NGD+
         }
-        else if(isResonant(atom)){
+        else if(isResonant(index)){
             setType(index, 55, (1.0/2.0)); // NCN+
         }
-        else if(atom->formalCharge() == 1 &&
-                (atom->isBondedTo(chemkit::Atom::Carbon, chemkit::Bond::Double) ||
-                 atom->isBondedTo(chemkit::Atom::Nitrogen, chemkit::Bond::Double))){
+        else if(environment.formalCharge == 1 &&
+                (isBondedTo(index, chemkit::Atom::Carbon, chemkit::Bond::Double) ||
+                 isBondedTo(index, chemkit::Atom::Nitrogen, chemkit::Bond::Double))){
             setType(index, 54, 1.0); // N+=C, N+=N
         }
         else if(sulfate || phosphate){
             setType(index, 43);
         }
-        else if(isAmide(atom)){
+        else if(isAmide(index)){
             setType(index, 10);
         }
-        else if(atom->isBondedTo(chemkit::Atom::Carbon)){
+        else if(isBondedTo(index, chemkit::Atom::Carbon)){
             bool doubleBond = false;
             bool doubleNitrogenBond = false;
             bool doubleNitrogenCarbonBond = false;
             bool cyano = false;
 
-            foreach(const chemkit::Atom *neighbor, atom->neighbors()){
-                if(neighbor->is(chemkit::Atom::Carbon)){
-                    if(neighbor->isBondedTo(chemkit::Atom::Carbon, chemkit::Bond::Double) ||
-                            neighbor->isBondedTo(chemkit::Atom::Nitrogen, chemkit::Bond::Double) ||
-                            neighbor->isBondedTo(chemkit::Atom::Phosphorus, chemkit::Bond::Double)){
+            for(const Neighbor *neighbor = neighborsBegin(index); neighbor != neighborsEnd(index); ++neighbor){
+                int neighborElement = m_environments[neighbor->index].atomicNumber;
+
+                if(neighborElement == chemkit::Atom::Carbon){
+                    if(isBondedTo(neighbor->index, chemkit::Atom::Carbon, chemkit::Bond::Double) ||
+                       isBondedTo(neighbor->index, chemkit::Atom::Nitrogen, chemkit::Bond::Double) ||
+                       isBondedTo(neighbor->index, chemkit::Atom::Phosphorus, chemkit::Bond::Double)){
                         doubleBond = true;
                     }
-                    else if(neighbor->isBondedTo(chemkit::Atom::Nitrogen, chemkit::Bond::Triple)){
+                    else if(isBondedTo(neighbor->index, chemkit::Atom::Nitrogen, chemkit::Bond::Triple)){
                         cyano = true;
                     }
                 }
-                else if(neighbor->is(chemkit::Atom::Nitrogen)){
-                    if(neighbor->isBondedTo(chemkit::Atom::Nitrogen, chemkit::Bond::Double)){
+                else if(neighborElement == chemkit::Atom::Nitrogen){
+                    if(isBondedTo(neighbor->index, chemkit::Atom::Nitrogen, chemkit::Bond::Double)){
                         doubleNitrogenBond = true;
                     }
-                    else if(neighbor->isBondedTo(chemkit::Atom::Carbon, chemkit::Bond::Double)){
+                    else if(isBondedTo(neighbor->index, chemkit::Atom::Carbon, chemkit::Bond::Double)){
                         doubleNitrogenCarbonBond = true;
                     }
                 }
@@ -1033,7 +1254,7 @@ void MmffAtomTyper::setNitrogenType(int index, const chemkit::Atom *atom)
             else if(doubleNitrogenBond){
                 setType(index, 10); // NN=N
             }
-            else if(doubleNitrogenCarbonBond && !atom->isBondedTo(chemkit::Atom::Carbon)){
+            else if(doubleNitrogenCarbonBond && !isBondedTo(index, chemkit::Atom::Carbon)){
                 setType(index, 10); // NN=C
             }
             else if(cyano){
@@ -1049,13 +1270,15 @@ void MmffAtomTyper::setNitrogenType(int index, const chemkit::Atom *atom)
     }
 
     // four neighbors
-    else if(atom->neighborCount() == 4){
-        if(atom->neighborCount(chemkit::Atom::Oxygen) == 3){
+    else if(environment.neighborCount == 4){
+        if(neighborCount(index, chemkit::Atom::Oxygen) == 3){
             setType(index, 45);
         }
-        else if(atom->isBondedTo(chemkit::Atom::Oxygen, chemkit::Bond::Single)){
-            foreach(const chemkit::Atom *neighbor, atom->neighbors()){
-                if(neighbor->is(chemkit::Atom::Oxygen) && neighbor->formalCharge() == -1){
+        else if(isBondedTo(index, chemkit::Atom::Oxygen, chemkit::Bond::Single)){
+            for(const Neighbor *neighbor = neighborsBegin(index); neighbor != neighborsEnd(index); ++neighbor){
+                const AtomEnvironment &neighborEnvironment = m_environments[neighbor->index];
+
+                if(neighborEnvironment.atomicNumber == chemkit::Atom::Oxygen && neighborEnvironment.formalCharge == -1){
                     setType(index, 68);
                 }
             }
@@ -1066,45 +1289,50 @@ void MmffAtomTyper::setNitrogenType(int index, const chemkit::Atom *atom)
     }
 }
 
-void MmffAtomTyper::setOxygenType(int index, const chemkit::Atom *atom)
+void MmffAtomTyper::setOxygenType(int index)
 {
+    const AtomEnvironment &environment = m_environments[index];
+
     // one neighbor
-    if(atom->neighborCount() == 1){
-        const chemkit::Bond *neighborBond = atom->bonds()[0];
-        const chemkit::Atom *neighbor = neighborBond->otherAtom(atom);
-
-        if(neighbor->is(chemkit::Atom::Carbon)){
-            if(neighborBond->order() == chemkit::Bond::Single){
-                if(neighbor->isBondedTo(chemkit::Atom::Oxygen, chemkit::Bond::Double)){
-                    if(atom->formalCharge() < 0){
+    if(environment.neighborCount == 1){
+        const Neighbor *neighborBond = neighborsBegin(index);
+        int neighbor = neighborBond->index;
+        const AtomEnvironment &neighborEnvironment = m_environments[neighbor];
+
+        if(neighborEnvironment.atomicNumber == chemkit::Atom::Carbon){
+            if(neighborBond->bondOrder == chemkit::Bond::Single){
+                if(isBondedTo(neighbor, chemkit::Atom::Oxygen, chemkit::Bond::Double)){
+                    if(environment.formalCharge < 0){
                         setType(index, 32, -0.5);
                     }
                     else{
                         setType(index, 6);
                     }
                 }
-                else if(atom->formalCharge() < 0){
+                else if(environment.formalCharge < 0){
                     setType(index, 35, -1.0); // alkoxide oxygen (OM)
                 }
-                else if(neighbor->isBondedTo(chemkit::Atom::Carbon, chemkit::Bond::Double)){
+                else if(isBondedTo(neighbor, chemkit::Atom::Carbon, chemkit::Bond::Double)){
                     setType(index, 6);
                 }
-                else if(neighbor->isBondedTo(chemkit::Atom::Nitrogen, chemkit::Bond::Double)){
+                else if(isBondedTo(neighbor, chemkit::Atom::Nitrogen, chemkit::Bond::Double)){
                     setType(index, 6);
                 }
-                else if(neighbor->isBondedTo(chemkit::Atom::Sulfur, chemkit::Bond::Double)){
+                else if(isBondedTo(neighbor, chemkit::Atom::Sulfur, chemkit::Bond::Double)){
                     setType(index, 6);
                 }
             }
-            else if(neighborBond->order() == chemkit::Bond::Double){
-                if(neighbor->isBondedTo(chemkit::Atom::Nitrogen)){
+            else if(neighborBond->bondOrder == chemkit::Bond::Double){
+                if(isBondedTo(neighbor, chemkit::Atom::Nitrogen)){
                     setType(index, 7);
                 }
-                else if(neighbor->neighborCount(chemkit::Atom::Oxygen) > 1){
+                else if(neighborCount(neighbor, chemkit::Atom::Oxygen) > 1){
                     bool isNegative = false;
-                    foreach(const chemkit::Atom *secondNeighbor, neighbor->neighbors()){
-                        if(secondNeighbor->is(chemkit::Atom::Oxygen)){
-                            if(secondNeighbor->formalCharge() < 0){
+                    for(const Neighbor *secondNeighbor = neighborsBegin(neighbor); secondNeighbor != neighborsEnd(neighbor); ++secondNeighbor){
+                        const AtomEnvironment &secondNeighborEnvironment = m_environments[secondNeighbor->index];
+
+                        if(secondNeighborEnvironment.atomicNumber == chemkit::Atom::Oxygen){
+                            if(secondNeighborEnvironment.formalCharge < 0){
                                 isNegative = true;
                             }
                         }
@@ -1116,29 +1344,28 @@ void MmffAtomTyper::setOxygenType(int index, const chemkit::Atom *atom)
                         setType(index, 7);
                     }
                 }
-                else if(neighbor->isBondedTo(chemkit::Atom::Carbon) || neighbor->isBondedTo(chemkit::Atom::Hydrogen)){
-                    setType(index, 7);
-                }
                 else{
                     setType(index, 7);
                 }
             }
         }
-        else if(neighbor->is(chemkit::Atom::Nitrogen)){
-            int oxygenCount = neighbor->neighborCount(chemkit::Atom::Oxygen);
+        else if(neighborEnvironment.atomicNumber == chemkit::Atom::Nitrogen){
+            int oxygenCount = neighborCount(neighbor, chemkit::Atom::Oxygen);
             int negativeOxygenCount = 0;
 
-            foreach(const chemkit::Atom *secondNeighbor, neighbor->neighbors()){
-                if(secondNeighbor->is(chemkit::Atom::Oxygen) && secondNeighbor->formalCharge() < 0){
+            for(const Neighbor *secondNeighbor = neighborsBegin(neighbor); secondNeighbor != neighborsEnd(neighbor); ++secondNeighbor){
+                const AtomEnvironment &secondNeighborEnvironment = m_environments[secondNeighbor->index];
+
+                if(secondNeighborEnvironment.atomicNumber == chemkit::Atom::Oxygen && secondNeighborEnvironment.formalCharge < 0){
                     negativeOxygenCount++;
                 }
             }
 
             if(oxygenCount >= 2){
-                if(neighbor->is(chemkit::Atom::Nitrogen) && negativeOxygenCount == 1){
+                if(negativeOxygenCount == 1){
                     setType(index, 32);
                 }
-                else if(neighbor->is(chemkit::Atom::Nitrogen) && oxygenCount == 3 && negativeOxygenCount > 1){
+                else if(oxygenCount == 3 && negativeOxygenCount > 1){
                     setType(index, 32, -1.0/3.0);
                 }
                 else if(negativeOxygenCount > 1){
@@ -1148,11 +1375,11 @@ void MmffAtomTyper::setOxygenType(int index, const chemkit::Atom *atom)
                     setType(index, 32);
                 }
             }
-            else if(atom->formalCharge() < 0){
-                if(neighbor->isBondedTo(chemkit::Atom::Carbon) && neighbor->neighborCount() == 2){
+            else if(environment.formalCharge < 0){
+                if(isBondedTo(neighbor, chemkit::Atom::Carbon) && neighborEnvironment.neighborCount == 2){
                     setType(index, 35, -1.0);
                 }
-                else if(neighbor->formalCharge() == 0 && neighbor->neighborCount(chemkit::Atom::Oxygen) == 1){
+                else if(neighborEnvironment.formalCharge == 0 && oxygenCount == 1){
                     setType(index, 35, -1.0);
                 }
                 else{
@@ -1163,38 +1390,30 @@ void MmffAtomTyper::setOxygenType(int index, const chemkit::Atom *atom)
                 setType(index, 7);
             }
         }
-        else if(neighbor->is(chemkit::Atom::Sulfur)){
-            int singleBondedOxygenCount = 0;
-            int doubleBondedOxygenCount = 0;
+        else if(neighborEnvironment.atomicNumber == chemkit::Atom::Sulfur){
+            int singleBondedOxygenCount = neighborEnvironment.bondCounts[OxygenSlot][chemkit::Bond::Single - 1];
+            int doubleBondedOxygenCount = neighborEnvironment.bondCounts[OxygenSlot][chemkit::Bond::Double - 1];
             bool negativeOxygen = false;
 
-            foreach(const chemkit::Atom *secondNeighbor, neighbor->neighbors()){
-                if(secondNeighbor->is(chemkit::Atom::Oxygen)){
-                    const chemkit::Bond *bond = neighbor->bondTo(secondNeighbor);
-
-                    if(bond->order() == chemkit::Bond::Single){
-                        singleBondedOxygenCount++;
-                    }
-                    else if(bond->order() == chemkit::Bond::Double){
-                        doubleBondedOxygenCount++;
-                    }
+            for(const Neighbor *secondNeighbor = neighborsBegin(neighbor); secondNeighbor != neighborsEnd(neighbor); ++secondNeighbor){
+                const AtomEnvironment &secondNeighborEnvironment = m_environments[secondNeighbor->index];
 
-                    if(secondNeighbor->formalCharge() == -1){
-                        negativeOxygen = true;
-                    }
+                if(secondNeighborEnvironment.atomicNumber == chemkit::Atom::Oxygen &&
+                   secondNeighborEnvironment.formalCharge == -1){
+                    negativeOxygen = true;
                 }
             }
 
             int oxygenCount = singleBondedOxygenCount + doubleBondedOxygenCount;
 
-            if(oxygenCount == 1 && neighbor->neighborCount() == 4){
+            if(oxygenCount == 1 && neighborEnvironment.neighborCount == 4){
                 setType(index, 32); // O-S
             }
             else if(doubleBondedOxygenCount >= 2){
                 if(negativeOxygen){
                     setType(index, 32, -1.0/3.0);
                 }
-                else if(neighbor->valence() == 5 && doubleBondedOxygenCount == 2){
+                else if(neighborEnvironment.valence == 5 && doubleBondedOxygenCount == 2){
                     setType(index, 32, -0.5);
                 }
                 else{
@@ -1205,35 +1424,38 @@ void MmffAtomTyper::setOxygenType(int index, const chemkit::Atom *atom)
                 setType(index, 7);
             }
             else if(doubleBondedOxygenCount == 1 &&
-                    neighbor->isBondedTo(chemkit::Atom::Sulfur, chemkit::Bond::Double) &&
-                    neighbor->valence() == 5){
+                    isBondedTo(neighbor, chemkit::Atom::Sulfur, chemkit::Bond::Double) &&
+                    neighborEnvironment.valence == 5){
                 setType(index, 32, -0.5); // OSMS
             }
             else{
                 setType(index, 7);
             }
         }
-        else if(neighbor->is(chemkit::Atom::Phosphorus)){
+        else if(neighborEnvironment.atomicNumber == chemkit::Atom::Phosphorus){
             int negativeOxygenAndSulfurCount = 0;
             bool doubleBondedOxygenOrSulfur = false;
             int oxygenAndSulfurCount = 0;
 
-            foreach(const chemkit::Atom *secondNeighbor, neighbor->neighbors()){
-                if(secondNeighbor->is(chemkit::Atom::Oxygen) || secondNeighbor->is(chemkit::Atom::Sulfur)){
+            for(const Neighbor *secondNeighbor = neighborsBegin(neighbor); secondNeighbor != neighborsEnd(neighbor); ++secondNeighbor){
+                const AtomEnvironment &secondNeighborEnvironment = m_environments[secondNeighbor->index];
+
+                if(secondNeighborEnvironment.atomicNumber == chemkit::Atom::Oxygen ||
+                   secondNeighborEnvironment.atomicNumber == chemkit::Atom::Sulfur){
                     oxygenAndSulfurCount++;
 
-                    if(neighbor->bondTo(secondNeighbor)->order() == chemkit::Bond::Double){
+                    if(secondNeighbor->bondOrder == chemkit::Bond::Double){
                         doubleBondedOxygenOrSulfur = true;
                     }
 
-                    if(secondNeighbor->isTerminal() && secondNeighbor->formalCharge() == -1){
+                    if(secondNeighborEnvironment.neighborCount == 1 && secondNeighborEnvironment.formalCharge == -1){
                         negativeOxygenAndSulfurCount++;
                     }
                 }
             }
 
             if(oxygenAndSulfurCount > 1 && doubleBondedOxygenOrSulfur && negativeOxygenAndSulfurCount){
-                if(neighbor->valence() == 5 && negativeOxygenAndSulfurCount == 2){
+                if(neighborEnvironment.valence == 5 && negativeOxygenAndSulfurCount == 2){
                     setType(index, 32, -2.0/3.0);
                 }
                 else{
@@ -1247,117 +1469,94 @@ void MmffAtomTyper::setOxygenType(int index, const chemkit::Atom *atom)
                 setType(index, 32);
             }
         }
-        else if(neighbor->is(chemkit::Atom::Chlorine) && neighbor->neighborCount(chemkit::Atom::Oxygen) == 4){
+        else if(neighborEnvironment.atomicNumber == chemkit::Atom::Chlorine && neighborCount(neighbor, chemkit::Atom::Oxygen) == 4){
             setType(index, 32, -0.25); // O4CL
         }
-        else if(neighbor->is(chemkit::Atom::Hydrogen) && atom->formalCharge() == -1){
+        else if(neighborEnvironment.atomicNumber == chemkit::Atom::Hydrogen && environment.formalCharge == -1){
             setType(index, 35, -1.0);
         }
     }
 
     // two neighbors
-    else if(atom->neighborCount() == 2){
-        if(atom->neighborCount(chemkit::Atom::Hydrogen) == 2){
+    else if(environment.neighborCount == 2){
+        if(neighborCount(index, chemkit::Atom::Hydrogen) == 2){
             setType(index, 70); // water
         }
-        else if(atom->formalCharge() == 1){
-            if(atom->isBondedTo(chemkit::Atom::Carbon, chemkit::Bond::Double)){
+        else if(environment.formalCharge == 1){
+            if(isBondedTo(index, chemkit::Atom::Carbon, chemkit::Bond::Double)){
                 setType(index, 51, 1.0);
             }
             else{
                 setType(index, 49, 1.0);
             }
         }
-        else if(atom->isBondedTo(chemkit::Atom::Nitrogen)){
-            setType(index, 6);
-        }
-        else if(atom->isBondedTo(chemkit::Atom::Sulfur)){
-            setType(index, 6);
-        }
-        else if(atom->isBondedTo(chemkit::Atom::Phosphorus)){
-            setType(index, 6);
-        }
-        else if(atom->isBondedTo(chemkit::Atom::Carbon)){
-            setType(index, 6);
-        }
         else{
             setType(index, 6);
         }
     }
 
     // three neighbors
-    else if(atom->neighborCount() == 3){
+    else if(environment.neighborCount == 3){
         setType(index, 49, 1.0);
     }
 }
 
-void MmffAtomTyper::setSulfurType(int index, const chemkit::Atom *atom)
+void MmffAtomTyper::setSulfurType(int index)
 {
-    if(atom->isTerminal()){
-        const chemkit::Atom *neighbor = atom->bonds()[0]->otherAtom(atom);
+    const AtomEnvironment &environment = m_environments[index];
+
+    if(environment.neighborCount == 1){
+        int neighbor = neighborsBegin(index)->index;
 
-        if(isThiocarboxylate(atom)){
+        if(isThiocarboxylate(index)){
             setType(index, 72, -0.5);
         }
-        else if(atom->isBondedTo(chemkit::Atom::Carbon, chemkit::Bond::Double)){
+        else if(isBondedTo(index, chemkit::Atom::Carbon, chemkit::Bond::Double)){
             setType(index, 16);
         }
-        else if(atom->isBondedTo(chemkit::Atom::Oxygen, chemkit::Bond::Double)){
+        else if(isBondedTo(index, chemkit::Atom::Oxygen, chemkit::Bond::Double)){
             setType(index, 17);
         }
-        else if(neighbor->is(chemkit::Atom::Phosphorus)){
-            if(neighbor->isBondedTo(chemkit::Atom::Oxygen, chemkit::Bond::Double) && atom->formalCharge() == -1){
+        else if(m_environments[neighbor].atomicNumber == chemkit::Atom::Phosphorus){
+            if(isBondedTo(neighbor, chemkit::Atom::Oxygen, chemkit::Bond::Double) && environment.formalCharge == -1){
                 setType(index, 72, -0.5);
             }
             else{
                 setType(index, 72); // S-P
             }
         }
-        else if(atom->formalCharge() < 0){
+        else if(environment.formalCharge < 0){
             setType(index, 72, -1.0); // SM
         }
-        else if(atom->isBondedTo(chemkit::Atom::Sulfur, chemkit::Bond::Double)){
+        else if(isBondedTo(index, chemkit::Atom::Sulfur, chemkit::Bond::Double)){
             setType(index, 72, -0.5);
         }
         else{
             setType(index, 72);
         }
     }
-    else if(atom->isBondedTo(chemkit::Atom::Nitrogen, chemkit::Bond::Double) &&
-            atom->isBondedTo(chemkit::Atom::Oxygen, chemkit::Bond::Double)){
+    else if(isBondedTo(index, chemkit::Atom::Nitrogen, chemkit::Bond::Double) &&
+            isBondedTo(index, chemkit::Atom::Oxygen, chemkit::Bond::Double)){
         setType(index, 18);
     }
-    else if(atom->isBondedTo(chemkit::Atom::Nitrogen, chemkit::Bond::Double) && atom->neighborCount() == 3){
+    else if(isBondedTo(index, chemkit::Atom::Nitrogen, chemkit::Bond::Double) && environment.neighborCount == 3){
         setType(index, 17); // >S=N
     }
-    else if(atom->isBondedTo(chemkit::Atom::Oxygen, chemkit::Bond::Double) &&
-            atom->isBondedTo(chemkit::Atom::Sulfur, chemkit::Bond::Double)){
+    else if(isBondedTo(index, chemkit::Atom::Oxygen, chemkit::Bond::Double) &&
+            isBondedTo(index, chemkit::Atom::Sulfur, chemkit::Bond::Double)){
         setType(index, 73);
     }
-    else if(atom->isBondedTo(chemkit::Atom::Oxygen, chemkit::Bond::Double)){
-        int singleBondedOxygenCount = 0;
-        int doubleBondedOxygenCount = 0;
-
-        foreach(const chemkit::Atom *neighbor, atom->neighbors()){
-            if(neighbor->is(chemkit::Atom::Oxygen)){
-                const chemkit::Bond *bond = atom->bondTo(neighbor);
-
-                if(bond->order() == chemkit::Bond::Single){
-                    singleBondedOxygenCount++;
-                }
-                else if(bond->order() == chemkit::Bond::Double){
-                    doubleBondedOxygenCount++;
-                }
-            }
-        }
+    else if(isBondedTo(index, chemkit::Atom::Oxygen, chemkit::Bond::Double)){
+        int singleBondedOxygenCount = environment.bondCounts[OxygenSlot][chemkit::Bond::Single - 1];
+        int doubleBondedOxygenCount = environment.bondCounts[OxygenSlot][chemkit::Bond::Double - 1];
 
         if(singleBondedOxygenCount == 1 && doubleBondedOxygenCount == 1){
             setType(index, 17); // S=O
         }
-        else if(doubleBondedOxygenCount == 2 && atom->valence() == 5){
+        else if(doubleBondedOxygenCount == 2 && environment.valence == 5){
             setType(index, 73); // SO2M
         }
-        else if(doubleBondedOxygenCount == 1 && atom->isBondedTo(chemkit::Atom::Carbon, chemkit::Bond::Double)){
+        else if(doubleBondedOxygenCount == 1 && isBondedTo(index, chemkit::Atom::Carbon, chemkit::Bond::Double)){
             setType(index, 74); // =S=O
         }
         else if(doubleBondedOxygenCount >= 2){
@@ -1372,12 +1571,13 @@ void MmffAtomTyper::setSulfurType(int index, const chemkit::Atom *atom)
     }
 }
 
-void MmffAtomTyper::setAromaticType(int index, const chemkit::Atom *atom, const chemkit::Ring *ring, int position)
+void MmffAtomTyper::setAromaticType(int index, const chemkit::Ring *ring, int position)
 {
-    int type = typeNumber(atom);
+    const AtomEnvironment &environment = m_environments[index];
+    int type = typeNumber(index);
 
     // carbon
-    if(atom->is(chemkit::Atom::Carbon)){
+    if(environment.atomicNumber == chemkit::Atom::Carbon){
         if(ring->size() == 5){
             if(type == 57){
                 setType(index, 80); // CIM+
@@ -1411,16 +1611,18 @@ void MmffAtomTyper::setAromaticType(int index, const chemkit::Atom *atom, const
     }
 
     // nitrogen
-    else if(atom->is(chemkit::Atom::Nitrogen)){
+    else if(environment.atomicNumber == chemkit::Atom::Nitrogen){
         if(ring->size() == 5){
             if(type == 62){
-                if(ring->atomCount(chemkit::Atom::Nitrogen) == 2){
+                int nitrogenCount = ring->atomCount(chemkit::Atom::Nitrogen);
+
+                if(nitrogenCount == 2){
                     setType(index, 76, -0.5); // N5M
                 }
-                else if(ring->atomCount(chemkit::Atom::Nitrogen) == 3){
+                else if(nitrogenCount == 3){
                     setType(index, 76, -1.0/3.0); // N5M
                 }
-                else if(ring->atomCount(chemkit::Atom::Nitrogen) == 4){
+                else if(nitrogenCount == 4){
                     setType(index, 76, -1.0/4.0); // N5M
                 }
             }
@@ -1467,7 +1669,7 @@ void MmffAtomTyper::setAromaticType(int index, const chemkit::Atom *atom, const
                 setType(index, 69); // NPOX
             }
             else{
-                if(atom->formalCharge() > 0){
+                if(environment.formalCharge > 0){
                     setType(index, 58, 1.0); // NPYD+
                 }
                 else{
@@ -1478,14 +1680,14 @@ void MmffAtomTyper::setAromaticType(int index, const chemkit::Atom *atom, const
     }
 
     // oxygen
-    else if(atom->is(chemkit::Atom::Oxygen)){
+    else if(environment.atomicNumber == chemkit::Atom::Oxygen){
         if(ring->size() == 5){
             setType(index, 59); // OFUR
         }
     }
 
     // sulfur
-    else if(atom->is(chemkit::Atom::Sulfur)){
+    else if(environment.atomicNumber == chemkit::Atom::Sulfur){
         if(ring->size() == 5){
             setType(index, 44); // STHI
         }
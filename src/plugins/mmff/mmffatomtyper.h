@@ -36,6 +36,8 @@
 #ifndef MMFFATOMTYPER_H
 #define MMFFATOMTYPER_H
 
+#include <vector>
+
 #include <chemkit/ring.h>
 #include <chemkit/atomtyper.h>
 
@@ -56,21 +58,65 @@ class MmffAtomTyper : public chemkit::AtomTyper
 
     protected:
         void assignTypes(const chemkit::Molecule *molecule);
+        bool copyTypes(const chemkit::AtomTyper *typer);
 
     private:
+        // The AtomEnvironment struct contains the properties of an
+        // atom and its neighbors which are used to determine its type.
+        struct AtomEnvironment
+        {
+            const chemkit::Atom *atom;
+            int atomicNumber;
+            int formalCharge;
+            int neighborCount;
+            int valence;
+            int firstNeighbor;
+            unsigned int ringSizes;
+            const chemkit::Ring *smallestRing;
+            bool aromatic;
+            unsigned char elementCounts[7];
+            unsigned char bondCounts[7][3];
+        };
+
+        // The Neighbor struct contains the index of a neighboring
+        // atom and the order of the bond to it.
+        struct Neighbor
+        {
+            int index;
+            int bondOrder;
+        };
+
+        void assignEnvironments(const chemkit::Molecule *molecule, std::vector<const chemkit::Ring *> &aromaticRings);
+        int atomIndex(const chemkit::Atom *atom) const;
+        const Neighbor* neighborsBegin(int index) const;
+        const Neighbor* neighborsEnd(int index) const;
+        int neighborCount(int index, int element) const;
+        bool isBondedTo(int index, int element) const;
+        bool isBondedTo(int index, int element, int bondOrder) const;
+        bool isInRing(int index) const;
+        bool isInRing(int index, int size) const;
+        bool isGuanidinium(int index) const;
+        bool isResonant(int index) const;
+        bool isAmide(int index) const;
+        bool isPhosphate(int index) const;
+        bool isSulfate(int index) const;
+        bool isThiocarboxylate(int index) const;
         void setType(int index, int type, chemkit::Float formalCharge = 0);
-        void setType(int index, const chemkit::Atom *atom);
-        void setHydrogenType(int index, const chemkit::Atom *atom);
-        void setCarbonType(int index, const chemkit::Atom *atom);
-        void setNitrogenType(int index, const chemkit::Atom *atom);
-        void setOxygenType(int index, const chemkit::Atom *atom);
-        void setSulfurType(int index, const chemkit::Atom *atom);
-        void setAromaticType(int index, const chemkit::Atom *atom, const chemkit::Ring *ring, int position);
+        void setType(int index);
+        void setHydrogenType(int index);
+        void setCarbonType(int index);
+        void setNitrogenType(int index);
+        void setOxygenType(int index);
+        void setSulfurType(int index);
+        void setAromaticType(int index, const chemkit::Ring *ring, int position);
 
     private:
         QVector<int> m_types;
         QVector<chemkit::Float> m_formalCharges;
         QVector<chemkit::Float> m_partialCharges;
+        std::vector<AtomEnvironment> m_environments;
+        std::vector<Neighbor> m_neighbors;
+        QHash<const chemkit::Atom *, int> m_indices;
 };
 
 #endif // MMFFATOMTYPER_H
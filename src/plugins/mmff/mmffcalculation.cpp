@@ -116,6 +116,27 @@ std::vector<chemkit::Vector3> MmffBondStrechCalculation::gradient() const
     return gradient;
 }
 
+chemkit::Matrix MmffBondStrechCalculation::hessian() const
+{
+    const MmffAtom *a = atom(0);
+    const MmffAtom *b = atom(1);
+
+    chemkit::Float kb = parameter(0);
+    chemkit::Float r0 = parameter(1);
+
+    chemkit::Float r = distance(a, b);
+    chemkit::Float dr = r - r0;
+    chemkit::Float cs = -2.0; // cubic strech constant
+
+    // dE/dr
+    chemkit::Float de_dr = 143.9325 * kb * dr * (1 + cs * dr + (7.0/12.0 * (cs*cs) * (dr*dr)) + 0.5 * dr * (cs + (14.0/12.0 * (cs*cs) * dr)));
+
+    // d2E/dr2
+    chemkit::Float d2e_dr2 = 143.9325 * kb * (1 + 3 * cs * dr + (7.0/2.0 * (cs*cs) * (dr*dr)));
+
+    return distanceHessian(a, b, de_dr, d2e_dr2);
+}
+
 // === MmffAngleBendCalculation ============================================ //
 MmffAngleBendCalculation::MmffAngleBendCalculation(const MmffAtom *a,
                                                    const MmffAtom *b,
@@ -185,6 +206,28 @@ std::vector<chemkit::Vector3> MmffAngleBendCalculation::gradient() const
     return gradient;
 }
 
+chemkit::Matrix MmffAngleBendCalculation::hessian() const
+{
+    const MmffAtom *a = atom(0);
+    const MmffAtom *b = atom(1);
+    const MmffAtom *c = atom(2);
+
+    chemkit::Float ka = parameter(0);
+    chemkit::Float t0 = parameter(1);
+
+    chemkit::Float cb = -0.007; // cubic bend constant
+    chemkit::Float t = bondAngle(a, b, c);
+    chemkit::Float dt = t - t0;
+
+    // dE/dt
+    chemkit::Float de_dt = 0.043844 * ka * dt * (1 + cb * dt + 0.5 * cb * dt);
+
+    // d2E/dt2
+    chemkit::Float d2e_dt2 = 0.043844 * ka * (1 + 3 * cb * dt);
+
+    return bondAngleHessian(a, b, c, de_dt, d2e_dt2);
+}
+
 // === MmffStrechBendCalculation =========================================== //
 MmffStrechBendCalculation::MmffStrechBendCalculation(const MmffAtom *a,
                                                      const MmffAtom *b,
@@ -533,6 +576,36 @@ std::vector<chemkit::Vector3> MmffVanDerWaalsCalculation::gradient() const
     return gradient;
 }
 
+chemkit::Matrix MmffVanDerWaalsCalculation::hessian() const
+{
+    const MmffAtom *a = atom(0);
+    const MmffAtom *b = atom(1);
+
+    chemkit::Float rs = parameter(0);
+    chemkit::Float eps = parameter(1);
+    chemkit::Float r = distance(a, b);
+
+    // the energy is eps * p * (q - 2) where p is the repulsive
+    // term and q is the attractive term of equation 8
+    chemkit::Float s = r + 0.07 * rs;
+    chemkit::Float p = pow(1.07 * rs / s, 7);
+    chemkit::Float dp_dr = -7 * p / s;
+    chemkit::Float d2p_dr2 = 56 * p / (s * s);
+
+    chemkit::Float t = pow(r, 7) + 0.12 * pow(rs, 7);
+    chemkit::Float q = 1.12 * pow(rs, 7) / t;
+    chemkit::Float dq_dr = -7 * q * pow(r, 6) / t;
+    chemkit::Float d2q_dr2 = -q * (42 * pow(r, 5) / t - 98 * pow(r, 12) / (t * t));
+
+    // dE/dr
+    chemkit::Float de_dr = eps * (dp_dr * (q - 2) + p * dq_dr);
+
+    // d2E/dr2
+    chemkit::Float d2e_dr2 = eps * (d2p_dr2 * (q - 2) + 2 * dp_dr * dq_dr + p * d2q_dr2);
+
+    return distanceHessian(a, b, de_dr, d2e_dr2);
+}
+
 // === MmffElectrostaticCalculation ======================================== //
 MmffElectrostaticCalculation::MmffElectrostaticCalculation(const MmffAtom *a,
                                                            const MmffAtom *b)
@@ -604,3 +677,25 @@ std::vector<chemkit::Vector3> MmffElectrostaticCalculation::gradient() const
 
     return gradient;
 }
+
+chemkit::Matrix MmffElectrostaticCalculation::hessian() const
+{
+    const chemkit::ForceFieldAtom *a = atom(0);
+    const chemkit::ForceFieldAtom *b = atom(1);
+
+    chemkit::Float qa = parameter(0);
+    chemkit::Float qb = parameter(1);
+    chemkit::Float oneFourScaling = parameter(2);
+
+    chemkit::Float r = distance(a, b);
+    chemkit::Float e = 1.0; // dielectric constant
+    chemkit::Float d = 0.05; // electrostatic buffering constant
+
+    // dE/dr
+    chemkit::Float de_dr = 332.0716 * qa * qb * oneFourScaling * (-1.0 / (e * pow(r + d, 2)));
+
+    // d2E/dr2
+    chemkit::Float d2e_dr2 = 332.0716 * qa * qb * oneFourScaling * (2.0 / (e * pow(r + d, 3)));
+
+    return distanceHessian(a, b, de_dr, d2e_dr2);
+}
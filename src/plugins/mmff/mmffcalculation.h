@@ -59,6 +59,7 @@ class MmffBondStrechCalculation : public MmffCalculation
         bool setup(const MmffParameters *parameters);
         chemkit::Float energy() const;
         std::vector<chemkit::Vector3> gradient() const;
+        chemkit::Matrix hessian() const;
 };
 
 class MmffAngleBendCalculation : public MmffCalculation
@@ -69,6 +70,7 @@ class MmffAngleBendCalculation : public MmffCalculation
         bool setup(const MmffParameters *parameters);
         chemkit::Float energy() const;
         std::vector<chemkit::Vector3> gradient() const;
+        chemkit::Matrix hessian() const;
 };
 
 class MmffStrechBendCalculation : public MmffCalculation
@@ -109,6 +111,7 @@ class MmffVanDerWaalsCalculation : public MmffCalculation
         bool setup(const MmffParameters *parameters);
         chemkit::Float energy() const;
         std::vector<chemkit::Vector3> gradient() const;
+        chemkit::Matrix hessian() const;
 };
 
 class MmffElectrostaticCalculation : public MmffCalculation
@@ -119,6 +122,7 @@ class MmffElectrostaticCalculation : public MmffCalculation
         bool setup(const MmffParameters *parameters);
         chemkit::Float energy() const;
         std::vector<chemkit::Vector3> gradient() const;
+        chemkit::Matrix hessian() const;
 };
 
 #endif // MMFFCALCULATION_H
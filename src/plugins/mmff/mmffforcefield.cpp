@@ -53,6 +53,8 @@
 #include "mmffcalculation.h"
 #include "mmffpartialchargepredictor.h"
 
+#include <map>
+
 #include <chemkit/atom.h>
 #include <chemkit/bond.h>
 #include <chemkit/ring.h>
@@ -84,13 +86,7 @@ MmffForceField::~MmffForceField()
 // --- Atoms --------------------------------------------------------------- //
 MmffAtom* MmffForceField::atom(const chemkit::Atom *atom)
 {
-    foreach(chemkit::ForceFieldAtom *forceFieldAtom, atoms()){
-        if(forceFieldAtom->atom() == atom){
-            return static_cast<MmffAtom *>(forceFieldAtom);
-        }
-    }
-
-    return 0;
+    return static_cast<MmffAtom *>(chemkit::ForceField::atom(atom));
 }
 
 const MmffAtom* MmffForceField::atom(const chemkit::Atom *atom) const
@@ -99,9 +95,24 @@ const MmffAtom* MmffForceField::atom(const chemkit::Atom *atom) const
 }
 
 // --- Parameterization ---------------------------------------------------- //
+namespace {
+
+// The TopologyTemplate struct stores the index of the first atom
+// and the range of calculations added for a molecule which is
+// used as the template for other molecules with the same topology.
+struct TopologyTemplate
+{
+    int firstAtom;
+    int firstCalculation;
+    int lastCalculation;
+};
+
+} // end anonymous namespace
+
 bool MmffForceField::setup()
 {
     if(!m_parameters || m_parameters->fileName() != parameterFile()){
+        delete m_parameters;
         m_parameters = new MmffParameters;
         bool ok = m_parameters->read(parameterFile());
         if(!ok){
@@ -112,95 +123,88 @@ bool MmffForceField::setup()
         }
     }
 
-    foreach(const chemkit::Molecule *molecule, molecules()){
-        MmffAtomTyper typer(molecule);
+    const std::vector<const chemkit::Molecule *> molecules = this->molecules();
+    const std::vector<const chemkit::Molecule *> templates = topologyTemplates();
 
-        // add atoms
-        foreach(const chemkit::Atom *atom, molecule->atoms()){
-            MmffAtom *mmffAtom = new MmffAtom(this, atom);
-            addAtom(mmffAtom);
-            mmffAtom->setType(typer.typeNumber(atom), typer.formalCharge(atom));
+    // type and enumerate the calculations for each template molecule
+    // in parallel. copies of a template are skipped here and filled
+    // in from the template below
+    std::vector<const chemkit::Molecule *> templateMolecules(molecules.size(), 0);
+    for(unsigned int i = 0; i < molecules.size(); i++){
+        if(templates[i] == molecules[i]){
+            templateMolecules[i] = molecules[i];
         }
+    }
 
-        // setup atom charges
-        MmffPartialChargePredictor partialCharges;
-        partialCharges.setAtomTyper(&typer);
-        partialCharges.setMolecule(molecule);
-
-        foreach(chemkit::ForceFieldAtom *atom, atoms()){
-            atom->setCharge(partialCharges.partialCharge(atom->atom()));
-        }
+    std::vector<std::vector<chemkit::ForceFieldAtom *> > moleculeAtoms;
+    std::vector<std::vector<chemkit::ForceFieldCalculation *> > moleculeCalculations;
+    bool ok = setupMolecules(templateMolecules, moleculeAtoms, moleculeCalculations);
 
-        // add calculations
-        chemkit::ForceFieldInteractions interactions(molecule, this);
+    std::map<const chemkit::Molecule *, TopologyTemplate> topologyTemplates;
 
-        // bond strech calculations
-        std::pair<const chemkit::ForceFieldAtom *, const chemkit::ForceFieldAtom *> bondedPair;
-        foreach(bondedPair, interactions.bondedPairs()){
-            const MmffAtom *a = static_cast<const MmffAtom *>(bondedPair.first);
-            const MmffAtom *b = static_cast<const MmffAtom *>(bondedPair.second);
+    // pairs of (copy, template) calculation indices
+    std::vector<std::pair<int, int> > copiedCalculations;
 
-            addCalculation(new MmffBondStrechCalculation(a, b));
-        }
+    // calculations of the template molecules
+    std::vector<chemkit::ForceFieldCalculation *> templateCalculations;
 
-        // angle bend and strech bend calculations
-        std::vector<const chemkit::ForceFieldAtom *> angleGroup;
-        foreach(angleGroup, interactions.angleGroups()){
-            const MmffAtom *a = static_cast<const MmffAtom *>(angleGroup[0]);
-            const MmffAtom *b = static_cast<const MmffAtom *>(angleGroup[1]);
-            const MmffAtom *c = static_cast<const MmffAtom *>(angleGroup[2]);
+    // add atoms and calculations in molecule order
+    for(unsigned int i = 0; i < molecules.size(); i++){
+        const chemkit::Molecule *molecule = molecules[i];
 
-            addCalculation(new MmffAngleBendCalculation(a, b, c));
-            addCalculation(new MmffStrechBendCalculation(a, b, c));
-        }
+        if(templateMolecules[i]){
+            TopologyTemplate &topologyTemplate = topologyTemplates[molecule];
+            topologyTemplate.firstAtom = atomCount();
+            topologyTemplate.firstCalculation = calculationCount();
 
-        // out of plane bending calculation (for each trigonal center)
-        foreach(const chemkit::Atom *atom, molecule->atoms()){
-            if(atom->neighborCount() == 3){
-                const std::vector<chemkit::Atom *> &neighbors = atom->neighbors();
-                const MmffAtom *a = this->atom(neighbors[0]);
-                const MmffAtom *b = this->atom(atom);
-                const MmffAtom *c = this->atom(neighbors[1]);
-                const MmffAtom *d = this->atom(neighbors[2]);
-
-                addCalculation(new MmffOutOfPlaneBendingCalculation(a, b, c, d));
-                addCalculation(new MmffOutOfPlaneBendingCalculation(a, b, d, c));
-                addCalculation(new MmffOutOfPlaneBendingCalculation(c, b, d, a));
+            foreach(chemkit::ForceFieldAtom *atom, moleculeAtoms[i]){
+                addAtom(atom);
+            }
+            foreach(chemkit::ForceFieldCalculation *calculation, moleculeCalculations[i]){
+                addCalculation(calculation);
+                templateCalculations.push_back(calculation);
             }
+
+            topologyTemplate.lastCalculation = calculationCount();
+            continue;
         }
 
-        // torsion calculations (for each dihedral)
-        std::vector<const chemkit::ForceFieldAtom *> torsionGroup;
-        foreach(torsionGroup, interactions.torsionGroups()){
-            const MmffAtom *a = static_cast<const MmffAtom *>(torsionGroup[0]);
-            const MmffAtom *b = static_cast<const MmffAtom *>(torsionGroup[1]);
-            const MmffAtom *c = static_cast<const MmffAtom *>(torsionGroup[2]);
-            const MmffAtom *d = static_cast<const MmffAtom *>(torsionGroup[3]);
+        // copy atom types, charges and calculations from the template molecule
+        const TopologyTemplate &topologyTemplate = topologyTemplates[templates[i]];
 
-            addCalculation(new MmffTorsionCalculation(a, b, c, d));
-        }
+        std::vector<const MmffAtom *> atoms;
+        atoms.reserve(molecule->atomCount());
 
-        // van der waals and electrostatic calculations
-        std::pair<const chemkit::ForceFieldAtom *, const chemkit::ForceFieldAtom *> nonbondedPair;
-        foreach(nonbondedPair, interactions.nonbondedPairs()){
-            const MmffAtom *a = static_cast<const MmffAtom *>(nonbondedPair.first);
-            const MmffAtom *b = static_cast<const MmffAtom *>(nonbondedPair.second);
+        for(int j = 0; j < molecule->atomCount(); j++){
+            const MmffAtom *templateAtom = static_cast<const MmffAtom *>(ForceField::atom(topologyTemplate.firstAtom + j));
 
-            addCalculation(new MmffVanDerWaalsCalculation(a, b));
-            addCalculation(new MmffElectrostaticCalculation(a, b));
+            MmffAtom *mmffAtom = new MmffAtom(this, molecule->atom(j));
+            addAtom(mmffAtom);
+            mmffAtom->setType(templateAtom->typeNumber(), templateAtom->formalCharge());
+            mmffAtom->setCharge(templateAtom->charge());
+            atoms.push_back(mmffAtom);
+        }
+
+        for(int j = topologyTemplate.firstCalculation; j < topologyTemplate.lastCalculation; j++){
+            copiedCalculations.push_back(std::make_pair(calculationCount(), j));
+            addCalculation(copyCalculation(calculation(j), topologyTemplate.firstAtom, atoms));
         }
     }
 
-    bool ok = true;
+    if(!setupCalculations(templateCalculations)){
+        ok = false;
+    }
 
-    foreach(chemkit::ForceFieldCalculation *calculation, calculations()){
-        bool setup = static_cast<MmffCalculation *>(calculation)->setup(m_parameters);
+    // copy parameters from the template calculations
+    for(unsigned int i = 0; i < copiedCalculations.size(); i++){
+        chemkit::ForceFieldCalculation *calculation = this->calculation(copiedCalculations[i].first);
+        const chemkit::ForceFieldCalculation *templateCalculation = this->calculation(copiedCalculations[i].second);
 
-        if(!setup){
-            ok = false;
+        for(int j = 0; j < templateCalculation->parameterCount(); j++){
+            calculation->setParameter(j, templateCalculation->parameter(j));
         }
 
-        setCalculationSetup(calculation, setup);
+        setCalculationSetup(calculation, templateCalculation->isSetup());
     }
 
     return ok;
@@ -211,6 +215,171 @@ const MmffParameters* MmffForceField::parameters() const
     return m_parameters;
 }
 
+// Creates the atoms and calculations for molecule. This is called
+// for several molecules at once from different threads and so only
+// modifies the atoms and calculations passed to it.
+bool MmffForceField::setupMolecule(const chemkit::Molecule *molecule,
+                                   std::vector<chemkit::ForceFieldAtom *> &atoms,
+                                   std::vector<chemkit::ForceFieldCalculation *> &calculations)
+{
+    MmffAtomTyper typer(molecule);
+
+    // the torsion parameters depend on the rings of the molecule
+    // which are perceived here so that the calculations can later
+    // be set up in parallel without perceiving them concurrently
+    molecule->rings();
+
+    // add atoms
+    QHash<const chemkit::Atom *, const MmffAtom *> mmffAtoms;
+    atoms.reserve(molecule->atomCount());
+
+    foreach(const chemkit::Atom *atom, molecule->atoms()){
+        MmffAtom *mmffAtom = new MmffAtom(this, atom);
+        mmffAtom->setType(typer.typeNumber(atom), typer.formalCharge(atom));
+        mmffAtoms[atom] = mmffAtom;
+        atoms.push_back(mmffAtom);
+    }
+
+    // setup atom charges
+    MmffPartialChargePredictor partialCharges;
+    partialCharges.setAtomTyper(&typer);
+    partialCharges.setMolecule(molecule);
+
+    foreach(chemkit::ForceFieldAtom *atom, atoms){
+        atom->setCharge(partialCharges.partialCharge(atom->atom()));
+    }
+
+    // add calculations
+    chemkit::ForceFieldInteractions interactions(molecule, atoms);
+
+    // bond strech calculations
+    std::pair<const chemkit::ForceFieldAtom *, const chemkit::ForceFieldAtom *> bondedPair;
+    foreach(bondedPair, interactions.bondedPairs()){
+        const MmffAtom *a = static_cast<const MmffAtom *>(bondedPair.first);
+        const MmffAtom *b = static_cast<const MmffAtom *>(bondedPair.second);
+
+        calculations.push_back(new MmffBondStrechCalculation(a, b));
+    }
+
+    // angle bend and strech bend calculations
+    std::vector<const chemkit::ForceFieldAtom *> angleGroup;
+    foreach(angleGroup, interactions.angleGroups()){
+        const MmffAtom *a = static_cast<const MmffAtom *>(angleGroup[0]);
+        const MmffAtom *b = static_cast<const MmffAtom *>(angleGroup[1]);
+        const MmffAtom *c = static_cast<const MmffAtom *>(angleGroup[2]);
+
+        calculations.push_back(new MmffAngleBendCalculation(a, b, c));
+        calculations.push_back(new MmffStrechBendCalculation(a, b, c));
+    }
+
+    // out of plane bending calculation (for each trigonal center)
+    foreach(const chemkit::Atom *atom, molecule->atoms()){
+        if(atom->neighborCount() == 3){
+            const std::vector<chemkit::Atom *> &neighbors = atom->neighbors();
+            const MmffAtom *a = mmffAtoms[neighbors[0]];
+            const MmffAtom *b = mmffAtoms[atom];
+            const MmffAtom *c = mmffAtoms[neighbors[1]];
+            const MmffAtom *d = mmffAtoms[neighbors[2]];
+
+            calculations.push_back(new MmffOutOfPlaneBendingCalculation(a, b, c, d));
+            calculations.push_back(new MmffOutOfPlaneBendingCalculation(a, b, d, c));
+            calculations.push_back(new MmffOutOfPlaneBendingCalculation(c, b, d, a));
+        }
+    }
+
+    // torsion calculations (for each dihedral)
+    std::vector<const chemkit::ForceFieldAtom *> torsionGroup;
+    foreach(torsionGroup, interactions.torsionGroups()){
+        const MmffAtom *a = static_cast<const MmffAtom *>(torsionGroup[0]);
+        const MmffAtom *b = static_cast<const MmffAtom *>(torsionGroup[1]);
+        const MmffAtom *c = static_cast<const MmffAtom *>(torsionGroup[2]);
+        const MmffAtom *d = static_cast<const MmffAtom *>(torsionGroup[3]);
+
+        calculations.push_back(new MmffTorsionCalculation(a, b, c, d));
+    }
+
+    // van der waals and electrostatic calculations
+    std::pair<const chemkit::ForceFieldAtom *, const chemkit::ForceFieldAtom *> nonbondedPair;
+    foreach(nonbondedPair, interactions.nonbondedPairs()){
+        const MmffAtom *a = static_cast<const MmffAtom *>(nonbondedPair.first);
+        const MmffAtom *b = static_cast<const MmffAtom *>(nonbondedPair.second);
+
+        calculations.push_back(new MmffVanDerWaalsCalculation(a, b));
+        calculations.push_back(new MmffElectrostaticCalculation(a, b));
+    }
+
+    return true;
+}
+
+bool MmffForceField::setupCalculation(chemkit::ForceFieldCalculation *calculation)
+{
+    return static_cast<MmffCalculation *>(calculation)->setup(m_parameters);
+}
+
+// Returns a new calculation of the same type as calculation which
+// acts on the atoms in atoms at the same molecule indices. The atoms
+// of the template molecule start at firstAtom in the force field.
+MmffCalculation* MmffForceField::copyCalculation(const chemkit::ForceFieldCalculation *calculation,
+                                                 int firstAtom,
+                                                 const std::vector<const MmffAtom *> &atoms) const
+{
+    std::vector<const MmffAtom *> a(calculation->atomCount());
+    for(int i = 0; i < calculation->atomCount(); i++){
+        a[i] = atoms[calculation->atom(i)->index() - firstAtom];
+    }
+
+    switch(calculation->type()){
+        case chemkit::ForceFieldCalculation::BondStrech:
+            return new MmffBondStrechCalculation(a[0], a[1]);
+        case chemkit::ForceFieldCalculation::AngleBend:
+            return new MmffAngleBendCalculation(a[0], a[1], a[2]);
+        case chemkit::ForceFieldCalculation::BondStrech | chemkit::ForceFieldCalculation::AngleBend:
+            return new MmffStrechBendCalculation(a[0], a[1], a[2]);
+        case chemkit::ForceFieldCalculation::Inversion:
+            return new MmffOutOfPlaneBendingCalculation(a[0], a[1], a[2], a[3]);
+        case chemkit::ForceFieldCalculation::Torsion:
+            return new MmffTorsionCalculation(a[0], a[1], a[2], a[3]);
+        case chemkit::ForceFieldCalculation::VanDerWaals:
+            return new MmffVanDerWaalsCalculation(a[0], a[1]);
+        case chemkit::ForceFieldCalculation::Electrostatic:
+            return new MmffElectrostaticCalculation(a[0], a[1]);
+        default:
+            return 0;
+    }
+}
+
+chemkit::ForceFieldCalculation* MmffForceField::createPairCalculation(chemkit::ForceFieldCalculation::Type type,
+                                                                     const chemkit::ForceFieldAtom *a,
+                                                                     const chemkit::ForceFieldAtom *b) const
+{
+    if(!m_parameters){
+        return 0;
+    }
+
+    const MmffAtom *mmffA = static_cast<const MmffAtom *>(a);
+    const MmffAtom *mmffB = static_cast<const MmffAtom *>(b);
+
+    MmffCalculation *calculation;
+
+    switch(type){
+        case chemkit::ForceFieldCalculation::VanDerWaals:
+            calculation = new MmffVanDerWaalsCalculation(mmffA, mmffB);
+            break;
+        case chemkit::ForceFieldCalculation::Electrostatic:
+            calculation = new MmffElectrostaticCalculation(mmffA, mmffB);
+            break;
+        default:
+            return 0;
+    }
+
+    if(!calculation->setup(m_parameters)){
+        delete calculation;
+        return 0;
+    }
+
+    return calculation;
+}
+
 // --- Static Methods ------------------------------------------------------ //
 bool MmffForceField::isAromatic(const chemkit::Ring *ring)
 {
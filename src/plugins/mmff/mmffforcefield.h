@@ -67,6 +67,20 @@ class MmffForceField : public chemkit::ForceField
         static bool isAromatic(const chemkit::Bond *bond);
         static int piElectronCount(const chemkit::Ring *ring);
 
+    protected:
+        chemkit::ForceFieldCalculation* createPairCalculation(chemkit::ForceFieldCalculation::Type type,
+                                                              const chemkit::ForceFieldAtom *a,
+                                                              const chemkit::ForceFieldAtom *b) const;
+        bool setupMolecule(const chemkit::Molecule *molecule,
+                           std::vector<chemkit::ForceFieldAtom *> &atoms,
+                           std::vector<chemkit::ForceFieldCalculation *> &calculations);
+        bool setupCalculation(chemkit::ForceFieldCalculation *calculation);
+
+    private:
+        MmffCalculation* copyCalculation(const chemkit::ForceFieldCalculation *calculation,
+                                         int firstAtom,
+                                         const std::vector<const MmffAtom *> &atoms) const;
+
     private:
         MmffParameters *m_parameters;
 };
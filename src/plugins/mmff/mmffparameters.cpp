@@ -44,6 +44,7 @@
 #include <chemkit/bond.h>
 #include <chemkit/ring.h>
 #include <chemkit/pluginmanager.h>
+#include <chemkit/binaryparameterfile.h>
 
 namespace {
 
@@ -151,7 +152,10 @@ const struct MmffAtomParameters AtomParameters[] = {
 };
 
 // --- Equivalent Types ---------------------------------------------------- //
+// Equivalent types for each type at levels one through five. The
+// table is indexed by type so lookups do not need to search it.
 const int EquivalentTypes[][5] = {
+    {0, 0, 0, 0, 0},
     {1, 1, 1, 1, 0},
     {2, 2, 2, 1, 0},
     {3, 3, 3, 1, 0},
@@ -234,6 +238,10 @@ const int EquivalentTypes[][5] = {
     {80, 80, 2, 1, 0},
     {81, 81, 10, 8, 0},
     {82, 82, 9, 8, 0},
+    {0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0},
     {87, 87, 87, 87, 87},
     {88, 88, 88, 88, 88},
     {89, 89, 89, 89, 89},
@@ -249,7 +257,7 @@ const int EquivalentTypes[][5] = {
     {99, 99, 99, 99, 99},
 };
 
-int EquivalentTypesCount = sizeof(EquivalentTypes) / sizeof(*EquivalentTypes);
+const int EquivalentTypesCount = sizeof(EquivalentTypes) / sizeof(*EquivalentTypes);
 
 } // end anonymous namespace
 
@@ -270,6 +278,10 @@ std::string MmffParameters::fileName() const
     return m_fileName;
 }
 
+/// Reads the parameters from \p fileName. The file may either be
+/// a text parameters file or a binary parameters file. Text files
+/// are compiled to a binary file in the parameter cache directory
+/// on first use and subsequent reads map the cached file directly.
 bool MmffParameters::read(const std::string &fileName)
 {
     // delete old parameters data
@@ -278,186 +290,40 @@ bool MmffParameters::read(const std::string &fileName)
         d = 0;
     }
 
+    m_fileName = fileName;
+
     // try to load cached parameters
     MmffPlugin *mmffPlugin = static_cast<MmffPlugin *>(chemkit::PluginManager::instance()->plugin("mmff"));
     if(mmffPlugin){
         d = mmffPlugin->parameters(QString::fromStdString(fileName));
 
         if(d){
-            d->ref();
             return true;
         }
     }
 
-    // create new parameters data if we don't have a cached one
-    if(!d){
-        d = new MmffParametersData;
-    }
-
-    QFile file(QString::fromStdString(fileName));
-    if(!file.open(QFile::ReadOnly)){
-        setErrorString(file.errorString());
-        return false;
-    }
-
-    m_fileName = fileName;
+    d = new MmffParametersData;
 
-    // section in file
-    enum Section {
-        BondStrech,
-        EmpiricalBondStrech,
-        AngleBend,
-        StrechBend,
-        DefaultStrechBend,
-        OutOfPlaneBending,
-        Torsion,
-        VanDerWaals,
-        Charge,
-        PartialCharge,
-        End
-    };
-
-    // first section is bond strech parameters
-    int section = BondStrech;
-
-    while(!file.atEnd()){
-        QString line = file.readLine();
-
-        // lines that start with '$' indicate a new section
-        if(line.startsWith("$")){
-            section++;
-
-            if(section == End){
-                break;
-            }
+    if(chemkit::BinaryParameterFile::isBinaryParameterFile(fileName)){
+        if(!d->open(fileName)){
+            setErrorString(QString::fromStdString(d->errorString()));
+            return false;
         }
+    }
+    else{
+        // try the compiled version of the text file
+        std::string cacheFileName = chemkit::BinaryParameterFile::cacheFileName(fileName);
 
-        // lines starting with '#' are comments
-        else if(line.startsWith("#")){
-            continue;
-        }
-
-        // read data from line
-        else{
-            QStringList data = line.split(" ", QString::SkipEmptyParts);
-            if(data.isEmpty() || data.size() < 2){
-                continue;
-            }
-
-            if(section == BondStrech){
-                int bondType = data.value(0).toInt();
-                int typeA = data.value(1).toInt();
-                int typeB = data.value(2).toInt();
-
-                int index = calculateBondStrechIndex(bondType, typeA, typeB);
-
-                MmffBondStrechParameters *parameters = new MmffBondStrechParameters;
-                parameters->kb = data.value(3).toDouble();
-                parameters->r0 = data.value(4).toDouble();
-
-                d->bondStrechParameters[index] = parameters;
-            }
-            else if(section == EmpiricalBondStrech){
-            }
-            else if(section == AngleBend){
-                int angleType = data.value(0).toInt();
-                int typeA = data.value(1).toInt();
-                int typeB = data.value(2).toInt();
-                int typeC = data.value(3).toInt();
-
-                int index = calculateAngleBendIndex(angleType, typeA, typeB, typeC);
-
-                MmffAngleBendParameters *parameters = new MmffAngleBendParameters;
-                parameters->ka = data.value(4).toDouble();
-                parameters->theta0 = data.value(5).toDouble();
-
-                d->angleBendParameters[index] = parameters;
-            }
-            else if(section == StrechBend){
-                int strechBendType = data.value(0).toInt();
-                int typeA = data.value(1).toInt();
-                int typeB = data.value(2).toInt();
-                int typeC = data.value(3).toInt();
-
-                int index = calculateStrechBendIndex(strechBendType, typeA, typeB, typeC);
-
-                MmffStrechBendParameters *parameters = new MmffStrechBendParameters;
-                parameters->kba_ijk = data.value(4).toDouble();
-                parameters->kba_kji = data.value(5).toDouble();
-
-                d->strechBendParameters[index] = parameters;
-            }
-            else if(section == DefaultStrechBend){
-                MmffDefaultStrechBendParameters *parameters = new MmffDefaultStrechBendParameters;
-                parameters->rowA = data.value(0).toInt();
-                parameters->rowB = data.value(1).toInt();
-                parameters->rowC = data.value(2).toInt();
-                parameters->parameters.kba_ijk = data.value(3).toDouble();
-                parameters->parameters.kba_kji = data.value(4).toDouble();
-                d->defaultStrechBendParameters.append(parameters);
-            }
-            else if(section == OutOfPlaneBending){
-                int typeA = data.value(0).toInt();
-                int typeB = data.value(1).toInt();
-                int typeC = data.value(2).toInt();
-                int typeD = data.value(3).toInt();
-
-                int index = calculateOutOfPlaneBendingIndex(typeA, typeB, typeC, typeD);
-
-                MmffOutOfPlaneBendingParameters *parameters = new MmffOutOfPlaneBendingParameters;
-                parameters->koop = data.value(4).toDouble();
-
-                d->outOfPlaneBendingParameters[index] = parameters;
-            }
-            else if(section == Torsion){
-                int torsionType = data.value(0).toInt();
-                int typeA = data.value(1).toInt();
-                int typeB = data.value(2).toInt();
-                int typeC = data.value(3).toInt();
-                int typeD = data.value(4).toInt();
-
-                int index = calculateTorsionIndex(torsionType, typeA, typeB, typeC, typeD);
-
-                MmffTorsionParameters *parameters = new MmffTorsionParameters;
-                parameters->V1 = data.value(5).toDouble();
-                parameters->V2 = data.value(6).toDouble();
-                parameters->V3 = data.value(7).toDouble();
-
-                d->torsionParameters[index] = parameters;
-            }
-            else if(section == VanDerWaals){
-                int type = data.value(0).toInt();
-                if(type > MaxAtomType)
-                    continue;
-
-                MmffVanDerWaalsParameters *parameters = new MmffVanDerWaalsParameters;
-                parameters->alpha = data.value(1).toDouble();
-                parameters->N = data.value(2).toDouble();
-                parameters->A = data.value(3).toDouble();
-                parameters->G = data.value(4).toDouble();
-                parameters->DA = data.value(5).at(0).toAscii();
+        if(!d->open(cacheFileName) || !d->isCurrent(fileName)){
+            d->deref();
+            d = new MmffParametersData;
 
-                d->vanDerWaalsParameters[type] = parameters;
+            if(!readText(fileName)){
+                return false;
             }
-            else if(section == Charge){
-                MmffChargeParameters *parameters = new MmffChargeParameters;
-                parameters->bondType = data.value(0).toInt();
-                parameters->typeA = data.value(1).toInt();
-                parameters->typeB = data.value(2).toInt();
-                parameters->bci = data.value(3).toDouble();
-                d->chargeParameters.append(parameters);
-            }
-            else if(section == PartialCharge){
-                int type = data.value(1).toInt();
-                if(type > MaxAtomType)
-                    continue;
 
-                MmffPartialChargeParameters *parameters = new MmffPartialChargeParameters;
-                parameters->pbci = data.value(2).toDouble();
-                parameters->fcadj = data.value(3).toDouble();
-
-                d->partialChargeParameters[type] = parameters;
-            }
+            // failing to write the cache is not an error
+            d->write(cacheFileName, fileName);
         }
     }
 
@@ -570,7 +436,7 @@ const MmffVanDerWaalsParameters* MmffParameters::vanDerWaalsParameters(const Mmf
 {
     int type = atom->typeNumber();
 
-    return d->vanDerWaalsParameters.value(type, 0);
+    return d->vanDerWaalsParameters.value(type);
 }
 
 const MmffAtomParameters* MmffParameters::atomParameters(int type) const
@@ -590,15 +456,7 @@ const MmffChargeParameters* MmffParameters::chargeParameters(const chemkit::Atom
 {
     int bondType = calculateBondType(a->bondTo(b), typeA, typeB);
 
-    foreach(const MmffChargeParameters *parameters, d->chargeParameters){
-        if(parameters->bondType == bondType &&
-           parameters->typeA == typeA &&
-           parameters->typeB == typeB){
-            return parameters;
-        }
-    }
-
-    return 0;
+    return d->chargeParameters.value(calculateChargeIndex(bondType, typeA, typeB));
 }
 
 const MmffChargeParameters* MmffParameters::chargeParameters(const MmffAtom *a, const MmffAtom *b) const
@@ -608,7 +466,7 @@ const MmffChargeParameters* MmffParameters::chargeParameters(const MmffAtom *a,
 
 const MmffPartialChargeParameters* MmffParameters::partialChargeParameters(int type) const
 {
-    return d->partialChargeParameters.value(type, 0);
+    return d->partialChargeParameters.value(type);
 }
 
 const MmffPartialChargeParameters* MmffParameters::partialChargeParameters(const MmffAtom *atom) const
@@ -624,7 +482,7 @@ const MmffBondStrechParameters* MmffParameters::bondStrechParameters(int bondTyp
 
     int index = calculateBondStrechIndex(bondType, typeA, typeB);
 
-    return d->bondStrechParameters.value(index, 0);
+    return d->bondStrechParameters.value(index);
 }
 
 const MmffBondStrechParameters* MmffParameters::empiricalBondStrechParameters(int atomicNumberA, int atomicNumberB) const
@@ -642,27 +500,19 @@ const MmffAngleBendParameters* MmffParameters::angleBendParameters(int angleType
 
     int index = calculateAngleBendIndex(angleType, typeA, typeB, typeC);
 
-    return d->angleBendParameters.value(index, 0);
+    return d->angleBendParameters.value(index);
 }
 
 const MmffStrechBendParameters* MmffParameters::strechBendParameters(int strechBendType, int typeA, int typeB, int typeC) const
 {
     int index = calculateStrechBendIndex(strechBendType, typeA, typeB, typeC);
 
-    return d->strechBendParameters.value(index, 0);
+    return d->strechBendParameters.value(index);
 }
 
 const MmffStrechBendParameters* MmffParameters::defaultStrechBendParameters(int rowA, int rowB, int rowC) const
 {
-    foreach(const MmffDefaultStrechBendParameters *parameters, d->defaultStrechBendParameters){
-        if(parameters->rowA == rowA &&
-           parameters->rowB == rowB &&
-           parameters->rowC == rowC){
-            return &parameters->parameters;
-        }
-    }
-
-    return 0;
+    return d->defaultStrechBendParameters.value(calculateDefaultStrechBendIndex(rowA, rowB, rowC));
 }
 
 const MmffOutOfPlaneBendingParameters* MmffParameters::outOfPlaneBendingParameters(int typeA, int typeB, int typeC, int typeD) const
@@ -675,7 +525,7 @@ const MmffOutOfPlaneBendingParameters* MmffParameters::outOfPlaneBendingParamete
 
     int index = calculateOutOfPlaneBendingIndex(typeA, typeB, typeC, typeD);
 
-    return d->outOfPlaneBendingParameters.value(index, 0);
+    return d->outOfPlaneBendingParameters.value(index);
 }
 
 const MmffTorsionParameters* MmffParameters::torsionParameters(int torsionType, int typeA, int typeB, int typeC, int typeD) const
@@ -690,7 +540,7 @@ const MmffTorsionParameters* MmffParameters::torsionParameters(int torsionType,
 
     int index = calculateTorsionIndex(torsionType, typeA, typeB, typeC, typeD);
 
-    return d->torsionParameters.value(index, 0);
+    return d->torsionParameters.value(index);
 }
 
 int MmffParameters::calculateBondType(const chemkit::Bond *bond, int typeA, int typeB) const
@@ -884,13 +734,12 @@ int MmffParameters::equivalentType(const MmffAtom *atom, int level) const
         return atom->typeNumber();
     }
 
-    for(int i = 0; i < EquivalentTypesCount; i++){
-        if(EquivalentTypes[i][0] == atom->typeNumber()){
-            return EquivalentTypes[i][level-1];
-        }
+    int type = atom->typeNumber();
+    if(type < 0 || type >= EquivalentTypesCount || level > 5){
+        return 0;
     }
 
-    return 0;
+    return EquivalentTypes[type][level-1];
 }
 
 int MmffParameters::calculateBondStrechIndex(int bondType, int typeA, int typeB) const
@@ -918,6 +767,203 @@ int MmffParameters::calculateTorsionIndex(int torsionType, int typeA, int typeB,
     return 6 * (typeB * (136*136*136) + typeC * (136*136) + typeA * 136 + typeD) + torsionType;
 }
 
+int MmffParameters::calculateDefaultStrechBendIndex(int rowA, int rowB, int rowC) const
+{
+    return rowA * 100 + rowB * 10 + rowC;
+}
+
+int MmffParameters::calculateChargeIndex(int bondType, int typeA, int typeB) const
+{
+    return 2 * (typeA * 136 + typeB) + bondType;
+}
+
+bool MmffParameters::readText(const std::string &fileName)
+{
+    QFile file(QString::fromStdString(fileName));
+    if(!file.open(QFile::ReadOnly)){
+        setErrorString(file.errorString());
+        return false;
+    }
+
+    std::vector<MmffParametersRecord<MmffBondStrechParameters> > bondStrechParameters;
+    std::vector<MmffParametersRecord<MmffAngleBendParameters> > angleBendParameters;
+    std::vector<MmffParametersRecord<MmffStrechBendParameters> > strechBendParameters;
+    std::vector<MmffParametersRecord<MmffStrechBendParameters> > defaultStrechBendParameters;
+    std::vector<MmffParametersRecord<MmffOutOfPlaneBendingParameters> > outOfPlaneBendingParameters;
+    std::vector<MmffParametersRecord<MmffTorsionParameters> > torsionParameters;
+    std::vector<MmffParametersRecord<MmffVanDerWaalsParameters> > vanDerWaalsParameters;
+    std::vector<MmffParametersRecord<MmffChargeParameters> > chargeParameters;
+    std::vector<MmffParametersRecord<MmffPartialChargeParameters> > partialChargeParameters;
+
+    // section in file
+    enum Section {
+        BondStrech,
+        EmpiricalBondStrech,
+        AngleBend,
+        StrechBend,
+        DefaultStrechBend,
+        OutOfPlaneBending,
+        Torsion,
+        VanDerWaals,
+        Charge,
+        PartialCharge,
+        End
+    };
+
+    // first section is bond strech parameters
+    int section = BondStrech;
+
+    while(!file.atEnd()){
+        QString line = file.readLine();
+
+        // lines that start with '$' indicate a new section
+        if(line.startsWith("$")){
+            section++;
+
+            if(section == End){
+                break;
+            }
+        }
+
+        // lines starting with '#' are comments
+        else if(line.startsWith("#")){
+            continue;
+        }
+
+        // read data from line
+        else{
+            QStringList data = line.split(" ", QString::SkipEmptyParts);
+            if(data.isEmpty() || data.size() < 2){
+                continue;
+            }
+
+            if(section == BondStrech){
+                int bondType = data.value(0).toInt();
+                int typeA = data.value(1).toInt();
+                int typeB = data.value(2).toInt();
+
+                MmffParametersRecord<MmffBondStrechParameters> record = MmffParametersRecord<MmffBondStrechParameters>();
+                record.index = calculateBondStrechIndex(bondType, typeA, typeB);
+                record.parameters.kb = data.value(3).toDouble();
+                record.parameters.r0 = data.value(4).toDouble();
+                bondStrechParameters.push_back(record);
+            }
+            else if(section == EmpiricalBondStrech){
+            }
+            else if(section == AngleBend){
+                int angleType = data.value(0).toInt();
+                int typeA = data.value(1).toInt();
+                int typeB = data.value(2).toInt();
+                int typeC = data.value(3).toInt();
+
+                MmffParametersRecord<MmffAngleBendParameters> record = MmffParametersRecord<MmffAngleBendParameters>();
+                record.index = calculateAngleBendIndex(angleType, typeA, typeB, typeC);
+                record.parameters.ka = data.value(4).toDouble();
+                record.parameters.theta0 = data.value(5).toDouble();
+                angleBendParameters.push_back(record);
+            }
+            else if(section == StrechBend){
+                int strechBendType = data.value(0).toInt();
+                int typeA = data.value(1).toInt();
+                int typeB = data.value(2).toInt();
+                int typeC = data.value(3).toInt();
+
+                MmffParametersRecord<MmffStrechBendParameters> record = MmffParametersRecord<MmffStrechBendParameters>();
+                record.index = calculateStrechBendIndex(strechBendType, typeA, typeB, typeC);
+                record.parameters.kba_ijk = data.value(4).toDouble();
+                record.parameters.kba_kji = data.value(5).toDouble();
+                strechBendParameters.push_back(record);
+            }
+            else if(section == DefaultStrechBend){
+                int rowA = data.value(0).toInt();
+                int rowB = data.value(1).toInt();
+                int rowC = data.value(2).toInt();
+
+                MmffParametersRecord<MmffStrechBendParameters> record = MmffParametersRecord<MmffStrechBendParameters>();
+                record.index = calculateDefaultStrechBendIndex(rowA, rowB, rowC);
+                record.parameters.kba_ijk = data.value(3).toDouble();
+                record.parameters.kba_kji = data.value(4).toDouble();
+                defaultStrechBendParameters.push_back(record);
+            }
+            else if(section == OutOfPlaneBending){
+                int typeA = data.value(0).toInt();
+                int typeB = data.value(1).toInt();
+                int typeC = data.value(2).toInt();
+                int typeD = data.value(3).toInt();
+
+                MmffParametersRecord<MmffOutOfPlaneBendingParameters> record = MmffParametersRecord<MmffOutOfPlaneBendingParameters>();
+                record.index = calculateOutOfPlaneBendingIndex(typeA, typeB, typeC, typeD);
+                record.parameters.koop = data.value(4).toDouble();
+                outOfPlaneBendingParameters.push_back(record);
+            }
+            else if(section == Torsion){
+                int torsionType = data.value(0).toInt();
+                int typeA = data.value(1).toInt();
+                int typeB = data.value(2).toInt();
+                int typeC = data.value(3).toInt();
+                int typeD = data.value(4).toInt();
+
+                MmffParametersRecord<MmffTorsionParameters> record = MmffParametersRecord<MmffTorsionParameters>();
+                record.index = calculateTorsionIndex(torsionType, typeA, typeB, typeC, typeD);
+                record.parameters.V1 = data.value(5).toDouble();
+                record.parameters.V2 = data.value(6).toDouble();
+                record.parameters.V3 = data.value(7).toDouble();
+                torsionParameters.push_back(record);
+            }
+            else if(section == VanDerWaals){
+                int type = data.value(0).toInt();
+                if(type > MaxAtomType)
+                    continue;
+
+                MmffParametersRecord<MmffVanDerWaalsParameters> record = MmffParametersRecord<MmffVanDerWaalsParameters>();
+                record.index = type;
+                record.parameters.alpha = data.value(1).toDouble();
+                record.parameters.N = data.value(2).toDouble();
+                record.parameters.A = data.value(3).toDouble();
+                record.parameters.G = data.value(4).toDouble();
+                record.parameters.DA = data.value(5).at(0).toAscii();
+                vanDerWaalsParameters.push_back(record);
+            }
+            else if(section == Charge){
+                MmffParametersRecord<MmffChargeParameters> record = MmffParametersRecord<MmffChargeParameters>();
+                record.parameters.bondType = data.value(0).toInt();
+                record.parameters.typeA = data.value(1).toInt();
+                record.parameters.typeB = data.value(2).toInt();
+                record.parameters.bci = data.value(3).toDouble();
+                record.index = calculateChargeIndex(record.parameters.bondType,
+                                                    record.parameters.typeA,
+                                                    record.parameters.typeB);
+                chargeParameters.push_back(record);
+            }
+            else if(section == PartialCharge){
+                int type = data.value(1).toInt();
+                if(type > MaxAtomType)
+                    continue;
+
+                MmffParametersRecord<MmffPartialChargeParameters> record = MmffParametersRecord<MmffPartialChargeParameters>();
+                record.index = type;
+                record.parameters.pbci = data.value(2).toDouble();
+                record.parameters.fcadj = data.value(3).toDouble();
+                partialChargeParameters.push_back(record);
+            }
+        }
+    }
+
+    // tables must be added in the same order as MmffParametersData::Table
+    d->addTable(bondStrechParameters, MmffParametersData::Dense);
+    d->addTable(angleBendParameters, MmffParametersData::PerfectHash);
+    d->addTable(strechBendParameters, MmffParametersData::PerfectHash);
+    d->addTable(defaultStrechBendParameters, MmffParametersData::Dense);
+    d->addTable(outOfPlaneBendingParameters, MmffParametersData::PerfectHash);
+    d->addTable(torsionParameters, MmffParametersData::PerfectHash);
+    d->addTable(vanDerWaalsParameters, MmffParametersData::Dense);
+    d->addTable(chargeParameters, MmffParametersData::Dense);
+    d->addTable(partialChargeParameters, MmffParametersData::Dense);
+    d->setup();
+
+    return true;
+}
+
 // --- Error Handling ------------------------------------------------------ //
 void MmffParameters::setErrorString(const QString &errorString)
 {
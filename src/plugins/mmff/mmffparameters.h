@@ -62,14 +62,6 @@ struct MmffStrechBendParameters
     chemkit::Float kba_kji;
 };
 
-struct MmffDefaultStrechBendParameters
-{
-    int rowA;
-    int rowB;
-    int rowC;
-    MmffStrechBendParameters parameters;
-};
-
 struct MmffOutOfPlaneBendingParameters
 {
     chemkit::Float koop;
@@ -166,6 +158,9 @@ class MmffParameters
         int calculateStrechBendIndex(int strechBendType, int typeA, int typeB, int typeC) const;
         int calculateOutOfPlaneBendingIndex(int typeA, int typeB, int typeC, int typeD) const;
         int calculateTorsionIndex(int torsionType, int typeA, int typeB, int typeC, int typeD) const;
+        int calculateDefaultStrechBendIndex(int rowA, int rowB, int rowC) const;
+        int calculateChargeIndex(int bondType, int typeA, int typeB) const;
+        bool readText(const std::string &fileName);
         void setErrorString(const QString &errorString);
 
     private:
@@ -35,12 +35,13 @@
 
 #include "mmffparametersdata.h"
 
+#include <algorithm>
+
 // === MmffParametersData ================================================== //
 // --- Construction and Destruction ---------------------------------------- //
 /// Creates a new parameters data object.
 MmffParametersData::MmffParametersData()
-    : vanDerWaalsParameters(MmffParameters::MaxAtomType + 1),
-      partialChargeParameters(MmffParameters::MaxAtomType + 1)
+    : m_file("mmff", BinaryVersion)
 {
     m_refcount.ref();
 }
@@ -49,15 +50,6 @@ MmffParametersData::MmffParametersData()
 /// directly, instead use the deref() method.
 MmffParametersData::~MmffParametersData()
 {
-    qDeleteAll(bondStrechParameters.values());
-    qDeleteAll(angleBendParameters.values());
-    qDeleteAll(strechBendParameters.values());
-    qDeleteAll(defaultStrechBendParameters);
-    qDeleteAll(outOfPlaneBendingParameters.values());
-    qDeleteAll(torsionParameters.values());
-    qDeleteAll(vanDerWaalsParameters);
-    qDeleteAll(chargeParameters);
-    qDeleteAll(partialChargeParameters);
 }
 
 // --- Reference Counting -------------------------------------------------- //
@@ -75,3 +67,142 @@ void MmffParametersData::deref()
         delete this;
     }
 }
+
+// --- Input and Output ---------------------------------------------------- //
+/// Opens the binary parameters file \p fileName. The parameter
+/// records are used directly from the memory-mapped file.
+bool MmffParametersData::open(const std::string &fileName)
+{
+    if(!m_file.open(fileName)){
+        return false;
+    }
+
+    if(m_file.sectionCount() != 3 * TableCount){
+        m_file.close();
+        return false;
+    }
+
+    setup();
+
+    return true;
+}
+
+/// Returns \c true if the parameters were generated from the
+/// current contents of \p sourceFileName.
+bool MmffParametersData::isCurrent(const std::string &sourceFileName) const
+{
+    return m_file.isCurrent(sourceFileName);
+}
+
+/// Writes the parameters to the binary parameters file \p fileName.
+bool MmffParametersData::write(const std::string &fileName, const std::string &sourceFileName)
+{
+    m_file.setSourceFile(sourceFileName);
+
+    return m_file.write(fileName);
+}
+
+/// Points the parameter tables at the records in each section.
+void MmffParametersData::setup()
+{
+    setupTable(bondStrechParameters, BondStrech);
+    setupTable(angleBendParameters, AngleBend);
+    setupTable(strechBendParameters, StrechBend);
+    setupTable(defaultStrechBendParameters, DefaultStrechBend);
+    setupTable(outOfPlaneBendingParameters, OutOfPlaneBending);
+    setupTable(torsionParameters, Torsion);
+    setupTable(vanDerWaalsParameters, VanDerWaals);
+    setupTable(chargeParameters, Charge);
+    setupTable(partialChargeParameters, PartialCharge);
+}
+
+// --- Internal Methods ---------------------------------------------------- //
+// Adds the slots and seeds sections for a table with the sorted
+// record indices. Dense tables have a slot for every possible index
+// up to the largest one. Perfect hash tables hash each index into a
+// bucket and then search for a seed for the bucket which places all
+// of its indices in empty slots, starting with the largest buckets.
+void MmffParametersData::addSlots(const std::vector<int> &indices, Lookup lookup)
+{
+    std::vector<qint32> slotRecords;
+    std::vector<qint32> seeds;
+
+    if(indices.empty()){
+    }
+    else if(lookup == Dense){
+        slotRecords.resize(indices.back() + 1, -1);
+
+        for(size_t i = 0; i < indices.size(); i++){
+            slotRecords[indices[i]] = i;
+        }
+    }
+    else{
+        int slotCount = indices.size() + indices.size() / 4 + 1;
+        int bucketCount = indices.size() / 4 + 1;
+
+        for(;;){
+            std::vector<std::vector<int> > buckets(bucketCount);
+            for(size_t i = 0; i < indices.size(); i++){
+                buckets[mmffParametersHash(indices[i], 0) % bucketCount].push_back(i);
+            }
+
+            // place the largest buckets first
+            std::vector<std::pair<int, int> > order;
+            for(int i = 0; i < bucketCount; i++){
+                order.push_back(std::make_pair(-int(buckets[i].size()), i));
+            }
+            std::sort(order.begin(), order.end());
+
+            slotRecords.assign(slotCount, -1);
+            seeds.assign(bucketCount, 0);
+
+            bool placed = true;
+            for(int i = 0; i < bucketCount && placed; i++){
+                const std::vector<int> &bucket = buckets[order[i].second];
+                if(bucket.empty()){
+                    break;
+                }
+
+                placed = false;
+                for(quint32 seed = 1; seed < (1u << 16) && !placed; seed++){
+                    std::vector<int> bucketSlots;
+                    for(size_t j = 0; j < bucket.size(); j++){
+                        int slot = mmffParametersHash(indices[bucket[j]], seed) % slotCount;
+                        if(slotRecords[slot] != -1 ||
+                           std::find(bucketSlots.begin(), bucketSlots.end(), slot) != bucketSlots.end()){
+                            break;
+                        }
+
+                        bucketSlots.push_back(slot);
+                    }
+
+                    if(bucketSlots.size() == bucket.size()){
+                        for(size_t j = 0; j < bucket.size(); j++){
+                            slotRecords[bucketSlots[j]] = bucket[j];
+                        }
+
+                        seeds[order[i].second] = seed;
+                        placed = true;
+                    }
+                }
+            }
+
+            if(placed){
+                break;
+            }
+
+            // no seed found for a bucket so retry with more slotRecords
+            slotCount += slotCount / 2;
+        }
+    }
+
+    m_file.addSection(slotRecords);
+    m_file.addSection(seeds);
+}
+
+// --- Error Handling ------------------------------------------------------ //
+/// Returns a string describing the last error that occured.
+std::string MmffParametersData::errorString() const
+{
+    return m_file.errorString();
+}
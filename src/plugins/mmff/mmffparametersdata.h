@@ -38,11 +38,81 @@
 
 #include <QtCore>
 
+#include <vector>
+#include <algorithm>
+
+#include <chemkit/binaryparameterfile.h>
+
 #include "mmffparameters.h"
 
+template<typename T>
+struct MmffParametersRecord
+{
+    int index;
+    T parameters;
+};
+
+// Returns the hash of key for seed. Used by the perfect hash tables.
+inline quint32 mmffParametersHash(quint32 key, quint32 seed)
+{
+    quint32 hash = key ^ (seed * 0x9e3779b9u);
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+
+    return hash;
+}
+
+// The MmffParametersTable class maps parameter indices to records.
+// Dense tables store the record for each index in a flat array
+// while sparse tables use a perfect hash where each bucket has a
+// seed chosen so that no two indices map to the same slot.
+template<typename T>
+class MmffParametersTable
+{
+    public:
+        MmffParametersTable();
+
+        void setRecords(const MmffParametersRecord<T> *records, int size);
+        void setSlots(const qint32 *slotRecords, int slotCount, const qint32 *seeds, int seedCount);
+        int size() const;
+        const T* value(int index) const;
+
+    private:
+        const MmffParametersRecord<T> *m_records;
+        int m_size;
+        const qint32 *m_slots;
+        int m_slotCount;
+        const qint32 *m_seeds;
+        int m_seedCount;
+};
+
 class MmffParametersData
 {
     public:
+        // parameter tables, each is stored as three sections in the
+        // binary parameter file (records, slots and seeds)
+        enum Table {
+            BondStrech,
+            AngleBend,
+            StrechBend,
+            DefaultStrechBend,
+            OutOfPlaneBending,
+            Torsion,
+            VanDerWaals,
+            Charge,
+            PartialCharge,
+            TableCount
+        };
+
+        // lookup used for a table
+        enum Lookup {
+            Dense,
+            PerfectHash
+        };
+
         // construction and destruction
         MmffParametersData();
 
@@ -50,22 +120,151 @@ class MmffParametersData
         void ref();
         void deref();
 
+        // tables
+        template<typename T> void addTable(std::vector<MmffParametersRecord<T> > &records, Lookup lookup);
+
+        // input and output
+        bool open(const std::string &fileName);
+        bool isCurrent(const std::string &sourceFileName) const;
+        bool write(const std::string &fileName, const std::string &sourceFileName);
+        void setup();
+
+        // error handling
+        std::string errorString() const;
+
+        // constants
+        const static int BinaryVersion = 2;
+
     private:
         ~MmffParametersData();
 
+        void addSlots(const std::vector<int> &indices, Lookup lookup);
+        template<typename T> void setupTable(MmffParametersTable<T> &table, int index);
+        template<typename T> static bool lessThan(const MmffParametersRecord<T> &a, const MmffParametersRecord<T> &b);
+
     public:
-        QMap<int, MmffBondStrechParameters *> bondStrechParameters;
-        QMap<int, MmffAngleBendParameters *> angleBendParameters;
-        QMap<int, MmffStrechBendParameters *> strechBendParameters;
-        QList<MmffDefaultStrechBendParameters *> defaultStrechBendParameters;
-        QMap<int, MmffOutOfPlaneBendingParameters *> outOfPlaneBendingParameters;
-        QMap<int, MmffTorsionParameters *> torsionParameters;
-        QVector<MmffVanDerWaalsParameters *> vanDerWaalsParameters;
-        QList<MmffChargeParameters *> chargeParameters;
-        QVector<MmffPartialChargeParameters *> partialChargeParameters;
+        MmffParametersTable<MmffBondStrechParameters> bondStrechParameters;
+        MmffParametersTable<MmffAngleBendParameters> angleBendParameters;
+        MmffParametersTable<MmffStrechBendParameters> strechBendParameters;
+        MmffParametersTable<MmffStrechBendParameters> defaultStrechBendParameters;
+        MmffParametersTable<MmffOutOfPlaneBendingParameters> outOfPlaneBendingParameters;
+        MmffParametersTable<MmffTorsionParameters> torsionParameters;
+        MmffParametersTable<MmffVanDerWaalsParameters> vanDerWaalsParameters;
+        MmffParametersTable<MmffChargeParameters> chargeParameters;
+        MmffParametersTable<MmffPartialChargeParameters> partialChargeParameters;
 
     private:
         QAtomicInt m_refcount;
+        chemkit::BinaryParameterFile m_file;
 };
 
+// === MmffParametersTable ================================================= //
+template<typename T>
+inline MmffParametersTable<T>::MmffParametersTable()
+    : m_records(0),
+      m_size(0),
+      m_slots(0),
+      m_slotCount(0),
+      m_seeds(0),
+      m_seedCount(0)
+{
+}
+
+template<typename T>
+inline void MmffParametersTable<T>::setRecords(const MmffParametersRecord<T> *records, int size)
+{
+    m_records = records;
+    m_size = size;
+}
+
+template<typename T>
+inline void MmffParametersTable<T>::setSlots(const qint32 *slotRecords, int slotCount, const qint32 *seeds, int seedCount)
+{
+    m_slots = slotRecords;
+    m_slotCount = slotCount;
+    m_seeds = seeds;
+    m_seedCount = seedCount;
+}
+
+template<typename T>
+inline int MmffParametersTable<T>::size() const
+{
+    return m_size;
+}
+
+template<typename T>
+inline const T* MmffParametersTable<T>::value(int index) const
+{
+    if(m_slotCount == 0 || index < 0){
+        return 0;
+    }
+
+    int slot;
+    if(m_seedCount == 0){
+        if(index >= m_slotCount){
+            return 0;
+        }
+
+        slot = index;
+    }
+    else{
+        quint32 seed = m_seeds[mmffParametersHash(index, 0) % m_seedCount];
+        slot = mmffParametersHash(index, seed) % m_slotCount;
+    }
+
+    int record = m_slots[slot];
+    if(record < 0 || record >= m_size || m_records[record].index != index){
+        return 0;
+    }
+
+    return &m_records[record].parameters;
+}
+
+// === MmffParametersData ================================================== //
+// Adds a table containing records. If an index is listed more than
+// once the last record is used.
+template<typename T>
+inline void MmffParametersData::addTable(std::vector<MmffParametersRecord<T> > &records, Lookup lookup)
+{
+    std::stable_sort(records.begin(), records.end(), lessThan<T>);
+
+    std::vector<MmffParametersRecord<T> > unique;
+    for(size_t i = 0; i < records.size(); i++){
+        if(!unique.empty() && unique.back().index == records[i].index){
+            unique.back() = records[i];
+        }
+        else{
+            unique.push_back(records[i]);
+        }
+    }
+
+    std::vector<int> indices;
+    for(size_t i = 0; i < unique.size(); i++){
+        indices.push_back(unique[i].index);
+    }
+
+    m_file.addSection(unique);
+    addSlots(indices, lookup);
+}
+
+template<typename T>
+inline void MmffParametersData::setupTable(MmffParametersTable<T> &table, int index)
+{
+    int recordCount = 0;
+    const MmffParametersRecord<T> *records = m_file.section<MmffParametersRecord<T> >(3 * index, &recordCount);
+    table.setRecords(records, recordCount);
+
+    int slotCount = 0;
+    const qint32 *slotRecords = m_file.section<qint32>(3 * index + 1, &slotCount);
+    int seedCount = 0;
+    const qint32 *seeds = m_file.section<qint32>(3 * index + 2, &seedCount);
+    table.setSlots(slotRecords, slotCount, seeds, seedCount);
+}
+
+template<typename T>
+inline bool MmffParametersData::lessThan(const MmffParametersRecord<T> &a, const MmffParametersRecord<T> &b)
+{
+    return a.index < b.index;
+}
+
 #endif // MMFFPARAMETERSDATA_H
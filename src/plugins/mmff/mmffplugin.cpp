@@ -59,8 +59,13 @@ MmffPlugin::~MmffPlugin()
     unregisterPluginClass<chemkit::PartialChargePredictor>("mmff");
 }
 
+// The parameters cache is shared by every force field, atom typer
+// and charge predictor and may be used from several threads at once
+// (e.g. when setting up molecules in parallel).
 void MmffPlugin::storeParameters(const QString &name, MmffParametersData *parameters)
 {
+    QMutexLocker locker(&m_parametersCacheMutex);
+
     if(m_parametersCache.contains(name)){
         m_parametersCache[name]->deref();
     }
@@ -69,9 +74,19 @@ void MmffPlugin::storeParameters(const QString &name, MmffParametersData *parame
     parameters->ref();
 }
 
+// Returns the cached parameters for name with an added reference
+// which the caller must release with deref(). Returns 0 if the
+// parameters are not cached.
 MmffParametersData* MmffPlugin::parameters(const QString &name) const
 {
-    return m_parametersCache.value(name, 0);
+    QMutexLocker locker(&m_parametersCacheMutex);
+
+    MmffParametersData *parameters = m_parametersCache.value(name, 0);
+    if(parameters){
+        parameters->ref();
+    }
+
+    return parameters;
 }
 
 chemkit::AtomTyper* MmffPlugin::createMmffAtomTyper()
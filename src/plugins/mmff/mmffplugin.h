@@ -62,6 +62,7 @@ class MmffPlugin : public chemkit::Plugin
 
     private:
         QHash<QString, MmffParametersData *> m_parametersCache;
+        mutable QMutex m_parametersCacheMutex;
 };
 
 #endif // MMFFPLUGIN_H
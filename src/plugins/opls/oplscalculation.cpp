@@ -247,15 +247,15 @@ std::vector<chemkit::Vector3> OplsTorsionCalculation::gradient() const
     return gradient;
 }
 
-// === OplsNonbondedCalculation ============================================ //
-OplsNonbondedCalculation::OplsNonbondedCalculation(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b)
-    : OplsCalculation(VanDerWaals | Electrostatic, 2, 5)
+// === OplsVanDerWaalsCalculation ========================================= //
+OplsVanDerWaalsCalculation::OplsVanDerWaalsCalculation(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b)
+    : OplsCalculation(VanDerWaals, 2, 3)
 {
     setAtom(0, a);
     setAtom(1, b);
 }
 
-bool OplsNonbondedCalculation::setup(const OplsParameters *parameters)
+bool OplsVanDerWaalsCalculation::setup(const OplsParameters *parameters)
 {
     const chemkit::ForceFieldAtom *a = atom(0);
     const chemkit::ForceFieldAtom *b = atom(1);
@@ -269,28 +269,91 @@ bool OplsNonbondedCalculation::setup(const OplsParameters *parameters)
         return false;
     }
 
-    chemkit::Float qa = parameters->partialCharge(typeA);
-    chemkit::Float qb = parameters->partialCharge(typeB);
     chemkit::Float sigma = sqrt(pa->sigma * pb->sigma);
     chemkit::Float epsilon = sqrt(pa->epsilon * pb->epsilon);
 
-    setParameter(0, qa);
-    setParameter(1, qb);
-    setParameter(2, sigma);
-    setParameter(3, epsilon);
+    setParameter(0, sigma);
+    setParameter(1, epsilon);
 
     // one-four scaling
     if(a->isOneFour(b)){
-        setParameter(4, 0.5);
+        setParameter(2, 0.5);
     }
     else{
-        setParameter(4, 1.0);
+        setParameter(2, 1.0);
     }
 
     return true;
 }
 
-chemkit::Float OplsNonbondedCalculation::energy() const
+chemkit::Float OplsVanDerWaalsCalculation::energy() const
+{
+    const chemkit::ForceFieldAtom *a = atom(0);
+    const chemkit::ForceFieldAtom *b = atom(1);
+
+    chemkit::Float sigma = parameter(0);
+    chemkit::Float epsilon = parameter(1);
+    chemkit::Float scale = parameter(2);
+
+    chemkit::Float r = distance(a, b);
+
+    return scale * 4.0 * epsilon * (pow(sigma / r, 12) - pow(sigma / r, 6));
+}
+
+std::vector<chemkit::Vector3> OplsVanDerWaalsCalculation::gradient() const
+{
+    const chemkit::ForceFieldAtom *a = atom(0);
+    const chemkit::ForceFieldAtom *b = atom(1);
+
+    chemkit::Float sigma = parameter(0);
+    chemkit::Float epsilon = parameter(1);
+    chemkit::Float scale = parameter(2);
+
+    chemkit::Float r = distance(a, b);
+    chemkit::Float sr = sigma / r;
+
+    // dE/dr
+    chemkit::Float de_dr = scale * -4.0 * epsilon * (12.0 * pow(sr, 11) - 6.0 * pow(sr, 5)) * sigma / pow(r, 2);
+
+    std::vector<chemkit::Vector3> gradient = distanceGradient(a, b);
+
+    gradient[0] *= de_dr;
+    gradient[1] *= de_dr;
+
+    return gradient;
+}
+
+// === OplsElectrostaticCalculation ======================================== //
+OplsElectrostaticCalculation::OplsElectrostaticCalculation(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b)
+    : OplsCalculation(Electrostatic, 2, 3)
+{
+    setAtom(0, a);
+    setAtom(1, b);
+}
+
+bool OplsElectrostaticCalculation::setup(const OplsParameters *parameters)
+{
+    const chemkit::ForceFieldAtom *a = atom(0);
+    const chemkit::ForceFieldAtom *b = atom(1);
+
+    int typeA = boost::lexical_cast<int>(a->type());
+    int typeB = boost::lexical_cast<int>(b->type());
+
+    setParameter(0, parameters->partialCharge(typeA));
+    setParameter(1, parameters->partialCharge(typeB));
+
+    // one-four scaling
+    if(a->isOneFour(b)){
+        setParameter(2, 0.5);
+    }
+    else{
+        setParameter(2, 1.0);
+    }
+
+    return true;
+}
+
+chemkit::Float OplsElectrostaticCalculation::energy() const
 {
     const chemkit::ForceFieldAtom *a = atom(0);
     const chemkit::ForceFieldAtom *b = atom(1);
@@ -298,40 +361,32 @@ chemkit::Float OplsNonbondedCalculation::energy() const
     chemkit::Float qa = parameter(0);
     chemkit::Float qb = parameter(1);
     chemkit::Float e = 332.06; // vacuum permitivity
-    chemkit::Float sigma = parameter(2);
-    chemkit::Float epsilon = parameter(3);
-    chemkit::Float scale = parameter(4);
+    chemkit::Float scale = parameter(2);
 
     chemkit::Float r = distance(a, b);
 
-    return scale * ((qa * qb * e) / r + 4.0 * epsilon * (pow(sigma / r, 12) - pow(sigma / r, 6)));
+    return scale * (qa * qb * e) / r;
 }
 
-std::vector<chemkit::Vector3> OplsNonbondedCalculation::gradient() const
+std::vector<chemkit::Vector3> OplsElectrostaticCalculation::gradient() const
 {
-    std::vector<chemkit::Vector3> gradient(2);
-
     const chemkit::ForceFieldAtom *a = atom(0);
     const chemkit::ForceFieldAtom *b = atom(1);
 
     chemkit::Float qa = parameter(0);
     chemkit::Float qb = parameter(1);
     chemkit::Float e = 332.06; // vacuum permitivity
-    chemkit::Float sigma = parameter(2);
-    chemkit::Float epsilon = parameter(3);
-    chemkit::Float scale = parameter(4);
+    chemkit::Float scale = parameter(2);
 
     chemkit::Float r = distance(a, b);
-    chemkit::Float sr = sigma / r;
 
     // dE/dr
-    chemkit::Float de_dr = scale * ((1.0 / pow(r, 3)) * (-qa * qb * e + -4.0 * epsilon * sigma * (12.0 * pow(sr, 11) - 6.0 * pow(sr, 5))));
+    chemkit::Float de_dr = -scale * (qa * qb * e) / pow(r, 2);
 
-    // dE/da
-    chemkit::Vector3 de_da = (a->position() - b->position()) * de_dr;
+    std::vector<chemkit::Vector3> gradient = distanceGradient(a, b);
 
-    gradient[0] = de_da;
-    gradient[1] = -de_da;
+    gradient[0] *= de_dr;
+    gradient[1] *= de_dr;
 
     return gradient;
 }
@@ -79,10 +79,20 @@ class OplsTorsionCalculation : public OplsCalculation
         std::vector<chemkit::Vector3> gradient() const;
 };
 
-class OplsNonbondedCalculation : public OplsCalculation
+class OplsVanDerWaalsCalculation : public OplsCalculation
 {
     public:
-        OplsNonbondedCalculation(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b);
+        OplsVanDerWaalsCalculation(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b);
+
+        bool setup(const OplsParameters *parameters);
+        chemkit::Float energy() const;
+        std::vector<chemkit::Vector3> gradient() const;
+};
+
+class OplsElectrostaticCalculation : public OplsCalculation
+{
+    public:
+        OplsElectrostaticCalculation(const chemkit::ForceFieldAtom *a, const chemkit::ForceFieldAtom *b);
 
         bool setup(const OplsParameters *parameters);
         chemkit::Float energy() const;
@@ -55,7 +55,8 @@ OplsForceField::OplsForceField()
 
     const chemkit::Plugin *oplsPlugin = chemkit::PluginManager::instance()->plugin("opls");
     if(oplsPlugin){
-        m_parameters = new OplsParameters(QString::fromStdString(oplsPlugin->dataPath()) + "oplsaa.prm");
+        addParameterSet("oplsaa", oplsPlugin->dataPath() + "oplsaa.prm");
+        setParameterSet("oplsaa");
     }
 }
 
@@ -67,11 +68,32 @@ OplsForceField::~OplsForceField()
 // --- Parameterization ---------------------------------------------------- //
 bool OplsForceField::setup()
 {
-    bool failed = false;
+    QString fileName = QString::fromStdString(parameterFile());
+
+    if(!m_parameters || m_parameters->fileName() != fileName){
+        delete m_parameters;
+        m_parameters = new OplsParameters;
+        if(!m_parameters->read(fileName)){
+            setErrorString(QString("Failed to load parameters: %1").arg(m_parameters->errorString()).toStdString());
+            delete m_parameters;
+            m_parameters = 0;
+        }
+    }
+
+    const std::vector<const chemkit::Molecule *> molecules = this->molecules();
 
-    foreach(const chemkit::Molecule *molecule, molecules()){
-        if(!setupMolecule(molecule)){
-            failed = true;
+    // type and enumerate the calculations for each molecule in parallel
+    std::vector<std::vector<chemkit::ForceFieldAtom *> > moleculeAtoms;
+    std::vector<std::vector<chemkit::ForceFieldCalculation *> > moleculeCalculations;
+    bool failed = !setupMolecules(molecules, moleculeAtoms, moleculeCalculations);
+
+    // add atoms and calculations in molecule order
+    for(unsigned int i = 0; i < molecules.size(); i++){
+        foreach(chemkit::ForceFieldAtom *atom, moleculeAtoms[i]){
+            addAtom(atom);
+        }
+        foreach(chemkit::ForceFieldCalculation *calculation, moleculeCalculations[i]){
+            addCalculation(calculation);
         }
     }
 
@@ -79,54 +101,62 @@ bool OplsForceField::setup()
         return false;
     }
 
-    foreach(chemkit::ForceFieldCalculation *calculation, calculations()){
-        bool setup = static_cast<OplsCalculation *>(calculation)->setup(m_parameters);
-
-        if(!setup){
-            failed = true;
-        }
-
-        setCalculationSetup(calculation, setup);
+    if(!setupCalculations(calculations())){
+        failed = true;
     }
 
     return !failed;
 }
 
-bool OplsForceField::setupMolecule(const chemkit::Molecule *molecule)
+// Creates the atoms and calculations for molecule. This is called
+// for several molecules at once from different threads and so only
+// modifies the atoms and calculations passed to it.
+bool OplsForceField::setupMolecule(const chemkit::Molecule *molecule,
+                                   std::vector<chemkit::ForceFieldAtom *> &atoms,
+                                   std::vector<chemkit::ForceFieldCalculation *> &calculations)
 {
     OplsAtomTyper typer(molecule);
 
     foreach(const chemkit::Atom *atom, molecule->atoms()){
         chemkit::ForceFieldAtom *forceFieldAtom = new chemkit::ForceFieldAtom(this, atom);
         forceFieldAtom->setType(typer.typeString(atom).c_str());
-        addAtom(forceFieldAtom);
+        if(m_parameters){
+            forceFieldAtom->setCharge(m_parameters->partialCharge(typer.typeNumber(atom)));
+        }
+        atoms.push_back(forceFieldAtom);
     }
 
-    chemkit::ForceFieldInteractions interactions(molecule, this);
+    chemkit::ForceFieldInteractions interactions(molecule, atoms);
 
     // bond strech pairs
     std::pair<const chemkit::ForceFieldAtom *, const chemkit::ForceFieldAtom *> bondedPair;
     foreach(bondedPair, interactions.bondedPairs()){
-        addCalculation(new OplsBondStrechCalculation(bondedPair.first, bondedPair.second));
+        calculations.push_back(new OplsBondStrechCalculation(bondedPair.first, bondedPair.second));
     }
 
     // angle bend groups
     std::vector<const chemkit::ForceFieldAtom *> angleGroup;
     foreach(angleGroup, interactions.angleGroups()){
-        addCalculation(new OplsAngleBendCalculation(angleGroup[0], angleGroup[1], angleGroup[2]));
+        calculations.push_back(new OplsAngleBendCalculation(angleGroup[0], angleGroup[1], angleGroup[2]));
     }
 
     // torsion groups
     std::vector<const chemkit::ForceFieldAtom *> torsionGroup;
     foreach(torsionGroup, interactions.torsionGroups()){
-        addCalculation(new OplsTorsionCalculation(torsionGroup[0], torsionGroup[1], torsionGroup[2], torsionGroup[3]));
+        calculations.push_back(new OplsTorsionCalculation(torsionGroup[0], torsionGroup[1], torsionGroup[2], torsionGroup[3]));
     }
 
     // nonbonded pairs
     std::pair<const chemkit::ForceFieldAtom *, const chemkit::ForceFieldAtom *> nonbondedPair;
     foreach(nonbondedPair, interactions.nonbondedPairs()){
-        addCalculation(new OplsNonbondedCalculation(nonbondedPair.first, nonbondedPair.second));
+        calculations.push_back(new OplsVanDerWaalsCalculation(nonbondedPair.first, nonbondedPair.second));
+        calculations.push_back(new OplsElectrostaticCalculation(nonbondedPair.first, nonbondedPair.second));
     }
 
     return true;
 }
+
+bool OplsForceField::setupCalculation(chemkit::ForceFieldCalculation *calculation)
+{
+    return static_cast<OplsCalculation *>(calculation)->setup(m_parameters);
+}
@@ -49,7 +49,12 @@ class OplsForceField : public chemkit::ForceField
 
         // parameterization
         bool setup();
-        bool setupMolecule(const chemkit::Molecule *molecule);
+
+    protected:
+        bool setupMolecule(const chemkit::Molecule *molecule,
+                           std::vector<chemkit::ForceFieldAtom *> &atoms,
+                           std::vector<chemkit::ForceFieldCalculation *> &calculations);
+        bool setupCalculation(chemkit::ForceFieldCalculation *calculation);
 
     private:
         OplsParameters *m_parameters;
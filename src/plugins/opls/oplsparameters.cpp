@@ -37,23 +37,88 @@
 
 #include <QtCore>
 
-// --- Construction and Destruction ---------------------------------------- //
-OplsParameters::OplsParameters(const QString &fileName)
-    : m_fileName(fileName)
+#include <vector>
+#include <algorithm>
+
+namespace {
+
+// Returns a hash key for the atom classes in a parameter.
+inline quint64 parameterKey(int a, int b, int c = 0, int d = 0)
 {
-    read(fileName);
+    return (quint64(quint16(a)) << 48) |
+           (quint64(quint16(b)) << 32) |
+           (quint64(quint16(c)) << 16) |
+            quint64(quint16(d));
 }
 
-OplsParameters::~OplsParameters()
+// Returns the key for a bond with the classes in canonical order.
+inline quint64 bondKey(int a, int b)
 {
+    if(a > b){
+        qSwap(a, b);
+    }
+
+    return parameterKey(a, b);
 }
 
-// --- Properties ---------------------------------------------------------- //
-void OplsParameters::setFileName(const QString &fileName)
+// Returns the key for an angle with the classes in canonical order.
+inline quint64 angleKey(int a, int b, int c)
 {
-    m_fileName = fileName;
+    if(a > c){
+        qSwap(a, c);
+    }
+
+    return parameterKey(a, b, c);
 }
 
+// Returns the key for a torsion with the classes in canonical order.
+// A torsion and its reverse (d, c, b, a) map to the same key.
+inline quint64 torsionKey(int a, int b, int c, int d)
+{
+    if(b > c || (b == c && a > d)){
+        qSwap(a, d);
+        qSwap(b, c);
+    }
+
+    return parameterKey(a, b, c, d);
+}
+
+// Orders parameter indices by key.
+bool indexLessThan(const OplsParameterIndex &a, const OplsParameterIndex &b)
+{
+    return a.key < b.key;
+}
+
+// Sorts the indices by key. When a key is listed more than once
+// only the first entry is kept.
+std::vector<OplsParameterIndex> sortIndices(std::vector<OplsParameterIndex> &indices)
+{
+    std::stable_sort(indices.begin(), indices.end(), indexLessThan);
+
+    std::vector<OplsParameterIndex> unique;
+    for(size_t i = 0; i < indices.size(); i++){
+        if(unique.empty() || unique.back().key != indices[i].key){
+            unique.push_back(indices[i]);
+        }
+    }
+
+    return unique;
+}
+
+} // end anonymous namespace
+
+// --- Construction and Destruction ---------------------------------------- //
+OplsParameters::OplsParameters()
+    : m_file("opls", BinaryVersion)
+{
+    setup();
+}
+
+OplsParameters::~OplsParameters()
+{
+}
+
+// --- Properties ---------------------------------------------------------- //
 QString OplsParameters::fileName() const
 {
     return m_fileName;
@@ -62,94 +127,156 @@ QString OplsParameters::fileName() const
 // --- Parameters ---------------------------------------------------------- //
 int OplsParameters::atomClass(int type) const
 {
-    return m_typeToClass.value(type);
+    const OplsAtomParameters *parameters = atomParameters(type);
+    if(!parameters){
+        return 0;
+    }
+
+    return parameters->atomClass;
 }
 
 QString OplsParameters::atomName(int type) const
 {
-    return m_typeToName.value(type);
+    const OplsAtomParameters *parameters = atomParameters(type);
+    if(!parameters){
+        return QString();
+    }
+
+    return QString::fromAscii(parameters->name);
 }
 
 chemkit::Float OplsParameters::partialCharge(int type) const
 {
-    return m_typeToCharge.value(type);
+    const OplsAtomParameters *parameters = atomParameters(type);
+    if(!parameters){
+        return 0;
+    }
+
+    return parameters->charge;
 }
 
 const OplsBondStrechParameters* OplsParameters::bondStrechParameters(int a, int b) const
 {
-    a = atomClass(a);
-    b = atomClass(b);
-
-    if(a > b){
-        qSwap(a, b);
+    int index = findIndex(m_bondStrechIndices, m_bondStrechIndicesCount, bondKey(atomClass(a), atomClass(b)));
+    if(index == -1){
+        return 0;
     }
 
-    foreach(const OplsBondStrechParameters &p, m_bondStrechParameters){
-        if(p.typeA == a && p.typeB == b){
-            return &p;
-        }
+    return &m_bondStrechParameters[index];
+}
+
+const OplsAngleBendParameters* OplsParameters::angleBendParameters(int a, int b, int c) const
+{
+    int index = findIndex(m_angleBendIndices, m_angleBendIndicesCount, angleKey(atomClass(a), atomClass(b), atomClass(c)));
+    if(index == -1){
+        return 0;
     }
 
-    return 0;
+    return &m_angleBendParameters[index];
 }
 
-const OplsAngleBendParameters* OplsParameters::angleBendParameters(int a, int b, int c) const
+const OplsTorsionParameters* OplsParameters::torsionParameters(int a, int b, int c, int d) const
 {
     a = atomClass(a);
     b = atomClass(b);
     c = atomClass(c);
+    d = atomClass(d);
 
-    if(a > c){
-        qSwap(a, c);
-    }
-
-    foreach(const OplsAngleBendParameters &p, m_angleBendParameters){
-        if(p.typeA == a && p.typeB == b && p.typeC == c){
-            return &p;
+    // try the exact classes first and then fall back to the
+    // parameters with class zero (wildcard) for the terminal atoms
+    const quint64 keys[] = {
+        torsionKey(a, b, c, d),
+        torsionKey(0, b, c, d),
+        torsionKey(a, b, c, 0),
+        torsionKey(0, b, c, 0)
+    };
+
+    for(int i = 0; i < 4; i++){
+        int index = findIndex(m_torsionIndices, m_torsionIndicesCount, keys[i]);
+        if(index != -1){
+            return &m_torsionParameters[index];
         }
     }
 
     return 0;
 }
 
-const OplsTorsionParameters* OplsParameters::torsionParameters(int a, int b, int c, int d) const
+const OplsVanDerWaalsParameters* OplsParameters::vanDerWaalsParameters(int type) const
 {
-    a = atomClass(a);
-    b = atomClass(b);
-    c = atomClass(c);
-    d = atomClass(d);
+    if(type < 0 || type >= m_vanDerWaalsParametersCount){
+        return 0;
+    }
 
-    if(b > c){
-        qSwap(b, c);
+    return &m_vanDerWaalsParameters[type];
+}
+
+// --- Input and Output ---------------------------------------------------- //
+/// Reads the parameters from \p fileName. The file may either be
+/// a text parameters file or a binary parameters file. Text files
+/// are compiled to a binary file in the parameter cache directory
+/// on first use and subsequent reads map the cached file directly.
+bool OplsParameters::read(const QString &fileName)
+{
+    m_fileName = fileName;
+    m_file.close();
+
+    if(chemkit::BinaryParameterFile::isBinaryParameterFile(fileName.toStdString())){
+        if(!m_file.open(fileName.toStdString())){
+            setErrorString(QString::fromStdString(m_file.errorString()));
+            setup();
+            return false;
+        }
+
+        return setup();
     }
 
-    if(a > d){
-        qSwap(a, d);
+    // try the compiled version of the text file
+    std::string cacheFileName = chemkit::BinaryParameterFile::cacheFileName(fileName.toStdString());
+    if(m_file.open(cacheFileName) && m_file.isCurrent(fileName.toStdString()) && setup()){
+        return true;
     }
 
-    foreach(const OplsTorsionParameters &p, m_torsionParameters){
-        if(p.typeA == a && p.typeB == b && p.typeC == c && p.typeD == d){
-            return &p;
-        }
+    m_file.close();
+
+    if(!readText(fileName)){
+        setup();
+        return false;
     }
 
-    return 0;
+    // failing to write the cache is not an error
+    m_file.setSourceFile(fileName.toStdString());
+    m_file.write(cacheFileName);
+
+    return setup();
 }
 
-const OplsVanDerWaalsParameters* OplsParameters::vanDerWaalsParameters(int type) const
+// --- Error Handling ------------------------------------------------------ //
+void OplsParameters::setErrorString(const QString &errorString)
 {
-    return &m_vanDerWaalsParameters[type];
+    m_errorString = errorString;
+}
+
+QString OplsParameters::errorString() const
+{
+    return m_errorString;
 }
 
 // --- Internal Methods ---------------------------------------------------- //
-bool OplsParameters::read(const QString &fileName)
+bool OplsParameters::readText(const QString &fileName)
 {
     QFile file(fileName);
     bool ok = file.open(QFile::ReadOnly);
     if(!ok){
+        setErrorString(file.errorString());
         return false;
     }
 
+    std::vector<OplsAtomParameters> atomParameters;
+    std::vector<OplsBondStrechParameters> bondStrechParameters;
+    std::vector<OplsAngleBendParameters> angleBendParameters;
+    std::vector<OplsTorsionParameters> torsionParameters;
+    std::vector<OplsVanDerWaalsParameters> vanDerWaalsParameters;
+
     while(!file.atEnd()){
         QByteArray line = file.readLine();
 
@@ -162,16 +289,17 @@ bool OplsParameters::read(const QString &fileName)
             }
 
             int type = lineItems[1].toInt();
-            int klass = lineItems[2].toInt();
-            QString name = lineItems[3];
+            if(type < 0){
+                continue;
+            }
 
-            if(m_typeToClass.size() < type + 1)
-                m_typeToClass.resize(type + 1);
-            m_typeToClass[type] = klass;
+            if(atomParameters.size() < size_t(type + 1)){
+                atomParameters.resize(type + 1, OplsAtomParameters());
+            }
 
-            if(m_typeToName.size() < type + 1)
-                m_typeToName.resize(type + 1);
-            m_typeToName[type] = name;
+            OplsAtomParameters &p = atomParameters[type];
+            p.atomClass = lineItems[2].toInt();
+            qstrncpy(p.name, lineItems[3].toAscii().constData(), sizeof(p.name));
         }
         // bond parameters
         else if(line.startsWith("bond")){
@@ -181,13 +309,13 @@ bool OplsParameters::read(const QString &fileName)
                 continue;
             }
 
-            OplsBondStrechParameters p;
+            OplsBondStrechParameters p = OplsBondStrechParameters();
             p.typeA = lineItems[1].toInt();
             p.typeB = lineItems[2].toInt();
             p.kb = lineItems[3].toDouble();
             p.r0 = lineItems[4].toDouble();
 
-            m_bondStrechParameters.append(p);
+            bondStrechParameters.push_back(p);
         }
         // angle parameters
         else if(line.startsWith("angle")){
@@ -197,14 +325,14 @@ bool OplsParameters::read(const QString &fileName)
                 continue;
             }
 
-            OplsAngleBendParameters p;
+            OplsAngleBendParameters p = OplsAngleBendParameters();
             p.typeA = lineItems[1].toInt();
             p.typeB = lineItems[2].toInt();
             p.typeC = lineItems[3].toInt();
             p.ka = lineItems[4].toDouble();
             p.theta0 = lineItems[5].toDouble();
 
-            m_angleBendParameters.append(p);
+            angleBendParameters.push_back(p);
         }
         // torsion parameters
         else if(line.startsWith("torsion")){
@@ -214,7 +342,7 @@ bool OplsParameters::read(const QString &fileName)
                 continue;
             }
 
-            OplsTorsionParameters p;
+            OplsTorsionParameters p = OplsTorsionParameters();
             p.typeA = lineItems[1].toInt();
             p.typeB = lineItems[2].toInt();
             p.typeC = lineItems[3].toInt();
@@ -223,7 +351,7 @@ bool OplsParameters::read(const QString &fileName)
             p.v2 = lineItems[8].toDouble();
             p.v3 = lineItems[11].toDouble();
 
-            m_torsionParameters.append(p);
+            torsionParameters.push_back(p);
         }
         // van der waals parameters
         else if(line.startsWith("vdw")){
@@ -234,14 +362,17 @@ bool OplsParameters::read(const QString &fileName)
             }
 
             int type = lineItems[1].toInt();
-            if(m_vanDerWaalsParameters.size() < type + 1)
-                m_vanDerWaalsParameters.resize(type + 1);
+            if(type < 0){
+                continue;
+            }
+
+            if(vanDerWaalsParameters.size() < size_t(type + 1)){
+                vanDerWaalsParameters.resize(type + 1, OplsVanDerWaalsParameters());
+            }
 
-            OplsVanDerWaalsParameters p;
+            OplsVanDerWaalsParameters &p = vanDerWaalsParameters[type];
             p.sigma = lineItems[2].toDouble();
             p.epsilon = lineItems[3].toDouble();
-
-            m_vanDerWaalsParameters[type] = p;
         }
         else if(line.startsWith("charge")){
             QStringList lineItems = QString(line).split(' ', QString::SkipEmptyParts);
@@ -251,14 +382,102 @@ bool OplsParameters::read(const QString &fileName)
             }
 
             int type = lineItems[1].toInt();
+            if(type < 0){
+                continue;
+            }
 
-            if(m_typeToCharge.size() < type + 1){
-                m_typeToCharge.resize(type + 1);
+            if(atomParameters.size() < size_t(type + 1)){
+                atomParameters.resize(type + 1, OplsAtomParameters());
             }
 
-            m_typeToCharge[type] = lineItems[2].toDouble();
+            atomParameters[type].charge = lineItems[2].toDouble();
         }
     }
 
+    // build the sorted indices mapping the canonical atom classes
+    // for each bond, angle and torsion to its parameters
+    std::vector<OplsParameterIndex> bondStrechIndices;
+    for(size_t i = 0; i < bondStrechParameters.size(); i++){
+        const OplsBondStrechParameters &p = bondStrechParameters[i];
+
+        OplsParameterIndex index = OplsParameterIndex();
+        index.key = bondKey(p.typeA, p.typeB);
+        index.index = i;
+        bondStrechIndices.push_back(index);
+    }
+
+    std::vector<OplsParameterIndex> angleBendIndices;
+    for(size_t i = 0; i < angleBendParameters.size(); i++){
+        const OplsAngleBendParameters &p = angleBendParameters[i];
+
+        OplsParameterIndex index = OplsParameterIndex();
+        index.key = angleKey(p.typeA, p.typeB, p.typeC);
+        index.index = i;
+        angleBendIndices.push_back(index);
+    }
+
+    std::vector<OplsParameterIndex> torsionIndices;
+    for(size_t i = 0; i < torsionParameters.size(); i++){
+        const OplsTorsionParameters &p = torsionParameters[i];
+
+        OplsParameterIndex index = OplsParameterIndex();
+        index.key = torsionKey(p.typeA, p.typeB, p.typeC, p.typeD);
+        index.index = i;
+        torsionIndices.push_back(index);
+    }
+
+    // sections must be added in the same order as the Section enum
+    m_file.addSection(atomParameters);
+    m_file.addSection(bondStrechParameters);
+    m_file.addSection(angleBendParameters);
+    m_file.addSection(torsionParameters);
+    m_file.addSection(vanDerWaalsParameters);
+    m_file.addSection(sortIndices(bondStrechIndices));
+    m_file.addSection(sortIndices(angleBendIndices));
+    m_file.addSection(sortIndices(torsionIndices));
+
     return true;
 }
+
+// Points the parameter arrays at the sections in the parameter
+// file. Returns false if the file does not contain all of the
+// sections.
+bool OplsParameters::setup()
+{
+    int unused = 0;
+
+    m_atomParameters = m_file.section<OplsAtomParameters>(Atoms, &m_atomParametersCount);
+    m_bondStrechParameters = m_file.section<OplsBondStrechParameters>(BondStrech, &unused);
+    m_angleBendParameters = m_file.section<OplsAngleBendParameters>(AngleBend, &unused);
+    m_torsionParameters = m_file.section<OplsTorsionParameters>(Torsion, &unused);
+    m_vanDerWaalsParameters = m_file.section<OplsVanDerWaalsParameters>(VanDerWaals, &m_vanDerWaalsParametersCount);
+    m_bondStrechIndices = m_file.section<OplsParameterIndex>(BondStrechIndices, &m_bondStrechIndicesCount);
+    m_angleBendIndices = m_file.section<OplsParameterIndex>(AngleBendIndices, &m_angleBendIndicesCount);
+    m_torsionIndices = m_file.section<OplsParameterIndex>(TorsionIndices, &m_torsionIndicesCount);
+
+    return m_file.sectionCount() == SectionCount;
+}
+
+const OplsAtomParameters* OplsParameters::atomParameters(int type) const
+{
+    if(type < 0 || type >= m_atomParametersCount){
+        return 0;
+    }
+
+    return &m_atomParameters[type];
+}
+
+// Returns the parameter index for key or -1 if the key is not found.
+int OplsParameters::findIndex(const OplsParameterIndex *indices, int count, quint64 key) const
+{
+    OplsParameterIndex value;
+    value.key = key;
+
+    const OplsParameterIndex *end = indices + count;
+    const OplsParameterIndex *location = std::lower_bound(indices, end, value, indexLessThan);
+    if(location == end || location->key != key){
+        return -1;
+    }
+
+    return location->index;
+}
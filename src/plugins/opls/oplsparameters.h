@@ -40,6 +40,7 @@
 
 #include <chemkit/chemkit.h>
 #include <chemkit/forcefieldatom.h>
+#include <chemkit/binaryparameterfile.h>
 
 struct OplsBondStrechParameters
 {
@@ -75,15 +76,27 @@ struct OplsVanDerWaalsParameters
     chemkit::Float epsilon;
 };
 
+struct OplsAtomParameters
+{
+    int atomClass;
+    char name[8];
+    chemkit::Float charge;
+};
+
+struct OplsParameterIndex
+{
+    quint64 key;
+    int index;
+};
+
 class OplsParameters
 {
     public:
         // construction and destruction
-        OplsParameters(const QString &fileName);
+        OplsParameters();
         ~OplsParameters();
 
         // properties
-        void setFileName(const QString &fileName);
         QString fileName() const;
 
         // parameters
@@ -95,18 +108,52 @@ class OplsParameters
         const OplsTorsionParameters* torsionParameters(int a, int b, int c, int d) const;
         const OplsVanDerWaalsParameters* vanDerWaalsParameters(int type) const;
 
-    private:
+        // input and output
         bool read(const QString &fileName);
 
+        // error handling
+        QString errorString() const;
+
+        // constants
+        const static int BinaryVersion = 1;
+
     private:
+        bool readText(const QString &fileName);
+        bool setup();
+        const OplsAtomParameters* atomParameters(int type) const;
+        int findIndex(const OplsParameterIndex *indices, int count, quint64 key) const;
+        void setErrorString(const QString &errorString);
+
+    private:
+        // sections in the binary parameter file
+        enum Section {
+            Atoms,
+            BondStrech,
+            AngleBend,
+            Torsion,
+            VanDerWaals,
+            BondStrechIndices,
+            AngleBendIndices,
+            TorsionIndices,
+            SectionCount
+        };
+
         QString m_fileName;
-        QVector<int> m_typeToClass;
-        QVector<QString> m_typeToName;
-        QVector<OplsBondStrechParameters> m_bondStrechParameters;
-        QVector<OplsAngleBendParameters> m_angleBendParameters;
-        QVector<OplsTorsionParameters> m_torsionParameters;
-        QVector<OplsVanDerWaalsParameters> m_vanDerWaalsParameters;
-        QVector<chemkit::Float> m_typeToCharge;
+        QString m_errorString;
+        chemkit::BinaryParameterFile m_file;
+        const OplsAtomParameters *m_atomParameters;
+        int m_atomParametersCount;
+        const OplsBondStrechParameters *m_bondStrechParameters;
+        const OplsAngleBendParameters *m_angleBendParameters;
+        const OplsTorsionParameters *m_torsionParameters;
+        const OplsVanDerWaalsParameters *m_vanDerWaalsParameters;
+        int m_vanDerWaalsParametersCount;
+        const OplsParameterIndex *m_bondStrechIndices;
+        int m_bondStrechIndicesCount;
+        const OplsParameterIndex *m_angleBendIndices;
+        int m_angleBendIndicesCount;
+        const OplsParameterIndex *m_torsionIndices;
+        int m_torsionIndicesCount;
 };
 
 #endif // OPLSPARAMETERS_H
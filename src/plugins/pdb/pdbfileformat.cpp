@@ -63,9 +63,10 @@ PdbAtom::PdbAtom(const char *data)
     // atom id
     sscanf(&data[5], "%d", &id);
 
-    // atom name
+    // atom name (columns 13-16, four character names such
+    // as HD21 start in column 13)
     name.clear();
-    for(int i = 13; i < 16; i++){
+    for(int i = 12; i < 16; i++){
         name += data[i];
     }
     name = name.trimmed();
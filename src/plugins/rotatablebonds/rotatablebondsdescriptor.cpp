@@ -35,7 +35,6 @@
 
 #include "rotatablebondsdescriptor.h"
 
-#include <chemkit/atom.h>
 #include <chemkit/bond.h>
 #include <chemkit/molecule.h>
 
@@ -53,23 +52,10 @@ QVariant RotatableBondsDescriptor::value(const chemkit::Molecule *molecule) cons
     int count = 0;
 
     foreach(const chemkit::Bond *bond, molecule->bonds()){
-        if(!bond->order() == chemkit::Bond::Single){
-            continue;
+        if(bond->isRotatable()){
+            count++;
         }
-        else if(heavyNeighborCount(bond->atom1()) < 2 || heavyNeighborCount(bond->atom2()) < 2){
-            continue;
-        }
-        else if(bond->isInRing()){
-            continue;
-        }
-
-        count++;
     }
 
     return count;
 }
-
-int RotatableBondsDescriptor::heavyNeighborCount(const chemkit::Atom *atom) const
-{
-    return atom->neighborCount() - atom->neighborCount(chemkit::Atom::Hydrogen);
-}
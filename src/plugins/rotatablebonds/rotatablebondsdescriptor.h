@@ -46,9 +46,6 @@ class RotatableBondsDescriptor : public chemkit::MolecularDescriptor
 		~RotatableBondsDescriptor();
 
 		QVariant value(const chemkit::Molecule *molecule) const;
-
-    private:
-        int heavyNeighborCount(const chemkit::Atom *atom) const;
 };
 
 #endif // ROTATABLEBONDSDESCRIPTOR_H
@@ -149,6 +149,24 @@ std::vector<chemkit::Vector3> UffBondStrechCalculation::gradient() const
     return gradient;
 }
 
+chemkit::Matrix UffBondStrechCalculation::hessian() const
+{
+    const chemkit::ForceFieldAtom *a = atom(0);
+    const chemkit::ForceFieldAtom *b = atom(1);
+
+    chemkit::Float kb = parameter(0);
+    chemkit::Float r0 = parameter(1);
+    chemkit::Float r = distance(a, b);
+
+    // dE/dr
+    chemkit::Float de_dr = kb * (r - r0);
+
+    // d2E/dr2
+    chemkit::Float d2e_dr2 = kb;
+
+    return distanceHessian(a, b, de_dr, d2e_dr2);
+}
+
 // === UffAngleBendCalculation ============================================= //
 UffAngleBendCalculation::UffAngleBendCalculation(const chemkit::ForceFieldAtom *a,
                                                  const chemkit::ForceFieldAtom *b,
@@ -243,6 +261,27 @@ std::vector<chemkit::Vector3> UffAngleBendCalculation::gradient() const
     return gradient;
 }
 
+chemkit::Matrix UffAngleBendCalculation::hessian() const
+{
+    const chemkit::ForceFieldAtom *a = atom(0);
+    const chemkit::ForceFieldAtom *b = atom(1);
+    const chemkit::ForceFieldAtom *c = atom(2);
+
+    chemkit::Float ka = parameter(0);
+    chemkit::Float c1 = parameter(2);
+    chemkit::Float c2 = parameter(3);
+
+    chemkit::Float theta = bondAngleRadians(a, b, c);
+
+    // dE/dtheta
+    chemkit::Float de_dtheta = -ka * (c1 * sin(theta) + 2 * c2 * sin(2 * theta));
+
+    // d2E/dtheta2
+    chemkit::Float d2e_dtheta2 = -ka * (c1 * cos(theta) + 4 * c2 * cos(2 * theta));
+
+    return bondAngleHessianRadians(a, b, c, de_dtheta, d2e_dtheta2);
+}
+
 // === UffTorsionCalculation =============================================== //
 UffTorsionCalculation::UffTorsionCalculation(const chemkit::ForceFieldAtom *a,
                                              const chemkit::ForceFieldAtom *b,
@@ -544,6 +583,24 @@ std::vector<chemkit::Vector3> UffVanDerWaalsCalculation::gradient() const
     return gradient;
 }
 
+chemkit::Matrix UffVanDerWaalsCalculation::hessian() const
+{
+    const chemkit::ForceFieldAtom *a = atom(0);
+    const chemkit::ForceFieldAtom *b = atom(1);
+
+    chemkit::Float d = parameter(0);
+    chemkit::Float x = parameter(1);
+    chemkit::Float r = distance(a, b);
+
+    // dE/dr
+    chemkit::Float de_dr = -12 * d * x / pow(r, 2) * (pow(x/r, 11) - pow(x/r, 5));
+
+    // d2E/dr2
+    chemkit::Float d2e_dr2 = d / pow(r, 2) * (156 * pow(x/r, 12) - 84 * pow(x/r, 6));
+
+    return distanceHessian(a, b, de_dr, d2e_dr2);
+}
+
 // === UffElectrostaticCalculation ========================================= //
 UffElectrostaticCalculation::UffElectrostaticCalculation(const chemkit::ForceFieldAtom *a,
                                                          const chemkit::ForceFieldAtom *b)
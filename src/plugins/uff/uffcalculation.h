@@ -61,6 +61,7 @@ class UffBondStrechCalculation : public UffCalculation
         bool setup();
         chemkit::Float energy() const;
         std::vector<chemkit::Vector3> gradient() const;
+        chemkit::Matrix hessian() const;
 };
 
 class UffAngleBendCalculation : public UffCalculation
@@ -71,6 +72,7 @@ class UffAngleBendCalculation : public UffCalculation
         bool setup();
         chemkit::Float energy() const;
         std::vector<chemkit::Vector3> gradient() const;
+        chemkit::Matrix hessian() const;
 };
 
 class UffTorsionCalculation : public UffCalculation
@@ -101,6 +103,7 @@ class UffVanDerWaalsCalculation : public UffCalculation
         bool setup();
         chemkit::Float energy() const;
         std::vector<chemkit::Vector3> gradient() const;
+        chemkit::Matrix hessian() const;
 };
 
 class UffElectrostaticCalculation : public UffCalculation
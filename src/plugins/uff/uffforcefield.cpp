@@ -45,6 +45,8 @@
 #include "uffparameters.h"
 #include "uffcalculation.h"
 
+#include <map>
+
 #include <chemkit/atom.h>
 #include <chemkit/molecule.h>
 #include <chemkit/forcefieldinteractions.h>
@@ -70,94 +72,246 @@ const UffParameters* UffForceField::parameters() const
 }
 
 // --- Setup --------------------------------------------------------------- //
-bool UffForceField::setup()
+namespace {
+
+// The TopologyTemplate struct stores the index of the first atom
+// and the range of calculations added for a molecule which is
+// used as the template for other molecules with the same topology.
+struct TopologyTemplate
 {
-    foreach(const chemkit::Molecule *molecule, molecules()){
-        QHash<const chemkit::Atom *, chemkit::ForceFieldAtom *> atoms;
+    int firstAtom;
+    int firstCalculation;
+    int lastCalculation;
+};
 
-        UffAtomTyper typer(molecule);
+} // end anonymous namespace
 
-        foreach(const chemkit::Atom *atom, molecule->atoms()){
-            chemkit::ForceFieldAtom *forceFieldAtom = new chemkit::ForceFieldAtom(this, atom);
-            atoms[atom] = forceFieldAtom;
-            addAtom(forceFieldAtom);
-            forceFieldAtom->setType(typer.typeString(atom).c_str());
+bool UffForceField::setup()
+{
+    const std::vector<const chemkit::Molecule *> molecules = this->molecules();
+    const std::vector<const chemkit::Molecule *> templates = topologyTemplates();
+
+    // type and enumerate the calculations for each template molecule
+    // in parallel. copies of a template are skipped here and filled
+    // in from the template below
+    std::vector<const chemkit::Molecule *> templateMolecules(molecules.size(), 0);
+    for(unsigned int i = 0; i < molecules.size(); i++){
+        if(templates[i] == molecules[i]){
+            templateMolecules[i] = molecules[i];
         }
+    }
 
-        chemkit::ForceFieldInteractions interactions(molecule, this);
+    std::vector<std::vector<chemkit::ForceFieldAtom *> > moleculeAtoms;
+    std::vector<std::vector<chemkit::ForceFieldCalculation *> > moleculeCalculations;
+    bool ok = setupMolecules(templateMolecules, moleculeAtoms, moleculeCalculations);
 
-        // bond strech
-        std::pair<const chemkit::ForceFieldAtom *, const chemkit::ForceFieldAtom *> bondedPair;
-        foreach(bondedPair, interactions.bondedPairs()){
-            addCalculation(new UffBondStrechCalculation(bondedPair.first,
-                                                        bondedPair.second));
-        }
+    std::map<const chemkit::Molecule *, TopologyTemplate> topologyTemplates;
 
-        // angle bend
-        std::vector<const chemkit::ForceFieldAtom *> angleGroup;
-        foreach(angleGroup, interactions.angleGroups()){
-            addCalculation(new UffAngleBendCalculation(angleGroup[0],
-                                                       angleGroup[1],
-                                                       angleGroup[2]));
-        }
+    // pairs of (copy, template) calculation indices
+    std::vector<std::pair<int, int> > copiedCalculations;
 
-        // torsion
-        std::vector<const chemkit::ForceFieldAtom *> torsionGroup;
-        foreach(torsionGroup, interactions.torsionGroups()){
-            addCalculation(new UffTorsionCalculation(torsionGroup[0],
-                                                     torsionGroup[1],
-                                                     torsionGroup[2],
-                                                     torsionGroup[3]));
-        }
+    // calculations of the template molecules
+    std::vector<chemkit::ForceFieldCalculation *> templateCalculations;
+
+    // add atoms and calculations in molecule order
+    for(unsigned int i = 0; i < molecules.size(); i++){
+        const chemkit::Molecule *molecule = molecules[i];
 
-        // inversion
-        foreach(const chemkit::Atom *atom, molecule->atoms()){
-            if(atom->neighborCount() == 3 && (atom->is(chemkit::Atom::Carbon) ||
-                                              atom->is(chemkit::Atom::Nitrogen) ||
-                                              atom->is(chemkit::Atom::Phosphorus) ||
-                                              atom->is(chemkit::Atom::Arsenic) ||
-                                              atom->is(chemkit::Atom::Antimony) ||
-                                              atom->is(chemkit::Atom::Bismuth))){
-                const std::vector<chemkit::Atom *> &neighbors = atom->neighbors();
-
-                addCalculation(new UffInversionCalculation(atoms[neighbors[0]],
-                                                           atoms[atom],
-                                                           atoms[neighbors[1]],
-                                                           atoms[neighbors[2]]));
-                addCalculation(new UffInversionCalculation(atoms[neighbors[0]],
-                                                           atoms[atom],
-                                                           atoms[neighbors[2]],
-                                                           atoms[neighbors[1]]));
-                addCalculation(new UffInversionCalculation(atoms[neighbors[1]],
-                                                           atoms[atom],
-                                                           atoms[neighbors[2]],
-                                                           atoms[neighbors[0]]));
+        if(templateMolecules[i]){
+            TopologyTemplate &topologyTemplate = topologyTemplates[molecule];
+            topologyTemplate.firstAtom = atomCount();
+            topologyTemplate.firstCalculation = calculationCount();
+
+            foreach(chemkit::ForceFieldAtom *atom, moleculeAtoms[i]){
+                addAtom(atom);
+            }
+            foreach(chemkit::ForceFieldCalculation *calculation, moleculeCalculations[i]){
+                addCalculation(calculation);
+                templateCalculations.push_back(calculation);
             }
+
+            topologyTemplate.lastCalculation = calculationCount();
+            continue;
         }
 
-        // van der waals
-        std::pair<const chemkit::ForceFieldAtom *, const chemkit::ForceFieldAtom *> nonbondedPair;
-        foreach(nonbondedPair, interactions.nonbondedPairs()){
-            addCalculation(new UffVanDerWaalsCalculation(nonbondedPair.first,
-                                                         nonbondedPair.second));
+        // copy atom types and calculations from the template molecule
+        const TopologyTemplate &topologyTemplate = topologyTemplates[templates[i]];
+
+        std::vector<const chemkit::ForceFieldAtom *> atoms;
+        atoms.reserve(molecule->atomCount());
+
+        for(int j = 0; j < molecule->atomCount(); j++){
+            const chemkit::ForceFieldAtom *templateAtom = this->atom(topologyTemplate.firstAtom + j);
+
+            chemkit::ForceFieldAtom *forceFieldAtom = new chemkit::ForceFieldAtom(this, molecule->atom(j));
+            addAtom(forceFieldAtom);
+            forceFieldAtom->setType(templateAtom->type());
+            atoms.push_back(forceFieldAtom);
+        }
+
+        for(int j = topologyTemplate.firstCalculation; j < topologyTemplate.lastCalculation; j++){
+            copiedCalculations.push_back(std::make_pair(calculationCount(), j));
+            addCalculation(copyCalculation(calculation(j), topologyTemplate.firstAtom, atoms));
         }
     }
 
-    bool ok = true;
+    if(!setupCalculations(templateCalculations)){
+        ok = false;
+    }
 
-    foreach(chemkit::ForceFieldCalculation *calculation, calculations()){
-        bool setup = static_cast<UffCalculation *>(calculation)->setup();
+    // copy parameters from the template calculations
+    for(unsigned int i = 0; i < copiedCalculations.size(); i++){
+        chemkit::ForceFieldCalculation *calculation = this->calculation(copiedCalculations[i].first);
+        const chemkit::ForceFieldCalculation *templateCalculation = this->calculation(copiedCalculations[i].second);
 
-        if(!setup){
-            ok = false;
+        for(int j = 0; j < templateCalculation->parameterCount(); j++){
+            calculation->setParameter(j, templateCalculation->parameter(j));
         }
 
-        setCalculationSetup(calculation, setup);
+        setCalculationSetup(calculation, templateCalculation->isSetup());
     }
 
     return ok;
 }
 
+// Creates the atoms and calculations for molecule. This is called
+// for several molecules at once from different threads and so only
+// modifies the atoms and calculations passed to it.
+bool UffForceField::setupMolecule(const chemkit::Molecule *molecule,
+                                  std::vector<chemkit::ForceFieldAtom *> &atoms,
+                                  std::vector<chemkit::ForceFieldCalculation *> &calculations)
+{
+    QHash<const chemkit::Atom *, chemkit::ForceFieldAtom *> forceFieldAtoms;
+    UffAtomTyper typer(molecule);
+
+    atoms.reserve(molecule->atomCount());
+    foreach(const chemkit::Atom *atom, molecule->atoms()){
+        chemkit::ForceFieldAtom *forceFieldAtom = new chemkit::ForceFieldAtom(this, atom);
+        forceFieldAtoms[atom] = forceFieldAtom;
+        forceFieldAtom->setType(typer.typeString(atom).c_str());
+        atoms.push_back(forceFieldAtom);
+    }
+
+    chemkit::ForceFieldInteractions interactions(molecule, atoms);
+
+    // bond strech
+    std::pair<const chemkit::ForceFieldAtom *, const chemkit::ForceFieldAtom *> bondedPair;
+    foreach(bondedPair, interactions.bondedPairs()){
+        calculations.push_back(new UffBondStrechCalculation(bondedPair.first,
+                                                            bondedPair.second));
+    }
+
+    // angle bend
+    std::vector<const chemkit::ForceFieldAtom *> angleGroup;
+    foreach(angleGroup, interactions.angleGroups()){
+        calculations.push_back(new UffAngleBendCalculation(angleGroup[0],
+                                                           angleGroup[1],
+                                                           angleGroup[2]));
+    }
+
+    // torsion
+    std::vector<const chemkit::ForceFieldAtom *> torsionGroup;
+    foreach(torsionGroup, interactions.torsionGroups()){
+        calculations.push_back(new UffTorsionCalculation(torsionGroup[0],
+                                                         torsionGroup[1],
+                                                         torsionGroup[2],
+                                                         torsionGroup[3]));
+    }
+
+    // inversion
+    foreach(const chemkit::Atom *atom, molecule->atoms()){
+        if(atom->neighborCount() == 3 && (atom->is(chemkit::Atom::Carbon) ||
+                                          atom->is(chemkit::Atom::Nitrogen) ||
+                                          atom->is(chemkit::Atom::Phosphorus) ||
+                                          atom->is(chemkit::Atom::Arsenic) ||
+                                          atom->is(chemkit::Atom::Antimony) ||
+                                          atom->is(chemkit::Atom::Bismuth))){
+            const std::vector<chemkit::Atom *> &neighbors = atom->neighbors();
+            calculations.push_back(new UffInversionCalculation(forceFieldAtoms[neighbors[0]],
+                                                               forceFieldAtoms[atom],
+                                                               forceFieldAtoms[neighbors[1]],
+                                                               forceFieldAtoms[neighbors[2]]));
+            calculations.push_back(new UffInversionCalculation(forceFieldAtoms[neighbors[0]],
+                                                               forceFieldAtoms[atom],
+                                                               forceFieldAtoms[neighbors[2]],
+                                                               forceFieldAtoms[neighbors[1]]));
+            calculations.push_back(new UffInversionCalculation(forceFieldAtoms[neighbors[1]],
+                                                               forceFieldAtoms[atom],
+                                                               forceFieldAtoms[neighbors[2]],
+                                                               forceFieldAtoms[neighbors[0]]));
+        }
+    }
+
+    // van der waals
+    std::pair<const chemkit::ForceFieldAtom *, const chemkit::ForceFieldAtom *> nonbondedPair;
+    foreach(nonbondedPair, interactions.nonbondedPairs()){
+        calculations.push_back(new UffVanDerWaalsCalculation(nonbondedPair.first,
+                                                             nonbondedPair.second));
+    }
+
+    return true;
+}
+
+bool UffForceField::setupCalculation(chemkit::ForceFieldCalculation *calculation)
+{
+    return static_cast<UffCalculation *>(calculation)->setup();
+}
+
+// Returns a new calculation of the same type as calculation which
+// acts on the atoms in atoms at the same molecule indices. The atoms
+// of the template molecule start at firstAtom in the force field.
+UffCalculation* UffForceField::copyCalculation(const chemkit::ForceFieldCalculation *calculation,
+                                               int firstAtom,
+                                               const std::vector<const chemkit::ForceFieldAtom *> &atoms) const
+{
+    std::vector<const chemkit::ForceFieldAtom *> a(calculation->atomCount());
+    for(int i = 0; i < calculation->atomCount(); i++){
+        a[i] = atoms[calculation->atom(i)->index() - firstAtom];
+    }
+
+    switch(calculation->type()){
+        case chemkit::ForceFieldCalculation::BondStrech:
+            return new UffBondStrechCalculation(a[0], a[1]);
+        case chemkit::ForceFieldCalculation::AngleBend:
+            return new UffAngleBendCalculation(a[0], a[1], a[2]);
+        case chemkit::ForceFieldCalculation::Torsion:
+            return new UffTorsionCalculation(a[0], a[1], a[2], a[3]);
+        case chemkit::ForceFieldCalculation::Inversion:
+            return new UffInversionCalculation(a[0], a[1], a[2], a[3]);
+        case chemkit::ForceFieldCalculation::VanDerWaals:
+            return new UffVanDerWaalsCalculation(a[0], a[1]);
+        case chemkit::ForceFieldCalculation::Electrostatic:
+            return new UffElectrostaticCalculation(a[0], a[1]);
+        default:
+            return 0;
+    }
+}
+
+chemkit::ForceFieldCalculation* UffForceField::createPairCalculation(chemkit::ForceFieldCalculation::Type type,
+                                                                    const chemkit::ForceFieldAtom *a,
+                                                                    const chemkit::ForceFieldAtom *b) const
+{
+    UffCalculation *calculation;
+
+    switch(type){
+        case chemkit::ForceFieldCalculation::VanDerWaals:
+            calculation = new UffVanDerWaalsCalculation(a, b);
+            break;
+        case chemkit::ForceFieldCalculation::Electrostatic:
+            calculation = new UffElectrostaticCalculation(a, b);
+            break;
+        default:
+            return 0;
+    }
+
+    if(!calculation->setup()){
+        delete calculation;
+        return 0;
+    }
+
+    return calculation;
+}
+
 bool UffForceField::isGroupSix(const chemkit::ForceFieldAtom *atom) const
 {
     switch(atom->atom()->atomicNumber()){
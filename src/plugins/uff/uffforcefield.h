@@ -40,6 +40,7 @@
 #include <chemkit/forcefieldatom.h>
 
 class UffParameters;
+class UffCalculation;
 
 class UffForceField : public chemkit::ForceField
 {
@@ -56,6 +57,20 @@ class UffForceField : public chemkit::ForceField
 
         bool isGroupSix(const chemkit::ForceFieldAtom *atom) const;
 
+    protected:
+        chemkit::ForceFieldCalculation* createPairCalculation(chemkit::ForceFieldCalculation::Type type,
+                                                              const chemkit::ForceFieldAtom *a,
+                                                              const chemkit::ForceFieldAtom *b) const;
+        bool setupMolecule(const chemkit::Molecule *molecule,
+                           std::vector<chemkit::ForceFieldAtom *> &atoms,
+                           std::vector<chemkit::ForceFieldCalculation *> &calculations);
+        bool setupCalculation(chemkit::ForceFieldCalculation *calculation);
+
+    private:
+        UffCalculation* copyCalculation(const chemkit::ForceFieldCalculation *calculation,
+                                        int firstAtom,
+                                        const std::vector<const chemkit::ForceFieldAtom *> &atoms) const;
+
     private:
         UffParameters *m_parameters;
 };
@@ -176,6 +176,10 @@ int AtomParametersCount = sizeof(AtomParameters) / sizeof(*AtomParameters);
 // --- Construction and Destruction ---------------------------------------- //
 UffParameters::UffParameters()
 {
+    for(int i = 0; i < AtomParametersCount; i++){
+        // insert() keeps the first entry for duplicate types
+        m_parameters.insert(std::make_pair(std::string(AtomParameters[i].type), &AtomParameters[i]));
+    }
 }
 
 UffParameters::~UffParameters()
@@ -185,11 +189,10 @@ UffParameters::~UffParameters()
 // --- Parameters ---------------------------------------------------------- //
 const UffAtomParameters* UffParameters::parameters(const chemkit::ForceFieldAtom *atom) const
 {
-    for(int i = 0; i < AtomParametersCount; i++){
-        if(atom->type() == AtomParameters[i].type){
-            return &AtomParameters[i];
-        }
+    std::map<std::string, const UffAtomParameters *>::const_iterator location = m_parameters.find(atom->type());
+    if(location == m_parameters.end()){
+        return 0;
     }
 
-    return 0;
+    return location->second;
 }
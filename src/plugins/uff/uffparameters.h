@@ -36,6 +36,9 @@
 #ifndef UFFPARAMETERS_H
 #define UFFPARAMETERS_H
 
+#include <map>
+#include <string>
+
 #include <chemkit/forcefieldatom.h>
 
 struct UffAtomParameters {
@@ -62,6 +65,9 @@ class UffParameters
 
         // parameters
         const UffAtomParameters* parameters(const chemkit::ForceFieldAtom *atom) const;
+
+    private:
+        std::map<std::string, const UffAtomParameters *> m_parameters;
 };
 
 #endif // UFFPARAMETERS_H
@@ -35,6 +35,7 @@
 
 #include "xtcfileformat.h"
 
+#include <vector>
 #include <rpc/xdr.h>
 #include <chemkit/vector3.h>
 #include <chemkit/unitcell.h>
@@ -83,10 +84,12 @@ bool XtcFileFormat::read(QIODevice *iodev, chemkit::TrajectoryFile *file)
         // read frame number
         int frameNumber = 0;
         xdr_int(&xdrs, &frameNumber);
+        frame->setStep(frameNumber);
 
         // read time
         float time = 0;
         xdr_float(&xdrs, &time);
+        frame->setTime(time);
 
         // read unit cell
         float box[3][3];
@@ -132,3 +135,81 @@ bool XtcFileFormat::read(QIODevice *iodev, chemkit::TrajectoryFile *file)
 
     return true;
 }
+
+bool XtcFileFormat::writeFrame(const chemkit::TrajectoryFrame *frame, QIODevice *iodev)
+{
+    int atomCount = frame->coordinates() ? frame->size() : 0;
+
+    // encode the frame into a memory buffer which is then appended to
+    // the output device. the buffer holds the header and twice the size
+    // of the uncompressed coordinates which is more than xdr3dfcoord()
+    // can write for the compressed coordinates
+    std::vector<char> buffer(64 * sizeof(int) + 2 * 3 * atomCount * sizeof(float));
+
+    XDR xdrs;
+    if(!xdrmemopen(&xdrs, &buffer[0], buffer.size(), "w")){
+        setErrorString("Failed to open xdr stream for writing.");
+        return false;
+    }
+
+    // write magic
+    int magic = 1995;
+    xdr_int(&xdrs, &magic);
+
+    // write atom count
+    xdr_int(&xdrs, &atomCount);
+
+    // write frame number
+    int frameNumber = frame->step();
+    xdr_int(&xdrs, &frameNumber);
+
+    // write time
+    float time = frame->time();
+    xdr_float(&xdrs, &time);
+
+    // write unit cell (in nanometers)
+    float box[3][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+    const chemkit::UnitCell *cell = frame->unitCell();
+    if(cell){
+        for(int i = 0; i < 3; i++){
+            box[0][i] = cell->x()[i] / 10;
+            box[1][i] = cell->y()[i] / 10;
+            box[2][i] = cell->z()[i] / 10;
+        }
+    }
+
+    for(int i = 0; i < 3; i++){
+        for(int j = 0; j < 3; j++){
+            xdr_float(&xdrs, &box[i][j]);
+        }
+    }
+
+    // write coordinates, dividing each by 10 to convert
+    // from angstroms to nanometers
+    std::vector<float> coordinateData(3 * atomCount);
+    for(int i = 0; i < atomCount; i++){
+        chemkit::Point3 position = frame->position(i);
+
+        coordinateData[i*3+0] = position.x() / 10;
+        coordinateData[i*3+1] = position.y() / 10;
+        coordinateData[i*3+2] = position.z() / 10;
+    }
+
+    float precision = 1000.0f;
+    int ok = xdr3dfcoord(&xdrs, atomCount ? &coordinateData[0] : 0, &atomCount, &precision);
+    int size = xdr_getpos(&xdrs);
+    xdrclose(&xdrs);
+
+    if(!ok){
+        setErrorString("Failed to encode frame coordinates.");
+        return false;
+    }
+
+    // append encoded frame to the output device
+    if(iodev->write(&buffer[0], size) != size){
+        setErrorString("Failed to write frame.");
+        return false;
+    }
+
+    return true;
+}
@@ -44,6 +44,7 @@ class XtcFileFormat : public chemkit::TrajectoryFileFormat
         XtcFileFormat();
 
         bool read(QIODevice *iodev, chemkit::TrajectoryFile *file);
+        bool writeFrame(const chemkit::TrajectoryFrame *frame, QIODevice *iodev);
 };
 
 #endif // XTCFILEFORMAT_H
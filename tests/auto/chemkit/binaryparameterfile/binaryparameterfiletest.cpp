@@ -0,0 +1,175 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "binaryparameterfiletest.h"
+
+#include <vector>
+
+#include <chemkit/binaryparameterfile.h>
+
+namespace {
+
+struct TestRecord
+{
+    int type;
+    chemkit::Float value;
+};
+
+} // end anonymous namespace
+
+void BinaryParameterFileTest::basic()
+{
+    chemkit::BinaryParameterFile file("test", 2);
+    QCOMPARE(file.format(), std::string("test"));
+    QCOMPARE(file.version(), 2);
+    QCOMPARE(file.isOpen(), false);
+    QCOMPARE(file.sectionCount(), 0);
+}
+
+void BinaryParameterFileTest::readWrite()
+{
+    QTemporaryFile temporaryFile;
+    QVERIFY(temporaryFile.open());
+    std::string fileName = temporaryFile.fileName().toStdString();
+    temporaryFile.close();
+
+    std::vector<TestRecord> records;
+    for(int i = 0; i < 10; i++){
+        TestRecord record = TestRecord();
+        record.type = i;
+        record.value = i * 1.5;
+        records.push_back(record);
+    }
+
+    std::vector<int> empty;
+
+    chemkit::BinaryParameterFile output("test", 1);
+    output.addSection(records);
+    output.addSection(empty);
+    QCOMPARE(output.sectionCount(), 2);
+    QVERIFY(output.write(fileName));
+
+    QVERIFY(chemkit::BinaryParameterFile::isBinaryParameterFile(fileName));
+
+    chemkit::BinaryParameterFile input("test", 1);
+    QVERIFY(input.open(fileName));
+    QCOMPARE(input.isOpen(), true);
+    QCOMPARE(input.sectionCount(), 2);
+
+    int count = 0;
+    const TestRecord *section = input.section<TestRecord>(0, &count);
+    QVERIFY(section != 0);
+    QCOMPARE(count, 10);
+    for(int i = 0; i < count; i++){
+        QCOMPARE(section[i].type, i);
+        QCOMPARE(section[i].value, chemkit::Float(i * 1.5));
+    }
+
+    // record size mismatch
+    QVERIFY(input.section<int>(0, &count) == 0);
+    QCOMPARE(count, 0);
+
+    // empty section
+    input.section<int>(1, &count);
+    QCOMPARE(count, 0);
+
+    // invalid section
+    QVERIFY(input.section<TestRecord>(2, &count) == 0);
+
+    input.close();
+    QCOMPARE(input.isOpen(), false);
+    QCOMPARE(input.sectionCount(), 0);
+
+    QFile::remove(QString::fromStdString(fileName));
+}
+
+void BinaryParameterFileTest::version()
+{
+    QTemporaryFile temporaryFile;
+    QVERIFY(temporaryFile.open());
+    std::string fileName = temporaryFile.fileName().toStdString();
+    temporaryFile.close();
+
+    chemkit::BinaryParameterFile output("test", 1);
+    QVERIFY(output.write(fileName));
+
+    chemkit::BinaryParameterFile newerVersion("test", 2);
+    QVERIFY(newerVersion.open(fileName) == false);
+
+    chemkit::BinaryParameterFile otherFormat("other", 1);
+    QVERIFY(otherFormat.open(fileName) == false);
+
+    chemkit::BinaryParameterFile sameVersion("test", 1);
+    QVERIFY(sameVersion.open(fileName) == true);
+
+    QFile::remove(QString::fromStdString(fileName));
+}
+
+void BinaryParameterFileTest::isCurrent()
+{
+    QTemporaryFile sourceFile;
+    QVERIFY(sourceFile.open());
+    sourceFile.write("parameters\n");
+    sourceFile.close();
+    std::string sourceFileName = sourceFile.fileName().toStdString();
+
+    QTemporaryFile temporaryFile;
+    QVERIFY(temporaryFile.open());
+    std::string fileName = temporaryFile.fileName().toStdString();
+    temporaryFile.close();
+
+    chemkit::BinaryParameterFile output("test", 1);
+    output.setSourceFile(sourceFileName);
+    QVERIFY(output.write(fileName));
+
+    chemkit::BinaryParameterFile input("test", 1);
+    QVERIFY(input.open(fileName));
+    QVERIFY(input.isCurrent(sourceFileName));
+
+    // changing the size of the source invalidates the file
+    QFile file(QString::fromStdString(sourceFileName));
+    QVERIFY(file.open(QFile::WriteOnly | QFile::Append));
+    file.write("more parameters\n");
+    file.close();
+    QVERIFY(input.isCurrent(sourceFileName) == false);
+
+    QVERIFY(input.isCurrent("missing.prm") == false);
+
+    QVERIFY(chemkit::BinaryParameterFile::isBinaryParameterFile(sourceFileName) == false);
+
+    QFile::remove(QString::fromStdString(fileName));
+}
+
+QTEST_APPLESS_MAIN(BinaryParameterFileTest)
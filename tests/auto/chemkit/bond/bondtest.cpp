@@ -138,6 +138,34 @@ void BondTest::isTerminal()
     QCOMPARE(C3_C4->isTerminal(), true);
 }
 
+void BondTest::isRotatable()
+{
+    chemkit::Molecule molecule;
+    chemkit::Atom *C1 = molecule.addAtom("C");
+    chemkit::Atom *C2 = molecule.addAtom("C");
+    chemkit::Atom *C3 = molecule.addAtom("C");
+    chemkit::Atom *C4 = molecule.addAtom("C");
+    chemkit::Atom *C5 = molecule.addAtom("C");
+    chemkit::Atom *H1 = molecule.addAtom("H");
+    chemkit::Bond *C1_C2 = molecule.addBond(C1, C2);
+    chemkit::Bond *C2_C3 = molecule.addBond(C2, C3);
+    chemkit::Bond *C3_C4 = molecule.addBond(C3, C4, chemkit::Bond::Double);
+    chemkit::Bond *C4_C5 = molecule.addBond(C4, C5);
+    chemkit::Bond *C1_H1 = molecule.addBond(C1, H1);
+    QCOMPARE(C1_C2->isRotatable(), false);
+    QCOMPARE(C2_C3->isRotatable(), true);
+    QCOMPARE(C3_C4->isRotatable(), false);
+    QCOMPARE(C4_C5->isRotatable(), false);
+    QCOMPARE(C1_H1->isRotatable(), false);
+
+    // bonds in rings are not rotatable
+    chemkit::Atom *C6 = molecule.addAtom("C");
+    molecule.addBond(C5, C6);
+    molecule.addBond(C6, C1);
+    QCOMPARE(C1_C2->isRotatable(), false);
+    QCOMPARE(C2_C3->isRotatable(), false);
+}
+
 void BondTest::rings()
 {
     chemkit::Molecule benzene("InChI=1/C6H6/c1-2-4-6-5-3-1/h1-6H", "inchi");
@@ -50,6 +50,7 @@ class BondTest : public QObject
         void residue();
         void contains();
         void isTerminal();
+        void isRotatable();
         void rings();
         void polarity();
         void length();
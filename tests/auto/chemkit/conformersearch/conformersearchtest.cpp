@@ -0,0 +1,145 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "conformersearchtest.h"
+
+#include <chemkit/atom.h>
+#include <chemkit/bond.h>
+#include <chemkit/molecule.h>
+#include <chemkit/conformer.h>
+#include <chemkit/moleculefile.h>
+#include <chemkit/conformersearch.h>
+
+const std::string dataPath = "../../../data/";
+
+void ConformerSearchTest::search()
+{
+    // butane in the anti conformation (slightly out of plane to avoid
+    // torsions of exactly 0 or 180 degrees)
+    const double coordinates[14][3] = {
+        {  0.0000,  0.0000,  0.0000 }, {  1.5300,  0.0000,  0.0000 },
+        {  2.0400,  1.4425,  0.0000 }, {  3.5700,  1.4425,  0.0500 },
+        { -0.3633,  1.0277,  0.0500 }, { -0.3633, -0.5138, -0.8900 },
+        { -0.3633, -0.5138,  0.8900 }, {  1.8933, -0.5138, -0.8900 },
+        {  1.8933, -0.5138,  0.8900 }, {  1.6766,  1.9563,  0.8900 },
+        {  1.6766,  1.9563, -0.8900 }, {  3.9333,  0.4148,  0.0500 },
+        {  3.9333,  1.9563, -0.8900 }, {  3.9333,  1.9563,  0.8900 }
+    };
+    const int hydrogenCarbons[10] = { 0, 0, 0, 1, 1, 2, 2, 3, 3, 3 };
+
+    chemkit::Molecule butane;
+    for(int i = 0; i < 14; i++){
+        chemkit::Atom *atom = butane.addAtom(i < 4 ? "C" : "H");
+        atom->setPosition(coordinates[i][0], coordinates[i][1], coordinates[i][2]);
+
+        if(i > 0 && i < 4){
+            butane.addBond(butane.atom(i - 1), atom);
+        }
+        else if(i >= 4){
+            butane.addBond(butane.atom(hydrogenCarbons[i - 4]), atom);
+        }
+    }
+
+    std::vector<chemkit::Bond *> rotatableBonds = chemkit::ConformerSearch::rotatableBonds(&butane);
+    QCOMPARE(rotatableBonds.size(), size_t(1));
+    QVERIFY(rotatableBonds[0] == butane.bond(butane.atom(1), butane.atom(2)));
+
+    // the systematic search finds the anti and gauche conformers
+    chemkit::ConformerSearch search("uff", chemkit::ConformerSearch::Systematic);
+    QCOMPARE(search.torsionIncrement(), 120.0);
+    QVERIFY(search.search(&butane));
+    QCOMPARE(search.trialCount(), 3);
+    QCOMPARE(search.failedTrialCount(), 0);
+    QVERIFY(search.conformerCount() >= 2);
+    QCOMPARE(butane.conformerCount(), search.conformerCount() + 1);
+    QVERIFY(search.energy(0) < search.energy(1));
+
+    // the coordinates of the molecule are not changed
+    QCOMPARE(butane.atom(3)->position().x(), 3.57);
+
+    butane.setConformer(search.conformer(0));
+    QVERIFY(qAbs(qAbs(butane.torsionAngle(butane.atom(0), butane.atom(1), butane.atom(2), butane.atom(3))) - 180) < 5);
+    butane.setConformer(search.conformer(1));
+    QVERIFY(qAbs(qAbs(butane.torsionAngle(butane.atom(0), butane.atom(1), butane.atom(2), butane.atom(3))) - 65) < 10);
+
+    // the results of a random search do not depend on the thread count
+    chemkit::Molecule *uridine = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(uridine != 0);
+    QCOMPARE(chemkit::ConformerSearch::rotatableBonds(uridine).size(), size_t(4));
+
+    chemkit::ConformerSearch serialSearch("uff", chemkit::ConformerSearch::Random);
+    serialSearch.setMaximumTrialCount(40);
+    serialSearch.setConvergenceTrialCount(0);
+    serialSearch.setThreadCount(1);
+    QVERIFY(serialSearch.search(uridine));
+    QCOMPARE(serialSearch.trialCount(), 40);
+    QVERIFY(serialSearch.conformerCount() > 1);
+
+    chemkit::ConformerSearch parallelSearch("uff", chemkit::ConformerSearch::Random);
+    parallelSearch.setMaximumTrialCount(40);
+    parallelSearch.setConvergenceTrialCount(0);
+    parallelSearch.setThreadCount(4);
+    QVERIFY(parallelSearch.search(uridine));
+    QCOMPARE(parallelSearch.conformerCount(), serialSearch.conformerCount());
+
+    for(int i = 0; i < serialSearch.conformerCount(); i++){
+        QCOMPARE(parallelSearch.energy(i), serialSearch.energy(i));
+        QVERIFY(serialSearch.energy(i) <= serialSearch.energy(0) + serialSearch.energyWindow());
+
+        foreach(const chemkit::Atom *atom, uridine->atoms()){
+            QVERIFY(parallelSearch.conformer(i)->position(atom) == serialSearch.conformer(i)->position(atom));
+        }
+    }
+
+    // the search stops early when no new conformers are found
+    chemkit::ConformerSearch convergedSearch("uff", chemkit::ConformerSearch::Random);
+    convergedSearch.setConvergenceTrialCount(5);
+    convergedSearch.setMaximumConformerCount(2);
+    QVERIFY(convergedSearch.search(uridine));
+    QVERIFY(convergedSearch.trialCount() < convergedSearch.maximumTrialCount());
+    QCOMPARE(convergedSearch.conformerCount(), 2);
+
+    // the search fails if the force field can not be setup
+    chemkit::Molecule *benzene = chemkit::MoleculeFile::quickRead(dataPath + "benzene.xyz");
+    QVERIFY(benzene != 0);
+    QVERIFY(!search.search(benzene));
+    QVERIFY(!search.errorString().empty());
+    QCOMPARE(search.conformerCount(), 0);
+
+    delete benzene;
+    delete uridine;
+}
+
+QTEST_APPLESS_MAIN(ConformerSearchTest)
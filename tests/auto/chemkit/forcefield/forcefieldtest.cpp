@@ -38,11 +38,21 @@
 #include <algorithm>
 
 #include <chemkit/chemkit.h>
+#include <chemkit/atom.h>
 #include <chemkit/molecule.h>
+#include <chemkit/unitcell.h>
+#include <chemkit/conformer.h>
 #include <chemkit/forcefield.h>
+#include <chemkit/moleculefile.h>
+#include <chemkit/forcefieldatom.h>
+#include <chemkit/moleculardynamics.h>
+#include <chemkit/forcefieldminimizer.h>
+#include <chemkit/forcefieldcalculation.h>
 
 #include "mockforcefield.h"
 
+const std::string dataPath = "../../../data/";
+
 void ForceFieldTest::initTestCase()
 {
     m_plugin = new MockForceFieldPlugin;
@@ -68,6 +78,477 @@ void ForceFieldTest::name()
     delete forceField;
 }
 
+void ForceFieldTest::frozenAtoms()
+{
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField);
+    forceField->addMolecule(molecule);
+    QVERIFY(forceField->setup());
+    QCOMPARE(forceField->frozenAtomCount(), 0);
+    QCOMPARE(forceField->frozenEnergy(), 0.0);
+
+    double energy = forceField->energy();
+    std::vector<chemkit::Vector3> gradient = forceField->gradient();
+
+    // freeze the first half of the atoms
+    int frozenAtomCount = forceField->atomCount() / 2;
+    for(int i = 0; i < frozenAtomCount; i++){
+        forceField->atom(i)->setFrozen(true);
+    }
+    QVERIFY(forceField->atom(0)->isFrozen());
+    QVERIFY(!forceField->atom(frozenAtomCount)->isFrozen());
+    QCOMPARE(forceField->frozenAtomCount(), frozenAtomCount);
+
+    // the calculations with only frozen atoms give the frozen energy
+    double frozenEnergy = 0;
+    foreach(const chemkit::ForceFieldCalculation *calculation, forceField->calculations()){
+        bool frozen = true;
+        for(int i = 0; i < calculation->atomCount(); i++){
+            frozen = frozen && calculation->atom(i)->isFrozen();
+        }
+
+        if(frozen){
+            frozenEnergy += calculation->energy();
+        }
+    }
+    QVERIFY(frozenEnergy != 0);
+    QVERIFY(qAbs(forceField->frozenEnergy() - frozenEnergy) < 1e-8);
+
+    // the total energy is unchanged and frozen atoms have no gradient
+    QVERIFY(qAbs(forceField->energy() - energy) < 1e-8);
+
+    std::vector<chemkit::Vector3> frozenGradient = forceField->gradient();
+    std::vector<chemkit::Vector3> numericalGradient = forceField->numericalGradient();
+    for(int i = 0; i < forceField->atomCount(); i++){
+        if(i < frozenAtomCount){
+            QVERIFY(frozenGradient[i] == chemkit::Vector3());
+            QVERIFY(numericalGradient[i] == chemkit::Vector3());
+        }
+        else{
+            QVERIFY((frozenGradient[i] - gradient[i]).length() < 1e-8);
+        }
+    }
+
+    // moving a frozen atom updates the frozen energy
+    chemkit::Point3 position = forceField->atom(0)->position();
+    forceField->atom(0)->moveBy(0.1, 0, 0);
+    double movedEnergy = forceField->energy();
+    QVERIFY(forceField->frozenEnergy() != frozenEnergy);
+    forceField->atom(0)->setFrozen(false);
+    QCOMPARE(forceField->frozenAtomCount(), frozenAtomCount - 1);
+    QVERIFY(qAbs(forceField->energy() - movedEnergy) < 1e-8);
+    forceField->atom(0)->setPosition(position);
+    forceField->atom(0)->setFrozen(true);
+
+    // minimization only moves the atoms which are not frozen
+    std::vector<chemkit::Point3> positions;
+    foreach(const chemkit::ForceFieldAtom *atom, forceField->atoms()){
+        positions.push_back(atom->position());
+    }
+
+    chemkit::ForceFieldMinimizer minimizer(forceField);
+    QVERIFY(minimizer.minimize());
+    QVERIFY(minimizer.isConverged());
+    QVERIFY(forceField->energy() < energy);
+
+    for(int i = 0; i < forceField->atomCount(); i++){
+        if(i < frozenAtomCount){
+            QVERIFY(forceField->atom(i)->position() == positions[i]);
+        }
+        else{
+            QVERIFY(!(forceField->atom(i)->position() == positions[i]));
+        }
+    }
+
+    delete forceField;
+    delete molecule;
+}
+
+void ForceFieldTest::restraints()
+{
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField);
+    forceField->addMolecule(molecule);
+    QVERIFY(forceField->setup());
+
+    double energy = forceField->energy();
+    int calculationCount = forceField->calculationCount();
+
+    chemkit::ForceFieldAtom *a = forceField->atom(0);
+    chemkit::ForceFieldAtom *b = forceField->atom(5);
+    double distance = forceField->distance(a, b);
+
+    // restraints add a harmonic energy term
+    chemkit::ForceFieldCalculation *positionRestraint =
+        forceField->addPositionRestraint(a, a->position() + chemkit::Vector3(1, 0, 0), 10);
+    QCOMPARE(positionRestraint->type(), int(chemkit::ForceFieldCalculation::Restraint));
+    QVERIFY(positionRestraint->isSetup());
+    QVERIFY(qAbs(forceField->energy() - (energy + 10)) < 1e-8);
+
+    chemkit::ForceFieldCalculation *distanceRestraint =
+        forceField->addDistanceRestraint(a, b, distance + 0.5, 5);
+    QCOMPARE(forceField->restraintCount(), 2);
+    QCOMPARE(forceField->calculationCount(), calculationCount + 2);
+    QVERIFY(qAbs(forceField->energy() - (energy + 10 + 1.25)) < 1e-8);
+
+    // the analytical gradient agrees with central differences
+    forceField->setNumericalGradientMethod(chemkit::ForceField::CentralDifference);
+    std::vector<chemkit::Vector3> analyticalGradient = forceField->gradient();
+    std::vector<chemkit::Vector3> numericalGradient = forceField->numericalGradient();
+    for(unsigned int i = 0; i < analyticalGradient.size(); i++){
+        QVERIFY((analyticalGradient[i] - numericalGradient[i]).length() < 1e-3);
+    }
+
+    // minimization satisfies a stiff distance restraint
+    forceField->removeRestraint(positionRestraint);
+    QCOMPARE(forceField->restraintCount(), 1);
+    QVERIFY(forceField->restraints()[0] == distanceRestraint);
+    forceField->removeRestraint(distanceRestraint);
+    distanceRestraint = forceField->addDistanceRestraint(a, b, distance + 0.5, 1000);
+
+    chemkit::ForceFieldMinimizer minimizer(forceField);
+    QVERIFY(minimizer.minimize());
+    QVERIFY(qAbs(forceField->distance(a, b) - (distance + 0.5)) < 0.05);
+
+    forceField->removeRestraints();
+    QCOMPARE(forceField->restraintCount(), 0);
+    QCOMPARE(forceField->calculationCount(), calculationCount);
+
+    delete forceField;
+    delete molecule;
+}
+
+void ForceFieldTest::trialMove()
+{
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField);
+    forceField->addMolecule(molecule);
+    QVERIFY(forceField->setup());
+
+    double initialEnergy = forceField->energy();
+
+    // move a single atom and reject
+    chemkit::ForceFieldAtom *atom = forceField->atom(3);
+    chemkit::Point3 initialPosition = atom->position();
+    double deltaEnergy = forceField->trialMove(atom, initialPosition + chemkit::Vector3(0.1, -0.2, 0.05));
+    QVERIFY(forceField->hasTrialMove());
+    QVERIFY(qAbs(forceField->energy() - (initialEnergy + deltaEnergy)) < 1e-8);
+
+    forceField->rejectTrialMove();
+    QVERIFY(!forceField->hasTrialMove());
+    QVERIFY(atom->position() == initialPosition);
+    QCOMPARE(forceField->energy(), initialEnergy);
+
+    // move a group of atoms and accept
+    std::vector<chemkit::ForceFieldAtom *> atoms;
+    std::vector<chemkit::Point3> positions;
+    for(int i = 0; i < 5; i++){
+        atoms.push_back(forceField->atom(i));
+        positions.push_back(forceField->atom(i)->position() + chemkit::Vector3(0.05, 0.05, 0.05));
+    }
+
+    deltaEnergy = forceField->trialMove(atoms, positions);
+    forceField->acceptTrialMove();
+    QVERIFY(!forceField->hasTrialMove());
+    QVERIFY(qAbs(forceField->energy() - (initialEnergy + deltaEnergy)) < 1e-8);
+    for(int i = 0; i < 5; i++){
+        QVERIFY(forceField->atom(i)->position() == positions[i]);
+    }
+
+    // the global terms are included in the change in energy
+    forceField->setElectrostaticsMethod(chemkit::ForceField::DampedShiftedForce);
+    forceField->setImplicitSolventEnabled(true);
+    for(int i = 0; i < forceField->atomCount(); i++){
+        forceField->atom(i)->setCharge(i % 2 ? 0.2 : -0.2);
+    }
+
+    initialEnergy = forceField->energy();
+    deltaEnergy = forceField->trialMove(atom, atom->position() + chemkit::Vector3(-0.1, 0.1, 0.2));
+    QVERIFY(qAbs(forceField->energy() - (initialEnergy + deltaEnergy)) < 1e-8);
+    forceField->rejectTrialMove();
+    QVERIFY(qAbs(forceField->energy() - initialEnergy) < 1e-8);
+
+    delete forceField;
+    delete molecule;
+}
+
+void ForceFieldTest::periodicBoundaries_data()
+{
+    QTest::addColumn<bool>("triclinic");
+
+    QTest::newRow("orthorhombic") << false;
+    QTest::newRow("triclinic") << true;
+}
+
+void ForceFieldTest::periodicBoundaries()
+{
+    QFETCH(bool, triclinic);
+
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField);
+    forceField->addMolecule(molecule);
+    QVERIFY(forceField->setup());
+
+    chemkit::Float energy = forceField->energy();
+    std::vector<chemkit::Vector3> gradient = forceField->gradient();
+
+    chemkit::UnitCell cell(chemkit::Vector3(40, 0, 0),
+                           triclinic ? chemkit::Vector3(12, 40, 0) : chemkit::Vector3(0, 40, 0),
+                           triclinic ? chemkit::Vector3(-8, 6, 40) : chemkit::Vector3(0, 0, 40));
+    forceField->setUnitCell(&cell);
+    QVERIFY(forceField->unitCell() == &cell);
+    QVERIFY(qAbs(forceField->energy() - energy) < 1e-6);
+
+    // split the molecule across the boundary of the cell
+    chemkit::Vector3 shift = cell.y() - cell.x() + cell.z();
+    for(int i = 0; i < forceField->atomCount(); i += 2){
+        forceField->atom(i)->moveBy(shift);
+    }
+
+    QVERIFY(qAbs(forceField->energy() - energy) < 1e-6);
+
+    std::vector<chemkit::Vector3> periodicGradient = forceField->gradient();
+    for(unsigned int i = 0; i < gradient.size(); i++){
+        QVERIFY((periodicGradient[i] - gradient[i]).length() < 1e-6);
+    }
+
+    // without the unit cell the bonds of the split molecule are broken
+    forceField->setUnitCell(0);
+    QVERIFY(qAbs(forceField->energy() - energy) > 1);
+
+    // the dynamics unit cell is used by the force field
+    chemkit::MolecularDynamics dynamics(forceField);
+    dynamics.setUnitCell(&cell);
+    QVERIFY(forceField->unitCell() == &cell);
+    QVERIFY(qAbs(dynamics.potentialEnergy() - energy) < 1e-6);
+
+    delete forceField;
+    delete molecule;
+}
+
+void ForceFieldTest::conformerEnergies()
+{
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    // add conformers with each atom displaced from its position
+    std::vector<chemkit::Conformer *> conformers;
+    for(int i = 0; i < 16; i++){
+        chemkit::Conformer *conformer = molecule->addConformer();
+
+        foreach(const chemkit::Atom *atom, molecule->atoms()){
+            chemkit::Float offset = 0.02 * ((atom->index() * 7 + i * 3) % 11 - 5);
+            conformer->setPosition(atom, atom->position() + chemkit::Vector3(offset, -offset, 0.5 * offset));
+        }
+
+        conformers.push_back(conformer);
+    }
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField);
+    forceField->addMolecule(molecule);
+    QVERIFY(forceField->setup());
+
+    // calculate the energy and gradient for each conformer one at a time
+    std::vector<chemkit::Float> referenceEnergies;
+    std::vector<chemkit::Vector3> referenceGradients;
+    foreach(const chemkit::Conformer *conformer, conformers){
+        forceField->readCoordinates(conformer);
+        referenceEnergies.push_back(forceField->energy());
+
+        std::vector<chemkit::Vector3> gradient = forceField->gradient();
+        referenceGradients.insert(referenceGradients.end(), gradient.begin(), gradient.end());
+    }
+    forceField->readCoordinates(molecule);
+    chemkit::Float initialEnergy = forceField->energy();
+
+    for(int threadCount = 1; threadCount <= 4; threadCount += 3){
+        forceField->setThreadCount(threadCount);
+
+        std::vector<chemkit::Float> energies = forceField->energies(conformers);
+        QCOMPARE(energies.size(), conformers.size());
+
+        std::vector<chemkit::Vector3> gradients;
+        std::vector<chemkit::Float> gradientEnergies = forceField->energies(conformers, gradients);
+        QCOMPARE(gradients.size(), referenceGradients.size());
+
+        for(unsigned int i = 0; i < conformers.size(); i++){
+            QVERIFY(qAbs(energies[i] - referenceEnergies[i]) < 1e-6);
+            QVERIFY(qAbs(gradientEnergies[i] - referenceEnergies[i]) < 1e-6);
+        }
+        for(unsigned int i = 0; i < gradients.size(); i++){
+            QVERIFY((gradients[i] - referenceGradients[i]).norm() < 1e-6);
+        }
+
+        // the positions of the atoms in the force field do not change
+        QCOMPARE(forceField->energy(), initialEnergy);
+    }
+
+    // a coordinate block with the positions of two conformers
+    std::vector<chemkit::Point3> coordinates;
+    for(int i = 0; i < 2; i++){
+        for(int j = 0; j < forceField->atomCount(); j++){
+            coordinates.push_back(conformers[i]->position(forceField->atom(j)->atom()));
+        }
+    }
+    std::vector<chemkit::Float> energies = forceField->energies(coordinates);
+    QCOMPARE(energies.size(), size_t(2));
+    QVERIFY(qAbs(energies[1] - referenceEnergies[1]) < 1e-6);
+
+    coordinates.pop_back();
+    QVERIFY(forceField->energies(coordinates).empty());
+
+    // restraints read the atom positions from each conformer
+    forceField->addDistanceRestraint(forceField->atom(0), forceField->atom(1), 2.0, 10.0);
+    forceField->addPositionRestraint(forceField->atom(2), forceField->atom(2)->position(), 10.0);
+    forceField->setThreadCount(1);
+    std::vector<chemkit::Float> restrainedEnergies = forceField->energies(conformers);
+    forceField->setThreadCount(4);
+    energies = forceField->energies(conformers);
+    for(unsigned int i = 0; i < conformers.size(); i++){
+        QVERIFY(restrainedEnergies[i] > referenceEnergies[i]);
+        QVERIFY(qAbs(energies[i] - restrainedEnergies[i]) < 1e-6);
+    }
+    forceField->removeRestraints();
+
+    // with the electrostatics enabled the conformers are evaluated
+    // one at a time and give the same energies as energy()
+    forceField->setElectrostaticsMethod(chemkit::ForceField::DampedShiftedForce);
+    forceField->readCoordinates(conformers[3]);
+    chemkit::Float electrostaticsEnergy = forceField->energy();
+    forceField->readCoordinates(molecule);
+    initialEnergy = forceField->energy();
+    energies = forceField->energies(conformers);
+    QCOMPARE(energies.size(), conformers.size());
+    QVERIFY(qAbs(energies[3] - electrostaticsEnergy) < 1e-6);
+    QCOMPARE(forceField->energy(), initialEnergy);
+
+    delete forceField;
+    delete molecule;
+}
+
+void ForceFieldTest::parallelGradient()
+{
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField);
+
+    // add enough copies of the molecule to use multiple threads
+    for(int i = 0; i < 20; i++){
+        forceField->addMolecule(molecule);
+    }
+
+    QVERIFY(forceField->setup());
+    QVERIFY(forceField->calculationCount() > 5000);
+
+    // serial gradient
+    forceField->setThreadCount(1);
+    QCOMPARE(forceField->threadCount(), 1);
+    QCOMPARE(forceField->effectiveThreadCount(), 1);
+    double serialEnergy = forceField->energy();
+    std::vector<chemkit::Vector3> serialGradient = forceField->gradient();
+    QCOMPARE(serialGradient.size(), size_t(forceField->atomCount()));
+
+    // parallel gradient with deterministic reduction
+    forceField->setThreadCount(4);
+    QCOMPARE(forceField->effectiveThreadCount(), 4);
+    QVERIFY(forceField->deterministicReduction());
+    QCOMPARE(forceField->energy(), serialEnergy);
+    std::vector<chemkit::Vector3> parallelGradient = forceField->gradient();
+    QCOMPARE(parallelGradient.size(), serialGradient.size());
+    for(unsigned int i = 0; i < serialGradient.size(); i++){
+        QVERIFY((parallelGradient[i] - serialGradient[i]).length() < 1e-6);
+    }
+
+    // deterministic reduction gives identical results each time
+    std::vector<chemkit::Vector3> repeatedGradient = forceField->gradient();
+    for(unsigned int i = 0; i < parallelGradient.size(); i++){
+        QVERIFY(repeatedGradient[i] == parallelGradient[i]);
+    }
+
+    // parallel gradient with unordered reduction
+    forceField->setDeterministicReduction(false);
+    parallelGradient = forceField->gradient();
+    for(unsigned int i = 0; i < serialGradient.size(); i++){
+        QVERIFY((parallelGradient[i] - serialGradient[i]).length() < 1e-6);
+    }
+
+    // ideal thread count
+    forceField->setThreadCount(0);
+    QCOMPARE(forceField->effectiveThreadCount(), QThread::idealThreadCount());
+
+    delete forceField;
+    delete molecule;
+}
+
+void ForceFieldTest::numericalGradient()
+{
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField);
+
+    for(int i = 0; i < 4; i++){
+        forceField->addMolecule(molecule);
+    }
+    QVERIFY(forceField->setup());
+
+    // atom energies only include the calculations the atom is in
+    foreach(const chemkit::ForceFieldAtom *atom, forceField->atoms()){
+        double energy = 0;
+        size_t calculationCount = 0;
+        foreach(const chemkit::ForceFieldCalculation *calculation, forceField->calculations()){
+            if(calculation->contains(atom)){
+                energy += calculation->energy();
+                calculationCount++;
+            }
+        }
+
+        QCOMPARE(atom->energy(), energy);
+        QCOMPARE(forceField->calculations(atom).size(), calculationCount);
+        QVERIFY(forceField->atom(atom->index()) == atom);
+    }
+
+    // central differences agree with the analytical gradient
+    std::vector<chemkit::Vector3> analyticalGradient = forceField->gradient();
+
+    QCOMPARE(forceField->numericalGradientMethod(), chemkit::ForceField::ForwardDifference);
+    forceField->setNumericalGradientMethod(chemkit::ForceField::CentralDifference);
+    QCOMPARE(forceField->numericalGradientMethod(), chemkit::ForceField::CentralDifference);
+
+    forceField->setThreadCount(1);
+    std::vector<chemkit::Vector3> serialGradient = forceField->numericalGradient();
+    QCOMPARE(serialGradient.size(), analyticalGradient.size());
+    for(unsigned int i = 0; i < serialGradient.size(); i++){
+        QVERIFY((serialGradient[i] - analyticalGradient[i]).length() < 1e-3);
+    }
+
+    // the parallel numerical gradient is identical to the serial one
+    forceField->setThreadCount(4);
+    std::vector<chemkit::Vector3> parallelGradient = forceField->numericalGradient();
+    for(unsigned int i = 0; i < parallelGradient.size(); i++){
+        QVERIFY(parallelGradient[i] == serialGradient[i]);
+    }
+
+    delete forceField;
+    delete molecule;
+}
+
 void ForceFieldTest::cleanupTestCase()
 {
     delete m_plugin;
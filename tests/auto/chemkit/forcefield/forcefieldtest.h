@@ -51,6 +51,14 @@ class ForceFieldTest : public QObject
         void initTestCase();
         void create();
         void name();
+        void frozenAtoms();
+        void restraints();
+        void trialMove();
+        void periodicBoundaries_data();
+        void periodicBoundaries();
+        void conformerEnergies();
+        void parallelGradient();
+        void numericalGradient();
         void cleanupTestCase();
 };
 
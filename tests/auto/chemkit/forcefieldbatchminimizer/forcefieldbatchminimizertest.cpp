@@ -0,0 +1,114 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "forcefieldbatchminimizertest.h"
+
+#include <chemkit/atom.h>
+#include <chemkit/molecule.h>
+#include <chemkit/forcefield.h>
+#include <chemkit/moleculefile.h>
+#include <chemkit/forcefieldminimizer.h>
+#include <chemkit/forcefieldbatchminimizer.h>
+
+const std::string dataPath = "../../../data/";
+
+void ForceFieldBatchMinimizerTest::minimize()
+{
+    // benzene.xyz has no bonds so the force field can not be setup
+    const char *fileNames[] = { "uridine.mol2", "adenosine.mol", "guanine.mol",
+                                "serine.mol", "methanol.sdf", "water.mol", "benzene.xyz" };
+
+    chemkit::MoleculeFile input;
+    for(int i = 0; i < 14; i++){
+        chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + fileNames[i % 7]);
+        QVERIFY(molecule != 0);
+        input.addMolecule(molecule);
+    }
+
+    chemkit::ForceFieldBatchMinimizer batchMinimizer("uff");
+    batchMinimizer.setThreadCount(4);
+    QCOMPARE(batchMinimizer.effectiveThreadCount(), 4);
+
+    chemkit::MoleculeFile output;
+    QVERIFY(batchMinimizer.minimize(&input, &output));
+    QCOMPARE(output.moleculeCount(), 14);
+    QCOMPARE(batchMinimizer.resultCount(), 14);
+    QCOMPARE(batchMinimizer.convergedCount(), 12);
+    QCOMPARE(batchMinimizer.failedCount(), 2);
+
+    // the results are in input order and match minimizing each
+    // molecule on its own
+    for(int i = 0; i < 14; i++){
+        const chemkit::Molecule *molecule = input.molecule(i);
+        const chemkit::Molecule *minimized = output.molecule(i);
+        QCOMPARE(minimized->formula(), molecule->formula());
+        QVERIFY(batchMinimizer.elapsedTime(i) >= 0);
+
+        // each molecule in a batch is evaluated with a single thread
+        chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+        forceField->setThreadCount(1);
+        forceField->addMolecule(molecule);
+
+        if(!forceField->setup()){
+            QCOMPARE(batchMinimizer.status(i), chemkit::ForceFieldMinimizer::Failed);
+            delete forceField;
+            continue;
+        }
+
+        QCOMPARE(batchMinimizer.initialEnergy(i), forceField->energy());
+
+        chemkit::ForceFieldMinimizer minimizer(forceField);
+        QVERIFY(minimizer.minimize());
+        QCOMPARE(batchMinimizer.status(i), chemkit::ForceFieldMinimizer::Converged);
+        QCOMPARE(batchMinimizer.stepCount(i), minimizer.stepCount());
+        QCOMPARE(batchMinimizer.energy(i), minimizer.energy());
+        QCOMPARE(batchMinimizer.rootMeanSquareGradient(i), minimizer.rootMeanSquareGradient());
+
+        // the minimized coordinates are written to the output molecules
+        for(int j = 0; j < minimized->atomCount(); j++){
+            QVERIFY(minimized->atom(j)->position() == forceField->atom(j)->position());
+        }
+
+        delete forceField;
+    }
+
+    // an unknown force field fails every molecule
+    batchMinimizer.setForceField("invalid_name");
+    QVERIFY(!batchMinimizer.minimize(output.molecules()));
+    QVERIFY(!batchMinimizer.errorString().empty());
+    QCOMPARE(batchMinimizer.failedCount(), 14);
+}
+
+QTEST_APPLESS_MAIN(ForceFieldBatchMinimizerTest)
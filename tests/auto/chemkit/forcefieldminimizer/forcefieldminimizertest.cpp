@@ -0,0 +1,89 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "forcefieldminimizertest.h"
+
+#include <chemkit/molecule.h>
+#include <chemkit/forcefield.h>
+#include <chemkit/moleculefile.h>
+#include <chemkit/forcefieldminimizer.h>
+
+const std::string dataPath = "../../../data/";
+
+void ForceFieldMinimizerTest::minimize_data()
+{
+    QTest::addColumn<int>("algorithm");
+
+    QTest::newRow("steepest-descent") << int(chemkit::ForceFieldMinimizer::SteepestDescent);
+    QTest::newRow("conjugate-gradient") << int(chemkit::ForceFieldMinimizer::ConjugateGradient);
+    QTest::newRow("lbfgs") << int(chemkit::ForceFieldMinimizer::Lbfgs);
+    QTest::newRow("fire") << int(chemkit::ForceFieldMinimizer::Fire);
+    QTest::newRow("truncated-newton") << int(chemkit::ForceFieldMinimizer::TruncatedNewton);
+}
+
+void ForceFieldMinimizerTest::minimize()
+{
+    QFETCH(int, algorithm);
+
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField);
+    forceField->addMolecule(molecule);
+    QVERIFY(forceField->setup());
+
+    double initialEnergy = forceField->energy();
+
+    chemkit::ForceFieldMinimizer minimizer(forceField, chemkit::ForceFieldMinimizer::Algorithm(algorithm));
+    minimizer.setEnergyConvergence(0);
+    minimizer.setMaximumStepCount(5000);
+    QVERIFY(minimizer.minimize());
+    QCOMPARE(minimizer.status(), chemkit::ForceFieldMinimizer::Converged);
+    QVERIFY(minimizer.stepCount() > 0);
+    QVERIFY(minimizer.gradientEvaluationCount() >= minimizer.stepCount());
+    QVERIFY(minimizer.energy() < initialEnergy);
+    QVERIFY(minimizer.rootMeanSquareGradient() < 0.1);
+    QVERIFY(minimizer.maximumGradient() < 0.5);
+
+    // the atoms are left at the minimized positions
+    QVERIFY(qAbs(forceField->energy() - minimizer.energy()) < 1e-6);
+    QVERIFY(forceField->rootMeanSquareGradient() < 0.1);
+
+    delete forceField;
+    delete molecule;
+}
+
+QTEST_APPLESS_MAIN(ForceFieldMinimizerTest)
@@ -0,0 +1,135 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "forcefieldprofiletest.h"
+
+#include <chemkit/molecule.h>
+#include <chemkit/forcefield.h>
+#include <chemkit/moleculefile.h>
+#include <chemkit/forcefieldatom.h>
+#include <chemkit/forcefieldprofile.h>
+#include <chemkit/forcefieldcalculation.h>
+
+const std::string dataPath = "../../../data/";
+
+void ForceFieldProfileTest::profile()
+{
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField);
+    forceField->addMolecule(molecule);
+    QVERIFY(forceField->setup());
+
+    double energy = forceField->energy();
+    std::vector<chemkit::Vector3> gradient = forceField->gradient();
+
+    // nothing is recorded while profiling is disabled
+    const chemkit::ForceFieldProfile *profile = forceField->profile();
+    QVERIFY(!forceField->profilingEnabled());
+    QVERIFY(profile->isEmpty());
+
+    forceField->setProfilingEnabled(true);
+    QVERIFY(forceField->profilingEnabled());
+    QVERIFY(qAbs(forceField->energy() - energy) < 1e-8);
+
+    std::vector<chemkit::Vector3> profiledGradient = forceField->gradient();
+    for(unsigned int i = 0; i < gradient.size(); i++){
+        QVERIFY((profiledGradient[i] - gradient[i]).length() < 1e-8);
+    }
+
+    QCOMPARE(profile->energyEvaluationCount(), 1);
+    QCOMPARE(profile->gradientEvaluationCount(), 1);
+
+    // the energy of each type is the sum of its calculations
+    std::vector<int> types = profile->types();
+    QCOMPARE(types.size(), size_t(5));
+
+    double profileEnergy = 0;
+    int calculationCount = 0;
+    foreach(int type, types){
+        double typeEnergy = 0;
+        int typeCalculationCount = 0;
+        std::vector<chemkit::Vector3> typeGradient(forceField->atomCount());
+
+        foreach(const chemkit::ForceFieldCalculation *calculation, forceField->calculations()){
+            if(calculation->type() == type){
+                typeEnergy += calculation->energy();
+                typeCalculationCount++;
+
+                std::vector<chemkit::Vector3> calculationGradient = calculation->gradient();
+                for(int i = 0; i < calculation->atomCount(); i++){
+                    typeGradient[calculation->atom(i)->index()] += calculationGradient[i];
+                }
+            }
+        }
+
+        double normSquared = 0;
+        foreach(const chemkit::Vector3 &vector, typeGradient){
+            normSquared += vector.lengthSquared();
+        }
+
+        QCOMPARE(profile->calculationCount(type), typeCalculationCount);
+        QVERIFY(qAbs(profile->energy(type) - typeEnergy) < 1e-8);
+        QVERIFY(qAbs(profile->gradientNorm(type) - sqrt(normSquared)) < 1e-8);
+        QVERIFY(profile->time(type) >= 0);
+
+        profileEnergy += profile->energy(type);
+        calculationCount += profile->calculationCount(type);
+    }
+
+    QVERIFY(qAbs(profileEnergy - energy) < 1e-8);
+    QCOMPARE(calculationCount, forceField->calculationCount());
+    QVERIFY(profile->totalTime() > 0);
+    QCOMPARE(profile->neighborListBuildCount(), 0);
+
+    // the neighbor list is profiled when it is used by the electrostatics
+    forceField->setElectrostaticsMethod(chemkit::ForceField::DampedShiftedForce);
+    forceField->energy();
+    QCOMPARE(profile->energyEvaluationCount(), 2);
+    QCOMPARE(profile->neighborListBuildCount(), 1);
+    QVERIFY(profile->neighborListPairCount() > 0);
+    QVERIFY(profile->neighborListCellCount() > 0);
+
+    forceField->clearProfile();
+    QVERIFY(profile->isEmpty());
+    QVERIFY(profile->types().empty());
+
+    delete forceField;
+    delete molecule;
+}
+
+QTEST_APPLESS_MAIN(ForceFieldProfileTest)
@@ -0,0 +1,269 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "generalizedborntest.h"
+
+#include <cmath>
+
+#include <chemkit/atom.h>
+#include <chemkit/point3.h>
+#include <chemkit/vector3.h>
+#include <chemkit/constants.h>
+#include <chemkit/molecule.h>
+#include <chemkit/moleculefile.h>
+#include <chemkit/generalizedborn.h>
+#include <chemkit/molecularsurface.h>
+
+namespace {
+
+const std::string dataPath = "../../../data/";
+
+chemkit::Molecule *uridine = 0;
+std::vector<chemkit::Point3> positions;
+std::vector<chemkit::Float> charges;
+
+// Sets the radii and screening factors of gb to the default values
+// for the atoms in uridine.
+void setupGeneralizedBorn(chemkit::GeneralizedBorn &gb)
+{
+    std::vector<chemkit::Float> radii;
+    std::vector<chemkit::Float> factors;
+
+    foreach(const chemkit::Atom *atom, uridine->atoms()){
+        radii.push_back(chemkit::GeneralizedBorn::intrinsicRadius(atom));
+        factors.push_back(chemkit::GeneralizedBorn::screeningFactor(atom));
+    }
+
+    gb.setRadii(radii);
+    gb.setScreeningFactors(factors);
+}
+
+} // end anonymous namespace
+
+void GeneralizedBornTest::initTestCase()
+{
+    uridine = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(uridine != 0);
+
+    // neutral set of pseudo-random charges
+    chemkit::Float sum = 0;
+    foreach(const chemkit::Atom *atom, uridine->atoms()){
+        positions.push_back(atom->position());
+        charges.push_back((atom->index() * 6007 % 100) / 100.0 - 0.5);
+        sum += charges.back();
+    }
+
+    for(unsigned int i = 0; i < charges.size(); i++){
+        charges[i] -= sum / charges.size();
+    }
+}
+
+void GeneralizedBornTest::basic()
+{
+    chemkit::GeneralizedBorn gb;
+    QCOMPARE(gb.soluteDielectric(), chemkit::Float(1.0));
+    QCOMPARE(gb.solventDielectric(), chemkit::Float(78.5));
+    QCOMPARE(gb.surfaceTension(), chemkit::Float(0.0054));
+    QCOMPARE(gb.probeRadius(), chemkit::Float(1.4));
+    QCOMPARE(gb.cutoff(), chemkit::Float(0));
+    QCOMPARE(gb.threadCount(), 0);
+    QVERIFY(gb.effectiveThreadCount() >= 1);
+
+    gb.setSolventDielectric(4.0);
+    QCOMPARE(gb.solventDielectric(), chemkit::Float(4.0));
+    gb.setCutoff(12.0);
+    QCOMPARE(gb.cutoff(), chemkit::Float(12.0));
+    gb.setThreadCount(-2);
+    QCOMPARE(gb.threadCount(), 0);
+
+    // without radii there is no energy
+    QCOMPARE(gb.energy(positions, charges), chemkit::Float(0));
+    QVERIFY(gb.bornRadii(positions).empty());
+}
+
+void GeneralizedBornTest::ion()
+{
+    // the polar energy of an isolated ion is given by the born
+    // equation with the offset radius of the ion
+    std::vector<chemkit::Point3> ionPositions(1);
+    std::vector<chemkit::Float> ionCharges(1, -1.0);
+
+    chemkit::GeneralizedBorn gb;
+    gb.setRadii(std::vector<chemkit::Float>(1, 1.7));
+    gb.setScreeningFactors(std::vector<chemkit::Float>(1, 0.8));
+
+    std::vector<chemkit::Float> bornRadii = gb.bornRadii(ionPositions);
+    QCOMPARE(bornRadii.size(), size_t(1));
+    QVERIFY(qAbs(bornRadii[0] - 1.61) < 1e-12);
+
+    gb.energy(ionPositions, ionCharges);
+    chemkit::Float expected = -0.5 * 332.0716 * (1 - 1 / 78.5) / 1.61;
+    QVERIFY(qAbs(gb.polarEnergy() - expected) < 1e-8);
+
+    // nonpolar energy of a fully exposed atom
+    chemkit::Float area = 4 * chemkit::constants::Pi * (1.7 + 1.4) * (1.7 + 1.4);
+    QVERIFY(qAbs(gb.nonpolarEnergy() - 0.0054 * area * std::pow(1.7 / 1.61, 6)) < 1e-8);
+
+    // no solvation energy without a dielectric boundary
+    gb.setSolventDielectric(1.0);
+    gb.energy(ionPositions, ionCharges);
+    QVERIFY(qAbs(gb.polarEnergy()) < 1e-12);
+}
+
+void GeneralizedBornTest::bornRadii()
+{
+    chemkit::GeneralizedBorn gb;
+    setupGeneralizedBorn(gb);
+
+    // buried atoms have larger born radii than their intrinsic radii
+    std::vector<chemkit::Float> radii = gb.radii();
+    std::vector<chemkit::Float> bornRadii = gb.bornRadii(positions);
+    QCOMPARE(bornRadii.size(), positions.size());
+
+    for(unsigned int i = 0; i < bornRadii.size(); i++){
+        QVERIFY(bornRadii[i] > radii[i] - 0.09);
+        QVERIFY(bornRadii[i] < 10.0);
+    }
+
+    // hydrogens bonded to nitrogen use the larger radius
+    foreach(const chemkit::Atom *atom, uridine->atoms()){
+        if(atom->is(chemkit::Atom::Hydrogen) && atom->isBondedTo(chemkit::Atom::Nitrogen)){
+            QCOMPARE(chemkit::GeneralizedBorn::intrinsicRadius(atom), chemkit::Float(1.3));
+        }
+        else if(atom->is(chemkit::Atom::Hydrogen)){
+            QCOMPARE(chemkit::GeneralizedBorn::intrinsicRadius(atom), chemkit::Float(1.2));
+        }
+    }
+}
+
+void GeneralizedBornTest::gradient()
+{
+    chemkit::GeneralizedBorn gb;
+    setupGeneralizedBorn(gb);
+
+    std::vector<chemkit::Vector3> gradient;
+    chemkit::Float energy = gb.energy(positions, charges, gradient);
+    QCOMPARE(gradient.size(), positions.size());
+    QVERIFY(qAbs(energy - gb.energy(positions, charges)) < 1e-12);
+    QVERIFY(qAbs(energy - gb.polarEnergy() - gb.nonpolarEnergy()) < 1e-12);
+
+    // compare with central differences
+    const chemkit::Float step = 1e-5;
+
+    for(unsigned int i = 0; i < positions.size(); i++){
+        for(int j = 0; j < 3; j++){
+            std::vector<chemkit::Point3> forward = positions;
+            forward[i][j] += step;
+            std::vector<chemkit::Point3> backward = positions;
+            backward[i][j] -= step;
+
+            chemkit::Float numerical = (gb.energy(forward, charges) -
+                                        gb.energy(backward, charges)) / (2 * step);
+
+            QVERIFY(qAbs(gradient[i][j] - numerical) < 1e-6);
+        }
+    }
+}
+
+void GeneralizedBornTest::threads()
+{
+    chemkit::GeneralizedBorn gb;
+    setupGeneralizedBorn(gb);
+
+    gb.setThreadCount(1);
+    std::vector<chemkit::Vector3> serialGradient;
+    chemkit::Float serialEnergy = gb.energy(positions, charges, serialGradient);
+
+    for(int threadCount = 2; threadCount <= 8; threadCount *= 2){
+        gb.setThreadCount(threadCount);
+
+        std::vector<chemkit::Vector3> gradient;
+        chemkit::Float energy = gb.energy(positions, charges, gradient);
+        QVERIFY(qAbs(energy - serialEnergy) < 1e-10);
+
+        for(unsigned int i = 0; i < gradient.size(); i++){
+            QVERIFY((gradient[i] - serialGradient[i]).length() < 1e-10);
+        }
+
+        // the result does not depend on the scheduling of the threads
+        std::vector<chemkit::Vector3> repeatGradient;
+        QCOMPARE(gb.energy(positions, charges, repeatGradient), energy);
+        for(unsigned int i = 0; i < gradient.size(); i++){
+            QVERIFY(repeatGradient[i] == gradient[i]);
+        }
+    }
+}
+
+void GeneralizedBornTest::cutoff()
+{
+    chemkit::GeneralizedBorn gb;
+    setupGeneralizedBorn(gb);
+
+    std::vector<chemkit::Vector3> gradient;
+    chemkit::Float energy = gb.energy(positions, charges, gradient);
+
+    // a cutoff longer than the molecule uses every pair
+    gb.setCutoff(30.0);
+    std::vector<chemkit::Vector3> cutoffGradient;
+    QVERIFY(qAbs(gb.energy(positions, charges, cutoffGradient) - energy) < 1e-10);
+    for(unsigned int i = 0; i < gradient.size(); i++){
+        QVERIFY((cutoffGradient[i] - gradient[i]).length() < 1e-10);
+    }
+
+    // a short cutoff changes the energy
+    gb.setCutoff(4.0);
+    QVERIFY(qAbs(gb.energy(positions, charges) - energy) > 1e-3);
+}
+
+void GeneralizedBornTest::nonpolarEnergy()
+{
+    chemkit::GeneralizedBorn gb;
+    setupGeneralizedBorn(gb);
+    gb.energy(positions, charges);
+
+    // the ace approximation should be close to the surface tension
+    // times the solvent accessible surface area of the molecule
+    chemkit::MolecularSurface surface(uridine, chemkit::MolecularSurface::SolventAccessible);
+    chemkit::Float surfaceEnergy = gb.surfaceTension() * surface.surfaceArea();
+
+    QVERIFY(gb.nonpolarEnergy() > 0.5 * surfaceEnergy);
+    QVERIFY(gb.nonpolarEnergy() < 2.0 * surfaceEnergy);
+
+    gb.setSurfaceTension(0);
+    gb.energy(positions, charges);
+    QCOMPARE(gb.nonpolarEnergy(), chemkit::Float(0));
+}
+
+QTEST_APPLESS_MAIN(GeneralizedBornTest)
@@ -0,0 +1,197 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "moleculardynamicstest.h"
+
+#include <chemkit/atom.h>
+#include <chemkit/bond.h>
+#include <chemkit/molecule.h>
+#include <chemkit/forcefield.h>
+#include <chemkit/trajectory.h>
+#include <chemkit/moleculefile.h>
+#include <chemkit/trajectoryframe.h>
+#include <chemkit/moleculardynamics.h>
+#include <chemkit/forcefieldminimizer.h>
+
+const std::string dataPath = "../../../data/";
+
+void MolecularDynamicsTest::constantEnergy()
+{
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField);
+    forceField->addMolecule(molecule);
+    QVERIFY(forceField->setup());
+
+    chemkit::ForceFieldMinimizer minimizer(forceField);
+    QVERIFY(minimizer.minimize());
+
+    // constant energy dynamics should conserve the total energy
+    chemkit::MolecularDynamics dynamics(forceField);
+    dynamics.setTimeStep(0.5);
+    dynamics.initializeVelocities(300);
+    QVERIFY(qAbs(dynamics.instantaneousTemperature() - 300) < 1e-6);
+
+    chemkit::Trajectory trajectory;
+    dynamics.setTrajectory(&trajectory);
+    dynamics.setFrameInterval(50);
+
+    double initialEnergy = dynamics.totalEnergy();
+    QVERIFY(dynamics.run(400));
+    QCOMPARE(dynamics.stepCount(), 400);
+    QVERIFY(qAbs(dynamics.time() - 0.2) < 1e-10);
+    QVERIFY(qAbs(dynamics.totalEnergy() - initialEnergy) < 0.5);
+
+    QCOMPARE(trajectory.frameCount(), 8);
+    QCOMPARE(trajectory.frame(7)->step(), 400);
+    QCOMPARE(trajectory.frame(7)->size(), forceField->atomCount());
+    QVERIFY(trajectory.frame(7)->position(0) == forceField->atom(0)->position());
+
+    delete forceField;
+    delete molecule;
+}
+
+void MolecularDynamicsTest::constraints()
+{
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField);
+    forceField->addMolecule(molecule);
+    QVERIFY(forceField->setup());
+
+    chemkit::ForceFieldMinimizer minimizer(forceField);
+    QVERIFY(minimizer.minimize());
+
+    chemkit::MolecularDynamics dynamics(forceField, chemkit::MolecularDynamics::Langevin);
+    dynamics.setConstraints(chemkit::MolecularDynamics::HydrogenBonds);
+    dynamics.setTimeStep(2.0);
+    dynamics.setFriction(5.0);
+    dynamics.setRandomSeed(42);
+    // record the constrained bond lengths
+    std::vector<std::pair<chemkit::ForceFieldAtom *, chemkit::ForceFieldAtom *> > bonds;
+    std::vector<double> lengths;
+    foreach(const chemkit::Bond *bond, molecule->bonds()){
+        if(bond->contains(chemkit::Atom::Hydrogen)){
+            chemkit::ForceFieldAtom *a = forceField->atom(bond->atom1());
+            chemkit::ForceFieldAtom *b = forceField->atom(bond->atom2());
+            bonds.push_back(std::make_pair(a, b));
+            lengths.push_back(forceField->distance(a, b));
+        }
+    }
+
+    int constraintCount = bonds.size();
+    QCOMPARE(dynamics.constraintCount(), constraintCount);
+    QCOMPARE(dynamics.degreesOfFreedom(), 3 * forceField->atomCount() - constraintCount - 3);
+
+    dynamics.initializeVelocities(300);
+    QVERIFY(dynamics.run(2000));
+
+    for(unsigned int i = 0; i < bonds.size(); i++){
+        QVERIFY(qAbs(forceField->distance(bonds[i].first, bonds[i].second) - lengths[i]) < 1e-4);
+    }
+
+    // the average temperature should be close to the target
+    double temperature = 0;
+    for(int i = 0; i < 500; i++){
+        QVERIFY(dynamics.step());
+        temperature += dynamics.instantaneousTemperature();
+    }
+    temperature /= 500;
+    QVERIFY(temperature > 200 && temperature < 400);
+
+    delete forceField;
+    delete molecule;
+}
+
+void MolecularDynamicsTest::frozenAtoms()
+{
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField);
+    forceField->addMolecule(molecule);
+    QVERIFY(forceField->setup());
+
+    // freeze the first ten atoms
+    std::vector<chemkit::Point3> frozenPositions;
+    for(int i = 0; i < 10; i++){
+        forceField->atom(i)->setFrozen(true);
+        frozenPositions.push_back(forceField->atom(i)->position());
+    }
+    int mobileAtomCount = forceField->atomCount() - 10;
+
+    // bonds between two frozen atoms are not constrained
+    int constraintCount = 0;
+    foreach(const chemkit::Bond *bond, molecule->bonds()){
+        if(bond->contains(chemkit::Atom::Hydrogen) &&
+           !(forceField->atom(bond->atom1())->isFrozen() && forceField->atom(bond->atom2())->isFrozen())){
+            constraintCount++;
+        }
+    }
+
+    chemkit::MolecularDynamics dynamics(forceField, chemkit::MolecularDynamics::Langevin);
+    dynamics.setConstraints(chemkit::MolecularDynamics::HydrogenBonds);
+    dynamics.setRandomSeed(42);
+    QCOMPARE(dynamics.constraintCount(), constraintCount);
+    QCOMPARE(dynamics.degreesOfFreedom(), 3 * mobileAtomCount - constraintCount);
+
+    dynamics.initializeVelocities(300);
+    QVERIFY(qAbs(dynamics.instantaneousTemperature() - 300) < 1e-6);
+    QVERIFY(dynamics.run(200));
+
+    // the frozen atoms stay at rest while the others move
+    for(int i = 0; i < 10; i++){
+        QVERIFY(dynamics.velocity(i).length() == 0);
+        QVERIFY(forceField->atom(i)->position().x() == frozenPositions[i].x());
+        QVERIFY(forceField->atom(i)->position().y() == frozenPositions[i].y());
+        QVERIFY(forceField->atom(i)->position().z() == frozenPositions[i].z());
+    }
+    QVERIFY(dynamics.velocity(20).length() > 0);
+
+    // unfreezing an atom lets it move on the next step
+    forceField->atom(0)->setFrozen(false);
+    QVERIFY(dynamics.run(10));
+    QVERIFY(dynamics.velocity(0).length() > 0);
+
+    delete forceField;
+    delete molecule;
+}
+
+QTEST_APPLESS_MAIN(MolecularDynamicsTest)
@@ -240,6 +240,42 @@ void MoleculeTest::isEmpty()
     QCOMPARE(molecule.isEmpty(), true);
 }
 
+void MoleculeTest::topologyRevision()
+{
+    chemkit::Molecule molecule;
+    unsigned int revision = molecule.topologyRevision();
+
+    chemkit::Atom *C1 = molecule.addAtom("C");
+    QVERIFY(molecule.topologyRevision() != revision);
+    revision = molecule.topologyRevision();
+
+    chemkit::Atom *C2 = molecule.addAtom("C");
+    chemkit::Bond *bond = molecule.addBond(C1, C2);
+    QVERIFY(molecule.topologyRevision() != revision);
+    revision = molecule.topologyRevision();
+
+    bond->setOrder(chemkit::Bond::Double);
+    QVERIFY(molecule.topologyRevision() != revision);
+    revision = molecule.topologyRevision();
+
+    C2->setAtomicNumber(chemkit::Atom::Oxygen);
+    QVERIFY(molecule.topologyRevision() != revision);
+    revision = molecule.topologyRevision();
+
+    // geometry and charges do not change the topology
+    C1->setPosition(1, 2, 3);
+    C1->setPartialCharge(0.5);
+    molecule.setName("formaldehyde");
+    QCOMPARE(molecule.topologyRevision(), revision);
+
+    molecule.removeBond(bond);
+    QVERIFY(molecule.topologyRevision() != revision);
+    revision = molecule.topologyRevision();
+
+    molecule.removeAtom(C2);
+    QVERIFY(molecule.topologyRevision() != revision);
+}
+
 void MoleculeTest::substructure()
 {
     chemkit::Molecule empty1;
@@ -53,6 +53,7 @@ class MoleculeTest : public QObject
         void bond();
         void size();
         void isEmpty();
+        void topologyRevision();
         void substructure();
         void mapping();
         void find();
@@ -0,0 +1,183 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "neighborlisttest.h"
+
+#include <set>
+
+#include <chemkit/point3.h>
+#include <chemkit/vector3.h>
+#include <chemkit/unitcell.h>
+#include <chemkit/neighborlist.h>
+
+namespace {
+
+// Returns count positions spread pseudo-randomly over [0, size) in
+// each dimension.
+std::vector<chemkit::Point3> randomPositions(int count, chemkit::Float size)
+{
+    std::vector<chemkit::Point3> positions;
+
+    for(int i = 0; i < count; i++){
+        positions.push_back(chemkit::Point3((i * 7919 % 1000) / 1000.0 * size,
+                                            (i * 104729 % 1000) / 1000.0 * size,
+                                            (i * 1299709 % 1000) / 1000.0 * size));
+    }
+
+    return positions;
+}
+
+// Returns the pairs in the neighbor list.
+std::set<std::pair<int, int> > listPairs(const chemkit::NeighborList &list)
+{
+    std::set<std::pair<int, int> > pairs;
+
+    for(int i = 0; i < list.size(); i++){
+        for(int j = 0; j < list.neighborCount(i); j++){
+            pairs.insert(std::make_pair(i, list.neighbor(i, j)));
+        }
+    }
+
+    return pairs;
+}
+
+} // end anonymous namespace
+
+void NeighborListTest::basic()
+{
+    chemkit::NeighborList list(5.0);
+    QCOMPARE(list.cutoff(), chemkit::Float(5.0));
+    QVERIFY(list.unitCell() == 0);
+
+    std::vector<chemkit::Point3> positions;
+    positions.push_back(chemkit::Point3(0, 0, 0));
+    positions.push_back(chemkit::Point3(4, 0, 0));
+    positions.push_back(chemkit::Point3(9, 0, 0));
+    positions.push_back(chemkit::Point3(0, 3, 0));
+    list.build(positions);
+
+    QCOMPARE(list.size(), 4);
+    QCOMPARE(list.pairCount(), 4);
+    QCOMPARE(list.neighborCount(0), 2);
+    QCOMPARE(list.neighbor(0, 0), 1);
+    QCOMPARE(list.neighbor(0, 1), 3);
+
+    std::vector<int> neighbors = list.neighbors(1);
+    QCOMPARE(neighbors.size(), size_t(2));
+    QCOMPARE(neighbors[0], 2);
+    QCOMPARE(neighbors[1], 3);
+
+    QCOMPARE(list.neighborCount(2), 0);
+    QCOMPARE(list.neighborCount(3), 0);
+}
+
+void NeighborListTest::empty()
+{
+    chemkit::NeighborList list(5.0);
+    list.build(std::vector<chemkit::Point3>());
+    QCOMPARE(list.size(), 0);
+    QCOMPARE(list.pairCount(), 0);
+
+    // without a cutoff there are no neighbors
+    chemkit::NeighborList zero;
+    zero.build(randomPositions(10, 5.0));
+    QCOMPARE(zero.size(), 10);
+    QCOMPARE(zero.pairCount(), 0);
+}
+
+void NeighborListTest::pairs()
+{
+    std::vector<chemkit::Point3> positions = randomPositions(500, 30.0);
+
+    chemkit::NeighborList list(6.0);
+    list.build(positions);
+    QVERIFY(list.cellCount() > 1);
+
+    std::set<std::pair<int, int> > expected;
+    for(unsigned int i = 0; i < positions.size(); i++){
+        for(unsigned int j = i + 1; j < positions.size(); j++){
+            if(positions[i].distance(positions[j]) <= 6.0){
+                expected.insert(std::make_pair(i, j));
+            }
+        }
+    }
+
+    QCOMPARE(list.pairCount(), int(expected.size()));
+    QVERIFY(listPairs(list) == expected);
+}
+
+void NeighborListTest::periodicPairs_data()
+{
+    QTest::addColumn<double>("skew");
+    QTest::addColumn<double>("cutoff");
+
+    QTest::newRow("cubic") << 0.0 << 6.0;
+    QTest::newRow("small") << 0.0 << 14.0;
+    QTest::newRow("triclinic") << 10.0 << 6.0;
+}
+
+void NeighborListTest::periodicPairs()
+{
+    QFETCH(double, skew);
+    QFETCH(double, cutoff);
+
+    chemkit::UnitCell cell(chemkit::Vector3(30, 0, 0),
+                           chemkit::Vector3(skew, 28, 0),
+                           chemkit::Vector3(-0.5 * skew, 0.8 * skew, 27));
+
+    // place positions both inside and outside of the cell
+    std::vector<chemkit::Point3> positions = randomPositions(500, 40.0);
+    for(unsigned int i = 0; i < positions.size(); i++){
+        positions[i] -= chemkit::Vector3(5, 5, 5);
+    }
+
+    chemkit::NeighborList list(cutoff);
+    list.setUnitCell(&cell);
+    list.build(positions);
+
+    std::set<std::pair<int, int> > expected;
+    for(unsigned int i = 0; i < positions.size(); i++){
+        for(unsigned int j = i + 1; j < positions.size(); j++){
+            if(cell.distance(positions[i], positions[j]) <= cutoff){
+                expected.insert(std::make_pair(i, j));
+            }
+        }
+    }
+
+    QCOMPARE(list.pairCount(), int(expected.size()));
+    QVERIFY(listPairs(list) == expected);
+}
+
+QTEST_APPLESS_MAIN(NeighborListTest)
@@ -0,0 +1,326 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "particlemeshewaldtest.h"
+
+#include <cmath>
+#include <complex>
+
+#include <chemkit/point3.h>
+#include <chemkit/vector3.h>
+#include <chemkit/unitcell.h>
+#include <chemkit/constants.h>
+#include <chemkit/neighborlist.h>
+#include <chemkit/particlemeshewald.h>
+
+namespace {
+
+const chemkit::UnitCell triclinicCell(chemkit::Vector3(20, 0, 0),
+                                      chemkit::Vector3(4, 19, 0),
+                                      chemkit::Vector3(-3, 2, 21));
+
+// Returns count pseudo-random positions inside of the triclinic
+// cell.
+std::vector<chemkit::Point3> randomPositions(int count)
+{
+    std::vector<chemkit::Point3> positions;
+
+    for(int i = 0; i < count; i++){
+        positions.push_back(chemkit::Point3(0, 0, 0) +
+                            triclinicCell.x() * ((i * 7919 % 1000) / 1000.0) +
+                            triclinicCell.y() * ((i * 104729 % 1000) / 1000.0) +
+                            triclinicCell.z() * ((i * 1299709 % 1000) / 1000.0));
+    }
+
+    return positions;
+}
+
+// Returns count charges which sum to netCharge.
+std::vector<chemkit::Float> randomCharges(int count, chemkit::Float netCharge)
+{
+    std::vector<chemkit::Float> charges;
+
+    chemkit::Float sum = 0;
+    for(int i = 0; i < count; i++){
+        charges.push_back((i * 6007 % 100) / 50.0 - 1.0);
+        sum += charges.back();
+    }
+
+    for(int i = 0; i < count; i++){
+        charges[i] += (netCharge - sum) / count;
+    }
+
+    return charges;
+}
+
+// Returns the reciprocal space energy calculated directly from the
+// Ewald sum over the reciprocal lattice vectors.
+chemkit::Float ewaldReciprocalEnergy(const chemkit::UnitCell &cell,
+                                     const std::vector<chemkit::Point3> &positions,
+                                     const std::vector<chemkit::Float> &charges,
+                                     chemkit::Float beta)
+{
+    const chemkit::Float pi = chemkit::constants::Pi;
+    const chemkit::Float volume = cell.volume();
+    const int limit = 16;
+
+    chemkit::Float determinant = cell.x().dot(cell.y().cross(cell.z()));
+    chemkit::Vector3 a = cell.y().cross(cell.z()) / determinant;
+    chemkit::Vector3 b = cell.z().cross(cell.x()) / determinant;
+    chemkit::Vector3 c = cell.x().cross(cell.y()) / determinant;
+
+    chemkit::Float energy = 0;
+    chemkit::Float totalCharge = 0;
+
+    for(unsigned int i = 0; i < charges.size(); i++){
+        totalCharge += charges[i];
+    }
+
+    for(int i = -limit; i <= limit; i++){
+        for(int j = -limit; j <= limit; j++){
+            for(int k = -limit; k <= limit; k++){
+                if(i == 0 && j == 0 && k == 0){
+                    continue;
+                }
+
+                chemkit::Vector3 m = a * chemkit::Float(i) + b * chemkit::Float(j) + c * chemkit::Float(k);
+                chemkit::Float mSquared = m.lengthSquared();
+
+                std::complex<chemkit::Float> structureFactor = 0;
+                for(unsigned int n = 0; n < positions.size(); n++){
+                    chemkit::Float angle = 2 * pi * m.dot(positions[n]);
+                    structureFactor += charges[n] * std::complex<chemkit::Float>(std::cos(angle), std::sin(angle));
+                }
+
+                energy += std::exp(-pi * pi * mSquared / (beta * beta)) / mSquared * std::norm(structureFactor);
+            }
+        }
+    }
+
+    energy /= 2 * pi * volume;
+    energy -= pi * totalCharge * totalCharge / (2 * volume * beta * beta);
+
+    return energy;
+}
+
+} // end anonymous namespace
+
+void ParticleMeshEwaldTest::basic()
+{
+    chemkit::ParticleMeshEwald pme;
+    QVERIFY(pme.unitCell() == 0);
+    QCOMPARE(pme.gridSpacing(), chemkit::Float(1.0));
+    QCOMPARE(pme.order(), 4);
+
+    pme.setOrder(6);
+    QCOMPARE(pme.order(), 6);
+    pme.setGridSpacing(0.5);
+    QCOMPARE(pme.gridSpacing(), chemkit::Float(0.5));
+    pme.setEwaldCoefficient(0.3);
+    QCOMPARE(pme.ewaldCoefficient(), chemkit::Float(0.3));
+
+    // without a unit cell there is no reciprocal space energy
+    std::vector<chemkit::Point3> positions(2);
+    positions[1] = chemkit::Point3(1, 0, 0);
+    std::vector<chemkit::Float> charges(2);
+    charges[0] = 1;
+    charges[1] = -1;
+    QCOMPARE(pme.reciprocalEnergy(positions, charges), chemkit::Float(0));
+
+    // self energy
+    QVERIFY(qAbs(pme.selfEnergy(charges) - -2 * 0.3 / std::sqrt(chemkit::constants::Pi)) < 1e-12);
+}
+
+void ParticleMeshEwaldTest::ewaldCoefficient()
+{
+    chemkit::Float beta = chemkit::ParticleMeshEwald::ewaldCoefficient(9.0, 1e-5);
+    QVERIFY(qAbs(erfc(beta * 9.0) - 1e-5) < 1e-10);
+    QVERIFY(qAbs(beta - 0.3470) < 1e-3);
+
+    // a tighter tolerance gives a larger coefficient
+    QVERIFY(chemkit::ParticleMeshEwald::ewaldCoefficient(9.0, 1e-8) > beta);
+}
+
+void ParticleMeshEwaldTest::gridDimensions()
+{
+    chemkit::UnitCell cell(chemkit::Vector3(20, 0, 0),
+                           chemkit::Vector3(0, 31, 0),
+                           chemkit::Vector3(0, 0, 7.5));
+
+    chemkit::ParticleMeshEwald pme;
+    pme.setUnitCell(&cell);
+
+    // sizes are rounded up to products of 2, 3 and 5
+    std::vector<int> dimensions = pme.gridDimensions();
+    QCOMPARE(dimensions.size(), size_t(3));
+    QCOMPARE(dimensions[0], 20);
+    QCOMPARE(dimensions[1], 32);
+    QCOMPARE(dimensions[2], 8);
+
+    pme.setGridSpacing(0.5);
+    dimensions = pme.gridDimensions();
+    QCOMPARE(dimensions[0], 40);
+    QCOMPARE(dimensions[1], 64);
+    QCOMPARE(dimensions[2], 15);
+}
+
+void ParticleMeshEwaldTest::reciprocalEnergy_data()
+{
+    QTest::addColumn<int>("order");
+    QTest::addColumn<double>("spacing");
+    QTest::addColumn<double>("netCharge");
+    QTest::addColumn<double>("tolerance");
+
+    QTest::newRow("default") << 4 << 1.0 << 0.0 << 1e-3;
+    QTest::newRow("fine") << 8 << 0.4 << 0.0 << 1e-6;
+    QTest::newRow("odd order") << 5 << 0.5 << 0.0 << 1e-4;
+    QTest::newRow("net charge") << 8 << 0.4 << 2.0 << 1e-6;
+}
+
+void ParticleMeshEwaldTest::reciprocalEnergy()
+{
+    QFETCH(int, order);
+    QFETCH(double, spacing);
+    QFETCH(double, netCharge);
+    QFETCH(double, tolerance);
+
+    std::vector<chemkit::Point3> positions = randomPositions(60);
+    std::vector<chemkit::Float> charges = randomCharges(60, netCharge);
+
+    chemkit::ParticleMeshEwald pme;
+    pme.setUnitCell(&triclinicCell);
+    pme.setEwaldCoefficient(0.35);
+    pme.setOrder(order);
+    pme.setGridSpacing(spacing);
+
+    chemkit::Float expected = ewaldReciprocalEnergy(triclinicCell, positions, charges, 0.35);
+    chemkit::Float energy = pme.reciprocalEnergy(positions, charges);
+
+    QVERIFY(qAbs(energy - expected) < tolerance * qAbs(expected));
+
+    // the energy does not depend on which periodic image is used
+    for(unsigned int i = 0; i < positions.size(); i += 3){
+        positions[i] += triclinicCell.x() - triclinicCell.z() * 2.0;
+    }
+
+    QVERIFY(qAbs(pme.reciprocalEnergy(positions, charges) - energy) < 1e-8 * qAbs(energy));
+}
+
+void ParticleMeshEwaldTest::gradient()
+{
+    std::vector<chemkit::Point3> positions = randomPositions(30);
+    std::vector<chemkit::Float> charges = randomCharges(30, 0.0);
+
+    chemkit::ParticleMeshEwald pme;
+    pme.setUnitCell(&triclinicCell);
+    pme.setEwaldCoefficient(0.35);
+    pme.setOrder(6);
+
+    std::vector<chemkit::Vector3> gradient;
+    chemkit::Float energy = pme.reciprocalEnergy(positions, charges, gradient);
+    QCOMPARE(gradient.size(), positions.size());
+    QVERIFY(qAbs(energy - pme.reciprocalEnergy(positions, charges)) < 1e-12);
+
+    // compare with central differences
+    const chemkit::Float step = 1e-5;
+
+    for(unsigned int i = 0; i < positions.size(); i += 5){
+        for(int j = 0; j < 3; j++){
+            std::vector<chemkit::Point3> forward = positions;
+            forward[i][j] += step;
+            std::vector<chemkit::Point3> backward = positions;
+            backward[i][j] -= step;
+
+            chemkit::Float numerical = (pme.reciprocalEnergy(forward, charges) -
+                                        pme.reciprocalEnergy(backward, charges)) / (2 * step);
+
+            QVERIFY(qAbs(gradient[i][j] - numerical) < 1e-6);
+        }
+    }
+}
+
+void ParticleMeshEwaldTest::madelungConstant()
+{
+    // rock salt lattice of alternating unit charges separated by 2.0
+    // angstroms in a periodic cell of 8x8x8 ions
+    const chemkit::Float spacing = 2.0;
+    chemkit::UnitCell cell(chemkit::Vector3(16, 0, 0),
+                           chemkit::Vector3(0, 16, 0),
+                           chemkit::Vector3(0, 0, 16));
+
+    std::vector<chemkit::Point3> positions;
+    std::vector<chemkit::Float> charges;
+
+    for(int i = 0; i < 8; i++){
+        for(int j = 0; j < 8; j++){
+            for(int k = 0; k < 8; k++){
+                positions.push_back(chemkit::Point3(i * spacing, j * spacing, k * spacing));
+                charges.push_back((i + j + k) % 2 ? -1 : 1);
+            }
+        }
+    }
+
+    const chemkit::Float cutoff = 7.9;
+    const chemkit::Float beta = chemkit::ParticleMeshEwald::ewaldCoefficient(cutoff, 1e-8);
+
+    chemkit::ParticleMeshEwald pme;
+    pme.setUnitCell(&cell);
+    pme.setEwaldCoefficient(beta);
+    pme.setGridSpacing(0.5);
+    pme.setOrder(8);
+
+    chemkit::Float energy = pme.reciprocalEnergy(positions, charges) + pme.selfEnergy(charges);
+
+    // real space sum over the pairs within the cutoff
+    chemkit::NeighborList neighborList(cutoff);
+    neighborList.setUnitCell(&cell);
+    neighborList.build(positions);
+
+    for(int i = 0; i < neighborList.size(); i++){
+        for(int k = 0; k < neighborList.neighborCount(i); k++){
+            int j = neighborList.neighbor(i, k);
+            chemkit::Float r = cell.distance(positions[i], positions[j]);
+
+            energy += charges[i] * charges[j] * erfc(beta * r) / r;
+        }
+    }
+
+    // the energy per ion pair is -M / r where M is the madelung
+    // constant of the rock salt lattice
+    chemkit::Float madelung = -energy / (positions.size() / 2) * spacing;
+    QVERIFY(qAbs(madelung - 1.747564594633) < 1e-5);
+}
+
+QTEST_APPLESS_MAIN(ParticleMeshEwaldTest)
@@ -0,0 +1,197 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "receptorgridtest.h"
+
+#include <chemkit/atom.h>
+#include <chemkit/bond.h>
+#include <chemkit/molecule.h>
+#include <chemkit/forcefield.h>
+#include <chemkit/scalarfield.h>
+#include <chemkit/moleculefile.h>
+#include <chemkit/receptorgrid.h>
+#include <chemkit/forcefieldatom.h>
+#include <chemkit/forcefieldcalculation.h>
+
+const std::string dataPath = "../../../data/";
+
+void ReceptorGridTest::build()
+{
+    chemkit::Molecule *uridine = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(uridine != 0);
+    chemkit::Molecule *water = chemkit::MoleculeFile::quickRead(dataPath + "water.mol");
+    QVERIFY(water != 0);
+
+    // place the water next to the atom of uridine with the largest x
+    chemkit::Atom *edgeAtom = uridine->atom(0);
+    foreach(chemkit::Atom *atom, uridine->atoms()){
+        if(atom->position().x() > edgeAtom->position().x()){
+            edgeAtom = atom;
+        }
+    }
+    chemkit::Vector3 offset = (edgeAtom->position() + chemkit::Vector3(3.2, 0.3, -0.2)) - water->atom(0)->position();
+    foreach(chemkit::Atom *atom, water->atoms()){
+        atom->setPosition(atom->position() + offset);
+    }
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField != 0);
+    forceField->addMolecule(uridine);
+    forceField->addMolecule(water);
+    QVERIFY(forceField->setup());
+
+    // assign charges to test the electrostatic map
+    for(int i = 0; i < forceField->atomCount(); i++){
+        chemkit::ForceFieldAtom *atom = forceField->atom(i);
+        if(atom->atom()->molecule() == water){
+            atom->setCharge(atom->atom()->is(chemkit::Atom::Oxygen) ? -0.8 : 0.4);
+        }
+        else{
+            atom->setCharge(i % 2 ? 0.2 : -0.2);
+        }
+    }
+
+    chemkit::ReceptorGrid grid(forceField, uridine);
+    grid.setCenter(water->atom(0)->position());
+    grid.setSize(chemkit::Vector3(8, 8, 8));
+    grid.setSpacing(0.2);
+    grid.setThreadCount(4);
+    QVERIFY(grid.build());
+    QVERIFY(grid.isBuilt());
+    QCOMPARE(grid.ligandAtomCount(), 3);
+    QCOMPARE(grid.types().size(), size_t(2));
+    QCOMPARE(grid.pointCount(), 41 * 41 * 41);
+    QVERIFY(grid.vanDerWaalsMap(grid.ligandAtoms()[0]->type()) != 0);
+    QVERIFY(grid.vanDerWaalsMap("Xx") == 0);
+    QVERIFY(grid.electrostaticMap() != 0);
+
+    // reference energy and gradient summed over every ligand-receptor
+    // pair. the van der Waals energies come from a force field for a
+    // single molecule containing both uridine and the water
+    std::vector<chemkit::ForceFieldAtom *> ligandAtoms = grid.ligandAtoms();
+    std::vector<chemkit::Point3> positions;
+    foreach(chemkit::ForceFieldAtom *atom, ligandAtoms){
+        positions.push_back(atom->position());
+    }
+
+    chemkit::Molecule complex(*uridine);
+    foreach(const chemkit::Atom *atom, water->atoms()){
+        complex.addAtomCopy(atom);
+    }
+    foreach(const chemkit::Bond *bond, water->bonds()){
+        complex.addBond(complex.atom(uridine->atomCount() + bond->atom1()->index()),
+                        complex.atom(uridine->atomCount() + bond->atom2()->index()),
+                        bond->order());
+    }
+
+    chemkit::ForceField *complexForceField = chemkit::ForceField::create("uff");
+    complexForceField->addMolecule(&complex);
+    QVERIFY(complexForceField->setup());
+
+    chemkit::Float referenceEnergy = 0;
+    std::vector<chemkit::Vector3> referenceGradient(ligandAtoms.size());
+    foreach(const chemkit::ForceFieldCalculation *calculation, complexForceField->calculations()){
+        if(calculation->type() != chemkit::ForceFieldCalculation::VanDerWaals){
+            continue;
+        }
+
+        int receptorIndex = calculation->atom(0)->index();
+        int ligandIndex = calculation->atom(1)->index() - uridine->atomCount();
+        if(ligandIndex < 0 || receptorIndex >= uridine->atomCount()){
+            continue;
+        }
+
+        referenceEnergy += calculation->energy();
+        referenceGradient[ligandIndex] += calculation->gradient()[1];
+    }
+
+    for(unsigned int i = 0; i < ligandAtoms.size(); i++){
+        const chemkit::ForceFieldAtom *ligandAtom = ligandAtoms[i];
+
+        for(int j = 0; j < uridine->atomCount(); j++){
+            const chemkit::ForceFieldAtom *receptorAtom = forceField->atom(j);
+            chemkit::Vector3 vector = positions[i] - receptorAtom->position();
+            chemkit::Float r = vector.length();
+
+            chemkit::Float qq = 332.0716 * receptorAtom->charge() * ligandAtom->charge();
+            referenceEnergy += qq / r;
+            referenceGradient[i] -= vector * (qq / (r * r * r));
+        }
+    }
+
+    delete complexForceField;
+
+    // the interpolated energy and gradient agree with the reference
+    // to within the interpolation error
+    chemkit::Float energy = grid.energy();
+    QCOMPARE(grid.energy(positions), energy);
+    QVERIFY(qAbs(energy - referenceEnergy) < 0.05);
+
+    std::vector<chemkit::Vector3> gradient = grid.gradient();
+    for(unsigned int i = 0; i < gradient.size(); i++){
+        QVERIFY((gradient[i] - referenceGradient[i]).length() < 0.1 * referenceGradient[i].length() + 0.1);
+    }
+
+    // the maps do not depend on the number of threads
+    chemkit::ReceptorGrid serialGrid(forceField, uridine);
+    serialGrid.setCenter(grid.center());
+    serialGrid.setSize(grid.size());
+    serialGrid.setSpacing(grid.spacing());
+    serialGrid.setThreadCount(1);
+    QVERIFY(serialGrid.build());
+    QVERIFY(serialGrid.electrostaticMap()->data() == grid.electrostaticMap()->data());
+    foreach(const std::string &type, grid.types()){
+        QVERIFY(serialGrid.vanDerWaalsMap(type)->data() == grid.vanDerWaalsMap(type)->data());
+    }
+
+    // atoms outside of the grid do not contribute
+    for(unsigned int i = 0; i < positions.size(); i++){
+        positions[i] += chemkit::Vector3(20, 0, 0);
+    }
+    QVERIFY(!grid.contains(positions[0]));
+    QCOMPARE(grid.energy(positions), chemkit::Float(0));
+
+    // building fails without a receptor
+    grid.setReceptor(0);
+    QVERIFY(!grid.build());
+    QVERIFY(!grid.isBuilt());
+    QVERIFY(!grid.errorString().empty());
+
+    delete forceField;
+    delete water;
+    delete uridine;
+}
+
+QTEST_APPLESS_MAIN(ReceptorGridTest)
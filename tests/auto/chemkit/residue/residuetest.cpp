@@ -36,6 +36,7 @@
 #include "residuetest.h"
 
 #include <chemkit/chemkit.h>
+#include <chemkit/atom.h>
 #include <chemkit/residue.h>
 #include <chemkit/molecule.h>
 
@@ -68,4 +69,26 @@ void ResidueTest::atomType()
     QVERIFY(residue->atom("C2") == c2);
 }
 
+void ResidueTest::atomResidue()
+{
+    chemkit::Molecule molecule;
+    chemkit::Residue *residue = new chemkit::Residue(&molecule);
+
+    chemkit::Atom *c1 = molecule.addAtom("C");
+    chemkit::Atom *c2 = molecule.addAtom("C");
+    QVERIFY(c1->residue() == 0);
+
+    residue->addAtom(c1);
+    residue->addAtom(c2);
+    QVERIFY(c1->residue() == residue);
+    QVERIFY(c2->residue() == residue);
+
+    residue->removeAtom(c1);
+    QVERIFY(c1->residue() == 0);
+    QVERIFY(c2->residue() == residue);
+
+    delete residue;
+    QVERIFY(c2->residue() == 0);
+}
+
 QTEST_APPLESS_MAIN(ResidueTest)
@@ -45,6 +45,7 @@ class ResidueTest : public QObject
     private slots:
         void molecule();
         void atomType();
+        void atomResidue();
 };
 
 #endif // RESIDUETEST_H
@@ -0,0 +1,152 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "unitcelltest.h"
+
+#include <chemkit/point3.h>
+#include <chemkit/vector3.h>
+#include <chemkit/unitcell.h>
+
+void UnitCellTest::basic()
+{
+    chemkit::UnitCell cell(chemkit::Vector3(10, 0, 0),
+                           chemkit::Vector3(0, 20, 0),
+                           chemkit::Vector3(0, 0, 30));
+    QCOMPARE(cell.x(), chemkit::Vector3(10, 0, 0));
+    QCOMPARE(cell.y(), chemkit::Vector3(0, 20, 0));
+    QCOMPARE(cell.z(), chemkit::Vector3(0, 0, 30));
+    QCOMPARE(cell.isOrthorhombic(), true);
+
+    chemkit::UnitCell triclinic(chemkit::Vector3(10, 0, 0),
+                                chemkit::Vector3(5, 10, 0),
+                                chemkit::Vector3(0, 0, 10));
+    QCOMPARE(triclinic.isOrthorhombic(), false);
+}
+
+void UnitCellTest::volume()
+{
+    chemkit::UnitCell cell(chemkit::Vector3(10, 0, 0),
+                           chemkit::Vector3(0, 20, 0),
+                           chemkit::Vector3(0, 0, 30));
+    QCOMPARE(qRound(cell.volume()), 6000);
+}
+
+void UnitCellTest::wrap()
+{
+    chemkit::UnitCell cell(chemkit::Vector3(10, 0, 0),
+                           chemkit::Vector3(0, 10, 0),
+                           chemkit::Vector3(0, 0, 10));
+
+    chemkit::Point3 position = cell.wrap(chemkit::Point3(12, -3, 25));
+    QVERIFY(qAbs(position.x() - 2) < 1e-10);
+    QVERIFY(qAbs(position.y() - 7) < 1e-10);
+    QVERIFY(qAbs(position.z() - 5) < 1e-10);
+}
+
+void UnitCellTest::minimumImage()
+{
+    chemkit::UnitCell cell(chemkit::Vector3(10, 0, 0),
+                           chemkit::Vector3(0, 20, 0),
+                           chemkit::Vector3(0, 0, 30));
+
+    chemkit::Vector3 image = cell.minimumImage(chemkit::Vector3(6, -12, 16));
+    QVERIFY(qAbs(image.x() - -4) < 1e-10);
+    QVERIFY(qAbs(image.y() - 8) < 1e-10);
+    QVERIFY(qAbs(image.z() - -14) < 1e-10);
+
+    // vectors shorter than half of the cell are unchanged
+    image = cell.minimumImage(chemkit::Vector3(4, -9, 14));
+    QVERIFY(qAbs(image.x() - 4) < 1e-10);
+    QVERIFY(qAbs(image.y() - -9) < 1e-10);
+    QVERIFY(qAbs(image.z() - 14) < 1e-10);
+
+    // image of a position closest to a reference position
+    chemkit::Point3 position = cell.image(chemkit::Point3(9, 1, 1), chemkit::Point3(1, 1, 1));
+    QVERIFY(qAbs(position.x() - -1) < 1e-10);
+    QVERIFY(qAbs(position.y() - 1) < 1e-10);
+    QVERIFY(qAbs(position.z() - 1) < 1e-10);
+
+    // a cell without volume is not periodic
+    chemkit::UnitCell empty;
+    image = empty.minimumImage(chemkit::Vector3(6, -12, 16));
+    QCOMPARE(image, chemkit::Vector3(6, -12, 16));
+}
+
+void UnitCellTest::triclinicMinimumImage()
+{
+    chemkit::UnitCell cell(chemkit::Vector3(10, 0, 0),
+                           chemkit::Vector3(7, 9, 0),
+                           chemkit::Vector3(-4, 3, 8));
+
+    // compare with the shortest image from a brute force search
+    for(int n = 0; n < 200; n++){
+        chemkit::Vector3 vector((n * 7919 % 400) / 20.0 - 10,
+                                (n * 104729 % 400) / 20.0 - 10,
+                                (n * 1299709 % 400) / 20.0 - 10);
+
+        chemkit::Float shortest = vector.length();
+        for(int i = -4; i <= 4; i++){
+            for(int j = -4; j <= 4; j++){
+                for(int k = -4; k <= 4; k++){
+                    chemkit::Vector3 candidate = vector + cell.x() * chemkit::Float(i)
+                                                        + cell.y() * chemkit::Float(j)
+                                                        + cell.z() * chemkit::Float(k);
+                    shortest = qMin(shortest, candidate.length());
+                }
+            }
+        }
+
+        chemkit::Vector3 image = cell.minimumImage(vector);
+        QVERIFY(qAbs(image.length() - shortest) < 1e-8);
+
+        // the image differs from the vector by a lattice vector
+        chemkit::Vector3 difference = image - vector;
+        chemkit::Point3 wrapped = cell.wrap(chemkit::Point3(difference.x(), difference.y(), difference.z()) + chemkit::Vector3(0.5, 0.5, 0.5));
+        QVERIFY(wrapped.distance(chemkit::Point3(0.5, 0.5, 0.5)) < 1e-8);
+    }
+}
+
+void UnitCellTest::distance()
+{
+    chemkit::UnitCell cell(chemkit::Vector3(10, 0, 0),
+                           chemkit::Vector3(0, 10, 0),
+                           chemkit::Vector3(0, 0, 10));
+
+    QVERIFY(qAbs(cell.distance(chemkit::Point3(1, 1, 1), chemkit::Point3(9, 1, 1)) - 2) < 1e-10);
+    QVERIFY(qAbs(cell.distance(chemkit::Point3(1, 1, 1), chemkit::Point3(9, 9, 9)) - std::sqrt(12.0)) < 1e-10);
+    QVERIFY(qAbs(cell.distance(chemkit::Point3(1, 1, 1), chemkit::Point3(4, 1, 1)) - 3) < 1e-10);
+}
+
+QTEST_APPLESS_MAIN(UnitCellTest)
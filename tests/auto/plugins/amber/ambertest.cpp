@@ -37,10 +37,18 @@
 
 #include <algorithm>
 
+#include <chemkit/atom.h>
+#include <chemkit/polymer.h>
+#include <chemkit/residue.h>
 #include <chemkit/molecule.h>
+#include <chemkit/unitcell.h>
 #include <chemkit/forcefield.h>
+#include <chemkit/polymerfile.h>
+#include <chemkit/polymerchain.h>
 #include <chemkit/moleculefile.h>
+#include <chemkit/bondpredictor.h>
 #include <chemkit/forcefieldatom.h>
+#include <chemkit/forcefieldcalculation.h>
 
 const std::string dataPath = "../../../data/";
 
@@ -104,8 +112,8 @@ void AmberTest::adenosine()
     QCOMPARE(atoms[30]->type(), std::string("H"));
     QCOMPARE(atoms[31]->type(), std::string("H"));
 
-    QCOMPARE(forceField->calculationCount(), 585);
-    QCOMPARE(qRound(forceField->energy()), 1460);
+    QCOMPARE(forceField->calculationCount(), 992);
+    QCOMPARE(qRound(forceField->energy()), 165);
 
     delete forceField;
 }
@@ -146,8 +154,8 @@ void AmberTest::serine()
     QCOMPARE(atoms[12]->type(), std::string("H"));
     QCOMPARE(atoms[13]->type(), std::string("H"));
 
-    QCOMPARE(forceField->calculationCount(), 118);
-    QCOMPARE(qRound(forceField->energy()), 322);
+    QCOMPARE(forceField->calculationCount(), 175);
+    QCOMPARE(qRound(forceField->energy()), 10);
 
     delete forceField;
 }
@@ -178,7 +186,219 @@ void AmberTest::water()
 
     QCOMPARE(forceField->calculationCount(), 3);
 
-    QCOMPARE(qRound(forceField->energy()), 21085);
+    QCOMPARE(qRound(forceField->energy()), 8);
+
+    delete forceField;
+}
+
+void AmberTest::enkephalin()
+{
+    // met-enkephalin (Tyr-Gly-Gly-Phe-Met) with hydrogens
+    chemkit::PolymerFile file(dataPath + "1PLX.pdb");
+    QVERIFY(file.read());
+
+    chemkit::Polymer *protein = file.polymer();
+    QVERIFY(protein != 0);
+    QCOMPARE(protein->atomCount(), 75);
+    chemkit::BondPredictor::predictBonds(protein);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("amber");
+    QVERIFY(forceField != 0);
+
+    forceField->addMolecule(protein);
+    QVERIFY(forceField->setup());
+
+    // the atoms are typed from the residue templates including the
+    // charged amino (NTYR) and carboxylate (CMET) groups
+    const chemkit::PolymerChain *chain = protein->chain(0);
+    QCOMPARE(chain->residueCount(), 5);
+
+    const chemkit::Residue *tyrosine = chain->residue(0);
+    QCOMPARE(forceField->atom(tyrosine->atom("N"))->type(), std::string("N3"));
+    QCOMPARE(forceField->atom(tyrosine->atom("H1"))->type(), std::string("H"));
+    QCOMPARE(forceField->atom(tyrosine->atom("HA"))->type(), std::string("HP"));
+    QCOMPARE(forceField->atom(tyrosine->atom("CZ"))->type(), std::string("C"));
+    QCOMPARE(forceField->atom(tyrosine->atom("OH"))->type(), std::string("OH"));
+    QCOMPARE(forceField->atom(tyrosine->atom("CZ"))->charge(), chemkit::Float(0.3226));
+
+    const chemkit::Residue *methionine = chain->residue(4);
+    QCOMPARE(forceField->atom(methionine->atom("SD"))->type(), std::string("S"));
+    QCOMPARE(forceField->atom(methionine->atom("O"))->type(), std::string("O2"));
+    QCOMPARE(forceField->atom(methionine->atom("OXT"))->type(), std::string("O2"));
+
+    // both glycines are stamped from the same template
+    const chemkit::Residue *glycine2 = chain->residue(1);
+    const chemkit::Residue *glycine3 = chain->residue(2);
+    foreach(const chemkit::Atom *atom, glycine2->atoms()){
+        const chemkit::ForceFieldAtom *a = forceField->atom(atom);
+        const chemkit::ForceFieldAtom *b = forceField->atom(glycine3->atom(glycine2->atomType(atom)));
+        QCOMPARE(a->type(), b->type());
+        QCOMPARE(a->charge(), b->charge());
+    }
+
+    // the terminal charges cancel
+    chemkit::Float charge = 0;
+    foreach(const chemkit::ForceFieldAtom *atom, forceField->atoms()){
+        charge += atom->charge();
+    }
+    QVERIFY(qAbs(charge) < 1e-6);
+
+    // the energy of each term matches a reference calculation of the
+    // sander functional forms with the parameters from parm99.dat for
+    // the same atom types, charges and coordinates
+    chemkit::Float bondEnergy = 0;
+    chemkit::Float angleEnergy = 0;
+    chemkit::Float torsionEnergy = 0;
+    chemkit::Float improperEnergy = 0;
+    chemkit::Float vanDerWaalsEnergy = 0;
+    chemkit::Float electrostaticEnergy = 0;
+    chemkit::Float oneFourVanDerWaalsEnergy = 0;
+    chemkit::Float oneFourElectrostaticEnergy = 0;
+    foreach(const chemkit::ForceFieldCalculation *calculation, forceField->calculations()){
+        chemkit::Float energy = calculation->energy();
+
+        switch(calculation->type()){
+            case chemkit::ForceFieldCalculation::BondStrech:
+                bondEnergy += energy;
+                break;
+            case chemkit::ForceFieldCalculation::AngleBend:
+                angleEnergy += energy;
+                break;
+            case chemkit::ForceFieldCalculation::Torsion:
+                torsionEnergy += energy;
+                break;
+            case chemkit::ForceFieldCalculation::Inversion:
+                improperEnergy += energy;
+                break;
+            case chemkit::ForceFieldCalculation::VanDerWaals:
+                if(calculation->atom(0)->isOneFour(calculation->atom(1))){
+                    oneFourVanDerWaalsEnergy += energy;
+                }
+                else{
+                    vanDerWaalsEnergy += energy;
+                }
+                break;
+            case chemkit::ForceFieldCalculation::Electrostatic:
+                if(calculation->atom(0)->isOneFour(calculation->atom(1))){
+                    oneFourElectrostaticEnergy += energy;
+                }
+                else{
+                    electrostaticEnergy += energy;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    QVERIFY(qAbs(bondEnergy - 6.0670) < 1e-3);
+    QVERIFY(qAbs(angleEnergy - 2.4744) < 1e-3);
+    QVERIFY(qAbs(torsionEnergy - 30.1696) < 1e-3);
+    QVERIFY(qAbs(improperEnergy - 0.0010) < 1e-3);
+    QVERIFY(qAbs(vanDerWaalsEnergy + 10.3297) < 1e-3);
+    QVERIFY(qAbs(electrostaticEnergy + 354.5508) < 1e-3);
+    QVERIFY(qAbs(oneFourVanDerWaalsEnergy - 26.0288) < 1e-3);
+    QVERIFY(qAbs(oneFourElectrostaticEnergy - 323.3275) < 1e-3);
+    QVERIFY(qAbs(forceField->energy() - 23.1879) < 1e-3);
+
+    std::vector<chemkit::Vector3> analyticalGradient = forceField->gradient();
+    forceField->setNumericalGradientMethod(chemkit::ForceField::CentralDifference);
+    std::vector<chemkit::Vector3> numericalGradient = forceField->numericalGradient();
+    for(unsigned int i = 0; i < analyticalGradient.size(); i++){
+        QVERIFY((numericalGradient[i] - analyticalGradient[i]).length() < 1e-3);
+    }
+
+    delete forceField;
+}
+
+void AmberTest::ubiquitin()
+{
+    chemkit::PolymerFile file(dataPath + "1D3Z.pdb");
+    QVERIFY(file.read());
+
+    chemkit::Polymer *protein = file.polymer();
+    QVERIFY(protein != 0);
+    QCOMPARE(protein->atomCount(), 1231);
+    chemkit::BondPredictor::predictBonds(protein);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("amber");
+    QVERIFY(forceField != 0);
+
+    forceField->addMolecule(protein);
+    QVERIFY(forceField->setup());
+
+    // every atom is in a residue template and the charged side
+    // chains (7 lysines, 4 arginines, 5 aspartates and 6 glutamates)
+    // and termini give a neutral protein
+    chemkit::Float charge = 0;
+    foreach(const chemkit::ForceFieldAtom *atom, forceField->atoms()){
+        QVERIFY(atom->charge() != 0);
+        charge += atom->charge();
+    }
+    QVERIFY(qAbs(charge) < 1e-6);
+
+    // histidine 68 is protonated on the delta nitrogen (HID)
+    const chemkit::Residue *histidine = protein->chain(0)->residue(67);
+    QCOMPARE(forceField->atom(histidine->atom("ND1"))->type(), std::string("NA"));
+    QCOMPARE(forceField->atom(histidine->atom("NE2"))->type(), std::string("NB"));
+
+    delete forceField;
+}
+
+// The particleMeshEwald() test checks that the electrostatic
+// calculations of the protein ubiquitin (PDB ID: 1UBQ) are replaced
+// by the particle mesh Ewald sum instead of being added to it.
+void AmberTest::particleMeshEwald()
+{
+    chemkit::PolymerFile file(dataPath + "1UBQ.pdb");
+    QVERIFY(file.read());
+
+    chemkit::Polymer *protein = file.polymer();
+    QVERIFY(protein != 0);
+    chemkit::BondPredictor::predictBonds(protein);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("amber");
+    QVERIFY(forceField != 0);
+    forceField->addMolecule(protein);
+    QVERIFY(forceField->setup());
+
+    // the structure has no hydrogens so the heavy atom charges are
+    // shifted to make the protein neutral
+    chemkit::Float charge = 0;
+    foreach(const chemkit::ForceFieldAtom *atom, forceField->atoms()){
+        charge += atom->charge();
+    }
+    foreach(chemkit::ForceFieldAtom *atom, forceField->atoms()){
+        atom->setCharge(atom->charge() - charge / forceField->atomCount());
+    }
+
+    // energy of the electrostatic calculations which are replaced by
+    // the method and of all other (bonded, van der Waals and 1-4
+    // electrostatic) calculations
+    chemkit::Float replacedEnergy = 0;
+    chemkit::Float keptEnergy = 0;
+    foreach(const chemkit::ForceFieldCalculation *calculation, forceField->calculations()){
+        if(calculation->type() == chemkit::ForceFieldCalculation::Electrostatic &&
+           !calculation->atom(0)->isOneFour(calculation->atom(1))){
+            replacedEnergy += calculation->energy();
+        }
+        else{
+            keptEnergy += calculation->energy();
+        }
+    }
+    QVERIFY(qAbs(forceField->energy() - (keptEnergy + replacedEnergy)) < 1e-6 * qAbs(replacedEnergy));
+
+    // in a box much larger than the protein the interactions with the
+    // periodic images are small and the particle mesh Ewald sum is
+    // close to the sum over the replaced pairs
+    chemkit::UnitCell cell(chemkit::Vector3(80, 0, 0),
+                           chemkit::Vector3(0, 80, 0),
+                           chemkit::Vector3(0, 0, 80));
+    forceField->setUnitCell(&cell);
+    forceField->setElectrostaticsMethod(chemkit::ForceField::ParticleMeshEwald);
+
+    chemkit::Float energy = forceField->energy();
+    QVERIFY(qAbs(energy - (keptEnergy + replacedEnergy)) < 0.01 * qAbs(replacedEnergy));
 
     delete forceField;
 }
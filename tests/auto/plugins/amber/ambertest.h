@@ -47,6 +47,9 @@ class AmberTest : public QObject
         void adenosine();
         void serine();
         void water();
+        void enkephalin();
+        void ubiquitin();
+        void particleMeshEwald();
 };
 
 #endif // AMBERTEST_H
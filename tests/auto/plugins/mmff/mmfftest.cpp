@@ -37,16 +37,71 @@
 
 #include <QtXml>
 
+#include <cmath>
 #include <algorithm>
 
+#include <chemkit/atom.h>
+#include <chemkit/bond.h>
+#include <chemkit/polymer.h>
+#include <chemkit/residue.h>
 #include <chemkit/molecule.h>
+#include <chemkit/unitcell.h>
 #include <chemkit/atomtyper.h>
 #include <chemkit/forcefield.h>
+#include <chemkit/polymerfile.h>
 #include <chemkit/moleculefile.h>
+#include <chemkit/bondpredictor.h>
+#include <chemkit/forcefieldatom.h>
+#include <chemkit/forcefieldminimizer.h>
+#include <chemkit/moleculardynamics.h>
+#include <chemkit/binaryparameterfile.h>
 #include <chemkit/partialchargepredictor.h>
 
 const std::string dataPath = "../../../data/";
 
+namespace {
+
+// Returns the electrostatic gradient of the force field by removing
+// the gradient of the other terms which is found by evaluating the
+// force field with all of the atom charges set to zero.
+std::vector<chemkit::Vector3> electrostaticGradient(chemkit::ForceField *forceField)
+{
+    std::vector<chemkit::Vector3> gradient = forceField->gradient();
+
+    std::vector<chemkit::Float> charges;
+    for(int i = 0; i < forceField->atomCount(); i++){
+        charges.push_back(forceField->atom(i)->charge());
+        forceField->atom(i)->setCharge(0);
+    }
+
+    std::vector<chemkit::Vector3> otherGradient = forceField->gradient();
+
+    for(int i = 0; i < forceField->atomCount(); i++){
+        forceField->atom(i)->setCharge(charges[i]);
+        gradient[i] -= otherGradient[i];
+    }
+
+    return gradient;
+}
+
+// Returns the root mean square difference between the two gradients
+// relative to the root mean square of the reference gradient.
+chemkit::Float relativeError(const std::vector<chemkit::Vector3> &gradient,
+                             const std::vector<chemkit::Vector3> &reference)
+{
+    chemkit::Float error = 0;
+    chemkit::Float norm = 0;
+
+    for(unsigned int i = 0; i < gradient.size(); i++){
+        error += (gradient[i] - reference[i]).lengthSquared();
+        norm += reference[i].lengthSquared();
+    }
+
+    return std::sqrt(error / norm);
+}
+
+} // end anonymous namespace
+
 void MmffTest::initTestCase()
 {
     std::vector<std::string> typers = chemkit::AtomTyper::typers();
@@ -184,4 +239,647 @@ void MmffTest::validate()
     QCOMPARE(failedMolecules.size(), 0);
 }
 
+void MmffTest::binaryParameters()
+{
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    // setup with the text parameter file
+    chemkit::ForceField *text = chemkit::ForceField::create("mmff");
+    QVERIFY(text != 0);
+    text->addMolecule(molecule);
+    QVERIFY(text->setup());
+
+    // the text file is compiled into the parameter cache
+    std::string binaryFileName = chemkit::BinaryParameterFile::cacheFileName(text->parameterFile());
+    QVERIFY(chemkit::BinaryParameterFile::isBinaryParameterFile(binaryFileName));
+
+    // setup with the binary parameter file
+    chemkit::ForceField *binary = chemkit::ForceField::create("mmff");
+    QVERIFY(binary != 0);
+    binary->setParameterFile(binaryFileName);
+    binary->addMolecule(molecule);
+    QVERIFY(binary->setup());
+
+    QCOMPARE(binary->energy(), text->energy());
+
+    delete text;
+    delete binary;
+    delete molecule;
+}
+
+void MmffTest::typeCache()
+{
+    chemkit::Molecule molecule("C=C", "smiles");
+    QCOMPARE(molecule.atomCount(), 6);
+
+    chemkit::AtomTyper *typer = chemkit::AtomTyper::create("mmff");
+    QVERIFY(typer != 0);
+    typer->setMolecule(&molecule);
+    QCOMPARE(typer->typeNumber(molecule.atom(0)), 2);
+    QCOMPARE(typer->typeNumber(molecule.atom(1)), 2);
+
+    // a second typer reuses the cached types
+    chemkit::AtomTyper *cachedTyper = chemkit::AtomTyper::create("mmff");
+    QVERIFY(cachedTyper != 0);
+    cachedTyper->setMolecule(&molecule);
+    for(int i = 0; i < molecule.atomCount(); i++){
+        QCOMPARE(cachedTyper->typeNumber(molecule.atom(i)), typer->typeNumber(molecule.atom(i)));
+    }
+
+    // changing the topology invalidates the cached types
+    molecule.bond(0)->setOrder(chemkit::Bond::Single);
+    molecule.addBond(molecule.atom(0), molecule.addAtom("H"));
+    molecule.addBond(molecule.atom(1), molecule.addAtom("H"));
+    cachedTyper->setMolecule(&molecule);
+    QCOMPARE(cachedTyper->typeNumber(molecule.atom(0)), 1);
+    QCOMPARE(cachedTyper->typeNumber(molecule.atom(1)), 1);
+
+    // the force field uses the same types
+    chemkit::ForceField *forceField = chemkit::ForceField::create("mmff");
+    QVERIFY(forceField != 0);
+    forceField->addMolecule(&molecule);
+    forceField->setup();
+    QCOMPARE(forceField->atom(0)->type(), std::string("1"));
+
+    // changing a partial charge invalidates the cached types
+    chemkit::Molecule ion;
+    chemkit::Atom *iron = ion.addAtom("Fe");
+    iron->setPartialCharge(3);
+    typer->setMolecule(&ion);
+    QCOMPARE(typer->typeNumber(iron), 88);
+
+    iron->setPartialCharge(2);
+    cachedTyper->setMolecule(&ion);
+    QCOMPARE(cachedTyper->typeNumber(iron), 87);
+
+    delete forceField;
+    delete cachedTyper;
+    delete typer;
+}
+
+void MmffTest::hessian()
+{
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("mmff");
+    QVERIFY(forceField != 0);
+    forceField->addMolecule(molecule);
+    QVERIFY(forceField->setup());
+
+    // the analytical hessian of each calculation agrees with central
+    // differences of its gradient
+    foreach(const chemkit::ForceFieldCalculation *calculation, forceField->calculations()){
+        chemkit::Matrix analytical = calculation->hessian();
+        chemkit::Matrix numerical = calculation->numericalHessian();
+
+        for(int i = 0; i < analytical.rowCount(); i++){
+            for(int j = 0; j < analytical.columnCount(); j++){
+                QVERIFY(qAbs(analytical(i, j) - numerical(i, j)) < 1e-4 * qMax(1.0, qAbs(numerical(i, j))));
+            }
+        }
+    }
+
+    // the hessian agrees with the numerical hessian both with the
+    // force field's electrostatics and with the damped shifted force
+    // electrostatics (whose contribution is calculated numerically)
+    int size = 3 * forceField->atomCount();
+
+    for(int method = 0; method < 2; method++){
+        if(method == 1){
+            forceField->setElectrostaticsMethod(chemkit::ForceField::DampedShiftedForce);
+            forceField->setElectrostaticsCutoff(8.0);
+        }
+
+        chemkit::Matrix hessian = forceField->hessian();
+        chemkit::Matrix numericalHessian = forceField->numericalHessian();
+        QCOMPARE(hessian.rowCount(), size);
+
+        for(int i = 0; i < size; i++){
+            for(int j = 0; j < size; j++){
+                QVERIFY(qAbs(hessian(i, j) - numericalHessian(i, j)) < 1e-3 * qMax(1.0, qAbs(hessian(i, j))));
+            }
+        }
+    }
+
+    delete forceField;
+    delete molecule;
+}
+
+void MmffTest::linearHessian()
+{
+    // acetonitrile with a linear c-c-n angle
+    chemkit::Molecule molecule;
+    chemkit::Atom *nitrogen = molecule.addAtom("N");
+    chemkit::Atom *carbon = molecule.addAtom("C");
+    chemkit::Atom *methyl = molecule.addAtom("C");
+    molecule.addBond(nitrogen, carbon, chemkit::Bond::Triple);
+    molecule.addBond(carbon, methyl);
+    nitrogen->setPosition(-1.16, 0, 0);
+    carbon->setPosition(0, 0, 0);
+    methyl->setPosition(1.46, 0, 0);
+
+    for(int i = 0; i < 3; i++){
+        chemkit::Atom *hydrogen = molecule.addAtom("H");
+        molecule.addBond(methyl, hydrogen);
+        hydrogen->setPosition(1.82, 1.03 * cos(2.0944 * i), 1.03 * sin(2.0944 * i));
+    }
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("mmff");
+    QVERIFY(forceField != 0);
+    forceField->addMolecule(&molecule);
+    QVERIFY(forceField->setup());
+
+    // the hessian of the linear angle is finite and agrees with
+    // central differences of its gradient
+    int linearAngleCount = 0;
+
+    foreach(const chemkit::ForceFieldCalculation *calculation, forceField->calculations()){
+        if(calculation->type() != chemkit::ForceFieldCalculation::AngleBend ||
+           calculation->atom(1)->atom() != carbon){
+            continue;
+        }
+
+        linearAngleCount++;
+
+        chemkit::Matrix analytical = calculation->hessian();
+        chemkit::Matrix numerical = calculation->numericalHessian();
+
+        for(int i = 0; i < analytical.rowCount(); i++){
+            for(int j = 0; j < analytical.columnCount(); j++){
+                QVERIFY(qAbs(analytical(i, j) - numerical(i, j)) < 1e-4 * qMax(1.0, qAbs(numerical(i, j))));
+            }
+        }
+    }
+
+    QCOMPARE(linearAngleCount, 1);
+
+    delete forceField;
+}
+
+void MmffTest::particleMeshEwald()
+{
+    // periodic box of 64 slightly displaced water molecules
+    chemkit::Molecule molecule;
+    for(int i = 0; i < 4; i++){
+        for(int j = 0; j < 4; j++){
+            for(int k = 0; k < 4; k++){
+                int n = molecule.atomCount();
+                chemkit::Point3 center(i * 3.1 + (n * 7919 % 100) / 200.0,
+                                       j * 3.1 + (n * 104729 % 100) / 200.0,
+                                       k * 3.1 + (n * 1299709 % 100) / 200.0);
+
+                chemkit::Atom *oxygen = molecule.addAtom("O");
+                chemkit::Atom *hydrogen1 = molecule.addAtom("H");
+                chemkit::Atom *hydrogen2 = molecule.addAtom("H");
+                oxygen->setPosition(center);
+                hydrogen1->setPosition(center + chemkit::Vector3(0.96, 0, 0));
+                hydrogen2->setPosition(center + chemkit::Vector3(-0.24, 0.93, 0.05 * (i - j)));
+                molecule.addBond(oxygen, hydrogen1);
+                molecule.addBond(oxygen, hydrogen2);
+            }
+        }
+    }
+
+    chemkit::UnitCell cell(chemkit::Vector3(12.4, 0, 0),
+                           chemkit::Vector3(0, 12.4, 0),
+                           chemkit::Vector3(0, 0, 12.4));
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("mmff");
+    QVERIFY(forceField != 0);
+    forceField->addMolecule(&molecule);
+    QVERIFY(forceField->setup());
+    QCOMPARE(forceField->electrostaticsMethod(), chemkit::ForceField::Coulomb);
+
+    // without a unit cell the method has no effect
+    chemkit::Float coulombEnergy = forceField->energy();
+    forceField->setElectrostaticsMethod(chemkit::ForceField::ParticleMeshEwald);
+    QCOMPARE(forceField->electrostaticsMethod(), chemkit::ForceField::ParticleMeshEwald);
+    QCOMPARE(forceField->energy(), coulombEnergy);
+
+    forceField->setUnitCell(&cell);
+    forceField->setElectrostaticsCutoff(6.0);
+    QCOMPARE(forceField->electrostaticsCutoff(), chemkit::Float(6.0));
+    chemkit::Float energy = forceField->energy();
+    QVERIFY(energy != coulombEnergy);
+
+    // the analytical gradient matches the numerical gradient
+    std::vector<chemkit::Vector3> gradient = forceField->gradient();
+    const chemkit::Float step = 1e-5;
+
+    for(int i = 0; i < forceField->atomCount(); i += 17){
+        chemkit::ForceFieldAtom *atom = forceField->atom(i);
+        chemkit::Point3 position = atom->position();
+
+        for(int j = 0; j < 3; j++){
+            chemkit::Point3 forward = position;
+            forward[j] += step;
+            atom->setPosition(forward);
+            chemkit::Float forwardEnergy = forceField->energy();
+
+            chemkit::Point3 backward = position;
+            backward[j] -= step;
+            atom->setPosition(backward);
+            chemkit::Float backwardEnergy = forceField->energy();
+
+            atom->setPosition(position);
+
+            chemkit::Float numerical = (forwardEnergy - backwardEnergy) / (2 * step);
+            QVERIFY(qAbs(gradient[i][j] - numerical) < 1e-4);
+        }
+    }
+
+    // the energy converges with finer grids and higher orders
+    forceField->setEwaldGridSpacing(0.4);
+    forceField->setEwaldOrder(8);
+    QCOMPARE(forceField->ewaldGridSpacing(), chemkit::Float(0.4));
+    QCOMPARE(forceField->ewaldOrder(), 8);
+    chemkit::Float converged = forceField->energy();
+    QVERIFY(qAbs(energy - converged) < 0.01 * qAbs(converged));
+
+    forceField->setEwaldGridSpacing(0.5);
+    forceField->setEwaldOrder(6);
+    QVERIFY(qAbs(forceField->energy() - converged) < 0.05);
+
+    delete forceField;
+}
+
+void MmffTest::cutoffElectrostatics_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::addColumn<double>("parameter");
+
+    QTest::newRow("reaction field") << int(chemkit::ForceField::ReactionField) << 78.5;
+    QTest::newRow("damped shifted force") << int(chemkit::ForceField::DampedShiftedForce) << 0.1;
+}
+
+// The cutoffElectrostatics() test compares the electrostatic forces
+// calculated with the cutoff methods for a cluster of uridine
+// molecules to the forces calculated from the sum over all pairs.
+void MmffTest::cutoffElectrostatics()
+{
+    QFETCH(int, method);
+    QFETCH(double, parameter);
+
+    chemkit::Molecule *uridine = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(uridine != 0);
+
+    // 3x3x3 grid of copies of uridine. every other copy is inverted
+    // so that the dipoles of neighboring molecules do not line up
+    std::vector<chemkit::Molecule *> molecules;
+    chemkit::Point3 center = uridine->center();
+    for(int i = 0; i < 3; i++){
+        for(int j = 0; j < 3; j++){
+            for(int k = 0; k < 3; k++){
+                chemkit::Molecule *molecule = new chemkit::Molecule(*uridine);
+                chemkit::Float sign = (i + j + k) % 2 ? -1 : 1;
+
+                foreach(chemkit::Atom *atom, molecule->atoms()){
+                    chemkit::Vector3 offset = (atom->position() - center) * sign;
+                    atom->setPosition(center + offset + chemkit::Vector3(i * 12.0, j * 12.0, k * 12.0));
+                }
+
+                molecules.push_back(molecule);
+            }
+        }
+    }
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("mmff");
+    QVERIFY(forceField != 0);
+    foreach(const chemkit::Molecule *molecule, molecules){
+        forceField->addMolecule(molecule);
+    }
+    QVERIFY(forceField->setup());
+
+    // reference gradient summed over every pair of atoms separated by
+    // more than three bonds
+    std::vector<chemkit::Vector3> reference(forceField->atomCount());
+    chemkit::Float referenceEnergy = 0;
+    chemkit::Float chargeProductSum = 0;
+    for(int i = 0; i < forceField->atomCount(); i++){
+        const chemkit::ForceFieldAtom *a = forceField->atom(i);
+
+        QSet<const chemkit::Atom *> excluded;
+        QList<const chemkit::Atom *> shell;
+        shell.append(a->atom());
+        for(int depth = 0; depth < 3; depth++){
+            QList<const chemkit::Atom *> nextShell;
+            foreach(const chemkit::Atom *shellAtom, shell){
+                foreach(const chemkit::Atom *neighbor, shellAtom->neighbors()){
+                    if(!excluded.contains(neighbor)){
+                        excluded.insert(neighbor);
+                        nextShell.append(neighbor);
+                    }
+                }
+            }
+            shell = nextShell;
+        }
+
+        for(int j = i + 1; j < forceField->atomCount(); j++){
+            const chemkit::ForceFieldAtom *b = forceField->atom(j);
+            if(excluded.contains(b->atom())){
+                continue;
+            }
+
+            chemkit::Float qq = 332.0716 * a->charge() * b->charge();
+            chemkit::Vector3 vector = b->position() - a->position();
+            chemkit::Float r = vector.length();
+
+            referenceEnergy += qq / r;
+            chargeProductSum += qq;
+
+            chemkit::Vector3 force = vector * (-qq / (r * r * r));
+            reference[i] -= force;
+            reference[j] += force;
+        }
+    }
+
+    // without a dielectric continuum and with a cutoff larger than the
+    // protein the reaction field reproduces the reference forces and
+    // only shifts the energy
+    forceField->setElectrostaticsMethod(chemkit::ForceField::ReactionField);
+    forceField->setReactionFieldDielectric(1.0);
+    forceField->setElectrostaticsCutoff(100.0);
+    QVERIFY(relativeError(electrostaticGradient(forceField), reference) < 1e-8);
+
+    chemkit::Float energy = forceField->energy();
+    for(int i = 0; i < forceField->atomCount(); i++){
+        forceField->atom(i)->setCharge(0);
+    }
+    chemkit::Float expectedEnergy = forceField->energy() + referenceEnergy - chargeProductSum / 100.0;
+    QVERIFY(qAbs(energy - expectedEnergy) < 1e-6 * qAbs(referenceEnergy));
+
+    delete forceField;
+
+    // the error of the method decreases as the cutoff is increased
+    forceField = chemkit::ForceField::create("mmff");
+    foreach(const chemkit::Molecule *molecule, molecules){
+        forceField->addMolecule(molecule);
+    }
+    QVERIFY(forceField->setup());
+
+    forceField->setElectrostaticsMethod(static_cast<chemkit::ForceField::ElectrostaticsMethod>(method));
+    forceField->setReactionFieldDielectric(parameter);
+    forceField->setElectrostaticsDamping(parameter);
+
+    chemkit::Float previousError = 1.0;
+    const chemkit::Float cutoffs[] = { 9.0, 12.0, 15.0, 20.0 };
+    for(int i = 0; i < 4; i++){
+        forceField->setElectrostaticsCutoff(cutoffs[i]);
+        chemkit::Float error = relativeError(electrostaticGradient(forceField), reference);
+        QVERIFY(error < previousError);
+        previousError = error;
+    }
+    QVERIFY(previousError < 0.25);
+
+    // the analytical gradient matches the numerical gradient
+    forceField->setElectrostaticsCutoff(9.0);
+    std::vector<chemkit::Vector3> gradient = forceField->gradient();
+    const chemkit::Float step = 1e-5;
+
+    for(int i = 0; i < forceField->atomCount(); i += 97){
+        chemkit::ForceFieldAtom *atom = forceField->atom(i);
+        chemkit::Point3 position = atom->position();
+
+        for(int j = 0; j < 3; j++){
+            chemkit::Point3 forward = position;
+            forward[j] += step;
+            atom->setPosition(forward);
+            chemkit::Float forwardEnergy = forceField->energy();
+
+            chemkit::Point3 backward = position;
+            backward[j] -= step;
+            atom->setPosition(backward);
+            chemkit::Float backwardEnergy = forceField->energy();
+
+            atom->setPosition(position);
+
+            chemkit::Float numerical = (forwardEnergy - backwardEnergy) / (2 * step);
+            QVERIFY(qAbs(gradient[i][j] - numerical) < 1e-3 * qMax(chemkit::Float(1.0), qAbs(numerical)));
+        }
+    }
+
+    delete forceField;
+    foreach(chemkit::Molecule *molecule, molecules){
+        delete molecule;
+    }
+    delete uridine;
+}
+
+void MmffTest::cutoffElectrostaticsDynamics_data()
+{
+    QTest::addColumn<int>("method");
+
+    QTest::newRow("reaction field") << int(chemkit::ForceField::ReactionField);
+    QTest::newRow("damped shifted force") << int(chemkit::ForceField::DampedShiftedForce);
+}
+
+// The cutoffElectrostaticsDynamics() test checks that the total energy
+// of a cluster of water molecules is conserved as well with the cutoff
+// methods as with the sum over all pairs during a short simulation
+// in which many pairs cross the cutoff.
+void MmffTest::cutoffElectrostaticsDynamics()
+{
+    QFETCH(int, method);
+
+    chemkit::Float deviations[2];
+
+    for(int run = 0; run < 2; run++){
+        chemkit::Molecule molecule;
+        for(int i = 0; i < 4; i++){
+            for(int j = 0; j < 4; j++){
+                for(int k = 0; k < 4; k++){
+                    int n = molecule.atomCount();
+                    chemkit::Point3 center(i * 3.1 + (n * 7919 % 100) / 200.0,
+                                           j * 3.1 + (n * 104729 % 100) / 200.0,
+                                           k * 3.1 + (n * 1299709 % 100) / 200.0);
+
+                    chemkit::Atom *oxygen = molecule.addAtom("O");
+                    chemkit::Atom *hydrogen1 = molecule.addAtom("H");
+                    chemkit::Atom *hydrogen2 = molecule.addAtom("H");
+                    oxygen->setPosition(center);
+                    hydrogen1->setPosition(center + chemkit::Vector3(0.96, 0, 0));
+                    hydrogen2->setPosition(center + chemkit::Vector3(-0.24, 0.93, 0.05 * (i - j)));
+                    molecule.addBond(oxygen, hydrogen1);
+                    molecule.addBond(oxygen, hydrogen2);
+                }
+            }
+        }
+
+        chemkit::ForceField *forceField = chemkit::ForceField::create("mmff");
+        QVERIFY(forceField != 0);
+        forceField->addMolecule(&molecule);
+        QVERIFY(forceField->setup());
+
+        if(run == 1){
+            forceField->setElectrostaticsMethod(static_cast<chemkit::ForceField::ElectrostaticsMethod>(method));
+            forceField->setElectrostaticsCutoff(6.0);
+        }
+
+        chemkit::MolecularDynamics dynamics(forceField);
+        dynamics.setTimeStep(0.5);
+        dynamics.setRandomSeed(7);
+        dynamics.initializeVelocities(300);
+        QVERIFY(dynamics.step());
+
+        chemkit::Float initialEnergy = dynamics.totalEnergy();
+        deviations[run] = 0;
+
+        for(int i = 0; i < 400; i++){
+            QVERIFY(dynamics.step());
+            deviations[run] = qMax(deviations[run], qAbs(dynamics.totalEnergy() - initialEnergy));
+        }
+
+        delete forceField;
+    }
+
+    QVERIFY(deviations[1] < 2 * deviations[0]);
+}
+
+void MmffTest::electrostaticsPrecision_data()
+{
+    QTest::addColumn<int>("method");
+
+    QTest::newRow("particle mesh ewald") << int(chemkit::ForceField::ParticleMeshEwald);
+    QTest::newRow("reaction field") << int(chemkit::ForceField::ReactionField);
+    QTest::newRow("damped shifted force") << int(chemkit::ForceField::DampedShiftedForce);
+}
+
+// The electrostaticsPrecision() test compares the electrostatic
+// energy and gradient of a periodic box of water molecules
+// calculated in single precision to those calculated in double
+// precision.
+void MmffTest::electrostaticsPrecision()
+{
+    QFETCH(int, method);
+
+    chemkit::Molecule molecule;
+    for(int i = 0; i < 4; i++){
+        for(int j = 0; j < 4; j++){
+            for(int k = 0; k < 4; k++){
+                int n = molecule.atomCount();
+                chemkit::Point3 center(i * 3.1 + (n * 7919 % 100) / 200.0,
+                                       j * 3.1 + (n * 104729 % 100) / 200.0,
+                                       k * 3.1 + (n * 1299709 % 100) / 200.0);
+
+                chemkit::Atom *oxygen = molecule.addAtom("O");
+                chemkit::Atom *hydrogen1 = molecule.addAtom("H");
+                chemkit::Atom *hydrogen2 = molecule.addAtom("H");
+                oxygen->setPosition(center);
+                hydrogen1->setPosition(center + chemkit::Vector3(0.96, 0, 0));
+                hydrogen2->setPosition(center + chemkit::Vector3(-0.24, 0.93, 0.05 * (i - j)));
+                molecule.addBond(oxygen, hydrogen1);
+                molecule.addBond(oxygen, hydrogen2);
+            }
+        }
+    }
+
+    chemkit::UnitCell cell(chemkit::Vector3(12.4, 0, 0),
+                           chemkit::Vector3(0, 12.4, 0),
+                           chemkit::Vector3(0, 0, 12.4));
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("mmff");
+    QVERIFY(forceField != 0);
+    forceField->addMolecule(&molecule);
+    QVERIFY(forceField->setup());
+    forceField->setUnitCell(&cell);
+    forceField->setElectrostaticsMethod(static_cast<chemkit::ForceField::ElectrostaticsMethod>(method));
+    forceField->setElectrostaticsCutoff(6.0);
+    QCOMPARE(forceField->electrostaticsPrecision(), chemkit::ForceField::DoublePrecision);
+
+    chemkit::Float energy = forceField->energy();
+    std::vector<chemkit::Vector3> gradient = electrostaticGradient(forceField);
+
+    forceField->setElectrostaticsPrecision(chemkit::ForceField::SinglePrecision);
+    QCOMPARE(forceField->electrostaticsPrecision(), chemkit::ForceField::SinglePrecision);
+
+    chemkit::Float singleEnergy = forceField->energy();
+    std::vector<chemkit::Vector3> singleGradient = electrostaticGradient(forceField);
+
+    QVERIFY(singleEnergy != energy);
+    QVERIFY(qAbs(singleEnergy - energy) < 1e-5 * qAbs(energy));
+    QVERIFY(relativeError(singleGradient, gradient) < 1e-5);
+
+    // the double precision results are unchanged
+    forceField->setElectrostaticsPrecision(chemkit::ForceField::DoublePrecision);
+    QCOMPARE(forceField->energy(), energy);
+
+    delete forceField;
+}
+
+// The implicitSolvent() test checks that the generalized Born
+// solvation energy is included in the energy, gradient and Hessian
+// of the force field and that the solvated molecule can be
+// minimized.
+void MmffTest::implicitSolvent()
+{
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("mmff");
+    QVERIFY(forceField != 0);
+    forceField->addMolecule(molecule);
+    QVERIFY(forceField->setup());
+
+    QVERIFY(!forceField->implicitSolventEnabled());
+    chemkit::Float gasEnergy = forceField->energy();
+
+    forceField->setImplicitSolventEnabled(true);
+    chemkit::Float solvationEnergy = forceField->solvationEnergy();
+    QVERIFY(solvationEnergy < 0);
+    QVERIFY(qAbs(forceField->energy() - (gasEnergy + solvationEnergy)) < 1e-8);
+    QCOMPARE(forceField->bornRadii().size(), size_t(forceField->atomCount()));
+
+    // compare the gradient with central differences of the energy
+    std::vector<chemkit::Vector3> gradient = forceField->gradient();
+    const chemkit::Float step = 1e-5;
+
+    for(int i = 0; i < forceField->atomCount(); i++){
+        chemkit::ForceFieldAtom *atom = forceField->atom(i);
+        chemkit::Point3 position = atom->position();
+
+        for(int j = 0; j < 3; j++){
+            chemkit::Point3 forward = position;
+            forward[j] += step;
+            atom->setPosition(forward);
+            chemkit::Float forwardEnergy = forceField->energy();
+
+            chemkit::Point3 backward = position;
+            backward[j] -= step;
+            atom->setPosition(backward);
+            chemkit::Float backwardEnergy = forceField->energy();
+
+            atom->setPosition(position);
+
+            QVERIFY(qAbs(gradient[i][j] - (forwardEnergy - backwardEnergy) / (2 * step)) < 1e-4);
+        }
+    }
+
+    // the solvation contribution to the hessian is calculated
+    // numerically from its gradient
+    chemkit::Matrix hessian = forceField->hessian();
+    chemkit::Matrix numericalHessian = forceField->numericalHessian();
+    for(int i = 0; i < hessian.rowCount(); i++){
+        for(int j = 0; j < hessian.columnCount(); j++){
+            QVERIFY(qAbs(hessian(i, j) - numericalHessian(i, j)) < 1e-3 * qMax(1.0, qAbs(hessian(i, j))));
+        }
+    }
+
+    // the cutoff and thread count do not change the result for a
+    // molecule smaller than the cutoff
+    forceField->setImplicitSolventCutoff(20.0);
+    forceField->setThreadCount(3);
+    QVERIFY(qAbs(forceField->solvationEnergy() - solvationEnergy) < 1e-8);
+    forceField->setImplicitSolventCutoff(0);
+    forceField->setThreadCount(0);
+
+    chemkit::ForceFieldMinimizer minimizer(forceField);
+    QVERIFY(minimizer.minimize());
+    QVERIFY(forceField->energy() < gasEnergy + solvationEnergy);
+
+    delete forceField;
+    delete molecule;
+}
+
 QTEST_APPLESS_MAIN(MmffTest)
@@ -45,6 +45,18 @@ class MmffTest : public QObject
     private slots:
         void initTestCase();
         void validate();
+        void binaryParameters();
+        void typeCache();
+        void hessian();
+        void linearHessian();
+        void particleMeshEwald();
+        void cutoffElectrostatics_data();
+        void cutoffElectrostatics();
+        void cutoffElectrostaticsDynamics_data();
+        void cutoffElectrostaticsDynamics();
+        void electrostaticsPrecision_data();
+        void electrostaticsPrecision();
+        void implicitSolvent();
 };
 
 #endif // MMFFTEST_H
@@ -45,6 +45,7 @@
 #include <chemkit/atomtyper.h>
 #include <chemkit/forcefield.h>
 #include <chemkit/moleculefile.h>
+#include <chemkit/binaryparameterfile.h>
 
 const std::string dataPath = "../../../data/";
 
@@ -92,4 +93,33 @@ void OplsTest::energy()
     delete opls;
 }
 
+void OplsTest::binaryParameters()
+{
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "methanol.sdf");
+    QVERIFY(molecule != 0);
+
+    // setup with the text parameter file
+    chemkit::ForceField *text = chemkit::ForceField::create("opls");
+    QVERIFY(text != 0);
+    text->addMolecule(molecule);
+    QVERIFY(text->setup());
+
+    // the text file is compiled into the parameter cache
+    std::string binaryFileName = chemkit::BinaryParameterFile::cacheFileName(text->parameterFile());
+    QVERIFY(chemkit::BinaryParameterFile::isBinaryParameterFile(binaryFileName));
+
+    // setup with the binary parameter file
+    chemkit::ForceField *binary = chemkit::ForceField::create("opls");
+    QVERIFY(binary != 0);
+    binary->setParameterFile(binaryFileName);
+    binary->addMolecule(molecule);
+    QVERIFY(binary->setup());
+
+    QCOMPARE(binary->energy(), text->energy());
+
+    delete text;
+    delete binary;
+    delete molecule;
+}
+
 QTEST_APPLESS_MAIN(OplsTest)
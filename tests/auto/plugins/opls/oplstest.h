@@ -46,6 +46,7 @@ class OplsTest : public QObject
         void initTestCase();
         void energy_data();
         void energy();
+        void binaryParameters();
 };
 
 #endif // OPLSTEST_H
@@ -54,6 +54,7 @@ void RotatableBondsTest::test_data()
     QTest::newRow("alanine") << "CC(C(=O)O)N" << 1;
     QTest::newRow("benzene") << "c1ccccc1" << 0;
     QTest::newRow("biphenyl") << "c1ccccc1(c2ccccc2)" << 1;
+    QTest::newRow("2-butene") << "CC=CC" << 0;
     QTest::newRow("isoleucine") << "CCC(C)C(C(=O)O)N" << 3;
     QTest::newRow("asparagine") << "C(C(C(=O)O)N)C(=O)N" << 3;
     QTest::newRow("octane") << "CCCCCCCC" << 5;
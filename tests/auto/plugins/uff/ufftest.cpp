@@ -37,11 +37,15 @@
 
 #include <algorithm>
 
+#include <chemkit/atom.h>
+#include <chemkit/bond.h>
 #include <chemkit/molecule.h>
 #include <chemkit/atomtyper.h>
 #include <chemkit/forcefield.h>
 #include <chemkit/moleculefile.h>
 
+const std::string dataPath = "../../../data/";
+
 void UffTest::initTestCase()
 {
     std::vector<std::string> typers = chemkit::AtomTyper::typers();
@@ -51,4 +55,238 @@ void UffTest::initTestCase()
     QVERIFY(std::find(forceFields.begin(), forceFields.end(), "uff") != forceFields.end());
 }
 
+void UffTest::hessian()
+{
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField);
+    forceField->addMolecule(molecule);
+    QVERIFY(forceField->setup());
+
+    // the analytical hessian of each calculation agrees with central
+    // differences of its gradient
+    foreach(const chemkit::ForceFieldCalculation *calculation, forceField->calculations()){
+        chemkit::Matrix analytical = calculation->hessian();
+        chemkit::Matrix numerical = calculation->numericalHessian();
+        QCOMPARE(analytical.rowCount(), 3 * calculation->atomCount());
+        QCOMPARE(analytical.columnCount(), 3 * calculation->atomCount());
+
+        for(int i = 0; i < analytical.rowCount(); i++){
+            for(int j = 0; j < analytical.columnCount(); j++){
+                QVERIFY(qAbs(analytical(i, j) - numerical(i, j)) < 1e-4 * qMax(1.0, qAbs(numerical(i, j))));
+                QVERIFY(qAbs(analytical(i, j) - analytical(j, i)) < 1e-8 * qMax(1.0, qAbs(analytical(i, j))));
+            }
+        }
+    }
+
+    // the hessian of the force field agrees with the numerical hessian
+    int size = 3 * forceField->atomCount();
+    chemkit::Matrix hessian = forceField->hessian();
+    chemkit::Matrix numericalHessian = forceField->numericalHessian();
+    QCOMPARE(hessian.rowCount(), size);
+    QCOMPARE(numericalHessian.rowCount(), size);
+
+    for(int i = 0; i < size; i++){
+        for(int j = 0; j < size; j++){
+            QVERIFY(qAbs(hessian(i, j) - numericalHessian(i, j)) < 1e-3 * qMax(1.0, qAbs(hessian(i, j))));
+        }
+    }
+
+    // hessian-vector products agree with the hessian
+    std::vector<chemkit::Vector3> vector(forceField->atomCount());
+    for(int i = 0; i < forceField->atomCount(); i++){
+        vector[i] = chemkit::Vector3(sin(i), cos(2.0 * i), 0.5 - 0.1 * i);
+    }
+
+    std::vector<chemkit::Vector3> product = forceField->hessianProduct(vector);
+    QCOMPARE(product.size(), vector.size());
+    for(int i = 0; i < size; i++){
+        double expected = 0;
+        for(int j = 0; j < size; j++){
+            expected += hessian(i, j) * vector[j / 3][j % 3];
+        }
+
+        QVERIFY(qAbs(product[i / 3][i % 3] - expected) < 1e-8 * qMax(1.0, qAbs(expected)));
+    }
+
+    // frozen atoms have zero rows and columns
+    chemkit::ForceFieldAtom *frozenAtom = forceField->atom(0);
+    frozenAtom->setFrozen(true);
+    hessian = forceField->hessian();
+    product = forceField->hessianProduct(vector);
+    for(int i = 0; i < size; i++){
+        for(int k = 0; k < 3; k++){
+            QCOMPARE(hessian(k, i), 0.0);
+            QCOMPARE(hessian(i, k), 0.0);
+        }
+    }
+    QVERIFY(product[0].isNull());
+
+    delete forceField;
+    delete molecule;
+}
+
+void UffTest::topologyTemplates()
+{
+    std::vector<chemkit::Molecule *> molecules;
+    for(int i = 0; i < 3; i++){
+        chemkit::Molecule *uridine = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+        QVERIFY(uridine != 0);
+        molecules.push_back(uridine);
+
+        chemkit::Molecule *water = chemkit::MoleculeFile::quickRead(dataPath + "water.mol");
+        QVERIFY(water != 0);
+        molecules.push_back(water);
+    }
+
+    // move the copies so that they have different coordinates
+    for(unsigned int i = 0; i < molecules.size(); i++){
+        foreach(chemkit::Atom *atom, molecules[i]->atoms()){
+            atom->moveBy(0.1 * i, -0.2 * i, 0.3 * i);
+        }
+    }
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField);
+    QVERIFY(forceField->topologyTemplatesEnabled());
+    foreach(const chemkit::Molecule *molecule, molecules){
+        forceField->addMolecule(molecule);
+    }
+    QVERIFY(forceField->setup());
+
+    chemkit::ForceField *reference = chemkit::ForceField::create("uff");
+    QVERIFY(reference);
+    reference->setTopologyTemplatesEnabled(false);
+    QVERIFY(!reference->topologyTemplatesEnabled());
+    foreach(const chemkit::Molecule *molecule, molecules){
+        reference->addMolecule(molecule);
+    }
+    QVERIFY(reference->setup());
+
+    // copies have the same atom types and calculations as the
+    // molecules which were set up independently
+    QCOMPARE(forceField->atomCount(), reference->atomCount());
+    for(int i = 0; i < forceField->atomCount(); i++){
+        QVERIFY(forceField->atom(i)->atom() == reference->atom(i)->atom());
+        QCOMPARE(forceField->atom(i)->type(), reference->atom(i)->type());
+    }
+
+    QCOMPARE(forceField->calculationCount(), reference->calculationCount());
+    for(int i = 0; i < forceField->calculationCount(); i++){
+        const chemkit::ForceFieldCalculation *calculation = forceField->calculation(i);
+        const chemkit::ForceFieldCalculation *referenceCalculation = reference->calculation(i);
+
+        QCOMPARE(calculation->type(), referenceCalculation->type());
+        QVERIFY(calculation->isSetup());
+        for(int j = 0; j < calculation->atomCount(); j++){
+            QVERIFY(calculation->atom(j)->atom() == referenceCalculation->atom(j)->atom());
+        }
+        QVERIFY(calculation->parameters() == referenceCalculation->parameters());
+    }
+
+    QCOMPARE(forceField->energy(), reference->energy());
+    QVERIFY(forceField->gradient() == reference->gradient());
+
+    delete forceField;
+    delete reference;
+    foreach(chemkit::Molecule *molecule, molecules){
+        delete molecule;
+    }
+}
+
+void UffTest::parallelSetup()
+{
+    std::vector<chemkit::Molecule *> molecules;
+    molecules.push_back(chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2"));
+    molecules.push_back(chemkit::MoleculeFile::quickRead(dataPath + "adenosine.mol"));
+    molecules.push_back(chemkit::MoleculeFile::quickRead(dataPath + "guanine.mol"));
+    molecules.push_back(chemkit::MoleculeFile::quickRead(dataPath + "serine.mol"));
+    molecules.push_back(chemkit::MoleculeFile::quickRead(dataPath + "water.mol"));
+    foreach(const chemkit::Molecule *molecule, molecules){
+        QVERIFY(molecule != 0);
+    }
+
+    // set up the force field with one and with several threads. the
+    // uridine molecule is added twice to check that a molecule added
+    // more than once is set up correctly
+    std::vector<chemkit::ForceField *> forceFields;
+    for(int threadCount = 1; threadCount <= 4; threadCount += 3){
+        chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+        QVERIFY(forceField);
+        forceField->setTopologyTemplatesEnabled(false);
+        forceField->setThreadCount(threadCount);
+        foreach(const chemkit::Molecule *molecule, molecules){
+            forceField->addMolecule(molecule);
+        }
+        forceField->addMolecule(molecules[0]);
+        QVERIFY(forceField->setup());
+        QVERIFY(forceField->calculationCount() > 1000);
+        forceFields.push_back(forceField);
+    }
+
+    // the atoms and calculations are created in the same order
+    // with the same parameters regardless of the thread count
+    chemkit::ForceField *forceField = forceFields[1];
+    chemkit::ForceField *reference = forceFields[0];
+
+    QCOMPARE(forceField->atomCount(), reference->atomCount());
+    for(int i = 0; i < forceField->atomCount(); i++){
+        QVERIFY(forceField->atom(i)->atom() == reference->atom(i)->atom());
+        QCOMPARE(forceField->atom(i)->type(), reference->atom(i)->type());
+    }
+
+    QCOMPARE(forceField->calculationCount(), reference->calculationCount());
+    for(int i = 0; i < forceField->calculationCount(); i++){
+        const chemkit::ForceFieldCalculation *calculation = forceField->calculation(i);
+        const chemkit::ForceFieldCalculation *referenceCalculation = reference->calculation(i);
+
+        QCOMPARE(calculation->type(), referenceCalculation->type());
+        QCOMPARE(calculation->isSetup(), referenceCalculation->isSetup());
+        for(int j = 0; j < calculation->atomCount(); j++){
+            QVERIFY(calculation->atom(j)->atom() == referenceCalculation->atom(j)->atom());
+        }
+        QVERIFY(calculation->parameters() == referenceCalculation->parameters());
+    }
+
+    forceField->setThreadCount(1);
+    QCOMPARE(forceField->energy(), reference->energy());
+
+    foreach(chemkit::ForceField *forceField, forceFields){
+        delete forceField;
+    }
+    foreach(chemkit::Molecule *molecule, molecules){
+        delete molecule;
+    }
+}
+
+void UffTest::clear()
+{
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField);
+    forceField->addMolecule(molecule);
+    QVERIFY(forceField->setup());
+    double energy = forceField->energy();
+    int calculationCount = forceField->calculationCount();
+
+    forceField->clear();
+    QCOMPARE(forceField->moleculeCount(), 0);
+    QCOMPARE(forceField->atomCount(), 0);
+    QCOMPARE(forceField->calculationCount(), 0);
+
+    // the force field can be setup again after being cleared
+    forceField->addMolecule(molecule);
+    QVERIFY(forceField->setup());
+    QCOMPARE(forceField->atomCount(), molecule->atomCount());
+    QCOMPARE(forceField->calculationCount(), calculationCount);
+    QCOMPARE(forceField->energy(), energy);
+
+    delete forceField;
+    delete molecule;
+}
+
 QTEST_APPLESS_MAIN(UffTest)
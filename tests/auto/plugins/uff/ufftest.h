@@ -44,6 +44,10 @@ class UffTest : public QObject
 
     private slots:
         void initTestCase();
+        void hessian();
+        void topologyTemplates();
+        void parallelSetup();
+        void clear();
 };
 
 #endif // UFFTEST_H
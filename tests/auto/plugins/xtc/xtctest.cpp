@@ -37,6 +37,7 @@
 
 #include <algorithm>
 
+#include <chemkit/unitcell.h>
 #include <chemkit/trajectory.h>
 #include <chemkit/trajectoryfile.h>
 #include <chemkit/trajectoryframe.h>
@@ -63,4 +64,48 @@ void XtcTest::spc216()
     QCOMPARE(trajectory->frameCount(), 201);
 }
 
+void XtcTest::writeFrames()
+{
+    chemkit::TrajectoryFile file(dataPath + "spc216.xtc");
+    QVERIFY(file.read());
+    chemkit::Trajectory *trajectory = file.trajectory();
+    QVERIFY(trajectory != 0);
+
+    // stream the first five frames to a buffer
+    QBuffer buffer;
+    buffer.open(QBuffer::WriteOnly);
+
+    chemkit::TrajectoryFile output;
+    QVERIFY(output.beginWriting(&buffer, "xtc"));
+    QVERIFY(output.isWriting());
+    for(int i = 0; i < 5; i++){
+        QVERIFY(output.writeFrame(trajectory->frame(i)));
+    }
+    output.endWriting();
+    QVERIFY(!output.isWriting());
+    buffer.close();
+
+    // read the frames back
+    buffer.open(QBuffer::ReadOnly);
+    chemkit::TrajectoryFile input;
+    QVERIFY(input.read(&buffer, "xtc"));
+    QVERIFY(input.trajectory() != 0);
+    QCOMPARE(input.trajectory()->frameCount(), 5);
+
+    for(int i = 0; i < 5; i++){
+        const chemkit::TrajectoryFrame *original = trajectory->frame(i);
+        const chemkit::TrajectoryFrame *frame = input.trajectory()->frame(i);
+
+        QCOMPARE(frame->size(), original->size());
+        QCOMPARE(frame->step(), original->step());
+        QCOMPARE(frame->time(), original->time());
+        QVERIFY(frame->unitCell() != 0);
+        QVERIFY((frame->unitCell()->x() - original->unitCell()->x()).norm() < 1e-4);
+
+        for(int j = 0; j < frame->size(); j++){
+            QVERIFY(frame->position(j).distance(original->position(j)) < 1e-2);
+        }
+    }
+}
+
 QTEST_APPLESS_MAIN(XtcTest)
@@ -0,0 +1,129 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+// This benchmark measures the time taken to minimize each of the
+// 753 molecules in the MMFF94 validation suite with the mmff force
+// field. The separate() benchmark creates and sets up a new force
+// field for each molecule while the batch() benchmark uses the
+// ForceFieldBatchMinimizer class with varying numbers of threads.
+
+#include "batchminimizationbenchmark.h"
+
+#include <chemkit/molecule.h>
+#include <chemkit/forcefield.h>
+#include <chemkit/moleculefile.h>
+#include <chemkit/forcefieldminimizer.h>
+#include <chemkit/forcefieldbatchminimizer.h>
+
+const std::string dataPath = "../../data/";
+
+void BatchMinimizationBenchmark::separate()
+{
+    chemkit::MoleculeFile input(dataPath + "MMFF94_hypervalent.mol2");
+    QVERIFY(input.read());
+
+    int convergedCount = 0;
+
+    QBENCHMARK {
+        convergedCount = 0;
+
+        foreach(const chemkit::Molecule *molecule, input.molecules()){
+            chemkit::Molecule copy(*molecule);
+
+            chemkit::ForceField *forceField = chemkit::ForceField::create("mmff");
+            forceField->setThreadCount(1);
+            forceField->addMolecule(&copy);
+
+            if(forceField->setup()){
+                chemkit::ForceFieldMinimizer minimizer(forceField);
+                if(minimizer.minimize()){
+                    convergedCount++;
+                }
+
+                forceField->writeCoordinates(&copy);
+            }
+
+            delete forceField;
+        }
+    }
+
+    qDebug() << "converged:" << convergedCount;
+}
+
+void BatchMinimizationBenchmark::batch_data()
+{
+    QTest::addColumn<int>("threadCount");
+
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("2 threads") << 2;
+    QTest::newRow("4 threads") << 4;
+    QTest::newRow("ideal") << 0;
+}
+
+void BatchMinimizationBenchmark::batch()
+{
+    QFETCH(int, threadCount);
+
+    chemkit::MoleculeFile input(dataPath + "MMFF94_hypervalent.mol2");
+    QVERIFY(input.read());
+
+    chemkit::ForceFieldBatchMinimizer batchMinimizer("mmff");
+    batchMinimizer.setThreadCount(threadCount);
+
+    QBENCHMARK {
+        chemkit::MoleculeFile output;
+        QVERIFY(batchMinimizer.minimize(&input, &output));
+    }
+
+    // per-molecule statistics
+    chemkit::Float totalTime = 0;
+    chemkit::Float maximumTime = 0;
+    int totalSteps = 0;
+
+    for(int i = 0; i < batchMinimizer.resultCount(); i++){
+        totalTime += batchMinimizer.elapsedTime(i);
+        maximumTime = qMax(maximumTime, batchMinimizer.elapsedTime(i));
+        totalSteps += batchMinimizer.stepCount(i);
+    }
+
+    qDebug() << "threads:" << batchMinimizer.effectiveThreadCount()
+             << "converged:" << batchMinimizer.convergedCount()
+             << "failed:" << batchMinimizer.failedCount()
+             << "mean steps:" << double(totalSteps) / batchMinimizer.resultCount()
+             << "mean time (ms):" << totalTime / batchMinimizer.resultCount()
+             << "max time (ms):" << maximumTime;
+}
+
+QTEST_APPLESS_MAIN(BatchMinimizationBenchmark)
@@ -0,0 +1,107 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+// This benchmark measures the time to calculate the energy of 500
+// conformers of uridine with the MMFF force field. The energies are
+// calculated either one conformer at a time with readCoordinates()
+// and energy() or all at once with energies().
+
+#include "conformerenergiesbenchmark.h"
+
+#include <chemkit/atom.h>
+#include <chemkit/molecule.h>
+#include <chemkit/conformer.h>
+#include <chemkit/forcefield.h>
+#include <chemkit/moleculefile.h>
+
+const std::string dataPath = "../../data/";
+
+void ConformerEnergiesBenchmark::benchmark_data()
+{
+    QTest::addColumn<bool>("batched");
+
+    QTest::newRow("read-coordinates") << false;
+    QTest::newRow("energies") << true;
+}
+
+void ConformerEnergiesBenchmark::benchmark()
+{
+    QFETCH(bool, batched);
+
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    std::vector<chemkit::Conformer *> conformers;
+    for(int i = 0; i < 500; i++){
+        chemkit::Conformer *conformer = molecule->addConformer();
+
+        foreach(const chemkit::Atom *atom, molecule->atoms()){
+            chemkit::Float offset = 0.01 * ((atom->index() * 7 + i * 3) % 11 - 5);
+            conformer->setPosition(atom, atom->position() + chemkit::Vector3(offset, offset, -offset));
+        }
+
+        conformers.push_back(conformer);
+    }
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("mmff");
+    QVERIFY(forceField != 0);
+
+    forceField->addMolecule(molecule);
+    bool ok = forceField->setup();
+    QVERIFY(ok);
+
+    std::vector<chemkit::Float> energies;
+
+    QBENCHMARK {
+        if(batched){
+            energies = forceField->energies(conformers);
+        }
+        else{
+            energies.clear();
+
+            foreach(const chemkit::Conformer *conformer, conformers){
+                forceField->readCoordinates(conformer);
+                energies.push_back(forceField->energy());
+            }
+        }
+    }
+
+    QCOMPARE(energies.size(), conformers.size());
+
+    delete forceField;
+    delete molecule;
+}
+
+QTEST_APPLESS_MAIN(ConformerEnergiesBenchmark)
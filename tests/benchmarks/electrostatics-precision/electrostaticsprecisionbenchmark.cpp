@@ -0,0 +1,211 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+// This benchmark compares the time taken to calculate the energy
+// and gradient of water boxes of increasing size with the damped
+// shifted force electrostatics method in double and in single
+// precision. The boxes are built by replicating the first frame of
+// the spc216 trajectory. The force field used only contains the
+// charges of the atoms so that the time is dominated by the sum
+// over the pairs within the cutoff. The gradient benchmark measures
+// the time taken to calculate the complete gradient of a single box
+// with the MMFF force field, which includes the bonded and van der
+// Waals calculations that are always performed in double precision.
+
+#include "electrostaticsprecisionbenchmark.h"
+
+#include <chemkit/atom.h>
+#include <chemkit/foreach.h>
+#include <chemkit/molecule.h>
+#include <chemkit/unitcell.h>
+#include <chemkit/trajectory.h>
+#include <chemkit/forcefield.h>
+#include <chemkit/forcefieldatom.h>
+#include <chemkit/trajectoryfile.h>
+#include <chemkit/trajectoryframe.h>
+
+const std::string dataPath = "../../data/";
+
+namespace {
+
+// The ChargeForceField class contains an atom with the spc charge
+// for each atom of the water molecules and no calculations.
+class ChargeForceField : public chemkit::ForceField
+{
+    public:
+        ChargeForceField()
+            : chemkit::ForceField("charge")
+        {
+        }
+
+        bool setup()
+        {
+            foreach(const chemkit::Molecule *molecule, molecules()){
+                foreach(const chemkit::Atom *atom, molecule->atoms()){
+                    chemkit::ForceFieldAtom *forceFieldAtom = new chemkit::ForceFieldAtom(this, atom);
+                    forceFieldAtom->setCharge(atom->is(chemkit::Atom::Oxygen) ? -0.82 : 0.41);
+                    addAtom(forceFieldAtom);
+                }
+            }
+
+            return true;
+        }
+};
+
+// Adds the water molecules of frame replicated replicas times along
+// each of the vectors of its unit cell to water.
+void replicateWater(const chemkit::TrajectoryFrame *frame, int replicas, chemkit::Molecule *water)
+{
+    const chemkit::UnitCell *box = frame->unitCell();
+
+    for(int a = 0; a < replicas; a++){
+        for(int b = 0; b < replicas; b++){
+            for(int c = 0; c < replicas; c++){
+                chemkit::Vector3 offset = box->x() * chemkit::Float(a) +
+                                          box->y() * chemkit::Float(b) +
+                                          box->z() * chemkit::Float(c);
+
+                for(int i = 0; i < frame->size(); i += 3){
+                    chemkit::Atom *oxygen = water->addAtom("O");
+                    chemkit::Atom *hydrogen1 = water->addAtom("H");
+                    chemkit::Atom *hydrogen2 = water->addAtom("H");
+                    oxygen->setPosition(frame->position(i) + offset);
+                    hydrogen1->setPosition(frame->position(i + 1) + offset);
+                    hydrogen2->setPosition(frame->position(i + 2) + offset);
+                    water->addBond(oxygen, hydrogen1);
+                    water->addBond(oxygen, hydrogen2);
+                }
+            }
+        }
+    }
+}
+
+} // end anonymous namespace
+
+void ElectrostaticsPrecisionBenchmark::benchmark_data()
+{
+    QTest::addColumn<int>("precision");
+    QTest::addColumn<int>("replicas");
+
+    QTest::newRow("double 5184") << int(chemkit::ForceField::DoublePrecision) << 2;
+    QTest::newRow("double 17496") << int(chemkit::ForceField::DoublePrecision) << 3;
+    QTest::newRow("double 41472") << int(chemkit::ForceField::DoublePrecision) << 4;
+    QTest::newRow("single 5184") << int(chemkit::ForceField::SinglePrecision) << 2;
+    QTest::newRow("single 17496") << int(chemkit::ForceField::SinglePrecision) << 3;
+    QTest::newRow("single 41472") << int(chemkit::ForceField::SinglePrecision) << 4;
+}
+
+void ElectrostaticsPrecisionBenchmark::benchmark()
+{
+    QFETCH(int, precision);
+    QFETCH(int, replicas);
+
+    chemkit::TrajectoryFile file(dataPath + "spc216.xtc");
+    QVERIFY(file.read());
+    const chemkit::TrajectoryFrame *frame = file.trajectory()->frame(0);
+    const chemkit::UnitCell *box = frame->unitCell();
+    QVERIFY(box != 0);
+
+    // replicate the box along each of its vectors
+    chemkit::UnitCell cell(box->x() * chemkit::Float(replicas),
+                           box->y() * chemkit::Float(replicas),
+                           box->z() * chemkit::Float(replicas));
+
+    chemkit::Molecule water;
+    replicateWater(frame, replicas, &water);
+
+    ChargeForceField forceField;
+    forceField.addMolecule(&water);
+    QVERIFY(forceField.setup());
+    forceField.setUnitCell(&cell);
+    forceField.setElectrostaticsMethod(chemkit::ForceField::DampedShiftedForce);
+    forceField.setElectrostaticsPrecision(static_cast<chemkit::ForceField::ElectrostaticsPrecision>(precision));
+
+    chemkit::Float energy = 0;
+    std::vector<chemkit::Vector3> gradient;
+
+    QBENCHMARK {
+        energy = forceField.energy();
+        gradient = forceField.gradient();
+    }
+
+    // energy in kcal/mol per water molecule
+    qDebug() << "atoms:" << forceField.atomCount()
+             << "energy per molecule:" << energy / (forceField.atomCount() / 3);
+}
+
+void ElectrostaticsPrecisionBenchmark::gradient_data()
+{
+    QTest::addColumn<int>("precision");
+
+    QTest::newRow("double") << int(chemkit::ForceField::DoublePrecision);
+    QTest::newRow("single") << int(chemkit::ForceField::SinglePrecision);
+}
+
+void ElectrostaticsPrecisionBenchmark::gradient()
+{
+    QFETCH(int, precision);
+
+    chemkit::TrajectoryFile file(dataPath + "spc216.xtc");
+    QVERIFY(file.read());
+    const chemkit::TrajectoryFrame *frame = file.trajectory()->frame(0);
+    const chemkit::UnitCell *box = frame->unitCell();
+    QVERIFY(box != 0);
+
+    chemkit::Molecule water;
+    replicateWater(frame, 1, &water);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("mmff");
+    QVERIFY(forceField != 0);
+    forceField->addMolecule(&water);
+    QVERIFY(forceField->setup());
+    forceField->setUnitCell(box);
+    forceField->setElectrostaticsMethod(chemkit::ForceField::DampedShiftedForce);
+    forceField->setElectrostaticsPrecision(static_cast<chemkit::ForceField::ElectrostaticsPrecision>(precision));
+
+    std::vector<chemkit::Vector3> gradient;
+
+    QBENCHMARK {
+        gradient = forceField->gradient();
+    }
+
+    qDebug() << "atoms:" << forceField->atomCount()
+             << "calculations:" << forceField->calculationCount()
+             << "rms gradient:" << forceField->rootMeanSquareGradient();
+
+    delete forceField;
+}
+
+QTEST_APPLESS_MAIN(ElectrostaticsPrecisionBenchmark)
@@ -0,0 +1,219 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+// This benchmark measures the time it takes to setup a force field
+// (atom typing, term enumeration and parameter assignment) for the
+// protein ubiquitin (PDB ID: 1UBQ) and for a box of 1000 water
+// molecules with and without topology templates. It also measures
+// how the setup of a mixture of many different molecules scales
+// with the number of threads and the setup of AMBER from residue
+// templates.
+
+#include "forcefieldsetupbenchmark.h"
+
+#include <chemkit/polymer.h>
+#include <chemkit/molecule.h>
+#include <chemkit/forcefield.h>
+#include <chemkit/polymerfile.h>
+#include <chemkit/moleculefile.h>
+#include <chemkit/bondpredictor.h>
+
+const std::string dataPath = "../../data/";
+
+void ForceFieldSetupBenchmark::benchmark_data()
+{
+    QTest::addColumn<QString>("forceFieldName");
+
+    QTest::newRow("opls") << "opls";
+    QTest::newRow("amber") << "amber";
+    QTest::newRow("mmff") << "mmff";
+}
+
+void ForceFieldSetupBenchmark::benchmark()
+{
+    QFETCH(QString, forceFieldName);
+
+    chemkit::PolymerFile file(dataPath + "1UBQ.pdb");
+    QVERIFY(file.read());
+
+    chemkit::Polymer *protein = file.polymer();
+    QVERIFY(protein != 0);
+
+    int calculationCount = 0;
+
+    QBENCHMARK {
+        chemkit::ForceField *forceField = chemkit::ForceField::create(forceFieldName.toStdString());
+        QVERIFY(forceField != 0);
+
+        forceField->addMolecule(protein);
+        forceField->setup();
+        calculationCount = forceField->calculationCount();
+
+        delete forceField;
+    }
+
+    qDebug() << "calculations:" << calculationCount;
+}
+
+// sets up the AMBER force field for ubiquitin with hydrogens (PDB ID:
+// 1D3Z) where each atom is typed and charged from its residue template
+void ForceFieldSetupBenchmark::residueTemplates()
+{
+    chemkit::PolymerFile file(dataPath + "1D3Z.pdb");
+    QVERIFY(file.read());
+
+    chemkit::Polymer *protein = file.polymer();
+    QVERIFY(protein != 0);
+    chemkit::BondPredictor::predictBonds(protein);
+
+    int calculationCount = 0;
+
+    QBENCHMARK {
+        chemkit::ForceField *forceField = chemkit::ForceField::create("amber");
+        QVERIFY(forceField != 0);
+
+        forceField->addMolecule(protein);
+        QVERIFY(forceField->setup());
+        calculationCount = forceField->calculationCount();
+
+        delete forceField;
+    }
+
+    qDebug() << "calculations:" << calculationCount;
+}
+
+void ForceFieldSetupBenchmark::solvent_data()
+{
+    QTest::addColumn<QString>("forceFieldName");
+    QTest::addColumn<bool>("topologyTemplates");
+
+    QTest::newRow("uff") << "uff" << false;
+    QTest::newRow("uff-templates") << "uff" << true;
+    QTest::newRow("mmff") << "mmff" << false;
+    QTest::newRow("mmff-templates") << "mmff" << true;
+}
+
+void ForceFieldSetupBenchmark::solvent()
+{
+    QFETCH(QString, forceFieldName);
+    QFETCH(bool, topologyTemplates);
+
+    std::vector<chemkit::Molecule *> waters;
+    for(int i = 0; i < 1000; i++){
+        chemkit::Molecule *water = chemkit::MoleculeFile::quickRead(dataPath + "water.mol");
+        QVERIFY(water != 0);
+        waters.push_back(water);
+    }
+
+    int calculationCount = 0;
+
+    QBENCHMARK {
+        chemkit::ForceField *forceField = chemkit::ForceField::create(forceFieldName.toStdString());
+        QVERIFY(forceField != 0);
+
+        forceField->setTopologyTemplatesEnabled(topologyTemplates);
+        foreach(const chemkit::Molecule *water, waters){
+            forceField->addMolecule(water);
+        }
+        forceField->setup();
+        calculationCount = forceField->calculationCount();
+
+        delete forceField;
+    }
+
+    qDebug() << "calculations:" << calculationCount;
+
+    foreach(chemkit::Molecule *water, waters){
+        delete water;
+    }
+}
+
+void ForceFieldSetupBenchmark::threads_data()
+{
+    QTest::addColumn<QString>("forceFieldName");
+    QTest::addColumn<int>("threadCount");
+
+    QTest::newRow("uff-1") << "uff" << 1;
+    QTest::newRow("uff-ideal") << "uff" << 0;
+    QTest::newRow("mmff-1") << "mmff" << 1;
+    QTest::newRow("mmff-ideal") << "mmff" << 0;
+    QTest::newRow("opls-1") << "opls" << 1;
+    QTest::newRow("opls-ideal") << "opls" << 0;
+}
+
+void ForceFieldSetupBenchmark::threads()
+{
+    QFETCH(QString, forceFieldName);
+    QFETCH(int, threadCount);
+
+    // topology templates are disabled so that each of the molecules
+    // is typed and parameterized independently
+    std::vector<chemkit::Molecule *> molecules;
+    for(int i = 0; i < 100; i++){
+        chemkit::Molecule *uridine = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+        QVERIFY(uridine != 0);
+        molecules.push_back(uridine);
+
+        chemkit::Molecule *adenosine = chemkit::MoleculeFile::quickRead(dataPath + "adenosine.mol");
+        QVERIFY(adenosine != 0);
+        molecules.push_back(adenosine);
+    }
+
+    int calculationCount = 0;
+
+    QBENCHMARK {
+        chemkit::ForceField *forceField = chemkit::ForceField::create(forceFieldName.toStdString());
+        QVERIFY(forceField != 0);
+
+        forceField->setThreadCount(threadCount);
+        forceField->setTopologyTemplatesEnabled(false);
+        foreach(const chemkit::Molecule *molecule, molecules){
+            forceField->addMolecule(molecule);
+        }
+        forceField->setup();
+        calculationCount = forceField->calculationCount();
+
+        delete forceField;
+    }
+
+    qDebug() << "calculations:" << calculationCount;
+
+    foreach(chemkit::Molecule *molecule, molecules){
+        delete molecule;
+    }
+}
+
+QTEST_APPLESS_MAIN(ForceFieldSetupBenchmark)
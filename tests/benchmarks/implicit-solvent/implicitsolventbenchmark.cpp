@@ -0,0 +1,180 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+// This benchmark measures the time taken to calculate the generalized
+// Born solvation energy and gradient of the protein ubiquitin (PDB
+// ID: 1D3Z, 1231 atoms including hydrogens) with bond increment
+// charges, both over every pair of atoms and over the pairs found by a
+// neighbor list within a cutoff, and with one thread and with the
+// ideal number of threads. The nonpolar energy is compared with the
+// surface tension times the solvent accessible surface area. It also
+// measures the time taken to minimize uridine with the mmff force
+// field in the gas phase and in implicit solvent.
+
+#include "implicitsolventbenchmark.h"
+
+#include <chemkit/atom.h>
+#include <chemkit/bond.h>
+#include <chemkit/polymer.h>
+#include <chemkit/molecule.h>
+#include <chemkit/forcefield.h>
+#include <chemkit/polymerfile.h>
+#include <chemkit/moleculefile.h>
+#include <chemkit/bondpredictor.h>
+#include <chemkit/generalizedborn.h>
+#include <chemkit/molecularsurface.h>
+#include <chemkit/forcefieldminimizer.h>
+
+const std::string dataPath = "../../data/";
+
+namespace {
+
+// Returns the charge of each atom in molecule. Each bond moves a
+// charge proportional to the difference in the electronegativities
+// of its atoms from the less to the more electronegative atom which
+// keeps the molecule neutral.
+std::vector<chemkit::Float> bondIncrementCharges(const chemkit::Molecule *molecule)
+{
+    std::vector<chemkit::Float> charges(molecule->atomCount());
+
+    foreach(const chemkit::Bond *bond, molecule->bonds()){
+        const chemkit::Atom *a = bond->atom1();
+        const chemkit::Atom *b = bond->atom2();
+
+        chemkit::Float increment = 0.25 * (b->electronegativity() - a->electronegativity());
+        charges[a->index()] += increment;
+        charges[b->index()] -= increment;
+    }
+
+    return charges;
+}
+
+} // end anonymous namespace
+
+void ImplicitSolventBenchmark::benchmark_data()
+{
+    QTest::addColumn<double>("cutoff");
+    QTest::addColumn<int>("threadCount");
+
+    QTest::newRow("all-pairs serial") << 0.0 << 1;
+    QTest::newRow("all-pairs") << 0.0 << 0;
+    QTest::newRow("cutoff 16 serial") << 16.0 << 1;
+    QTest::newRow("cutoff 16") << 16.0 << 0;
+    QTest::newRow("cutoff 12") << 12.0 << 0;
+}
+
+void ImplicitSolventBenchmark::benchmark()
+{
+    QFETCH(double, cutoff);
+    QFETCH(int, threadCount);
+
+    chemkit::PolymerFile file(dataPath + "1D3Z.pdb");
+    QVERIFY(file.read());
+
+    chemkit::Polymer *protein = file.polymer();
+    QVERIFY(protein != 0);
+    chemkit::BondPredictor::predictBonds(protein);
+
+    std::vector<chemkit::Point3> positions;
+    std::vector<chemkit::Float> charges = bondIncrementCharges(protein);
+    std::vector<chemkit::Float> radii;
+    std::vector<chemkit::Float> factors;
+
+    foreach(const chemkit::Atom *atom, protein->atoms()){
+        positions.push_back(atom->position());
+        radii.push_back(chemkit::GeneralizedBorn::intrinsicRadius(atom));
+        factors.push_back(chemkit::GeneralizedBorn::screeningFactor(atom));
+    }
+
+    chemkit::GeneralizedBorn gb;
+    gb.setRadii(radii);
+    gb.setScreeningFactors(factors);
+    gb.setCutoff(cutoff);
+    gb.setThreadCount(threadCount);
+
+    chemkit::Float energy = 0;
+    std::vector<chemkit::Vector3> gradient;
+
+    QBENCHMARK {
+        energy = gb.energy(positions, charges, gradient);
+    }
+
+    chemkit::MolecularSurface surface(protein, chemkit::MolecularSurface::SolventAccessible);
+
+    qDebug() << "atoms:" << positions.size()
+             << "threads:" << gb.effectiveThreadCount()
+             << "energy:" << energy
+             << "polar:" << gb.polarEnergy()
+             << "nonpolar:" << gb.nonpolarEnergy()
+             << "surface area nonpolar:" << gb.surfaceTension() * surface.surfaceArea();
+}
+
+void ImplicitSolventBenchmark::minimization_data()
+{
+    QTest::addColumn<bool>("implicitSolvent");
+
+    QTest::newRow("gas phase") << false;
+    QTest::newRow("implicit solvent") << true;
+}
+
+void ImplicitSolventBenchmark::minimization()
+{
+    QFETCH(bool, implicitSolvent);
+
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("mmff");
+    QVERIFY(forceField != 0);
+    forceField->addMolecule(molecule);
+    QVERIFY(forceField->setup());
+    forceField->setImplicitSolventEnabled(implicitSolvent);
+
+    chemkit::ForceFieldMinimizer minimizer(forceField);
+
+    QBENCHMARK_ONCE {
+        minimizer.minimize();
+    }
+
+    qDebug() << "converged:" << minimizer.isConverged()
+             << "steps:" << minimizer.stepCount()
+             << "energy:" << forceField->energy()
+             << "solvation energy:" << forceField->solvationEnergy();
+
+    delete forceField;
+    delete molecule;
+}
+
+QTEST_APPLESS_MAIN(ImplicitSolventBenchmark)
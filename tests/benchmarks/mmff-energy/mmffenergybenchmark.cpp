@@ -37,10 +37,32 @@
 
 #include <chemkit/molecule.h>
 #include <chemkit/forcefield.h>
+#include <chemkit/forcefieldprofile.h>
 #include <chemkit/moleculefile.h>
 
+#include <map>
+
 const std::string dataPath = "../../data/";
 
+namespace {
+
+const char* calculationTypeName(int type)
+{
+    switch(type){
+        case chemkit::ForceFieldCalculation::BondStrech: return "bond";
+        case chemkit::ForceFieldCalculation::AngleBend: return "angle";
+        case chemkit::ForceFieldCalculation::BondStrech | chemkit::ForceFieldCalculation::AngleBend: return "stretch-bend";
+        case chemkit::ForceFieldCalculation::Torsion: return "torsion";
+        case chemkit::ForceFieldCalculation::Inversion: return "inversion";
+        case chemkit::ForceFieldCalculation::VanDerWaals: return "van der waals";
+        case chemkit::ForceFieldCalculation::Electrostatic: return "electrostatic";
+        case chemkit::ForceFieldCalculation::Restraint: return "restraint";
+        default: return "other";
+    }
+}
+
+} // end anonymous namespace
+
 void MmffEnergyBenchmark::benchmark()
 {
     // load test file
@@ -74,4 +96,54 @@ void MmffEnergyBenchmark::benchmark()
     QCOMPARE(qRound(totalEnergy), 5228);
 }
 
+// calculates the energy and gradient of each molecule with profiling
+// enabled and prints the totals for each calculation type
+void MmffEnergyBenchmark::profile()
+{
+    chemkit::MoleculeFile file(dataPath + "MMFF94_hypervalent.mol2");
+    bool ok = file.read();
+    QVERIFY(ok);
+
+    std::map<int, int> calculationCounts;
+    std::map<int, double> energies;
+    std::map<int, double> times;
+    double totalTime = 0;
+
+    QBENCHMARK_ONCE {
+        foreach(const chemkit::Molecule *molecule, file.molecules()){
+            chemkit::ForceField *forceField = chemkit::ForceField::create("mmff");
+            QVERIFY(forceField);
+
+            forceField->addMolecule(molecule);
+            forceField->setup();
+            forceField->setProfilingEnabled(true);
+
+            forceField->energy();
+            forceField->gradient();
+
+            const chemkit::ForceFieldProfile *profile = forceField->profile();
+            foreach(int type, profile->types()){
+                calculationCounts[type] += profile->calculationCount(type);
+                energies[type] += profile->energy(type);
+                times[type] += profile->time(type);
+            }
+            totalTime += profile->totalTime();
+
+            delete forceField;
+        }
+    }
+
+    qDebug() << "molecules:" << file.moleculeCount()
+             << "time (ms):" << totalTime;
+
+    for(std::map<int, int>::const_iterator iter = calculationCounts.begin(); iter != calculationCounts.end(); ++iter){
+        int type = iter->first;
+
+        qDebug() << calculationTypeName(type)
+                 << "calculations:" << calculationCounts[type]
+                 << "energy:" << energies[type]
+                 << "time (ms):" << times[type];
+    }
+}
+
 QTEST_APPLESS_MAIN(MmffEnergyBenchmark)
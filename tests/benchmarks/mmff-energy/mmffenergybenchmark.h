@@ -44,6 +44,7 @@ class MmffEnergyBenchmark : public QObject
 
     private slots:
         void benchmark();
+        void profile();
 };
 
 #endif // MMFFENERGYBENCHMARK_H
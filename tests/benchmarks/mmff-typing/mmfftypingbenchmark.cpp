@@ -0,0 +1,143 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+// This benchmark measures the throughput of the MMFF atom typer
+// for the 416 molecules in the pubchem_416_benzenes.sdf file using
+// one or more threads. The cached row measures the time taken to
+// reuse the types cached by each molecule.
+
+#include "mmfftypingbenchmark.h"
+
+#include <chemkit/molecule.h>
+#include <chemkit/atomtyper.h>
+#include <chemkit/moleculefile.h>
+
+const std::string dataPath = "../../data/";
+
+void MmffTypingBenchmark::benchmark_data()
+{
+    QTest::addColumn<int>("threadCount");
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("1 thread") << 1 << false;
+    QTest::newRow("2 threads") << 2 << false;
+    QTest::newRow("4 threads") << 4 << false;
+    QTest::newRow("ideal") << 0 << false;
+    QTest::newRow("cached") << 1 << true;
+}
+
+void MmffTypingBenchmark::benchmark()
+{
+    QFETCH(int, threadCount);
+    QFETCH(bool, cached);
+
+    // load test file
+    chemkit::MoleculeFile file(dataPath + "pubchem_416_benzenes.sdf");
+    bool ok = file.read();
+    if(!ok)
+        qDebug() << file.errorString().c_str();
+    QVERIFY(ok);
+
+    // perceive rings before typing
+    std::vector<const chemkit::Molecule *> molecules;
+    int atomCount = 0;
+    foreach(const chemkit::Molecule *molecule, file.molecules()){
+        molecule->rings();
+        molecules.push_back(molecule);
+        atomCount += molecule->atomCount();
+    }
+    QCOMPARE(molecules.size(), size_t(416));
+
+    // reference types assigned with a single thread
+    std::vector<int> expectedTypes;
+    foreach(const chemkit::Molecule *molecule, molecules){
+        chemkit::AtomTyper *typer = chemkit::AtomTyper::create("mmff");
+        QVERIFY(typer != 0);
+        typer->setMolecule(molecule);
+        for(int i = 0; i < molecule->atomCount(); i++){
+            expectedTypes.push_back(typer->typeNumber(i));
+        }
+        delete typer;
+    }
+
+    // copies of the molecules do not share the cached types
+    std::vector<chemkit::Molecule *> copies;
+    std::vector<const chemkit::Molecule *> targets = molecules;
+    if(!cached){
+        for(unsigned int i = 0; i < molecules.size(); i++){
+            chemkit::Molecule *copy = new chemkit::Molecule(*molecules[i]);
+            copy->rings();
+            copies.push_back(copy);
+            targets[i] = copy;
+        }
+    }
+
+    std::vector<chemkit::AtomTyper *> typers;
+
+    if(cached){
+        QBENCHMARK {
+            foreach(chemkit::AtomTyper *typer, typers){
+                delete typer;
+            }
+
+            typers = chemkit::AtomTyper::create("mmff", targets, threadCount);
+        }
+    }
+    else{
+        QBENCHMARK_ONCE {
+            typers = chemkit::AtomTyper::create("mmff", targets, threadCount);
+        }
+    }
+
+    QCOMPARE(typers.size(), molecules.size());
+
+    std::vector<int> types;
+    for(unsigned int i = 0; i < typers.size(); i++){
+        for(int j = 0; j < targets[i]->atomCount(); j++){
+            types.push_back(typers[i]->typeNumber(j));
+        }
+
+        delete typers[i];
+    }
+
+    foreach(chemkit::Molecule *copy, copies){
+        delete copy;
+    }
+
+    QVERIFY(types == expectedTypes);
+    QCOMPARE(int(types.size()), atomCount);
+}
+
+QTEST_APPLESS_MAIN(MmffTypingBenchmark)
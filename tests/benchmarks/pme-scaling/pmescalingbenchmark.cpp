@@ -0,0 +1,215 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+// This benchmark compares the time taken to calculate the periodic
+// electrostatic energy and gradient of water boxes of increasing
+// size with the all-pairs sum used by the force field calculations
+// and with the particle mesh Ewald method. The boxes are built by
+// replicating the first frame of the spc216 trajectory. The time
+// for the all-pairs sum grows as O(N^2) while the particle mesh
+// Ewald time grows as O(N log N).
+
+#include "pmescalingbenchmark.h"
+
+#include <cmath>
+
+#include <chemkit/unitcell.h>
+#include <chemkit/constants.h>
+#include <chemkit/trajectory.h>
+#include <chemkit/neighborlist.h>
+#include <chemkit/trajectoryfile.h>
+#include <chemkit/trajectoryframe.h>
+#include <chemkit/particlemeshewald.h>
+
+const std::string dataPath = "../../data/";
+
+namespace {
+
+enum Method {
+    AllPairs,
+    ParticleMeshEwald
+};
+
+// Returns the all-pairs energy of the charges using the minimum
+// image convention. Pairs within the same water molecule are
+// excluded.
+chemkit::Float allPairsEnergy(const chemkit::UnitCell &cell,
+                              const std::vector<chemkit::Point3> &positions,
+                              const std::vector<chemkit::Float> &charges,
+                              std::vector<chemkit::Vector3> &gradient)
+{
+    chemkit::Float energy = 0;
+    gradient.assign(positions.size(), chemkit::Vector3());
+
+    for(unsigned int i = 0; i < positions.size(); i++){
+        for(unsigned int j = (i / 3 + 1) * 3; j < positions.size(); j++){
+            chemkit::Vector3 vector = cell.minimumImage(positions[j] - positions[i]);
+            chemkit::Float r = vector.length();
+            chemkit::Float e = charges[i] * charges[j] / r;
+
+            energy += e;
+
+            chemkit::Vector3 force = vector * (-e / (r * r));
+            gradient[i] -= force;
+            gradient[j] += force;
+        }
+    }
+
+    return energy;
+}
+
+// Returns the particle mesh Ewald energy of the charges. Pairs
+// within the same water molecule are excluded.
+chemkit::Float particleMeshEwaldEnergy(const chemkit::UnitCell &cell,
+                                       const std::vector<chemkit::Point3> &positions,
+                                       const std::vector<chemkit::Float> &charges,
+                                       std::vector<chemkit::Vector3> &gradient)
+{
+    const chemkit::Float cutoff = 9.0;
+    const chemkit::Float beta = chemkit::ParticleMeshEwald::ewaldCoefficient(cutoff, 1e-5);
+    const chemkit::Float twoBetaOverRootPi = 2.0 * beta / std::sqrt(chemkit::constants::Pi);
+
+    chemkit::ParticleMeshEwald pme;
+    pme.setUnitCell(&cell);
+    pme.setEwaldCoefficient(beta);
+
+    chemkit::Float energy = pme.reciprocalEnergy(positions, charges, gradient);
+    energy += pme.selfEnergy(charges);
+
+    chemkit::NeighborList neighborList(cutoff);
+    neighborList.setUnitCell(&cell);
+    neighborList.build(positions);
+
+    for(int i = 0; i < neighborList.size(); i++){
+        for(int k = 0; k < neighborList.neighborCount(i); k++){
+            int j = neighborList.neighbor(i, k);
+
+            chemkit::Vector3 vector = cell.minimumImage(positions[j] - positions[i]);
+            chemkit::Float r = vector.length();
+            chemkit::Float qiqj = charges[i] * charges[j];
+
+            // the reciprocal space sum includes the excluded pairs
+            chemkit::Float screened;
+            chemkit::Float de_dr;
+            if(i / 3 == j / 3){
+                screened = -erf(beta * r) / r;
+                de_dr = -qiqj * (twoBetaOverRootPi * std::exp(-beta * beta * r * r) + screened) / r;
+            }
+            else{
+                screened = erfc(beta * r) / r;
+                de_dr = -qiqj * (screened + twoBetaOverRootPi * std::exp(-beta * beta * r * r)) / r;
+            }
+
+            energy += qiqj * screened;
+
+            chemkit::Vector3 force = vector * (de_dr / r);
+            gradient[i] -= force;
+            gradient[j] += force;
+        }
+    }
+
+    return energy;
+}
+
+} // end anonymous namespace
+
+void PmeScalingBenchmark::benchmark_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::addColumn<int>("replicas");
+
+    QTest::newRow("all-pairs 648") << int(AllPairs) << 1;
+    QTest::newRow("all-pairs 5184") << int(AllPairs) << 2;
+    QTest::newRow("all-pairs 17496") << int(AllPairs) << 3;
+    QTest::newRow("pme 648") << int(ParticleMeshEwald) << 1;
+    QTest::newRow("pme 5184") << int(ParticleMeshEwald) << 2;
+    QTest::newRow("pme 17496") << int(ParticleMeshEwald) << 3;
+    QTest::newRow("pme 41472") << int(ParticleMeshEwald) << 4;
+}
+
+void PmeScalingBenchmark::benchmark()
+{
+    QFETCH(int, method);
+    QFETCH(int, replicas);
+
+    chemkit::TrajectoryFile file(dataPath + "spc216.xtc");
+    QVERIFY(file.read());
+    const chemkit::TrajectoryFrame *frame = file.trajectory()->frame(0);
+    const chemkit::UnitCell *box = frame->unitCell();
+    QVERIFY(box != 0);
+
+    // replicate the box along each of its vectors
+    chemkit::UnitCell cell(box->x() * chemkit::Float(replicas),
+                           box->y() * chemkit::Float(replicas),
+                           box->z() * chemkit::Float(replicas));
+
+    std::vector<chemkit::Point3> positions;
+    std::vector<chemkit::Float> charges;
+
+    for(int a = 0; a < replicas; a++){
+        for(int b = 0; b < replicas; b++){
+            for(int c = 0; c < replicas; c++){
+                chemkit::Vector3 offset = box->x() * chemkit::Float(a) +
+                                          box->y() * chemkit::Float(b) +
+                                          box->z() * chemkit::Float(c);
+
+                // spc charges for the oxygen and two hydrogens of
+                // each water molecule
+                for(int i = 0; i < frame->size(); i++){
+                    positions.push_back(frame->position(i) + offset);
+                    charges.push_back(i % 3 == 0 ? -0.82 : 0.41);
+                }
+            }
+        }
+    }
+
+    chemkit::Float energy = 0;
+    std::vector<chemkit::Vector3> gradient;
+
+    QBENCHMARK {
+        if(method == AllPairs){
+            energy = allPairsEnergy(cell, positions, charges, gradient);
+        }
+        else{
+            energy = particleMeshEwaldEnergy(cell, positions, charges, gradient);
+        }
+    }
+
+    // energy in kcal/mol per water molecule
+    qDebug() << "atoms:" << positions.size()
+             << "energy per molecule:" << 332.0716 * energy / (positions.size() / 3);
+}
+
+QTEST_APPLESS_MAIN(PmeScalingBenchmark)
@@ -37,10 +37,31 @@
 
 #include <chemkit/molecule.h>
 #include <chemkit/forcefield.h>
+#include <chemkit/forcefieldprofile.h>
 #include <chemkit/moleculefile.h>
+#include <chemkit/forcefieldminimizer.h>
 
 const std::string dataPath = "../../data/";
 
+namespace {
+
+const char* calculationTypeName(int type)
+{
+    switch(type){
+        case chemkit::ForceFieldCalculation::BondStrech: return "bond";
+        case chemkit::ForceFieldCalculation::AngleBend: return "angle";
+        case chemkit::ForceFieldCalculation::BondStrech | chemkit::ForceFieldCalculation::AngleBend: return "stretch-bend";
+        case chemkit::ForceFieldCalculation::Torsion: return "torsion";
+        case chemkit::ForceFieldCalculation::Inversion: return "inversion";
+        case chemkit::ForceFieldCalculation::VanDerWaals: return "van der waals";
+        case chemkit::ForceFieldCalculation::Electrostatic: return "electrostatic";
+        case chemkit::ForceFieldCalculation::Restraint: return "restraint";
+        default: return "other";
+    }
+}
+
+} // end anonymous namespace
+
 void UridineMinimizationBenchmark::benchmark()
 {
     chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
@@ -68,4 +89,97 @@ void UridineMinimizationBenchmark::benchmark()
     delete molecule;
 }
 
+void UridineMinimizationBenchmark::minimizer_data()
+{
+    QTest::addColumn<int>("algorithm");
+
+    QTest::newRow("steepest-descent") << int(chemkit::ForceFieldMinimizer::SteepestDescent);
+    QTest::newRow("conjugate-gradient") << int(chemkit::ForceFieldMinimizer::ConjugateGradient);
+    QTest::newRow("lbfgs") << int(chemkit::ForceFieldMinimizer::Lbfgs);
+    QTest::newRow("fire") << int(chemkit::ForceFieldMinimizer::Fire);
+    QTest::newRow("truncated-newton") << int(chemkit::ForceFieldMinimizer::TruncatedNewton);
+}
+
+void UridineMinimizationBenchmark::minimizer()
+{
+    QFETCH(int, algorithm);
+
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField != 0);
+
+    forceField->addMolecule(molecule);
+    bool ok = forceField->setup();
+    QVERIFY(ok);
+
+    chemkit::ForceFieldMinimizer minimizer(forceField, chemkit::ForceFieldMinimizer::Algorithm(algorithm));
+    minimizer.setEnergyConvergence(0);
+    minimizer.setMaximumGradientConvergence(0);
+    minimizer.setMaximumStepCount(0);
+
+    QBENCHMARK {
+        // start from the initial coordinates each iteration
+        forceField->readCoordinates(molecule);
+        minimizer.reset();
+
+        // converge when rmsg = 0.1
+        bool converged = minimizer.minimize();
+        QVERIFY(converged);
+    }
+
+    qDebug() << "steps:" << minimizer.stepCount()
+             << "gradient evaluations:" << minimizer.gradientEvaluationCount()
+             << "hessian evaluations:" << minimizer.hessianEvaluationCount()
+             << "energy:" << minimizer.energy();
+
+    delete forceField;
+    delete molecule;
+}
+
+// minimizes uridine with profiling enabled and prints the energy,
+// gradient norm and time for each calculation type
+void UridineMinimizationBenchmark::profile()
+{
+    chemkit::Molecule *molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField != 0);
+
+    forceField->addMolecule(molecule);
+    bool ok = forceField->setup();
+    QVERIFY(ok);
+
+    forceField->setProfilingEnabled(true);
+
+    chemkit::ForceFieldMinimizer minimizer(forceField, chemkit::ForceFieldMinimizer::Lbfgs);
+    minimizer.setEnergyConvergence(0);
+    minimizer.setMaximumGradientConvergence(0);
+    minimizer.setMaximumStepCount(0);
+
+    QBENCHMARK_ONCE {
+        bool converged = minimizer.minimize();
+        QVERIFY(converged);
+    }
+
+    const chemkit::ForceFieldProfile *profile = forceField->profile();
+
+    qDebug() << "energy evaluations:" << profile->energyEvaluationCount()
+             << "gradient evaluations:" << profile->gradientEvaluationCount()
+             << "time (ms):" << profile->totalTime();
+
+    foreach(int type, profile->types()){
+        qDebug() << calculationTypeName(type)
+                 << "calculations:" << profile->calculationCount(type)
+                 << "energy:" << profile->energy(type)
+                 << "gradient norm:" << profile->gradientNorm(type)
+                 << "time (ms):" << profile->time(type);
+    }
+
+    delete forceField;
+    delete molecule;
+}
+
 QTEST_APPLESS_MAIN(UridineMinimizationBenchmark)
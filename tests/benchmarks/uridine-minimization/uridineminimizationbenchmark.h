@@ -44,6 +44,9 @@ class UridineMinimizationBenchmark : public QObject
 
     private slots:
         void benchmark();
+        void minimizer_data();
+        void minimizer();
+        void profile();
 };
 
 #endif // URIDINEMINIMIZATIONBENCHMARK_H
@@ -0,0 +1,138 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+// This benchmark measures the throughput of molecular dynamics for
+// the 216 water molecules from the first frame of the spc216
+// trajectory using the UFF force field with periodic boundary
+// conditions. Results are reported in nanoseconds of simulated time
+// per day.
+
+#include "waterdynamicsbenchmark.h"
+
+#include <chemkit/atom.h>
+#include <chemkit/molecule.h>
+#include <chemkit/unitcell.h>
+#include <chemkit/forcefield.h>
+#include <chemkit/trajectory.h>
+#include <chemkit/trajectoryfile.h>
+#include <chemkit/trajectoryframe.h>
+#include <chemkit/moleculardynamics.h>
+#include <chemkit/forcefieldminimizer.h>
+
+const std::string dataPath = "../../data/";
+
+void WaterDynamicsBenchmark::benchmark_data()
+{
+    QTest::addColumn<int>("integrator");
+    QTest::addColumn<int>("constraints");
+    QTest::addColumn<double>("timeStep");
+
+    QTest::newRow("velocity-verlet") << int(chemkit::MolecularDynamics::VelocityVerlet)
+                                     << int(chemkit::MolecularDynamics::NoConstraints)
+                                     << 1.0;
+    QTest::newRow("langevin") << int(chemkit::MolecularDynamics::Langevin)
+                              << int(chemkit::MolecularDynamics::NoConstraints)
+                              << 1.0;
+    QTest::newRow("langevin-shake") << int(chemkit::MolecularDynamics::Langevin)
+                                    << int(chemkit::MolecularDynamics::HydrogenBonds)
+                                    << 2.0;
+}
+
+void WaterDynamicsBenchmark::benchmark()
+{
+    QFETCH(int, integrator);
+    QFETCH(int, constraints);
+    QFETCH(double, timeStep);
+
+    chemkit::TrajectoryFile file(dataPath + "spc216.xtc");
+    QVERIFY(file.read());
+    const chemkit::TrajectoryFrame *frame = file.trajectory()->frame(0);
+    QCOMPARE(frame->size(), 648);
+
+    // build water molecules (oxygen followed by two hydrogens)
+    chemkit::Molecule molecule;
+    for(int i = 0; i < frame->size(); i += 3){
+        chemkit::Atom *oxygen = molecule.addAtom("O");
+        chemkit::Atom *hydrogen1 = molecule.addAtom("H");
+        chemkit::Atom *hydrogen2 = molecule.addAtom("H");
+
+        oxygen->setPosition(frame->position(i));
+        hydrogen1->setPosition(frame->position(i + 1));
+        hydrogen2->setPosition(frame->position(i + 2));
+
+        molecule.addBond(oxygen, hydrogen1);
+        molecule.addBond(oxygen, hydrogen2);
+    }
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField != 0);
+    forceField->addMolecule(&molecule);
+    QVERIFY(forceField->setup());
+    forceField->setUnitCell(frame->unitCell());
+
+    // relax the spc geometry for the force field before starting
+    chemkit::ForceFieldMinimizer minimizer(forceField);
+    minimizer.setMaximumStepCount(200);
+    minimizer.minimize();
+
+    chemkit::MolecularDynamics dynamics(forceField, chemkit::MolecularDynamics::Integrator(integrator));
+    dynamics.setConstraints(chemkit::MolecularDynamics::Constraints(constraints));
+    dynamics.setTimeStep(timeStep);
+    dynamics.setTemperature(300);
+    dynamics.setUnitCell(frame->unitCell());
+    dynamics.initializeVelocities();
+
+    const int steps = 50;
+    QTime timer;
+    qint64 elapsed = 0;
+
+    QBENCHMARK {
+        timer.start();
+        QVERIFY(dynamics.run(steps));
+        elapsed += timer.elapsed();
+    }
+
+    // report simulated nanoseconds per day of wall time
+    double nanoseconds = dynamics.stepCount() * timeStep * 1.0e-6;
+    double days = elapsed / (1000.0 * 60 * 60 * 24);
+
+    qDebug() << "ns/day:" << (days > 0 ? nanoseconds / days : 0)
+             << "temperature:" << dynamics.instantaneousTemperature();
+
+    delete forceField;
+}
+
+QTEST_APPLESS_MAIN(WaterDynamicsBenchmark)